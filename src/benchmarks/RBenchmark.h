@@ -0,0 +1,65 @@
+#pragma once
+
+#include "common.h"
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace rocket
+{
+
+/**
+ * Working set sizes (in bytes) that the math benchmarks are run at.
+ *
+ * Each benchmark touches its whole input and output arrays once per
+ * iteration, so these select whether the data lives in L1, L2 or DRAM.
+ */
+static const size_t BENCH_L1_BYTES = 16 * 1024;
+static const size_t BENCH_L2_BYTES = 512 * 1024;
+static const size_t BENCH_DRAM_BYTES = 64 * 1024 * 1024;
+
+/**
+ * Registers the L1/L2/DRAM item counts for a benchmark whose items
+ * touch bytesPerItem bytes of memory.
+ *
+ * Usage: BENCHMARK(fn)->Apply(benchSizes<sizeof(RMatrix) * 2>);
+ */
+template <size_t bytesPerItem>
+void benchSizes(benchmark::internal::Benchmark* b)
+{
+    b->ArgName("items");
+    b->Arg(BENCH_L1_BYTES / bytesPerItem);
+    b->Arg(BENCH_L2_BYTES / bytesPerItem);
+    b->Arg(BENCH_DRAM_BYTES / bytesPerItem);
+}
+
+/**
+ * Reports items/s and the time per item (shown as time/op) for a benchmark
+ * that processed count items on every iteration.
+ */
+inline void benchReport(benchmark::State& state, size_t count)
+{
+    state.SetItemsProcessed(state.iterations() * (int64_t)count);
+    state.counters["time/op"] = benchmark::Counter((double)count,
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+/**
+ * Deterministic source of benchmark inputs, so runs are comparable.
+ */
+class RBenchRandom
+{
+public:
+
+    RBenchRandom(unsigned int seed = 0x5eed) : _engine(seed) { }
+
+    float next(float lo = -1.0f, float hi = 1.0f)
+    {
+        return std::uniform_real_distribution<float>(lo, hi)(_engine);
+    }
+
+private:
+
+    std::mt19937 _engine;
+};
+
+}
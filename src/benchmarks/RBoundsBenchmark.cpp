@@ -0,0 +1,169 @@
+#include "RBenchmark.h"
+#include "math/RBoundingBox.h"
+#include "math/RBoundingSphere.h"
+#include "math/RFrustum.h"
+#include "math/RRay.h"
+
+namespace rocket
+{
+
+static void fillBoxes(std::vector<RBoundingBox>& boxes)
+{
+    RBenchRandom random;
+    for (size_t i = 0; i < boxes.size(); i++)
+    {
+        RVector3 center(random.next(-200.0f, 200.0f), random.next(-200.0f, 200.0f), random.next(-200.0f, 200.0f));
+        RVector3 extent(random.next(0.5f, 5.0f), random.next(0.5f, 5.0f), random.next(0.5f, 5.0f));
+        boxes[i].set(center - extent, center + extent);
+    }
+}
+
+static void fillSpheres(std::vector<RBoundingSphere>& spheres)
+{
+    RBenchRandom random;
+    for (size_t i = 0; i < spheres.size(); i++)
+    {
+        RVector3 center(random.next(-200.0f, 200.0f), random.next(-200.0f, 200.0f), random.next(-200.0f, 200.0f));
+        spheres[i].set(center, random.next(0.5f, 5.0f));
+    }
+}
+
+static RFrustum createBenchFrustum()
+{
+    RMatrix projection;
+    RMatrix view;
+    RMatrix::createPerspective(60.0f, 16.0f / 9.0f, 0.1f, 250.0f, &projection);
+    RMatrix::createLookAt(RVector3(0.0f, 20.0f, 50.0f), RVector3::zero(), RVector3::unitY(), &view);
+    return RFrustum(projection * view);
+}
+
+static RRay createBenchRay()
+{
+    return RRay(RVector3(0.0f, 20.0f, 250.0f), RVector3(0.05f, -0.05f, -1.0f));
+}
+
+static void BM_RFrustumIntersectsBox(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RBoundingBox> boxes(count);
+    fillBoxes(boxes);
+    RFrustum frustum = createBenchFrustum();
+
+    for (auto _ : state)
+    {
+        size_t visible = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            visible += frustum.intersects(boxes[i]) ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(visible);
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RFrustumIntersectsBox)->Apply(benchSizes<sizeof(RBoundingBox)>);
+
+static void BM_RFrustumIntersectsSphere(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RBoundingSphere> spheres(count);
+    fillSpheres(spheres);
+    RFrustum frustum = createBenchFrustum();
+
+    for (auto _ : state)
+    {
+        size_t visible = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            visible += frustum.intersects(spheres[i]) ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(visible);
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RFrustumIntersectsSphere)->Apply(benchSizes<sizeof(RBoundingSphere)>);
+
+static void BM_RBoundingBoxIntersectsBox(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RBoundingBox> boxes(count);
+    fillBoxes(boxes);
+    RBoundingBox query(-20.0f, -20.0f, -20.0f, 20.0f, 20.0f, 20.0f);
+
+    for (auto _ : state)
+    {
+        size_t hits = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            hits += query.intersects(boxes[i]) ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(hits);
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RBoundingBoxIntersectsBox)->Apply(benchSizes<sizeof(RBoundingBox)>);
+
+static void BM_RRayIntersectsBox(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RBoundingBox> boxes(count);
+    fillBoxes(boxes);
+    RRay ray = createBenchRay();
+
+    for (auto _ : state)
+    {
+        float nearest = 0.0f;
+        for (size_t i = 0; i < count; i++)
+        {
+            nearest += ray.intersects(boxes[i]);
+        }
+        benchmark::DoNotOptimize(nearest);
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RRayIntersectsBox)->Apply(benchSizes<sizeof(RBoundingBox)>);
+
+static void BM_RRayIntersectsSphere(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RBoundingSphere> spheres(count);
+    fillSpheres(spheres);
+    RRay ray = createBenchRay();
+
+    for (auto _ : state)
+    {
+        float nearest = 0.0f;
+        for (size_t i = 0; i < count; i++)
+        {
+            nearest += ray.intersects(spheres[i]);
+        }
+        benchmark::DoNotOptimize(nearest);
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RRayIntersectsSphere)->Apply(benchSizes<sizeof(RBoundingSphere)>);
+
+static void BM_RFrustumClipTriangles(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    RBenchRandom random;
+    std::vector<RVector3> triangles(count * 3);
+    for (size_t i = 0; i < count; i++)
+    {
+        RVector3 center(random.next(-100.0f, 100.0f), random.next(-20.0f, 40.0f), random.next(-200.0f, 50.0f));
+        for (int j = 0; j < 3; j++)
+            triangles[i * 3 + j] = center + RVector3(random.next(-20.0f, 20.0f), random.next(-20.0f, 20.0f), random.next(-20.0f, 20.0f));
+    }
+    RFrustum frustum = createBenchFrustum();
+    std::vector<RVector3> dst(count * 3 * 7);
+
+    for (auto _ : state)
+    {
+        unsigned int written = frustum.clipTriangles(triangles.data(), (unsigned int)count, dst.data(), (unsigned int)count * 7);
+        benchmark::DoNotOptimize(written);
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RFrustumClipTriangles)->Apply(benchSizes<sizeof(RVector3) * 3 * 8>);
+
+}
@@ -0,0 +1,61 @@
+#include "RBenchmark.h"
+
+namespace rocket
+{
+
+static void fillBenchCommands(std::vector<RDrawCommand>& commands)
+{
+    RBenchRandom random;
+    for (size_t i = 0; i < commands.size(); i++)
+    {
+        RDrawCommand& command = commands[i];
+        command.shader = (uint32_t)random.next(0.0f, 32.0f);
+        command.material = (uint32_t)random.next(0.0f, 512.0f);
+        command.mesh = (uint32_t)random.next(0.0f, 2048.0f);
+        command.firstIndex = 0;
+        command.indexCount = 36;
+        command.baseVertex = 0;
+        command.instanceCount = 1;
+        RSortKey::Layer layer = random.next(0.0f, 1.0f) < 0.2f ? RSortKey::TRANSLUCENT : RSortKey::OPAQUE;
+        command.key = RSortKey::make(0, layer, random.next(0.0f, 1.0f), command.shader, command.material, command.mesh);
+    }
+}
+
+static void BM_StdSortCommands(benchmark::State& state)
+{
+    std::vector<RDrawCommand> commands((size_t)state.range(0));
+    fillBenchCommands(commands);
+    std::vector<RDrawCommand> sorted;
+
+    for (auto _ : state)
+    {
+        sorted = commands;
+        std::sort(sorted.begin(), sorted.end(), [](const RDrawCommand& a, const RDrawCommand& b) { return a.key < b.key; });
+        benchmark::DoNotOptimize(sorted.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, commands.size());
+}
+BENCHMARK(BM_StdSortCommands)->Apply(benchSizes<sizeof(RDrawCommand) * 3>);
+
+static void BM_RCommandBufferSort(benchmark::State& state)
+{
+    std::vector<RDrawCommand> commands((size_t)state.range(0));
+    fillBenchCommands(commands);
+    RCommandBuffer buffer;
+    buffer.reserve(commands.size());
+
+    for (auto _ : state)
+    {
+        buffer.clear();
+        for (size_t i = 0; i < commands.size(); i++)
+            buffer.add(commands[i]);
+        buffer.sort();
+        benchmark::DoNotOptimize(&buffer.get(0));
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, commands.size());
+}
+BENCHMARK(BM_RCommandBufferSort)->Apply(benchSizes<sizeof(RDrawCommand) * 3>);
+
+}
@@ -0,0 +1,94 @@
+#include "RBenchmark.h"
+#include "math/RCurve.h"
+
+namespace rocket
+{
+
+static const unsigned int CURVE_BENCH_POINTS = 32;
+
+static void fillBenchCurve(RCurve* curve, RBenchRandom& random, RCurve::InterpolationType type)
+{
+    std::vector<float> value(curve->getComponentCount());
+    for (unsigned int i = 0; i < curve->getPointCount(); i++)
+    {
+        for (size_t c = 0; c < value.size(); c++)
+            value[c] = random.next();
+        curve->setPoint(i, (float)i, value.data(), type);
+    }
+}
+
+static void BM_RCurveEvaluate(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    RCurve curve(CURVE_BENCH_POINTS, 3);
+    RBenchRandom random;
+    fillBenchCurve(&curve, random, RCurve::CATMULL_ROM);
+    std::vector<float> times(count);
+    std::vector<RVector3> dst(count);
+    for (size_t i = 0; i < count; i++)
+        times[i] = random.next(0.0f, (float)CURVE_BENCH_POINTS);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+            curve.evaluate(times[i], &dst[i].x);
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RCurveEvaluate)->Apply(benchSizes<sizeof(float) + sizeof(RVector3)>);
+
+static void BM_RCurveEvaluateTimes(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    RCurve curve(CURVE_BENCH_POINTS, 3);
+    RBenchRandom random;
+    fillBenchCurve(&curve, random, RCurve::CATMULL_ROM);
+    std::vector<float> times(count);
+    std::vector<RVector3> dst(count);
+    for (size_t i = 0; i < count; i++)
+        times[i] = random.next(0.0f, (float)CURVE_BENCH_POINTS);
+    std::sort(times.begin(), times.end());
+
+    for (auto _ : state)
+    {
+        curve.evaluate(times.data(), count, &dst[0].x);
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RCurveEvaluateTimes)->Apply(benchSizes<sizeof(float) + sizeof(RVector3)>);
+
+static void BM_RCurveEvaluateCurves(benchmark::State& state)
+{
+    // One float curve per animated property, all sampled at the frame time.
+    const size_t count = (size_t)state.range(0);
+    RBenchRandom random;
+    std::vector<std::unique_ptr<RCurve>> curves(count);
+    std::vector<const RCurve*> pointers(count);
+    std::vector<float> values(count);
+    std::vector<float*> dst(count);
+    std::vector<unsigned int> cursors(count, 0);
+    for (size_t i = 0; i < count; i++)
+    {
+        curves[i].reset(new RCurve(8, 1));
+        fillBenchCurve(curves[i].get(), random, RCurve::HERMITE);
+        pointers[i] = curves[i].get();
+        dst[i] = &values[i];
+    }
+
+    float time = 0.0f;
+    for (auto _ : state)
+    {
+        RCurve::evaluate(pointers.data(), count, time, dst.data(), cursors.data());
+        time = time < 7.0f ? time + 0.016f : 0.0f;
+        benchmark::DoNotOptimize(values.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RCurveEvaluateCurves)->Arg(1000)->Arg(10000);
+
+}
@@ -0,0 +1,85 @@
+#include "RBenchmark.h"
+#include "math/RMatrix.h"
+#include "math/RQuaternion.h"
+
+namespace rocket
+{
+
+static void fillMatrices(std::vector<RMatrix>& matrices)
+{
+    RBenchRandom random;
+    for (size_t i = 0; i < matrices.size(); i++)
+    {
+        RQuaternion rotation(random.next(), random.next(), random.next(), random.next());
+        rotation.normalize();
+        RMatrix::createTranslation(random.next(-100.0f, 100.0f), random.next(-100.0f, 100.0f), random.next(-100.0f, 100.0f), &matrices[i]);
+        matrices[i].rotate(rotation);
+        matrices[i].scale(random.next(0.5f, 2.0f), random.next(0.5f, 2.0f), random.next(0.5f, 2.0f));
+    }
+}
+
+static void BM_RMatrixMultiply(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RMatrix> src(count);
+    std::vector<RMatrix> dst(count);
+    fillMatrices(src);
+    RMatrix view;
+    RMatrix::createLookAt(RVector3(0.0f, 10.0f, 10.0f), RVector3::zero(), RVector3::unitY(), &view);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            RMatrix::multiply(view, src[i], &dst[i]);
+        }
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RMatrixMultiply)->Apply(benchSizes<sizeof(RMatrix) * 2>);
+
+static void BM_RMatrixInvert(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RMatrix> src(count);
+    std::vector<RMatrix> dst(count);
+    fillMatrices(src);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            src[i].invert(&dst[i]);
+        }
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RMatrixInvert)->Apply(benchSizes<sizeof(RMatrix) * 2>);
+
+static void BM_RMatrixDecompose(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RMatrix> src(count);
+    std::vector<RVector3> scale(count);
+    std::vector<RQuaternion> rotation(count);
+    std::vector<RVector3> translation(count);
+    fillMatrices(src);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            src[i].decompose(&scale[i], &rotation[i], &translation[i]);
+        }
+        benchmark::DoNotOptimize(rotation.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RMatrixDecompose)->Apply(benchSizes<sizeof(RMatrix) + sizeof(RVector3) * 2 + sizeof(RQuaternion)>);
+
+}
@@ -0,0 +1,130 @@
+#include "RBenchmark.h"
+#include "utilities/Noise.h"
+
+namespace rocket
+{
+
+// Noise is compute bound, so a single 256 x 256 grid (256KB of output) is
+// enough and the results are reported as samples/s.
+static const int NOISE_BENCH_SIZE = 256;
+
+static void noiseBenchArgs(benchmark::internal::Benchmark* b)
+{
+    b->ArgNames({ "type", "octaves" });
+    for (int type = RNoise::GRADIENT; type <= RNoise::SIMPLEX; type++)
+    {
+        b->Args({ type, 1 });
+        b->Args({ type, 5 });
+    }
+}
+
+static RNoise makeBenchNoise(const benchmark::State& state, unsigned int threads = 1)
+{
+    RNoise noise;
+    noise.setType((RNoise::Type)state.range(0));
+    if (state.range(1) > 1)
+        noise.setFractal(RNoise::FBM, (int)state.range(1));
+    noise.setFrequency(1.0f / 32.0f);
+    noise.setThreadCount(threads);
+    return noise;
+}
+
+static void BM_RNoiseSingle2(benchmark::State& state)
+{
+    RNoise noise = makeBenchNoise(state);
+    std::vector<float> dst(NOISE_BENCH_SIZE * NOISE_BENCH_SIZE);
+
+    for (auto _ : state)
+    {
+        for (int j = 0; j < NOISE_BENCH_SIZE; j++)
+            for (int i = 0; i < NOISE_BENCH_SIZE; i++)
+                dst[j * NOISE_BENCH_SIZE + i] = noise.get((float)i, (float)j);
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, dst.size());
+}
+BENCHMARK(BM_RNoiseSingle2)->Apply(noiseBenchArgs);
+
+static void BM_RNoiseGrid2(benchmark::State& state)
+{
+    RNoise noise = makeBenchNoise(state);
+    std::vector<float> dst(NOISE_BENCH_SIZE * NOISE_BENCH_SIZE);
+
+    for (auto _ : state)
+    {
+        noise.fillGrid(0.0f, 0.0f, 1.0f, NOISE_BENCH_SIZE, NOISE_BENCH_SIZE, dst.data());
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, dst.size());
+}
+BENCHMARK(BM_RNoiseGrid2)->Apply(noiseBenchArgs);
+
+static void BM_RNoisePoints3(benchmark::State& state)
+{
+    RNoise noise = makeBenchNoise(state);
+    const size_t count = NOISE_BENCH_SIZE * NOISE_BENCH_SIZE;
+    std::vector<float> x(count), y(count), z(count), dst(count);
+    RBenchRandom random;
+    for (size_t i = 0; i < count; i++)
+    {
+        x[i] = random.next(-1000.0f, 1000.0f);
+        y[i] = random.next(-1000.0f, 1000.0f);
+        z[i] = random.next(-1000.0f, 1000.0f);
+    }
+
+    for (auto _ : state)
+    {
+        noise.get(x.data(), y.data(), z.data(), count, dst.data());
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RNoisePoints3)->Apply(noiseBenchArgs);
+
+static void BM_RNoisePoints4(benchmark::State& state)
+{
+    RNoise noise = makeBenchNoise(state);
+    const size_t count = NOISE_BENCH_SIZE * NOISE_BENCH_SIZE;
+    std::vector<float> x(count), y(count), z(count), w(count), dst(count);
+    RBenchRandom random;
+    for (size_t i = 0; i < count; i++)
+    {
+        x[i] = random.next(-1000.0f, 1000.0f);
+        y[i] = random.next(-1000.0f, 1000.0f);
+        z[i] = random.next(-1000.0f, 1000.0f);
+        w[i] = random.next(-1000.0f, 1000.0f);
+    }
+
+    for (auto _ : state)
+    {
+        noise.get(x.data(), y.data(), z.data(), w.data(), count, dst.data());
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RNoisePoints4)->Apply(noiseBenchArgs);
+
+static void BM_RNoiseGrid3Threads(benchmark::State& state)
+{
+    RNoise noise;
+    noise.setFractal(RNoise::FBM, 5);
+    noise.setFrequency(1.0f / 32.0f);
+    noise.setThreadCount((unsigned int)state.range(0));
+    const int size = 64;
+    std::vector<float> dst(size * size * size);
+
+    for (auto _ : state)
+    {
+        noise.fillGrid(0.0f, 0.0f, 0.0f, 1.0f, size, size, size, dst.data());
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, dst.size());
+}
+BENCHMARK(BM_RNoiseGrid3Threads)->ArgName("threads")->Arg(1)->Arg(2)->Arg(4)->UseRealTime();
+
+}
@@ -0,0 +1,105 @@
+#include "RBenchmark.h"
+#include "math/RPacking.h"
+
+namespace rocket
+{
+
+static void BM_RPackingHalf(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RVector4> src(count);
+    std::vector<uint16_t> dst(count * 4);
+    RBenchRandom random;
+    for (size_t i = 0; i < count; i++)
+        src[i].set(random.next(-100.0f, 100.0f), random.next(-100.0f, 100.0f), random.next(-100.0f, 100.0f), 1.0f);
+
+    for (auto _ : state)
+    {
+        RPacking::packHalf(src.data(), count, dst.data());
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RPackingHalf)->Apply(benchSizes<sizeof(RVector4) + sizeof(uint16_t) * 4>);
+
+static void BM_RPackingSnorm16(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RVector3> src(count);
+    std::vector<int16_t> dst(count * 3);
+    RBenchRandom random;
+    for (size_t i = 0; i < count; i++)
+        src[i].set(random.next(), random.next(), random.next());
+
+    for (auto _ : state)
+    {
+        RPacking::packSnorm16(src.data(), count, dst.data());
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RPackingSnorm16)->Apply(benchSizes<sizeof(RVector3) + sizeof(int16_t) * 3>);
+
+static void BM_RPackingOctahedral16(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RVector3> src(count);
+    std::vector<int16_t> dst(count * 2);
+    RBenchRandom random;
+    for (size_t i = 0; i < count; i++)
+        src[i].set(random.next(), random.next(), random.next());
+
+    for (auto _ : state)
+    {
+        RPacking::packOctahedral16(src.data(), count, dst.data());
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RPackingOctahedral16)->Apply(benchSizes<sizeof(RVector3) + sizeof(int16_t) * 2>);
+
+static void BM_RUnpackingOctahedral16(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<int16_t> src(count * 2);
+    std::vector<RVector3> dst(count);
+    RBenchRandom random;
+    for (size_t i = 0; i < src.size(); i++)
+        src[i] = (int16_t)random.next(-32767.0f, 32767.0f);
+
+    for (auto _ : state)
+    {
+        RPacking::unpackOctahedral16(src.data(), count, dst.data());
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RUnpackingOctahedral16)->Apply(benchSizes<sizeof(RVector3) + sizeof(int16_t) * 2>);
+
+static void BM_RPackingQuaternion32(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RQuaternion> src(count);
+    std::vector<uint32_t> dst(count);
+    RBenchRandom random;
+    for (size_t i = 0; i < count; i++)
+    {
+        src[i].set(random.next(), random.next(), random.next(), random.next());
+        src[i].normalize();
+    }
+
+    for (auto _ : state)
+    {
+        RPacking::packQuaternion32(src.data(), count, dst.data());
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RPackingQuaternion32)->Apply(benchSizes<sizeof(RQuaternion) + sizeof(uint32_t)>);
+
+}
@@ -0,0 +1,37 @@
+#include "RBenchmark.h"
+#include "math/RQuaternion.h"
+
+namespace rocket
+{
+
+static void BM_RQuaternionSlerp(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RQuaternion> from(count);
+    std::vector<RQuaternion> to(count);
+    std::vector<RQuaternion> dst(count);
+    std::vector<float> t(count);
+    RBenchRandom random;
+    for (size_t i = 0; i < count; i++)
+    {
+        from[i].set(random.next(), random.next(), random.next(), random.next());
+        from[i].normalize();
+        to[i].set(random.next(), random.next(), random.next(), random.next());
+        to[i].normalize();
+        t[i] = random.next(0.0f, 1.0f);
+    }
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            RQuaternion::slerp(from[i], to[i], t[i], &dst[i]);
+        }
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RQuaternionSlerp)->Apply(benchSizes<sizeof(RQuaternion) * 3 + sizeof(float)>);
+
+}
@@ -0,0 +1,105 @@
+#include "RBenchmark.h"
+#include "utilities/Random.h"
+
+namespace rocket
+{
+
+static void BM_RRandomStdRand(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<float> dst(count);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+            dst[i] = (float)rand() / RAND_MAX;
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RRandomStdRand)->Apply(benchSizes<sizeof(float)>);
+
+static void BM_RRandomNextFloat(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<float> dst(count);
+    RRandom random(1);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+            dst[i] = random.nextFloat();
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RRandomNextFloat)->Apply(benchSizes<sizeof(float)>);
+
+static void BM_RRandomFillFloat(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<float> dst(count);
+    RRandom random(1);
+
+    for (auto _ : state)
+    {
+        random.fillFloat(dst.data(), count, -1.0f, 1.0f);
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RRandomFillFloat)->Apply(benchSizes<sizeof(float)>);
+
+static void BM_RRandomNextUnitVector(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RVector3> dst(count);
+    RRandom random(1);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+            dst[i] = random.nextUnitVector();
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RRandomNextUnitVector)->Apply(benchSizes<sizeof(RVector3)>);
+
+static void BM_RRandomFillUnitVectors(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RVector3> dst(count);
+    RRandom random(1);
+
+    for (auto _ : state)
+    {
+        random.fillUnitVectors(dst.data(), count);
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RRandomFillUnitVectors)->Apply(benchSizes<sizeof(RVector3)>);
+
+static void BM_RRandomFillPointsInSphere(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RVector3> dst(count);
+    RRandom random(1);
+
+    for (auto _ : state)
+    {
+        random.fillPointsInSphere(dst.data(), count, RVector3::zero(), 10.0f);
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RRandomFillPointsInSphere)->Apply(benchSizes<sizeof(RVector3)>);
+
+}
@@ -0,0 +1,165 @@
+#include "RBenchmark.h"
+#include "math/RRectangleTree.h"
+
+namespace rocket
+{
+
+// UI/sprite-like layout: small rectangles scattered over a 4096x4096 canvas.
+static void fillRectangles(std::vector<RRectangle>& rects)
+{
+    RBenchRandom random;
+    for (size_t i = 0; i < rects.size(); i++)
+    {
+        rects[i].set(random.next(0.0f, 4096.0f), random.next(0.0f, 4096.0f), random.next(8.0f, 64.0f), random.next(8.0f, 64.0f));
+    }
+}
+
+static void fillTree(const std::vector<RRectangle>& rects, RRectangleTree* tree, std::vector<int>* ids)
+{
+    for (size_t i = 0; i < rects.size(); i++)
+    {
+        ids->push_back(tree->insert(rects[i]));
+    }
+}
+
+static const int QUERY_COUNT = 256;
+
+static void BM_RRectangleHitTestLinear(benchmark::State& state)
+{
+    std::vector<RRectangle> rects((size_t)state.range(0));
+    fillRectangles(rects);
+    RBenchRandom random(7);
+    std::vector<RVector2> points(QUERY_COUNT);
+    for (size_t i = 0; i < points.size(); i++)
+        points[i].set(random.next(0.0f, 4096.0f), random.next(0.0f, 4096.0f));
+
+    for (auto _ : state)
+    {
+        size_t hits = 0;
+        for (size_t q = 0; q < points.size(); q++)
+        {
+            for (size_t i = 0; i < rects.size(); i++)
+            {
+                hits += rects[i].contains(points[q].x, points[q].y) ? 1 : 0;
+            }
+        }
+        benchmark::DoNotOptimize(hits);
+    }
+    benchReport(state, QUERY_COUNT);
+}
+BENCHMARK(BM_RRectangleHitTestLinear)->ArgName("rects")->Arg(1000)->Arg(10000)->Arg(100000);
+
+static void BM_RRectangleHitTestTree(benchmark::State& state)
+{
+    std::vector<RRectangle> rects((size_t)state.range(0));
+    fillRectangles(rects);
+    RRectangleTree tree;
+    std::vector<int> ids;
+    fillTree(rects, &tree, &ids);
+    RBenchRandom random(7);
+    std::vector<RVector2> points(QUERY_COUNT);
+    for (size_t i = 0; i < points.size(); i++)
+        points[i].set(random.next(0.0f, 4096.0f), random.next(0.0f, 4096.0f));
+
+    std::vector<int> results;
+    for (auto _ : state)
+    {
+        results.clear();
+        for (size_t q = 0; q < points.size(); q++)
+        {
+            tree.query(points[q].x, points[q].y, &results);
+        }
+        benchmark::DoNotOptimize(results.data());
+    }
+    benchReport(state, QUERY_COUNT);
+}
+BENCHMARK(BM_RRectangleHitTestTree)->ArgName("rects")->Arg(1000)->Arg(10000)->Arg(100000);
+
+static void BM_RRectangleCullLinear(benchmark::State& state)
+{
+    std::vector<RRectangle> rects((size_t)state.range(0));
+    fillRectangles(rects);
+    RRectangle viewport(1024.0f, 1024.0f, 1280.0f, 720.0f);
+
+    for (auto _ : state)
+    {
+        size_t visible = 0;
+        for (size_t i = 0; i < rects.size(); i++)
+        {
+            visible += rects[i].intersects(viewport) ? 1 : 0;
+        }
+        benchmark::DoNotOptimize(visible);
+    }
+    benchReport(state, 1);
+}
+BENCHMARK(BM_RRectangleCullLinear)->ArgName("rects")->Arg(1000)->Arg(10000)->Arg(100000);
+
+static void BM_RRectangleCullTree(benchmark::State& state)
+{
+    std::vector<RRectangle> rects((size_t)state.range(0));
+    fillRectangles(rects);
+    RRectangleTree tree;
+    std::vector<int> ids;
+    fillTree(rects, &tree, &ids);
+    RRectangle viewport(1024.0f, 1024.0f, 1280.0f, 720.0f);
+
+    std::vector<int> results;
+    for (auto _ : state)
+    {
+        results.clear();
+        tree.query(viewport, &results);
+        benchmark::DoNotOptimize(results.data());
+    }
+    benchReport(state, 1);
+}
+BENCHMARK(BM_RRectangleCullTree)->ArgName("rects")->Arg(1000)->Arg(10000)->Arg(100000);
+
+static void BM_RRectangleTreeNearest(benchmark::State& state)
+{
+    std::vector<RRectangle> rects((size_t)state.range(0));
+    fillRectangles(rects);
+    RRectangleTree tree;
+    std::vector<int> ids;
+    fillTree(rects, &tree, &ids);
+    RBenchRandom random(7);
+    std::vector<RVector2> points(QUERY_COUNT);
+    for (size_t i = 0; i < points.size(); i++)
+        points[i].set(random.next(0.0f, 4096.0f), random.next(0.0f, 4096.0f));
+
+    for (auto _ : state)
+    {
+        int found = 0;
+        for (size_t q = 0; q < points.size(); q++)
+        {
+            found += tree.nearest(points[q].x, points[q].y);
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    benchReport(state, QUERY_COUNT);
+}
+BENCHMARK(BM_RRectangleTreeNearest)->ArgName("rects")->Arg(1000)->Arg(10000)->Arg(100000);
+
+static void BM_RRectangleTreeMove(benchmark::State& state)
+{
+    std::vector<RRectangle> rects((size_t)state.range(0));
+    fillRectangles(rects);
+    RRectangleTree tree;
+    std::vector<int> ids;
+    fillTree(rects, &tree, &ids);
+
+    // Every rectangle drifts one unit per frame, like scrolling widgets or moving sprites.
+    float offset = 1.0f;
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < rects.size(); i++)
+        {
+            rects[i].x += offset;
+            tree.move(ids[i], rects[i]);
+        }
+        offset = -offset;
+    }
+    benchReport(state, rects.size());
+}
+BENCHMARK(BM_RRectangleTreeMove)->ArgName("rects")->Arg(1000)->Arg(10000)->Arg(100000);
+
+}
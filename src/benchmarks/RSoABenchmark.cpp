@@ -0,0 +1,108 @@
+#include "RBenchmark.h"
+#include "math/RTransformArray.h"
+
+namespace rocket
+{
+
+static void BM_AoSNormalize(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    RBenchRandom random;
+    std::vector<RVector3> v(count);
+    for (size_t i = 0; i < count; i++)
+        v[i].set(random.next(-1.0f, 1.0f), random.next(-1.0f, 1.0f), random.next(-1.0f, 1.0f));
+    std::vector<RVector3> dst(count);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+            v[i].normalize(&dst[i]);
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_AoSNormalize)->Apply(benchSizes<2 * sizeof(RVector3)>);
+
+static void BM_SoANormalize(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    RBenchRandom random;
+    RVector3Array v(count);
+    for (size_t i = 0; i < count; i++)
+        v[i] = RVector3(random.next(-1.0f, 1.0f), random.next(-1.0f, 1.0f), random.next(-1.0f, 1.0f));
+    RVector3Array dst;
+
+    for (auto _ : state)
+    {
+        RVector3Array::normalize(v, &dst);
+        benchmark::DoNotOptimize(dst.getComponent(0));
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_SoANormalize)->Apply(benchSizes<2 * sizeof(RVector3)>);
+
+static void fillBenchTransform(RTransform* transform, RBenchRandom& random)
+{
+    RQuaternion rotation(random.next(-1.0f, 1.0f), random.next(-1.0f, 1.0f), random.next(-1.0f, 1.0f), random.next(-1.0f, 1.0f));
+    rotation.normalize();
+    transform->set(RVector3(random.next(0.5f, 2.0f), random.next(0.5f, 2.0f), random.next(0.5f, 2.0f)), rotation,
+                   RVector3(random.next(-10.0f, 10.0f), random.next(-10.0f, 10.0f), random.next(-10.0f, 10.0f)));
+}
+
+static void BM_AoSCompose(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    RBenchRandom random;
+    std::vector<RTransform> parents(count), locals(count), dst(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        fillBenchTransform(&parents[i], random);
+        fillBenchTransform(&locals[i], random);
+    }
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            const RTransform& p = parents[i];
+            const RTransform& l = locals[i];
+            RVector3 scale(p.getScale().x * l.getScale().x, p.getScale().y * l.getScale().y, p.getScale().z * l.getScale().z);
+            RVector3 translation(p.getScale().x * l.getTranslation().x, p.getScale().y * l.getTranslation().y,
+                                 p.getScale().z * l.getTranslation().z);
+            p.getRotation().rotatePoint(translation, &translation);
+            dst[i].set(scale, p.getRotation() * l.getRotation(), p.getTranslation() + translation);
+        }
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_AoSCompose)->Apply(benchSizes<3 * sizeof(RTransform)>);
+
+static void BM_SoACompose(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    RBenchRandom random;
+    RTransformArray parents(count), locals(count), dst;
+    RTransform transform;
+    for (size_t i = 0; i < count; i++)
+    {
+        fillBenchTransform(&transform, random);
+        parents.set(i, transform);
+        fillBenchTransform(&transform, random);
+        locals.set(i, transform);
+    }
+
+    for (auto _ : state)
+    {
+        RTransformArray::compose(parents, locals, &dst);
+        benchmark::DoNotOptimize(dst.getComponent(0));
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_SoACompose)->Apply(benchSizes<3 * sizeof(RTransform)>);
+
+}
@@ -0,0 +1,220 @@
+#include "RBenchmark.h"
+#include "graphics/RBlockCompressor.h"
+#include "graphics/RMipGenerator.h"
+#include "graphics/RTexture2D.h"
+#include "graphics/RTextureFile.h"
+#include "utilities/Noise.h"
+#ifdef ROCKET_BENCH_PNG
+    #include <png.h>
+#endif
+
+namespace rocket
+{
+
+// Loading a texture is measured from its bytes in memory (a mapped file in
+// the page cache) to the mips in a staging buffer, ready to upload. The
+// texture file stores the mips as uploaded; a PNG stores mip 0 only, which
+// must be decoded, filtered into mips and, for compressed formats, encoded.
+
+static void textureBenchArgs(benchmark::internal::Benchmark* b)
+{
+    b->ArgName("size");
+    b->Arg(256);
+    b->Arg(1024);
+}
+
+/**
+ * Builds a terrain-like RGBA8 image from fractal noise.
+ */
+static std::vector<uint8_t> makeBenchImage(unsigned int size)
+{
+    RNoise noise;
+    noise.setFrequency(1.0f / 64.0f);
+    noise.setFractal(RNoise::FBM, 4);
+    std::vector<float> height(size * size);
+    noise.fillGrid(0.0f, 0.0f, 1.0f, (int)size, (int)size, height.data());
+
+    std::vector<uint8_t> image(size * size * 4);
+    for (size_t i = 0; i < height.size(); i++)
+    {
+        float h = std::min(std::max(height[i] * 0.5f + 0.5f, 0.0f), 1.0f);
+        image[i * 4] = (uint8_t)(h * 120.0f + 40.0f);
+        image[i * 4 + 1] = (uint8_t)(h * 200.0f + 30.0f);
+        image[i * 4 + 2] = (uint8_t)(h * 60.0f + 20.0f);
+        image[i * 4 + 3] = 255;
+    }
+    return image;
+}
+
+static std::vector<uint8_t> makeBenchFile(unsigned int size, RTexture::Format format, bool supercompress)
+{
+    std::vector<uint8_t> image = makeBenchImage(size);
+    RTexture2D layout(size, size, format);
+    std::vector<uint8_t> chain(RMipGenerator::getChainSize(size, size, 1, 0));
+    RMipGenerator().generate(image.data(), size, size, 1, 0, chain.data());
+
+    std::vector<uint8_t> mips;
+    if (format == RTexture::FORMAT_RGBA8)
+        mips = chain;
+    else
+    {
+        RBlockCompressor compressor(RBlockCompressor::QUALITY_FAST);
+        mips.resize(layout.getChainSize(0));
+        size_t src = 0, dst = 0;
+        for (unsigned int mip = 0; mip < layout.getMipCount(); mip++)
+        {
+            compressor.compress(format, chain.data() + src, layout.getMipWidth(mip), layout.getMipHeight(mip), mips.data() + dst);
+            src += (size_t)layout.getMipWidth(mip) * layout.getMipHeight(mip) * 4;
+            dst += layout.getMipSize(mip);
+        }
+    }
+    std::vector<uint8_t> data;
+    RTextureFile::write(RTexture::TYPE_2D, format, size, size, 1, layout.getMipCount(), mips.data(), supercompress, &data);
+    return data;
+}
+
+static void benchTextureFile(benchmark::State& state, RTexture::Format format, bool supercompress)
+{
+    unsigned int size = (unsigned int)state.range(0);
+    std::vector<uint8_t> data = makeBenchFile(size, format, supercompress);
+    RTexture2D layout(size, size, format);
+    std::vector<uint8_t> staging(layout.getChainSize(0));
+
+    for (auto _ : state)
+    {
+        RTextureFile file;
+        file.openMemory(data.data(), data.size());
+        size_t offset = 0;
+        for (unsigned int mip = 0; mip < file.getHeader()->mipCount; mip++)
+        {
+            size_t mipSize = (size_t)file.getLevel(mip).uncompressedSize;
+            file.readMip(mip, staging.data() + offset, mipSize);
+            offset += mipSize;
+        }
+        benchmark::DoNotOptimize(staging.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["file_bytes"] = (double)data.size();
+    state.SetBytesProcessed(state.iterations() * (int64_t)staging.size());
+}
+
+static void BM_RTextureFileRGBA8(benchmark::State& state)
+{
+    benchTextureFile(state, RTexture::FORMAT_RGBA8, false);
+}
+BENCHMARK(BM_RTextureFileRGBA8)->Apply(textureBenchArgs);
+
+static void BM_RTextureFileRGBA8Supercompressed(benchmark::State& state)
+{
+    benchTextureFile(state, RTexture::FORMAT_RGBA8, true);
+}
+BENCHMARK(BM_RTextureFileRGBA8Supercompressed)->Apply(textureBenchArgs);
+
+static void BM_RTextureFileBC1Supercompressed(benchmark::State& state)
+{
+    benchTextureFile(state, RTexture::FORMAT_BC1, true);
+}
+BENCHMARK(BM_RTextureFileBC1Supercompressed)->Apply(textureBenchArgs);
+
+#ifdef ROCKET_BENCH_PNG
+
+static void writePngData(png_structp png, png_bytep data, png_size_t size)
+{
+    std::vector<uint8_t>* dst = (std::vector<uint8_t>*)png_get_io_ptr(png);
+    dst->insert(dst->end(), data, data + size);
+}
+
+static void flushPngData(png_structp)
+{
+}
+
+struct PngReader
+{
+    const uint8_t* data;
+    size_t offset;
+};
+
+static void readPngData(png_structp png, png_bytep data, png_size_t size)
+{
+    PngReader* reader = (PngReader*)png_get_io_ptr(png);
+    memcpy(data, reader->data + reader->offset, size);
+    reader->offset += size;
+}
+
+static std::vector<uint8_t> encodePng(const std::vector<uint8_t>& image, unsigned int size)
+{
+    std::vector<uint8_t> dst;
+    png_structp png = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = png_create_info_struct(png);
+    png_set_write_fn(png, &dst, writePngData, flushPngData);
+    png_set_IHDR(png, info, size, size, 8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(png, info);
+    for (unsigned int y = 0; y < size; y++)
+        png_write_row(png, image.data() + (size_t)y * size * 4);
+    png_write_end(png, NULL);
+    png_destroy_write_struct(&png, &info);
+    return dst;
+}
+
+static void decodePng(const std::vector<uint8_t>& data, unsigned int size, uint8_t* rgba)
+{
+    PngReader reader = { data.data(), 0 };
+    png_structp png = png_create_read_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop info = png_create_info_struct(png);
+    png_set_read_fn(png, &reader, readPngData);
+    png_read_info(png, info);
+    for (unsigned int y = 0; y < size; y++)
+        png_read_row(png, rgba + (size_t)y * size * 4, NULL);
+    png_read_end(png, NULL);
+    png_destroy_read_struct(&png, &info, NULL);
+}
+
+static void benchPng(benchmark::State& state, RTexture::Format format)
+{
+    unsigned int size = (unsigned int)state.range(0);
+    std::vector<uint8_t> data = encodePng(makeBenchImage(size), size);
+    RTexture2D layout(size, size, format);
+    RMipGenerator generator;
+    RBlockCompressor compressor(RBlockCompressor::QUALITY_FAST);
+    std::vector<uint8_t> image(size * size * 4);
+    std::vector<uint8_t> chain(RMipGenerator::getChainSize(size, size, 1, 0));
+    std::vector<uint8_t> staging(layout.getChainSize(0));
+
+    for (auto _ : state)
+    {
+        decodePng(data, size, image.data());
+        generator.generate(image.data(), size, size, 1, 0, chain.data());
+        if (format != RTexture::FORMAT_RGBA8)
+        {
+            size_t src = 0, dst = 0;
+            for (unsigned int mip = 0; mip < layout.getMipCount(); mip++)
+            {
+                compressor.compress(format, chain.data() + src, layout.getMipWidth(mip), layout.getMipHeight(mip), staging.data() + dst);
+                src += (size_t)layout.getMipWidth(mip) * layout.getMipHeight(mip) * 4;
+                dst += layout.getMipSize(mip);
+            }
+        }
+        benchmark::DoNotOptimize(chain.data());
+        benchmark::DoNotOptimize(staging.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["file_bytes"] = (double)data.size();
+    state.SetBytesProcessed(state.iterations() * (int64_t)staging.size());
+}
+
+static void BM_RTexturePngRGBA8(benchmark::State& state)
+{
+    benchPng(state, RTexture::FORMAT_RGBA8);
+}
+BENCHMARK(BM_RTexturePngRGBA8)->Apply(textureBenchArgs);
+
+static void BM_RTexturePngBC1(benchmark::State& state)
+{
+    benchPng(state, RTexture::FORMAT_BC1);
+}
+BENCHMARK(BM_RTexturePngBC1)->Apply(textureBenchArgs);
+
+#endif
+
+}
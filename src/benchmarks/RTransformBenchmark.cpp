@@ -0,0 +1,63 @@
+#include "RBenchmark.h"
+#include "math/RTransform.h"
+#include "math/RWorldTransform.h"
+
+namespace rocket
+{
+
+static void BM_RTransformGetMatrix(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RTransform> transforms(count);
+    std::vector<RVector3> translations(count);
+    RBenchRandom random;
+    for (size_t i = 0; i < count; i++)
+    {
+        RQuaternion rotation(random.next(), random.next(), random.next(), random.next());
+        rotation.normalize();
+        transforms[i].set(RVector3(random.next(0.5f, 2.0f), random.next(0.5f, 2.0f), random.next(0.5f, 2.0f)), rotation, RVector3::zero());
+        translations[i].set(random.next(-100.0f, 100.0f), random.next(-100.0f, 100.0f), random.next(-100.0f, 100.0f));
+    }
+
+    float sum = 0.0f;
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            // Dirty the transform so getMatrix() has to recompose it.
+            transforms[i].setTranslation(translations[i]);
+            sum += transforms[i].getMatrix().m[12];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RTransformGetMatrix)->Apply(benchSizes<sizeof(RTransform) + sizeof(RVector3)>);
+
+static void BM_RWorldTransformRebase(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RMatrix> rotationScales(count);
+    std::vector<RVector3d> translations(count);
+    std::vector<RMatrix> dst(count);
+    RBenchRandom random;
+    for (size_t i = 0; i < count; i++)
+    {
+        RQuaternion rotation(random.next(), random.next(), random.next(), random.next());
+        rotation.normalize();
+        RMatrix::createRotation(rotation, &rotationScales[i]);
+        translations[i].set(random.next(-32000.0f, 32000.0f), random.next(-100.0f, 100.0f), random.next(-32000.0f, 32000.0f));
+    }
+    RVector3d camera(31000.25, 12.5, -30500.75);
+
+    for (auto _ : state)
+    {
+        RWorldTransform::rebase(camera, rotationScales.data(), translations.data(), count, dst.data());
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RWorldTransformRebase)->Apply(benchSizes<sizeof(RMatrix) * 2 + sizeof(RVector3d)>);
+
+}
@@ -0,0 +1,31 @@
+#include "RBenchmark.h"
+#include "math/RVector3.h"
+
+namespace rocket
+{
+
+static void BM_RVector3Normalize(benchmark::State& state)
+{
+    const size_t count = (size_t)state.range(0);
+    std::vector<RVector3> src(count);
+    std::vector<RVector3> dst(count);
+    RBenchRandom random;
+    for (size_t i = 0; i < count; i++)
+    {
+        src[i].set(random.next(-100.0f, 100.0f), random.next(-100.0f, 100.0f), random.next(-100.0f, 100.0f));
+    }
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            src[i].normalize(&dst[i]);
+        }
+        benchmark::DoNotOptimize(dst.data());
+        benchmark::ClobberMemory();
+    }
+    benchReport(state, count);
+}
+BENCHMARK(BM_RVector3Normalize)->Apply(benchSizes<sizeof(RVector3) * 2>);
+
+}
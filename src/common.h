@@ -39,8 +39,8 @@
 
 #define MATH_DEG_TO_RAD(x)          ((x) * 0.0174532925f)
 #define MATH_RAD_TO_DEG(x)          ((x)* 57.29577951f)
-#define MATH_RANDOM_MINUS1_1()      ((2.0f*((float)rand()/RAND_MAX))-1.0f)      // Returns a random float between -1 and 1.
-#define MATH_RANDOM_0_1()           ((float)rand()/RAND_MAX)                    // Returns a random float between 0 and 1.
+#define MATH_RANDOM_MINUS1_1()      (rocket::RRandom::getLocal().nextFloat(-1.0f, 1.0f))  // Returns a random float between -1 and 1.
+#define MATH_RANDOM_0_1()           (rocket::RRandom::getLocal().nextFloat())              // Returns a random float in [0, 1).
 #define MATH_FLOAT_SMALL            1.0e-37f
 #define MATH_TOLERANCE              2e-37f
 #define MATH_E                      2.71828182845904523536f
@@ -63,12 +63,18 @@ namespace rocket
     class RQuaternion;
     class RVector2;
     class RVector3;
+    class RVector3d;
     class RVector4;
     class RBoundingBox;
     class RBoundingSphere;
+    class RCurve;
     class RFrustum;
     class RPlane;
     class RRay;
+    class RWorldTransform;
+
+    class RNoise;
+    class RRandom;
 
     class REngine;
     class RWindow;
@@ -85,12 +91,15 @@ namespace rocket
 #include "math/RQuaternion.h"
 #include "math/RVector2.h"
 #include "math/RVector3.h"
+#include "math/RVector3d.h"
 #include "math/RVector4.h"
 #include "math/RBoundingBox.h"
 #include "math/RBoundingSphere.h"
+#include "math/RCurve.h"
 #include "math/RFrustum.h"
 #include "math/RPlane.h"
 #include "math/RRay.h"
+#include "math/RWorldTransform.h"
 
 // -- CORE -- //
 #include "REngine.h"
@@ -103,9 +112,17 @@ namespace rocket
 #include "input/RMouse.h"
 #include "input/RGameController.h"
 // -- GFX -- //
+#include "graphics/RDrawCommand.h"
+#include "graphics/RCommandBuffer.h"
+#include "graphics/RCommandQueue.h"
+#include "graphics/RRenderBackend.h"
 
 // -- AUDIO -- //
 
 // -- NET -- //
 
-// -- UI -- //
\ No newline at end of file
+// -- UI -- //
+
+// -- UTILITIES -- //
+#include "utilities/Noise.h"
+#include "utilities/Random.h"
\ No newline at end of file
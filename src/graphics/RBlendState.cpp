@@ -0,0 +1,111 @@
+#include "common.h"
+#include "RBlendState.h"
+
+namespace rocket
+{
+
+static std::mutex blendStatesMutex;
+static std::unordered_multimap<size_t, RBlendState*> blendStates;
+
+static inline size_t hashCombine(size_t hash, size_t value)
+{
+    return hash ^ (value + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2));
+}
+
+static inline bool equals(const RBlendState::Description& a, const RBlendState::Description& b)
+{
+    return a.enabled == b.enabled && a.srcColor == b.srcColor && a.dstColor == b.dstColor &&
+           a.colorEquation == b.colorEquation && a.srcAlpha == b.srcAlpha && a.dstAlpha == b.dstAlpha &&
+           a.alphaEquation == b.alphaEquation && a.writeMask == b.writeMask;
+}
+
+static RBlendState::Description createBlending(RBlendState::Blend srcColor, RBlendState::Blend dstColor,
+                                               RBlendState::Blend srcAlpha, RBlendState::Blend dstAlpha)
+{
+    RBlendState::Description description;
+    description.enabled = true;
+    description.srcColor = srcColor;
+    description.dstColor = dstColor;
+    description.srcAlpha = srcAlpha;
+    description.dstAlpha = dstAlpha;
+    return description;
+}
+
+RBlendState::Description::Description()
+    : enabled(false), srcColor(BLEND_ONE), dstColor(BLEND_ZERO), colorEquation(EQUATION_ADD),
+      srcAlpha(BLEND_ONE), dstAlpha(BLEND_ZERO), alphaEquation(EQUATION_ADD), writeMask(WRITE_ALL)
+{
+}
+
+RBlendState::RBlendState(const Description& description, size_t hash)
+    : _description(description), _hash(hash)
+{
+}
+
+const RBlendState* RBlendState::get(const Description& description)
+{
+    Description canonical = description;
+    canonical.writeMask &= WRITE_ALL;
+    if (!canonical.enabled)
+    {
+        unsigned int writeMask = canonical.writeMask;
+        canonical = Description();
+        canonical.writeMask = writeMask;
+    }
+
+    size_t hash = (size_t)canonical.enabled;
+    hash = hashCombine(hash, (size_t)canonical.srcColor);
+    hash = hashCombine(hash, (size_t)canonical.dstColor);
+    hash = hashCombine(hash, (size_t)canonical.colorEquation);
+    hash = hashCombine(hash, (size_t)canonical.srcAlpha);
+    hash = hashCombine(hash, (size_t)canonical.dstAlpha);
+    hash = hashCombine(hash, (size_t)canonical.alphaEquation);
+    hash = hashCombine(hash, (size_t)canonical.writeMask);
+
+    std::lock_guard<std::mutex> lock(blendStatesMutex);
+    auto range = blendStates.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        if (equals(it->second->_description, canonical))
+            return it->second;
+    }
+    RBlendState* state = new RBlendState(canonical, hash);
+    blendStates.insert(std::make_pair(hash, state));
+    return state;
+}
+
+const RBlendState* RBlendState::getOpaque()
+{
+    static const RBlendState* state = get(Description());
+    return state;
+}
+
+const RBlendState* RBlendState::getAlpha()
+{
+    static const RBlendState* state = get(createBlending(BLEND_SRC_ALPHA, BLEND_ONE_MINUS_SRC_ALPHA, BLEND_ONE, BLEND_ONE_MINUS_SRC_ALPHA));
+    return state;
+}
+
+const RBlendState* RBlendState::getPremultiplied()
+{
+    static const RBlendState* state = get(createBlending(BLEND_ONE, BLEND_ONE_MINUS_SRC_ALPHA, BLEND_ONE, BLEND_ONE_MINUS_SRC_ALPHA));
+    return state;
+}
+
+const RBlendState* RBlendState::getAdditive()
+{
+    static const RBlendState* state = get(createBlending(BLEND_SRC_ALPHA, BLEND_ONE, BLEND_ONE, BLEND_ONE));
+    return state;
+}
+
+const RBlendState::Description& RBlendState::getDescription() const
+{
+    return _description;
+}
+
+size_t RBlendState::getHash() const
+{
+    return _hash;
+}
+
+}
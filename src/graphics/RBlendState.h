@@ -0,0 +1,139 @@
+#pragma once
+
+#include "common.h"
+#include "RGL.h"
+
+namespace rocket
+{
+
+/**
+ * Defines an immutable blend state.
+ *
+ * States are created with get(), which returns the same object for equal
+ * descriptions, so two states are equal if and only if their pointers are.
+ * RGLStateCache relies on this to skip binding a state that is already
+ * bound with a single comparison. States live until the program exits.
+ */
+class API RBlendState
+{
+public:
+
+    /**
+     * Blend factors.
+     */
+    enum Blend
+    {
+        BLEND_ZERO = GL_ZERO,
+        BLEND_ONE = GL_ONE,
+        BLEND_SRC_COLOR = GL_SRC_COLOR,
+        BLEND_ONE_MINUS_SRC_COLOR = GL_ONE_MINUS_SRC_COLOR,
+        BLEND_DST_COLOR = GL_DST_COLOR,
+        BLEND_ONE_MINUS_DST_COLOR = GL_ONE_MINUS_DST_COLOR,
+        BLEND_SRC_ALPHA = GL_SRC_ALPHA,
+        BLEND_ONE_MINUS_SRC_ALPHA = GL_ONE_MINUS_SRC_ALPHA,
+        BLEND_DST_ALPHA = GL_DST_ALPHA,
+        BLEND_ONE_MINUS_DST_ALPHA = GL_ONE_MINUS_DST_ALPHA,
+        BLEND_SRC_ALPHA_SATURATE = GL_SRC_ALPHA_SATURATE
+    };
+
+    /**
+     * Blend equations.
+     */
+    enum Equation
+    {
+        EQUATION_ADD = GL_FUNC_ADD,
+        EQUATION_SUBTRACT = GL_FUNC_SUBTRACT,
+        EQUATION_REVERSE_SUBTRACT = GL_FUNC_REVERSE_SUBTRACT,
+        EQUATION_MIN = GL_MIN,
+        EQUATION_MAX = GL_MAX
+    };
+
+    /**
+     * Color write mask bits.
+     */
+    enum WriteMask
+    {
+        WRITE_RED = 1,
+        WRITE_GREEN = 2,
+        WRITE_BLUE = 4,
+        WRITE_ALPHA = 8,
+        WRITE_ALL = 15
+    };
+
+    /**
+     * Describes a blend state. Defaults to blending disabled, writing all channels.
+     */
+    struct Description
+    {
+        Description();
+
+        bool enabled;
+        Blend srcColor;
+        Blend dstColor;
+        Equation colorEquation;
+        Blend srcAlpha;
+        Blend dstAlpha;
+        Equation alphaEquation;
+        unsigned int writeMask;
+    };
+
+    /**
+     * Gets the state for a description, creating it on first use.
+     *
+     * Factors and equations of a disabled state are ignored, so all
+     * disabled states with the same write mask are the same object.
+     * Thread safe.
+     *
+     * @param description The description.
+     *
+     * @return The shared state.
+     */
+    static const RBlendState* get(const Description& description);
+
+    /**
+     * Gets the opaque state, blending disabled.
+     */
+    static const RBlendState* getOpaque();
+
+    /**
+     * Gets the state for alpha blending, src * srcAlpha + dst * (1 - srcAlpha).
+     */
+    static const RBlendState* getAlpha();
+
+    /**
+     * Gets the state for premultiplied alpha blending, src + dst * (1 - srcAlpha).
+     */
+    static const RBlendState* getPremultiplied();
+
+    /**
+     * Gets the state for additive blending, src * srcAlpha + dst.
+     */
+    static const RBlendState* getAdditive();
+
+    /**
+     * Gets the description of this state.
+     *
+     * @return The description.
+     */
+    const Description& getDescription() const;
+
+    /**
+     * Gets the hash of the description.
+     *
+     * @return The hash.
+     */
+    size_t getHash() const;
+
+private:
+
+    RBlendState(const Description& description, size_t hash);
+
+    RBlendState(const RBlendState& copy);
+
+    RBlendState& operator=(const RBlendState&);
+
+    Description _description;
+    size_t _hash;
+};
+
+}
@@ -0,0 +1,1131 @@
+#include "common.h"
+#include "RBlockCompressor.h"
+#include "math/RSimd.h"
+#include <cfloat>
+
+namespace rocket
+{
+
+// The fewest block rows worth a thread of their own.
+#define BLOCK_PARALLEL_MIN_ROWS     4
+// The power iterations that find the principal axis of a block.
+#define BLOCK_AXIS_ITERATIONS       8
+
+// The BC7 interpolation weights of 2, 3 and 4-bit indices, out of 64.
+static const int BLOCK_WEIGHTS2[4] = { 0, 21, 43, 64 };
+static const int BLOCK_WEIGHTS3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const int BLOCK_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// The BC7 two-subset partitions, bit i is set when pixel i is in subset 1.
+static const uint16_t BLOCK_PARTITIONS2[64] =
+{
+    0xcccc, 0x8888, 0xeeee, 0xecc8, 0xc880, 0xfeec, 0xfec8, 0xec80,
+    0xc800, 0xffec, 0xfe80, 0xe800, 0xffe8, 0xff00, 0xfff0, 0xf000,
+    0xf710, 0x008e, 0x7100, 0x08ce, 0x008c, 0x7310, 0x3100, 0x8cce,
+    0x088c, 0x3110, 0x6666, 0x366c, 0x17e8, 0x0ff0, 0x718e, 0x399c,
+    0xaaaa, 0xf0f0, 0x5a5a, 0x33cc, 0x3c3c, 0x55aa, 0x9696, 0xa55a,
+    0x73ce, 0x13c8, 0x324c, 0x3bdc, 0x6996, 0xc33c, 0x9966, 0x0660,
+    0x0272, 0x04e4, 0x4e40, 0x2720, 0xc936, 0x936c, 0x39c6, 0x639c,
+    0x9336, 0x9cc6, 0x817e, 0xe718, 0xccf0, 0x0fcc, 0x7744, 0xee22
+};
+
+// The pixel of subset 1 whose index has an implicit leading 0, per two-subset partition.
+static const uint8_t BLOCK_ANCHORS2[64] =
+{
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15, 15, 15, 15, 15, 15, 15, 15,
+    15,  2,  8,  2,  2,  8,  8, 15,
+     2,  8,  2,  2,  8,  8,  2,  2,
+    15, 15,  6,  8,  2,  8, 15, 15,
+     2,  8,  2,  2,  2, 15, 15,  6,
+     6,  2,  6,  8, 15, 15,  2,  2,
+    15, 15, 15, 15, 15,  2,  2, 15
+};
+
+// The BC7 three-subset partitions, bits 2i and 2i + 1 hold the subset of pixel i.
+static const uint32_t BLOCK_PARTITIONS3[64] =
+{
+    0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8, 0xa5a50000, 0xa0a05050, 0x5555a0a0, 0x5a5a5050,
+    0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090, 0x94949494, 0xa4a4a4a4, 0xa9a59450, 0x2a0a4250,
+    0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0, 0xa8a85454, 0x6a6a4040, 0xa4a45000, 0x1a1a0500,
+    0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400, 0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200,
+    0xa9a58000, 0x5090a0a8, 0xa8a09050, 0x24242424, 0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50,
+    0x500aa550, 0xaaaa4444, 0x66660000, 0xa5a0a5a0, 0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600,
+    0xaa444444, 0x54a854a8, 0x95809580, 0x96969600, 0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+    0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000, 0x40804080, 0xa9a8a9a8, 0xaaaaaa44, 0x2a4a5254
+};
+
+// The pixels of subsets 1 and 2 whose indices have an implicit leading 0, per three-subset partition.
+static const uint8_t BLOCK_ANCHORS3[64][2] =
+{
+    {  3, 15 }, {  3,  8 }, { 15,  8 }, { 15,  3 }, {  8, 15 }, {  3, 15 }, { 15,  3 }, { 15,  8 },
+    {  8, 15 }, {  8, 15 }, {  6, 15 }, {  6, 15 }, {  6, 15 }, {  5, 15 }, {  3, 15 }, {  3,  8 },
+    {  3, 15 }, {  3,  8 }, {  8, 15 }, { 15,  3 }, {  3, 15 }, {  3,  8 }, {  6, 15 }, { 10,  8 },
+    {  5,  3 }, {  8, 15 }, {  8,  6 }, {  6, 10 }, {  8, 15 }, {  5, 15 }, { 15, 10 }, { 15,  8 },
+    {  8, 15 }, { 15,  3 }, {  3, 15 }, {  5, 10 }, {  6, 10 }, { 10,  8 }, {  8,  9 }, { 15, 10 },
+    { 15,  6 }, {  3, 15 }, { 15,  8 }, {  5, 15 }, { 15,  3 }, { 15,  6 }, { 15,  6 }, { 15,  8 },
+    {  3, 15 }, { 15,  3 }, {  5, 15 }, {  5, 15 }, {  5, 15 }, {  8, 15 }, {  5, 15 }, { 10, 15 },
+    {  5, 15 }, { 10, 15 }, {  8, 15 }, { 13, 15 }, { 15,  3 }, { 12, 15 }, {  3, 15 }, {  3,  8 }
+};
+
+/**
+ * The layout of a BC7 mode.
+ */
+struct BlockMode
+{
+    unsigned int subsets;
+    unsigned int partitionBits;
+    unsigned int rotationBits;
+    unsigned int selectionBits;
+    unsigned int colorBits;
+    unsigned int alphaBits;
+    unsigned int endpointPBits;
+    unsigned int sharedPBits;
+    unsigned int indexBits;
+    unsigned int indexBits2;
+};
+
+static const BlockMode BLOCK_MODES[8] =
+{
+    { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+    { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+    { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+    { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+    { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+    { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+    { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+    { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+};
+
+/**
+ * The 16 pixels of a block, one array of 0 to 255 values per channel.
+ */
+struct BlockPixels
+{
+    float channels[4][16];
+};
+
+/**
+ * Writes a block bit by bit, least significant bit first.
+ */
+struct BlockWriter
+{
+    uint8_t* data;
+    unsigned int position;
+
+    void write(uint32_t value, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i++, position++)
+        {
+            if ((value >> i) & 1)
+                data[position >> 3] |= (uint8_t)(1 << (position & 7));
+        }
+    }
+};
+
+/**
+ * Reads a block bit by bit, least significant bit first.
+ */
+struct BlockReader
+{
+    const uint8_t* data;
+    unsigned int position;
+
+    uint32_t read(unsigned int count)
+    {
+        uint32_t value = 0;
+        for (unsigned int i = 0; i < count; i++, position++)
+            value |= (uint32_t)((data[position >> 3] >> (position & 7)) & 1) << i;
+        return value;
+    }
+};
+
+static inline void loadBlock(const uint8_t* rgba, BlockPixels* block)
+{
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        for (unsigned int c = 0; c < 4; c++)
+            block->channels[c][i] = (float)rgba[i * 4 + c];
+    }
+}
+
+static inline float clampColor(float value)
+{
+    return std::min(std::max(value, 0.0f), 255.0f);
+}
+
+/**
+ * Chooses for each pixel the nearest palette entry, and returns the squared
+ * error summed over the pixels, each scaled by its weight (NULL for 1).
+ */
+static inline float findIndices(const BlockPixels& block, const float* weights, const float (*palette)[4],
+                                unsigned int count, unsigned int channels, uint8_t* indices)
+{
+    float errors[16];
+    float chosen[16];
+    simdForEach(16, [&](auto lane, size_t i)
+    {
+        typedef decltype(lane) F;
+        F bestError(FLT_MAX);
+        F bestIndex(0.0f);
+        for (unsigned int e = 0; e < count; e++)
+        {
+            F error(0.0f);
+            for (unsigned int c = 0; c < channels; c++)
+            {
+                F d = F::load(block.channels[c] + i) - F(palette[e][c]);
+                error = error + d * d;
+            }
+            F closer = error < bestError;
+            bestError = simdSelect(closer, error, bestError);
+            bestIndex = simdSelect(closer, F((float)e), bestIndex);
+        }
+        if (weights)
+            bestError = bestError * F::load(weights + i);
+        bestError.store(errors + i);
+        bestIndex.store(chosen + i);
+    });
+
+    float total = 0.0f;
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        indices[i] = (uint8_t)chosen[i];
+        total += errors[i];
+    }
+    return total;
+}
+
+/**
+ * Fits a line to the pixels of a subset along their principal axis, and
+ * returns the squared distance of the pixels to the line.
+ */
+static inline float fitAxis(const BlockPixels& block, const float* subsets, unsigned int subset, unsigned int channels,
+                            float* low, float* high)
+{
+    float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    unsigned int count = 0;
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        if (subsets && subsets[i] != (float)subset)
+            continue;
+        for (unsigned int c = 0; c < channels; c++)
+            mean[c] += block.channels[c][i];
+        count++;
+    }
+    if (count == 0)
+    {
+        for (unsigned int c = 0; c < channels; c++)
+            low[c] = high[c] = 0.0f;
+        return 0.0f;
+    }
+    for (unsigned int c = 0; c < channels; c++)
+        mean[c] /= (float)count;
+
+    float covariance[4][4] = {};
+    float total = 0.0f;
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        if (subsets && subsets[i] != (float)subset)
+            continue;
+        float d[4];
+        for (unsigned int c = 0; c < channels; c++)
+            d[c] = block.channels[c][i] - mean[c];
+        for (unsigned int a = 0; a < channels; a++)
+        {
+            for (unsigned int b = 0; b < channels; b++)
+                covariance[a][b] += d[a] * d[b];
+            total += d[a] * d[a];
+        }
+    }
+
+    // Power iteration from the row of the largest variance.
+    float axis[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    unsigned int largest = 0;
+    for (unsigned int c = 1; c < channels; c++)
+    {
+        if (covariance[c][c] > covariance[largest][largest])
+            largest = c;
+    }
+    for (unsigned int c = 0; c < channels; c++)
+        axis[c] = covariance[largest][c];
+    for (unsigned int iteration = 0; iteration < BLOCK_AXIS_ITERATIONS; iteration++)
+    {
+        float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        float scale = 0.0f;
+        for (unsigned int a = 0; a < channels; a++)
+        {
+            for (unsigned int b = 0; b < channels; b++)
+                next[a] += covariance[a][b] * axis[b];
+            scale = std::max(scale, std::fabs(next[a]));
+        }
+        if (scale == 0.0f)
+            break;
+        for (unsigned int c = 0; c < channels; c++)
+            axis[c] = next[c] / scale;
+    }
+    float length = 0.0f;
+    for (unsigned int c = 0; c < channels; c++)
+        length += axis[c] * axis[c];
+    if (length == 0.0f)
+    {
+        for (unsigned int c = 0; c < channels; c++)
+            low[c] = high[c] = mean[c];
+        return total;
+    }
+    length = std::sqrt(length);
+    for (unsigned int c = 0; c < channels; c++)
+        axis[c] /= length;
+
+    float minimum = FLT_MAX;
+    float maximum = -FLT_MAX;
+    float projected = 0.0f;
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        if (subsets && subsets[i] != (float)subset)
+            continue;
+        float t = 0.0f;
+        for (unsigned int c = 0; c < channels; c++)
+            t += (block.channels[c][i] - mean[c]) * axis[c];
+        minimum = std::min(minimum, t);
+        maximum = std::max(maximum, t);
+        projected += t * t;
+    }
+    for (unsigned int c = 0; c < channels; c++)
+    {
+        low[c] = clampColor(mean[c] + axis[c] * minimum);
+        high[c] = clampColor(mean[c] + axis[c] * maximum);
+    }
+    return std::max(total - projected, 0.0f);
+}
+
+/**
+ * Solves the endpoints that best reproduce the pixels of a subset with the
+ * given indices, where index i interpolates (1 - weights[i]) * e0 + weights[i] * e1.
+ *
+ * @return false if the indices do not determine both endpoints.
+ */
+static inline bool refineEndpoints(const BlockPixels& block, const float* subsets, unsigned int subset, unsigned int channels,
+                                   const uint8_t* indices, const float* weights, float* e0, float* e1)
+{
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    float bx[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        if (subsets && subsets[i] != (float)subset)
+            continue;
+        float b = weights[indices[i]];
+        float a = 1.0f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (unsigned int c = 0; c < channels; c++)
+        {
+            ax[c] += a * block.channels[c][i];
+            bx[c] += b * block.channels[c][i];
+        }
+    }
+    float determinant = aa * bb - ab * ab;
+    if (std::fabs(determinant) < 1e-6f)
+        return false;
+    for (unsigned int c = 0; c < channels; c++)
+    {
+        e0[c] = clampColor((ax[c] * bb - bx[c] * ab) / determinant);
+        e1[c] = clampColor((bx[c] * aa - ax[c] * ab) / determinant);
+    }
+    return true;
+}
+
+static inline unsigned int getRefinements(RBlockCompressor::Quality quality)
+{
+    switch (quality)
+    {
+    case RBlockCompressor::QUALITY_FAST:
+        return 0;
+    case RBlockCompressor::QUALITY_NORMAL:
+        return 2;
+    case RBlockCompressor::QUALITY_HIGH:
+        return 8;
+    }
+    return 0;
+}
+
+static inline uint16_t packColor565(const float* color)
+{
+    unsigned int r = (unsigned int)(color[0] * (31.0f / 255.0f) + 0.5f);
+    unsigned int g = (unsigned int)(color[1] * (63.0f / 255.0f) + 0.5f);
+    unsigned int b = (unsigned int)(color[2] * (31.0f / 255.0f) + 0.5f);
+    return (uint16_t)((r << 11) | (g << 5) | b);
+}
+
+static inline void getBC1Palette(uint16_t c0, uint16_t c1, bool fourColors, int (*palette)[4])
+{
+    const uint16_t colors[2] = { c0, c1 };
+    for (unsigned int e = 0; e < 2; e++)
+    {
+        int r = (colors[e] >> 11) & 31;
+        int g = (colors[e] >> 5) & 63;
+        int b = colors[e] & 31;
+        palette[e][0] = (r << 3) | (r >> 2);
+        palette[e][1] = (g << 2) | (g >> 4);
+        palette[e][2] = (b << 3) | (b >> 2);
+        palette[e][3] = 255;
+    }
+    for (unsigned int c = 0; c < 3; c++)
+    {
+        if (fourColors)
+        {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c] + 1) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c] + 1) / 3;
+        }
+        else
+        {
+            palette[2][c] = (palette[0][c] + palette[1][c] + 1) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = fourColors ? 255 : 0;
+}
+
+static inline void getBC4Palette(int a0, int a1, int* palette)
+{
+    palette[0] = a0;
+    palette[1] = a1;
+    if (a0 > a1)
+    {
+        for (int i = 2; i < 8; i++)
+            palette[i] = ((8 - i) * a0 + (i - 1) * a1 + 3) / 7;
+    }
+    else
+    {
+        for (int i = 2; i < 6; i++)
+            palette[i] = ((6 - i) * a0 + (i - 1) * a1 + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+static inline int expandEndpoint(int value, unsigned int bits, int pbit)
+{
+    if (pbit >= 0)
+    {
+        value = (value << 1) | pbit;
+        bits++;
+    }
+    value <<= 8 - bits;
+    return value | (value >> bits);
+}
+
+/**
+ * Finds the value of bits bits, followed by a p-bit when pbit >= 0, that expands closest to a color.
+ */
+static inline int quantizeEndpoint(float color, unsigned int bits, int pbit)
+{
+    int maximum = (1 << bits) - 1;
+    unsigned int total = bits + (pbit >= 0 ? 1 : 0);
+    float scaled = color * (float)((1 << total) - 1) / 255.0f;
+    int guess = (int)((pbit >= 0 ? (scaled - (float)pbit) * 0.5f : scaled) + 0.5f);
+    int best = 0;
+    float bestError = FLT_MAX;
+    for (int q = std::max(guess - 1, 0); q <= std::min(guess + 1, maximum); q++)
+    {
+        float error = std::fabs((float)expandEndpoint(q, bits, pbit) - color);
+        if (error < bestError)
+        {
+            bestError = error;
+            best = q;
+        }
+    }
+    return best;
+}
+
+static inline int interpolate(int e0, int e1, int weight)
+{
+    return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+}
+
+static void encodeBC1(const BlockPixels& block, uint8_t* dst, RBlockCompressor::Quality quality, bool alwaysFourColors)
+{
+    // Pixels with alpha below 128 are punched through with index 3 of the three color mode.
+    float transparent[16];
+    float opaque[16];
+    bool punchThrough = false;
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        bool clear = !alwaysFourColors && block.channels[3][i] < 128.0f;
+        transparent[i] = clear ? 1.0f : 0.0f;
+        opaque[i] = clear ? 0.0f : 1.0f;
+        punchThrough |= clear;
+    }
+
+    float e0[3], e1[3];
+    fitAxis(block, transparent, 0, 3, e1, e0);
+
+    static const float fourWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    static const float threeWeights[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+    float bestError = FLT_MAX;
+    uint16_t bestColors[2] = { 0, 0 };
+    uint8_t bestIndices[16] = {};
+    unsigned int refinements = getRefinements(quality);
+    for (unsigned int refinement = 0; refinement <= refinements; refinement++)
+    {
+        uint16_t c0 = packColor565(e0);
+        uint16_t c1 = packColor565(e1);
+        if ((punchThrough && c0 > c1) || (!punchThrough && c0 < c1))
+            std::swap(c0, c1);
+        bool fourColors = alwaysFourColors || c0 > c1;
+
+        int colors[4][4];
+        getBC1Palette(c0, c1, fourColors, colors);
+        float palette[4][4];
+        for (unsigned int e = 0; e < 4; e++)
+        {
+            for (unsigned int c = 0; c < 4; c++)
+                palette[e][c] = (float)colors[e][c];
+        }
+
+        uint8_t indices[16];
+        float error = findIndices(block, opaque, palette, fourColors ? 4 : 3, 3, indices);
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            if (transparent[i] != 0.0f)
+                indices[i] = 3;
+        }
+        if (error < bestError)
+        {
+            bestError = error;
+            bestColors[0] = c0;
+            bestColors[1] = c1;
+            memcpy(bestIndices, indices, sizeof(indices));
+        }
+        if (refinement == refinements || bestError == 0.0f)
+            break;
+        const float* weights = fourColors ? fourWeights : threeWeights;
+        if (!refineEndpoints(block, transparent, 0, 3, indices, weights, e0, e1))
+            break;
+    }
+
+    uint32_t bits = 0;
+    for (unsigned int i = 0; i < 16; i++)
+        bits |= (uint32_t)bestIndices[i] << (i * 2);
+    dst[0] = (uint8_t)bestColors[0];
+    dst[1] = (uint8_t)(bestColors[0] >> 8);
+    dst[2] = (uint8_t)bestColors[1];
+    dst[3] = (uint8_t)(bestColors[1] >> 8);
+    for (unsigned int b = 0; b < 4; b++)
+        dst[4 + b] = (uint8_t)(bits >> (b * 8));
+}
+
+static inline float tryBC4(const BlockPixels& single, int a0, int a1, uint8_t* indices)
+{
+    int values[8];
+    getBC4Palette(a0, a1, values);
+    float palette[8][4] = {};
+    for (unsigned int e = 0; e < 8; e++)
+        palette[e][0] = (float)values[e];
+    return findIndices(single, NULL, palette, 8, 1, indices);
+}
+
+static void encodeBC4(const BlockPixels& block, unsigned int channel, uint8_t* dst, RBlockCompressor::Quality quality)
+{
+    BlockPixels single;
+    memcpy(single.channels[0], block.channels[channel], sizeof(single.channels[0]));
+
+    float minimum = 255.0f, maximum = 0.0f;
+    float inner[2] = { 255.0f, 0.0f };
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        float value = single.channels[0][i];
+        minimum = std::min(minimum, value);
+        maximum = std::max(maximum, value);
+        if (value > 0.0f && value < 255.0f)
+        {
+            inner[0] = std::min(inner[0], value);
+            inner[1] = std::max(inner[1], value);
+        }
+    }
+
+    int best[2] = { (int)maximum, (int)minimum };
+    uint8_t bestIndices[16];
+    float bestError = tryBC4(single, best[0], best[1], bestIndices);
+
+    if (quality != RBlockCompressor::QUALITY_FAST && bestError > 0.0f)
+    {
+        uint8_t indices[16];
+
+        // The six value mode keeps exact 0 and 255 for the other values.
+        if (inner[0] <= inner[1] && (minimum == 0.0f || maximum == 255.0f))
+        {
+            float error = tryBC4(single, (int)inner[0], (int)inner[1], indices);
+            if (error < bestError)
+            {
+                bestError = error;
+                best[0] = (int)inner[0];
+                best[1] = (int)inner[1];
+                memcpy(bestIndices, indices, sizeof(indices));
+            }
+        }
+
+        // Least squares refinement of the eight value mode.
+        static const float weights[8] = { 0.0f, 1.0f, 1.0f / 7.0f, 2.0f / 7.0f, 3.0f / 7.0f, 4.0f / 7.0f, 5.0f / 7.0f, 6.0f / 7.0f };
+        uint8_t current[16];
+        memcpy(current, bestIndices, sizeof(current));
+        unsigned int refinements = getRefinements(quality);
+        for (unsigned int refinement = 0; refinement < refinements && best[0] > best[1]; refinement++)
+        {
+            float e0, e1;
+            if (!refineEndpoints(single, NULL, 0, 1, current, weights, &e0, &e1))
+                break;
+            int a0 = (int)(e0 + 0.5f);
+            int a1 = (int)(e1 + 0.5f);
+            if (a0 <= a1)
+                break;
+            float error = tryBC4(single, a0, a1, current);
+            if (error >= bestError)
+                break;
+            bestError = error;
+            best[0] = a0;
+            best[1] = a1;
+            memcpy(bestIndices, current, sizeof(current));
+        }
+
+        // Nudging the endpoints catches what rounding missed.
+        if (quality == RBlockCompressor::QUALITY_HIGH)
+        {
+            int center[2] = { best[0], best[1] };
+            for (int d0 = -2; d0 <= 2; d0++)
+            {
+                for (int d1 = -2; d1 <= 2; d1++)
+                {
+                    int a0 = std::min(std::max(center[0] + d0, 0), 255);
+                    int a1 = std::min(std::max(center[1] + d1, 0), 255);
+                    if ((a0 > a1) != (center[0] > center[1]))
+                        continue;
+                    float error = tryBC4(single, a0, a1, indices);
+                    if (error < bestError)
+                    {
+                        bestError = error;
+                        best[0] = a0;
+                        best[1] = a1;
+                        memcpy(bestIndices, indices, sizeof(indices));
+                    }
+                }
+            }
+        }
+    }
+
+    uint64_t bits = 0;
+    for (unsigned int i = 0; i < 16; i++)
+        bits |= (uint64_t)bestIndices[i] << (i * 3);
+    dst[0] = (uint8_t)best[0];
+    dst[1] = (uint8_t)best[1];
+    for (unsigned int b = 0; b < 6; b++)
+        dst[2 + b] = (uint8_t)(bits >> (b * 8));
+}
+
+static float encodeBC7Mode6(const BlockPixels& block, RBlockCompressor::Quality quality, uint8_t* dst)
+{
+    float weights[16];
+    for (unsigned int w = 0; w < 16; w++)
+        weights[w] = (float)BLOCK_WEIGHTS4[w] / 64.0f;
+
+    float e[2][4];
+    fitAxis(block, NULL, 0, 4, e[0], e[1]);
+
+    float bestError = FLT_MAX;
+    int bestEndpoints[2][4] = {};
+    int bestPBits[2] = { 0, 0 };
+    uint8_t bestIndices[16] = {};
+    unsigned int refinements = getRefinements(quality);
+    for (unsigned int refinement = 0; refinement <= refinements; refinement++)
+    {
+        // The p-bit of each endpoint is chosen by its own rounding error, or searched at high quality.
+        unsigned int combinations = quality == RBlockCompressor::QUALITY_HIGH ? 4 : 1;
+        int chosen[2] = { 0, 0 };
+        for (unsigned int p = 0; p < 2; p++)
+        {
+            float errors[2] = { 0.0f, 0.0f };
+            for (int pbit = 0; pbit < 2; pbit++)
+            {
+                for (unsigned int c = 0; c < 4; c++)
+                    errors[pbit] += std::fabs((float)expandEndpoint(quantizeEndpoint(e[p][c], 7, pbit), 7, pbit) - e[p][c]);
+            }
+            chosen[p] = errors[1] < errors[0] ? 1 : 0;
+        }
+
+        uint8_t indices[16];
+        for (unsigned int combination = 0; combination < combinations; combination++)
+        {
+            int pbits[2] = { chosen[0], chosen[1] };
+            if (combinations > 1)
+            {
+                pbits[0] = (int)(combination & 1);
+                pbits[1] = (int)(combination >> 1);
+            }
+            int endpoints[2][4];
+            int values[2][4];
+            for (unsigned int p = 0; p < 2; p++)
+            {
+                for (unsigned int c = 0; c < 4; c++)
+                {
+                    endpoints[p][c] = quantizeEndpoint(e[p][c], 7, pbits[p]);
+                    values[p][c] = expandEndpoint(endpoints[p][c], 7, pbits[p]);
+                }
+            }
+            float palette[16][4];
+            for (unsigned int w = 0; w < 16; w++)
+            {
+                for (unsigned int c = 0; c < 4; c++)
+                    palette[w][c] = (float)interpolate(values[0][c], values[1][c], BLOCK_WEIGHTS4[w]);
+            }
+            float error = findIndices(block, NULL, palette, 16, 4, indices);
+            if (error < bestError)
+            {
+                bestError = error;
+                memcpy(bestEndpoints, endpoints, sizeof(endpoints));
+                bestPBits[0] = pbits[0];
+                bestPBits[1] = pbits[1];
+                memcpy(bestIndices, indices, sizeof(indices));
+            }
+        }
+        if (refinement == refinements || bestError == 0.0f)
+            break;
+        if (!refineEndpoints(block, NULL, 0, 4, bestIndices, weights, e[0], e[1]))
+            break;
+    }
+
+    // The anchor index is stored without its leading bit, which must be 0.
+    if (bestIndices[0] & 8)
+    {
+        for (unsigned int c = 0; c < 4; c++)
+            std::swap(bestEndpoints[0][c], bestEndpoints[1][c]);
+        std::swap(bestPBits[0], bestPBits[1]);
+        for (unsigned int i = 0; i < 16; i++)
+            bestIndices[i] = (uint8_t)(15 - bestIndices[i]);
+    }
+
+    memset(dst, 0, 16);
+    BlockWriter writer = { dst, 0 };
+    writer.write(1 << 6, 7);
+    for (unsigned int c = 0; c < 4; c++)
+    {
+        writer.write((uint32_t)bestEndpoints[0][c], 7);
+        writer.write((uint32_t)bestEndpoints[1][c], 7);
+    }
+    writer.write((uint32_t)bestPBits[0], 1);
+    writer.write((uint32_t)bestPBits[1], 1);
+    for (unsigned int i = 0; i < 16; i++)
+        writer.write(bestIndices[i], i == 0 ? 3 : 4);
+    return bestError;
+}
+
+static float encodeBC7Mode1(const BlockPixels& block, unsigned int partition, RBlockCompressor::Quality quality, uint8_t* dst)
+{
+    float weights[8];
+    for (unsigned int w = 0; w < 8; w++)
+        weights[w] = (float)BLOCK_WEIGHTS3[w] / 64.0f;
+
+    float subsets[16];
+    float masks[2][16];
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        subsets[i] = (float)((BLOCK_PARTITIONS2[partition] >> i) & 1);
+        masks[0][i] = 1.0f - subsets[i];
+        masks[1][i] = subsets[i];
+    }
+
+    // The subsets are independent, so each is fitted on its own.
+    float totalError = 0.0f;
+    int bestEndpoints[2][2][3] = {};
+    int bestPBits[2] = { 0, 0 };
+    uint8_t bestIndices[16] = {};
+    unsigned int refinements = getRefinements(quality);
+    for (unsigned int s = 0; s < 2; s++)
+    {
+        float e[2][4];
+        fitAxis(block, subsets, s, 3, e[0], e[1]);
+        float bestError = FLT_MAX;
+        uint8_t indices[16];
+        for (unsigned int refinement = 0; refinement <= refinements; refinement++)
+        {
+            for (int pbit = 0; pbit < 2; pbit++)
+            {
+                int endpoints[2][3];
+                int values[2][3];
+                for (unsigned int p = 0; p < 2; p++)
+                {
+                    for (unsigned int c = 0; c < 3; c++)
+                    {
+                        endpoints[p][c] = quantizeEndpoint(e[p][c], 6, pbit);
+                        values[p][c] = expandEndpoint(endpoints[p][c], 6, pbit);
+                    }
+                }
+                float palette[8][4] = {};
+                for (unsigned int w = 0; w < 8; w++)
+                {
+                    for (unsigned int c = 0; c < 3; c++)
+                        palette[w][c] = (float)interpolate(values[0][c], values[1][c], BLOCK_WEIGHTS3[w]);
+                }
+                float error = findIndices(block, masks[s], palette, 8, 3, indices);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    memcpy(bestEndpoints[s], endpoints, sizeof(endpoints));
+                    bestPBits[s] = pbit;
+                    for (unsigned int i = 0; i < 16; i++)
+                    {
+                        if (masks[s][i] != 0.0f)
+                            bestIndices[i] = indices[i];
+                    }
+                }
+            }
+            if (refinement == refinements || bestError == 0.0f)
+                break;
+            if (!refineEndpoints(block, subsets, s, 3, bestIndices, weights, e[0], e[1]))
+                break;
+        }
+        totalError += bestError;
+    }
+
+    unsigned int anchors[2] = { 0, BLOCK_ANCHORS2[partition] };
+    for (unsigned int s = 0; s < 2; s++)
+    {
+        if (!(bestIndices[anchors[s]] & 4))
+            continue;
+        for (unsigned int c = 0; c < 3; c++)
+            std::swap(bestEndpoints[s][0][c], bestEndpoints[s][1][c]);
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            if (masks[s][i] != 0.0f)
+                bestIndices[i] = (uint8_t)(7 - bestIndices[i]);
+        }
+    }
+
+    memset(dst, 0, 16);
+    BlockWriter writer = { dst, 0 };
+    writer.write(1 << 1, 2);
+    writer.write(partition, 6);
+    for (unsigned int c = 0; c < 3; c++)
+    {
+        for (unsigned int s = 0; s < 2; s++)
+        {
+            writer.write((uint32_t)bestEndpoints[s][0][c], 6);
+            writer.write((uint32_t)bestEndpoints[s][1][c], 6);
+        }
+    }
+    writer.write((uint32_t)bestPBits[0], 1);
+    writer.write((uint32_t)bestPBits[1], 1);
+    for (unsigned int i = 0; i < 16; i++)
+        writer.write(bestIndices[i], (i == anchors[0] || i == anchors[1]) ? 2 : 3);
+    return totalError;
+}
+
+static void encodeBC7(const BlockPixels& block, uint8_t* dst, RBlockCompressor::Quality quality)
+{
+    float bestError = encodeBC7Mode6(block, quality, dst);
+    if (quality == RBlockCompressor::QUALITY_FAST || bestError == 0.0f)
+        return;
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        if (block.channels[3][i] != 255.0f)
+            return;
+    }
+
+    // Opaque blocks also try two subsets, with the partitions whose subsets lie closest to lines.
+    std::pair<float, unsigned int> partitions[64];
+    for (unsigned int p = 0; p < 64; p++)
+    {
+        float subsets[16];
+        for (unsigned int i = 0; i < 16; i++)
+            subsets[i] = (float)((BLOCK_PARTITIONS2[p] >> i) & 1);
+        float low[4], high[4];
+        float residual = fitAxis(block, subsets, 0, 3, low, high) + fitAxis(block, subsets, 1, 3, low, high);
+        partitions[p] = std::make_pair(residual, p);
+    }
+    unsigned int count = quality == RBlockCompressor::QUALITY_HIGH ? 16 : 4;
+    std::partial_sort(partitions, partitions + count, partitions + 64);
+
+    uint8_t candidate[16];
+    for (unsigned int p = 0; p < count; p++)
+    {
+        float error = encodeBC7Mode1(block, partitions[p].second, quality, candidate);
+        if (error < bestError)
+        {
+            bestError = error;
+            memcpy(dst, candidate, 16);
+        }
+    }
+}
+
+static void decodeBC1(const uint8_t* src, uint8_t* rgba, bool alwaysFourColors)
+{
+    uint16_t c0 = (uint16_t)(src[0] | (src[1] << 8));
+    uint16_t c1 = (uint16_t)(src[2] | (src[3] << 8));
+    int palette[4][4];
+    getBC1Palette(c0, c1, alwaysFourColors || c0 > c1, palette);
+    uint32_t bits = (uint32_t)src[4] | ((uint32_t)src[5] << 8) | ((uint32_t)src[6] << 16) | ((uint32_t)src[7] << 24);
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        unsigned int index = (bits >> (i * 2)) & 3;
+        for (unsigned int c = 0; c < 4; c++)
+            rgba[i * 4 + c] = (uint8_t)palette[index][c];
+    }
+}
+
+static void decodeBC4(const uint8_t* src, uint8_t* rgba, unsigned int channel)
+{
+    int palette[8];
+    getBC4Palette(src[0], src[1], palette);
+    uint64_t bits = 0;
+    for (unsigned int b = 0; b < 6; b++)
+        bits |= (uint64_t)src[2 + b] << (b * 8);
+    for (unsigned int i = 0; i < 16; i++)
+        rgba[i * 4 + channel] = (uint8_t)palette[(bits >> (i * 3)) & 7];
+}
+
+static void decodeBC7(const uint8_t* src, uint8_t* rgba)
+{
+    unsigned int mode = 0;
+    while (mode < 8 && !((src[0] >> mode) & 1))
+        mode++;
+
+    // Reserved modes decode to transparent black.
+    if (mode >= 8)
+    {
+        memset(rgba, 0, 64);
+        return;
+    }
+
+    const BlockMode& layout = BLOCK_MODES[mode];
+    BlockReader reader = { src, mode + 1 };
+    unsigned int partition = reader.read(layout.partitionBits);
+    unsigned int rotation = reader.read(layout.rotationBits);
+    unsigned int selection = reader.read(layout.selectionBits);
+
+    int endpoints[3][2][4];
+    for (unsigned int c = 0; c < 3; c++)
+    {
+        for (unsigned int s = 0; s < layout.subsets; s++)
+        {
+            endpoints[s][0][c] = (int)reader.read(layout.colorBits);
+            endpoints[s][1][c] = (int)reader.read(layout.colorBits);
+        }
+    }
+    for (unsigned int s = 0; s < layout.subsets; s++)
+    {
+        endpoints[s][0][3] = (int)reader.read(layout.alphaBits);
+        endpoints[s][1][3] = (int)reader.read(layout.alphaBits);
+    }
+    int pbits[3][2] = { { -1, -1 }, { -1, -1 }, { -1, -1 } };
+    for (unsigned int s = 0; s < layout.subsets; s++)
+    {
+        if (layout.endpointPBits)
+        {
+            pbits[s][0] = (int)reader.read(1);
+            pbits[s][1] = (int)reader.read(1);
+        }
+        else if (layout.sharedPBits)
+            pbits[s][0] = pbits[s][1] = (int)reader.read(1);
+    }
+    for (unsigned int s = 0; s < layout.subsets; s++)
+    {
+        for (unsigned int e = 0; e < 2; e++)
+        {
+            for (unsigned int c = 0; c < 3; c++)
+                endpoints[s][e][c] = expandEndpoint(endpoints[s][e][c], layout.colorBits, pbits[s][e]);
+            endpoints[s][e][3] = layout.alphaBits ? expandEndpoint(endpoints[s][e][3], layout.alphaBits, pbits[s][e]) : 255;
+        }
+    }
+
+    // The first pixel of each subset drops the leading bit of its index.
+    unsigned int subsetOf[16];
+    bool anchor[16] = { true };
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        if (layout.subsets == 3)
+            subsetOf[i] = (BLOCK_PARTITIONS3[partition] >> (i * 2)) & 3;
+        else
+            subsetOf[i] = layout.subsets == 2 ? (BLOCK_PARTITIONS2[partition] >> i) & 1 : 0;
+    }
+    if (layout.subsets == 2)
+        anchor[BLOCK_ANCHORS2[partition]] = true;
+    else if (layout.subsets == 3)
+        anchor[BLOCK_ANCHORS3[partition][0]] = anchor[BLOCK_ANCHORS3[partition][1]] = true;
+
+    unsigned int indices[16];
+    unsigned int indices2[16];
+    for (unsigned int i = 0; i < 16; i++)
+        indices[i] = reader.read(layout.indexBits - (anchor[i] ? 1 : 0));
+    for (unsigned int i = 0; i < 16; i++)
+        indices2[i] = layout.indexBits2 ? reader.read(layout.indexBits2 - (i == 0 ? 1 : 0)) : indices[i];
+
+    const int* weights[5] = { NULL, NULL, BLOCK_WEIGHTS2, BLOCK_WEIGHTS3, BLOCK_WEIGHTS4 };
+    const int* colorWeights = weights[layout.indexBits];
+    const int* alphaWeights = weights[layout.indexBits2 ? layout.indexBits2 : layout.indexBits];
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        const int (*pair)[4] = endpoints[subsetOf[i]];
+        unsigned int colorIndex = indices[i];
+        unsigned int alphaIndex = indices2[i];
+        const int* colorTable = colorWeights;
+        const int* alphaTable = alphaWeights;
+        if (selection)
+        {
+            std::swap(colorIndex, alphaIndex);
+            std::swap(colorTable, alphaTable);
+        }
+        uint8_t* pixel = rgba + i * 4;
+        for (unsigned int c = 0; c < 3; c++)
+            pixel[c] = (uint8_t)interpolate(pair[0][c], pair[1][c], colorTable[colorIndex]);
+        pixel[3] = (uint8_t)interpolate(pair[0][3], pair[1][3], alphaTable[alphaIndex]);
+        if (rotation)
+            std::swap(pixel[3], pixel[rotation - 1]);
+    }
+}
+
+RBlockCompressor::RBlockCompressor(Quality quality)
+    : _quality(quality)
+{
+}
+
+RBlockCompressor::~RBlockCompressor()
+{
+}
+
+RBlockCompressor::Quality RBlockCompressor::getQuality() const
+{
+    return _quality;
+}
+
+void RBlockCompressor::setQuality(Quality quality)
+{
+    _quality = quality;
+}
+
+bool RBlockCompressor::compress(RTexture::Format format, const uint8_t* rgba, unsigned int width, unsigned int height, uint8_t* dst) const
+{
+    if (!RTexture::isCompressed(format) || width == 0 || height == 0)
+        return false;
+
+    unsigned int columns = (width + 3) / 4;
+    unsigned int rows = (height + 3) / 4;
+    size_t blockSize = RTexture::getBlockSize(format);
+    Quality quality = _quality;
+    parallelFor(rows, BLOCK_PARALLEL_MIN_ROWS, [&](size_t begin, size_t end)
+    {
+        uint8_t pixels[64];
+        for (size_t row = begin; row < end; row++)
+        {
+            for (unsigned int column = 0; column < columns; column++)
+            {
+                for (unsigned int y = 0; y < 4; y++)
+                {
+                    unsigned int sy = std::min((unsigned int)row * 4 + y, height - 1);
+                    for (unsigned int x = 0; x < 4; x++)
+                    {
+                        unsigned int sx = std::min(column * 4 + x, width - 1);
+                        memcpy(pixels + (y * 4 + x) * 4, rgba + ((size_t)sy * width + sx) * 4, 4);
+                    }
+                }
+                compressBlock(format, pixels, dst + (row * columns + column) * blockSize, quality);
+            }
+        }
+    });
+    return true;
+}
+
+bool RBlockCompressor::decompress(RTexture::Format format, const uint8_t* src, unsigned int width, unsigned int height, uint8_t* rgba) const
+{
+    if (!RTexture::isCompressed(format) || width == 0 || height == 0)
+        return false;
+
+    unsigned int columns = (width + 3) / 4;
+    unsigned int rows = (height + 3) / 4;
+    size_t blockSize = RTexture::getBlockSize(format);
+    // Decoding is much cheaper than encoding, so each thread takes more rows.
+    parallelFor(rows, BLOCK_PARALLEL_MIN_ROWS * 4, [&](size_t begin, size_t end)
+    {
+        uint8_t pixels[64];
+        for (size_t row = begin; row < end; row++)
+        {
+            for (unsigned int column = 0; column < columns; column++)
+            {
+                decompressBlock(format, src + (row * columns + column) * blockSize, pixels);
+                for (unsigned int y = 0; y < 4 && row * 4 + y < height; y++)
+                {
+                    unsigned int count = std::min(4u, width - column * 4);
+                    memcpy(rgba + ((row * 4 + y) * width + column * 4) * 4, pixels + y * 16, count * 4);
+                }
+            }
+        }
+    });
+    return true;
+}
+
+void RBlockCompressor::compressBlock(RTexture::Format format, const uint8_t* rgba, uint8_t* dst, Quality quality)
+{
+    BlockPixels block;
+    loadBlock(rgba, &block);
+    switch (format)
+    {
+    case RTexture::FORMAT_BC1:
+    case RTexture::FORMAT_BC1_SRGB:
+        encodeBC1(block, dst, quality, false);
+        break;
+    case RTexture::FORMAT_BC3:
+    case RTexture::FORMAT_BC3_SRGB:
+        encodeBC4(block, 3, dst, quality);
+        encodeBC1(block, dst + 8, quality, true);
+        break;
+    case RTexture::FORMAT_BC4:
+        encodeBC4(block, 0, dst, quality);
+        break;
+    case RTexture::FORMAT_BC5:
+        encodeBC4(block, 0, dst, quality);
+        encodeBC4(block, 1, dst + 8, quality);
+        break;
+    case RTexture::FORMAT_BC7:
+    case RTexture::FORMAT_BC7_SRGB:
+        encodeBC7(block, dst, quality);
+        break;
+    default:
+        break;
+    }
+}
+
+void RBlockCompressor::decompressBlock(RTexture::Format format, const uint8_t* src, uint8_t* rgba)
+{
+    switch (format)
+    {
+    case RTexture::FORMAT_BC1:
+    case RTexture::FORMAT_BC1_SRGB:
+        decodeBC1(src, rgba, false);
+        break;
+    case RTexture::FORMAT_BC3:
+    case RTexture::FORMAT_BC3_SRGB:
+        decodeBC1(src + 8, rgba, true);
+        decodeBC4(src, rgba, 3);
+        break;
+    case RTexture::FORMAT_BC4:
+    case RTexture::FORMAT_BC5:
+        for (unsigned int i = 0; i < 16; i++)
+        {
+            rgba[i * 4 + 1] = 0;
+            rgba[i * 4 + 2] = 0;
+            rgba[i * 4 + 3] = 255;
+        }
+        decodeBC4(src, rgba, 0);
+        if (format == RTexture::FORMAT_BC5)
+            decodeBC4(src + 8, rgba, 1);
+        break;
+    case RTexture::FORMAT_BC7:
+    case RTexture::FORMAT_BC7_SRGB:
+        decodeBC7(src, rgba);
+        break;
+    default:
+        break;
+    }
+}
+
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "RTexture.h"
+#include "utilities/Parallel.h"
+
+namespace rocket
+{
+
+/**
+ * Defines an encoder and decoder of the BC1, BC3, BC4, BC5 and BC7 block
+ * compressed texture formats.
+ *
+ * Images are RGBA8, 4 bytes per pixel in rows without padding. BC4 encodes
+ * the red channel and BC5 the red and green channels; decoding them writes
+ * 0 to the missing color channels and 255 to alpha, like the GPU does. BC1
+ * punches through pixels with alpha below 128. Images whose size is not a
+ * multiple of 4 are padded by repeating their last row and column.
+ *
+ * The encoders fit the endpoints of each block to the principal axis of its
+ * colors and choose the indices with SIMD over the 16 pixels. Higher
+ * qualities refine the endpoints by least squares and search more options:
+ *
+ * - QUALITY_FAST: one fit per block. BC7 uses mode 6 only.
+ * - QUALITY_NORMAL: two refinements. BC7 also tries mode 1 with the four
+ *   most promising of its 64 partitions on opaque blocks.
+ * - QUALITY_HIGH: eight refinements, all p-bit combinations, and mode 1 with
+ *   the sixteen most promising partitions.
+ *
+ * The decoders handle every mode of the formats, including the three-subset
+ * BC7 modes 0 and 2 that the encoder never picks.
+ */
+class API RBlockCompressor : public RParallel
+{
+public:
+
+    /**
+     * The trade-off between encoding time and quality.
+     */
+    enum Quality
+    {
+        QUALITY_FAST,
+        QUALITY_NORMAL,
+        QUALITY_HIGH
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param quality The encoding quality.
+     */
+    explicit RBlockCompressor(Quality quality = QUALITY_NORMAL);
+
+    /**
+     * Destructor.
+     */
+    ~RBlockCompressor();
+
+    /**
+     * Gets the encoding quality.
+     *
+     * @return The quality.
+     */
+    Quality getQuality() const;
+
+    /**
+     * Sets the encoding quality.
+     *
+     * @param quality The quality.
+     */
+    void setQuality(Quality quality);
+
+    /**
+     * Encodes an image.
+     *
+     * @param format The compressed format.
+     * @param rgba The RGBA8 pixels.
+     * @param width The width in pixels.
+     * @param height The height in pixels.
+     * @param dst The blocks, RTexture::getImageSize(format, width, height) bytes.
+     *
+     * @return false if the format is not compressed.
+     */
+    bool compress(RTexture::Format format, const uint8_t* rgba, unsigned int width, unsigned int height, uint8_t* dst) const;
+
+    /**
+     * Decodes an image.
+     *
+     * @param format The compressed format.
+     * @param src The blocks.
+     * @param width The width in pixels.
+     * @param height The height in pixels.
+     * @param rgba The RGBA8 pixels, width * height * 4 bytes.
+     *
+     * @return false if the format is not compressed.
+     */
+    bool decompress(RTexture::Format format, const uint8_t* src, unsigned int width, unsigned int height, uint8_t* rgba) const;
+
+    /**
+     * Encodes a block.
+     *
+     * @param format The compressed format.
+     * @param rgba The 4 x 4 RGBA8 pixels, in rows.
+     * @param dst The block, RTexture::getBlockSize(format) bytes.
+     * @param quality The encoding quality.
+     */
+    static void compressBlock(RTexture::Format format, const uint8_t* rgba, uint8_t* dst, Quality quality = QUALITY_NORMAL);
+
+    /**
+     * Decodes a block.
+     *
+     * @param format The compressed format.
+     * @param src The block.
+     * @param rgba The 4 x 4 RGBA8 pixels, in rows.
+     */
+    static void decompressBlock(RTexture::Format format, const uint8_t* src, uint8_t* rgba);
+
+private:
+
+    Quality _quality;
+};
+
+}
@@ -0,0 +1,394 @@
+#include "common.h"
+#include "RBrickMap.h"
+#include "RTexture3D.h"
+#include "math/RPacking.h"
+
+namespace rocket
+{
+
+// The number of voxels in a brick.
+#define BRICK_MAP_BRICK_VOXELS  (RBrickMap::BRICK_SIZE * RBrickMap::BRICK_SIZE * RBrickMap::BRICK_SIZE)
+// The alpha of an indirection entry that points into the atlas.
+#define BRICK_MAP_OCCUPIED      0xFF000000u
+
+const unsigned int RBrickMap::BRICK_SIZE;
+const unsigned int RBrickMap::ATLAS_BRICKS;
+const unsigned int RBrickMap::MAX_BRICKS;
+
+/**
+ * Converts an atlas slot to the indirection entry pointing at it.
+ */
+static uint32_t slotToEntry(uint32_t slot)
+{
+    uint32_t x = slot % RBrickMap::ATLAS_BRICKS;
+    uint32_t y = slot / RBrickMap::ATLAS_BRICKS % RBrickMap::ATLAS_BRICKS;
+    uint32_t z = slot / (RBrickMap::ATLAS_BRICKS * RBrickMap::ATLAS_BRICKS);
+    return x | (y << 8) | (z << 16) | BRICK_MAP_OCCUPIED;
+}
+
+/**
+ * Converts an indirection entry of an occupied brick to its atlas slot.
+ */
+static uint32_t entryToSlot(uint32_t entry)
+{
+    return (entry & 255) + ((entry >> 8) & 255) * RBrickMap::ATLAS_BRICKS +
+           ((entry >> 16) & 255) * RBrickMap::ATLAS_BRICKS * RBrickMap::ATLAS_BRICKS;
+}
+
+/**
+ * Gets the number of float channels sample() writes for a format.
+ */
+static unsigned int getChannelCount(RTexture::Format format)
+{
+    switch (format)
+    {
+    case RTexture::FORMAT_R8:
+        return 1;
+    case RTexture::FORMAT_RG8:
+        return 2;
+    case RTexture::FORMAT_RGBA8:
+    case RTexture::FORMAT_RGBA8_SRGB:
+    case RTexture::FORMAT_RGBA16F:
+    case RTexture::FORMAT_RGBA32F:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+/**
+ * Converts the bytes of a voxel to floats.
+ */
+static void decodeVoxel(RTexture::Format format, unsigned int channels, const uint8_t* voxel, float* dst)
+{
+    if (format == RTexture::FORMAT_RGBA32F)
+        memcpy(dst, voxel, 4 * sizeof(float));
+    else if (format == RTexture::FORMAT_RGBA16F)
+    {
+        for (unsigned int i = 0; i < 4; i++)
+        {
+            uint16_t half;
+            memcpy(&half, voxel + i * 2, sizeof(half));
+            dst[i] = RPacking::fromHalf(half);
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < channels; i++)
+            dst[i] = voxel[i] * (1.0f / 255.0f);
+    }
+}
+
+/**
+ * Moves a coordinate from voxel centers to voxel corners and clamps it to
+ * one voxel around the volume, so it converts to an int safely (NaN clamps
+ * to the low edge).
+ */
+static float clampCoordinate(float value, unsigned int size)
+{
+    value -= 0.5f;
+    return value > -1.0f ? std::min(value, (float)size) : -1.0f;
+}
+
+static unsigned int clampVoxel(int value, unsigned int size)
+{
+    return value < 0 ? 0 : std::min((unsigned int)value, size - 1);
+}
+
+RBrickMap::RBrickMap(unsigned int width, unsigned int height, unsigned int depth, RTexture::Format format,
+                     const void* emptyVoxel)
+    : _width(std::max(width, 1u)), _height(std::max(height, 1u)), _depth(std::max(depth, 1u)), _format(format),
+      _voxelSize(RTexture::isCompressed(format) ? 0 : RTexture::getBlockSize(format)),
+      _gridWidth((_width + BRICK_SIZE - 1) / BRICK_SIZE), _gridHeight((_height + BRICK_SIZE - 1) / BRICK_SIZE),
+      _gridDepth((_depth + BRICK_SIZE - 1) / BRICK_SIZE), _slotCount(0), _indirectionDirty(true)
+{
+    _emptyBrick.resize(BRICK_MAP_BRICK_VOXELS * _voxelSize);
+    if (emptyVoxel != NULL)
+    {
+        for (size_t i = 0; i < _emptyBrick.size(); i += _voxelSize)
+            memcpy(_emptyBrick.data() + i, emptyVoxel, _voxelSize);
+    }
+    size_t brickCount = (size_t)_gridWidth * _gridHeight * _gridDepth;
+    _indirection.resize(brickCount, 0);
+    _dirty.resize(brickCount, false);
+}
+
+RBrickMap::~RBrickMap()
+{
+}
+
+bool RBrickMap::build(const void* voxels)
+{
+    if (_voxelSize == 0)
+        return false;
+    clear();
+
+    const uint8_t* src = (const uint8_t*)voxels;
+    std::vector<uint8_t> brick(_emptyBrick.size());
+    for (unsigned int bz = 0; bz < _gridDepth; bz++)
+    {
+        unsigned int depth = std::min(BRICK_SIZE, _depth - bz * BRICK_SIZE);
+        for (unsigned int by = 0; by < _gridHeight; by++)
+        {
+            unsigned int height = std::min(BRICK_SIZE, _height - by * BRICK_SIZE);
+            for (unsigned int bx = 0; bx < _gridWidth; bx++)
+            {
+                // Edge bricks are padded with empty voxels past the volume.
+                unsigned int width = std::min(BRICK_SIZE, _width - bx * BRICK_SIZE);
+                if (width < BRICK_SIZE || height < BRICK_SIZE || depth < BRICK_SIZE)
+                    memcpy(brick.data(), _emptyBrick.data(), brick.size());
+                for (unsigned int z = 0; z < depth; z++)
+                {
+                    for (unsigned int y = 0; y < height; y++)
+                    {
+                        size_t srcVoxel = ((size_t)(bz * BRICK_SIZE + z) * _height + by * BRICK_SIZE + y) * _width + bx * BRICK_SIZE;
+                        memcpy(brick.data() + (z * BRICK_SIZE + y) * BRICK_SIZE * _voxelSize, src + srcVoxel * _voxelSize,
+                               width * _voxelSize);
+                    }
+                }
+                if (!setBrick(bx, by, bz, brick.data()))
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+void RBrickMap::clear()
+{
+    std::fill(_indirection.begin(), _indirection.end(), 0);
+    std::fill(_dirty.begin(), _dirty.end(), false);
+    _dirtyBricks.clear();
+    _atlas.clear();
+    _atlas.shrink_to_fit();
+    _freeSlots.clear();
+    _slotCount = 0;
+    _indirectionDirty = true;
+}
+
+bool RBrickMap::setBrick(unsigned int x, unsigned int y, unsigned int z, const void* voxels)
+{
+    if (_voxelSize == 0 || x >= _gridWidth || y >= _gridHeight || z >= _gridDepth)
+        return false;
+    size_t brick = ((size_t)z * _gridHeight + y) * _gridWidth + x;
+    size_t brickSize = _emptyBrick.size();
+    if (memcmp(voxels, _emptyBrick.data(), brickSize) == 0)
+    {
+        clearBrick(x, y, z);
+        return true;
+    }
+
+    uint32_t entry = _indirection[brick];
+    if (entry == 0)
+    {
+        uint32_t slot;
+        if (!_freeSlots.empty())
+        {
+            slot = _freeSlots.back();
+            _freeSlots.pop_back();
+        }
+        else if (_slotCount < MAX_BRICKS)
+        {
+            slot = _slotCount++;
+            _atlas.resize(_slotCount * brickSize);
+        }
+        else
+            return false;
+        entry = slotToEntry(slot);
+        _indirection[brick] = entry;
+        _indirectionDirty = true;
+    }
+    memcpy(_atlas.data() + entryToSlot(entry) * brickSize, voxels, brickSize);
+    markDirty(brick);
+    return true;
+}
+
+void RBrickMap::clearBrick(unsigned int x, unsigned int y, unsigned int z)
+{
+    if (x >= _gridWidth || y >= _gridHeight || z >= _gridDepth)
+        return;
+    size_t brick = ((size_t)z * _gridHeight + y) * _gridWidth + x;
+    if (_indirection[brick] == 0)
+        return;
+    _freeSlots.push_back(entryToSlot(_indirection[brick]));
+    _indirection[brick] = 0;
+    _indirectionDirty = true;
+}
+
+bool RBrickMap::getBrick(unsigned int x, unsigned int y, unsigned int z, void* voxels) const
+{
+    if (x >= _gridWidth || y >= _gridHeight || z >= _gridDepth)
+        return false;
+    uint32_t entry = _indirection[((size_t)z * _gridHeight + y) * _gridWidth + x];
+    size_t brickSize = _emptyBrick.size();
+    memcpy(voxels, entry == 0 ? _emptyBrick.data() : _atlas.data() + entryToSlot(entry) * brickSize, brickSize);
+    return true;
+}
+
+bool RBrickMap::isBrickOccupied(unsigned int x, unsigned int y, unsigned int z) const
+{
+    if (x >= _gridWidth || y >= _gridHeight || z >= _gridDepth)
+        return false;
+    return _indirection[((size_t)z * _gridHeight + y) * _gridWidth + x] != 0;
+}
+
+void RBrickMap::getVoxel(unsigned int x, unsigned int y, unsigned int z, void* voxel) const
+{
+    if (x >= _width || y >= _height || z >= _depth)
+        memcpy(voxel, _emptyBrick.data(), _voxelSize);
+    else
+        memcpy(voxel, findVoxel(x, y, z), _voxelSize);
+}
+
+unsigned int RBrickMap::sample(float x, float y, float z, float* dst) const
+{
+    unsigned int channels = getChannelCount(_format);
+    if (channels == 0)
+        return 0;
+
+    float fx = clampCoordinate(x, _width);
+    float fy = clampCoordinate(y, _height);
+    float fz = clampCoordinate(z, _depth);
+    float floorX = std::floor(fx), floorY = std::floor(fy), floorZ = std::floor(fz);
+    float weightX[2] = { 1.0f - (fx - floorX), fx - floorX };
+    float weightY[2] = { 1.0f - (fy - floorY), fy - floorY };
+    float weightZ[2] = { 1.0f - (fz - floorZ), fz - floorZ };
+    unsigned int voxelX[2] = { clampVoxel((int)floorX, _width), clampVoxel((int)floorX + 1, _width) };
+    unsigned int voxelY[2] = { clampVoxel((int)floorY, _height), clampVoxel((int)floorY + 1, _height) };
+    unsigned int voxelZ[2] = { clampVoxel((int)floorZ, _depth), clampVoxel((int)floorZ + 1, _depth) };
+
+    for (unsigned int i = 0; i < channels; i++)
+        dst[i] = 0.0f;
+    for (unsigned int k = 0; k < 8; k++)
+    {
+        float weight = weightX[k & 1] * weightY[(k >> 1) & 1] * weightZ[k >> 2];
+        float values[4];
+        decodeVoxel(_format, channels, findVoxel(voxelX[k & 1], voxelY[(k >> 1) & 1], voxelZ[k >> 2]), values);
+        for (unsigned int i = 0; i < channels; i++)
+            dst[i] += values[i] * weight;
+    }
+    return channels;
+}
+
+RTexture3D* RBrickMap::createAtlasTexture(unsigned int brickCapacity) const
+{
+    unsigned int sliceBricks = ATLAS_BRICKS * ATLAS_BRICKS;
+    unsigned int bricks = std::min(std::max(brickCapacity, _slotCount), MAX_BRICKS);
+    unsigned int slices = std::max((bricks + sliceBricks - 1) / sliceBricks, 1u);
+    return new RTexture3D(ATLAS_BRICKS * BRICK_SIZE, ATLAS_BRICKS * BRICK_SIZE, slices * BRICK_SIZE, _format, 1);
+}
+
+RTexture3D* RBrickMap::createIndirectionTexture() const
+{
+    return new RTexture3D(_gridWidth, _gridHeight, _gridDepth, RTexture::FORMAT_RGBA8, 1);
+}
+
+bool RBrickMap::upload(RGLStateCache* cache, RTexture3D* atlas, RTexture3D* indirection)
+{
+    unsigned int sliceBricks = ATLAS_BRICKS * ATLAS_BRICKS;
+    unsigned int atlasDepth = (_slotCount + sliceBricks - 1) / sliceBricks * BRICK_SIZE;
+    if (atlas->getHandle() == 0 || atlas->getFormat() != _format || atlas->getWidth() != ATLAS_BRICKS * BRICK_SIZE ||
+        atlas->getHeight() != ATLAS_BRICKS * BRICK_SIZE || atlas->getDepth() < atlasDepth)
+        return false;
+    if (indirection->getHandle() == 0 || indirection->getFormat() != RTexture::FORMAT_RGBA8 ||
+        indirection->getWidth() != _gridWidth || indirection->getHeight() != _gridHeight ||
+        indirection->getDepth() != _gridDepth)
+        return false;
+
+    // Bricks cleared since they were marked dirty only change the indirection.
+    size_t brickSize = _emptyBrick.size();
+    for (size_t i = 0; i < _dirtyBricks.size(); i++)
+    {
+        uint32_t brick = _dirtyBricks[i];
+        _dirty[brick] = false;
+        uint32_t entry = _indirection[brick];
+        if (entry == 0)
+            continue;
+        atlas->uploadRegion(cache, 0, (entry & 255) * BRICK_SIZE, ((entry >> 8) & 255) * BRICK_SIZE,
+                            ((entry >> 16) & 255) * BRICK_SIZE, BRICK_SIZE, BRICK_SIZE, BRICK_SIZE,
+                            _atlas.data() + entryToSlot(entry) * brickSize);
+    }
+    _dirtyBricks.clear();
+    if (_indirectionDirty)
+    {
+        indirection->upload(cache, 0, _indirection.data(), _indirection.size() * sizeof(uint32_t));
+        _indirectionDirty = false;
+    }
+    return true;
+}
+
+void RBrickMap::invalidate()
+{
+    for (size_t brick = 0; brick < _indirection.size(); brick++)
+    {
+        if (_indirection[brick] != 0)
+            markDirty(brick);
+    }
+    _indirectionDirty = true;
+}
+
+unsigned int RBrickMap::getWidth() const
+{
+    return _width;
+}
+
+unsigned int RBrickMap::getHeight() const
+{
+    return _height;
+}
+
+unsigned int RBrickMap::getDepth() const
+{
+    return _depth;
+}
+
+RTexture::Format RBrickMap::getFormat() const
+{
+    return _format;
+}
+
+void RBrickMap::getGridSize(unsigned int* x, unsigned int* y, unsigned int* z) const
+{
+    *x = _gridWidth;
+    *y = _gridHeight;
+    *z = _gridDepth;
+}
+
+const uint32_t* RBrickMap::getIndirection() const
+{
+    return _indirection.data();
+}
+
+unsigned int RBrickMap::getOccupiedBrickCount() const
+{
+    return _slotCount - (unsigned int)_freeSlots.size();
+}
+
+size_t RBrickMap::getMemorySize() const
+{
+    return _atlas.size() + _indirection.size() * sizeof(uint32_t);
+}
+
+size_t RBrickMap::getDenseSize() const
+{
+    return (size_t)_width * _height * _depth * _voxelSize;
+}
+
+const uint8_t* RBrickMap::findVoxel(unsigned int x, unsigned int y, unsigned int z) const
+{
+    uint32_t entry = _indirection[((size_t)(z / BRICK_SIZE) * _gridHeight + y / BRICK_SIZE) * _gridWidth + x / BRICK_SIZE];
+    size_t voxel = ((z % BRICK_SIZE) * BRICK_SIZE + y % BRICK_SIZE) * BRICK_SIZE + x % BRICK_SIZE;
+    if (entry == 0)
+        return _emptyBrick.data() + voxel * _voxelSize;
+    return _atlas.data() + ((size_t)entryToSlot(entry) * BRICK_MAP_BRICK_VOXELS + voxel) * _voxelSize;
+}
+
+void RBrickMap::markDirty(size_t brick)
+{
+    if (_dirty[brick])
+        return;
+    _dirty[brick] = true;
+    _dirtyBricks.push_back((uint32_t)brick);
+}
+
+}
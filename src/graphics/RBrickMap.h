@@ -0,0 +1,283 @@
+#pragma once
+
+#include "RTexture.h"
+
+namespace rocket
+{
+
+class RGLStateCache;
+class RTexture3D;
+
+/**
+ * Defines a sparse volume, stored as bricks of 8x8x8 voxels of which only
+ * those holding something other than the empty voxel take memory.
+ *
+ * Volumes such as fog densities or signed distance fields are mostly empty
+ * space; the brick map keeps an indirection table with one entry per brick
+ * of the volume and packs the occupied bricks in an atlas. An entry is
+ * RGBA8 for the GPU: the atlas column, row and slice of the brick in bricks,
+ * and 255 in alpha, or 0 for an empty brick. A shader samples the
+ * indirection texture with GL_NEAREST at the voxel, then the atlas at
+ * entry.xyz * 8 + the voxel offset within the brick. Bricks have no border,
+ * so filtering across bricks is done in the shader (or by sample() on the
+ * CPU).
+ *
+ * The atlas is ATLAS_BRICKS bricks wide and high and grows in slices of
+ * bricks as bricks are added. Freed bricks leave a hole that the next brick
+ * added fills. Edits mark their bricks dirty and upload() sends only those
+ * to the GPU.
+ *
+ * A brick is empty when every voxel has the bytes of the empty voxel, so
+ * signed distance fields should clamp their distances to a narrow band
+ * before building, making the voxels far from the surface equal.
+ */
+class API RBrickMap
+{
+public:
+
+    /**
+     * The size of a brick in voxels along each axis.
+     */
+    static const unsigned int BRICK_SIZE = 8;
+
+    /**
+     * The width and height of the atlas in bricks.
+     */
+    static const unsigned int ATLAS_BRICKS = 16;
+
+    /**
+     * The largest number of occupied bricks, as many as the 8 bit slice of an
+     * indirection entry addresses.
+     */
+    static const unsigned int MAX_BRICKS = ATLAS_BRICKS * ATLAS_BRICKS * 256;
+
+    /**
+     * Constructs an empty volume.
+     *
+     * @param width The width in voxels.
+     * @param height The height in voxels.
+     * @param depth The depth in voxels.
+     * @param format The voxel format, uncompressed.
+     * @param emptyVoxel The bytes of the empty voxel, NULL for zeros.
+     */
+    RBrickMap(unsigned int width, unsigned int height, unsigned int depth, RTexture::Format format,
+              const void* emptyVoxel = NULL);
+
+    /**
+     * Destructor.
+     */
+    ~RBrickMap();
+
+    /**
+     * Replaces the volume with dense voxels, keeping the bricks that are not
+     * empty.
+     *
+     * @param voxels The voxels, rows then slices, getWidth() * getHeight() * getDepth() of them.
+     *
+     * @return false if the format is compressed or the occupied bricks do not fit in the atlas.
+     */
+    bool build(const void* voxels);
+
+    /**
+     * Empties the volume, freeing the atlas.
+     */
+    void clear();
+
+    /**
+     * Writes the voxels of a brick, adding it to the atlas or removing it if
+     * the voxels are empty.
+     *
+     * @param x The column of the brick, in bricks.
+     * @param y The row of the brick, in bricks.
+     * @param z The slice of the brick, in bricks.
+     * @param voxels The BRICK_SIZE^3 voxels of the brick, rows then slices.
+     *
+     * @return false if the brick is outside the volume, the format is compressed or the atlas is full.
+     */
+    bool setBrick(unsigned int x, unsigned int y, unsigned int z, const void* voxels);
+
+    /**
+     * Removes a brick, making its voxels empty.
+     *
+     * @param x The column of the brick, in bricks.
+     * @param y The row of the brick, in bricks.
+     * @param z The slice of the brick, in bricks.
+     */
+    void clearBrick(unsigned int x, unsigned int y, unsigned int z);
+
+    /**
+     * Reads the voxels of a brick.
+     *
+     * @param x The column of the brick, in bricks.
+     * @param y The row of the brick, in bricks.
+     * @param z The slice of the brick, in bricks.
+     * @param voxels Set to the BRICK_SIZE^3 voxels of the brick.
+     *
+     * @return false if the brick is outside the volume.
+     */
+    bool getBrick(unsigned int x, unsigned int y, unsigned int z, void* voxels) const;
+
+    /**
+     * Determines whether a brick is in the atlas.
+     *
+     * @param x The column of the brick, in bricks.
+     * @param y The row of the brick, in bricks.
+     * @param z The slice of the brick, in bricks.
+     *
+     * @return true if the brick holds voxels other than the empty voxel.
+     */
+    bool isBrickOccupied(unsigned int x, unsigned int y, unsigned int z) const;
+
+    /**
+     * Reads a voxel.
+     *
+     * @param x The column of the voxel.
+     * @param y The row of the voxel.
+     * @param z The slice of the voxel.
+     * @param voxel Set to the bytes of the voxel, the empty voxel outside the volume.
+     */
+    void getVoxel(unsigned int x, unsigned int y, unsigned int z, void* voxel) const;
+
+    /**
+     * Filters the volume trilinearly at a point, clamping to its edges like
+     * GL_CLAMP_TO_EDGE.
+     *
+     * @param x The x coordinate in voxels, the center of voxel i at i + 0.5.
+     * @param y The y coordinate in voxels.
+     * @param z The z coordinate in voxels.
+     * @param dst Set to the channels of the format as floats, normalized for
+     *      8 bit formats (sRGB is not decoded).
+     *
+     * @return The number of channels written to dst, 0 for compressed formats.
+     */
+    unsigned int sample(float x, float y, float z, float* dst) const;
+
+    /**
+     * Creates a texture sized for the atlas, to upload() to.
+     *
+     * @param brickCapacity The number of bricks the texture should hold, at
+     *      least the occupied bricks.
+     *
+     * @return The texture, owned by the caller, with a single mip.
+     */
+    RTexture3D* createAtlasTexture(unsigned int brickCapacity = 0) const;
+
+    /**
+     * Creates a texture sized for the indirection table, to upload() to.
+     *
+     * @return The RGBA8 texture, owned by the caller, with a single mip.
+     */
+    RTexture3D* createIndirectionTexture() const;
+
+    /**
+     * Uploads the bricks changed since the last upload and, if it changed,
+     * the indirection table. The textures must be created.
+     *
+     * @param cache The state cache to bind the textures through.
+     * @param atlas The atlas texture, from createAtlasTexture().
+     * @param indirection The indirection texture, from createIndirectionTexture().
+     *
+     * @return false, uploading nothing, if a texture is too small for the volume.
+     */
+    bool upload(RGLStateCache* cache, RTexture3D* atlas, RTexture3D* indirection);
+
+    /**
+     * Marks every brick and the indirection table dirty, for an upload() to
+     * new textures.
+     */
+    void invalidate();
+
+    /**
+     * Gets the width of the volume.
+     *
+     * @return The width in voxels.
+     */
+    unsigned int getWidth() const;
+
+    /**
+     * Gets the height of the volume.
+     *
+     * @return The height in voxels.
+     */
+    unsigned int getHeight() const;
+
+    /**
+     * Gets the depth of the volume.
+     *
+     * @return The depth in voxels.
+     */
+    unsigned int getDepth() const;
+
+    /**
+     * Gets the voxel format.
+     *
+     * @return The format.
+     */
+    RTexture::Format getFormat() const;
+
+    /**
+     * Gets the number of bricks along x, y and z.
+     *
+     * @param x Set to the width of the indirection table.
+     * @param y Set to the height of the indirection table.
+     * @param z Set to the depth of the indirection table.
+     */
+    void getGridSize(unsigned int* x, unsigned int* y, unsigned int* z) const;
+
+    /**
+     * Gets the indirection table, x first, then y, then z.
+     *
+     * @return The entries, one per brick.
+     */
+    const uint32_t* getIndirection() const;
+
+    /**
+     * Gets the number of bricks in the atlas.
+     *
+     * @return The number of occupied bricks.
+     */
+    unsigned int getOccupiedBrickCount() const;
+
+    /**
+     * Gets the memory held by the atlas and the indirection table.
+     *
+     * @return The size in bytes.
+     */
+    size_t getMemorySize() const;
+
+    /**
+     * Gets the memory a dense texture of the volume would take.
+     *
+     * @return The size in bytes.
+     */
+    size_t getDenseSize() const;
+
+private:
+
+    RBrickMap(const RBrickMap& copy);
+
+    RBrickMap& operator=(const RBrickMap&);
+
+    const uint8_t* findVoxel(unsigned int x, unsigned int y, unsigned int z) const;
+
+    void markDirty(size_t brick);
+
+    unsigned int _width;
+    unsigned int _height;
+    unsigned int _depth;
+    RTexture::Format _format;
+    size_t _voxelSize;
+    unsigned int _gridWidth;
+    unsigned int _gridHeight;
+    unsigned int _gridDepth;
+    std::vector<uint8_t> _emptyBrick;
+    std::vector<uint32_t> _indirection;
+    std::vector<uint8_t> _atlas;
+    std::vector<uint32_t> _freeSlots;
+    unsigned int _slotCount;
+    std::vector<uint32_t> _dirtyBricks;
+    std::vector<bool> _dirty;
+    bool _indirectionDirty;
+};
+
+}
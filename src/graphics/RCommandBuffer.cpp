@@ -0,0 +1,126 @@
+#include "common.h"
+#include "RCommandBuffer.h"
+
+namespace rocket
+{
+
+// 11-bit digits sort a 64-bit key in 6 passes.
+#define COMMAND_RADIX_BITS      11
+#define COMMAND_RADIX_SIZE      (1 << COMMAND_RADIX_BITS)
+#define COMMAND_RADIX_PASSES    6
+// Below this count the histograms cost more than a comparison sort.
+#define COMMAND_RADIX_MIN       1024
+
+static bool compareKeys(const RDrawCommand& a, const RDrawCommand& b)
+{
+    return a.key < b.key;
+}
+
+RCommandBuffer::RCommandBuffer()
+    : _sorted(true)
+{
+}
+
+RCommandBuffer::~RCommandBuffer()
+{
+}
+
+void RCommandBuffer::reserve(size_t count)
+{
+    _commands.reserve(count);
+    _scratch.reserve(count);
+    _entries.reserve(count);
+    _entryScratch.reserve(count);
+}
+
+void RCommandBuffer::add(const RDrawCommand& command)
+{
+    _commands.push_back(command);
+    _sorted = false;
+}
+
+size_t RCommandBuffer::size() const
+{
+    return _commands.size();
+}
+
+const RDrawCommand& RCommandBuffer::get(size_t index) const
+{
+    return _commands[index];
+}
+
+void RCommandBuffer::sort()
+{
+    if (_sorted)
+        return;
+    _sorted = true;
+
+    const size_t count = _commands.size();
+    if (count < 2)
+        return;
+
+    if (count < COMMAND_RADIX_MIN)
+    {
+        std::stable_sort(_commands.begin(), _commands.end(), compareKeys);
+        return;
+    }
+
+    // Sort (key, index) pairs, then move each command once.
+    _entries.resize(count);
+    _entryScratch.resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        _entries[i].key = _commands[i].key;
+        _entries[i].index = (uint32_t)i;
+    }
+
+    // One pass builds the histograms of every digit.
+    uint32_t histograms[COMMAND_RADIX_PASSES][COMMAND_RADIX_SIZE];
+    memset(histograms, 0, sizeof(histograms));
+    for (size_t i = 0; i < count; i++)
+    {
+        uint64_t key = _entries[i].key;
+        for (int p = 0; p < COMMAND_RADIX_PASSES; p++)
+            histograms[p][(key >> (p * COMMAND_RADIX_BITS)) & (COMMAND_RADIX_SIZE - 1)]++;
+    }
+
+    SortEntry* src = _entries.data();
+    SortEntry* dst = _entryScratch.data();
+    for (int p = 0; p < COMMAND_RADIX_PASSES; p++)
+    {
+        const int shift = p * COMMAND_RADIX_BITS;
+        uint32_t* histogram = histograms[p];
+        // Digits equal in every key (often the pass and layer) need no pass.
+        if (histogram[(src[0].key >> shift) & (COMMAND_RADIX_SIZE - 1)] == count)
+            continue;
+
+        uint32_t offset = 0;
+        for (int i = 0; i < COMMAND_RADIX_SIZE; i++)
+        {
+            uint32_t n = histogram[i];
+            histogram[i] = offset;
+            offset += n;
+        }
+        for (size_t i = 0; i < count; i++)
+            dst[histogram[(src[i].key >> shift) & (COMMAND_RADIX_SIZE - 1)]++] = src[i];
+        std::swap(src, dst);
+    }
+
+    _scratch.resize(count);
+    for (size_t i = 0; i < count; i++)
+        _scratch[i] = _commands[src[i].index];
+    _commands.swap(_scratch);
+}
+
+bool RCommandBuffer::isSorted() const
+{
+    return _sorted;
+}
+
+void RCommandBuffer::clear()
+{
+    _commands.clear();
+    _sorted = true;
+}
+
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "RDrawCommand.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a list of draw commands recorded by one thread.
+ *
+ * Each worker thread records into its own buffer (see RCommandQueue), so
+ * recording needs no locking. A buffer keeps its allocations when cleared,
+ * so after the first frames recording and sorting do not allocate.
+ */
+class API RCommandBuffer
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    RCommandBuffer();
+
+    /**
+     * Destructor.
+     */
+    ~RCommandBuffer();
+
+    /**
+     * Reserves space for a number of commands.
+     *
+     * @param count The number of commands.
+     */
+    void reserve(size_t count);
+
+    /**
+     * Records a command, clearing the sorted state.
+     *
+     * @param command The command.
+     */
+    void add(const RDrawCommand& command);
+
+    /**
+     * Gets the number of recorded commands.
+     *
+     * @return The number of commands.
+     */
+    size_t size() const;
+
+    /**
+     * Gets a command, in sorted order if sort() was called since the last add().
+     *
+     * @param index The index of the command.
+     *
+     * @return The command.
+     */
+    const RDrawCommand& get(size_t index) const;
+
+    /**
+     * Sorts the commands by key with a stable LSD radix sort.
+     *
+     * The keys are sorted in 11-bit digits along with command indices, then
+     * every command is moved once. Digits that are equal in every command
+     * (often the pass and layer) are skipped. Commands with equal keys keep
+     * their recording order.
+     */
+    void sort();
+
+    /**
+     * Determines if the commands are sorted.
+     *
+     * @return true if sort() was called since the last add().
+     */
+    bool isSorted() const;
+
+    /**
+     * Removes all commands, keeping the allocations.
+     */
+    void clear();
+
+private:
+
+    RCommandBuffer(const RCommandBuffer& copy);
+
+    RCommandBuffer& operator=(const RCommandBuffer&);
+
+    struct SortEntry
+    {
+        uint64_t key;
+        uint32_t index;
+    };
+
+    std::vector<RDrawCommand> _commands;
+    std::vector<RDrawCommand> _scratch;
+    std::vector<SortEntry> _entries;
+    std::vector<SortEntry> _entryScratch;
+    bool _sorted;
+};
+
+}
@@ -0,0 +1,147 @@
+#include "common.h"
+#include "RCommandQueue.h"
+
+namespace rocket
+{
+
+/**
+ * The next command of a buffer during the merge.
+ */
+struct MergeHead
+{
+    uint64_t key;
+    unsigned int buffer;
+    size_t index;
+};
+
+/**
+ * Orders the merge heap so the smallest key, then the lowest buffer, is on top.
+ */
+static inline bool mergeAfter(const MergeHead& a, const MergeHead& b)
+{
+    return a.key != b.key ? a.key > b.key : a.buffer > b.buffer;
+}
+
+RCommandQueue::RCommandQueue(unsigned int bufferCount)
+{
+    if (bufferCount == 0)
+        bufferCount = 1;
+    _buffers.resize(bufferCount);
+    for (unsigned int i = 0; i < bufferCount; i++)
+        _buffers[i] = new RCommandBuffer();
+    memset(&_statistics, 0, sizeof(_statistics));
+}
+
+RCommandQueue::~RCommandQueue()
+{
+    for (size_t i = 0; i < _buffers.size(); i++)
+        delete _buffers[i];
+}
+
+unsigned int RCommandQueue::getBufferCount() const
+{
+    return (unsigned int)_buffers.size();
+}
+
+RCommandBuffer* RCommandQueue::getBuffer(unsigned int index)
+{
+    return _buffers[index];
+}
+
+void RCommandQueue::sort()
+{
+    for (size_t i = 0; i < _buffers.size(); i++)
+        _buffers[i]->sort();
+}
+
+void RCommandQueue::execute(RRenderBackend* backend)
+{
+    memset(&_statistics, 0, sizeof(_statistics));
+    sort();
+
+    MergeHead heap[64];
+    std::vector<MergeHead> largeHeap;
+    MergeHead* heads = heap;
+    if (_buffers.size() > sizeof(heap) / sizeof(heap[0]))
+    {
+        largeHeap.resize(_buffers.size());
+        heads = largeHeap.data();
+    }
+    size_t headCount = 0;
+    for (unsigned int i = 0; i < _buffers.size(); i++)
+    {
+        if (_buffers[i]->size() > 0)
+        {
+            MergeHead head = { _buffers[i]->get(0).key, i, 0 };
+            heads[headCount++] = head;
+        }
+    }
+    std::make_heap(heads, heads + headCount, mergeAfter);
+
+    bool first = true;
+    unsigned int pass = 0;
+    uint32_t shader = 0;
+    uint32_t material = 0;
+    uint32_t mesh = 0;
+    while (headCount > 0)
+    {
+        std::pop_heap(heads, heads + headCount, mergeAfter);
+        MergeHead& head = heads[headCount - 1];
+        const RCommandBuffer* buffer = _buffers[head.buffer];
+        const RDrawCommand& command = buffer->get(head.index);
+
+        unsigned int commandPass = RSortKey::getPass(command.key);
+        if (first || commandPass != pass)
+        {
+            pass = commandPass;
+            backend->beginPass(pass);
+            _statistics.passChanges++;
+        }
+        bool shaderChanged = first || command.shader != shader;
+        if (shaderChanged)
+        {
+            shader = command.shader;
+            backend->bindShader(shader);
+            _statistics.shaderChanges++;
+        }
+        // Materials are bound after their shader, so rebind when either changes.
+        if (shaderChanged || command.material != material)
+        {
+            material = command.material;
+            backend->bindMaterial(material);
+            _statistics.materialChanges++;
+        }
+        if (first || command.mesh != mesh)
+        {
+            mesh = command.mesh;
+            backend->bindMesh(mesh);
+            _statistics.meshChanges++;
+        }
+        backend->draw(command);
+        _statistics.draws++;
+        first = false;
+
+        if (++head.index < buffer->size())
+        {
+            head.key = buffer->get(head.index).key;
+            std::push_heap(heads, heads + headCount, mergeAfter);
+        }
+        else
+        {
+            headCount--;
+        }
+    }
+}
+
+const RCommandQueue::Statistics& RCommandQueue::getStatistics() const
+{
+    return _statistics;
+}
+
+void RCommandQueue::clear()
+{
+    for (size_t i = 0; i < _buffers.size(); i++)
+        _buffers[i]->clear();
+}
+
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "RCommandBuffer.h"
+#include "RRenderBackend.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a frame's draw submission queue: one command buffer per
+ * recording thread, merged in sort key order and replayed to a backend.
+ *
+ * A frame goes:
+ *
+ * 1. Worker i records into getBuffer(i), then calls sort() on it.
+ * 2. After joining the workers, the render thread calls execute(), which
+ *    merges the sorted buffers and replays them, binding state only when
+ *    it changes.
+ * 3. clear() empties the buffers for the next frame.
+ *
+ * Commands with equal keys replay in buffer order, then recording order,
+ * so the output is deterministic whatever the thread timing.
+ */
+class API RCommandQueue
+{
+public:
+
+    /**
+     * State change counts of the last execute().
+     */
+    struct Statistics
+    {
+        unsigned int draws;
+        unsigned int passChanges;
+        unsigned int shaderChanges;
+        unsigned int materialChanges;
+        unsigned int meshChanges;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param bufferCount The number of command buffers, usually the number of recording threads.
+     */
+    explicit RCommandQueue(unsigned int bufferCount);
+
+    /**
+     * Destructor.
+     */
+    ~RCommandQueue();
+
+    /**
+     * Gets the number of command buffers.
+     *
+     * @return The number of command buffers.
+     */
+    unsigned int getBufferCount() const;
+
+    /**
+     * Gets a command buffer.
+     *
+     * @param index The index of the buffer, less than getBufferCount().
+     *
+     * @return The buffer.
+     */
+    RCommandBuffer* getBuffer(unsigned int index);
+
+    /**
+     * Sorts the buffers that are not sorted yet, on the calling thread.
+     */
+    void sort();
+
+    /**
+     * Merges the buffers in key order and replays them to a backend.
+     *
+     * Unsorted buffers are sorted first.
+     *
+     * @param backend The backend to replay to.
+     */
+    void execute(RRenderBackend* backend);
+
+    /**
+     * Gets the state change counts of the last execute().
+     *
+     * @return The statistics.
+     */
+    const Statistics& getStatistics() const;
+
+    /**
+     * Empties every buffer.
+     */
+    void clear();
+
+private:
+
+    RCommandQueue(const RCommandQueue& copy);
+
+    RCommandQueue& operator=(const RCommandQueue&);
+
+    std::vector<RCommandBuffer*> _buffers;
+    Statistics _statistics;
+};
+
+}
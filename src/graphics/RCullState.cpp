@@ -0,0 +1,71 @@
+#include "common.h"
+#include "RCullState.h"
+
+namespace rocket
+{
+
+static std::mutex cullStatesMutex;
+static std::unordered_multimap<size_t, RCullState*> cullStates;
+
+static RCullState::Description createCulling(bool enabled)
+{
+    RCullState::Description description;
+    description.enabled = enabled;
+    return description;
+}
+
+RCullState::Description::Description()
+    : enabled(true), side(SIDE_BACK), frontFace(FRONT_FACE_CCW)
+{
+}
+
+RCullState::RCullState(const Description& description, size_t hash)
+    : _description(description), _hash(hash)
+{
+}
+
+const RCullState* RCullState::get(const Description& description)
+{
+    // The front face still matters with culling disabled (gl_FrontFacing), so it is kept.
+    Description canonical = description;
+    if (!canonical.enabled)
+        canonical.side = SIDE_BACK;
+
+    size_t hash = ((size_t)canonical.side << 20) ^ ((size_t)canonical.frontFace << 1) ^ (size_t)canonical.enabled;
+
+    std::lock_guard<std::mutex> lock(cullStatesMutex);
+    auto range = cullStates.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it)
+    {
+        const Description& d = it->second->_description;
+        if (d.enabled == canonical.enabled && d.side == canonical.side && d.frontFace == canonical.frontFace)
+            return it->second;
+    }
+    RCullState* state = new RCullState(canonical, hash);
+    cullStates.insert(std::make_pair(hash, state));
+    return state;
+}
+
+const RCullState* RCullState::getBack()
+{
+    static const RCullState* state = get(createCulling(true));
+    return state;
+}
+
+const RCullState* RCullState::getNone()
+{
+    static const RCullState* state = get(createCulling(false));
+    return state;
+}
+
+const RCullState::Description& RCullState::getDescription() const
+{
+    return _description;
+}
+
+size_t RCullState::getHash() const
+{
+    return _hash;
+}
+
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "common.h"
+#include "RGL.h"
+
+namespace rocket
+{
+
+/**
+ * Defines an immutable face culling state.
+ *
+ * Like RBlendState, states are created with get() and deduplicated, so two
+ * states are equal if and only if their pointers are.
+ */
+class API RCullState
+{
+public:
+
+    /**
+     * The faces to cull.
+     */
+    enum Side
+    {
+        SIDE_BACK = GL_BACK,
+        SIDE_FRONT = GL_FRONT,
+        SIDE_FRONT_AND_BACK = GL_FRONT_AND_BACK
+    };
+
+    /**
+     * The winding of front faces.
+     */
+    enum FrontFace
+    {
+        FRONT_FACE_CCW = GL_CCW,
+        FRONT_FACE_CW = GL_CW
+    };
+
+    /**
+     * Describes a cull state. Defaults to culling back faces, counter-clockwise front faces.
+     */
+    struct Description
+    {
+        Description();
+
+        bool enabled;
+        Side side;
+        FrontFace frontFace;
+    };
+
+    /**
+     * Gets the state for a description, creating it on first use. Thread safe.
+     *
+     * @param description The description.
+     *
+     * @return The shared state.
+     */
+    static const RCullState* get(const Description& description);
+
+    /**
+     * Gets the state culling back faces.
+     */
+    static const RCullState* getBack();
+
+    /**
+     * Gets the state with culling disabled.
+     */
+    static const RCullState* getNone();
+
+    /**
+     * Gets the description of this state.
+     *
+     * @return The description.
+     */
+    const Description& getDescription() const;
+
+    /**
+     * Gets the hash of the description.
+     *
+     * @return The hash.
+     */
+    size_t getHash() const;
+
+private:
+
+    RCullState(const Description& description, size_t hash);
+
+    RCullState(const RCullState& copy);
+
+    RCullState& operator=(const RCullState&);
+
+    Description _description;
+    size_t _hash;
+};
+
+}
@@ -0,0 +1,69 @@
+#include "common.h"
+#include "RDrawCommand.h"
+
+namespace rocket
+{
+
+#define SORTKEY_MASK(bits)      ((1ull << (bits)) - 1)
+#define SORTKEY_LAYER_SHIFT     (64 - RSortKey::PASS_BITS - RSortKey::LAYER_BITS)
+#define SORTKEY_STATE_BITS      (RSortKey::SHADER_BITS + RSortKey::MATERIAL_BITS + RSortKey::MESH_BITS)
+
+static inline uint64_t packState(uint32_t shader, uint32_t material, uint32_t mesh)
+{
+    return ((uint64_t)(shader & SORTKEY_MASK(RSortKey::SHADER_BITS)) << (RSortKey::MATERIAL_BITS + RSortKey::MESH_BITS)) |
+           ((uint64_t)(material & SORTKEY_MASK(RSortKey::MATERIAL_BITS)) << RSortKey::MESH_BITS) |
+           (uint64_t)(mesh & SORTKEY_MASK(RSortKey::MESH_BITS));
+}
+
+static inline uint64_t getState(uint64_t key)
+{
+    if (RSortKey::getLayer(key) == RSortKey::TRANSLUCENT)
+        return key & SORTKEY_MASK(SORTKEY_STATE_BITS);
+    return (key >> RSortKey::DEPTH_BITS) & SORTKEY_MASK(SORTKEY_STATE_BITS);
+}
+
+uint64_t RSortKey::make(unsigned int pass, Layer layer, float depth, uint32_t shader, uint32_t material, uint32_t mesh)
+{
+    // NaN depths fail both comparisons and sort as 0.
+    float clamped = depth > 0.0f ? (depth < 1.0f ? depth : 1.0f) : 0.0f;
+    uint64_t quantized = (uint64_t)(clamped * (float)SORTKEY_MASK(DEPTH_BITS) + 0.5f);
+    uint64_t key = ((uint64_t)(pass & SORTKEY_MASK(PASS_BITS)) << (64 - PASS_BITS)) |
+                   ((uint64_t)layer << SORTKEY_LAYER_SHIFT);
+    if (layer == TRANSLUCENT)
+        return key | ((SORTKEY_MASK(DEPTH_BITS) - quantized) << SORTKEY_STATE_BITS) | packState(shader, material, mesh);
+    return key | (packState(shader, material, mesh) << DEPTH_BITS) | quantized;
+}
+
+unsigned int RSortKey::getPass(uint64_t key)
+{
+    return (unsigned int)(key >> (64 - PASS_BITS));
+}
+
+RSortKey::Layer RSortKey::getLayer(uint64_t key)
+{
+    return (Layer)((key >> SORTKEY_LAYER_SHIFT) & SORTKEY_MASK(LAYER_BITS));
+}
+
+unsigned int RSortKey::getDepth(uint64_t key)
+{
+    if (getLayer(key) == TRANSLUCENT)
+        return (unsigned int)(SORTKEY_MASK(DEPTH_BITS) - ((key >> SORTKEY_STATE_BITS) & SORTKEY_MASK(DEPTH_BITS)));
+    return (unsigned int)(key & SORTKEY_MASK(DEPTH_BITS));
+}
+
+uint32_t RSortKey::getShader(uint64_t key)
+{
+    return (uint32_t)(getState(key) >> (MATERIAL_BITS + MESH_BITS));
+}
+
+uint32_t RSortKey::getMaterial(uint64_t key)
+{
+    return (uint32_t)((getState(key) >> MESH_BITS) & SORTKEY_MASK(MATERIAL_BITS));
+}
+
+uint32_t RSortKey::getMesh(uint64_t key)
+{
+    return (uint32_t)(getState(key) & SORTKEY_MASK(MESH_BITS));
+}
+
+}
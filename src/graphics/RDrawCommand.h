@@ -0,0 +1,149 @@
+#pragma once
+
+#include "common.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a draw item recorded into an RCommandBuffer.
+ *
+ * The sort key decides the replay order, the other fields are what the
+ * render backend binds and draws. Ids are assigned by the caller (shader
+ * program, material and mesh handles); only their low bits take part in the
+ * key, the full values are always replayed.
+ */
+struct RDrawCommand
+{
+    /**
+     * The sort key, see RSortKey.
+     */
+    uint64_t key;
+
+    /**
+     * The shader to bind.
+     */
+    uint32_t shader;
+
+    /**
+     * The material (uniforms and textures) to bind.
+     */
+    uint32_t material;
+
+    /**
+     * The mesh (vertex and index buffers) to bind.
+     */
+    uint32_t mesh;
+
+    /**
+     * The first index to draw.
+     */
+    uint32_t firstIndex;
+
+    /**
+     * The number of indices to draw.
+     */
+    uint32_t indexCount;
+
+    /**
+     * The value added to each index before fetching the vertex, from
+     * RMeshPart::getBaseVertex() for parts drawn with 16-bit indices.
+     */
+    int32_t baseVertex;
+
+    /**
+     * The number of instances to draw.
+     */
+    uint32_t instanceCount;
+
+    /**
+     * The first instance to draw, the offset of per instance attributes.
+     */
+    uint32_t firstInstance;
+};
+
+/**
+ * Builds and decodes the 64-bit keys draw commands are sorted by.
+ *
+ * From the most significant bit the key holds the pass (4 bits) and the
+ * layer (2 bits), so passes replay in order and opaque geometry before
+ * translucent geometry. The remaining 58 bits depend on the layer:
+ *
+ * - OPAQUE and CUTOUT: shader (12), material (16), mesh (14), depth (16).
+ *   Draws are grouped by state to minimize state changes, then front to
+ *   back within a state so early depth testing rejects hidden pixels.
+ * - TRANSLUCENT: inverted depth (16), shader (12), material (16), mesh (14).
+ *   Draws are back to front, which blending requires, and grouped by state
+ *   only at equal depths.
+ */
+class API RSortKey
+{
+public:
+
+    /**
+     * The layers of a pass, in replay order.
+     */
+    enum Layer
+    {
+        OPAQUE = 0,
+        CUTOUT = 1,
+        TRANSLUCENT = 2
+    };
+
+    static const unsigned int PASS_BITS = 4;
+    static const unsigned int LAYER_BITS = 2;
+    static const unsigned int SHADER_BITS = 12;
+    static const unsigned int MATERIAL_BITS = 16;
+    static const unsigned int MESH_BITS = 14;
+    static const unsigned int DEPTH_BITS = 16;
+
+    /**
+     * Builds a sort key.
+     *
+     * @param pass The pass, less than 16.
+     * @param layer The layer within the pass.
+     * @param depth The view depth normalized to [0, 1], clamped.
+     * @param shader The shader id, only the low SHADER_BITS are used.
+     * @param material The material id, only the low MATERIAL_BITS are used.
+     * @param mesh The mesh id, only the low MESH_BITS are used.
+     *
+     * @return The key.
+     */
+    static uint64_t make(unsigned int pass, Layer layer, float depth, uint32_t shader, uint32_t material, uint32_t mesh);
+
+    /**
+     * Gets the pass of a key.
+     */
+    static unsigned int getPass(uint64_t key);
+
+    /**
+     * Gets the layer of a key.
+     */
+    static Layer getLayer(uint64_t key);
+
+    /**
+     * Gets the quantized depth of a key, in [0, 65535].
+     */
+    static unsigned int getDepth(uint64_t key);
+
+    /**
+     * Gets the low SHADER_BITS of the shader id of a key.
+     */
+    static uint32_t getShader(uint64_t key);
+
+    /**
+     * Gets the low MATERIAL_BITS of the material id of a key.
+     */
+    static uint32_t getMaterial(uint64_t key);
+
+    /**
+     * Gets the low MESH_BITS of the mesh id of a key.
+     */
+    static uint32_t getMesh(uint64_t key);
+
+private:
+
+    RSortKey();
+};
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+/**
+ * Includes the OpenGL headers for the types and enums used by the graphics
+ * module. Entry points are not linked, they are loaded at runtime by
+ * RGLFunctions.
+ */
+#if defined(__APPLE__)
+    #include <OpenGL/gl3.h>
+#else
+    #if defined(_WIN32)
+        #ifndef WIN32_LEAN_AND_MEAN
+            #define WIN32_LEAN_AND_MEAN
+        #endif
+        #include <windows.h>
+    #endif
+    #include <GL/gl.h>
+    #include <GL/glext.h>
+#endif
+
+#ifndef APIENTRY
+    #define APIENTRY
+#endif
+
+// S3TC and BPTC are extensions on some platforms (gl3.h on Apple has neither).
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+    #define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT        0x83F1
+    #define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT        0x83F3
+#endif
+#ifndef GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+    #define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT  0x8C4D
+    #define GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT  0x8C4F
+#endif
+#ifndef GL_COMPRESSED_RGBA_BPTC_UNORM
+    #define GL_COMPRESSED_RGBA_BPTC_UNORM           0x8E8C
+    #define GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM     0x8E8D
+#endif
@@ -0,0 +1,498 @@
+#include "common.h"
+#include "RGLApi.h"
+
+namespace rocket
+{
+
+template <typename F>
+static inline bool loadFunction(void* (*getProcAddress)(const char*), const char* name, F* dst)
+{
+    void* function = getProcAddress(name);
+    *dst = (F)function;
+    return function != NULL;
+}
+
+RGLApi::~RGLApi()
+{
+}
+
+RGLFunctions::RGLFunctions()
+    : _enable(NULL), _disable(NULL), _blendFuncSeparate(NULL), _blendEquationSeparate(NULL), _colorMask(NULL),
+      _cullFace(NULL), _frontFace(NULL), _useProgram(NULL), _activeTexture(NULL), _bindTexture(NULL),
+      _bindFramebuffer(NULL), _genTextures(NULL), _deleteTextures(NULL), _pixelStorei(NULL), _texStorage2D(NULL),
+      _texSubImage2D(NULL), _compressedTexSubImage2D(NULL), _texStorage3D(NULL), _texSubImage3D(NULL),
+      _compressedTexSubImage3D(NULL), _texParameteri(NULL), _copyImageSubData(NULL), _genBuffers(NULL), _deleteBuffers(NULL), _bindBuffer(NULL), _bufferStorage(NULL),
+      _mapBufferRange(NULL), _unmapBuffer(NULL), _getIntegerv(NULL), _fenceSync(NULL), _clientWaitSync(NULL),
+      _deleteSync(NULL)
+{
+}
+
+RGLFunctions::~RGLFunctions()
+{
+}
+
+bool RGLFunctions::load(void* (*getProcAddress)(const char* name))
+{
+    bool loaded = loadFunction(getProcAddress, "glEnable", &_enable);
+    loaded &= loadFunction(getProcAddress, "glDisable", &_disable);
+    loaded &= loadFunction(getProcAddress, "glBlendFuncSeparate", &_blendFuncSeparate);
+    loaded &= loadFunction(getProcAddress, "glBlendEquationSeparate", &_blendEquationSeparate);
+    loaded &= loadFunction(getProcAddress, "glColorMask", &_colorMask);
+    loaded &= loadFunction(getProcAddress, "glCullFace", &_cullFace);
+    loaded &= loadFunction(getProcAddress, "glFrontFace", &_frontFace);
+    loaded &= loadFunction(getProcAddress, "glUseProgram", &_useProgram);
+    loaded &= loadFunction(getProcAddress, "glActiveTexture", &_activeTexture);
+    loaded &= loadFunction(getProcAddress, "glBindTexture", &_bindTexture);
+    loaded &= loadFunction(getProcAddress, "glBindFramebuffer", &_bindFramebuffer);
+    loaded &= loadFunction(getProcAddress, "glGenTextures", &_genTextures);
+    loaded &= loadFunction(getProcAddress, "glDeleteTextures", &_deleteTextures);
+    loaded &= loadFunction(getProcAddress, "glPixelStorei", &_pixelStorei);
+    loaded &= loadFunction(getProcAddress, "glTexStorage2D", &_texStorage2D);
+    loaded &= loadFunction(getProcAddress, "glTexSubImage2D", &_texSubImage2D);
+    loaded &= loadFunction(getProcAddress, "glCompressedTexSubImage2D", &_compressedTexSubImage2D);
+    loaded &= loadFunction(getProcAddress, "glTexStorage3D", &_texStorage3D);
+    loaded &= loadFunction(getProcAddress, "glTexSubImage3D", &_texSubImage3D);
+    loaded &= loadFunction(getProcAddress, "glCompressedTexSubImage3D", &_compressedTexSubImage3D);
+    loaded &= loadFunction(getProcAddress, "glTexParameteri", &_texParameteri);
+    loaded &= loadFunction(getProcAddress, "glGenBuffers", &_genBuffers);
+    loaded &= loadFunction(getProcAddress, "glDeleteBuffers", &_deleteBuffers);
+    loaded &= loadFunction(getProcAddress, "glBindBuffer", &_bindBuffer);
+    loaded &= loadFunction(getProcAddress, "glMapBufferRange", &_mapBufferRange);
+    loaded &= loadFunction(getProcAddress, "glUnmapBuffer", &_unmapBuffer);
+    loaded &= loadFunction(getProcAddress, "glGetIntegerv", &_getIntegerv);
+    loaded &= loadFunction(getProcAddress, "glFenceSync", &_fenceSync);
+    loaded &= loadFunction(getProcAddress, "glClientWaitSync", &_clientWaitSync);
+    loaded &= loadFunction(getProcAddress, "glDeleteSync", &_deleteSync);
+    loadFunction(getProcAddress, "glBufferStorage", &_bufferStorage);
+    loadFunction(getProcAddress, "glCopyImageSubData", &_copyImageSubData);
+    return loaded;
+}
+
+void RGLFunctions::enable(GLenum capability)
+{
+    _enable(capability);
+}
+
+void RGLFunctions::disable(GLenum capability)
+{
+    _disable(capability);
+}
+
+void RGLFunctions::blendFuncSeparate(GLenum srcColor, GLenum dstColor, GLenum srcAlpha, GLenum dstAlpha)
+{
+    _blendFuncSeparate(srcColor, dstColor, srcAlpha, dstAlpha);
+}
+
+void RGLFunctions::blendEquationSeparate(GLenum colorEquation, GLenum alphaEquation)
+{
+    _blendEquationSeparate(colorEquation, alphaEquation);
+}
+
+void RGLFunctions::colorMask(bool red, bool green, bool blue, bool alpha)
+{
+    _colorMask(red ? GL_TRUE : GL_FALSE, green ? GL_TRUE : GL_FALSE, blue ? GL_TRUE : GL_FALSE, alpha ? GL_TRUE : GL_FALSE);
+}
+
+void RGLFunctions::cullFace(GLenum side)
+{
+    _cullFace(side);
+}
+
+void RGLFunctions::frontFace(GLenum winding)
+{
+    _frontFace(winding);
+}
+
+void RGLFunctions::useProgram(GLuint program)
+{
+    _useProgram(program);
+}
+
+void RGLFunctions::activeTexture(GLenum unit)
+{
+    _activeTexture(unit);
+}
+
+void RGLFunctions::bindTexture(GLenum target, GLuint texture)
+{
+    _bindTexture(target, texture);
+}
+
+void RGLFunctions::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    _bindFramebuffer(target, framebuffer);
+}
+
+GLuint RGLFunctions::genTexture()
+{
+    GLuint texture = 0;
+    _genTextures(1, &texture);
+    return texture;
+}
+
+void RGLFunctions::deleteTexture(GLuint texture)
+{
+    _deleteTextures(1, &texture);
+}
+
+void RGLFunctions::pixelStorei(GLenum name, GLint value)
+{
+    _pixelStorei(name, value);
+}
+
+void RGLFunctions::texStorage2D(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height)
+{
+    _texStorage2D(target, levels, internalFormat, width, height);
+}
+
+void RGLFunctions::texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                                 GLenum format, GLenum type, const void* pixels)
+{
+    _texSubImage2D(target, level, x, y, width, height, format, type, pixels);
+}
+
+void RGLFunctions::compressedTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                                           GLenum format, GLsizei size, const void* data)
+{
+    _compressedTexSubImage2D(target, level, x, y, width, height, format, size, data);
+}
+
+void RGLFunctions::texStorage3D(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height,
+                                GLsizei depth)
+{
+    _texStorage3D(target, levels, internalFormat, width, height, depth);
+}
+
+void RGLFunctions::texSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height,
+                                 GLsizei depth, GLenum format, GLenum type, const void* pixels)
+{
+    _texSubImage3D(target, level, x, y, z, width, height, depth, format, type, pixels);
+}
+
+void RGLFunctions::compressedTexSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width,
+                                           GLsizei height, GLsizei depth, GLenum format, GLsizei size, const void* data)
+{
+    _compressedTexSubImage3D(target, level, x, y, z, width, height, depth, format, size, data);
+}
+
+void RGLFunctions::texParameteri(GLenum target, GLenum name, GLint value)
+{
+    _texParameteri(target, name, value);
+}
+
+bool RGLFunctions::hasCopyImageSubData() const
+{
+    return _copyImageSubData != NULL;
+}
+
+void RGLFunctions::copyImageSubData(GLuint src, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ,
+                                    GLuint dst, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ,
+                                    GLsizei width, GLsizei height, GLsizei depth)
+{
+    _copyImageSubData(src, srcTarget, srcLevel, srcX, srcY, srcZ, dst, dstTarget, dstLevel, dstX, dstY, dstZ, width, height, depth);
+}
+
+GLuint RGLFunctions::genBuffer()
+{
+    GLuint buffer = 0;
+    _genBuffers(1, &buffer);
+    return buffer;
+}
+
+void RGLFunctions::deleteBuffer(GLuint buffer)
+{
+    _deleteBuffers(1, &buffer);
+}
+
+void RGLFunctions::bindBuffer(GLenum target, GLuint buffer)
+{
+    _bindBuffer(target, buffer);
+}
+
+bool RGLFunctions::hasBufferStorage() const
+{
+    return _bufferStorage != NULL;
+}
+
+void RGLFunctions::bufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+    _bufferStorage(target, size, data, flags);
+}
+
+void* RGLFunctions::mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    return _mapBufferRange(target, offset, length, access);
+}
+
+bool RGLFunctions::unmapBuffer(GLenum target)
+{
+    return _unmapBuffer(target) == GL_TRUE;
+}
+
+GLint RGLFunctions::getInteger(GLenum name)
+{
+    GLint value = 0;
+    _getIntegerv(name, &value);
+    return value;
+}
+
+GLsync RGLFunctions::fenceSync(GLenum condition, GLbitfield flags)
+{
+    return _fenceSync(condition, flags);
+}
+
+GLenum RGLFunctions::clientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+    return _clientWaitSync(sync, flags, timeout);
+}
+
+void RGLFunctions::deleteSync(GLsync sync)
+{
+    _deleteSync(sync);
+}
+
+RGLRecorder::RGLRecorder()
+    : _textures(0), _buffers(0), _copyImageSubData(true)
+{
+    clear();
+}
+
+RGLRecorder::~RGLRecorder()
+{
+}
+
+const std::vector<RGLRecorder::Call>& RGLRecorder::getCalls() const
+{
+    return _calls;
+}
+
+unsigned int RGLRecorder::getCount(CallType type) const
+{
+    return _counts[type];
+}
+
+void RGLRecorder::clear()
+{
+    _calls.clear();
+    memset(_counts, 0, sizeof(_counts));
+}
+
+void RGLRecorder::setInteger(GLenum name, GLint value)
+{
+    _integers[name] = value;
+}
+
+void RGLRecorder::setCopyImageSubData(bool supported)
+{
+    _copyImageSubData = supported;
+}
+
+void RGLRecorder::enable(GLenum capability)
+{
+    record(ENABLE, capability);
+}
+
+void RGLRecorder::disable(GLenum capability)
+{
+    record(DISABLE, capability);
+}
+
+void RGLRecorder::blendFuncSeparate(GLenum srcColor, GLenum dstColor, GLenum srcAlpha, GLenum dstAlpha)
+{
+    record(BLEND_FUNC_SEPARATE, srcColor, dstColor, srcAlpha, dstAlpha);
+}
+
+void RGLRecorder::blendEquationSeparate(GLenum colorEquation, GLenum alphaEquation)
+{
+    record(BLEND_EQUATION_SEPARATE, colorEquation, alphaEquation);
+}
+
+void RGLRecorder::colorMask(bool red, bool green, bool blue, bool alpha)
+{
+    record(COLOR_MASK, red, green, blue, alpha);
+}
+
+void RGLRecorder::cullFace(GLenum side)
+{
+    record(CULL_FACE, side);
+}
+
+void RGLRecorder::frontFace(GLenum winding)
+{
+    record(FRONT_FACE, winding);
+}
+
+void RGLRecorder::useProgram(GLuint program)
+{
+    record(USE_PROGRAM, program);
+}
+
+void RGLRecorder::activeTexture(GLenum unit)
+{
+    record(ACTIVE_TEXTURE, unit);
+}
+
+void RGLRecorder::bindTexture(GLenum target, GLuint texture)
+{
+    record(BIND_TEXTURE, target, texture);
+}
+
+void RGLRecorder::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    record(BIND_FRAMEBUFFER, target, framebuffer);
+}
+
+GLuint RGLRecorder::genTexture()
+{
+    record(GEN_TEXTURE, ++_textures);
+    return _textures;
+}
+
+void RGLRecorder::deleteTexture(GLuint texture)
+{
+    record(DELETE_TEXTURE, texture);
+}
+
+void RGLRecorder::pixelStorei(GLenum name, GLint value)
+{
+    record(PIXEL_STORE, name, (GLuint)value);
+}
+
+void RGLRecorder::texStorage2D(GLenum, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height)
+{
+    record(TEX_STORAGE_2D, (GLuint)levels, internalFormat, (GLuint)width, (GLuint)height);
+}
+
+void RGLRecorder::texSubImage2D(GLenum, GLint level, GLint, GLint, GLsizei width, GLsizei height,
+                                GLenum format, GLenum, const void*)
+{
+    record(TEX_SUB_IMAGE_2D, (GLuint)level, (GLuint)width, (GLuint)height, format);
+}
+
+void RGLRecorder::compressedTexSubImage2D(GLenum, GLint level, GLint, GLint, GLsizei width, GLsizei height,
+                                          GLenum, GLsizei size, const void*)
+{
+    record(COMPRESSED_TEX_SUB_IMAGE_2D, (GLuint)level, (GLuint)width, (GLuint)height, (GLuint)size);
+}
+
+void RGLRecorder::texStorage3D(GLenum, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei, GLsizei depth)
+{
+    record(TEX_STORAGE_3D, (GLuint)levels, internalFormat, (GLuint)width, (GLuint)depth);
+}
+
+void RGLRecorder::texSubImage3D(GLenum, GLint level, GLint, GLint, GLint, GLsizei width, GLsizei,
+                                GLsizei depth, GLenum format, GLenum, const void*)
+{
+    record(TEX_SUB_IMAGE_3D, (GLuint)level, (GLuint)width, (GLuint)depth, format);
+}
+
+void RGLRecorder::compressedTexSubImage3D(GLenum, GLint level, GLint, GLint, GLint, GLsizei width, GLsizei,
+                                          GLsizei depth, GLenum, GLsizei size, const void*)
+{
+    record(COMPRESSED_TEX_SUB_IMAGE_3D, (GLuint)level, (GLuint)width, (GLuint)depth, (GLuint)size);
+}
+
+void RGLRecorder::texParameteri(GLenum, GLenum name, GLint value)
+{
+    record(TEX_PARAMETER, name, (GLuint)value);
+}
+
+bool RGLRecorder::hasCopyImageSubData() const
+{
+    return _copyImageSubData;
+}
+
+void RGLRecorder::copyImageSubData(GLuint src, GLenum, GLint srcLevel, GLint, GLint, GLint,
+                                   GLuint dst, GLenum, GLint dstLevel, GLint, GLint, GLint, GLsizei, GLsizei, GLsizei)
+{
+    record(COPY_IMAGE_SUB_DATA, src, (GLuint)srcLevel, dst, (GLuint)dstLevel);
+}
+
+GLuint RGLRecorder::genBuffer()
+{
+    record(GEN_BUFFER, ++_buffers);
+    return _buffers;
+}
+
+void RGLRecorder::deleteBuffer(GLuint buffer)
+{
+    record(DELETE_BUFFER, buffer);
+    _bufferMemory.erase(buffer);
+}
+
+void RGLRecorder::bindBuffer(GLenum target, GLuint buffer)
+{
+    record(BIND_BUFFER, target, buffer);
+    _boundBuffers[target] = buffer;
+}
+
+bool RGLRecorder::hasBufferStorage() const
+{
+    return true;
+}
+
+void RGLRecorder::bufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+    record(BUFFER_STORAGE, target, (GLuint)size, flags);
+    std::vector<uint8_t>& memory = _bufferMemory[_boundBuffers[target]];
+    memory.assign((size_t)size, 0);
+    if (data)
+        memcpy(memory.data(), data, (size_t)size);
+}
+
+void* RGLRecorder::mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    record(MAP_BUFFER_RANGE, target, (GLuint)offset, (GLuint)length, access);
+    std::vector<uint8_t>& memory = _bufferMemory[_boundBuffers[target]];
+    if (offset < 0 || length <= 0 || (size_t)offset + (size_t)length > memory.size())
+        return NULL;
+    return memory.data() + offset;
+}
+
+bool RGLRecorder::unmapBuffer(GLenum target)
+{
+    record(UNMAP_BUFFER, target, _boundBuffers[target]);
+    return true;
+}
+
+GLint RGLRecorder::getInteger(GLenum name)
+{
+    record(GET_INTEGER, name);
+    std::map<GLenum, GLint>::const_iterator it = _integers.find(name);
+    return it != _integers.end() ? it->second : 0;
+}
+
+GLsync RGLRecorder::fenceSync(GLenum, GLbitfield)
+{
+    _signaledSyncs.push_back(false);
+    record(FENCE_SYNC, (GLuint)_signaledSyncs.size());
+    return (GLsync)(uintptr_t)_signaledSyncs.size();
+}
+
+GLenum RGLRecorder::clientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+    GLuint fence = (GLuint)(uintptr_t)sync;
+    record(CLIENT_WAIT_SYNC, fence, flags, timeout != 0);
+    if (fence == 0 || fence > _signaledSyncs.size())
+        return GL_WAIT_FAILED;
+    if (_signaledSyncs[fence - 1])
+        return GL_ALREADY_SIGNALED;
+    if (timeout == 0)
+        return GL_TIMEOUT_EXPIRED;
+    _signaledSyncs[fence - 1] = true;
+    return GL_CONDITION_SATISFIED;
+}
+
+void RGLRecorder::deleteSync(GLsync sync)
+{
+    record(DELETE_SYNC, (GLuint)(uintptr_t)sync);
+}
+
+void RGLRecorder::record(CallType type, GLuint a, GLuint b, GLuint c, GLuint d)
+{
+    Call call = { type, { a, b, c, d } };
+    _calls.push_back(call);
+    _counts[type]++;
+}
+
+}
@@ -0,0 +1,452 @@
+#pragma once
+
+#include "common.h"
+#include "RGL.h"
+
+namespace rocket
+{
+
+/**
+ * Defines the OpenGL calls that change the state tracked by RGLStateCache,
+ * the calls that create and upload textures, and the buffer and sync calls
+ * of persistently mapped stream buffers.
+ *
+ * RGLFunctions forwards them to the driver, RGLRecorder records them so
+ * that state caching can be tested without a GL context.
+ */
+class API RGLApi
+{
+public:
+
+    /**
+     * Destructor.
+     */
+    virtual ~RGLApi();
+
+    virtual void enable(GLenum capability) = 0;
+
+    virtual void disable(GLenum capability) = 0;
+
+    virtual void blendFuncSeparate(GLenum srcColor, GLenum dstColor, GLenum srcAlpha, GLenum dstAlpha) = 0;
+
+    virtual void blendEquationSeparate(GLenum colorEquation, GLenum alphaEquation) = 0;
+
+    virtual void colorMask(bool red, bool green, bool blue, bool alpha) = 0;
+
+    virtual void cullFace(GLenum side) = 0;
+
+    virtual void frontFace(GLenum winding) = 0;
+
+    virtual void useProgram(GLuint program) = 0;
+
+    virtual void activeTexture(GLenum unit) = 0;
+
+    virtual void bindTexture(GLenum target, GLuint texture) = 0;
+
+    virtual void bindFramebuffer(GLenum target, GLuint framebuffer) = 0;
+
+    virtual GLuint genTexture() = 0;
+
+    virtual void deleteTexture(GLuint texture) = 0;
+
+    virtual void pixelStorei(GLenum name, GLint value) = 0;
+
+    virtual void texStorage2D(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height) = 0;
+
+    virtual void texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                               GLenum format, GLenum type, const void* pixels) = 0;
+
+    virtual void compressedTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                                         GLenum format, GLsizei size, const void* data) = 0;
+
+    virtual void texStorage3D(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height,
+                              GLsizei depth) = 0;
+
+    virtual void texSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height,
+                               GLsizei depth, GLenum format, GLenum type, const void* pixels) = 0;
+
+    virtual void compressedTexSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width,
+                                         GLsizei height, GLsizei depth, GLenum format, GLsizei size, const void* data) = 0;
+
+    virtual void texParameteri(GLenum target, GLenum name, GLint value) = 0;
+
+    virtual bool hasCopyImageSubData() const = 0;
+
+    virtual void copyImageSubData(GLuint src, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ,
+                                  GLuint dst, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ,
+                                  GLsizei width, GLsizei height, GLsizei depth) = 0;
+
+    virtual GLuint genBuffer() = 0;
+
+    virtual void deleteBuffer(GLuint buffer) = 0;
+
+    virtual void bindBuffer(GLenum target, GLuint buffer) = 0;
+
+    /**
+     * Determines whether bufferStorage() is available, OpenGL 4.4 or ARB_buffer_storage.
+     *
+     * @return true if buffers can have immutable storage.
+     */
+    virtual bool hasBufferStorage() const = 0;
+
+    virtual void bufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags) = 0;
+
+    virtual void* mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) = 0;
+
+    virtual bool unmapBuffer(GLenum target) = 0;
+
+    virtual GLint getInteger(GLenum name) = 0;
+
+    virtual GLsync fenceSync(GLenum condition, GLbitfield flags) = 0;
+
+    virtual GLenum clientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) = 0;
+
+    virtual void deleteSync(GLsync sync) = 0;
+};
+
+/**
+ * Defines the OpenGL calls of the current context, loaded at runtime.
+ */
+class API RGLFunctions : public RGLApi
+{
+public:
+
+    /**
+     * Constructor. The functions must be loaded before use.
+     */
+    RGLFunctions();
+
+    /**
+     * Destructor.
+     */
+    ~RGLFunctions();
+
+    /**
+     * Loads the entry points with the platform's loader, for example
+     * glfwGetProcAddress or SDL_GL_GetProcAddress, on the thread that owns
+     * the context.
+     *
+     * @param getProcAddress The loader.
+     *
+     * @return true if every entry point was found, glBufferStorage() and
+     *      glCopyImageSubData() aside (see hasBufferStorage() and
+     *      hasCopyImageSubData()).
+     */
+    bool load(void* (*getProcAddress)(const char* name));
+
+    void enable(GLenum capability);
+
+    void disable(GLenum capability);
+
+    void blendFuncSeparate(GLenum srcColor, GLenum dstColor, GLenum srcAlpha, GLenum dstAlpha);
+
+    void blendEquationSeparate(GLenum colorEquation, GLenum alphaEquation);
+
+    void colorMask(bool red, bool green, bool blue, bool alpha);
+
+    void cullFace(GLenum side);
+
+    void frontFace(GLenum winding);
+
+    void useProgram(GLuint program);
+
+    void activeTexture(GLenum unit);
+
+    void bindTexture(GLenum target, GLuint texture);
+
+    void bindFramebuffer(GLenum target, GLuint framebuffer);
+
+    GLuint genTexture();
+
+    void deleteTexture(GLuint texture);
+
+    void pixelStorei(GLenum name, GLint value);
+
+    void texStorage2D(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height);
+
+    void texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                       GLenum format, GLenum type, const void* pixels);
+
+    void compressedTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                                 GLenum format, GLsizei size, const void* data);
+
+    void texStorage3D(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height, GLsizei depth);
+
+    void texSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height,
+                       GLsizei depth, GLenum format, GLenum type, const void* pixels);
+
+    void compressedTexSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height,
+                                 GLsizei depth, GLenum format, GLsizei size, const void* data);
+
+    void texParameteri(GLenum target, GLenum name, GLint value);
+
+    bool hasCopyImageSubData() const;
+
+    void copyImageSubData(GLuint src, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ,
+                          GLuint dst, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ,
+                          GLsizei width, GLsizei height, GLsizei depth);
+
+    GLuint genBuffer();
+
+    void deleteBuffer(GLuint buffer);
+
+    void bindBuffer(GLenum target, GLuint buffer);
+
+    bool hasBufferStorage() const;
+
+    void bufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+    void* mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+
+    bool unmapBuffer(GLenum target);
+
+    GLint getInteger(GLenum name);
+
+    GLsync fenceSync(GLenum condition, GLbitfield flags);
+
+    GLenum clientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout);
+
+    void deleteSync(GLsync sync);
+
+private:
+
+    void (APIENTRY* _enable)(GLenum);
+    void (APIENTRY* _disable)(GLenum);
+    void (APIENTRY* _blendFuncSeparate)(GLenum, GLenum, GLenum, GLenum);
+    void (APIENTRY* _blendEquationSeparate)(GLenum, GLenum);
+    void (APIENTRY* _colorMask)(GLboolean, GLboolean, GLboolean, GLboolean);
+    void (APIENTRY* _cullFace)(GLenum);
+    void (APIENTRY* _frontFace)(GLenum);
+    void (APIENTRY* _useProgram)(GLuint);
+    void (APIENTRY* _activeTexture)(GLenum);
+    void (APIENTRY* _bindTexture)(GLenum, GLuint);
+    void (APIENTRY* _bindFramebuffer)(GLenum, GLuint);
+    void (APIENTRY* _genTextures)(GLsizei, GLuint*);
+    void (APIENTRY* _deleteTextures)(GLsizei, const GLuint*);
+    void (APIENTRY* _pixelStorei)(GLenum, GLint);
+    void (APIENTRY* _texStorage2D)(GLenum, GLsizei, GLenum, GLsizei, GLsizei);
+    void (APIENTRY* _texSubImage2D)(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, const void*);
+    void (APIENTRY* _compressedTexSubImage2D)(GLenum, GLint, GLint, GLint, GLsizei, GLsizei, GLenum, GLsizei, const void*);
+    void (APIENTRY* _texStorage3D)(GLenum, GLsizei, GLenum, GLsizei, GLsizei, GLsizei);
+    void (APIENTRY* _texSubImage3D)(GLenum, GLint, GLint, GLint, GLint, GLsizei, GLsizei, GLsizei, GLenum, GLenum, const void*);
+    void (APIENTRY* _compressedTexSubImage3D)(GLenum, GLint, GLint, GLint, GLint, GLsizei, GLsizei, GLsizei, GLenum, GLsizei, const void*);
+    void (APIENTRY* _texParameteri)(GLenum, GLenum, GLint);
+    void (APIENTRY* _copyImageSubData)(GLuint, GLenum, GLint, GLint, GLint, GLint, GLuint, GLenum, GLint, GLint, GLint, GLint,
+                                       GLsizei, GLsizei, GLsizei);
+    void (APIENTRY* _genBuffers)(GLsizei, GLuint*);
+    void (APIENTRY* _deleteBuffers)(GLsizei, const GLuint*);
+    void (APIENTRY* _bindBuffer)(GLenum, GLuint);
+    void (APIENTRY* _bufferStorage)(GLenum, GLsizeiptr, const void*, GLbitfield);
+    void* (APIENTRY* _mapBufferRange)(GLenum, GLintptr, GLsizeiptr, GLbitfield);
+    GLboolean (APIENTRY* _unmapBuffer)(GLenum);
+    void (APIENTRY* _getIntegerv)(GLenum, GLint*);
+    GLsync (APIENTRY* _fenceSync)(GLenum, GLbitfield);
+    GLenum (APIENTRY* _clientWaitSync)(GLsync, GLbitfield, GLuint64);
+    void (APIENTRY* _deleteSync)(GLsync);
+};
+
+/**
+ * Defines an RGLApi that records the calls made to it.
+ *
+ * Buffers are backed by memory, so mapped ranges can be written. getInteger()
+ * returns the values given to setInteger(), 0 for the others. Fences are
+ * unsignaled until waited on with a timeout, as if the GPU finished during
+ * the wait.
+ */
+class API RGLRecorder : public RGLApi
+{
+public:
+
+    /**
+     * The recorded functions.
+     */
+    enum CallType
+    {
+        ENABLE,
+        DISABLE,
+        BLEND_FUNC_SEPARATE,
+        BLEND_EQUATION_SEPARATE,
+        COLOR_MASK,
+        CULL_FACE,
+        FRONT_FACE,
+        USE_PROGRAM,
+        ACTIVE_TEXTURE,
+        BIND_TEXTURE,
+        BIND_FRAMEBUFFER,
+        GEN_TEXTURE,
+        DELETE_TEXTURE,
+        PIXEL_STORE,
+        TEX_STORAGE_2D,
+        TEX_SUB_IMAGE_2D,
+        COMPRESSED_TEX_SUB_IMAGE_2D,
+        TEX_STORAGE_3D,
+        TEX_SUB_IMAGE_3D,
+        COMPRESSED_TEX_SUB_IMAGE_3D,
+        TEX_PARAMETER,
+        COPY_IMAGE_SUB_DATA,
+        GEN_BUFFER,
+        DELETE_BUFFER,
+        BIND_BUFFER,
+        BUFFER_STORAGE,
+        MAP_BUFFER_RANGE,
+        UNMAP_BUFFER,
+        GET_INTEGER,
+        FENCE_SYNC,
+        CLIENT_WAIT_SYNC,
+        DELETE_SYNC
+    };
+
+    /**
+     * A recorded call and its arguments, unused arguments are 0. Texture
+     * uploads record the level, width, height and the format (or the size
+     * of compressed data); storage records the levels, internal format,
+     * width and height. 3D calls record the depth in place of the height.
+     * Texture parameters record the name and value, copies the source
+     * texture and level, then the destination texture and level.
+     * Buffer calls record the target and buffer, storage the target, size and
+     * flags, and maps the target, offset, length and access. Sync calls
+     * record the fence and, for waits, the flags and whether the timeout is
+     * not 0.
+     */
+    struct Call
+    {
+        CallType type;
+        GLuint args[4];
+    };
+
+    /**
+     * Constructor.
+     */
+    RGLRecorder();
+
+    /**
+     * Destructor.
+     */
+    ~RGLRecorder();
+
+    /**
+     * Gets the calls recorded since construction or clear().
+     *
+     * @return The calls in order.
+     */
+    const std::vector<Call>& getCalls() const;
+
+    /**
+     * Gets the number of recorded calls of a type.
+     *
+     * @param type The type of call.
+     *
+     * @return The number of calls.
+     */
+    unsigned int getCount(CallType type) const;
+
+    /**
+     * Removes the recorded calls.
+     */
+    void clear();
+
+    /**
+     * Sets the value getInteger() returns for a name.
+     *
+     * @param name The name, for example GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+     * @param value The value.
+     */
+    void setInteger(GLenum name, GLint value);
+
+    /**
+     * Sets whether hasCopyImageSubData() reports support, true by default.
+     *
+     * @param supported Whether copies are supported.
+     */
+    void setCopyImageSubData(bool supported);
+
+    void enable(GLenum capability);
+
+    void disable(GLenum capability);
+
+    void blendFuncSeparate(GLenum srcColor, GLenum dstColor, GLenum srcAlpha, GLenum dstAlpha);
+
+    void blendEquationSeparate(GLenum colorEquation, GLenum alphaEquation);
+
+    void colorMask(bool red, bool green, bool blue, bool alpha);
+
+    void cullFace(GLenum side);
+
+    void frontFace(GLenum winding);
+
+    void useProgram(GLuint program);
+
+    void activeTexture(GLenum unit);
+
+    void bindTexture(GLenum target, GLuint texture);
+
+    void bindFramebuffer(GLenum target, GLuint framebuffer);
+
+    GLuint genTexture();
+
+    void deleteTexture(GLuint texture);
+
+    void pixelStorei(GLenum name, GLint value);
+
+    void texStorage2D(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height);
+
+    void texSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                       GLenum format, GLenum type, const void* pixels);
+
+    void compressedTexSubImage2D(GLenum target, GLint level, GLint x, GLint y, GLsizei width, GLsizei height,
+                                 GLenum format, GLsizei size, const void* data);
+
+    void texStorage3D(GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height, GLsizei depth);
+
+    void texSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height,
+                       GLsizei depth, GLenum format, GLenum type, const void* pixels);
+
+    void compressedTexSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height,
+                                 GLsizei depth, GLenum format, GLsizei size, const void* data);
+
+    void texParameteri(GLenum target, GLenum name, GLint value);
+
+    bool hasCopyImageSubData() const;
+
+    void copyImageSubData(GLuint src, GLenum srcTarget, GLint srcLevel, GLint srcX, GLint srcY, GLint srcZ,
+                          GLuint dst, GLenum dstTarget, GLint dstLevel, GLint dstX, GLint dstY, GLint dstZ,
+                          GLsizei width, GLsizei height, GLsizei depth);
+
+    GLuint genBuffer();
+
+    void deleteBuffer(GLuint buffer);
+
+    void bindBuffer(GLenum target, GLuint buffer);
+
+    bool hasBufferStorage() const;
+
+    void bufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags);
+
+    void* mapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
+
+    bool unmapBuffer(GLenum target);
+
+    GLint getInteger(GLenum name);
+
+    GLsync fenceSync(GLenum condition, GLbitfield flags);
+
+    GLenum clientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout);
+
+    void deleteSync(GLsync sync);
+
+private:
+
+    void record(CallType type, GLuint a = 0, GLuint b = 0, GLuint c = 0, GLuint d = 0);
+
+    std::vector<Call> _calls;
+    unsigned int _counts[DELETE_SYNC + 1];
+    GLuint _textures;
+    GLuint _buffers;
+    std::map<GLuint, std::vector<uint8_t>> _bufferMemory;
+    std::map<GLenum, GLuint> _boundBuffers;
+    std::map<GLenum, GLint> _integers;
+    std::vector<bool> _signaledSyncs;
+    bool _copyImageSubData;
+};
+
+}
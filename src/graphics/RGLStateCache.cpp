@@ -0,0 +1,277 @@
+#include "common.h"
+#include "RGLStateCache.h"
+
+namespace rocket
+{
+
+// Shadow value meaning "not known", no GL name or enum takes it.
+#define GLSTATE_UNKNOWN     0xffffffffu
+
+static inline int getTextureTargetIndex(GLenum target)
+{
+    switch (target)
+    {
+    case GL_TEXTURE_2D:
+        return 0;
+    case GL_TEXTURE_3D:
+        return 1;
+    case GL_TEXTURE_CUBE_MAP:
+        return 2;
+    case GL_TEXTURE_2D_ARRAY:
+        return 3;
+    default:
+        return -1;
+    }
+}
+
+RGLStateCache::RGLStateCache(RGLApi* api)
+    : _api(api)
+{
+    memset(&_statistics, 0, sizeof(_statistics));
+    invalidate();
+}
+
+RGLStateCache::~RGLStateCache()
+{
+}
+
+RGLApi* RGLStateCache::getApi() const
+{
+    return _api;
+}
+
+void RGLStateCache::invalidate()
+{
+    _blendState = NULL;
+    _cullState = NULL;
+    for (int i = 0; i < 4; i++)
+        _blendFunc[i] = GLSTATE_UNKNOWN;
+    _blendEquation[0] = _blendEquation[1] = GLSTATE_UNKNOWN;
+    _colorMask = GLSTATE_UNKNOWN;
+    _cullSide = GLSTATE_UNKNOWN;
+    _frontFace = GLSTATE_UNKNOWN;
+    _capabilities.clear();
+    _program = GLSTATE_UNKNOWN;
+    _activeUnit = GLSTATE_UNKNOWN;
+    memset(_textures, 0xff, sizeof(_textures));
+    _drawFramebuffer = GLSTATE_UNKNOWN;
+    _readFramebuffer = GLSTATE_UNKNOWN;
+}
+
+void RGLStateCache::beginFrame()
+{
+    memset(&_statistics, 0, sizeof(_statistics));
+}
+
+const RGLStateCache::Statistics& RGLStateCache::getStatistics() const
+{
+    return _statistics;
+}
+
+void RGLStateCache::setBlendState(const RBlendState* state)
+{
+    if (!state)
+        state = RBlendState::getOpaque();
+    const RBlendState::Description& d = state->getDescription();
+    if (state == _blendState)
+    {
+        _statistics.skipped += d.enabled ? 4 : 2;
+        return;
+    }
+    _blendState = state;
+
+    updateCapability(GL_BLEND, d.enabled);
+    if (d.enabled)
+    {
+        if (_blendFunc[0] != (GLenum)d.srcColor || _blendFunc[1] != (GLenum)d.dstColor ||
+            _blendFunc[2] != (GLenum)d.srcAlpha || _blendFunc[3] != (GLenum)d.dstAlpha)
+        {
+            _blendFunc[0] = d.srcColor;
+            _blendFunc[1] = d.dstColor;
+            _blendFunc[2] = d.srcAlpha;
+            _blendFunc[3] = d.dstAlpha;
+            _api->blendFuncSeparate(d.srcColor, d.dstColor, d.srcAlpha, d.dstAlpha);
+            count(true);
+        }
+        else
+        {
+            count(false);
+        }
+        if (_blendEquation[0] != (GLenum)d.colorEquation || _blendEquation[1] != (GLenum)d.alphaEquation)
+        {
+            _blendEquation[0] = d.colorEquation;
+            _blendEquation[1] = d.alphaEquation;
+            _api->blendEquationSeparate(d.colorEquation, d.alphaEquation);
+            count(true);
+        }
+        else
+        {
+            count(false);
+        }
+    }
+    if (_colorMask != d.writeMask)
+    {
+        _colorMask = d.writeMask;
+        _api->colorMask((d.writeMask & RBlendState::WRITE_RED) != 0, (d.writeMask & RBlendState::WRITE_GREEN) != 0,
+                        (d.writeMask & RBlendState::WRITE_BLUE) != 0, (d.writeMask & RBlendState::WRITE_ALPHA) != 0);
+        count(true);
+    }
+    else
+    {
+        count(false);
+    }
+}
+
+void RGLStateCache::setCullState(const RCullState* state)
+{
+    if (!state)
+        state = RCullState::getBack();
+    const RCullState::Description& d = state->getDescription();
+    if (state == _cullState)
+    {
+        _statistics.skipped += d.enabled ? 3 : 2;
+        return;
+    }
+    _cullState = state;
+
+    updateCapability(GL_CULL_FACE, d.enabled);
+    if (d.enabled)
+    {
+        if (_cullSide != (GLenum)d.side)
+        {
+            _cullSide = d.side;
+            _api->cullFace(d.side);
+            count(true);
+        }
+        else
+        {
+            count(false);
+        }
+    }
+    if (_frontFace != (GLenum)d.frontFace)
+    {
+        _frontFace = d.frontFace;
+        _api->frontFace(d.frontFace);
+        count(true);
+    }
+    else
+    {
+        count(false);
+    }
+}
+
+void RGLStateCache::setEnabled(GLenum capability, bool enabled)
+{
+    // The state objects shadow these capabilities too.
+    if (updateCapability(capability, enabled))
+    {
+        if (capability == GL_BLEND)
+            _blendState = NULL;
+        else if (capability == GL_CULL_FACE)
+            _cullState = NULL;
+    }
+}
+
+void RGLStateCache::useProgram(GLuint program)
+{
+    if (_program == program)
+    {
+        count(false);
+        return;
+    }
+    _program = program;
+    _api->useProgram(program);
+    count(true);
+}
+
+void RGLStateCache::bindTexture(unsigned int unit, GLenum target, GLuint texture)
+{
+    int index = getTextureTargetIndex(target);
+    if (unit < MAX_TEXTURE_UNITS && index >= 0 && _textures[unit][index] == texture)
+    {
+        count(false);
+        return;
+    }
+
+    GLenum activeUnit = GL_TEXTURE0 + unit;
+    if (_activeUnit != activeUnit)
+    {
+        _activeUnit = activeUnit;
+        _api->activeTexture(activeUnit);
+        count(true);
+    }
+    _api->bindTexture(target, texture);
+    count(true);
+    if (unit < MAX_TEXTURE_UNITS && index >= 0)
+        _textures[unit][index] = texture;
+}
+
+void RGLStateCache::deleteTexture(GLuint texture)
+{
+    _api->deleteTexture(texture);
+    count(true);
+    for (unsigned int unit = 0; unit < MAX_TEXTURE_UNITS; unit++)
+    {
+        for (int index = 0; index < 4; index++)
+        {
+            if (_textures[unit][index] == texture)
+                _textures[unit][index] = 0;
+        }
+    }
+}
+
+void RGLStateCache::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    bool draw = target != GL_READ_FRAMEBUFFER;
+    bool read = target != GL_DRAW_FRAMEBUFFER;
+    if ((!draw || _drawFramebuffer == framebuffer) && (!read || _readFramebuffer == framebuffer))
+    {
+        count(false);
+        return;
+    }
+    _api->bindFramebuffer(target, framebuffer);
+    count(true);
+    if (draw)
+        _drawFramebuffer = framebuffer;
+    if (read)
+        _readFramebuffer = framebuffer;
+}
+
+bool RGLStateCache::updateCapability(GLenum capability, bool enabled)
+{
+    for (size_t i = 0; i < _capabilities.size(); i++)
+    {
+        if (_capabilities[i].first == capability)
+        {
+            if (_capabilities[i].second == enabled)
+            {
+                count(false);
+                return false;
+            }
+            _capabilities[i].second = enabled;
+            if (enabled)
+                _api->enable(capability);
+            else
+                _api->disable(capability);
+            count(true);
+            return true;
+        }
+    }
+    _capabilities.push_back(std::make_pair(capability, enabled));
+    if (enabled)
+        _api->enable(capability);
+    else
+        _api->disable(capability);
+    count(true);
+    return true;
+}
+
+void RGLStateCache::count(bool issued)
+{
+    if (issued)
+        _statistics.issued++;
+    else
+        _statistics.skipped++;
+}
+
+}
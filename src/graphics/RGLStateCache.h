@@ -0,0 +1,162 @@
+#pragma once
+
+#include "RGLApi.h"
+#include "RBlendState.h"
+#include "RCullState.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a shadow copy of the OpenGL state that skips redundant calls.
+ *
+ * All binding goes through the cache, which compares each request with
+ * the state it last set and only calls GL for what differs. Blend and cull
+ * states are deduplicated objects, so rebinding the bound state costs one
+ * pointer comparison. The shadow starts unknown, so the first request for
+ * each piece of state is always issued; call invalidate() after code
+ * outside the cache changed GL state.
+ *
+ * Statistics count every GL call the requests needed, issued or skipped.
+ * A cache belongs to the thread that owns the context.
+ */
+class API RGLStateCache
+{
+public:
+
+    /**
+     * The number of texture units whose bindings are tracked.
+     */
+    static const unsigned int MAX_TEXTURE_UNITS = 32;
+
+    /**
+     * Call counts since the last beginFrame().
+     */
+    struct Statistics
+    {
+        unsigned int issued;
+        unsigned int skipped;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param api The GL calls to issue, must outlive the cache.
+     */
+    explicit RGLStateCache(RGLApi* api);
+
+    /**
+     * Destructor.
+     */
+    ~RGLStateCache();
+
+    /**
+     * Gets the GL calls the cache issues.
+     *
+     * @return The GL calls.
+     */
+    RGLApi* getApi() const;
+
+    /**
+     * Forgets the shadow state, so the next request for each piece of state is issued.
+     */
+    void invalidate();
+
+    /**
+     * Resets the statistics, call at the start of each frame.
+     */
+    void beginFrame();
+
+    /**
+     * Gets the call counts since the last beginFrame().
+     *
+     * @return The statistics.
+     */
+    const Statistics& getStatistics() const;
+
+    /**
+     * Binds a blend state.
+     *
+     * @param state The state, NULL binds RBlendState::getOpaque().
+     */
+    void setBlendState(const RBlendState* state);
+
+    /**
+     * Binds a cull state.
+     *
+     * @param state The state, NULL binds RCullState::getBack().
+     */
+    void setCullState(const RCullState* state);
+
+    /**
+     * Enables or disables a capability, such as GL_DEPTH_TEST or GL_SCISSOR_TEST.
+     *
+     * @param capability The capability.
+     * @param enabled true to enable it.
+     */
+    void setEnabled(GLenum capability, bool enabled);
+
+    /**
+     * Makes a program current.
+     *
+     * @param program The program name.
+     */
+    void useProgram(GLuint program);
+
+    /**
+     * Binds a texture to a texture unit.
+     *
+     * Bindings of GL_TEXTURE_2D, GL_TEXTURE_3D, GL_TEXTURE_CUBE_MAP and
+     * GL_TEXTURE_2D_ARRAY on the first MAX_TEXTURE_UNITS units are cached,
+     * others are always issued.
+     *
+     * @param unit The texture unit index, 0 for GL_TEXTURE0.
+     * @param target The texture target.
+     * @param texture The texture name.
+     */
+    void bindTexture(unsigned int unit, GLenum target, GLuint texture);
+
+    /**
+     * Deletes a texture. GL unbinds it from every unit it was bound to, so
+     * those bindings are shadowed as 0.
+     *
+     * @param texture The texture name.
+     */
+    void deleteTexture(GLuint texture);
+
+    /**
+     * Binds a framebuffer.
+     *
+     * @param target GL_FRAMEBUFFER, GL_DRAW_FRAMEBUFFER or GL_READ_FRAMEBUFFER.
+     * @param framebuffer The framebuffer name, 0 for the default framebuffer.
+     */
+    void bindFramebuffer(GLenum target, GLuint framebuffer);
+
+private:
+
+    RGLStateCache(const RGLStateCache& copy);
+
+    RGLStateCache& operator=(const RGLStateCache&);
+
+    bool updateCapability(GLenum capability, bool enabled);
+
+    void count(bool issued);
+
+    RGLApi* _api;
+    Statistics _statistics;
+    const RBlendState* _blendState;
+    const RCullState* _cullState;
+    GLenum _blendFunc[4];
+    GLenum _blendEquation[2];
+    unsigned int _colorMask;
+    GLenum _cullSide;
+    GLenum _frontFace;
+    std::vector<std::pair<GLenum, bool> > _capabilities;
+    GLuint _program;
+    GLenum _activeUnit;
+    GLuint _textures[MAX_TEXTURE_UNITS][4];
+    GLuint _drawFramebuffer;
+    GLuint _readFramebuffer;
+};
+
+}
@@ -0,0 +1,117 @@
+#include "common.h"
+#include "RGLStreamBuffer.h"
+
+namespace rocket
+{
+
+// How long wait() blocks in glClientWaitSync() before checking again, in nanoseconds.
+#define STREAM_BUFFER_WAIT_TIMEOUT  1000000000ull
+
+RGLStreamBuffer::RGLStreamBuffer()
+    : _api(NULL), _target(GL_ARRAY_BUFFER), _buffer(0), _memory(NULL), _size(0), _uniformAlignment(256),
+      _storageAlignment(256)
+{
+}
+
+RGLStreamBuffer::~RGLStreamBuffer()
+{
+    destroy();
+}
+
+bool RGLStreamBuffer::create(RGLApi* api, GLenum target, size_t size)
+{
+    destroy();
+    if (!api || !api->hasBufferStorage() || size == 0)
+        return false;
+
+    GLint alignment = api->getInteger(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT);
+    _uniformAlignment = alignment > 0 ? (size_t)alignment : 256;
+    alignment = api->getInteger(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT);
+    _storageAlignment = alignment > 0 ? (size_t)alignment : 256;
+
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    _api = api;
+    _target = target;
+    _buffer = api->genBuffer();
+    api->bindBuffer(target, _buffer);
+    api->bufferStorage(target, (GLsizeiptr)size, NULL, flags);
+    _memory = api->mapBufferRange(target, 0, (GLsizeiptr)size, flags);
+    if (!_memory)
+    {
+        destroy();
+        return false;
+    }
+    _size = size;
+    return true;
+}
+
+void RGLStreamBuffer::destroy()
+{
+    if (_buffer == 0)
+        return;
+    if (_memory)
+    {
+        _api->bindBuffer(_target, _buffer);
+        _api->unmapBuffer(_target);
+    }
+    _api->deleteBuffer(_buffer);
+    _buffer = 0;
+    _memory = NULL;
+    _size = 0;
+}
+
+GLuint RGLStreamBuffer::getBuffer() const
+{
+    return _buffer;
+}
+
+void* RGLStreamBuffer::getMemory() const
+{
+    return _memory;
+}
+
+size_t RGLStreamBuffer::getSize() const
+{
+    return _size;
+}
+
+size_t RGLStreamBuffer::getUniformAlignment() const
+{
+    return _uniformAlignment;
+}
+
+size_t RGLStreamBuffer::getStorageAlignment() const
+{
+    return _storageAlignment;
+}
+
+uint64_t RGLStreamBuffer::insert()
+{
+    return (uint64_t)(uintptr_t)_api->fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+bool RGLStreamBuffer::isSignaled(uint64_t fence)
+{
+    GLenum result = _api->clientWaitSync((GLsync)(uintptr_t)fence, 0, 0);
+    return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED;
+}
+
+void RGLStreamBuffer::wait(uint64_t fence)
+{
+    // Flush on the first wait so the fence is submitted, then keep waiting.
+    GLbitfield flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+    while (true)
+    {
+        GLenum result = _api->clientWaitSync((GLsync)(uintptr_t)fence, flags, STREAM_BUFFER_WAIT_TIMEOUT);
+        if (result != GL_TIMEOUT_EXPIRED)
+            return;
+        flags = 0;
+    }
+}
+
+void RGLStreamBuffer::release(uint64_t fence)
+{
+    _api->deleteSync((GLsync)(uintptr_t)fence);
+}
+
+}
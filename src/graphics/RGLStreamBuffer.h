@@ -0,0 +1,115 @@
+#pragma once
+
+#include "RGLApi.h"
+#include "RRingBuffer.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a persistently mapped GL buffer for an RRingBuffer, and the GL
+ * sync objects that fence it.
+ *
+ * The buffer is created with glBufferStorage() as persistent and coherent
+ * write-only storage (OpenGL 4.4 or ARB_buffer_storage) and stays mapped
+ * for its lifetime, so writes to allocations need no map, unmap or flush
+ * calls. Fences are glFenceSync() objects. The GL calls go through an
+ * RGLApi, so the buffer runs against an RGLRecorder without a context.
+ *
+ * Usage, with the context current:
+ *
+ *     RGLStreamBuffer buffer;
+ *     buffer.create(&functions, GL_UNIFORM_BUFFER, 4 << 20);
+ *     RRingBuffer ring(buffer.getMemory(), buffer.getSize(), &buffer);
+ *     ...
+ *     ring.allocate(size, buffer.getUniformAlignment());
+ */
+class API RGLStreamBuffer : public RRingBuffer::Fences
+{
+public:
+
+    /**
+     * Constructor.
+     */
+    RGLStreamBuffer();
+
+    /**
+     * Destructor, destroys the buffer.
+     */
+    ~RGLStreamBuffer();
+
+    /**
+     * Creates and maps the buffer in the current context.
+     *
+     * @param api The GL calls, used until destroy().
+     * @param target The target the buffer is bound to, for example GL_ARRAY_BUFFER or GL_UNIFORM_BUFFER.
+     * @param size The size in bytes.
+     *
+     * @return false if glBufferStorage() is missing or the buffer cannot be mapped.
+     */
+    bool create(RGLApi* api, GLenum target, size_t size);
+
+    /**
+     * Unmaps and deletes the buffer.
+     */
+    void destroy();
+
+    /**
+     * Gets the GL buffer name.
+     *
+     * @return The buffer, 0 before create().
+     */
+    GLuint getBuffer() const;
+
+    /**
+     * Gets the mapped memory.
+     *
+     * @return The memory, NULL before create().
+     */
+    void* getMemory() const;
+
+    /**
+     * Gets the size of the buffer.
+     *
+     * @return The size in bytes.
+     */
+    size_t getSize() const;
+
+    /**
+     * Gets the alignment of uniform buffer ranges in the context.
+     *
+     * @return GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+     */
+    size_t getUniformAlignment() const;
+
+    /**
+     * Gets the alignment of shader storage buffer ranges in the context.
+     *
+     * @return GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT.
+     */
+    size_t getStorageAlignment() const;
+
+    uint64_t insert();
+
+    bool isSignaled(uint64_t fence);
+
+    void wait(uint64_t fence);
+
+    void release(uint64_t fence);
+
+private:
+
+    RGLStreamBuffer(const RGLStreamBuffer& copy);
+
+    RGLStreamBuffer& operator=(const RGLStreamBuffer&);
+
+    RGLApi* _api;
+    GLenum _target;
+    GLuint _buffer;
+    void* _memory;
+    size_t _size;
+    size_t _uniformAlignment;
+    size_t _storageAlignment;
+};
+
+}
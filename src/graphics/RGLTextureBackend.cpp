@@ -0,0 +1,44 @@
+#include "common.h"
+#include "RGLTextureBackend.h"
+#include "RGLStateCache.h"
+
+namespace rocket
+{
+
+RGLTextureBackend::RGLTextureBackend(RGLStateCache* cache)
+    : _cache(cache)
+{
+}
+
+RGLTextureBackend::~RGLTextureBackend()
+{
+}
+
+void RGLTextureBackend::upload(RTexture2D* texture, unsigned int mip, const uint8_t* data, size_t size)
+{
+    if (mip < texture->getStorageMip())
+    {
+        // Without copies the full chain is allocated once, up front.
+        if (_cache->getApi()->hasCopyImageSubData())
+            texture->setStorageMip(_cache, mip);
+        else
+            texture->create(_cache);
+    }
+    texture->upload(_cache, mip, data, size);
+    texture->clampToResidentMips(_cache);
+}
+
+void RGLTextureBackend::evict(RTexture2D* texture, unsigned int mip)
+{
+    if (_cache->getApi()->hasCopyImageSubData())
+        texture->setStorageMip(_cache, mip);
+    texture->setResidentMip(mip);
+    texture->clampToResidentMips(_cache);
+}
+
+RGLStateCache* RGLTextureBackend::getStateCache() const
+{
+    return _cache;
+}
+
+}
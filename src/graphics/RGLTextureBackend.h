@@ -0,0 +1,63 @@
+#pragma once
+
+#include "RTextureStreamer.h"
+
+namespace rocket
+{
+
+class RGLStateCache;
+
+/**
+ * Defines the GPU side of a texture streamer backend. Storage reads are left
+ * to derived classes.
+ *
+ * Each texture's GL storage follows its resident mips: an upload of a finer
+ * mip grows the storage to it and an eviction shrinks the storage, with
+ * RTexture2D::setStorageMip(), so evicted mips free their memory. Textures
+ * do not need to be created first, the first upload creates them. After
+ * every upload and eviction GL_TEXTURE_BASE_LEVEL is clamped to the
+ * resident mip.
+ *
+ * Without glCopyImageSubData() the storage cannot be re-created, so textures
+ * are created with the full chain and eviction only clamps sampling. The
+ * budget then bounds the mips read and uploaded, not the GPU memory taken.
+ */
+class API RGLTextureBackend : public RTextureStreamer::Backend
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param cache The state cache to bind through, must outlive the backend.
+     */
+    explicit RGLTextureBackend(RGLStateCache* cache);
+
+    /**
+     * Destructor.
+     */
+    ~RGLTextureBackend();
+
+    void upload(RTexture2D* texture, unsigned int mip, const uint8_t* data, size_t size);
+
+    void evict(RTexture2D* texture, unsigned int mip);
+
+protected:
+
+    /**
+     * Gets the state cache textures are bound through.
+     *
+     * @return The state cache.
+     */
+    RGLStateCache* getStateCache() const;
+
+private:
+
+    RGLTextureBackend(const RGLTextureBackend& copy);
+
+    RGLTextureBackend& operator=(const RGLTextureBackend&);
+
+    RGLStateCache* _cache;
+};
+
+}
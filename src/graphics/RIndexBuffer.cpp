@@ -0,0 +1,338 @@
+#include "common.h"
+#include "RIndexBuffer.h"
+#include "RGL.h"
+#include "math/RSimd.h"
+
+namespace rocket
+{
+
+// The first byte of compressed indices.
+#define INDEX_CODEC_VERSION     2
+// The number of indices whose 4-bit codes are stored together.
+#define INDEX_CODEC_BLOCK       128
+// The recent indices kept by the codec, a power of two.
+#define INDEX_CODEC_FIFO        16
+// The recent indices a code can refer to, codes 1 to 14.
+#define INDEX_CODEC_HITS        14
+// The code of an index stored as a varint.
+#define INDEX_CODEC_ESCAPE      15
+// The largest size of a varint of a 32-bit value.
+#define INDEX_CODEC_VARINT      5
+// The largest difference of the indices of a 16-bit draw.
+#define INDEX_MAX_SPAN          65535u
+
+/**
+ * Gets the zigzag code of a delta, small for small deltas of either sign.
+ */
+static inline uint32_t encodeZigzag(uint32_t delta)
+{
+    return (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+}
+
+/**
+ * Unpacks the 4-bit codes of a block, code 2k in the low bits of byte k.
+ *
+ * @param src INDEX_CODEC_BLOCK / 2 bytes of codes.
+ * @param codes INDEX_CODEC_BLOCK codes, one per byte.
+ */
+static inline void unpackCodes(const uint8_t* src, uint8_t* codes)
+{
+#ifdef ROCKET_SIMD_SSE2
+    const __m128i mask = _mm_set1_epi8(0x0f);
+    for (unsigned int k = 0; k < INDEX_CODEC_BLOCK / 2; k += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + k));
+        __m128i low = _mm_and_si128(v, mask);
+        __m128i high = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+        _mm_storeu_si128((__m128i*)(codes + k * 2), _mm_unpacklo_epi8(low, high));
+        _mm_storeu_si128((__m128i*)(codes + k * 2 + 16), _mm_unpackhi_epi8(low, high));
+    }
+#else
+    for (unsigned int k = 0; k < INDEX_CODEC_BLOCK / 2; k++)
+    {
+        codes[k * 2] = src[k] & 0x0f;
+        codes[k * 2 + 1] = src[k] >> 4;
+    }
+#endif
+}
+
+RIndexBuffer::RIndexBuffer()
+    : _format(FORMAT_UINT16), _indexCount(0)
+{
+}
+
+RIndexBuffer::~RIndexBuffer()
+{
+}
+
+void RIndexBuffer::set(const uint32_t* indices, size_t indexCount, const std::vector<RMeshPart>& parts)
+{
+    std::vector<RMeshPart> ranges = parts;
+    if (ranges.empty())
+        ranges.push_back(RMeshPart(0, (uint32_t)indexCount));
+
+    // Split every part into runs of whole triangles spanning at most 65536 vertices.
+    bool wide = false;
+    _draws.clear();
+    _partDraws.assign(1, 0);
+    for (size_t p = 0; p < ranges.size(); p++)
+    {
+        const RMeshPart& part = ranges[p];
+        size_t first = std::min<size_t>(part.getFirstIndex(), indexCount);
+        size_t end = std::min<size_t>(first + part.getIndexCount(), indexCount);
+        size_t start = first;
+        uint32_t low = UINT32_MAX;
+        uint32_t high = 0;
+        for (size_t i = first; i < end; i += 3)
+        {
+            uint32_t triangleLow = UINT32_MAX;
+            uint32_t triangleHigh = 0;
+            for (size_t k = i; k < std::min(i + 3, end); k++)
+            {
+                triangleLow = std::min(triangleLow, indices[k]);
+                triangleHigh = std::max(triangleHigh, indices[k]);
+            }
+            if (triangleHigh - triangleLow > INDEX_MAX_SPAN)
+                wide = true;
+            if (i > start && std::max(high, triangleHigh) - std::min(low, triangleLow) > INDEX_MAX_SPAN)
+            {
+                _draws.push_back(RMeshPart((uint32_t)start, (uint32_t)(i - start), part.getError(),
+                                           high <= INDEX_MAX_SPAN ? 0 : low));
+                start = i;
+                low = UINT32_MAX;
+                high = 0;
+            }
+            low = std::min(low, triangleLow);
+            high = std::max(high, triangleHigh);
+        }
+        if (end > start || start == first)
+            _draws.push_back(RMeshPart((uint32_t)start, (uint32_t)(end - start), part.getError(),
+                                       high <= INDEX_MAX_SPAN || end == start ? 0 : low));
+        _partDraws.push_back((unsigned int)_draws.size());
+    }
+
+    _indexCount = indexCount;
+    if (wide)
+    {
+        _format = FORMAT_UINT32;
+        _draws.clear();
+        _partDraws.assign(1, 0);
+        for (size_t p = 0; p < ranges.size(); p++)
+        {
+            _draws.push_back(ranges[p]);
+            _partDraws.push_back((unsigned int)_draws.size());
+        }
+        _data.resize(indexCount * sizeof(uint32_t));
+        if (indexCount > 0)
+            memcpy(_data.data(), indices, indexCount * sizeof(uint32_t));
+        return;
+    }
+
+    _format = FORMAT_UINT16;
+    _data.assign(indexCount * sizeof(uint16_t), 0);
+    uint16_t* dst = (uint16_t*)_data.data();
+    for (size_t d = 0; d < _draws.size(); d++)
+    {
+        const RMeshPart& draw = _draws[d];
+        uint32_t base = draw.getBaseVertex();
+        for (uint32_t i = draw.getFirstIndex(); i < draw.getFirstIndex() + draw.getIndexCount(); i++)
+            dst[i] = (uint16_t)(indices[i] - base);
+    }
+}
+
+bool RIndexBuffer::load(const uint8_t* data, size_t size, size_t indexCount, const std::vector<RMeshPart>& parts)
+{
+    std::vector<uint32_t> indices(indexCount);
+    if (!decompress(data, size, indices.data(), indexCount))
+    {
+        set(NULL, 0, std::vector<RMeshPart>());
+        return false;
+    }
+    set(indices.data(), indexCount, parts);
+    return true;
+}
+
+RIndexBuffer::Format RIndexBuffer::getFormat() const
+{
+    return _format;
+}
+
+unsigned int RIndexBuffer::getIndexSize() const
+{
+    return _format == FORMAT_UINT16 ? 2 : 4;
+}
+
+unsigned int RIndexBuffer::getGLType() const
+{
+    return _format == FORMAT_UINT16 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+size_t RIndexBuffer::getIndexCount() const
+{
+    return _indexCount;
+}
+
+const void* RIndexBuffer::getData() const
+{
+    return _data.data();
+}
+
+size_t RIndexBuffer::getSize() const
+{
+    return _data.size();
+}
+
+uint32_t RIndexBuffer::getIndex(size_t index) const
+{
+    if (_format == FORMAT_UINT16)
+        return ((const uint16_t*)_data.data())[index];
+    return ((const uint32_t*)_data.data())[index];
+}
+
+unsigned int RIndexBuffer::getPartCount() const
+{
+    return _partDraws.empty() ? 0 : (unsigned int)_partDraws.size() - 1;
+}
+
+const RMeshPart* RIndexBuffer::getDraws(unsigned int part, unsigned int* count) const
+{
+    if (part >= getPartCount())
+    {
+        *count = 0;
+        return NULL;
+    }
+    *count = _partDraws[part + 1] - _partDraws[part];
+    return _draws.data() + _partDraws[part];
+}
+
+size_t RIndexBuffer::getCompressBound(size_t indexCount)
+{
+    size_t blocks = (indexCount + INDEX_CODEC_BLOCK - 1) / INDEX_CODEC_BLOCK;
+    return 1 + blocks * INDEX_CODEC_BLOCK / 2 + indexCount * INDEX_CODEC_VARINT;
+}
+
+void RIndexBuffer::compress(const uint32_t* indices, size_t indexCount, std::vector<uint8_t>* dst)
+{
+    dst->clear();
+    dst->reserve(getCompressBound(indexCount));
+    dst->push_back(INDEX_CODEC_VERSION);
+
+    uint32_t fifo[INDEX_CODEC_FIFO] = { 0 };
+    unsigned int head = 0;
+    uint32_t next = 0;
+    uint8_t codes[INDEX_CODEC_BLOCK / 2];
+    std::vector<uint8_t> escapes;
+    for (size_t begin = 0; begin < indexCount; begin += INDEX_CODEC_BLOCK)
+    {
+        size_t n = std::min<size_t>(INDEX_CODEC_BLOCK, indexCount - begin);
+        memset(codes, 0, sizeof(codes));
+        escapes.clear();
+        for (size_t k = 0; k < n; k++)
+        {
+            uint32_t index = indices[begin + k];
+            unsigned int code = 0;
+            if (index != next)
+            {
+                code = INDEX_CODEC_ESCAPE;
+                for (unsigned int age = 0; age < INDEX_CODEC_HITS; age++)
+                {
+                    if (fifo[(head - age) & (INDEX_CODEC_FIFO - 1)] == index)
+                    {
+                        code = age + 1;
+                        break;
+                    }
+                }
+                if (code == INDEX_CODEC_ESCAPE)
+                {
+                    uint32_t value = encodeZigzag(index - next);
+                    while (value >= 0x80)
+                    {
+                        escapes.push_back((uint8_t)(value | 0x80));
+                        value >>= 7;
+                    }
+                    escapes.push_back((uint8_t)value);
+                }
+            }
+            if (code == 0 || code == INDEX_CODEC_ESCAPE)
+            {
+                head = (head + 1) & (INDEX_CODEC_FIFO - 1);
+                fifo[head] = index;
+            }
+            if (index >= next)
+                next = index + 1;
+            codes[k >> 1] |= (uint8_t)(code << ((k & 1) * 4));
+        }
+        dst->insert(dst->end(), codes, codes + (n + 1) / 2);
+        dst->insert(dst->end(), escapes.begin(), escapes.end());
+    }
+}
+
+bool RIndexBuffer::decompress(const uint8_t* data, size_t size, uint32_t* dst, size_t indexCount)
+{
+    if (size < 1 || data[0] != INDEX_CODEC_VERSION)
+        return false;
+
+    size_t offset = 1;
+    uint32_t fifo[INDEX_CODEC_FIFO] = { 0 };
+    unsigned int head = 0;
+    uint32_t next = 0;
+    uint8_t packed[INDEX_CODEC_BLOCK / 2];
+    uint8_t codes[INDEX_CODEC_BLOCK];
+    for (size_t begin = 0; begin < indexCount; begin += INDEX_CODEC_BLOCK)
+    {
+        size_t n = std::min<size_t>(INDEX_CODEC_BLOCK, indexCount - begin);
+        size_t bytes = (n + 1) / 2;
+        if (size - offset < bytes)
+            return false;
+        if (bytes == INDEX_CODEC_BLOCK / 2)
+        {
+            unpackCodes(data + offset, codes);
+        }
+        else
+        {
+            memset(packed, 0, sizeof(packed));
+            memcpy(packed, data + offset, bytes);
+            unpackCodes(packed, codes);
+        }
+        offset += bytes;
+
+        for (size_t k = 0; k < n; k++)
+        {
+            unsigned int code = codes[k];
+            uint32_t index;
+            if (code == 0)
+            {
+                index = next;
+            }
+            else if (code < INDEX_CODEC_ESCAPE)
+            {
+                index = fifo[(head - (code - 1)) & (INDEX_CODEC_FIFO - 1)];
+            }
+            else
+            {
+                uint32_t value = 0;
+                for (unsigned int shift = 0; ; shift += 7)
+                {
+                    if (offset >= size || shift >= INDEX_CODEC_VARINT * 7)
+                        return false;
+                    uint8_t byte = data[offset++];
+                    value |= (uint32_t)(byte & 0x7f) << shift;
+                    if (byte < 0x80)
+                        break;
+                }
+                index = next + ((value >> 1) ^ (0u - (value & 1)));
+            }
+            if (code == 0 || code == INDEX_CODEC_ESCAPE)
+            {
+                head = (head + 1) & (INDEX_CODEC_FIFO - 1);
+                fifo[head] = index;
+            }
+            if (index >= next)
+                next = index + 1;
+            dst[begin + k] = index;
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "RMeshPart.h"
+
+namespace rocket
+{
+
+/**
+ * Defines the index buffer of a mesh and the parts drawn from it.
+ *
+ * set() stores 16-bit indices whenever every part fits, halving index
+ * memory and bandwidth. A part whose triangles span more than 65536
+ * vertices is split at triangle boundaries into draws that each span
+ * fewer, with a base vertex added back when drawing; indices only fall
+ * back to 32 bits when a single triangle spans more than 65536 vertices.
+ * Vertex fetch ordered meshes (see RMeshBuilder::optimizeVertexFetch())
+ * split into the fewest draws.
+ *
+ * compress() encodes indices for storage against the vertices of the
+ * triangles before them. Each index takes a 4-bit code: the next vertex
+ * not yet referenced, one of the 14 vertices most recently added to a
+ * FIFO, or an escape followed by a varint zigzag delta from the next
+ * vertex. Vertex cache and fetch optimized meshes (see RMeshBuilder) need
+ * few escapes and take under 2 bytes per triangle. decompress() unpacks
+ * the codes of 128 indices at a time with SSE2 and resolves them with a
+ * table lookup each.
+ */
+class API RIndexBuffer
+{
+public:
+
+    /**
+     * The storage format of the indices.
+     */
+    enum Format
+    {
+        FORMAT_UINT16,
+        FORMAT_UINT32
+    };
+
+    /**
+     * Constructs an empty buffer.
+     */
+    RIndexBuffer();
+
+    /**
+     * Destructor.
+     */
+    ~RIndexBuffer();
+
+    /**
+     * Sets the indices and the parts drawn from them.
+     *
+     * Parts must not overlap. Indices outside every part are not drawn and
+     * are stored as 0 in 16-bit buffers.
+     *
+     * @param indices The 32-bit indices, 3 per triangle.
+     * @param indexCount The number of indices.
+     * @param parts The parts, or an empty list for a single part of all indices.
+     */
+    void set(const uint32_t* indices, size_t indexCount, const std::vector<RMeshPart>& parts);
+
+    /**
+     * Sets the indices from compress()ed data.
+     *
+     * @param data The compressed indices.
+     * @param size The size of the data in bytes.
+     * @param indexCount The number of indices.
+     * @param parts The parts, or an empty list for a single part of all indices.
+     *
+     * @return false if the data is invalid, leaving the buffer empty.
+     */
+    bool load(const uint8_t* data, size_t size, size_t indexCount, const std::vector<RMeshPart>& parts);
+
+    /**
+     * Gets the storage format of the indices.
+     *
+     * @return The format.
+     */
+    Format getFormat() const;
+
+    /**
+     * Gets the size of an index.
+     *
+     * @return 2 or 4 bytes.
+     */
+    unsigned int getIndexSize() const;
+
+    /**
+     * Gets the GL type of the indices, for glDrawElements().
+     *
+     * @return GL_UNSIGNED_SHORT or GL_UNSIGNED_INT.
+     */
+    unsigned int getGLType() const;
+
+    /**
+     * Gets the number of indices.
+     *
+     * @return The index count.
+     */
+    size_t getIndexCount() const;
+
+    /**
+     * Gets the stored indices.
+     *
+     * @return getIndexCount() indices of getIndexSize() bytes.
+     */
+    const void* getData() const;
+
+    /**
+     * Gets the size of the stored indices.
+     *
+     * @return The size in bytes.
+     */
+    size_t getSize() const;
+
+    /**
+     * Gets a stored index, relative to the base vertex of its draw.
+     *
+     * @param index The position of the index.
+     *
+     * @return The index.
+     */
+    uint32_t getIndex(size_t index) const;
+
+    /**
+     * Gets the number of parts passed to set().
+     *
+     * @return The part count.
+     */
+    unsigned int getPartCount() const;
+
+    /**
+     * Gets the draws of a part.
+     *
+     * @param part The index of the part.
+     * @param count Set to the number of draws, 1 unless the part was split.
+     *
+     * @return The draws, each with the error of the part and its own base vertex.
+     */
+    const RMeshPart* getDraws(unsigned int part, unsigned int* count) const;
+
+    /**
+     * Gets the largest size of compress()ed indices.
+     *
+     * @param indexCount The number of indices.
+     *
+     * @return The size in bytes.
+     */
+    static size_t getCompressBound(size_t indexCount);
+
+    /**
+     * Compresses indices for storage.
+     *
+     * @param indices The indices.
+     * @param indexCount The number of indices.
+     * @param dst Set to the compressed indices.
+     */
+    static void compress(const uint32_t* indices, size_t indexCount, std::vector<uint8_t>* dst);
+
+    /**
+     * Decompresses indices.
+     *
+     * @param data The compressed indices.
+     * @param size The size of the data in bytes.
+     * @param dst indexCount indices.
+     * @param indexCount The number of indices.
+     *
+     * @return false if the data is invalid or too short.
+     */
+    static bool decompress(const uint8_t* data, size_t size, uint32_t* dst, size_t indexCount);
+
+private:
+
+    RIndexBuffer(const RIndexBuffer& copy);
+
+    RIndexBuffer& operator=(const RIndexBuffer&);
+
+    Format _format;
+    size_t _indexCount;
+    std::vector<uint8_t> _data;
+    std::vector<RMeshPart> _draws;
+    std::vector<unsigned int> _partDraws;
+};
+
+}
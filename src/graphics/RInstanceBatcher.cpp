@@ -0,0 +1,288 @@
+#include "common.h"
+#include "RInstanceBatcher.h"
+#include "RMeshInstance.h"
+#include "math/RPacking.h"
+
+namespace rocket
+{
+
+// Below this many instances per thread update() does not start threads.
+#define INSTANCE_MIN_PER_THREAD     4096
+
+/**
+ * Transforms local bounds to world space, scaling the radius by the longest axis of the matrix.
+ */
+static inline void transformBounds(const RBoundingSphere& local, const RMatrix& world, RBoundingSphere* dst)
+{
+    const float* m = world.m;
+    const RVector3& c = local.center;
+    dst->center.set(m[0] * c.x + m[4] * c.y + m[8] * c.z + m[12],
+                    m[1] * c.x + m[5] * c.y + m[9] * c.z + m[13],
+                    m[2] * c.x + m[6] * c.y + m[10] * c.z + m[14]);
+    float sx = m[0] * m[0] + m[1] * m[1] + m[2] * m[2];
+    float sy = m[4] * m[4] + m[5] * m[5] + m[6] * m[6];
+    float sz = m[8] * m[8] + m[9] * m[9] + m[10] * m[10];
+    dst->radius = local.radius * sqrt(std::max(sx, std::max(sy, sz)));
+}
+
+/**
+ * Writes a transform in a format.
+ */
+static inline void writeTransform(const RMatrix& world, RInstanceBatcher::Format format, uint8_t* dst)
+{
+    const float* m = world.m;
+    if (format == RInstanceBatcher::FORMAT_MATRIX)
+    {
+        memcpy(dst, m, 16 * sizeof(float));
+        return;
+    }
+
+    float rows[12] = { m[0], m[4], m[8], m[12],
+                       m[1], m[5], m[9], m[13],
+                       m[2], m[6], m[10], m[14] };
+    if (format == RInstanceBatcher::FORMAT_AFFINE)
+        memcpy(dst, rows, sizeof(rows));
+    else
+        RPacking::packHalf(rows, 12, (uint16_t*)dst);
+}
+
+RInstanceBatcher::RInstanceBatcher(Format format)
+    : _format(format), _buffer(NULL), _capacity(0), _jobCount(1)
+{
+    memset(&_statistics, 0, sizeof(_statistics));
+}
+
+RInstanceBatcher::~RInstanceBatcher()
+{
+    for (size_t i = 0; i < _instances.size(); i++)
+        _instances[i]->_batcher = NULL;
+}
+
+RInstanceBatcher::Format RInstanceBatcher::getFormat() const
+{
+    return _format;
+}
+
+unsigned int RInstanceBatcher::getStride() const
+{
+    return getStride(_format);
+}
+
+unsigned int RInstanceBatcher::getStride(Format format)
+{
+    switch (format)
+    {
+    case FORMAT_MATRIX:
+        return 16 * sizeof(float);
+    case FORMAT_AFFINE:
+        return 12 * sizeof(float);
+    default:
+        return 12 * sizeof(uint16_t);
+    }
+}
+
+unsigned int RInstanceBatcher::addBatch(const Batch& batch)
+{
+    _batches.push_back(batch);
+    return (unsigned int)_batches.size() - 1;
+}
+
+unsigned int RInstanceBatcher::getBatchCount() const
+{
+    return (unsigned int)_batches.size();
+}
+
+const RInstanceBatcher::Batch& RInstanceBatcher::getBatch(unsigned int index) const
+{
+    return _batches[index];
+}
+
+size_t RInstanceBatcher::getInstanceCount() const
+{
+    return _instances.size();
+}
+
+size_t RInstanceBatcher::update(const RFrustum& frustum, void* buffer, size_t capacity,
+                                RCommandBuffer* commands, unsigned int pass, RSortKey::Layer layer)
+{
+    unsigned int jobCount = (unsigned int)std::min<size_t>(getThreadCount(), _instances.size() / INSTANCE_MIN_PER_THREAD);
+    jobCount = std::max(1u, jobCount);
+    begin(frustum, buffer, capacity, jobCount);
+
+    parallelFor(jobCount, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t job = begin; job < end; job++)
+            cull((unsigned int)job);
+    });
+
+    size_t written = allocate();
+
+    parallelFor(jobCount, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t job = begin; job < end; job++)
+            write((unsigned int)job);
+    });
+
+    if (commands)
+        record(commands, pass, layer);
+    return written;
+}
+
+void RInstanceBatcher::begin(const RFrustum& frustum, void* buffer, size_t capacity, unsigned int jobCount)
+{
+    frustum.getPlanes(_planes);
+    _buffer = (uint8_t*)buffer;
+    _capacity = buffer ? capacity / getStride() : 0;
+    _jobCount = std::max(1u, jobCount);
+    _jobCounts.assign((size_t)_jobCount * _batches.size(), 0);
+    _jobOffsets.assign((size_t)_jobCount * _batches.size(), 0);
+    _firstInstances.assign(_batches.size(), 0);
+    _visibleCounts.assign(_batches.size(), 0);
+    _visible.resize(_instances.size());
+    memset(&_statistics, 0, sizeof(_statistics));
+    _statistics.instances = (unsigned int)_instances.size();
+}
+
+void RInstanceBatcher::cull(unsigned int job)
+{
+    if (job >= _jobCount)
+        return;
+
+    size_t begin, end;
+    getJobRange(job, &begin, &end);
+    unsigned int* counts = _jobCounts.data() + (size_t)job * _batches.size();
+    for (size_t i = begin; i < end; i++)
+    {
+        const RBoundingSphere& bounds = _worldBounds[i];
+        bool visible = true;
+        for (unsigned int p = 0; p < 6 && visible; p++)
+            visible = _planes[p].distance(bounds.center) >= -bounds.radius;
+        _visible[i] = visible;
+        if (visible)
+            counts[_instances[i]->_batch]++;
+    }
+}
+
+size_t RInstanceBatcher::allocate()
+{
+    // Batches are contiguous in the buffer, and within a batch the jobs are in order.
+    size_t batchCount = _batches.size();
+    size_t offset = 0;
+    for (size_t b = 0; b < batchCount; b++)
+    {
+        unsigned int visible = 0;
+        for (unsigned int job = 0; job < _jobCount; job++)
+        {
+            _jobOffsets[job * batchCount + b] = (unsigned int)(offset + visible);
+            visible += _jobCounts[job * batchCount + b];
+        }
+        size_t drawn = std::min<size_t>(visible, _capacity > offset ? _capacity - offset : 0);
+        _firstInstances[b] = (unsigned int)offset;
+        _visibleCounts[b] = (unsigned int)drawn;
+        _statistics.visible += visible;
+        _statistics.dropped += visible - (unsigned int)drawn;
+        offset += drawn;
+    }
+    return offset;
+}
+
+void RInstanceBatcher::write(unsigned int job)
+{
+    if (job >= _jobCount || !_buffer)
+        return;
+
+    size_t begin, end;
+    getJobRange(job, &begin, &end);
+    unsigned int stride = getStride();
+    unsigned int* offsets = _jobOffsets.data() + (size_t)job * _batches.size();
+    for (size_t i = begin; i < end; i++)
+    {
+        if (!_visible[i])
+            continue;
+        unsigned int batch = _instances[i]->_batch;
+        unsigned int offset = offsets[batch]++;
+        if (offset - _firstInstances[batch] < _visibleCounts[batch])
+            writeTransform(_transforms[i], _format, _buffer + (size_t)offset * stride);
+    }
+}
+
+void RInstanceBatcher::record(RCommandBuffer* commands, unsigned int pass, RSortKey::Layer layer)
+{
+    if (!commands)
+        return;
+
+    for (size_t b = 0; b < _batches.size(); b++)
+    {
+        if (_visibleCounts[b] == 0)
+            continue;
+        const Batch& batch = _batches[b];
+        RDrawCommand command;
+        command.key = RSortKey::make(pass, layer, 0.0f, batch.shader, batch.material, batch.mesh);
+        command.shader = batch.shader;
+        command.material = batch.material;
+        command.mesh = batch.mesh;
+        command.firstIndex = batch.firstIndex;
+        command.indexCount = batch.indexCount;
+        command.baseVertex = batch.baseVertex;
+        command.instanceCount = _visibleCounts[b];
+        command.firstInstance = _firstInstances[b];
+        commands->add(command);
+        _statistics.draws++;
+    }
+}
+
+unsigned int RInstanceBatcher::getVisibleCount(unsigned int batch) const
+{
+    return batch < _visibleCounts.size() ? _visibleCounts[batch] : 0;
+}
+
+unsigned int RInstanceBatcher::getFirstInstance(unsigned int batch) const
+{
+    return batch < _firstInstances.size() ? _firstInstances[batch] : 0;
+}
+
+const RInstanceBatcher::Statistics& RInstanceBatcher::getStatistics() const
+{
+    return _statistics;
+}
+
+void RInstanceBatcher::add(RMeshInstance* instance)
+{
+    instance->_index = _instances.size();
+    _instances.push_back(instance);
+    _transforms.push_back(instance->_transform);
+    _worldBounds.push_back(RBoundingSphere());
+    transformBounds(_batches[instance->_batch].bounds, instance->_transform, &_worldBounds.back());
+}
+
+void RInstanceBatcher::remove(RMeshInstance* instance)
+{
+    // Move the last instance into the hole.
+    size_t index = instance->_index;
+    size_t last = _instances.size() - 1;
+    if (index != last)
+    {
+        _instances[index] = _instances[last];
+        _instances[index]->_index = index;
+        _transforms[index] = _transforms[last];
+        _worldBounds[index] = _worldBounds[last];
+    }
+    _instances.pop_back();
+    _transforms.pop_back();
+    _worldBounds.pop_back();
+}
+
+void RInstanceBatcher::setTransform(size_t index, const RMatrix& world)
+{
+    _transforms[index] = world;
+    transformBounds(_batches[_instances[index]->_batch].bounds, world, &_worldBounds[index]);
+}
+
+void RInstanceBatcher::getJobRange(unsigned int job, size_t* begin, size_t* end) const
+{
+    size_t count = _instances.size();
+    *begin = count * job / _jobCount;
+    *end = count * (job + 1) / _jobCount;
+}
+
+}
@@ -0,0 +1,309 @@
+#pragma once
+
+#include "RCommandBuffer.h"
+#include "math/RBoundingSphere.h"
+#include "math/RFrustum.h"
+#include "utilities/Parallel.h"
+
+namespace rocket
+{
+
+class RMeshInstance;
+
+/**
+ * Defines a batcher that draws many instances of a mesh with one instanced
+ * draw per mesh and material.
+ *
+ * Each batch is a mesh part (index range) with a shader, a material and
+ * local bounds. RMeshInstance objects register with a batch and hold only
+ * a world transform. Every frame the batcher culls the instances against a
+ * frustum, writes the transforms of the visible ones into an instance
+ * buffer, one contiguous range per batch, and records one draw command per
+ * non-empty batch whose firstInstance is the start of that range.
+ *
+ * The instance buffer is memory supplied by the caller, usually a
+ * persistently mapped GL buffer, so transforms are written straight into
+ * GPU visible memory. A frame goes:
+ *
+ * 1. begin() with the frustum and the buffer.
+ * 2. cull(job) for every job, on any threads.
+ * 3. allocate() on one thread, which assigns each job a disjoint range of
+ *    the buffer in every batch.
+ * 4. write(job) for every job, on any threads.
+ * 5. record() the draws.
+ *
+ * update() runs the whole frame on up to getThreadCount() threads. Jobs
+ * are contiguous ranges of instances and the output is ordered by batch,
+ * then instance index, whatever the job count or thread timing.
+ *
+ * Adding and removing batches or instances, and setting transforms, must
+ * not happen during a frame.
+ */
+class API RInstanceBatcher : public RParallel
+{
+public:
+
+    /**
+     * The layouts of a transform in the instance buffer.
+     */
+    enum Format
+    {
+        /**
+         * The 4x4 world matrix, 16 floats in column-major order (64 bytes).
+         */
+        FORMAT_MATRIX,
+
+        /**
+         * The top three rows of the world matrix, 12 floats in row-major
+         * order (48 bytes), read by shaders as a mat3x4.
+         */
+        FORMAT_AFFINE,
+
+        /**
+         * FORMAT_AFFINE as half floats (24 bytes). Translations lose
+         * precision far from the origin, so use it for world regions that
+         * are small or translated in the shader.
+         */
+        FORMAT_AFFINE_HALF
+    };
+
+    /**
+     * A mesh part, shader and material drawn by the instances of a batch.
+     */
+    struct Batch
+    {
+        uint32_t shader;
+        uint32_t material;
+        uint32_t mesh;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+
+        /**
+         * The base vertex of the mesh part, see RMeshPart::getBaseVertex().
+         */
+        int32_t baseVertex;
+
+        /**
+         * The bounds of the mesh part in its local space.
+         */
+        RBoundingSphere bounds;
+    };
+
+    /**
+     * The counts of the last frame.
+     */
+    struct Statistics
+    {
+        /**
+         * The number of instances culled.
+         */
+        unsigned int instances;
+
+        /**
+         * The number of instances that passed culling.
+         */
+        unsigned int visible;
+
+        /**
+         * The number of visible instances that did not fit in the buffer.
+         */
+        unsigned int dropped;
+
+        /**
+         * The number of draw commands recorded.
+         */
+        unsigned int draws;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param format The layout of the transforms in the instance buffer.
+     */
+    explicit RInstanceBatcher(Format format = FORMAT_AFFINE);
+
+    /**
+     * Destructor.
+     *
+     * Instances still registered are detached and no longer draw.
+     */
+    ~RInstanceBatcher();
+
+    /**
+     * Gets the layout of the transforms in the instance buffer.
+     *
+     * @return The format.
+     */
+    Format getFormat() const;
+
+    /**
+     * Gets the size of a transform in the instance buffer.
+     *
+     * @return The stride in bytes.
+     */
+    unsigned int getStride() const;
+
+    /**
+     * Gets the size of a transform in a format.
+     *
+     * @param format The format.
+     *
+     * @return The stride in bytes.
+     */
+    static unsigned int getStride(Format format);
+
+    /**
+     * Adds a batch.
+     *
+     * @param batch The mesh part, shader and material of the batch.
+     *
+     * @return The index of the batch, passed to RMeshInstance.
+     */
+    unsigned int addBatch(const Batch& batch);
+
+    /**
+     * Gets the number of batches.
+     *
+     * @return The number of batches.
+     */
+    unsigned int getBatchCount() const;
+
+    /**
+     * Gets a batch.
+     *
+     * @param index The index of the batch.
+     *
+     * @return The batch.
+     */
+    const Batch& getBatch(unsigned int index) const;
+
+    /**
+     * Gets the number of registered instances.
+     *
+     * @return The number of instances.
+     */
+    size_t getInstanceCount() const;
+
+    /**
+     * Runs a whole frame: culls, writes the visible transforms and records the draws.
+     *
+     * @param frustum The view frustum.
+     * @param buffer The instance buffer, aligned to 4 bytes.
+     * @param capacity The size of the buffer in bytes.
+     * @param commands The command buffer to record the draws into.
+     * @param pass The pass of the draws.
+     * @param layer The layer of the draws.
+     *
+     * @return The number of transforms written.
+     */
+    size_t update(const RFrustum& frustum, void* buffer, size_t capacity,
+                  RCommandBuffer* commands, unsigned int pass, RSortKey::Layer layer = RSortKey::OPAQUE);
+
+    /**
+     * Starts a frame.
+     *
+     * @param frustum The view frustum.
+     * @param buffer The instance buffer, aligned to 4 bytes.
+     * @param capacity The size of the buffer in bytes.
+     * @param jobCount The number of jobs the instances are split into, at least 1.
+     */
+    void begin(const RFrustum& frustum, void* buffer, size_t capacity, unsigned int jobCount);
+
+    /**
+     * Culls the instances of a job. Jobs may run concurrently.
+     *
+     * @param job The job, less than the job count given to begin().
+     */
+    void cull(unsigned int job);
+
+    /**
+     * Assigns every job its ranges of the instance buffer, after all jobs are culled.
+     *
+     * Visible instances past the capacity of the buffer are dropped, from
+     * the last batches first.
+     *
+     * @return The number of transforms that will be written.
+     */
+    size_t allocate();
+
+    /**
+     * Writes the visible transforms of a job. Jobs write disjoint ranges and may run concurrently.
+     *
+     * @param job The job, less than the job count given to begin().
+     */
+    void write(unsigned int job);
+
+    /**
+     * Records one instanced draw per batch with visible instances, after allocate().
+     *
+     * The sort key depth is 0, so draws of the same state are adjacent.
+     *
+     * @param commands The command buffer to record into.
+     * @param pass The pass of the draws.
+     * @param layer The layer of the draws.
+     */
+    void record(RCommandBuffer* commands, unsigned int pass, RSortKey::Layer layer = RSortKey::OPAQUE);
+
+    /**
+     * Gets the number of instances of a batch drawn this frame, after allocate().
+     *
+     * @param batch The index of the batch.
+     *
+     * @return The number of instances.
+     */
+    unsigned int getVisibleCount(unsigned int batch) const;
+
+    /**
+     * Gets the first instance of a batch in the instance buffer, after allocate().
+     *
+     * @param batch The index of the batch.
+     *
+     * @return The index of the first transform of the batch.
+     */
+    unsigned int getFirstInstance(unsigned int batch) const;
+
+    /**
+     * Gets the counts of the last frame.
+     *
+     * @return The statistics.
+     */
+    const Statistics& getStatistics() const;
+
+private:
+
+    friend class RMeshInstance;
+
+    RInstanceBatcher(const RInstanceBatcher& copy);
+
+    RInstanceBatcher& operator=(const RInstanceBatcher&);
+
+    void add(RMeshInstance* instance);
+
+    void remove(RMeshInstance* instance);
+
+    void setTransform(size_t index, const RMatrix& world);
+
+    void getJobRange(unsigned int job, size_t* begin, size_t* end) const;
+
+    Format _format;
+    std::vector<Batch> _batches;
+    // Per instance, indexed by RMeshInstance::_index.
+    std::vector<RMeshInstance*> _instances;
+    std::vector<RMatrix> _transforms;
+    std::vector<RBoundingSphere> _worldBounds;
+    std::vector<uint8_t> _visible;
+    // The frame.
+    RPlane _planes[6];
+    uint8_t* _buffer;
+    size_t _capacity;
+    unsigned int _jobCount;
+    // Per job and batch: the visible count after cull(), the write offset after allocate().
+    std::vector<unsigned int> _jobCounts;
+    std::vector<unsigned int> _jobOffsets;
+    // Per batch: the first instance and the drawn count after allocate().
+    std::vector<unsigned int> _firstInstances;
+    std::vector<unsigned int> _visibleCounts;
+    Statistics _statistics;
+};
+
+}
@@ -0,0 +1,91 @@
+#include "common.h"
+#include "RMesh.h"
+
+namespace rocket
+{
+
+RMesh::RMesh()
+{
+}
+
+RMesh::~RMesh()
+{
+}
+
+const RBoundingSphere& RMesh::getBounds() const
+{
+    return _bounds;
+}
+
+void RMesh::setBounds(const RBoundingSphere& bounds)
+{
+    _bounds = bounds;
+}
+
+unsigned int RMesh::getLodCount() const
+{
+    return (unsigned int)_lods.size();
+}
+
+const RMeshPart& RMesh::getLod(unsigned int level) const
+{
+    return _lods[level];
+}
+
+void RMesh::setLods(const std::vector<RMeshPart>& lods)
+{
+    _lods = lods;
+    _draws.resize(lods.size());
+    for (size_t level = 0; level < lods.size(); level++)
+        _draws[level].assign(1, lods[level]);
+}
+
+const RMeshPart* RMesh::getDraws(unsigned int level, unsigned int* count) const
+{
+    *count = (unsigned int)_draws[level].size();
+    return _draws[level].data();
+}
+
+void RMesh::setDraws(unsigned int level, const std::vector<RMeshPart>& draws)
+{
+    if (level < _draws.size() && !draws.empty())
+        _draws[level] = draws;
+}
+
+float RMesh::getProjectedError(float error, const RMatrix& world, const RMatrix& viewProjection, float viewportHeight) const
+{
+    const float* w = world.m;
+    const float* m = viewProjection.m;
+    const RVector3& c = _bounds.center;
+    RVector3 center(w[0] * c.x + w[4] * c.y + w[8] * c.z + w[12],
+                    w[1] * c.x + w[5] * c.y + w[9] * c.z + w[13],
+                    w[2] * c.x + w[6] * c.y + w[10] * c.z + w[14]);
+    float sx = w[0] * w[0] + w[1] * w[1] + w[2] * w[2];
+    float sy = w[4] * w[4] + w[5] * w[5] + w[6] * w[6];
+    float sz = w[8] * w[8] + w[9] * w[9] + w[10] * w[10];
+    float scale = sqrt(std::max(sx, std::max(sy, sz)));
+
+    // The clip w of a perspective projection grows with the view depth along
+    // the fourth row; for an orthographic projection that row is (0, 0, 0, 1).
+    float depth = m[3] * center.x + m[7] * center.y + m[11] * center.z + m[15];
+    float depthScale = sqrt(m[3] * m[3] + m[7] * m[7] + m[11] * m[11]);
+    depth -= _bounds.radius * scale * depthScale;
+    if (depth <= 0.0f)
+        return FLT_MAX;
+
+    // Clip space units per world unit vertically, then pixels.
+    float clipScale = sqrt(m[1] * m[1] + m[5] * m[5] + m[9] * m[9]);
+    return error * scale * clipScale / depth * viewportHeight * 0.5f;
+}
+
+unsigned int RMesh::selectLod(const RMatrix& world, const RMatrix& viewProjection, float viewportHeight, float maxPixelError) const
+{
+    for (size_t level = _lods.size(); level > 1; level--)
+    {
+        if (getProjectedError(_lods[level - 1].getError(), world, viewProjection, viewportHeight) <= maxPixelError)
+            return (unsigned int)level - 1;
+    }
+    return 0;
+}
+
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "RMeshPart.h"
+#include "math/RBoundingSphere.h"
+#include <cfloat>
+
+namespace rocket
+{
+
+/**
+ * Defines a mesh: its bounds and its levels of detail.
+ *
+ * Level 0 is full detail and each further level is coarser, with a larger
+ * error (see RMeshBuilder::generateLods()). selectLod() projects the error
+ * of each level at the distance of the mesh and picks the coarsest level
+ * whose error stays under a pixel threshold.
+ *
+ * A level is drawn with the draws getDraws() lists: the level itself, or
+ * the ranges RIndexBuffer split it into when its 16-bit indices are
+ * relative to different base vertices.
+ */
+class API RMesh
+{
+public:
+
+    /**
+     * Constructs a mesh with no levels and empty bounds.
+     */
+    RMesh();
+
+    /**
+     * Destructor.
+     */
+    ~RMesh();
+
+    /**
+     * Gets the bounds of the mesh in its local space.
+     *
+     * @return The bounding sphere.
+     */
+    const RBoundingSphere& getBounds() const;
+
+    /**
+     * Sets the bounds of the mesh in its local space.
+     *
+     * @param bounds The bounding sphere.
+     */
+    void setBounds(const RBoundingSphere& bounds);
+
+    /**
+     * Gets the number of levels of detail.
+     *
+     * @return The level count.
+     */
+    unsigned int getLodCount() const;
+
+    /**
+     * Gets a level of detail.
+     *
+     * @param level The level, less than getLodCount().
+     *
+     * @return The index range and error of the level.
+     */
+    const RMeshPart& getLod(unsigned int level) const;
+
+    /**
+     * Sets the levels of detail, ordered from full detail with increasing
+     * error. Each level is drawn as a single draw until setDraws().
+     *
+     * @param lods The levels.
+     */
+    void setLods(const std::vector<RMeshPart>& lods);
+
+    /**
+     * Gets the draws of a level of detail.
+     *
+     * @param level The level, less than getLodCount().
+     * @param count Set to the number of draws, 1 unless the level was split.
+     *
+     * @return The draws, each with its own base vertex.
+     */
+    const RMeshPart* getDraws(unsigned int level, unsigned int* count) const;
+
+    /**
+     * Sets the draws of a level of detail, see RIndexBuffer::getDraws().
+     *
+     * @param level The level, less than getLodCount().
+     * @param draws The draws, covering the indices of the level.
+     */
+    void setDraws(unsigned int level, const std::vector<RMeshPart>& draws);
+
+    /**
+     * Gets the size an error covers on screen at the distance of the mesh.
+     *
+     * The error is measured at the point of the bounds closest to the
+     * camera, so the estimate is conservative. Perspective and orthographic
+     * projections are supported.
+     *
+     * @param error The error in local position units.
+     * @param world The world matrix of the mesh.
+     * @param viewProjection The view projection matrix of the camera.
+     * @param viewportHeight The height of the viewport in pixels.
+     *
+     * @return The error in pixels, FLT_MAX if the camera is inside the bounds.
+     */
+    float getProjectedError(float error, const RMatrix& world, const RMatrix& viewProjection, float viewportHeight) const;
+
+    /**
+     * Selects the coarsest level of detail whose projected error is at most a threshold.
+     *
+     * @param world The world matrix of the mesh.
+     * @param viewProjection The view projection matrix of the camera.
+     * @param viewportHeight The height of the viewport in pixels.
+     * @param maxPixelError The largest error allowed on screen, in pixels.
+     *
+     * @return The level, 0 if there are no levels.
+     */
+    unsigned int selectLod(const RMatrix& world, const RMatrix& viewProjection, float viewportHeight, float maxPixelError) const;
+
+private:
+
+    RBoundingSphere _bounds;
+    std::vector<RMeshPart> _lods;
+    std::vector<std::vector<RMeshPart>> _draws;
+};
+
+}
@@ -0,0 +1,1118 @@
+#include "common.h"
+#include "RMeshBuilder.h"
+#include <unordered_set>
+
+namespace rocket
+{
+
+#define MESH_BUILDER_UNUSED     0xffffffffu
+
+/**
+ * Hashes the bytes of a vertex (FNV-1a).
+ */
+static inline uint64_t hashVertex(const uint8_t* vertex, unsigned int size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned int i = 0; i < size; i++)
+        hash = (hash ^ vertex[i]) * 1099511628211ull;
+    return hash;
+}
+
+/**
+ * FIFO vertex cache model: a vertex is cached while fewer than size misses
+ * happened since its own miss. Jumping the time forgets every vertex.
+ */
+class MeshCache
+{
+public:
+
+    MeshCache(size_t vertexCount, unsigned int size) : _stamps(vertexCount, 0), _time(size + 1), _size(size) { }
+
+    unsigned int access(uint32_t vertex)
+    {
+        if (_time - _stamps[vertex] <= _size)
+            return 0;
+        _stamps[vertex] = _time++;
+        return 1;
+    }
+
+    unsigned int access(const uint32_t* triangle)
+    {
+        return access(triangle[0]) + access(triangle[1]) + access(triangle[2]);
+    }
+
+    /**
+     * Gets the age of a vertex, more than the cache size if it is not cached.
+     */
+    uint32_t getAge(uint32_t vertex) const { return _time - _stamps[vertex]; }
+
+    void reset() { _time += _size + 1; }
+
+private:
+
+    std::vector<uint32_t> _stamps;
+    uint32_t _time;
+    uint32_t _size;
+};
+
+/**
+ * Orders triangles for a vertex cache with Tipsify.
+ */
+static void orderForVertexCache(std::vector<uint32_t>* indices, size_t vertexCount, unsigned int cacheSize)
+{
+    std::vector<uint32_t>& input = *indices;
+    size_t triangleCount = input.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // Triangles adjacent to each vertex, and how many are not emitted yet.
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    std::vector<uint32_t> live(vertexCount, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+        live[input[i]]++;
+    for (size_t v = 0; v < vertexCount; v++)
+        offsets[v + 1] = offsets[v] + live[v];
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+        adjacency[cursors[input[i]]++] = (uint32_t)(i / 3);
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> deadEnd;
+    std::vector<uint32_t> candidates;
+    std::vector<uint32_t> output;
+    deadEnd.reserve(triangleCount * 3);
+    output.reserve(triangleCount * 3);
+    MeshCache cache(vertexCount, cacheSize);
+    size_t next = 0;
+    int64_t fan = input[0];
+    while (fan >= 0)
+    {
+        // Emit every remaining triangle around the fanning vertex.
+        candidates.clear();
+        for (uint32_t a = offsets[fan]; a < offsets[fan + 1]; a++)
+        {
+            uint32_t t = adjacency[a];
+            if (emitted[t])
+                continue;
+            emitted[t] = 1;
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                uint32_t v = input[t * 3 + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                cache.access(v);
+            }
+        }
+
+        // Fan next around the oldest candidate that stays cached while its triangles are emitted.
+        fan = -1;
+        int64_t best = -1;
+        for (size_t i = 0; i < candidates.size(); i++)
+        {
+            uint32_t v = candidates[i];
+            if (live[v] == 0)
+                continue;
+            int64_t age = cache.getAge(v);
+            int64_t priority = age + 2 * (int64_t)live[v] <= (int64_t)cacheSize ? age : 0;
+            if (priority > best)
+            {
+                best = priority;
+                fan = v;
+            }
+        }
+        while (fan < 0 && !deadEnd.empty())
+        {
+            uint32_t v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0)
+                fan = v;
+        }
+        for (; fan < 0 && next < vertexCount; next++)
+        {
+            if (live[next] > 0)
+                fan = (int64_t)next;
+        }
+    }
+
+    input.swap(output);
+}
+
+/**
+ * Symmetric 4x4 quadric of summed squared plane distances (Garland and Heckbert).
+ */
+struct MeshQuadric
+{
+    double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2;
+
+    void addPlane(double a, double b, double c, double d)
+    {
+        a2 += a * a; ab += a * b; ac += a * c; ad += a * d;
+        b2 += b * b; bc += b * c; bd += b * d;
+        c2 += c * c; cd += c * d;
+        d2 += d * d;
+    }
+
+    void add(const MeshQuadric& q)
+    {
+        a2 += q.a2; ab += q.ab; ac += q.ac; ad += q.ad;
+        b2 += q.b2; bc += q.bc; bd += q.bd;
+        c2 += q.c2; cd += q.cd;
+        d2 += q.d2;
+    }
+
+    double evaluate(const RVector3& p) const
+    {
+        double x = p.x, y = p.y, z = p.z;
+        double error = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+                     + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                     + c2 * z * z + 2 * cd * z
+                     + d2;
+        return error > 0.0 ? error : 0.0;
+    }
+};
+
+/**
+ * An edge collapse moving vertex from onto vertex to.
+ */
+struct MeshCollapse
+{
+    double cost;
+    uint32_t from;
+    uint32_t to;
+
+    bool operator<(const MeshCollapse& other) const { return cost < other.cost; }
+};
+
+/**
+ * Gets the normal (unnormalized) of a triangle.
+ */
+static inline RVector3 getTriangleNormal(const RVector3& p0, const RVector3& p1, const RVector3& p2)
+{
+    RVector3 normal;
+    RVector3::cross(p1 - p0, p2 - p0, &normal);
+    return normal;
+}
+
+/**
+ * Gets the transform from the snorm16 range to a box of positions.
+ */
+static inline void getPositionDecode(const RVector3& min, const RVector3& max, RVector3* offset, RVector3* scale)
+{
+    *offset = (min + max) * 0.5f;
+    *scale = (max - min) * 0.5f;
+    // A flat box still needs a scale to divide by.
+    scale->set(scale->x > 0.0f ? scale->x : 1.0f, scale->y > 0.0f ? scale->y : 1.0f, scale->z > 0.0f ? scale->z : 1.0f);
+}
+
+/**
+ * Gets the compact formats of a semantic, from the smallest.
+ */
+static inline unsigned int getCandidateFormats(RVertexDeclaration::Semantic semantic, RVertexDeclaration::Format* formats)
+{
+    switch (semantic)
+    {
+    case RVertexDeclaration::SEMANTIC_POSITION:
+        formats[0] = RVertexDeclaration::FORMAT_SNORM16_4;
+        formats[1] = RVertexDeclaration::FORMAT_HALF4;
+        return 2;
+    case RVertexDeclaration::SEMANTIC_NORMAL:
+        formats[0] = RVertexDeclaration::FORMAT_OCTAHEDRAL8;
+        formats[1] = RVertexDeclaration::FORMAT_OCTAHEDRAL16;
+        return 2;
+    case RVertexDeclaration::SEMANTIC_TANGENT:
+        formats[0] = RVertexDeclaration::FORMAT_SNORM_10_10_10_2;
+        formats[1] = RVertexDeclaration::FORMAT_SNORM16_4;
+        return 2;
+    case RVertexDeclaration::SEMANTIC_COLOR:
+        formats[0] = RVertexDeclaration::FORMAT_UNORM8_4;
+        formats[1] = RVertexDeclaration::FORMAT_UNORM16_4;
+        formats[2] = RVertexDeclaration::FORMAT_HALF4;
+        return 3;
+    default:
+        formats[0] = RVertexDeclaration::FORMAT_UNORM16_2;
+        formats[1] = RVertexDeclaration::FORMAT_HALF2;
+        formats[2] = RVertexDeclaration::FORMAT_HALF4;
+        return 3;
+    }
+}
+
+/**
+ * Gets the largest error of decoded attributes, measured as the semantic requires.
+ */
+static float getAttributeError(RVertexDeclaration::Semantic semantic, const float* source, const float* decoded,
+                               size_t count, unsigned int components)
+{
+    float error = 0.0f;
+    for (size_t i = 0; i < count; i++)
+    {
+        const float* a = &source[i * 4];
+        const float* b = &decoded[i * 4];
+        if (semantic == RVertexDeclaration::SEMANTIC_POSITION)
+        {
+            RVector3 p(components > 0 ? a[0] : 0.0f, components > 1 ? a[1] : 0.0f, components > 2 ? a[2] : 0.0f);
+            error = std::max(error, p.distance(RVector3(b[0], b[1], b[2])));
+        }
+        else if (semantic == RVertexDeclaration::SEMANTIC_NORMAL || semantic == RVertexDeclaration::SEMANTIC_TANGENT)
+        {
+            // Tangents must keep the bitangent sign in w.
+            if (semantic == RVertexDeclaration::SEMANTIC_TANGENT && components > 3 && (a[3] < 0.0f) != (b[3] < 0.0f))
+                return FLT_MAX;
+            RVector3 u(a[0], a[1], a[2]);
+            RVector3 v(b[0], b[1], b[2]);
+            float length = u.length() * v.length();
+            if (length > 0.0f)
+                error = std::max(error, (float)acos(std::min(std::max(u.dot(v) / length, -1.0f), 1.0f)));
+            else if (u.length() > 0.0f)
+                return FLT_MAX;
+        }
+        else
+        {
+            for (unsigned int c = 0; c < components; c++)
+                error = std::max(error, fabs(a[c] - b[c]));
+        }
+    }
+    return error;
+}
+
+RMeshBuilder::RMeshBuilder(unsigned int vertexSize, unsigned int positionOffset)
+    : _vertexSize(std::max(vertexSize, 1u)), _positionOffset(positionOffset), _cacheSize(16)
+{
+}
+
+RMeshBuilder::~RMeshBuilder()
+{
+}
+
+unsigned int RMeshBuilder::getVertexSize() const
+{
+    return _vertexSize;
+}
+
+unsigned int RMeshBuilder::getPositionOffset() const
+{
+    return _positionOffset;
+}
+
+unsigned int RMeshBuilder::getCacheSize() const
+{
+    return _cacheSize;
+}
+
+void RMeshBuilder::setCacheSize(unsigned int size)
+{
+    _cacheSize = std::max(size, 3u);
+}
+
+uint32_t RMeshBuilder::addVertex(const void* vertex)
+{
+    uint32_t index = (uint32_t)getVertexCount();
+    addVertices(vertex, 1);
+    return index;
+}
+
+void RMeshBuilder::addVertices(const void* vertices, size_t count)
+{
+    const uint8_t* bytes = (const uint8_t*)vertices;
+    _vertices.insert(_vertices.end(), bytes, bytes + count * _vertexSize);
+}
+
+void RMeshBuilder::addTriangle(uint32_t a, uint32_t b, uint32_t c)
+{
+    _indices.push_back(a);
+    _indices.push_back(b);
+    _indices.push_back(c);
+}
+
+void RMeshBuilder::addTriangles(const uint32_t* indices, size_t count)
+{
+    _indices.insert(_indices.end(), indices, indices + count * 3);
+}
+
+void RMeshBuilder::clear()
+{
+    _vertices.clear();
+    _indices.clear();
+}
+
+size_t RMeshBuilder::getVertexCount() const
+{
+    return _vertices.size() / _vertexSize;
+}
+
+const uint8_t* RMeshBuilder::getVertices() const
+{
+    return _vertices.data();
+}
+
+RVector3 RMeshBuilder::getPosition(uint32_t index) const
+{
+    RVector3 position;
+    memcpy(&position.x, &_vertices[(size_t)index * _vertexSize + _positionOffset], 3 * sizeof(float));
+    return position;
+}
+
+size_t RMeshBuilder::getIndexCount() const
+{
+    return _indices.size();
+}
+
+const uint32_t* RMeshBuilder::getIndices() const
+{
+    return _indices.data();
+}
+
+RMeshBuilder::Statistics RMeshBuilder::getStatistics() const
+{
+    size_t vertexCount = getVertexCount();
+    Statistics statistics;
+    statistics.vertexCount = (unsigned int)vertexCount;
+    statistics.triangleCount = (unsigned int)(_indices.size() / 3);
+
+    MeshCache cache(vertexCount, _cacheSize);
+    std::vector<uint8_t> referenced(vertexCount, 0);
+    unsigned int misses = 0;
+    unsigned int referencedCount = 0;
+    for (size_t i = 0; i < _indices.size(); i++)
+    {
+        misses += cache.access(_indices[i]);
+        referencedCount += referenced[_indices[i]] ? 0 : 1;
+        referenced[_indices[i]] = 1;
+    }
+    statistics.acmr = statistics.triangleCount ? (float)misses / statistics.triangleCount : 0.0f;
+    statistics.atvr = referencedCount ? (float)misses / referencedCount : 0.0f;
+    return statistics;
+}
+
+RMeshBuilder::Statistics RMeshBuilder::deduplicate()
+{
+    size_t vertexCount = getVertexCount();
+    size_t tableSize = 1;
+    while (tableSize < vertexCount * 2)
+        tableSize *= 2;
+    size_t mask = tableSize - 1;
+
+    // Unique vertices are compacted to the front as they are found, the
+    // table holds their new indices. A vertex is only overwritten after
+    // it has been read, since the write position never passes the read one.
+    std::vector<uint32_t> table(tableSize, MESH_BUILDER_UNUSED);
+    std::vector<uint32_t> remap(vertexCount);
+    uint32_t unique = 0;
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        const uint8_t* vertex = &_vertices[v * _vertexSize];
+        size_t slot = (size_t)hashVertex(vertex, _vertexSize) & mask;
+        while (table[slot] != MESH_BUILDER_UNUSED &&
+               memcmp(&_vertices[(size_t)table[slot] * _vertexSize], vertex, _vertexSize) != 0)
+            slot = (slot + 1) & mask;
+
+        if (table[slot] != MESH_BUILDER_UNUSED)
+        {
+            remap[v] = table[slot];
+            continue;
+        }
+        if (unique != v)
+            memcpy(&_vertices[(size_t)unique * _vertexSize], vertex, _vertexSize);
+        table[slot] = unique;
+        remap[v] = unique++;
+    }
+
+    // Triangles left with two identical vertices cover no pixels and are dropped.
+    _vertices.resize((size_t)unique * _vertexSize);
+    size_t indexCount = 0;
+    for (size_t i = 0; i + 2 < _indices.size(); i += 3)
+    {
+        uint32_t a = remap[_indices[i]], b = remap[_indices[i + 1]], c = remap[_indices[i + 2]];
+        if (a == b || b == c || c == a)
+            continue;
+        _indices[indexCount++] = a;
+        _indices[indexCount++] = b;
+        _indices[indexCount++] = c;
+    }
+    _indices.resize(indexCount);
+    return getStatistics();
+}
+
+RMeshBuilder::Statistics RMeshBuilder::optimizeVertexCache()
+{
+    orderForVertexCache(&_indices, getVertexCount(), _cacheSize);
+    return getStatistics();
+}
+
+RMeshBuilder::Statistics RMeshBuilder::optimizeOverdraw(float threshold)
+{
+    size_t vertexCount = getVertexCount();
+    size_t triangleCount = _indices.size() / 3;
+    if (triangleCount < 2)
+        return getStatistics();
+
+    // Hard boundaries: triangles that miss on all three vertices start a new region.
+    MeshCache cache(vertexCount, _cacheSize);
+    std::vector<uint32_t> hard;
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        if (cache.access(&_indices[t * 3]) == 3)
+            hard.push_back((uint32_t)t);
+    }
+    // A first triangle with repeated vertices misses on fewer than three.
+    if (hard.empty() || hard[0] != 0)
+        hard.insert(hard.begin(), 0);
+    hard.push_back((uint32_t)triangleCount);
+
+    // Soft boundaries: split a region once a prefix, simulated from a cold
+    // cache, is within threshold of the ACMR of the whole region.
+    std::vector<uint32_t> clusters;
+    for (size_t h = 0; h + 1 < hard.size(); h++)
+    {
+        uint32_t begin = hard[h];
+        uint32_t end = hard[h + 1];
+        cache.reset();
+        unsigned int misses = 0;
+        for (uint32_t t = begin; t < end; t++)
+            misses += cache.access(&_indices[t * 3]);
+        float limit = threshold * misses / (end - begin);
+
+        cache.reset();
+        clusters.push_back(begin);
+        uint32_t start = begin;
+        misses = 0;
+        for (uint32_t t = begin; t + 1 < end; t++)
+        {
+            misses += cache.access(&_indices[t * 3]);
+            if (misses <= limit * (t - start + 1))
+            {
+                clusters.push_back(t + 1);
+                start = t + 1;
+                misses = 0;
+                cache.reset();
+            }
+        }
+    }
+    size_t clusterCount = clusters.size();
+    clusters.push_back((uint32_t)triangleCount);
+
+    // The area weighted centroid and normal of each cluster and of the mesh.
+    std::vector<RVector3> centroids(clusterCount);
+    std::vector<RVector3> normals(clusterCount);
+    RVector3 meshCentroid;
+    float meshArea = 0.0f;
+    for (size_t c = 0; c < clusterCount; c++)
+    {
+        RVector3 centroid;
+        RVector3 normal;
+        float area = 0.0f;
+        for (uint32_t t = clusters[c]; t < clusters[c + 1]; t++)
+        {
+            RVector3 p0 = getPosition(_indices[t * 3]);
+            RVector3 p1 = getPosition(_indices[t * 3 + 1]);
+            RVector3 p2 = getPosition(_indices[t * 3 + 2]);
+            RVector3 cross;
+            RVector3::cross(p1 - p0, p2 - p0, &cross);
+            float a = cross.length();
+            centroid += (p0 + p1 + p2) * (a / 3.0f);
+            normal += cross;
+            area += a;
+        }
+        meshCentroid += centroid;
+        meshArea += area;
+        centroids[c] = area > 0.0f ? centroid * (1.0f / area) : getPosition(_indices[clusters[c] * 3]);
+        normals[c] = normal;
+    }
+    if (meshArea > 0.0f)
+        meshCentroid *= 1.0f / meshArea;
+
+    // Clusters facing out of the mesh draw first.
+    std::vector<float> keys(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++)
+    {
+        float length = normals[c].length();
+        keys[c] = length > 0.0f ? (centroids[c] - meshCentroid).dot(normals[c]) / length : 0.0f;
+    }
+    std::vector<uint32_t> order(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++)
+        order[c] = (uint32_t)c;
+    std::stable_sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] > keys[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(_indices.size());
+    for (size_t i = 0; i < clusterCount; i++)
+    {
+        uint32_t c = order[i];
+        output.insert(output.end(), _indices.begin() + clusters[c] * 3, _indices.begin() + clusters[c + 1] * 3);
+    }
+    _indices.swap(output);
+    return getStatistics();
+}
+
+RMeshBuilder::Statistics RMeshBuilder::optimizeVertexFetch()
+{
+    size_t vertexCount = getVertexCount();
+    std::vector<uint32_t> remap(vertexCount, MESH_BUILDER_UNUSED);
+    uint32_t next = 0;
+    for (size_t i = 0; i < _indices.size(); i++)
+    {
+        uint32_t& index = _indices[i];
+        if (remap[index] == MESH_BUILDER_UNUSED)
+            remap[index] = next++;
+        index = remap[index];
+    }
+
+    std::vector<uint8_t> vertices((size_t)next * _vertexSize);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        if (remap[v] != MESH_BUILDER_UNUSED)
+            memcpy(&vertices[(size_t)remap[v] * _vertexSize], &_vertices[v * _vertexSize], _vertexSize);
+    }
+    _vertices.swap(vertices);
+    return getStatistics();
+}
+
+RBoundingSphere RMeshBuilder::getBounds() const
+{
+    size_t vertexCount = getVertexCount();
+    if (vertexCount == 0)
+        return RBoundingSphere();
+
+    RVector3 min, max;
+    getBox(&min, &max);
+    RVector3 center = (min + max) * 0.5f;
+    float radius = 0.0f;
+    for (size_t v = 0; v < vertexCount; v++)
+        radius = std::max(radius, center.distanceSquared(getPosition((uint32_t)v)));
+    return RBoundingSphere(center, sqrt(radius));
+}
+
+void RMeshBuilder::getBox(RVector3* min, RVector3* max) const
+{
+    *min = RVector3::zero();
+    *max = RVector3::zero();
+    size_t vertexCount = getVertexCount();
+    if (vertexCount == 0)
+        return;
+
+    *min = getPosition(0);
+    *max = *min;
+    for (size_t v = 1; v < vertexCount; v++)
+    {
+        RVector3 p = getPosition((uint32_t)v);
+        min->set(std::min(min->x, p.x), std::min(min->y, p.y), std::min(min->z, p.z));
+        max->set(std::max(max->x, p.x), std::max(max->y, p.y), std::max(max->z, p.z));
+    }
+}
+
+float RMeshBuilder::simplify(size_t targetIndexCount, float targetError, std::vector<uint32_t>* dst) const
+{
+    return simplify(_indices.data(), _indices.size(), targetIndexCount, targetError, dst);
+}
+
+float RMeshBuilder::simplify(const uint32_t* indices, size_t indexCount, size_t targetIndexCount, float targetError,
+                             std::vector<uint32_t>* dst) const
+{
+    std::vector<uint32_t>& triangles = *dst;
+    triangles.assign(indices, indices + indexCount - indexCount % 3);
+    size_t vertexCount = getVertexCount();
+    std::vector<RVector3> positions(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+        positions[v] = getPosition((uint32_t)v);
+
+    // Vertices sharing a position share a position id, so seams are not mistaken for borders.
+    std::vector<uint32_t> positionIds(vertexCount);
+    std::vector<uint32_t> positionUses;
+    {
+        size_t tableSize = 1;
+        while (tableSize < vertexCount * 2)
+            tableSize *= 2;
+        std::vector<uint32_t> table(tableSize, MESH_BUILDER_UNUSED);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            size_t slot = (size_t)hashVertex((const uint8_t*)&positions[v].x, 3 * sizeof(float)) & (tableSize - 1);
+            while (table[slot] != MESH_BUILDER_UNUSED && memcmp(&positions[table[slot]].x, &positions[v].x, 3 * sizeof(float)) != 0)
+                slot = (slot + 1) & (tableSize - 1);
+            if (table[slot] == MESH_BUILDER_UNUSED)
+            {
+                table[slot] = (uint32_t)v;
+                positionIds[v] = (uint32_t)positionUses.size();
+                positionUses.push_back(0);
+            }
+            else
+            {
+                positionIds[v] = positionIds[table[slot]];
+            }
+        }
+    }
+
+    // Lock seam vertices, then border vertices: the ends of edges without an opposite edge.
+    std::vector<uint8_t> locked(vertexCount, 0);
+    std::vector<uint8_t> referenced(vertexCount, 0);
+    for (size_t i = 0; i < triangles.size(); i++)
+    {
+        if (!referenced[triangles[i]])
+            positionUses[positionIds[triangles[i]]]++;
+        referenced[triangles[i]] = 1;
+    }
+    for (size_t v = 0; v < vertexCount; v++)
+        locked[v] = positionUses[positionIds[v]] > 1;
+    std::unordered_set<uint64_t> edges;
+    for (size_t t = 0; t < triangles.size(); t += 3)
+    {
+        for (unsigned int k = 0; k < 3; k++)
+            edges.insert((uint64_t)positionIds[triangles[t + k]] << 32 | positionIds[triangles[t + (k + 1) % 3]]);
+    }
+    for (size_t t = 0; t < triangles.size(); t += 3)
+    {
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            uint32_t a = triangles[t + k];
+            uint32_t b = triangles[t + (k + 1) % 3];
+            if (edges.find((uint64_t)positionIds[b] << 32 | positionIds[a]) == edges.end())
+                locked[a] = locked[b] = 1;
+        }
+    }
+
+    std::vector<MeshQuadric> quadrics(vertexCount);
+    memset(quadrics.data(), 0, vertexCount * sizeof(MeshQuadric));
+    for (size_t t = 0; t < triangles.size(); t += 3)
+    {
+        const RVector3& p0 = positions[triangles[t]];
+        RVector3 normal = getTriangleNormal(p0, positions[triangles[t + 1]], positions[triangles[t + 2]]);
+        float length = normal.length();
+        if (length <= 0.0f)
+            continue;
+        normal *= 1.0f / length;
+        for (unsigned int k = 0; k < 3; k++)
+            quadrics[triangles[t + k]].addPlane(normal.x, normal.y, normal.z, -normal.dot(p0));
+    }
+
+    // Each pass collapses the cheapest edges that do not share a vertex,
+    // then the adjacency and candidates are rebuilt.
+    double maxCost = (double)targetError * targetError;
+    double error = 0.0;
+    size_t triangleCount = triangles.size() / 3;
+    size_t targetTriangleCount = targetIndexCount / 3;
+    std::vector<uint32_t> offsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    std::vector<MeshCollapse> collapses;
+    std::vector<uint8_t> touched(vertexCount);
+    std::vector<uint8_t> removed;
+    while (triangleCount > targetTriangleCount)
+    {
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (size_t i = 0; i < triangles.size(); i++)
+            offsets[triangles[i] + 1]++;
+        for (size_t v = 0; v < vertexCount; v++)
+            offsets[v + 1] += offsets[v];
+        adjacency.resize(triangles.size());
+        std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < triangles.size(); i++)
+            adjacency[cursors[triangles[i]]++] = (uint32_t)(i / 3);
+
+        collapses.clear();
+        for (size_t t = 0; t < triangles.size(); t += 3)
+        {
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                uint32_t a = triangles[t + k];
+                uint32_t b = triangles[t + (k + 1) % 3];
+                // Each interior edge is seen from both triangles, keep one.
+                if (a > b && !locked[a] && !locked[b])
+                    continue;
+                MeshCollapse collapse = { DBL_MAX, a, b };
+                if (!locked[a])
+                    collapse.cost = quadrics[a].evaluate(positions[b]);
+                if (!locked[b])
+                {
+                    double cost = quadrics[b].evaluate(positions[a]);
+                    if (cost < collapse.cost)
+                    {
+                        collapse.cost = cost;
+                        collapse.from = b;
+                        collapse.to = a;
+                    }
+                }
+                if (collapse.cost <= maxCost)
+                    collapses.push_back(collapse);
+            }
+        }
+        std::sort(collapses.begin(), collapses.end());
+
+        std::fill(touched.begin(), touched.end(), 0);
+        removed.assign(triangles.size() / 3, 0);
+        size_t collapsed = 0;
+        for (size_t c = 0; c < collapses.size() && triangleCount > targetTriangleCount; c++)
+        {
+            const MeshCollapse& collapse = collapses[c];
+            uint32_t from = collapse.from;
+            uint32_t to = collapse.to;
+            if (touched[from] || touched[to])
+                continue;
+
+            // Reject collapses that flip a remaining triangle.
+            bool flips = false;
+            for (uint32_t a = offsets[from]; a < offsets[from + 1] && !flips; a++)
+            {
+                const uint32_t* triangle = &triangles[adjacency[a] * 3];
+                if (removed[adjacency[a]] || triangle[0] == to || triangle[1] == to || triangle[2] == to)
+                    continue;
+                RVector3 p[3];
+                for (unsigned int k = 0; k < 3; k++)
+                    p[k] = positions[triangle[k]];
+                RVector3 before = getTriangleNormal(p[0], p[1], p[2]);
+                for (unsigned int k = 0; k < 3; k++)
+                {
+                    if (triangle[k] == from)
+                        p[k] = positions[to];
+                }
+                flips = before.dot(getTriangleNormal(p[0], p[1], p[2])) <= 0.0f;
+            }
+            if (flips)
+                continue;
+
+            for (uint32_t a = offsets[from]; a < offsets[from + 1]; a++)
+            {
+                uint32_t t = adjacency[a];
+                if (removed[t])
+                    continue;
+                uint32_t* triangle = &triangles[t * 3];
+                for (unsigned int k = 0; k < 3; k++)
+                {
+                    if (triangle[k] == from)
+                        triangle[k] = to;
+                }
+                if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[0] == triangle[2])
+                {
+                    removed[t] = 1;
+                    triangleCount--;
+                }
+            }
+            quadrics[to].add(quadrics[from]);
+            error = std::max(error, collapse.cost);
+            touched[from] = touched[to] = 1;
+            collapsed++;
+        }
+
+        size_t write = 0;
+        for (size_t t = 0; t < removed.size(); t++)
+        {
+            if (removed[t])
+                continue;
+            memmove(&triangles[write * 3], &triangles[t * 3], 3 * sizeof(uint32_t));
+            write++;
+        }
+        triangles.resize(write * 3);
+        if (collapsed == 0)
+            break;
+    }
+    return (float)sqrt(error);
+}
+
+std::vector<RMeshPart> RMeshBuilder::generateLods(unsigned int levelCount, float ratio, float maxError)
+{
+    std::vector<RMeshPart> lods;
+    size_t baseCount = _indices.size();
+    lods.push_back(RMeshPart(0, (uint32_t)baseCount));
+
+    std::vector<uint32_t> level;
+    float target = (float)(baseCount / 3);
+    float error = 0.0f;
+    for (unsigned int l = 1; l < levelCount; l++)
+    {
+        target *= ratio;
+        float levelError = simplify(_indices.data(), baseCount, (size_t)target * 3, maxError, &level);
+        // Stop when a level is less than 10% smaller than the previous one.
+        if (level.empty() || level.size() * 10 > (size_t)lods.back().getIndexCount() * 9)
+            break;
+        orderForVertexCache(&level, getVertexCount(), _cacheSize);
+        error = std::max(error, levelError);
+        lods.push_back(RMeshPart((uint32_t)_indices.size(), (uint32_t)level.size(), error));
+        _indices.insert(_indices.end(), level.begin(), level.end());
+    }
+    return lods;
+}
+
+void RMeshBuilder::buildMeshlets(RMeshletSet* dst, unsigned int maxVertices, unsigned int maxTriangles) const
+{
+    dst->clear();
+    maxVertices = std::min(std::max(maxVertices, 3u), 256u);
+    maxTriangles = std::max(maxTriangles, 1u);
+    size_t vertexCount = getVertexCount();
+    size_t triangleCount = _indices.size() / 3;
+
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+        offsets[_indices[i] + 1]++;
+    for (size_t v = 0; v < vertexCount; v++)
+        offsets[v + 1] += offsets[v];
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> cursors(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; i++)
+        adjacency[cursors[_indices[i]]++] = (uint32_t)(i / 3);
+
+    std::vector<RVector3> centroids(triangleCount);
+    std::vector<RVector3> normals(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        RVector3 p0 = getPosition(_indices[t * 3]);
+        RVector3 p1 = getPosition(_indices[t * 3 + 1]);
+        RVector3 p2 = getPosition(_indices[t * 3 + 2]);
+        centroids[t] = (p0 + p1 + p2) * (1.0f / 3.0f);
+        normals[t] = getTriangleNormal(p0, p1, p2);
+        float length = normals[t].length();
+        normals[t] = length > 0.0f ? normals[t] * (1.0f / length) : RVector3::zero();
+    }
+
+    std::vector<uint8_t> assigned(triangleCount, 0);
+    std::vector<uint32_t> local(vertexCount, MESH_BUILDER_UNUSED);
+    std::vector<uint32_t> vertices;
+    std::vector<uint8_t> triangles;
+    std::vector<uint32_t> meshletTriangles;
+    std::vector<uint32_t> candidates;
+    // Unassigned triangles around each vertex.
+    std::vector<uint32_t> live(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+        live[v] = offsets[v + 1] - offsets[v];
+    size_t cursor = 0;
+    while (true)
+    {
+        // Seed next to the last meshlet, with the triangle whose vertices
+        // have the fewest unassigned triangles left, so pockets are filled
+        // before they become isolated; else the next one in index order.
+        int64_t seed = -1;
+        uint32_t bestLive = MESH_BUILDER_UNUSED;
+        for (size_t i = 0; i < vertices.size(); i++)
+        {
+            uint32_t v = vertices[i];
+            for (uint32_t a = offsets[v]; a < offsets[v + 1]; a++)
+            {
+                uint32_t t = adjacency[a];
+                if (assigned[t])
+                    continue;
+                const uint32_t* triangle = &_indices[t * 3];
+                uint32_t score = live[triangle[0]] + live[triangle[1]] + live[triangle[2]];
+                if (score < bestLive)
+                {
+                    bestLive = score;
+                    seed = t;
+                }
+            }
+        }
+        while (seed < 0 && cursor < triangleCount)
+        {
+            if (!assigned[cursor])
+                seed = (int64_t)cursor;
+            cursor++;
+        }
+        if (seed < 0)
+            break;
+
+        vertices.clear();
+        triangles.clear();
+        meshletTriangles.clear();
+        candidates.clear();
+        RVector3 center;
+        int64_t next = seed;
+        while (next >= 0)
+        {
+            uint32_t t = (uint32_t)next;
+            assigned[t] = 1;
+            for (unsigned int k = 0; k < 3; k++)
+                live[_indices[t * 3 + k]]--;
+            meshletTriangles.push_back(t);
+            center += (centroids[t] - center) * (1.0f / meshletTriangles.size());
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                uint32_t v = _indices[t * 3 + k];
+                if (local[v] == MESH_BUILDER_UNUSED)
+                {
+                    local[v] = (uint32_t)vertices.size();
+                    vertices.push_back(v);
+                    for (uint32_t a = offsets[v]; a < offsets[v + 1]; a++)
+                    {
+                        if (!assigned[adjacency[a]])
+                            candidates.push_back(adjacency[a]);
+                    }
+                }
+                triangles.push_back((uint8_t)local[v]);
+            }
+            if (meshletTriangles.size() == maxTriangles)
+                break;
+
+            // The candidate adding the fewest vertices, then the nearest.
+            next = -1;
+            unsigned int bestNew = 4;
+            float bestScore = FLT_MAX;
+            size_t write = 0;
+            for (size_t i = 0; i < candidates.size(); i++)
+            {
+                uint32_t c = candidates[i];
+                if (assigned[c])
+                    continue;
+                candidates[write++] = c;
+                unsigned int added = 0;
+                for (unsigned int k = 0; k < 3; k++)
+                    added += local[_indices[c * 3 + k]] == MESH_BUILDER_UNUSED ? 1 : 0;
+                if (vertices.size() + added > maxVertices)
+                    continue;
+                // Triangles with few unassigned neighbours left are taken early so they are not left isolated.
+                const uint32_t* triangle = &_indices[c * 3];
+                float score = centroids[c].distanceSquared(center) * (float)(live[triangle[0]] + live[triangle[1]] + live[triangle[2]] + 1);
+                if (added < bestNew || (added == bestNew && score < bestScore))
+                {
+                    bestNew = added;
+                    bestScore = score;
+                    next = c;
+                }
+            }
+            candidates.resize(write);
+        }
+
+        RMeshlet meshlet;
+        meshlet.vertexCount = (uint32_t)vertices.size();
+        meshlet.triangleCount = (uint32_t)meshletTriangles.size();
+
+        RVector3 min = getPosition(vertices[0]);
+        RVector3 max = min;
+        for (size_t i = 1; i < vertices.size(); i++)
+        {
+            RVector3 p = getPosition(vertices[i]);
+            min.set(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+            max.set(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+        }
+        meshlet.bounds.center = (min + max) * 0.5f;
+        meshlet.bounds.radius = 0.0f;
+        for (size_t i = 0; i < vertices.size(); i++)
+            meshlet.bounds.radius = std::max(meshlet.bounds.radius, meshlet.bounds.center.distance(getPosition(vertices[i])));
+
+        RVector3 axis;
+        for (size_t i = 0; i < meshletTriangles.size(); i++)
+            axis += normals[meshletTriangles[i]];
+        float length = axis.length();
+        meshlet.coneAxis = length > 0.0f ? axis * (1.0f / length) : RVector3::zero();
+        meshlet.coneCutoff = 1.0f;
+        if (length > 0.0f)
+        {
+            float minDot = 1.0f;
+            for (size_t i = 0; i < meshletTriangles.size(); i++)
+                minDot = std::min(minDot, meshlet.coneAxis.dot(normals[meshletTriangles[i]]));
+            if (minDot > 0.0f)
+                meshlet.coneCutoff = sqrt(1.0f - minDot * minDot);
+        }
+
+        dst->add(meshlet, vertices.data(), triangles.data());
+        for (size_t i = 0; i < vertices.size(); i++)
+            local[vertices[i]] = MESH_BUILDER_UNUSED;
+        // vertices keeps the last meshlet's vertices for the next seed.
+    }
+}
+
+RMeshBuilder::Statistics RMeshBuilder::optimize(Statistics* stages)
+{
+    Statistics statistics[4];
+    statistics[0] = deduplicate();
+    statistics[1] = optimizeVertexCache();
+    statistics[2] = optimizeOverdraw();
+    statistics[3] = optimizeVertexFetch();
+    if (stages)
+        memcpy(stages, statistics, sizeof(statistics));
+    return statistics[3];
+}
+
+void RMeshBuilder::convert(const RVertexDeclaration& source, RVertexDeclaration* target, std::vector<uint8_t>* dst) const
+{
+    size_t vertexCount = getVertexCount();
+    unsigned int stride = target->getStride();
+    dst->assign(vertexCount * stride, 0);
+    if (vertexCount == 0)
+        return;
+
+    const RVertexDeclaration::Element* position = target->find(RVertexDeclaration::SEMANTIC_POSITION);
+    if (position && position->format == RVertexDeclaration::FORMAT_SNORM16_4)
+    {
+        RVector3 min, max, offset, scale;
+        getBox(&min, &max);
+        getPositionDecode(min, max, &offset, &scale);
+        target->setDecode(offset, scale);
+    }
+
+    for (unsigned int i = 0; i < target->getElementCount(); i++)
+    {
+        const RVertexDeclaration::Element& element = target->getElement(i);
+        const RVertexDeclaration::Element* input = source.find(element.semantic);
+        if (!input)
+            continue;
+        bool decode = element.semantic == RVertexDeclaration::SEMANTIC_POSITION &&
+                      element.format == RVertexDeclaration::FORMAT_SNORM16_4;
+        RVertexDeclaration::pack(element.format, &_vertices[input->offset], _vertexSize,
+                                 RVertexDeclaration::getComponentCount(input->format), vertexCount,
+                                 &(*dst)[element.offset], stride,
+                                 decode ? &target->getDecodeOffset() : NULL, decode ? &target->getDecodeScale() : NULL);
+    }
+}
+
+RVertexDeclaration RMeshBuilder::selectDeclaration(const RVertexDeclaration& source,
+                                                   const RVertexDeclaration::Tolerances& tolerances) const
+{
+    size_t vertexCount = getVertexCount();
+    RVector3 min, max, offset, scale;
+    getBox(&min, &max);
+    getPositionDecode(min, max, &offset, &scale);
+
+    std::vector<RVertexDeclaration::Element> selected;
+    std::vector<float> values(vertexCount * 4);
+    std::vector<float> decoded(vertexCount * 4);
+    std::vector<uint8_t> encoded;
+    for (unsigned int i = 0; i < source.getElementCount(); i++)
+    {
+        RVertexDeclaration::Element element = source.getElement(i);
+        unsigned int components = RVertexDeclaration::getComponentCount(element.format);
+        RVertexDeclaration::unpack(element.format, _vertices.data() + element.offset, _vertexSize, vertexCount, values.data());
+
+        float tolerance = tolerances.texcoord;
+        if (element.semantic == RVertexDeclaration::SEMANTIC_POSITION)
+            tolerance = tolerances.position;
+        else if (element.semantic == RVertexDeclaration::SEMANTIC_NORMAL || element.semantic == RVertexDeclaration::SEMANTIC_TANGENT)
+            tolerance = tolerances.direction;
+        else if (element.semantic == RVertexDeclaration::SEMANTIC_COLOR)
+            tolerance = tolerances.color;
+
+        RVertexDeclaration::Format candidates[4];
+        unsigned int candidateCount = getCandidateFormats(element.semantic, candidates);
+        for (unsigned int c = 0; c < candidateCount; c++)
+        {
+            RVertexDeclaration::Format format = candidates[c];
+            unsigned int size = RVertexDeclaration::getSize(format);
+            if (RVertexDeclaration::getComponentCount(format) < components || size >= RVertexDeclaration::getSize(element.format))
+                continue;
+
+            bool decode = element.semantic == RVertexDeclaration::SEMANTIC_POSITION && format == RVertexDeclaration::FORMAT_SNORM16_4;
+            encoded.resize(vertexCount * size);
+            RVertexDeclaration::pack(format, values.data(), 4 * sizeof(float), components, vertexCount, encoded.data(), size,
+                                     decode ? &offset : NULL, decode ? &scale : NULL);
+            RVertexDeclaration::unpack(format, encoded.data(), size, vertexCount, decoded.data(),
+                                       decode ? &offset : NULL, decode ? &scale : NULL);
+            if (getAttributeError(element.semantic, values.data(), decoded.data(), vertexCount, components) <= tolerance)
+            {
+                element.format = format;
+                break;
+            }
+        }
+        selected.push_back(element);
+    }
+
+    // Every size is a multiple of the alignment of the smaller formats.
+    std::stable_sort(selected.begin(), selected.end(),
+                     [](const RVertexDeclaration::Element& a, const RVertexDeclaration::Element& b)
+                     {
+                         return RVertexDeclaration::getSize(a.format) > RVertexDeclaration::getSize(b.format);
+                     });
+    RVertexDeclaration declaration;
+    for (size_t i = 0; i < selected.size(); i++)
+        declaration.add(selected[i].semantic, selected[i].format);
+    if (declaration.find(RVertexDeclaration::SEMANTIC_POSITION) &&
+        declaration.find(RVertexDeclaration::SEMANTIC_POSITION)->format == RVertexDeclaration::FORMAT_SNORM16_4)
+        declaration.setDecode(offset, scale);
+    return declaration;
+}
+
+}
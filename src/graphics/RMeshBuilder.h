@@ -0,0 +1,343 @@
+#pragma once
+
+#include "RMeshlet.h"
+#include "RMeshPart.h"
+#include "RVertexDeclaration.h"
+#include "math/RBoundingSphere.h"
+#include <cfloat>
+
+namespace rocket
+{
+
+/**
+ * Defines a builder of indexed triangle meshes, with the import-time
+ * optimizations that reduce the per-frame cost of drawing them.
+ *
+ * Vertices are opaque blocks of getVertexSize() bytes with a float3
+ * position at getPositionOffset(); indices are 32-bit and list triangles.
+ * The optimization stages are meant to run in order:
+ *
+ * 1. deduplicate() merges bitwise identical vertices and drops the
+ *    triangles this leaves degenerate.
+ * 2. optimizeVertexCache() orders triangles for the post-transform vertex
+ *    cache (Tipsify, Sander et al. 2007), so fewer vertices are shaded.
+ * 3. optimizeOverdraw() reorders clusters of that order so triangles
+ *    facing out of the mesh draw first, keeping the cache efficiency
+ *    within a threshold.
+ * 4. optimizeVertexFetch() orders vertices by first use and drops unused
+ *    ones, so vertex fetch reads memory sequentially.
+ *
+ * optimize() runs all four. Each stage returns the statistics of the
+ * result: ACMR, the vertices shaded per triangle (0.5 is ideal for large
+ * grids, 3 is the worst), and ATVR, the vertices shaded per vertex (1 is
+ * ideal), both for a FIFO cache of getCacheSize() entries.
+ *
+ * simplify() and generateLods() reduce the triangle count by edge
+ * collapses ordered by quadric error (Garland and Heckbert 1997). A vertex
+ * collapses onto a neighbouring vertex, so no attributes are interpolated.
+ * Vertices on the border of the mesh and on attribute seams (several
+ * vertices at one position) are never removed, so borders keep their shape
+ * and seams do not tear.
+ *
+ * buildMeshlets() partitions the triangles into meshlets for culling at a
+ * finer granularity than the whole mesh (see RMeshletSet).
+ *
+ * convert() writes the vertices in the compact formats of a
+ * RVertexDeclaration, and selectDeclaration() picks the smallest formats
+ * that keep every attribute within a tolerance of its float value.
+ */
+class API RMeshBuilder
+{
+public:
+
+    /**
+     * Vertex cache statistics of the index buffer.
+     */
+    struct Statistics
+    {
+        unsigned int vertexCount;
+        unsigned int triangleCount;
+
+        /**
+         * Average cache miss ratio: the vertices shaded per triangle.
+         */
+        float acmr;
+
+        /**
+         * Average transformed to vertex ratio: the vertices shaded per referenced vertex.
+         */
+        float atvr;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param vertexSize The size of a vertex in bytes.
+     * @param positionOffset The offset of the float3 position in a vertex, in bytes.
+     */
+    RMeshBuilder(unsigned int vertexSize, unsigned int positionOffset = 0);
+
+    /**
+     * Destructor.
+     */
+    ~RMeshBuilder();
+
+    /**
+     * Gets the size of a vertex.
+     *
+     * @return The size in bytes.
+     */
+    unsigned int getVertexSize() const;
+
+    /**
+     * Gets the offset of the position in a vertex.
+     *
+     * @return The offset in bytes.
+     */
+    unsigned int getPositionOffset() const;
+
+    /**
+     * Gets the vertex cache size the optimizations and statistics model.
+     *
+     * @return The number of cache entries.
+     */
+    unsigned int getCacheSize() const;
+
+    /**
+     * Sets the vertex cache size the optimizations and statistics model.
+     *
+     * Defaults to 16, a conservative size for current GPUs.
+     *
+     * @param size The number of cache entries, at least 3.
+     */
+    void setCacheSize(unsigned int size);
+
+    /**
+     * Adds a vertex.
+     *
+     * @param vertex getVertexSize() bytes.
+     *
+     * @return The index of the vertex.
+     */
+    uint32_t addVertex(const void* vertex);
+
+    /**
+     * Adds vertices.
+     *
+     * @param vertices count * getVertexSize() bytes.
+     * @param count The number of vertices.
+     */
+    void addVertices(const void* vertices, size_t count);
+
+    /**
+     * Adds a triangle.
+     *
+     * @param a The index of the first vertex.
+     * @param b The index of the second vertex.
+     * @param c The index of the third vertex.
+     */
+    void addTriangle(uint32_t a, uint32_t b, uint32_t c);
+
+    /**
+     * Adds triangles.
+     *
+     * @param indices 3 * count vertex indices.
+     * @param count The number of triangles.
+     */
+    void addTriangles(const uint32_t* indices, size_t count);
+
+    /**
+     * Removes all vertices and triangles.
+     */
+    void clear();
+
+    /**
+     * Gets the number of vertices.
+     *
+     * @return The number of vertices.
+     */
+    size_t getVertexCount() const;
+
+    /**
+     * Gets the vertices.
+     *
+     * @return getVertexCount() * getVertexSize() bytes.
+     */
+    const uint8_t* getVertices() const;
+
+    /**
+     * Gets the position of a vertex.
+     *
+     * @param index The index of the vertex.
+     *
+     * @return The position.
+     */
+    RVector3 getPosition(uint32_t index) const;
+
+    /**
+     * Gets the number of indices.
+     *
+     * @return Three times the number of triangles.
+     */
+    size_t getIndexCount() const;
+
+    /**
+     * Gets the indices.
+     *
+     * @return getIndexCount() indices.
+     */
+    const uint32_t* getIndices() const;
+
+    /**
+     * Computes the vertex cache statistics of the current index order.
+     *
+     * @return The statistics.
+     */
+    Statistics getStatistics() const;
+
+    /**
+     * Merges vertices with identical bytes and removes the duplicates, then
+     * drops triangles that reference a vertex twice.
+     *
+     * @return The statistics after the stage.
+     */
+    Statistics deduplicate();
+
+    /**
+     * Reorders triangles for the vertex cache with Tipsify.
+     *
+     * @return The statistics after the stage.
+     */
+    Statistics optimizeVertexCache();
+
+    /**
+     * Reorders clusters of triangles to reduce overdraw, after optimizeVertexCache().
+     *
+     * The cache optimized order is split where the cache starts cold, and
+     * further where a prefix of a cluster is within threshold of the
+     * cluster's ACMR. Clusters are then sorted so those facing away from the
+     * mesh centroid draw first and occlude the inner ones.
+     *
+     * @param threshold The ACMR degradation allowed for smaller clusters, 1.05 allows 5%.
+     *
+     * @return The statistics after the stage.
+     */
+    Statistics optimizeOverdraw(float threshold = 1.05f);
+
+    /**
+     * Reorders vertices by first use in the index buffer and removes unused vertices.
+     *
+     * @return The statistics after the stage.
+     */
+    Statistics optimizeVertexFetch();
+
+    /**
+     * Computes a sphere bounding the vertex positions.
+     *
+     * @return The bounds, centered on the box of the positions.
+     */
+    RBoundingSphere getBounds() const;
+
+    /**
+     * Simplifies the triangles, leaving the builder unchanged.
+     *
+     * Collapses stop when the index count reaches the target or the next
+     * collapse would move the surface by more than the target error.
+     *
+     * @param targetIndexCount The index count to reduce to.
+     * @param targetError The largest error allowed, in position units.
+     * @param dst Set to the indices of the simplified triangles, into the builder's vertices.
+     *
+     * @return The error of the result: a bound on the distance from its
+     *      vertices to the original surface, in position units.
+     */
+    float simplify(size_t targetIndexCount, float targetError, std::vector<uint32_t>* dst) const;
+
+    /**
+     * Appends a chain of levels of detail to the index buffer, after the optimization stages.
+     *
+     * Level 0 is the current triangles; level i is simplified from them to
+     * ratio^i of their count and ordered for the vertex cache. All levels
+     * share the vertices. The chain stops early when a level would exceed
+     * maxError or would barely be smaller than the previous one.
+     *
+     * @param levelCount The largest number of levels, including level 0.
+     * @param ratio The triangle count of each level relative to the previous one.
+     * @param maxError The largest error of a level, in position units.
+     *
+     * @return The index range and error of each level.
+     */
+    std::vector<RMeshPart> generateLods(unsigned int levelCount, float ratio = 0.5f, float maxError = FLT_MAX);
+
+    /**
+     * Partitions the triangles into meshlets.
+     *
+     * Meshlets grow from a seed triangle by adding the adjacent triangle
+     * that brings the fewest new vertices, nearest to the meshlet first,
+     * so they are compact and share few vertices. Seeds follow the index
+     * order, so run optimizeVertexCache() first for locality.
+     *
+     * @param dst The set to fill, cleared first.
+     * @param maxVertices The most vertices per meshlet, at most 256.
+     * @param maxTriangles The most triangles per meshlet.
+     */
+    void buildMeshlets(RMeshletSet* dst, unsigned int maxVertices = 64, unsigned int maxTriangles = 124) const;
+
+    /**
+     * Runs every stage in order.
+     *
+     * @param stages An optional array of 4 statistics, one per stage.
+     *
+     * @return The statistics of the result.
+     */
+    Statistics optimize(Statistics* stages = NULL);
+
+    /**
+     * Converts the vertices to another declaration, usually of compact formats.
+     *
+     * Each attribute of the target is encoded from the float attribute of
+     * the same semantic in the source; attributes the source lacks are zero.
+     * When the target stores positions as snorm16, its decode transform is
+     * set to the center and half extents of the position box.
+     *
+     * @param source The float attributes of the builder's vertices.
+     * @param target The declaration to convert to.
+     * @param dst Set to getVertexCount() vertices of target->getStride() bytes.
+     */
+    void convert(const RVertexDeclaration& source, RVertexDeclaration* target, std::vector<uint8_t>* dst) const;
+
+    /**
+     * Selects the smallest declaration that encodes the vertices within tolerances.
+     *
+     * Every attribute of the source tries the compact formats of its
+     * semantic from the smallest, and keeps the first whose round trip over
+     * all vertices stays within the tolerance, or its float format. The
+     * attributes are ordered from the largest so the vertex has no padding.
+     *
+     * @param source The float attributes of the builder's vertices.
+     * @param tolerances The largest error of each kind of attribute.
+     *
+     * @return The declaration, with the decode transform of its positions set.
+     */
+    RVertexDeclaration selectDeclaration(const RVertexDeclaration& source,
+                                         const RVertexDeclaration::Tolerances& tolerances = RVertexDeclaration::Tolerances()) const;
+
+private:
+
+    RMeshBuilder(const RMeshBuilder& copy);
+
+    RMeshBuilder& operator=(const RMeshBuilder&);
+
+    void getBox(RVector3* min, RVector3* max) const;
+
+    float simplify(const uint32_t* indices, size_t indexCount, size_t targetIndexCount, float targetError,
+                   std::vector<uint32_t>* dst) const;
+
+    unsigned int _vertexSize;
+    unsigned int _positionOffset;
+    unsigned int _cacheSize;
+    std::vector<uint8_t> _vertices;
+    std::vector<uint32_t> _indices;
+};
+
+}
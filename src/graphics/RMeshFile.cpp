@@ -0,0 +1,477 @@
+#include "common.h"
+#include "RMeshFile.h"
+#include "RIndexBuffer.h"
+
+namespace rocket
+{
+
+// The alignment of the index and vertex blocks (see RFileMapping).
+#define MESH_FILE_BLOCK_ALIGNMENT   64
+// The alignment of the tables.
+#define MESH_FILE_TABLE_ALIGNMENT   16
+#define MESH_FILE_UNUSED            0xffffffffu
+
+const uint32_t RMeshFile::MAGIC;
+const uint32_t RMeshFile::VERSION;
+const uint32_t RMeshFile::FLAG_STREAMING;
+
+RMeshFile::RMeshFile()
+    : _data(NULL), _size(0)
+{
+}
+
+RMeshFile::~RMeshFile()
+{
+    close();
+}
+
+bool RMeshFile::open(const char* path)
+{
+    close();
+    RFileMapping mapping;
+    if (!mapping.open(path))
+        return false;
+    if (!openMemory(mapping.getData(), mapping.getSize()) || !isComplete())
+    {
+        close();
+        return false;
+    }
+    _mapping.swap(mapping);
+    return true;
+}
+
+bool RMeshFile::openMemory(const void* data, size_t size)
+{
+    close();
+    const Header* header = (const Header*)data;
+    if (!data || size < sizeof(Header) || header->magic != MAGIC || header->version != VERSION)
+        return false;
+
+    // The tables must be present, the blocks must fit in the file.
+    uint64_t fileSize = header->fileSize;
+    uint64_t available = std::min<uint64_t>(size, fileSize);
+    bool streaming = (header->flags & FLAG_STREAMING) != 0;
+    if (header->lodCount == 0 || (header->indexSize != 2 && header->indexSize != 4) ||
+        !RFileMapping::isInRange(header->elementOffset, (uint64_t)header->elementCount * sizeof(Element), available) ||
+        !RFileMapping::isInRange(header->lodOffset, (uint64_t)header->lodCount * sizeof(Lod), available) ||
+        !RFileMapping::isInRange(header->drawOffset, (uint64_t)header->drawCount * sizeof(Draw), available) ||
+        (!streaming && !RFileMapping::isInRange(header->indexOffset, (uint64_t)header->indexCount * header->indexSize, fileSize)) ||
+        (!streaming && !RFileMapping::isInRange(header->vertexOffset, (uint64_t)header->vertexCount * header->vertexStride, fileSize)) ||
+        !RFileMapping::isInRange(header->meshletOffset, (uint64_t)header->meshletCount * sizeof(Meshlet), fileSize) ||
+        !RFileMapping::isInRange(header->meshletVertexOffset, (uint64_t)header->meshletVertexCount * sizeof(uint32_t), fileSize) ||
+        !RFileMapping::isInRange(header->meshletTriangleOffset, header->meshletTriangleSize, fileSize))
+        return false;
+
+    const uint8_t* bytes = (const uint8_t*)data;
+    const Element* elements = (const Element*)(bytes + header->elementOffset);
+    for (uint32_t i = 0; i < header->elementCount; i++)
+    {
+        if (elements[i].semantic >= RVertexDeclaration::SEMANTIC_COUNT ||
+            elements[i].format > RVertexDeclaration::FORMAT_OCTAHEDRAL16 ||
+            elements[i].offset + RVertexDeclaration::getSize((RVertexDeclaration::Format)elements[i].format) > header->vertexStride)
+            return false;
+    }
+    const Lod* lods = (const Lod*)(bytes + header->lodOffset);
+    const Draw* draws = (const Draw*)(bytes + header->drawOffset);
+    for (uint32_t i = 0; i < header->lodCount; i++)
+    {
+        if (!RFileMapping::isInRange(lods[i].firstDraw, lods[i].drawCount, header->drawCount) ||
+            !RFileMapping::isInRange(lods[i].firstIndex, lods[i].indexCount, header->indexCount) ||
+            lods[i].vertexCount > header->vertexCount || lods[i].requiredSize > fileSize ||
+            !RFileMapping::isInRange(lods[i].firstStoredVertex, lods[i].storedVertexCount, header->vertexCount) ||
+            !RFileMapping::isInRange(lods[i].indexDataOffset, (uint64_t)lods[i].indexCount * header->indexSize, lods[i].requiredSize) ||
+            !RFileMapping::isInRange(lods[i].vertexDataOffset, (uint64_t)lods[i].storedVertexCount * header->vertexStride, lods[i].requiredSize))
+            return false;
+    }
+    for (uint32_t i = 0; i < header->drawCount; i++)
+    {
+        if (!RFileMapping::isInRange(draws[i].firstIndex, draws[i].indexCount, header->indexCount))
+            return false;
+    }
+
+    _data = bytes;
+    _size = (size_t)available;
+    return true;
+}
+
+void RMeshFile::close()
+{
+    _mapping.close();
+    _data = NULL;
+    _size = 0;
+}
+
+bool RMeshFile::isComplete() const
+{
+    return _data && _size == getHeader()->fileSize;
+}
+
+bool RMeshFile::verify() const
+{
+    if (!isComplete())
+        return false;
+    return RFileMapping::computeChecksum(_data + sizeof(Header), _size - sizeof(Header)) == getHeader()->checksum;
+}
+
+const RMeshFile::Header* RMeshFile::getHeader() const
+{
+    return (const Header*)_data;
+}
+
+RVertexDeclaration RMeshFile::getDeclaration() const
+{
+    RVertexDeclaration declaration;
+    if (!_data)
+        return declaration;
+
+    const Header* header = getHeader();
+    const Element* elements = (const Element*)(_data + header->elementOffset);
+    for (uint32_t i = 0; i < header->elementCount; i++)
+        declaration.add((RVertexDeclaration::Semantic)elements[i].semantic, (RVertexDeclaration::Format)elements[i].format);
+    declaration.setDecode(RVector3(header->decodeOffset[0], header->decodeOffset[1], header->decodeOffset[2]),
+                          RVector3(header->decodeScale[0], header->decodeScale[1], header->decodeScale[2]));
+    return declaration;
+}
+
+const uint8_t* RMeshFile::getVertices() const
+{
+    if (!_data || (getHeader()->flags & FLAG_STREAMING))
+        return NULL;
+    return _data + getHeader()->vertexOffset;
+}
+
+const uint8_t* RMeshFile::getIndices() const
+{
+    if (!_data || (getHeader()->flags & FLAG_STREAMING))
+        return NULL;
+    return _data + getHeader()->indexOffset;
+}
+
+unsigned int RMeshFile::getLodCount() const
+{
+    return _data ? getHeader()->lodCount : 0;
+}
+
+const RMeshFile::Lod& RMeshFile::getLod(unsigned int level) const
+{
+    return ((const Lod*)(_data + getHeader()->lodOffset))[level];
+}
+
+const RMeshFile::Draw* RMeshFile::getDraws(unsigned int level) const
+{
+    return (const Draw*)(_data + getHeader()->drawOffset) + getLod(level).firstDraw;
+}
+
+bool RMeshFile::isLodAvailable(unsigned int level) const
+{
+    return level < getLodCount() && getLod(level).requiredSize <= _size;
+}
+
+const uint8_t* RMeshFile::getLodIndices(unsigned int level) const
+{
+    return isLodAvailable(level) ? _data + getLod(level).indexDataOffset : NULL;
+}
+
+const uint8_t* RMeshFile::getLodVertices(unsigned int level) const
+{
+    return isLodAvailable(level) ? _data + getLod(level).vertexDataOffset : NULL;
+}
+
+void RMeshFile::getMesh(RMesh* mesh) const
+{
+    if (!_data)
+        return;
+
+    const Header* header = getHeader();
+    mesh->setBounds(RBoundingSphere(RVector3(header->bounds[0], header->bounds[1], header->bounds[2]), header->bounds[3]));
+    std::vector<RMeshPart> lods;
+    for (unsigned int i = 0; i < header->lodCount; i++)
+    {
+        const Lod& lod = getLod(i);
+        uint32_t baseVertex = lod.drawCount == 1 ? getDraws(i)[0].baseVertex : 0;
+        lods.push_back(RMeshPart(lod.firstIndex, lod.indexCount, lod.error, baseVertex));
+    }
+    mesh->setLods(lods);
+
+    // The indices of a split level are relative to the base of each draw.
+    for (unsigned int i = 0; i < header->lodCount; i++)
+    {
+        const Lod& lod = getLod(i);
+        if (lod.drawCount < 2)
+            continue;
+        std::vector<RMeshPart> parts;
+        const Draw* draws = getDraws(i);
+        for (uint32_t d = 0; d < lod.drawCount; d++)
+            parts.push_back(RMeshPart(draws[d].firstIndex, draws[d].indexCount, lod.error, draws[d].baseVertex));
+        mesh->setDraws(i, parts);
+    }
+}
+
+bool RMeshFile::getMeshlets(RMeshletSet* meshlets) const
+{
+    meshlets->clear();
+    if (!_data)
+        return false;
+
+    const Header* header = getHeader();
+    if (header->meshletTriangleOffset + header->meshletTriangleSize > _size)
+        return false;
+
+    const Meshlet* records = (const Meshlet*)(_data + header->meshletOffset);
+    const uint32_t* vertices = (const uint32_t*)(_data + header->meshletVertexOffset);
+    const uint8_t* triangles = _data + header->meshletTriangleOffset;
+    for (uint32_t i = 0; i < header->meshletCount; i++)
+    {
+        const Meshlet& record = records[i];
+        if (!RFileMapping::isInRange(record.vertexOffset, record.vertexCount, header->meshletVertexCount) ||
+            !RFileMapping::isInRange(record.triangleOffset, (uint64_t)record.triangleCount * 3, header->meshletTriangleSize))
+        {
+            meshlets->clear();
+            return false;
+        }
+        RMeshlet meshlet;
+        meshlet.vertexOffset = 0;
+        meshlet.triangleOffset = 0;
+        meshlet.vertexCount = record.vertexCount;
+        meshlet.triangleCount = record.triangleCount;
+        meshlet.bounds = RBoundingSphere(RVector3(record.bounds[0], record.bounds[1], record.bounds[2]), record.bounds[3]);
+        meshlet.coneAxis.set(record.coneAxis[0], record.coneAxis[1], record.coneAxis[2]);
+        meshlet.coneCutoff = record.coneCutoff;
+        meshlets->add(meshlet, vertices + record.vertexOffset, triangles + record.triangleOffset);
+    }
+    return true;
+}
+
+void RMeshFile::write(const RMeshBuilder& builder, const RVertexDeclaration& source, const RVertexDeclaration& target,
+                      const std::vector<RMeshPart>& lods, const RMeshletSet* meshlets, bool streaming,
+                      std::vector<uint8_t>* dst)
+{
+    size_t vertexCount = builder.getVertexCount();
+    std::vector<uint32_t> indices(builder.getIndices(), builder.getIndices() + builder.getIndexCount());
+    std::vector<RMeshPart> levels = lods;
+    if (levels.empty())
+        levels.push_back(RMeshPart(0, (uint32_t)indices.size()));
+
+    // Streaming files put the coarsest level first and number the vertices
+    // by first use in that order, so every level needs a prefix of both blocks.
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint32_t> levelVertexCounts(levels.size(), (uint32_t)vertexCount);
+    if (streaming)
+    {
+        std::fill(remap.begin(), remap.end(), MESH_FILE_UNUSED);
+        std::vector<uint32_t> ordered;
+        ordered.reserve(indices.size());
+        uint32_t next = 0;
+        for (size_t l = levels.size(); l-- > 0;)
+        {
+            size_t first = std::min<size_t>(levels[l].getFirstIndex(), indices.size());
+            size_t end = std::min<size_t>(first + levels[l].getIndexCount(), indices.size());
+            uint32_t orderedFirst = (uint32_t)ordered.size();
+            for (size_t i = first; i < end; i++)
+            {
+                if (remap[indices[i]] == MESH_FILE_UNUSED)
+                    remap[indices[i]] = next++;
+                ordered.push_back(indices[i]);
+            }
+            levelVertexCounts[l] = next;
+            levels[l] = RMeshPart(orderedFirst, (uint32_t)(end - first), levels[l].getError());
+        }
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            if (remap[v] == MESH_FILE_UNUSED)
+                remap[v] = next++;
+        }
+        indices.swap(ordered);
+    }
+    else
+    {
+        for (size_t v = 0; v < vertexCount; v++)
+            remap[v] = (uint32_t)v;
+    }
+    for (size_t i = 0; i < indices.size(); i++)
+        indices[i] = remap[indices[i]];
+
+    RVertexDeclaration declaration = target;
+    std::vector<uint8_t> converted;
+    builder.convert(source, &declaration, &converted);
+    unsigned int stride = declaration.getStride();
+
+    RIndexBuffer indexBuffer;
+    indexBuffer.set(indices.data(), indices.size(), levels);
+    std::vector<Draw> draws;
+    std::vector<Lod> lodRecords(levels.size());
+    for (size_t l = 0; l < levels.size(); l++)
+    {
+        unsigned int count;
+        const RMeshPart* parts = indexBuffer.getDraws((unsigned int)l, &count);
+        Lod& lod = lodRecords[l];
+        lod.error = levels[l].getError();
+        lod.firstIndex = levels[l].getFirstIndex();
+        lod.indexCount = levels[l].getIndexCount();
+        lod.firstDraw = (uint32_t)draws.size();
+        lod.drawCount = count;
+        lod.vertexCount = levelVertexCounts[l];
+        lod.firstStoredVertex = 0;
+        lod.storedVertexCount = 0;
+        lod.indexDataOffset = 0;
+        lod.vertexDataOffset = 0;
+        lod.requiredSize = 0;
+        for (unsigned int d = 0; d < count; d++)
+        {
+            Draw draw;
+            draw.firstIndex = parts[d].getFirstIndex();
+            draw.indexCount = parts[d].getIndexCount();
+            draw.baseVertex = parts[d].getBaseVertex();
+            draw.reserved = 0;
+            draws.push_back(draw);
+        }
+    }
+
+    std::vector<Meshlet> meshletRecords;
+    std::vector<uint32_t> meshletVertices;
+    std::vector<uint8_t> meshletTriangles;
+    if (meshlets)
+    {
+        for (size_t i = 0; i < meshlets->size(); i++)
+        {
+            const RMeshlet& meshlet = meshlets->get(i);
+            Meshlet record;
+            record.vertexOffset = meshlet.vertexOffset;
+            record.triangleOffset = meshlet.triangleOffset;
+            record.vertexCount = meshlet.vertexCount;
+            record.triangleCount = meshlet.triangleCount;
+            record.bounds[0] = meshlet.bounds.center.x;
+            record.bounds[1] = meshlet.bounds.center.y;
+            record.bounds[2] = meshlet.bounds.center.z;
+            record.bounds[3] = meshlet.bounds.radius;
+            record.coneAxis[0] = meshlet.coneAxis.x;
+            record.coneAxis[1] = meshlet.coneAxis.y;
+            record.coneAxis[2] = meshlet.coneAxis.z;
+            record.coneCutoff = meshlet.coneCutoff;
+            meshletRecords.push_back(record);
+        }
+        meshletVertices = meshlets->getVertices();
+        for (size_t i = 0; i < meshletVertices.size(); i++)
+            meshletVertices[i] = meshletVertices[i] < vertexCount ? remap[meshletVertices[i]] : meshletVertices[i];
+        meshletTriangles = meshlets->getTriangles();
+    }
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.flags = streaming ? FLAG_STREAMING : 0;
+    header.vertexCount = (uint32_t)vertexCount;
+    header.vertexStride = stride;
+    header.indexCount = (uint32_t)indices.size();
+    header.indexSize = indexBuffer.getIndexSize();
+    header.elementCount = declaration.getElementCount();
+    header.lodCount = (uint32_t)lodRecords.size();
+    header.drawCount = (uint32_t)draws.size();
+    header.meshletCount = (uint32_t)meshletRecords.size();
+    header.meshletVertexCount = (uint32_t)meshletVertices.size();
+    header.meshletTriangleSize = (uint32_t)meshletTriangles.size();
+    RBoundingSphere bounds = builder.getBounds();
+    header.bounds[0] = bounds.center.x;
+    header.bounds[1] = bounds.center.y;
+    header.bounds[2] = bounds.center.z;
+    header.bounds[3] = bounds.radius;
+    memcpy(header.decodeOffset, &declaration.getDecodeOffset().x, sizeof(header.decodeOffset));
+    memcpy(header.decodeScale, &declaration.getDecodeScale().x, sizeof(header.decodeScale));
+
+    uint64_t offset = sizeof(Header);
+    header.elementOffset = RFileMapping::alignOffset(offset, MESH_FILE_TABLE_ALIGNMENT);
+    offset = header.elementOffset + header.elementCount * sizeof(Element);
+    header.lodOffset = RFileMapping::alignOffset(offset, MESH_FILE_TABLE_ALIGNMENT);
+    offset = header.lodOffset + header.lodCount * sizeof(Lod);
+    header.drawOffset = RFileMapping::alignOffset(offset, MESH_FILE_TABLE_ALIGNMENT);
+    offset = header.drawOffset + header.drawCount * sizeof(Draw);
+    if (streaming)
+    {
+        // Each level stores its indices, then the vertices it adds to the
+        // coarser levels; the finest level also stores the unused vertices.
+        uint32_t firstVertex = 0;
+        for (size_t l = lodRecords.size(); l-- > 0;)
+        {
+            Lod& lod = lodRecords[l];
+            lod.indexDataOffset = RFileMapping::alignOffset(offset, MESH_FILE_BLOCK_ALIGNMENT);
+            offset = lod.indexDataOffset + (uint64_t)lod.indexCount * header.indexSize;
+            lod.firstStoredVertex = firstVertex;
+            lod.storedVertexCount = (l == 0 ? (uint32_t)vertexCount : lod.vertexCount) - firstVertex;
+            lod.vertexDataOffset = RFileMapping::alignOffset(offset, MESH_FILE_BLOCK_ALIGNMENT);
+            offset = lod.vertexDataOffset + (uint64_t)lod.storedVertexCount * stride;
+            lod.requiredSize = offset;
+            firstVertex += lod.storedVertexCount;
+        }
+    }
+    else
+    {
+        header.indexOffset = RFileMapping::alignOffset(offset, MESH_FILE_BLOCK_ALIGNMENT);
+        offset = header.indexOffset + indexBuffer.getSize();
+        header.vertexOffset = RFileMapping::alignOffset(offset, MESH_FILE_BLOCK_ALIGNMENT);
+        offset = header.vertexOffset + (uint64_t)vertexCount * stride;
+
+        // The coarsest level stores every vertex, the loader uploads it first.
+        for (size_t l = 0; l < lodRecords.size(); l++)
+        {
+            Lod& lod = lodRecords[l];
+            lod.indexDataOffset = header.indexOffset + (uint64_t)lod.firstIndex * header.indexSize;
+            lod.storedVertexCount = l + 1 == lodRecords.size() ? (uint32_t)vertexCount : 0;
+            lod.vertexDataOffset = header.vertexOffset;
+            lod.requiredSize = std::max(lod.indexDataOffset + (uint64_t)lod.indexCount * header.indexSize,
+                                        header.vertexOffset + (uint64_t)lod.vertexCount * stride);
+        }
+    }
+    header.meshletOffset = RFileMapping::alignOffset(offset, MESH_FILE_TABLE_ALIGNMENT);
+    offset = header.meshletOffset + meshletRecords.size() * sizeof(Meshlet);
+    header.meshletVertexOffset = RFileMapping::alignOffset(offset, MESH_FILE_TABLE_ALIGNMENT);
+    offset = header.meshletVertexOffset + meshletVertices.size() * sizeof(uint32_t);
+    header.meshletTriangleOffset = RFileMapping::alignOffset(offset, MESH_FILE_TABLE_ALIGNMENT);
+    header.fileSize = header.meshletTriangleOffset + meshletTriangles.size();
+
+    dst->assign((size_t)header.fileSize, 0);
+    uint8_t* bytes = dst->data();
+    for (unsigned int i = 0; i < header.elementCount; i++)
+    {
+        const RVertexDeclaration::Element& element = declaration.getElement(i);
+        Element record = { (uint32_t)element.semantic, (uint32_t)element.format, element.offset };
+        memcpy(bytes + header.elementOffset + i * sizeof(Element), &record, sizeof(record));
+    }
+    if (!lodRecords.empty())
+        memcpy(bytes + header.lodOffset, lodRecords.data(), lodRecords.size() * sizeof(Lod));
+    if (!draws.empty())
+        memcpy(bytes + header.drawOffset, draws.data(), draws.size() * sizeof(Draw));
+    if (streaming)
+    {
+        std::vector<uint32_t> order(vertexCount);
+        for (size_t v = 0; v < vertexCount; v++)
+            order[remap[v]] = (uint32_t)v;
+        for (size_t l = 0; l < lodRecords.size(); l++)
+        {
+            const Lod& lod = lodRecords[l];
+            if (lod.indexCount > 0)
+                memcpy(bytes + lod.indexDataOffset, (const uint8_t*)indexBuffer.getData() + (size_t)lod.firstIndex * header.indexSize,
+                       (size_t)lod.indexCount * header.indexSize);
+            for (uint32_t v = 0; v < lod.storedVertexCount; v++)
+                memcpy(bytes + lod.vertexDataOffset + (size_t)v * stride, &converted[(size_t)order[lod.firstStoredVertex + v] * stride], stride);
+        }
+    }
+    else
+    {
+        if (indexBuffer.getSize() > 0)
+            memcpy(bytes + header.indexOffset, indexBuffer.getData(), indexBuffer.getSize());
+        for (size_t v = 0; v < vertexCount; v++)
+            memcpy(bytes + header.vertexOffset + (size_t)remap[v] * stride, &converted[v * stride], stride);
+    }
+    if (!meshletRecords.empty())
+        memcpy(bytes + header.meshletOffset, meshletRecords.data(), meshletRecords.size() * sizeof(Meshlet));
+    if (!meshletVertices.empty())
+        memcpy(bytes + header.meshletVertexOffset, meshletVertices.data(), meshletVertices.size() * sizeof(uint32_t));
+    if (!meshletTriangles.empty())
+        memcpy(bytes + header.meshletTriangleOffset, meshletTriangles.data(), meshletTriangles.size());
+
+    header.checksum = RFileMapping::computeChecksum(bytes + sizeof(Header), (size_t)header.fileSize - sizeof(Header));
+    memcpy(bytes, &header, sizeof(header));
+}
+
+}
@@ -0,0 +1,364 @@
+#pragma once
+
+#include "RMesh.h"
+#include "RMeshBuilder.h"
+#include "utilities/FileMapping.h"
+
+namespace rocket
+{
+
+/**
+ * Defines the binary mesh asset format and its loader.
+ *
+ * A mesh file is a header followed by tables and blocks at the offsets
+ * the header lists, all little endian:
+ *
+ * - the vertex declaration, the levels of detail and the draws of each
+ *   level (levels split by RIndexBuffer into several draws),
+ * - the indices (16 or 32-bit) and the vertices, aligned to 64 bytes and
+ *   in the format the GPU draws from,
+ * - the meshlets, their vertex lists and their local triangles.
+ *
+ * Loading is mapping the file (open()), checking the header and turning
+ * offsets into pointers: the data is uploaded straight from the mapping,
+ * nothing is parsed or converted. verify() checks the CRC-32 of
+ * everything after the header, for assets from untrusted storage.
+ *
+ * write() is the offline converter from an RMeshBuilder. Files store the
+ * indices and the vertices as two blocks (getIndices(), getVertices()),
+ * unless written for streaming: then the indices are ordered from the
+ * coarsest level and the vertices by first use in that order, and each
+ * level stores its indices followed by the vertices it adds to the coarser
+ * levels, coarsest level first. Every level needs only the prefix of the
+ * file up to its own data, so a loader reading the file sequentially can
+ * openMemory() what it has read so far and upload each level, into index
+ * and vertex buffers of the full size, as soon as isLodAvailable().
+ * getLodIndices() and getLodVertices() give the data of a level in both
+ * layouts.
+ */
+class API RMeshFile
+{
+public:
+
+    /**
+     * The first four bytes of a mesh file, "RMSH".
+     */
+    static const uint32_t MAGIC = 0x48534d52;
+
+    /**
+     * The version of the format.
+     */
+    static const uint32_t VERSION = 2;
+
+    /**
+     * Set in Header::flags for files written for streaming.
+     */
+    static const uint32_t FLAG_STREAMING = 1;
+
+    /**
+     * The header at the start of the file.
+     */
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t flags;
+
+        /**
+         * The CRC-32 of the bytes after the header.
+         */
+        uint32_t checksum;
+
+        uint64_t fileSize;
+        uint32_t vertexCount;
+        uint32_t vertexStride;
+        uint32_t indexCount;
+
+        /**
+         * The size of an index, 2 or 4 bytes.
+         */
+        uint32_t indexSize;
+
+        uint32_t elementCount;
+        uint32_t lodCount;
+        uint32_t drawCount;
+        uint32_t meshletCount;
+        uint32_t meshletVertexCount;
+        uint32_t meshletTriangleSize;
+
+        /**
+         * The bounding sphere: center and radius.
+         */
+        float bounds[4];
+
+        float decodeOffset[3];
+        float decodeScale[3];
+        uint64_t elementOffset;
+        uint64_t lodOffset;
+        uint64_t drawOffset;
+        uint64_t indexOffset;
+        uint64_t vertexOffset;
+        uint64_t meshletOffset;
+        uint64_t meshletVertexOffset;
+        uint64_t meshletTriangleOffset;
+    };
+
+    /**
+     * An attribute of the vertex declaration.
+     */
+    struct Element
+    {
+        uint32_t semantic;
+        uint32_t format;
+        uint32_t offset;
+    };
+
+    /**
+     * A level of detail.
+     */
+    struct Lod
+    {
+        float error;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        uint32_t firstDraw;
+        uint32_t drawCount;
+
+        /**
+         * The number of vertices from the first the level uses.
+         */
+        uint32_t vertexCount;
+
+        /**
+         * The first of the vertices stored with the level.
+         */
+        uint32_t firstStoredVertex;
+
+        /**
+         * The number of vertices stored with the level.
+         */
+        uint32_t storedVertexCount;
+
+        /**
+         * The offset of the level's indexCount indices in the file.
+         */
+        uint64_t indexDataOffset;
+
+        /**
+         * The offset of the vertices stored with the level in the file.
+         */
+        uint64_t vertexDataOffset;
+
+        /**
+         * The size of the file prefix holding the level's indices and the
+         * vertices of the level and the coarser levels.
+         */
+        uint64_t requiredSize;
+    };
+
+    /**
+     * A draw of a level.
+     */
+    struct Draw
+    {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        uint32_t baseVertex;
+        uint32_t reserved;
+    };
+
+    /**
+     * A meshlet, see RMeshlet.
+     */
+    struct Meshlet
+    {
+        uint32_t vertexOffset;
+        uint32_t triangleOffset;
+        uint32_t vertexCount;
+        uint32_t triangleCount;
+        float bounds[4];
+        float coneAxis[3];
+        float coneCutoff;
+    };
+
+    /**
+     * Constructs a closed file.
+     */
+    RMeshFile();
+
+    /**
+     * Destructor, closes the file.
+     */
+    ~RMeshFile();
+
+    /**
+     * Maps a mesh file into memory.
+     *
+     * @param path The path of the file.
+     *
+     * @return false if the file cannot be mapped or is not a complete mesh file.
+     */
+    bool open(const char* path);
+
+    /**
+     * Opens a mesh file in memory, which must outlive the RMeshFile.
+     *
+     * The data may be a prefix of the file holding at least the header and
+     * the tables, while it is streamed in.
+     *
+     * @param data The file data.
+     * @param size The size of the data in bytes.
+     *
+     * @return false if the data is not a mesh file or misses the tables.
+     */
+    bool openMemory(const void* data, size_t size);
+
+    /**
+     * Closes the file, unmapping it.
+     */
+    void close();
+
+    /**
+     * Determines whether the whole file is available.
+     *
+     * @return true if the file is open and complete.
+     */
+    bool isComplete() const;
+
+    /**
+     * Checks the checksum of the file.
+     *
+     * @return true if the file is complete and its checksum matches.
+     */
+    bool verify() const;
+
+    /**
+     * Gets the header of the open file.
+     *
+     * @return The header, NULL if the file is closed.
+     */
+    const Header* getHeader() const;
+
+    /**
+     * Gets the vertex declaration of the vertex block.
+     *
+     * @return The declaration, with its position decode transform.
+     */
+    RVertexDeclaration getDeclaration() const;
+
+    /**
+     * Gets the vertex block.
+     *
+     * @return vertexCount * vertexStride bytes, ready to upload, or NULL for
+     *      streaming files, whose vertices are stored per level.
+     */
+    const uint8_t* getVertices() const;
+
+    /**
+     * Gets the index block.
+     *
+     * @return indexCount * indexSize bytes, ready to upload, or NULL for
+     *      streaming files, whose indices are stored per level.
+     */
+    const uint8_t* getIndices() const;
+
+    /**
+     * Gets the number of levels of detail.
+     *
+     * @return The level count, at least 1 for an open file.
+     */
+    unsigned int getLodCount() const;
+
+    /**
+     * Gets a level of detail.
+     *
+     * @param level The level, less than getLodCount().
+     *
+     * @return The level.
+     */
+    const Lod& getLod(unsigned int level) const;
+
+    /**
+     * Gets the draws of a level of detail.
+     *
+     * @param level The level, less than getLodCount().
+     *
+     * @return getLod(level).drawCount draws.
+     */
+    const Draw* getDraws(unsigned int level) const;
+
+    /**
+     * Determines whether the indices and vertices of a level are available.
+     *
+     * @param level The level.
+     *
+     * @return true if the open data holds the prefix the level requires.
+     */
+    bool isLodAvailable(unsigned int level) const;
+
+    /**
+     * Gets the indices of a level of detail.
+     *
+     * @param level The level.
+     *
+     * @return getLod(level).indexCount indices, uploaded at firstIndex, or
+     *      NULL if the level is not available.
+     */
+    const uint8_t* getLodIndices(unsigned int level) const;
+
+    /**
+     * Gets the vertices stored with a level of detail. Uploading the
+     * vertices of every level gives the vertex buffer.
+     *
+     * @param level The level.
+     *
+     * @return getLod(level).storedVertexCount vertices, uploaded at
+     *      firstStoredVertex, or NULL if the level is not available.
+     */
+    const uint8_t* getLodVertices(unsigned int level) const;
+
+    /**
+     * Sets the bounds and levels of detail of a mesh, one part per level,
+     * with the draws of levels split into several draws.
+     *
+     * @param mesh The mesh.
+     */
+    void getMesh(RMesh* mesh) const;
+
+    /**
+     * Fills a meshlet set with the meshlets of the file.
+     *
+     * @param meshlets The set to fill, cleared first.
+     *
+     * @return false if the meshlets are not available yet.
+     */
+    bool getMeshlets(RMeshletSet* meshlets) const;
+
+    /**
+     * Converts a mesh to the format.
+     *
+     * @param builder The mesh, usually optimized.
+     * @param source The float attributes of the builder's vertices.
+     * @param target The declaration of the vertex block (see RMeshBuilder::selectDeclaration()).
+     * @param lods The levels of detail from RMeshBuilder::generateLods(), or an
+     *      empty list for a single level of all indices.
+     * @param meshlets The meshlets of the builder, or NULL.
+     * @param streaming Whether to order the blocks for streaming.
+     * @param dst Set to the file data.
+     */
+    static void write(const RMeshBuilder& builder, const RVertexDeclaration& source, const RVertexDeclaration& target,
+                      const std::vector<RMeshPart>& lods, const RMeshletSet* meshlets, bool streaming,
+                      std::vector<uint8_t>* dst);
+
+private:
+
+    RMeshFile(const RMeshFile& copy);
+
+    RMeshFile& operator=(const RMeshFile&);
+
+    const uint8_t* _data;
+    size_t _size;
+    RFileMapping _mapping;
+};
+
+}
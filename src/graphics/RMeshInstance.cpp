@@ -0,0 +1,46 @@
+#include "common.h"
+#include "RMeshInstance.h"
+
+namespace rocket
+{
+
+RMeshInstance::RMeshInstance(RInstanceBatcher* batcher, unsigned int batch)
+    : _batcher(batcher), _batch(batch), _index(0)
+{
+    if (!_batcher || _batch >= _batcher->getBatchCount())
+    {
+        _batcher = NULL;
+        return;
+    }
+    _batcher->add(this);
+}
+
+RMeshInstance::~RMeshInstance()
+{
+    if (_batcher)
+        _batcher->remove(this);
+}
+
+RInstanceBatcher* RMeshInstance::getBatcher() const
+{
+    return _batcher;
+}
+
+unsigned int RMeshInstance::getBatch() const
+{
+    return _batch;
+}
+
+const RMatrix& RMeshInstance::getTransform() const
+{
+    return _transform;
+}
+
+void RMeshInstance::setTransform(const RMatrix& world)
+{
+    _transform = world;
+    if (_batcher)
+        _batcher->setTransform(_index, world);
+}
+
+}
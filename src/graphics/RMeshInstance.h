@@ -0,0 +1,75 @@
+#pragma once
+
+#include "RInstanceBatcher.h"
+
+namespace rocket
+{
+
+/**
+ * Defines an instance of a mesh drawn by an RInstanceBatcher.
+ *
+ * The instance registers with a batch of the batcher on construction and
+ * unregisters on destruction. It only holds a world transform; culling,
+ * writing the instance buffer and drawing are done for all instances of
+ * the batcher at once.
+ */
+class API RMeshInstance
+{
+public:
+
+    /**
+     * Constructs an instance with an identity transform.
+     *
+     * @param batcher The batcher to register with.
+     * @param batch The index of the batch in the batcher.
+     */
+    RMeshInstance(RInstanceBatcher* batcher, unsigned int batch);
+
+    /**
+     * Destructor, unregisters from the batcher.
+     */
+    ~RMeshInstance();
+
+    /**
+     * Gets the batcher the instance is registered with.
+     *
+     * @return The batcher, NULL if the batcher was destroyed.
+     */
+    RInstanceBatcher* getBatcher() const;
+
+    /**
+     * Gets the batch of the instance.
+     *
+     * @return The index of the batch.
+     */
+    unsigned int getBatch() const;
+
+    /**
+     * Gets the world transform.
+     *
+     * @return The world matrix.
+     */
+    const RMatrix& getTransform() const;
+
+    /**
+     * Sets the world transform.
+     *
+     * @param world The world matrix.
+     */
+    void setTransform(const RMatrix& world);
+
+private:
+
+    friend class RInstanceBatcher;
+
+    RMeshInstance(const RMeshInstance& copy);
+
+    RMeshInstance& operator=(const RMeshInstance&);
+
+    RInstanceBatcher* _batcher;
+    unsigned int _batch;
+    size_t _index;
+    RMatrix _transform;
+};
+
+}
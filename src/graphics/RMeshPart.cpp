@@ -0,0 +1,46 @@
+#include "common.h"
+#include "RMeshPart.h"
+
+namespace rocket
+{
+
+RMeshPart::RMeshPart()
+    : _firstIndex(0), _indexCount(0), _error(0.0f), _baseVertex(0)
+{
+}
+
+RMeshPart::RMeshPart(uint32_t firstIndex, uint32_t indexCount, float error, uint32_t baseVertex)
+    : _firstIndex(firstIndex), _indexCount(indexCount), _error(error), _baseVertex(baseVertex)
+{
+}
+
+RMeshPart::~RMeshPart()
+{
+}
+
+uint32_t RMeshPart::getFirstIndex() const
+{
+    return _firstIndex;
+}
+
+uint32_t RMeshPart::getIndexCount() const
+{
+    return _indexCount;
+}
+
+uint32_t RMeshPart::getTriangleCount() const
+{
+    return _indexCount / 3;
+}
+
+float RMeshPart::getError() const
+{
+    return _error;
+}
+
+uint32_t RMeshPart::getBaseVertex() const
+{
+    return _baseVertex;
+}
+
+}
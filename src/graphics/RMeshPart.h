@@ -0,0 +1,86 @@
+#pragma once
+
+#include "common.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a part of a mesh: a range of its index buffer drawn with one
+ * draw call.
+ *
+ * Levels of detail are parts too, each with the geometric error of its
+ * simplification so a level can be chosen by its projected size.
+ *
+ * The base vertex is added to every index of the part when drawing
+ * (glDrawElementsBaseVertex), so parts of meshes with more than 65536
+ * vertices can still use 16-bit indices (see RIndexBuffer).
+ */
+class API RMeshPart
+{
+public:
+
+    /**
+     * Constructs an empty part.
+     */
+    RMeshPart();
+
+    /**
+     * Constructs a part.
+     *
+     * @param firstIndex The first index of the part.
+     * @param indexCount The number of indices.
+     * @param error The distance the part deviates from the full detail surface, in position units.
+     * @param baseVertex The value added to the indices of the part.
+     */
+    RMeshPart(uint32_t firstIndex, uint32_t indexCount, float error = 0.0f, uint32_t baseVertex = 0);
+
+    /**
+     * Destructor.
+     */
+    ~RMeshPart();
+
+    /**
+     * Gets the first index of the part.
+     *
+     * @return The first index.
+     */
+    uint32_t getFirstIndex() const;
+
+    /**
+     * Gets the number of indices of the part.
+     *
+     * @return The index count.
+     */
+    uint32_t getIndexCount() const;
+
+    /**
+     * Gets the number of triangles of the part.
+     *
+     * @return The triangle count.
+     */
+    uint32_t getTriangleCount() const;
+
+    /**
+     * Gets the distance the part deviates from the full detail surface.
+     *
+     * @return The error in position units, 0 for full detail.
+     */
+    float getError() const;
+
+    /**
+     * Gets the value added to the indices of the part when drawing.
+     *
+     * @return The base vertex, 0 unless the part was split by RIndexBuffer.
+     */
+    uint32_t getBaseVertex() const;
+
+private:
+
+    uint32_t _firstIndex;
+    uint32_t _indexCount;
+    float _error;
+    uint32_t _baseVertex;
+};
+
+}
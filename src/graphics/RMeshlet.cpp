@@ -0,0 +1,121 @@
+#include "common.h"
+#include "RMeshlet.h"
+
+namespace rocket
+{
+
+RMeshletSet::RMeshletSet()
+{
+    memset(&_statistics, 0, sizeof(_statistics));
+}
+
+RMeshletSet::~RMeshletSet()
+{
+}
+
+void RMeshletSet::clear()
+{
+    _meshlets.clear();
+    _vertices.clear();
+    _triangles.clear();
+}
+
+void RMeshletSet::add(const RMeshlet& meshlet, const uint32_t* vertices, const uint8_t* triangles)
+{
+    RMeshlet added = meshlet;
+    added.vertexOffset = (uint32_t)_vertices.size();
+    added.triangleOffset = (uint32_t)_triangles.size();
+    _vertices.insert(_vertices.end(), vertices, vertices + meshlet.vertexCount);
+    _triangles.insert(_triangles.end(), triangles, triangles + meshlet.triangleCount * 3);
+    _meshlets.push_back(added);
+}
+
+size_t RMeshletSet::size() const
+{
+    return _meshlets.size();
+}
+
+const RMeshlet& RMeshletSet::get(size_t index) const
+{
+    return _meshlets[index];
+}
+
+const std::vector<uint32_t>& RMeshletSet::getVertices() const
+{
+    return _vertices;
+}
+
+const std::vector<uint8_t>& RMeshletSet::getTriangles() const
+{
+    return _triangles;
+}
+
+size_t RMeshletSet::cull(const RMatrix& world, const RFrustum& frustum, const RVector3& cameraPosition,
+                         const ROcclusionBuffer* occlusion, std::vector<uint32_t>* dst)
+{
+    memset(&_statistics, 0, sizeof(_statistics));
+    _statistics.meshlets = (unsigned int)_meshlets.size();
+    dst->clear();
+
+    RPlane planes[6];
+    frustum.getPlanes(planes);
+    const float* w = world.m;
+    float sx = w[0] * w[0] + w[1] * w[1] + w[2] * w[2];
+    float sy = w[4] * w[4] + w[5] * w[5] + w[6] * w[6];
+    float sz = w[8] * w[8] + w[9] * w[9] + w[10] * w[10];
+    float scale = sqrt(std::max(sx, std::max(sy, sz)));
+
+    size_t visible = 0;
+    for (size_t i = 0; i < _meshlets.size(); i++)
+    {
+        const RMeshlet& meshlet = _meshlets[i];
+        const RVector3& c = meshlet.bounds.center;
+        RBoundingSphere bounds(RVector3(w[0] * c.x + w[4] * c.y + w[8] * c.z + w[12],
+                                        w[1] * c.x + w[5] * c.y + w[9] * c.z + w[13],
+                                        w[2] * c.x + w[6] * c.y + w[10] * c.z + w[14]),
+                               meshlet.bounds.radius * scale);
+
+        bool inside = true;
+        for (unsigned int p = 0; p < 6 && inside; p++)
+            inside = planes[p].distance(bounds.center) >= -bounds.radius;
+        if (!inside)
+        {
+            _statistics.frustumCulled++;
+            continue;
+        }
+
+        // Back facing when every direction from the camera into the bounds
+        // is within the complement of the cone angle of the axis.
+        const RVector3& a = meshlet.coneAxis;
+        RVector3 axis(w[0] * a.x + w[4] * a.y + w[8] * a.z,
+                      w[1] * a.x + w[5] * a.y + w[9] * a.z,
+                      w[2] * a.x + w[6] * a.y + w[10] * a.z);
+        RVector3 view = bounds.center - cameraPosition;
+        if (view.dot(axis) > meshlet.coneCutoff * view.length() * axis.length() + bounds.radius * axis.length())
+        {
+            _statistics.backfaceCulled++;
+            continue;
+        }
+
+        if (occlusion && occlusion->isOccluded(bounds))
+        {
+            _statistics.occlusionCulled++;
+            continue;
+        }
+
+        const uint32_t* vertices = &_vertices[meshlet.vertexOffset];
+        const uint8_t* triangles = &_triangles[meshlet.triangleOffset];
+        for (uint32_t t = 0; t < meshlet.triangleCount * 3; t++)
+            dst->push_back(vertices[triangles[t]]);
+        _statistics.triangles += meshlet.triangleCount;
+        visible++;
+    }
+    return visible;
+}
+
+const RMeshletSet::Statistics& RMeshletSet::getStatistics() const
+{
+    return _statistics;
+}
+
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "ROcclusionBuffer.h"
+#include "math/RFrustum.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a meshlet: a small cluster of triangles with its own vertex list,
+ * bounds and normal cone, culled as a unit.
+ */
+struct RMeshlet
+{
+    /**
+     * The offset of the meshlet's vertices in RMeshletSet::getVertices().
+     */
+    uint32_t vertexOffset;
+
+    /**
+     * The offset of the meshlet's triangles in RMeshletSet::getTriangles(), in bytes.
+     */
+    uint32_t triangleOffset;
+
+    uint32_t vertexCount;
+    uint32_t triangleCount;
+
+    /**
+     * The bounds of the meshlet's vertices.
+     */
+    RBoundingSphere bounds;
+
+    /**
+     * The average normal of the triangles.
+     */
+    RVector3 coneAxis;
+
+    /**
+     * The sine of the angle between the axis and the farthest normal, 1 if
+     * the normals span a hemisphere or more and the meshlet is never back facing.
+     */
+    float coneCutoff;
+};
+
+/**
+ * Defines the meshlets of a mesh (see RMeshBuilder::buildMeshlets()) and
+ * the culling of them.
+ *
+ * Each meshlet lists the mesh vertices it uses, and its triangles as
+ * three 8-bit indices into that list. cull() tests every meshlet against
+ * a frustum, its normal cone and optionally an occlusion buffer, and
+ * writes the triangles of the visible ones to a compacted index list, so
+ * large static meshes are culled at a finer granularity than the object.
+ */
+class API RMeshletSet
+{
+public:
+
+    /**
+     * The counts of the last cull().
+     */
+    struct Statistics
+    {
+        unsigned int meshlets;
+        unsigned int frustumCulled;
+        unsigned int backfaceCulled;
+        unsigned int occlusionCulled;
+        unsigned int triangles;
+    };
+
+    /**
+     * Constructs an empty set.
+     */
+    RMeshletSet();
+
+    /**
+     * Destructor.
+     */
+    ~RMeshletSet();
+
+    /**
+     * Removes all meshlets.
+     */
+    void clear();
+
+    /**
+     * Adds a meshlet.
+     *
+     * @param meshlet The counts, bounds and cone of the meshlet; the offsets are assigned.
+     * @param vertices meshlet.vertexCount mesh vertex indices.
+     * @param triangles 3 * meshlet.triangleCount indices into vertices.
+     */
+    void add(const RMeshlet& meshlet, const uint32_t* vertices, const uint8_t* triangles);
+
+    /**
+     * Gets the number of meshlets.
+     *
+     * @return The number of meshlets.
+     */
+    size_t size() const;
+
+    /**
+     * Gets a meshlet.
+     *
+     * @param index The index of the meshlet.
+     *
+     * @return The meshlet.
+     */
+    const RMeshlet& get(size_t index) const;
+
+    /**
+     * Gets the mesh vertex indices of all meshlets.
+     *
+     * @return The vertex indices.
+     */
+    const std::vector<uint32_t>& getVertices() const;
+
+    /**
+     * Gets the local triangles of all meshlets.
+     *
+     * @return The triangle indices.
+     */
+    const std::vector<uint8_t>& getTriangles() const;
+
+    /**
+     * Culls the meshlets and writes the triangles of the visible ones.
+     *
+     * Normal cones assume counter-clockwise front faces and a world matrix
+     * without non-uniform scale.
+     *
+     * @param world The world matrix of the mesh.
+     * @param frustum The view frustum in world space.
+     * @param cameraPosition The camera position in world space.
+     * @param occlusion The occlusion buffer of the view, or NULL.
+     * @param dst Set to the mesh indices of the visible triangles.
+     *
+     * @return The number of visible meshlets.
+     */
+    size_t cull(const RMatrix& world, const RFrustum& frustum, const RVector3& cameraPosition,
+                const ROcclusionBuffer* occlusion, std::vector<uint32_t>* dst);
+
+    /**
+     * Gets the counts of the last cull().
+     *
+     * @return The statistics.
+     */
+    const Statistics& getStatistics() const;
+
+private:
+
+    std::vector<RMeshlet> _meshlets;
+    std::vector<uint32_t> _vertices;
+    std::vector<uint8_t> _triangles;
+    Statistics _statistics;
+};
+
+}
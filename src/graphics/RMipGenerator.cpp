@@ -0,0 +1,369 @@
+#include "common.h"
+#include "RMipGenerator.h"
+#include "RTexture.h"
+#include "math/RSimd.h"
+
+namespace rocket
+{
+
+// The fewest rows worth a thread of their own.
+#define MIP_PARALLEL_MIN_ROWS       16
+// The radius of the Kaiser filter in output pixels, and the shape of its window.
+#define MIP_KAISER_RADIUS           3.0f
+#define MIP_KAISER_ALPHA            4.0f
+
+/**
+ * The weights of a downsampling pass along one axis: for each output pixel,
+ * taps source indices (clamped to the edge) and their weights, summing to 1.
+ */
+struct MipKernel
+{
+    unsigned int taps;
+    std::vector<unsigned int> indices;
+    std::vector<float> weights;
+};
+
+static float besselI0(float x)
+{
+    float sum = 1.0f;
+    float term = 1.0f;
+    float q = x * x * 0.25f;
+    for (int k = 1; k < 24; k++)
+    {
+        term *= q / (float)(k * k);
+        sum += term;
+    }
+    return sum;
+}
+
+static float evaluateKaiser(float x)
+{
+    if (std::fabs(x) >= MIP_KAISER_RADIUS)
+        return 0.0f;
+    float sinc = x == 0.0f ? 1.0f : std::sin(MATH_PI * x) / (MATH_PI * x);
+    float t = x / MIP_KAISER_RADIUS;
+    return sinc * besselI0(MIP_KAISER_ALPHA * std::sqrt(1.0f - t * t)) / besselI0(MIP_KAISER_ALPHA);
+}
+
+static void buildKernel(unsigned int srcSize, unsigned int dstSize, RMipGenerator::Filter filter, MipKernel* kernel)
+{
+    float scale = (float)srcSize / (float)dstSize;
+    // The filter footprint of each output pixel, in source pixels.
+    float radius = filter == RMipGenerator::FILTER_BOX ? scale * 0.5f : scale * MIP_KAISER_RADIUS;
+
+    std::vector<int> first(dstSize);
+    kernel->taps = 1;
+    for (unsigned int i = 0; i < dstSize; i++)
+    {
+        float center = ((float)i + 0.5f) * scale;
+        first[i] = (int)std::floor(center - radius);
+        int last = (int)std::ceil(center + radius) - 1;
+        kernel->taps = std::max(kernel->taps, (unsigned int)(last - first[i] + 1));
+    }
+
+    kernel->indices.assign(dstSize * kernel->taps, 0);
+    kernel->weights.assign(dstSize * kernel->taps, 0.0f);
+    for (unsigned int i = 0; i < dstSize; i++)
+    {
+        float center = ((float)i + 0.5f) * scale;
+        float total = 0.0f;
+        for (unsigned int t = 0; t < kernel->taps; t++)
+        {
+            int s = first[i] + (int)t;
+            float weight;
+            if (filter == RMipGenerator::FILTER_BOX)
+            {
+                // The overlap of the source pixel with the output footprint.
+                float lo = std::max((float)s, center - radius);
+                float hi = std::min((float)(s + 1), center + radius);
+                weight = std::max(hi - lo, 0.0f);
+            }
+            else
+            {
+                weight = evaluateKaiser(((float)s + 0.5f - center) / scale);
+            }
+            kernel->indices[i * kernel->taps + t] = (unsigned int)std::min(std::max(s, 0), (int)srcSize - 1);
+            kernel->weights[i * kernel->taps + t] = weight;
+            total += weight;
+        }
+        for (unsigned int t = 0; t < kernel->taps; t++)
+            kernel->weights[i * kernel->taps + t] /= total;
+    }
+}
+
+/**
+ * Filters each row of RGBA pixels along x.
+ */
+static void filterRows(const float* src, unsigned int srcWidth, float* dst, unsigned int dstWidth, size_t rows,
+                       const MipKernel& kernel, unsigned int threadCount)
+{
+    RParallel::parallelFor(rows, MIP_PARALLEL_MIN_ROWS, threadCount, [&](size_t begin, size_t end)
+    {
+        for (size_t row = begin; row < end; row++)
+        {
+            const float* in = src + row * srcWidth * 4;
+            float* out = dst + row * dstWidth * 4;
+            // With SSE2 a lane holds the four channels of a pixel, scalar lanes hold one channel.
+            simdForEach((size_t)dstWidth * 4, [&](auto lane, size_t i)
+            {
+                typedef decltype(lane) F;
+                size_t x = i / 4;
+                size_t channel = i % 4;
+                const unsigned int* indices = &kernel.indices[x * kernel.taps];
+                const float* weights = &kernel.weights[x * kernel.taps];
+                F sum(0.0f);
+                for (unsigned int t = 0; t < kernel.taps; t++)
+                    sum = sum + F(weights[t]) * F::load(in + indices[t] * 4 + channel);
+                sum.store(out + i);
+            });
+        }
+    });
+}
+
+/**
+ * Filters whole rows of rowSize floats along an outer axis of the image,
+ * y or z. The image is indexed as [outer][axis][inner] rows, and the axis
+ * shrinks from srcCount to dstCount rows.
+ */
+static void filterAxis(const float* src, float* dst, size_t rowSize, unsigned int srcCount, unsigned int dstCount,
+                       size_t outer, size_t inner, const MipKernel& kernel, unsigned int threadCount)
+{
+    RParallel::parallelFor(outer * dstCount * inner, MIP_PARALLEL_MIN_ROWS, threadCount, [&](size_t begin, size_t end)
+    {
+        for (size_t job = begin; job < end; job++)
+        {
+            size_t b = job % inner;
+            size_t n = (job / inner) % dstCount;
+            size_t a = job / inner / dstCount;
+            const unsigned int* indices = &kernel.indices[n * kernel.taps];
+            const float* weights = &kernel.weights[n * kernel.taps];
+            float* out = dst + ((a * dstCount + n) * inner + b) * rowSize;
+            simdForEach(rowSize, [&](auto lane, size_t i)
+            {
+                typedef decltype(lane) F;
+                F sum(0.0f);
+                for (unsigned int t = 0; t < kernel.taps; t++)
+                    sum = sum + F(weights[t]) * F::load(src + ((a * srcCount + indices[t]) * inner + b) * rowSize + i);
+                sum.store(out + i);
+            });
+        }
+    });
+}
+
+static const float* getSrgbToLinearTable()
+{
+    static const std::vector<float> table = []()
+    {
+        std::vector<float> values(256);
+        for (unsigned int i = 0; i < 256; i++)
+        {
+            float c = (float)i / 255.0f;
+            values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return values;
+    }();
+    return table.data();
+}
+
+static inline float linearToSrgb(float value)
+{
+    return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+}
+
+static inline uint8_t quantize(float value)
+{
+    return (uint8_t)(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+static void normalizePixel(float* pixel)
+{
+    float x = pixel[0] * 2.0f - 1.0f;
+    float y = pixel[1] * 2.0f - 1.0f;
+    float z = pixel[2] * 2.0f - 1.0f;
+    float length = std::sqrt(x * x + y * y + z * z);
+    if (length < 1e-6f)
+    {
+        x = 0.0f;
+        y = 0.0f;
+        z = length = 1.0f;
+    }
+    pixel[0] = x / length * 0.5f + 0.5f;
+    pixel[1] = y / length * 0.5f + 0.5f;
+    pixel[2] = z / length * 0.5f + 0.5f;
+}
+
+/**
+ * Gets the factor that scales the alpha of a mip so that the given fraction
+ * of its pixels reaches the cutoff.
+ */
+static float getCoverageScale(const std::vector<float>& level, size_t pixelCount, float cutoff, float coverage)
+{
+    size_t passing = (size_t)(coverage * (float)pixelCount + 0.5f);
+    if (passing == 0)
+        return 0.0f;
+
+    std::vector<float> alphas(pixelCount);
+    for (size_t i = 0; i < pixelCount; i++)
+        alphas[i] = level[i * 4 + 3];
+    std::nth_element(alphas.begin(), alphas.begin() + (pixelCount - passing), alphas.end());
+    float threshold = alphas[pixelCount - passing];
+    return threshold > 0.0f ? cutoff / threshold : 1.0f;
+}
+
+RMipGenerator::RMipGenerator(Filter filter)
+    : _filter(filter), _srgb(false), _normalMap(false), _alphaCutoff(0.0f)
+{
+}
+
+RMipGenerator::~RMipGenerator()
+{
+}
+
+RMipGenerator::Filter RMipGenerator::getFilter() const
+{
+    return _filter;
+}
+
+void RMipGenerator::setFilter(Filter filter)
+{
+    _filter = filter;
+}
+
+bool RMipGenerator::isSrgb() const
+{
+    return _srgb;
+}
+
+void RMipGenerator::setSrgb(bool srgb)
+{
+    _srgb = srgb;
+}
+
+bool RMipGenerator::isNormalMap() const
+{
+    return _normalMap;
+}
+
+void RMipGenerator::setNormalMap(bool normalMap)
+{
+    _normalMap = normalMap;
+}
+
+float RMipGenerator::getAlphaCutoff() const
+{
+    return _alphaCutoff;
+}
+
+void RMipGenerator::setAlphaCutoff(float cutoff)
+{
+    _alphaCutoff = std::min(std::max(cutoff, 0.0f), 1.0f);
+}
+
+bool RMipGenerator::generate(const uint8_t* rgba, unsigned int width, unsigned int height, unsigned int depth,
+                             unsigned int mipCount, uint8_t* dst) const
+{
+    if (width == 0 || height == 0 || depth == 0)
+        return false;
+    unsigned int fullCount = RTexture::getFullMipCount(width, height, depth);
+    if (mipCount == 0)
+        mipCount = fullCount;
+    if (mipCount > fullCount)
+        return false;
+
+    size_t pixelCount = (size_t)width * height * depth;
+    memcpy(dst, rgba, pixelCount * 4);
+    if (mipCount == 1)
+        return true;
+
+    bool srgb = _srgb && !_normalMap;
+    const float* toLinear = getSrgbToLinearTable();
+    std::vector<float> level(pixelCount * 4);
+    size_t coveragePixels = 0;
+    parallelFor((size_t)height * depth, MIP_PARALLEL_MIN_ROWS, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin * width * 4; i < end * width * 4; i++)
+        {
+            bool color = (i & 3) != 3;
+            level[i] = srgb && color ? toLinear[rgba[i]] : (float)rgba[i] / 255.0f;
+        }
+    });
+    if (_alphaCutoff > 0.0f)
+    {
+        for (size_t i = 0; i < pixelCount; i++)
+        {
+            if (level[i * 4 + 3] >= _alphaCutoff)
+                coveragePixels++;
+        }
+    }
+    float coverage = (float)coveragePixels / (float)pixelCount;
+
+    std::vector<float> scratch;
+    std::vector<float> next;
+    MipKernel kernel;
+    dst += pixelCount * 4;
+    for (unsigned int mip = 1; mip < mipCount; mip++)
+    {
+        unsigned int w = std::max(width >> 1, 1u);
+        unsigned int h = std::max(height >> 1, 1u);
+        unsigned int d = std::max(depth >> 1, 1u);
+
+        // Each pass shrinks one axis, skipped when it is already 1.
+        if (w != width)
+        {
+            buildKernel(width, w, _filter, &kernel);
+            next.resize((size_t)w * height * depth * 4);
+            filterRows(level.data(), width, next.data(), w, (size_t)height * depth, kernel, getThreadCount());
+            level.swap(next);
+        }
+        if (h != height)
+        {
+            buildKernel(height, h, _filter, &kernel);
+            next.resize((size_t)w * h * depth * 4);
+            filterAxis(level.data(), next.data(), (size_t)w * 4, height, h, depth, 1, kernel, getThreadCount());
+            level.swap(next);
+        }
+        if (d != depth)
+        {
+            buildKernel(depth, d, _filter, &kernel);
+            next.resize((size_t)w * h * d * 4);
+            filterAxis(level.data(), next.data(), (size_t)w * 4, depth, d, 1, h, kernel, getThreadCount());
+            level.swap(next);
+        }
+        width = w;
+        height = h;
+        depth = d;
+        pixelCount = (size_t)width * height * depth;
+
+        if (_normalMap)
+        {
+            for (size_t i = 0; i < pixelCount; i++)
+                normalizePixel(&level[i * 4]);
+        }
+        // The coverage scale applies to the stored mip only, the next mip is filtered from unscaled alpha.
+        float alphaScale = _alphaCutoff > 0.0f ? getCoverageScale(level, pixelCount, _alphaCutoff, coverage) : 1.0f;
+        parallelFor((size_t)height * depth, MIP_PARALLEL_MIN_ROWS, [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin * width; i < end * width; i++)
+            {
+                const float* pixel = &level[i * 4];
+                for (unsigned int c = 0; c < 3; c++)
+                    dst[i * 4 + c] = quantize(srgb ? linearToSrgb(pixel[c]) : pixel[c]);
+                dst[i * 4 + 3] = quantize(pixel[3] * alphaScale);
+            }
+        });
+        dst += pixelCount * 4;
+    }
+    return true;
+}
+
+size_t RMipGenerator::getChainSize(unsigned int width, unsigned int height, unsigned int depth, unsigned int mipCount)
+{
+    unsigned int fullCount = RTexture::getFullMipCount(width, height, depth);
+    mipCount = mipCount == 0 ? fullCount : std::min(mipCount, fullCount);
+    size_t size = 0;
+    for (unsigned int mip = 0; mip < mipCount; mip++)
+        size += RTexture::getImageSize(RTexture::FORMAT_RGBA8, std::max(width >> mip, 1u), std::max(height >> mip, 1u), std::max(depth >> mip, 1u));
+    return size;
+}
+
+}
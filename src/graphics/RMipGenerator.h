@@ -0,0 +1,150 @@
+#pragma once
+
+#include "common.h"
+#include "utilities/Parallel.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a generator of mip chains for 2D and 3D RGBA8 images.
+ *
+ * Each mip halves the width, height and depth of the previous one, down to
+ * 1, and is filtered from it separably: rows, then columns, then slices,
+ * each pass split across threads by rows and running SIMD along them. Odd
+ * sizes are filtered exactly instead of dropping the last row or column, and
+ * edges are clamped. The filter is one of:
+ *
+ * - FILTER_BOX: the average of the pixels under each output pixel.
+ * - FILTER_KAISER: a Kaiser-windowed sinc over three output pixels on each
+ *   side, sharper than the box at the cost of slight ringing.
+ *
+ * The chain keeps full float precision between mips and is quantized only
+ * when stored. Options adapt the filtering to the content:
+ *
+ * - sRGB images are filtered in linear space, so bright and dark pixels
+ *   average to the right brightness. Alpha is always linear.
+ * - Normal maps store vectors as RGB * 2 - 1, renormalized after each mip.
+ *   They are never treated as sRGB.
+ * - Alpha-tested images keep in each mip the fraction of pixels that pass
+ *   the alpha cutoff in mip 0, so cutouts such as foliage do not thin out in
+ *   the distance.
+ */
+class API RMipGenerator : public RParallel
+{
+public:
+
+    /**
+     * The downsampling filter.
+     */
+    enum Filter
+    {
+        FILTER_BOX,
+        FILTER_KAISER
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param filter The downsampling filter.
+     */
+    explicit RMipGenerator(Filter filter = FILTER_BOX);
+
+    /**
+     * Destructor.
+     */
+    ~RMipGenerator();
+
+    /**
+     * Gets the downsampling filter.
+     *
+     * @return The filter.
+     */
+    Filter getFilter() const;
+
+    /**
+     * Sets the downsampling filter.
+     *
+     * @param filter The filter.
+     */
+    void setFilter(Filter filter);
+
+    /**
+     * Determines if the color channels are sRGB encoded.
+     *
+     * @return true if colors are filtered in linear space.
+     */
+    bool isSrgb() const;
+
+    /**
+     * Sets if the color channels are sRGB encoded.
+     *
+     * @param srgb true to filter colors in linear space.
+     */
+    void setSrgb(bool srgb);
+
+    /**
+     * Determines if the color channels store normals.
+     *
+     * @return true if normals are renormalized.
+     */
+    bool isNormalMap() const;
+
+    /**
+     * Sets if the color channels store normals.
+     *
+     * @param normalMap true to renormalize normals.
+     */
+    void setNormalMap(bool normalMap);
+
+    /**
+     * Gets the alpha cutoff whose coverage is preserved.
+     *
+     * @return The cutoff in [0, 1], 0 if coverage is not preserved.
+     */
+    float getAlphaCutoff() const;
+
+    /**
+     * Sets the alpha cutoff whose coverage is preserved, the reference value
+     * of the alpha test the texture is drawn with.
+     *
+     * @param cutoff The cutoff in [0, 1], 0 to filter alpha like the other channels.
+     */
+    void setAlphaCutoff(float cutoff);
+
+    /**
+     * Generates a mip chain.
+     *
+     * @param rgba The RGBA8 pixels of mip 0, in rows and then slices.
+     * @param width The width of mip 0 in pixels.
+     * @param height The height of mip 0 in pixels.
+     * @param depth The depth of mip 0 in slices, 1 for 2D images.
+     * @param mipCount The number of mips, 0 for the full chain.
+     * @param dst The chain, mip 0 first, getChainSize(width, height, depth, mipCount) bytes.
+     *
+     * @return false if the image is empty or the mip count exceeds the full chain.
+     */
+    bool generate(const uint8_t* rgba, unsigned int width, unsigned int height, unsigned int depth,
+                  unsigned int mipCount, uint8_t* dst) const;
+
+    /**
+     * Gets the size of an RGBA8 mip chain.
+     *
+     * @param width The width of mip 0 in pixels.
+     * @param height The height of mip 0 in pixels.
+     * @param depth The depth of mip 0 in slices.
+     * @param mipCount The number of mips, 0 for the full chain.
+     *
+     * @return The size in bytes.
+     */
+    static size_t getChainSize(unsigned int width, unsigned int height, unsigned int depth, unsigned int mipCount);
+
+private:
+
+    Filter _filter;
+    bool _srgb;
+    bool _normalMap;
+    float _alphaCutoff;
+};
+
+}
@@ -0,0 +1,142 @@
+#include "common.h"
+#include "ROcclusionBuffer.h"
+#include <cfloat>
+
+namespace rocket
+{
+
+// Vertices closer than this clip w are treated as crossing the near plane.
+#define OCCLUSION_MIN_W     1e-4f
+
+ROcclusionBuffer::ROcclusionBuffer(unsigned int width, unsigned int height)
+    : _width(std::max(width, 1u)), _height(std::max(height, 1u)), _depths((size_t)_width * _height, FLT_MAX)
+{
+}
+
+ROcclusionBuffer::~ROcclusionBuffer()
+{
+}
+
+unsigned int ROcclusionBuffer::getWidth() const
+{
+    return _width;
+}
+
+unsigned int ROcclusionBuffer::getHeight() const
+{
+    return _height;
+}
+
+void ROcclusionBuffer::clear(const RMatrix& viewProjection)
+{
+    _viewProjection = viewProjection;
+    std::fill(_depths.begin(), _depths.end(), FLT_MAX);
+}
+
+void ROcclusionBuffer::addOccluder(const RVector3* positions, const uint32_t* indices, size_t indexCount, const RMatrix& world)
+{
+    RMatrix matrix = _viewProjection * world;
+    const float* m = matrix.m;
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        float x[3], y[3];
+        float depth = 0.0f;
+        bool clipped = false;
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            const RVector3& p = positions[indices[i + k]];
+            float w = m[3] * p.x + m[7] * p.y + m[11] * p.z + m[15];
+            if (w < OCCLUSION_MIN_W)
+            {
+                clipped = true;
+                break;
+            }
+            x[k] = ((m[0] * p.x + m[4] * p.y + m[8] * p.z + m[12]) / w * 0.5f + 0.5f) * _width;
+            y[k] = ((m[1] * p.x + m[5] * p.y + m[9] * p.z + m[13]) / w * 0.5f + 0.5f) * _height;
+            depth = std::max(depth, w);
+        }
+        if (clipped)
+            continue;
+
+        // Counter-clockwise on screen, so the edge functions are positive inside.
+        float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+        if (area == 0.0f)
+            continue;
+        if (area < 0.0f)
+        {
+            std::swap(x[1], x[2]);
+            std::swap(y[1], y[2]);
+        }
+
+        int minX = std::max(0, (int)floor(std::min(x[0], std::min(x[1], x[2]))));
+        int maxX = std::min((int)_width - 1, (int)ceil(std::max(x[0], std::max(x[1], x[2]))));
+        int minY = std::max(0, (int)floor(std::min(y[0], std::min(y[1], y[2]))));
+        int maxY = std::min((int)_height - 1, (int)ceil(std::max(y[0], std::max(y[1], y[2]))));
+        for (int py = minY; py <= maxY; py++)
+        {
+            float cy = py + 0.5f;
+            float* row = &_depths[(size_t)py * _width];
+            for (int px = minX; px <= maxX; px++)
+            {
+                float cx = px + 0.5f;
+                bool inside = true;
+                for (unsigned int k = 0; k < 3 && inside; k++)
+                {
+                    unsigned int n = (k + 1) % 3;
+                    inside = (x[n] - x[k]) * (cy - y[k]) - (y[n] - y[k]) * (cx - x[k]) >= 0.0f;
+                }
+                if (inside)
+                    row[px] = std::min(row[px], depth);
+            }
+        }
+    }
+}
+
+float ROcclusionBuffer::getDepth(unsigned int x, unsigned int y) const
+{
+    if (x >= _width || y >= _height)
+        return FLT_MAX;
+    return _depths[(size_t)y * _width + x];
+}
+
+bool ROcclusionBuffer::isOccluded(const RBoundingSphere& sphere) const
+{
+    const float* m = _viewProjection.m;
+    const RVector3& c = sphere.center;
+    float cx = m[0] * c.x + m[4] * c.y + m[8] * c.z + m[12];
+    float cy = m[1] * c.x + m[5] * c.y + m[9] * c.z + m[13];
+    float cw = m[3] * c.x + m[7] * c.y + m[11] * c.z + m[15];
+    float rx = sphere.radius * sqrt(m[0] * m[0] + m[4] * m[4] + m[8] * m[8]);
+    float ry = sphere.radius * sqrt(m[1] * m[1] + m[5] * m[5] + m[9] * m[9]);
+    float rw = sphere.radius * sqrt(m[3] * m[3] + m[7] * m[7] + m[11] * m[11]);
+    float nearW = cw - rw;
+    float farW = cw + rw;
+    if (nearW < OCCLUSION_MIN_W)
+        return false;
+
+    // Every point of the sphere has x in [cx - rx, cx + rx] and w in
+    // [nearW, farW], so x / w is bounded by the corners of that range.
+    float minX = std::min(std::min((cx - rx) / nearW, (cx - rx) / farW), std::min((cx + rx) / nearW, (cx + rx) / farW));
+    float maxX = std::max(std::max((cx - rx) / nearW, (cx - rx) / farW), std::max((cx + rx) / nearW, (cx + rx) / farW));
+    float minY = std::min(std::min((cy - ry) / nearW, (cy - ry) / farW), std::min((cy + ry) / nearW, (cy + ry) / farW));
+    float maxY = std::max(std::max((cy - ry) / nearW, (cy - ry) / farW), std::max((cy + ry) / nearW, (cy + ry) / farW));
+    int x0 = std::max(0, (int)floor((minX * 0.5f + 0.5f) * _width));
+    int x1 = std::min((int)_width - 1, (int)floor((maxX * 0.5f + 0.5f) * _width));
+    int y0 = std::max(0, (int)floor((minY * 0.5f + 0.5f) * _height));
+    int y1 = std::min((int)_height - 1, (int)floor((maxY * 0.5f + 0.5f) * _height));
+    if (x0 > x1 || y0 > y1)
+        return false;
+
+    for (int y = y0; y <= y1; y++)
+    {
+        const float* row = &_depths[(size_t)y * _width];
+        for (int x = x0; x <= x1; x++)
+        {
+            if (row[x] >= nearW)
+                return false;
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "common.h"
+#include "math/RBoundingSphere.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a small CPU depth buffer of occluders, used to cull objects
+ * hidden behind them.
+ *
+ * Occluder triangles (walls, terrain, large props) are rasterized at low
+ * resolution, each pixel keeping the view depth of the nearest occluder
+ * that covers its center. A triangle is written at the depth of its
+ * farthest vertex, so the stored depth never lies in front of the real
+ * surface. Triangles crossing the near plane are skipped, which only
+ * loses occlusion.
+ *
+ * Depths are clip space w, the view depth for perspective projections.
+ */
+class API ROcclusionBuffer
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param width The width in pixels.
+     * @param height The height in pixels.
+     */
+    ROcclusionBuffer(unsigned int width, unsigned int height);
+
+    /**
+     * Destructor.
+     */
+    ~ROcclusionBuffer();
+
+    /**
+     * Gets the width.
+     *
+     * @return The width in pixels.
+     */
+    unsigned int getWidth() const;
+
+    /**
+     * Gets the height.
+     *
+     * @return The height in pixels.
+     */
+    unsigned int getHeight() const;
+
+    /**
+     * Clears the buffer for a new view.
+     *
+     * @param viewProjection The view projection matrix of the camera.
+     */
+    void clear(const RMatrix& viewProjection);
+
+    /**
+     * Rasterizes occluder triangles, both faces.
+     *
+     * @param positions The vertex positions.
+     * @param indices The indices of the triangles.
+     * @param indexCount The number of indices.
+     * @param world The world matrix of the occluder.
+     */
+    void addOccluder(const RVector3* positions, const uint32_t* indices, size_t indexCount, const RMatrix& world);
+
+    /**
+     * Gets the depth of a pixel.
+     *
+     * @param x The column.
+     * @param y The row, from the bottom.
+     *
+     * @return The depth of the nearest occluder, FLT_MAX if there is none.
+     */
+    float getDepth(unsigned int x, unsigned int y) const;
+
+    /**
+     * Tests whether a sphere is hidden behind the occluders.
+     *
+     * @param sphere The sphere in world space.
+     *
+     * @return true if every pixel the sphere may cover has an occluder in front of the sphere.
+     */
+    bool isOccluded(const RBoundingSphere& sphere) const;
+
+private:
+
+    ROcclusionBuffer(const ROcclusionBuffer& copy);
+
+    ROcclusionBuffer& operator=(const ROcclusionBuffer&);
+
+    unsigned int _width;
+    unsigned int _height;
+    RMatrix _viewProjection;
+    std::vector<float> _depths;
+};
+
+}
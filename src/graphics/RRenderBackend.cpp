@@ -0,0 +1,72 @@
+#include "common.h"
+#include "RRenderBackend.h"
+
+namespace rocket
+{
+
+RRenderBackend::~RRenderBackend()
+{
+}
+
+RRecordingBackend::RRecordingBackend()
+{
+    clear();
+}
+
+RRecordingBackend::~RRecordingBackend()
+{
+}
+
+const std::vector<RRecordingBackend::Call>& RRecordingBackend::getCalls() const
+{
+    return _calls;
+}
+
+unsigned int RRecordingBackend::getCount(CallType type) const
+{
+    return _counts[type];
+}
+
+void RRecordingBackend::clear()
+{
+    _calls.clear();
+    memset(_counts, 0, sizeof(_counts));
+}
+
+void RRecordingBackend::beginPass(unsigned int pass)
+{
+    record(BEGIN_PASS, pass);
+}
+
+void RRecordingBackend::bindShader(uint32_t shader)
+{
+    record(BIND_SHADER, shader);
+}
+
+void RRecordingBackend::bindMaterial(uint32_t material)
+{
+    record(BIND_MATERIAL, material);
+}
+
+void RRecordingBackend::bindMesh(uint32_t mesh)
+{
+    record(BIND_MESH, mesh);
+}
+
+void RRecordingBackend::draw(const RDrawCommand& command)
+{
+    record(DRAW, command.shader);
+    _calls.back().command = command;
+}
+
+void RRecordingBackend::record(CallType type, uint32_t value)
+{
+    Call call;
+    memset(&call, 0, sizeof(call));
+    call.type = type;
+    call.value = value;
+    _calls.push_back(call);
+    _counts[type]++;
+}
+
+}
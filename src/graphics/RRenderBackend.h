@@ -0,0 +1,147 @@
+#pragma once
+
+#include "RDrawCommand.h"
+
+namespace rocket
+{
+
+/**
+ * Defines the target draw commands are replayed to.
+ *
+ * RCommandQueue::execute() calls the bind functions only when the bound
+ * value changes, then draw() for every command, all from the calling
+ * thread. An OpenGL backend issues the GL calls; RRecordingBackend
+ * records them so that sorting and replay can be tested without a GPU.
+ */
+class API RRenderBackend
+{
+public:
+
+    /**
+     * Destructor.
+     */
+    virtual ~RRenderBackend();
+
+    /**
+     * Starts a pass, called before the first draw of each pass.
+     *
+     * @param pass The pass.
+     */
+    virtual void beginPass(unsigned int pass) = 0;
+
+    /**
+     * Binds a shader.
+     *
+     * @param shader The shader id.
+     */
+    virtual void bindShader(uint32_t shader) = 0;
+
+    /**
+     * Binds a material, called after bindShader() when both change.
+     *
+     * @param material The material id.
+     */
+    virtual void bindMaterial(uint32_t material) = 0;
+
+    /**
+     * Binds a mesh.
+     *
+     * @param mesh The mesh id.
+     */
+    virtual void bindMesh(uint32_t mesh) = 0;
+
+    /**
+     * Draws a command with the bound state.
+     *
+     * @param command The command.
+     */
+    virtual void draw(const RDrawCommand& command) = 0;
+};
+
+/**
+ * Defines a render backend that records the calls made to it.
+ */
+class API RRecordingBackend : public RRenderBackend
+{
+public:
+
+    /**
+     * The recorded functions.
+     */
+    enum CallType
+    {
+        BEGIN_PASS,
+        BIND_SHADER,
+        BIND_MATERIAL,
+        BIND_MESH,
+        DRAW
+    };
+
+    /**
+     * A recorded call.
+     */
+    struct Call
+    {
+        CallType type;
+
+        /**
+         * The pass or id passed to the call, the shader for DRAW.
+         */
+        uint32_t value;
+
+        /**
+         * The command, for DRAW.
+         */
+        RDrawCommand command;
+    };
+
+    /**
+     * Constructor.
+     */
+    RRecordingBackend();
+
+    /**
+     * Destructor.
+     */
+    ~RRecordingBackend();
+
+    /**
+     * Gets the calls recorded since construction or clear().
+     *
+     * @return The calls in order.
+     */
+    const std::vector<Call>& getCalls() const;
+
+    /**
+     * Gets the number of recorded calls of a type.
+     *
+     * @param type The type of call.
+     *
+     * @return The number of calls.
+     */
+    unsigned int getCount(CallType type) const;
+
+    /**
+     * Removes the recorded calls.
+     */
+    void clear();
+
+    void beginPass(unsigned int pass);
+
+    void bindShader(uint32_t shader);
+
+    void bindMaterial(uint32_t material);
+
+    void bindMesh(uint32_t mesh);
+
+    void draw(const RDrawCommand& command);
+
+private:
+
+    void record(CallType type, uint32_t value);
+
+    std::vector<Call> _calls;
+    unsigned int _counts[DRAW + 1];
+};
+
+}
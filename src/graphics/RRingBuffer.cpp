@@ -0,0 +1,137 @@
+#include "common.h"
+#include "RRingBuffer.h"
+
+namespace rocket
+{
+
+const unsigned int RRingBuffer::MAX_FRAMES_IN_FLIGHT;
+
+RRingBuffer::Fences::~Fences()
+{
+}
+
+RRingBuffer::RRingBuffer(void* memory, size_t capacity, Fences* fences, unsigned int framesInFlight)
+    : _memory((uint8_t*)memory), _capacity(memory ? capacity : 0), _fences(fences),
+      _framesInFlight(std::min(std::max(framesInFlight, 1u), MAX_FRAMES_IN_FLIGHT)),
+      _head(0), _tail(0), _firstPending(0), _pendingCount(0), _allocations(0), _failures(0), _waits(0)
+{
+}
+
+RRingBuffer::~RRingBuffer()
+{
+    for (unsigned int i = 0; i < _pendingCount; i++)
+        _fences->release(_pendingFences[(_firstPending + i) % MAX_FRAMES_IN_FLIGHT]);
+}
+
+void RRingBuffer::retire()
+{
+    _fences->release(_pendingFences[_firstPending]);
+    _tail.store(_pendingEnds[_firstPending], std::memory_order_release);
+    _firstPending = (_firstPending + 1) % MAX_FRAMES_IN_FLIGHT;
+    _pendingCount--;
+}
+
+void RRingBuffer::beginFrame()
+{
+    while (_pendingCount > 0 && _fences->isSignaled(_pendingFences[_firstPending]))
+        retire();
+
+    // The current frame is in flight too.
+    while (_pendingCount > 0 && _pendingCount + 1 > _framesInFlight)
+    {
+        _fences->wait(_pendingFences[_firstPending]);
+        _waits++;
+        retire();
+    }
+}
+
+void RRingBuffer::endFrame()
+{
+    uint64_t head = _head.load(std::memory_order_acquire);
+    if (_pendingCount > 0 && _pendingEnds[(_firstPending + _pendingCount - 1) % MAX_FRAMES_IN_FLIGHT] == head)
+        return;
+
+    // Frames that allocated nothing need no fence.
+    if (_pendingCount == 0 && _tail.load(std::memory_order_relaxed) == head)
+        return;
+
+    if (_pendingCount == MAX_FRAMES_IN_FLIGHT)
+    {
+        _fences->wait(_pendingFences[_firstPending]);
+        _waits++;
+        retire();
+    }
+    unsigned int slot = (_firstPending + _pendingCount) % MAX_FRAMES_IN_FLIGHT;
+    _pendingFences[slot] = _fences->insert();
+    _pendingEnds[slot] = head;
+    _pendingCount++;
+}
+
+RRingBuffer::Allocation RRingBuffer::allocate(size_t size, size_t alignment)
+{
+    Allocation allocation = { NULL, 0, size };
+    alignment = std::max<size_t>(alignment, 1);
+    if (size > _capacity || _capacity == 0)
+    {
+        _failures.fetch_add(1, std::memory_order_relaxed);
+        return allocation;
+    }
+
+    uint64_t head = _head.load(std::memory_order_relaxed);
+    while (true)
+    {
+        uint64_t offset = head % _capacity;
+        uint64_t aligned = (offset + alignment - 1) / alignment * alignment;
+        uint64_t start = head + (aligned - offset);
+        if (aligned + size > _capacity)
+        {
+            // Skip the end of the buffer, offset 0 has every alignment.
+            start = head - offset + _capacity;
+            aligned = 0;
+        }
+        uint64_t end = start + size;
+        if (end - _tail.load(std::memory_order_acquire) > _capacity)
+        {
+            _failures.fetch_add(1, std::memory_order_relaxed);
+            return allocation;
+        }
+        if (_head.compare_exchange_weak(head, end, std::memory_order_acq_rel, std::memory_order_relaxed))
+        {
+            allocation.data = _memory + aligned;
+            allocation.offset = (size_t)aligned;
+            _allocations.fetch_add(1, std::memory_order_relaxed);
+            return allocation;
+        }
+    }
+}
+
+size_t RRingBuffer::getCapacity() const
+{
+    return _capacity;
+}
+
+size_t RRingBuffer::getUsedSize() const
+{
+    return (size_t)(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire));
+}
+
+unsigned int RRingBuffer::getFramesInFlight() const
+{
+    return _framesInFlight;
+}
+
+unsigned int RRingBuffer::getPendingFrameCount() const
+{
+    return _pendingCount;
+}
+
+RRingBuffer::Statistics RRingBuffer::getStatistics() const
+{
+    Statistics statistics;
+    statistics.allocations = _allocations.load(std::memory_order_relaxed);
+    statistics.failures = _failures.load(std::memory_order_relaxed);
+    statistics.waits = _waits;
+    return statistics;
+}
+
+}
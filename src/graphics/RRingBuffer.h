@@ -0,0 +1,222 @@
+#pragma once
+
+#include "common.h"
+#include <atomic>
+
+namespace rocket
+{
+
+/**
+ * Defines a ring allocator for per-frame dynamic GPU data (UI, particles,
+ * debug lines, uniforms) in a persistently mapped buffer.
+ *
+ * Allocations are written by the CPU and read by the GPU frames later, so
+ * memory is only reused once the GPU is done with it: endFrame() inserts a
+ * fence after the frame's commands and beginFrame() retires the frames
+ * whose fences have signaled. At most getFramesInFlight() frames use the
+ * ring at once; beginFrame() waits for the oldest fence when the CPU would
+ * get further ahead.
+ *
+ * allocate() is lock-free and may be called from any number of threads
+ * between beginFrame() and endFrame(): it advances the head of the ring
+ * with a compare-and-swap, padding to the requested alignment (the
+ * GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT or GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+ * of the context for UBO and SSBO ranges) and skipping to the start of the
+ * buffer rather than splitting an allocation at its end. When the ring is
+ * full, allocate() fails instead of waiting, so the caller can skip the
+ * data or fall back to a buffer upload.
+ *
+ * The memory and fences are supplied by the caller: an RGLStreamBuffer on
+ * the GPU, or plain memory and a mock in tests.
+ */
+class API RRingBuffer
+{
+public:
+
+    /**
+     * Defines the fences the ring waits on.
+     */
+    class API Fences
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~Fences();
+
+        /**
+         * Inserts a fence after the commands submitted so far.
+         *
+         * @return The fence.
+         */
+        virtual uint64_t insert() = 0;
+
+        /**
+         * Determines whether the GPU has passed a fence, without waiting.
+         *
+         * @param fence The fence.
+         *
+         * @return true if the fence has signaled.
+         */
+        virtual bool isSignaled(uint64_t fence) = 0;
+
+        /**
+         * Waits until the GPU has passed a fence.
+         *
+         * @param fence The fence.
+         */
+        virtual void wait(uint64_t fence) = 0;
+
+        /**
+         * Releases a fence that is no longer waited on.
+         *
+         * @param fence The fence.
+         */
+        virtual void release(uint64_t fence) = 0;
+    };
+
+    /**
+     * A range of the ring.
+     */
+    struct Allocation
+    {
+        /**
+         * The mapped memory to write, NULL if the allocation failed.
+         */
+        uint8_t* data;
+
+        /**
+         * The offset in the buffer, for binding the range.
+         */
+        size_t offset;
+
+        size_t size;
+    };
+
+    /**
+     * The counts of the ring since its creation.
+     */
+    struct Statistics
+    {
+        uint64_t allocations;
+        uint64_t failures;
+
+        /**
+         * The number of times beginFrame() blocked on a fence.
+         */
+        uint64_t waits;
+    };
+
+    /**
+     * The largest number of frames in flight.
+     */
+    static const unsigned int MAX_FRAMES_IN_FLIGHT = 8;
+
+    /**
+     * Constructor.
+     *
+     * @param memory The mapped memory of the buffer.
+     * @param capacity The size of the memory in bytes.
+     * @param fences The fences of the buffer's context.
+     * @param framesInFlight The most frames using the ring at once, 1 to MAX_FRAMES_IN_FLIGHT.
+     */
+    RRingBuffer(void* memory, size_t capacity, Fences* fences, unsigned int framesInFlight = 3);
+
+    /**
+     * Destructor, releases the pending fences without waiting.
+     */
+    ~RRingBuffer();
+
+    /**
+     * Starts a frame: retires the frames the GPU is done with and waits for
+     * the oldest one when getFramesInFlight() frames are pending.
+     *
+     * Must not run concurrently with allocate().
+     */
+    void beginFrame();
+
+    /**
+     * Ends a frame: fences the allocations made since beginFrame().
+     *
+     * Call after submitting the commands that read them. Must not run concurrently with allocate().
+     */
+    void endFrame();
+
+    /**
+     * Allocates a range for the current frame. Thread safe and lock-free.
+     *
+     * @param size The size in bytes.
+     * @param alignment The alignment of the offset.
+     *
+     * @return The range, with a NULL data pointer if the ring is full.
+     */
+    Allocation allocate(size_t size, size_t alignment = 16);
+
+    /**
+     * Gets the size of the ring.
+     *
+     * @return The capacity in bytes.
+     */
+    size_t getCapacity() const;
+
+    /**
+     * Gets the bytes of the ring in use by pending and current frames.
+     *
+     * @return The size in bytes, including alignment padding.
+     */
+    size_t getUsedSize() const;
+
+    /**
+     * Gets the most frames using the ring at once.
+     *
+     * @return The frame count.
+     */
+    unsigned int getFramesInFlight() const;
+
+    /**
+     * Gets the number of ended frames the GPU may still read.
+     *
+     * @return The pending frame count.
+     */
+    unsigned int getPendingFrameCount() const;
+
+    /**
+     * Gets the counts of the ring.
+     *
+     * @return The statistics.
+     */
+    Statistics getStatistics() const;
+
+private:
+
+    RRingBuffer(const RRingBuffer& copy);
+
+    RRingBuffer& operator=(const RRingBuffer&);
+
+    void retire();
+
+    uint8_t* _memory;
+    size_t _capacity;
+    Fences* _fences;
+    unsigned int _framesInFlight;
+
+    /**
+     * The positions only grow: the physical offset is position % capacity.
+     */
+    std::atomic<uint64_t> _head;
+    std::atomic<uint64_t> _tail;
+
+    /**
+     * The fence and end position of each pending frame, oldest first from _firstPending.
+     */
+    uint64_t _pendingFences[MAX_FRAMES_IN_FLIGHT];
+    uint64_t _pendingEnds[MAX_FRAMES_IN_FLIGHT];
+    unsigned int _firstPending;
+    unsigned int _pendingCount;
+    std::atomic<uint64_t> _allocations;
+    std::atomic<uint64_t> _failures;
+    uint64_t _waits;
+};
+
+}
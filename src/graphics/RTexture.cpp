@@ -0,0 +1,169 @@
+#include "common.h"
+#include "RTexture.h"
+#include "RGL.h"
+
+namespace rocket
+{
+
+RTexture::RTexture(Type type, Format format, unsigned int mipCount)
+    : _type(type), _format(format), _mipCount(std::max(mipCount, 1u)), _handle(0)
+{
+}
+
+RTexture::~RTexture()
+{
+}
+
+RTexture::Type RTexture::getType() const
+{
+    return _type;
+}
+
+RTexture::Format RTexture::getFormat() const
+{
+    return _format;
+}
+
+unsigned int RTexture::getMipCount() const
+{
+    return _mipCount;
+}
+
+uint32_t RTexture::getHandle() const
+{
+    return _handle;
+}
+
+void RTexture::setHandle(uint32_t handle)
+{
+    _handle = handle;
+}
+
+unsigned int RTexture::getBlockDimension(Format format)
+{
+    return isCompressed(format) ? 4 : 1;
+}
+
+unsigned int RTexture::getBlockSize(Format format)
+{
+    switch (format)
+    {
+    case FORMAT_R8:
+        return 1;
+    case FORMAT_RG8:
+        return 2;
+    case FORMAT_RGBA8:
+    case FORMAT_RGBA8_SRGB:
+        return 4;
+    case FORMAT_RGBA16F:
+        return 8;
+    case FORMAT_RGBA32F:
+        return 16;
+    case FORMAT_BC1:
+    case FORMAT_BC1_SRGB:
+    case FORMAT_BC4:
+        return 8;
+    case FORMAT_BC3:
+    case FORMAT_BC3_SRGB:
+    case FORMAT_BC5:
+    case FORMAT_BC7:
+    case FORMAT_BC7_SRGB:
+        return 16;
+    }
+    return 0;
+}
+
+bool RTexture::isCompressed(Format format)
+{
+    return format >= FORMAT_BC1;
+}
+
+bool RTexture::isSrgb(Format format)
+{
+    return format == FORMAT_RGBA8_SRGB || format == FORMAT_BC1_SRGB || format == FORMAT_BC3_SRGB || format == FORMAT_BC7_SRGB;
+}
+
+size_t RTexture::getImageSize(Format format, unsigned int width, unsigned int height, unsigned int depth)
+{
+    unsigned int block = getBlockDimension(format);
+    size_t columns = (std::max(width, 1u) + block - 1) / block;
+    size_t rows = (std::max(height, 1u) + block - 1) / block;
+    return columns * rows * std::max(depth, 1u) * getBlockSize(format);
+}
+
+unsigned int RTexture::getFullMipCount(unsigned int width, unsigned int height, unsigned int depth)
+{
+    unsigned int size = std::max(width, std::max(height, depth));
+    unsigned int count = 1;
+    while (size > 1)
+    {
+        size >>= 1;
+        count++;
+    }
+    return count;
+}
+
+void RTexture::getGLFormat(Format format, unsigned int* internalFormat, unsigned int* pixelFormat, unsigned int* pixelType)
+{
+    *pixelType = GL_UNSIGNED_BYTE;
+    switch (format)
+    {
+    case FORMAT_R8:
+        *internalFormat = GL_R8;
+        *pixelFormat = GL_RED;
+        break;
+    case FORMAT_RG8:
+        *internalFormat = GL_RG8;
+        *pixelFormat = GL_RG;
+        break;
+    case FORMAT_RGBA8:
+        *internalFormat = GL_RGBA8;
+        *pixelFormat = GL_RGBA;
+        break;
+    case FORMAT_RGBA8_SRGB:
+        *internalFormat = GL_SRGB8_ALPHA8;
+        *pixelFormat = GL_RGBA;
+        break;
+    case FORMAT_RGBA16F:
+        *internalFormat = GL_RGBA16F;
+        *pixelFormat = GL_RGBA;
+        *pixelType = GL_HALF_FLOAT;
+        break;
+    case FORMAT_RGBA32F:
+        *internalFormat = GL_RGBA32F;
+        *pixelFormat = GL_RGBA;
+        *pixelType = GL_FLOAT;
+        break;
+    case FORMAT_BC1:
+        *internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        break;
+    case FORMAT_BC1_SRGB:
+        *internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+        break;
+    case FORMAT_BC3:
+        *internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        break;
+    case FORMAT_BC3_SRGB:
+        *internalFormat = GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+        break;
+    case FORMAT_BC4:
+        *internalFormat = GL_COMPRESSED_RED_RGTC1;
+        break;
+    case FORMAT_BC5:
+        *internalFormat = GL_COMPRESSED_RG_RGTC2;
+        break;
+    case FORMAT_BC7:
+        *internalFormat = GL_COMPRESSED_RGBA_BPTC_UNORM;
+        break;
+    case FORMAT_BC7_SRGB:
+        *internalFormat = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+        break;
+    }
+    if (isCompressed(format))
+    {
+        *pixelFormat = 0;
+        *pixelType = 0;
+    }
+}
+
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "common.h"
+
+namespace rocket
+{
+
+/**
+ * Defines the base of textures: the pixel format, the mip chain and the GL
+ * texture they are uploaded to.
+ *
+ * The storage of a mip is computed from its format: uncompressed formats
+ * store pixels, block-compressed formats store blocks of 4 x 4 pixels and
+ * round the mip dimensions up to whole blocks.
+ */
+class API RTexture
+{
+public:
+
+    /**
+     * The kind of texture.
+     */
+    enum Type
+    {
+        TYPE_2D,
+        TYPE_3D
+    };
+
+    /**
+     * The pixel format.
+     */
+    enum Format
+    {
+        FORMAT_R8,
+        FORMAT_RG8,
+        FORMAT_RGBA8,
+        FORMAT_RGBA8_SRGB,
+        FORMAT_RGBA16F,
+        FORMAT_RGBA32F,
+        FORMAT_BC1,
+        FORMAT_BC1_SRGB,
+        FORMAT_BC3,
+        FORMAT_BC3_SRGB,
+        FORMAT_BC4,
+        FORMAT_BC5,
+        FORMAT_BC7,
+        FORMAT_BC7_SRGB
+    };
+
+    /**
+     * Destructor.
+     */
+    virtual ~RTexture();
+
+    /**
+     * Gets the kind of texture.
+     *
+     * @return The type.
+     */
+    Type getType() const;
+
+    /**
+     * Gets the pixel format.
+     *
+     * @return The format.
+     */
+    Format getFormat() const;
+
+    /**
+     * Gets the number of mips.
+     *
+     * @return The mip count, at least 1.
+     */
+    unsigned int getMipCount() const;
+
+    /**
+     * Gets the GL texture the texture is uploaded to.
+     *
+     * @return The GL texture name, 0 if none.
+     */
+    uint32_t getHandle() const;
+
+    /**
+     * Sets the GL texture the texture is uploaded to.
+     *
+     * @param handle The GL texture name.
+     */
+    void setHandle(uint32_t handle);
+
+    /**
+     * Gets the width and height of the blocks of a format.
+     *
+     * @param format The format.
+     *
+     * @return 4 for block-compressed formats, otherwise 1.
+     */
+    static unsigned int getBlockDimension(Format format);
+
+    /**
+     * Gets the size of a block of a format.
+     *
+     * @param format The format.
+     *
+     * @return The size of a block, or of a pixel for uncompressed formats, in bytes.
+     */
+    static unsigned int getBlockSize(Format format);
+
+    /**
+     * Determines whether a format is block-compressed.
+     *
+     * @param format The format.
+     *
+     * @return true for the BC formats.
+     */
+    static bool isCompressed(Format format);
+
+    /**
+     * Determines whether a format stores sRGB encoded colors.
+     *
+     * @param format The format.
+     *
+     * @return true for sRGB formats.
+     */
+    static bool isSrgb(Format format);
+
+    /**
+     * Gets the size of an image.
+     *
+     * @param format The format.
+     * @param width The width in pixels.
+     * @param height The height in pixels.
+     * @param depth The depth in pixels.
+     *
+     * @return The size in bytes.
+     */
+    static size_t getImageSize(Format format, unsigned int width, unsigned int height, unsigned int depth = 1);
+
+    /**
+     * Gets the number of mips of a full chain down to 1 x 1 x 1.
+     *
+     * @param width The width in pixels.
+     * @param height The height in pixels.
+     * @param depth The depth in pixels.
+     *
+     * @return The mip count.
+     */
+    static unsigned int getFullMipCount(unsigned int width, unsigned int height, unsigned int depth = 1);
+
+    /**
+     * Gets the arguments of glTexImage2D() or glCompressedTexImage2D() for a format.
+     *
+     * @param format The format.
+     * @param internalFormat Set to the GL internal format.
+     * @param pixelFormat Set to the GL pixel format, 0 for compressed formats.
+     * @param pixelType Set to the GL pixel type, 0 for compressed formats.
+     */
+    static void getGLFormat(Format format, unsigned int* internalFormat, unsigned int* pixelFormat, unsigned int* pixelType);
+
+protected:
+
+    /**
+     * Constructor.
+     *
+     * @param type The kind of texture.
+     * @param format The pixel format.
+     * @param mipCount The number of mips.
+     */
+    RTexture(Type type, Format format, unsigned int mipCount);
+
+private:
+
+    RTexture(const RTexture& copy);
+
+    RTexture& operator=(const RTexture&);
+
+    Type _type;
+    Format _format;
+    unsigned int _mipCount;
+    uint32_t _handle;
+};
+
+}
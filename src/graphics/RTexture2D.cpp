@@ -0,0 +1,189 @@
+#include "common.h"
+#include "RTexture2D.h"
+#include "RBlockCompressor.h"
+#include "RGLStateCache.h"
+#include "RMipGenerator.h"
+
+namespace rocket
+{
+
+RTexture2D::RTexture2D(unsigned int width, unsigned int height, Format format, unsigned int mipCount)
+    : RTexture(TYPE_2D, format, std::min(mipCount == 0 ? getFullMipCount(width, height) : mipCount, getFullMipCount(width, height))),
+      _width(std::max(width, 1u)), _height(std::max(height, 1u)), _residentMip(0), _storageMip(0)
+{
+    _residentMip = getMipCount();
+    _storageMip = getMipCount();
+}
+
+RTexture2D::~RTexture2D()
+{
+}
+
+bool RTexture2D::create(RGLStateCache* cache)
+{
+    if (getHandle() != 0)
+        return false;
+    return setStorageMip(cache, 0);
+}
+
+bool RTexture2D::setStorageMip(RGLStateCache* cache, unsigned int mip)
+{
+    mip = std::min(mip, getMipCount());
+    GLuint previous = getHandle();
+    if (previous != 0 && mip == _storageMip)
+        return true;
+    if (mip == getMipCount())
+    {
+        destroy(cache);
+        return true;
+    }
+    RGLApi* api = cache->getApi();
+    if (previous != 0 && !api->hasCopyImageSubData())
+        return false;
+
+    unsigned int internalFormat, pixelFormat, pixelType;
+    getGLFormat(getFormat(), &internalFormat, &pixelFormat, &pixelType);
+    setHandle(api->genTexture());
+    cache->bindTexture(0, GL_TEXTURE_2D, getHandle());
+    api->texStorage2D(GL_TEXTURE_2D, (GLsizei)(getMipCount() - mip), internalFormat,
+                      (GLsizei)getMipWidth(mip), (GLsizei)getMipHeight(mip));
+    if (previous != 0)
+    {
+        for (unsigned int m = std::max(std::max(_residentMip, _storageMip), mip); m < getMipCount(); m++)
+            api->copyImageSubData(previous, GL_TEXTURE_2D, (GLint)(m - _storageMip), 0, 0, 0,
+                                  getHandle(), GL_TEXTURE_2D, (GLint)(m - mip), 0, 0, 0,
+                                  (GLsizei)getMipWidth(m), (GLsizei)getMipHeight(m), 1);
+        cache->deleteTexture(previous);
+    }
+    _storageMip = mip;
+    _residentMip = std::max(_residentMip, mip);
+    return true;
+}
+
+void RTexture2D::clampToResidentMips(RGLStateCache* cache)
+{
+    if (getHandle() == 0)
+        return;
+    unsigned int levels = getMipCount() - _storageMip;
+    unsigned int base = std::min(std::max(_residentMip, _storageMip) - _storageMip, levels - 1);
+    cache->bindTexture(0, GL_TEXTURE_2D, getHandle());
+    cache->getApi()->texParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, (GLint)base);
+}
+
+void RTexture2D::destroy(RGLStateCache* cache)
+{
+    if (getHandle() == 0)
+        return;
+    cache->deleteTexture(getHandle());
+    setHandle(0);
+    _residentMip = getMipCount();
+    _storageMip = getMipCount();
+}
+
+bool RTexture2D::upload(RGLStateCache* cache, unsigned int mip, const void* data, size_t size)
+{
+    if (getHandle() == 0 || mip < _storageMip || mip >= getMipCount() || size != getMipSize(mip))
+        return false;
+    unsigned int internalFormat, pixelFormat, pixelType;
+    getGLFormat(getFormat(), &internalFormat, &pixelFormat, &pixelType);
+    GLsizei width = (GLsizei)getMipWidth(mip);
+    GLsizei height = (GLsizei)getMipHeight(mip);
+    GLint level = (GLint)(mip - _storageMip);
+    RGLApi* api = cache->getApi();
+    cache->bindTexture(0, GL_TEXTURE_2D, getHandle());
+    if (isCompressed(getFormat()))
+        api->compressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, internalFormat, (GLsizei)size, data);
+    else
+    {
+        api->pixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        api->texSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, pixelFormat, pixelType, data);
+    }
+    _residentMip = std::min(_residentMip, mip);
+    return true;
+}
+
+bool RTexture2D::uploadPixels(RGLStateCache* cache, unsigned int mip, const uint8_t* rgba, const RBlockCompressor* compressor)
+{
+    if (mip >= getMipCount())
+        return false;
+    if (getFormat() == FORMAT_RGBA8 || getFormat() == FORMAT_RGBA8_SRGB)
+        return upload(cache, mip, rgba, getMipSize(mip));
+    if (!isCompressed(getFormat()))
+        return false;
+
+    RBlockCompressor encoder;
+    std::vector<uint8_t> blocks(getMipSize(mip));
+    (compressor ? compressor : &encoder)->compress(getFormat(), rgba, getMipWidth(mip), getMipHeight(mip), blocks.data());
+    return upload(cache, mip, blocks.data(), blocks.size());
+}
+
+bool RTexture2D::uploadChain(RGLStateCache* cache, const uint8_t* rgba, const RMipGenerator* generator, const RBlockCompressor* compressor)
+{
+    RMipGenerator settings = generator ? *generator : RMipGenerator();
+    settings.setSrgb(isSrgb(getFormat()));
+    std::vector<uint8_t> chain(RMipGenerator::getChainSize(_width, _height, 1, getMipCount()));
+    if (!settings.generate(rgba, _width, _height, 1, getMipCount(), chain.data()))
+        return false;
+
+    // Upload coarse to fine so the texture is usable as soon as the first mip lands.
+    size_t offset = chain.size();
+    for (unsigned int mip = getMipCount(); mip-- > 0;)
+    {
+        offset -= (size_t)getMipWidth(mip) * getMipHeight(mip) * 4;
+        if (!uploadPixels(cache, mip, chain.data() + offset, compressor))
+            return false;
+    }
+    return true;
+}
+
+unsigned int RTexture2D::getWidth() const
+{
+    return _width;
+}
+
+unsigned int RTexture2D::getHeight() const
+{
+    return _height;
+}
+
+unsigned int RTexture2D::getMipWidth(unsigned int mip) const
+{
+    return mip < 32 ? std::max(_width >> mip, 1u) : 1;
+}
+
+unsigned int RTexture2D::getMipHeight(unsigned int mip) const
+{
+    return mip < 32 ? std::max(_height >> mip, 1u) : 1;
+}
+
+size_t RTexture2D::getMipSize(unsigned int mip) const
+{
+    if (mip >= getMipCount())
+        return 0;
+    return getImageSize(getFormat(), getMipWidth(mip), getMipHeight(mip));
+}
+
+size_t RTexture2D::getChainSize(unsigned int mip) const
+{
+    size_t size = 0;
+    for (unsigned int m = mip; m < getMipCount(); m++)
+        size += getMipSize(m);
+    return size;
+}
+
+unsigned int RTexture2D::getStorageMip() const
+{
+    return _storageMip;
+}
+
+unsigned int RTexture2D::getResidentMip() const
+{
+    return _residentMip;
+}
+
+void RTexture2D::setResidentMip(unsigned int mip)
+{
+    _residentMip = std::min(mip, getMipCount());
+}
+
+}
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "RTexture.h"
+
+namespace rocket
+{
+
+class RGLStateCache;
+class RBlockCompressor;
+class RMipGenerator;
+
+/**
+ * Defines a 2D texture and the mips of it that are resident on the GPU.
+ *
+ * Mip 0 is the finest level. Residency is a suffix of the chain: when the
+ * resident mip is m, mips m to getMipCount() - 1 are uploaded and finer mips
+ * are not. RTextureStreamer moves the resident mip as the texture is used.
+ *
+ * The GL storage holds a suffix of the chain too, from the storage mip down,
+ * so that streamed textures only take the memory of the mips they need.
+ * create() allocates the full chain; setStorageMip() re-creates the storage
+ * at another mip, keeping the resident mips it holds. GL level 0 is the
+ * storage mip.
+ *
+ * Block-compressed formats are uploaded as they are stored, so their data
+ * stays compressed on the GPU; uploadPixels() encodes RGBA8 pixels first.
+ */
+class API RTexture2D : public RTexture
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param width The width of mip 0 in pixels.
+     * @param height The height of mip 0 in pixels.
+     * @param format The pixel format.
+     * @param mipCount The number of mips, 0 for the full chain.
+     */
+    RTexture2D(unsigned int width, unsigned int height, Format format, unsigned int mipCount = 0);
+
+    /**
+     * Destructor.
+     */
+    ~RTexture2D();
+
+    /**
+     * Creates the GL texture with immutable storage for every mip. The texture
+     * is bound to GL_TEXTURE_2D of texture unit 0 through the cache.
+     *
+     * @param cache The state cache to bind through.
+     *
+     * @return false if the texture was already created.
+     */
+    bool create(RGLStateCache* cache);
+
+    /**
+     * Re-creates the GL storage to hold the mips from a mip to the coarsest,
+     * copying the resident mips both storages hold, or creates it if the
+     * texture is not created. Mips finer than the new storage stop being
+     * resident. The texture is bound like create().
+     *
+     * Re-creating needs glCopyImageSubData(), see RGLApi::hasCopyImageSubData().
+     *
+     * @param cache The state cache to bind through.
+     * @param mip The finest mip of the storage, getMipCount() to delete the texture.
+     *
+     * @return false if the storage cannot be copied.
+     */
+    bool setStorageMip(RGLStateCache* cache, unsigned int mip);
+
+    /**
+     * Sets GL_TEXTURE_BASE_LEVEL to the resident mip, so sampling never reads
+     * mips that were not uploaded. The texture is bound like create().
+     *
+     * @param cache The state cache to bind through.
+     */
+    void clampToResidentMips(RGLStateCache* cache);
+
+    /**
+     * Deletes the GL texture.
+     *
+     * @param cache The state cache to unbind it from.
+     */
+    void destroy(RGLStateCache* cache);
+
+    /**
+     * Uploads a mip in the format of the texture, binding it like create().
+     *
+     * @param cache The state cache to bind through.
+     * @param mip The mip.
+     * @param data The mip data, compressed blocks for block-compressed formats.
+     * @param size The size of the data, getMipSize(mip) bytes.
+     *
+     * @return false if the texture is not created, the mip is outside the storage or the size does not match.
+     */
+    bool upload(RGLStateCache* cache, unsigned int mip, const void* data, size_t size);
+
+    /**
+     * Uploads a mip from RGBA8 pixels, encoding them first when the format is
+     * block-compressed. Other formats must be RGBA8 or RGBA8 sRGB.
+     *
+     * @param cache The state cache to bind through.
+     * @param mip The mip.
+     * @param rgba The pixels, getMipWidth(mip) * getMipHeight(mip) * 4 bytes.
+     * @param compressor The encoder, NULL for one of normal quality.
+     *
+     * @return false if the upload fails or the format cannot be converted.
+     */
+    bool uploadPixels(RGLStateCache* cache, unsigned int mip, const uint8_t* rgba, const RBlockCompressor* compressor = NULL);
+
+    /**
+     * Generates every mip from the RGBA8 pixels of mip 0 and uploads them
+     * with uploadPixels(). sRGB formats are filtered in linear space whatever
+     * the generator is set to.
+     *
+     * @param cache The state cache to bind through.
+     * @param rgba The pixels of mip 0, getWidth() * getHeight() * 4 bytes.
+     * @param generator The mip generator, NULL for a box filter.
+     * @param compressor The encoder, NULL for one of normal quality.
+     *
+     * @return false if an upload fails or the format cannot be converted.
+     */
+    bool uploadChain(RGLStateCache* cache, const uint8_t* rgba, const RMipGenerator* generator = NULL,
+                     const RBlockCompressor* compressor = NULL);
+
+    /**
+     * Gets the width of mip 0.
+     *
+     * @return The width in pixels.
+     */
+    unsigned int getWidth() const;
+
+    /**
+     * Gets the height of mip 0.
+     *
+     * @return The height in pixels.
+     */
+    unsigned int getHeight() const;
+
+    /**
+     * Gets the width of a mip.
+     *
+     * @param mip The mip.
+     *
+     * @return The width in pixels, at least 1.
+     */
+    unsigned int getMipWidth(unsigned int mip) const;
+
+    /**
+     * Gets the height of a mip.
+     *
+     * @param mip The mip.
+     *
+     * @return The height in pixels, at least 1.
+     */
+    unsigned int getMipHeight(unsigned int mip) const;
+
+    /**
+     * Gets the storage size of a mip.
+     *
+     * @param mip The mip.
+     *
+     * @return The size in bytes.
+     */
+    size_t getMipSize(unsigned int mip) const;
+
+    /**
+     * Gets the storage size of the chain from a mip to the coarsest mip.
+     *
+     * @param mip The finest mip of the chain, getMipCount() for an empty chain.
+     *
+     * @return The size in bytes.
+     */
+    size_t getChainSize(unsigned int mip) const;
+
+    /**
+     * Gets the finest mip the GL storage holds.
+     *
+     * @return The mip, getMipCount() if the texture is not created.
+     */
+    unsigned int getStorageMip() const;
+
+    /**
+     * Gets the finest mip resident on the GPU.
+     *
+     * @return The mip, getMipCount() if no mip is resident.
+     */
+    unsigned int getResidentMip() const;
+
+    /**
+     * Sets the finest mip resident on the GPU. Only the bookkeeping changes,
+     * clampToResidentMips() applies it to sampling.
+     *
+     * @param mip The mip, getMipCount() if no mip is resident.
+     */
+    void setResidentMip(unsigned int mip);
+
+private:
+
+    RTexture2D(const RTexture2D& copy);
+
+    RTexture2D& operator=(const RTexture2D&);
+
+    unsigned int _width;
+    unsigned int _height;
+    unsigned int _residentMip;
+    unsigned int _storageMip;
+};
+
+}
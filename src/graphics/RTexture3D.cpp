@@ -0,0 +1,145 @@
+#include "common.h"
+#include "RTexture3D.h"
+#include "RGLStateCache.h"
+#include "RMipGenerator.h"
+
+namespace rocket
+{
+
+RTexture3D::RTexture3D(unsigned int width, unsigned int height, unsigned int depth, Format format, unsigned int mipCount)
+    : RTexture(TYPE_3D, format, std::min(mipCount == 0 ? getFullMipCount(width, height, depth) : mipCount, getFullMipCount(width, height, depth))),
+      _width(std::max(width, 1u)), _height(std::max(height, 1u)), _depth(std::max(depth, 1u))
+{
+}
+
+RTexture3D::~RTexture3D()
+{
+}
+
+bool RTexture3D::create(RGLStateCache* cache)
+{
+    if (getHandle() != 0)
+        return false;
+    unsigned int internalFormat, pixelFormat, pixelType;
+    getGLFormat(getFormat(), &internalFormat, &pixelFormat, &pixelType);
+    RGLApi* api = cache->getApi();
+    setHandle(api->genTexture());
+    cache->bindTexture(0, GL_TEXTURE_3D, getHandle());
+    api->texStorage3D(GL_TEXTURE_3D, (GLsizei)getMipCount(), internalFormat, (GLsizei)_width, (GLsizei)_height, (GLsizei)_depth);
+    return true;
+}
+
+void RTexture3D::destroy(RGLStateCache* cache)
+{
+    if (getHandle() == 0)
+        return;
+    cache->deleteTexture(getHandle());
+    setHandle(0);
+}
+
+bool RTexture3D::upload(RGLStateCache* cache, unsigned int mip, const void* data, size_t size)
+{
+    if (getHandle() == 0 || mip >= getMipCount() || size != getMipSize(mip))
+        return false;
+    unsigned int internalFormat, pixelFormat, pixelType;
+    getGLFormat(getFormat(), &internalFormat, &pixelFormat, &pixelType);
+    GLsizei width = (GLsizei)getMipWidth(mip);
+    GLsizei height = (GLsizei)getMipHeight(mip);
+    GLsizei depth = (GLsizei)getMipDepth(mip);
+    RGLApi* api = cache->getApi();
+    cache->bindTexture(0, GL_TEXTURE_3D, getHandle());
+    if (isCompressed(getFormat()))
+        api->compressedTexSubImage3D(GL_TEXTURE_3D, (GLint)mip, 0, 0, 0, width, height, depth, internalFormat, (GLsizei)size, data);
+    else
+    {
+        api->pixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        api->texSubImage3D(GL_TEXTURE_3D, (GLint)mip, 0, 0, 0, width, height, depth, pixelFormat, pixelType, data);
+    }
+    return true;
+}
+
+bool RTexture3D::uploadRegion(RGLStateCache* cache, unsigned int mip, unsigned int x, unsigned int y, unsigned int z,
+                              unsigned int width, unsigned int height, unsigned int depth, const void* data)
+{
+    if (getHandle() == 0 || mip >= getMipCount() || isCompressed(getFormat()))
+        return false;
+    if (x > getMipWidth(mip) || width > getMipWidth(mip) - x || y > getMipHeight(mip) || height > getMipHeight(mip) - y ||
+        z > getMipDepth(mip) || depth > getMipDepth(mip) - z)
+        return false;
+    unsigned int internalFormat, pixelFormat, pixelType;
+    getGLFormat(getFormat(), &internalFormat, &pixelFormat, &pixelType);
+    RGLApi* api = cache->getApi();
+    cache->bindTexture(0, GL_TEXTURE_3D, getHandle());
+    api->pixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    api->texSubImage3D(GL_TEXTURE_3D, (GLint)mip, (GLint)x, (GLint)y, (GLint)z, (GLsizei)width, (GLsizei)height,
+                       (GLsizei)depth, pixelFormat, pixelType, data);
+    return true;
+}
+
+bool RTexture3D::uploadChain(RGLStateCache* cache, const uint8_t* rgba, const RMipGenerator* generator)
+{
+    if (getFormat() != FORMAT_RGBA8 && getFormat() != FORMAT_RGBA8_SRGB)
+        return false;
+    RMipGenerator settings = generator ? *generator : RMipGenerator();
+    settings.setSrgb(isSrgb(getFormat()));
+    std::vector<uint8_t> chain(RMipGenerator::getChainSize(_width, _height, _depth, getMipCount()));
+    if (!settings.generate(rgba, _width, _height, _depth, getMipCount(), chain.data()))
+        return false;
+
+    // Upload coarse to fine so the texture is usable as soon as the first mip lands.
+    size_t offset = chain.size();
+    for (unsigned int mip = getMipCount(); mip-- > 0;)
+    {
+        offset -= getMipSize(mip);
+        if (!upload(cache, mip, chain.data() + offset, getMipSize(mip)))
+            return false;
+    }
+    return true;
+}
+
+unsigned int RTexture3D::getWidth() const
+{
+    return _width;
+}
+
+unsigned int RTexture3D::getHeight() const
+{
+    return _height;
+}
+
+unsigned int RTexture3D::getDepth() const
+{
+    return _depth;
+}
+
+unsigned int RTexture3D::getMipWidth(unsigned int mip) const
+{
+    return mip < 32 ? std::max(_width >> mip, 1u) : 1;
+}
+
+unsigned int RTexture3D::getMipHeight(unsigned int mip) const
+{
+    return mip < 32 ? std::max(_height >> mip, 1u) : 1;
+}
+
+unsigned int RTexture3D::getMipDepth(unsigned int mip) const
+{
+    return mip < 32 ? std::max(_depth >> mip, 1u) : 1;
+}
+
+size_t RTexture3D::getMipSize(unsigned int mip) const
+{
+    if (mip >= getMipCount())
+        return 0;
+    return getImageSize(getFormat(), getMipWidth(mip), getMipHeight(mip), getMipDepth(mip));
+}
+
+size_t RTexture3D::getChainSize(unsigned int mip) const
+{
+    size_t size = 0;
+    for (unsigned int m = mip; m < getMipCount(); m++)
+        size += getMipSize(m);
+    return size;
+}
+
+}
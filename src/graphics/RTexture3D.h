@@ -0,0 +1,173 @@
+#pragma once
+
+#include "RTexture.h"
+
+namespace rocket
+{
+
+class RGLStateCache;
+class RMipGenerator;
+
+/**
+ * Defines a 3D texture, a stack of depth slices with a mip chain that halves
+ * the width, height and depth of each mip.
+ */
+class API RTexture3D : public RTexture
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param width The width of mip 0 in pixels.
+     * @param height The height of mip 0 in pixels.
+     * @param depth The depth of mip 0 in slices.
+     * @param format The pixel format.
+     * @param mipCount The number of mips, 0 for the full chain.
+     */
+    RTexture3D(unsigned int width, unsigned int height, unsigned int depth, Format format, unsigned int mipCount = 0);
+
+    /**
+     * Destructor.
+     */
+    ~RTexture3D();
+
+    /**
+     * Creates the GL texture with immutable storage for every mip. The texture
+     * is bound to GL_TEXTURE_3D of texture unit 0 through the cache.
+     *
+     * @param cache The state cache to bind through.
+     *
+     * @return false if the texture was already created.
+     */
+    bool create(RGLStateCache* cache);
+
+    /**
+     * Deletes the GL texture.
+     *
+     * @param cache The state cache to unbind it from.
+     */
+    void destroy(RGLStateCache* cache);
+
+    /**
+     * Uploads a mip in the format of the texture, binding it like create().
+     *
+     * @param cache The state cache to bind through.
+     * @param mip The mip.
+     * @param data The mip data, slices of compressed blocks for block-compressed formats.
+     * @param size The size of the data, getMipSize(mip) bytes.
+     *
+     * @return false if the texture is not created, or the mip or size do not match.
+     */
+    bool upload(RGLStateCache* cache, unsigned int mip, const void* data, size_t size);
+
+    /**
+     * Uploads a box of pixels to a mip of an uncompressed texture, binding it
+     * like create().
+     *
+     * @param cache The state cache to bind through.
+     * @param mip The mip.
+     * @param x The first column of the box.
+     * @param y The first row of the box.
+     * @param z The first slice of the box.
+     * @param width The width of the box in pixels.
+     * @param height The height of the box in pixels.
+     * @param depth The depth of the box in slices.
+     * @param data The pixels of the box, rows then slices, tightly packed.
+     *
+     * @return false if the texture is not created, is compressed or the box is outside the mip.
+     */
+    bool uploadRegion(RGLStateCache* cache, unsigned int mip, unsigned int x, unsigned int y, unsigned int z,
+                      unsigned int width, unsigned int height, unsigned int depth, const void* data);
+
+    /**
+     * Generates every mip from the RGBA8 pixels of mip 0 and uploads them
+     * with upload(), coarsest first. The format must be RGBA8 or RGBA8 sRGB;
+     * sRGB formats are filtered in linear space whatever the generator is set to.
+     *
+     * @param cache The state cache to bind through.
+     * @param rgba The pixels of mip 0 in rows and then slices, getWidth() * getHeight() * getDepth() * 4 bytes.
+     * @param generator The mip generator, NULL for a box filter.
+     *
+     * @return false if an upload fails or the format is not RGBA8.
+     */
+    bool uploadChain(RGLStateCache* cache, const uint8_t* rgba, const RMipGenerator* generator = NULL);
+
+    /**
+     * Gets the width of mip 0.
+     *
+     * @return The width in pixels.
+     */
+    unsigned int getWidth() const;
+
+    /**
+     * Gets the height of mip 0.
+     *
+     * @return The height in pixels.
+     */
+    unsigned int getHeight() const;
+
+    /**
+     * Gets the depth of mip 0.
+     *
+     * @return The depth in slices.
+     */
+    unsigned int getDepth() const;
+
+    /**
+     * Gets the width of a mip.
+     *
+     * @param mip The mip.
+     *
+     * @return The width in pixels, at least 1.
+     */
+    unsigned int getMipWidth(unsigned int mip) const;
+
+    /**
+     * Gets the height of a mip.
+     *
+     * @param mip The mip.
+     *
+     * @return The height in pixels, at least 1.
+     */
+    unsigned int getMipHeight(unsigned int mip) const;
+
+    /**
+     * Gets the depth of a mip.
+     *
+     * @param mip The mip.
+     *
+     * @return The depth in slices, at least 1.
+     */
+    unsigned int getMipDepth(unsigned int mip) const;
+
+    /**
+     * Gets the storage size of a mip.
+     *
+     * @param mip The mip.
+     *
+     * @return The size in bytes.
+     */
+    size_t getMipSize(unsigned int mip) const;
+
+    /**
+     * Gets the storage size of the chain from a mip to the coarsest mip.
+     *
+     * @param mip The finest mip of the chain, getMipCount() for an empty chain.
+     *
+     * @return The size in bytes.
+     */
+    size_t getChainSize(unsigned int mip) const;
+
+private:
+
+    RTexture3D(const RTexture3D& copy);
+
+    RTexture3D& operator=(const RTexture3D&);
+
+    unsigned int _width;
+    unsigned int _height;
+    unsigned int _depth;
+};
+
+}
@@ -0,0 +1,400 @@
+#include "common.h"
+#include "RTextureFile.h"
+#include "RTexture2D.h"
+#include "RTexture3D.h"
+
+namespace rocket
+{
+
+// The alignment of the mip data (see RFileMapping).
+#define TEXTURE_FILE_MIP_ALIGNMENT  64
+// The alignment of the level table.
+#define TEXTURE_FILE_TABLE_ALIGNMENT 16
+// The LZ codec: the shortest match, the farthest match and the size of the match finder's hash table.
+#define TEXTURE_FILE_MIN_MATCH      4
+#define TEXTURE_FILE_MAX_OFFSET     65535
+#define TEXTURE_FILE_HASH_BITS      14
+
+static inline uint32_t readWord(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+/**
+ * Writes a length of the LZ codec past the 15 its token nibble holds.
+ */
+static inline void writeLength(size_t length, std::vector<uint8_t>* dst)
+{
+    if (length < 15)
+        return;
+    length -= 15;
+    for (; length >= 255; length -= 255)
+        dst->push_back(255);
+    dst->push_back((uint8_t)length);
+}
+
+static inline bool readLength(const uint8_t* src, size_t size, size_t* in, size_t* length)
+{
+    if (*length < 15)
+        return true;
+    uint8_t byte;
+    do
+    {
+        if (*in >= size)
+            return false;
+        byte = src[(*in)++];
+        *length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+/**
+ * Writes a sequence of the LZ codec: a token holding the literal count and
+ * the match length, the literals, then the match offset. The last sequence
+ * of a stream has literals only.
+ */
+static void writeSequence(const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength,
+                          std::vector<uint8_t>* dst)
+{
+    size_t matchCode = matchLength ? matchLength - TEXTURE_FILE_MIN_MATCH : 0;
+    dst->push_back((uint8_t)((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+    writeLength(literalCount, dst);
+    dst->insert(dst->end(), literals, literals + literalCount);
+    if (matchLength == 0)
+        return;
+    dst->push_back((uint8_t)(offset & 0xff));
+    dst->push_back((uint8_t)(offset >> 8));
+    writeLength(matchCode, dst);
+}
+
+/**
+ * Compresses data with a greedy LZ77 match finder over a hash of the next four bytes.
+ */
+static void compressLZ(const uint8_t* src, size_t size, std::vector<uint8_t>* dst)
+{
+    dst->clear();
+    // Positions plus one, 0 for an empty slot.
+    std::vector<size_t> table((size_t)1 << TEXTURE_FILE_HASH_BITS, 0);
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (pos + TEXTURE_FILE_MIN_MATCH <= size)
+    {
+        uint32_t word = readWord(src + pos);
+        uint32_t hash = (word * 2654435761u) >> (32 - TEXTURE_FILE_HASH_BITS);
+        size_t candidate = table[hash];
+        table[hash] = pos + 1;
+        if (candidate == 0 || pos - (candidate - 1) > TEXTURE_FILE_MAX_OFFSET || readWord(src + candidate - 1) != word)
+        {
+            pos++;
+            continue;
+        }
+
+        size_t match = candidate - 1;
+        size_t length = TEXTURE_FILE_MIN_MATCH;
+        while (pos + length < size && src[match + length] == src[pos + length])
+            length++;
+        writeSequence(src + anchor, pos - anchor, pos - match, length, dst);
+        pos += length;
+        anchor = pos;
+    }
+    writeSequence(src + anchor, size - anchor, 0, 0, dst);
+}
+
+static bool decompressLZ(const uint8_t* src, size_t size, uint8_t* dst, size_t dstSize)
+{
+    size_t in = 0;
+    size_t out = 0;
+    while (in < size)
+    {
+        uint8_t token = src[in++];
+        size_t literalCount = token >> 4;
+        if (!readLength(src, size, &in, &literalCount) || literalCount > size - in || literalCount > dstSize - out)
+            return false;
+        memcpy(dst + out, src + in, literalCount);
+        in += literalCount;
+        out += literalCount;
+        if (out == dstSize)
+            return in == size;
+
+        if (size - in < 2)
+            return false;
+        size_t offset = (size_t)src[in] | ((size_t)src[in + 1] << 8);
+        in += 2;
+        size_t length = token & 15;
+        if (!readLength(src, size, &in, &length))
+            return false;
+        length += TEXTURE_FILE_MIN_MATCH;
+        if (offset == 0 || offset > out || length > dstSize - out)
+            return false;
+        // Overlapping matches repeat the last offset bytes: copy them, then
+        // the doubled pattern, and so on, each copy disjoint from its source.
+        for (size_t copied = 0, distance = offset; copied < length; distance = copied + offset)
+        {
+            size_t count = std::min(distance, length - copied);
+            memcpy(dst + out + copied, dst + out + copied - distance, count);
+            copied += count;
+        }
+        out += length;
+    }
+    return out == dstSize;
+}
+
+/**
+ * Gets the size of a mip of a texture described by a header.
+ */
+static size_t getMipSize(const RTextureFile::Header* header, unsigned int mip)
+{
+    return RTexture::getImageSize((RTexture::Format)header->format, std::max(header->width >> mip, 1u),
+                                  std::max(header->height >> mip, 1u), std::max(header->depth >> mip, 1u));
+}
+
+/**
+ * Uploads the available mips of a file to a texture of its size, coarsest first.
+ */
+template <typename T>
+static bool uploadMips(const RTextureFile& file, RGLStateCache* cache, T* texture)
+{
+    // The coarsest mips come first in the file, stop at the first one not read yet.
+    std::vector<uint8_t> scratch;
+    for (unsigned int mip = file.getHeader()->mipCount; mip-- > 0 && file.isMipAvailable(mip);)
+    {
+        const RTextureFile::Level& level = file.getLevel(mip);
+        const uint8_t* data = file.getMipData(mip);
+        if (level.supercompression != RTextureFile::SUPERCOMPRESSION_NONE)
+        {
+            scratch.resize((size_t)level.uncompressedSize);
+            if (!file.readMip(mip, scratch.data(), scratch.size()))
+                return false;
+            data = scratch.data();
+        }
+        if (!texture->upload(cache, mip, data, (size_t)level.uncompressedSize))
+            return false;
+    }
+    return true;
+}
+
+const uint32_t RTextureFile::MAGIC;
+const uint32_t RTextureFile::VERSION;
+
+RTextureFile::RTextureFile()
+    : _data(NULL), _size(0)
+{
+}
+
+RTextureFile::~RTextureFile()
+{
+    close();
+}
+
+bool RTextureFile::open(const char* path)
+{
+    close();
+    RFileMapping mapping;
+    if (!mapping.open(path))
+        return false;
+    if (!openMemory(mapping.getData(), mapping.getSize()) || !isComplete())
+    {
+        close();
+        return false;
+    }
+    _mapping.swap(mapping);
+    return true;
+}
+
+bool RTextureFile::openMemory(const void* data, size_t size)
+{
+    close();
+    const Header* header = (const Header*)data;
+    if (!data || size < sizeof(Header) || header->magic != MAGIC || header->version != VERSION)
+        return false;
+
+    if (header->type > RTexture::TYPE_3D || header->format > RTexture::FORMAT_BC7_SRGB ||
+        header->width == 0 || header->height == 0 || header->depth == 0 ||
+        (header->type == RTexture::TYPE_2D && header->depth != 1) || header->mipCount == 0 ||
+        header->mipCount > RTexture::getFullMipCount(header->width, header->height, header->depth))
+        return false;
+
+    // The levels must be present, the mips must fit in the file.
+    uint64_t fileSize = header->fileSize;
+    uint64_t available = std::min<uint64_t>(size, fileSize);
+    if (!RFileMapping::isInRange(header->levelOffset, (uint64_t)header->mipCount * sizeof(Level), available))
+        return false;
+    const uint8_t* bytes = (const uint8_t*)data;
+    const Level* levels = (const Level*)(bytes + header->levelOffset);
+    for (uint32_t mip = 0; mip < header->mipCount; mip++)
+    {
+        const Level& level = levels[mip];
+        if (!RFileMapping::isInRange(level.offset, level.size, fileSize) || level.uncompressedSize != getMipSize(header, mip) ||
+            level.supercompression > SUPERCOMPRESSION_LZ ||
+            (level.supercompression == SUPERCOMPRESSION_NONE && level.size != level.uncompressedSize))
+            return false;
+    }
+
+    _data = bytes;
+    _size = (size_t)available;
+    return true;
+}
+
+void RTextureFile::close()
+{
+    _mapping.close();
+    _data = NULL;
+    _size = 0;
+}
+
+bool RTextureFile::isComplete() const
+{
+    return _data && _size == getHeader()->fileSize;
+}
+
+bool RTextureFile::verify() const
+{
+    if (!isComplete())
+        return false;
+    return RFileMapping::computeChecksum(_data + sizeof(Header), _size - sizeof(Header)) == getHeader()->checksum;
+}
+
+const RTextureFile::Header* RTextureFile::getHeader() const
+{
+    return (const Header*)_data;
+}
+
+const RTextureFile::Level& RTextureFile::getLevel(unsigned int mip) const
+{
+    return ((const Level*)(_data + getHeader()->levelOffset))[mip];
+}
+
+bool RTextureFile::isMipAvailable(unsigned int mip) const
+{
+    if (!_data || mip >= getHeader()->mipCount)
+        return false;
+    const Level& level = getLevel(mip);
+    return level.offset + level.size <= _size;
+}
+
+const uint8_t* RTextureFile::getMipData(unsigned int mip) const
+{
+    return isMipAvailable(mip) ? _data + getLevel(mip).offset : NULL;
+}
+
+bool RTextureFile::readMip(unsigned int mip, uint8_t* dst, size_t size) const
+{
+    if (!isMipAvailable(mip))
+        return false;
+    const Level& level = getLevel(mip);
+    if (size != level.uncompressedSize)
+        return false;
+    if (level.supercompression == SUPERCOMPRESSION_NONE)
+    {
+        memcpy(dst, _data + level.offset, size);
+        return true;
+    }
+    return decompressLZ(_data + level.offset, (size_t)level.size, dst, size);
+}
+
+RTexture2D* RTextureFile::createTexture2D() const
+{
+    const Header* header = getHeader();
+    if (!header || header->type != RTexture::TYPE_2D)
+        return NULL;
+    return new RTexture2D(header->width, header->height, (RTexture::Format)header->format, header->mipCount);
+}
+
+RTexture3D* RTextureFile::createTexture3D() const
+{
+    const Header* header = getHeader();
+    if (!header || header->type != RTexture::TYPE_3D)
+        return NULL;
+    return new RTexture3D(header->width, header->height, header->depth, (RTexture::Format)header->format, header->mipCount);
+}
+
+bool RTextureFile::matches(const RTexture2D* texture) const
+{
+    const Header* header = getHeader();
+    return header && header->type == RTexture::TYPE_2D && texture->getWidth() == header->width &&
+           texture->getHeight() == header->height && texture->getFormat() == (RTexture::Format)header->format &&
+           texture->getMipCount() == header->mipCount;
+}
+
+bool RTextureFile::upload(RGLStateCache* cache, RTexture2D* texture) const
+{
+    if (!matches(texture))
+        return false;
+    return uploadMips(*this, cache, texture);
+}
+
+bool RTextureFile::upload(RGLStateCache* cache, RTexture3D* texture) const
+{
+    const Header* header = getHeader();
+    if (!header || header->type != RTexture::TYPE_3D || texture->getWidth() != header->width ||
+        texture->getHeight() != header->height || texture->getDepth() != header->depth ||
+        texture->getFormat() != (RTexture::Format)header->format || texture->getMipCount() != header->mipCount)
+        return false;
+    return uploadMips(*this, cache, texture);
+}
+
+bool RTextureFile::write(RTexture::Type type, RTexture::Format format, unsigned int width, unsigned int height,
+                         unsigned int depth, unsigned int mipCount, const uint8_t* chain, bool supercompress,
+                         std::vector<uint8_t>* dst)
+{
+    if (width == 0 || height == 0 || depth == 0 || (type == RTexture::TYPE_2D && depth != 1) ||
+        mipCount == 0 || mipCount > RTexture::getFullMipCount(width, height, depth))
+        return false;
+
+    Header header;
+    memset(&header, 0, sizeof(header));
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.type = type;
+    header.format = format;
+    header.width = width;
+    header.height = height;
+    header.depth = depth;
+    header.mipCount = mipCount;
+    header.levelOffset = RFileMapping::alignOffset(sizeof(Header), TEXTURE_FILE_TABLE_ALIGNMENT);
+
+    std::vector<Level> levels(mipCount);
+    std::vector<size_t> chainOffsets(mipCount);
+    size_t chainOffset = 0;
+    for (unsigned int mip = 0; mip < mipCount; mip++)
+    {
+        memset(&levels[mip], 0, sizeof(Level));
+        levels[mip].uncompressedSize = getMipSize(&header, mip);
+        chainOffsets[mip] = chainOffset;
+        chainOffset += (size_t)levels[mip].uncompressedSize;
+    }
+
+    // The smallest mip first, so that any prefix of the file holds the coarsest mips.
+    dst->assign((size_t)RFileMapping::alignOffset(header.levelOffset + mipCount * sizeof(Level), TEXTURE_FILE_MIP_ALIGNMENT), 0);
+    std::vector<uint8_t> compressed;
+    for (unsigned int mip = mipCount; mip-- > 0;)
+    {
+        Level& level = levels[mip];
+        const uint8_t* data = chain + chainOffsets[mip];
+        level.size = level.uncompressedSize;
+        level.supercompression = SUPERCOMPRESSION_NONE;
+        if (supercompress)
+        {
+            compressLZ(data, (size_t)level.uncompressedSize, &compressed);
+            if (compressed.size() < level.uncompressedSize)
+            {
+                data = compressed.data();
+                level.size = compressed.size();
+                level.supercompression = SUPERCOMPRESSION_LZ;
+            }
+        }
+        level.offset = RFileMapping::alignOffset(dst->size(), TEXTURE_FILE_MIP_ALIGNMENT);
+        dst->resize((size_t)level.offset);
+        dst->insert(dst->end(), data, data + level.size);
+    }
+
+    header.fileSize = dst->size();
+    memcpy(dst->data() + header.levelOffset, levels.data(), mipCount * sizeof(Level));
+    header.checksum = RFileMapping::computeChecksum(dst->data() + sizeof(Header), dst->size() - sizeof(Header));
+    memcpy(dst->data(), &header, sizeof(Header));
+    return true;
+}
+
+}
@@ -0,0 +1,288 @@
+#pragma once
+
+#include "RTexture.h"
+#include "utilities/FileMapping.h"
+
+namespace rocket
+{
+
+class RGLStateCache;
+class RTexture2D;
+class RTexture3D;
+
+/**
+ * Defines the binary texture asset format and its loader, a layout in the
+ * spirit of KTX2.
+ *
+ * A texture file is a header, a table with one level per mip (mip 0 first)
+ * and the mip data, all little endian. The data is stored smallest mip
+ * first, each mip aligned to 64 bytes, so every mip needs a prefix of the
+ * file: a loader reading the file sequentially can openMemory() what it has
+ * read so far and upload the coarsest mips as soon as isMipAvailable().
+ *
+ * Each mip is stored in the format the GPU samples (pixels or compressed
+ * blocks, slices after one another for 3D textures), optionally
+ * supercompressed with a byte-oriented LZ codec that decodes far faster
+ * than deflate. write() keeps the supercompressed data of a mip only if it is
+ * smaller, so incompressible mips cost nothing to read.
+ *
+ * Loading is mapping the file (open()) and checking the header and levels.
+ * readMip() copies or decodes a mip from the mapping straight into a
+ * staging buffer, such as a mapped RRingBuffer range or the buffer an
+ * RTextureStreamer::Backend reads into (RTextureFileBackend streams textures
+ * from files this way), and getMipData() exposes the mip
+ * without copying. verify() checks the CRC-32 of everything after the
+ * header, for assets from untrusted storage.
+ */
+class API RTextureFile
+{
+public:
+
+    /**
+     * The first four bytes of a texture file, "RTEX".
+     */
+    static const uint32_t MAGIC = 0x58455452;
+
+    /**
+     * The version of the format.
+     */
+    static const uint32_t VERSION = 1;
+
+    /**
+     * How a mip is stored.
+     */
+    enum Supercompression
+    {
+        SUPERCOMPRESSION_NONE,
+        SUPERCOMPRESSION_LZ
+    };
+
+    /**
+     * The header at the start of the file.
+     */
+    struct Header
+    {
+        uint32_t magic;
+        uint32_t version;
+
+        /**
+         * The RTexture::Type.
+         */
+        uint32_t type;
+
+        /**
+         * The RTexture::Format.
+         */
+        uint32_t format;
+
+        uint32_t width;
+        uint32_t height;
+        uint32_t depth;
+        uint32_t mipCount;
+
+        /**
+         * The CRC-32 of the bytes after the header.
+         */
+        uint32_t checksum;
+
+        uint32_t reserved;
+        uint64_t fileSize;
+        uint64_t levelOffset;
+    };
+
+    /**
+     * The storage of a mip.
+     */
+    struct Level
+    {
+        uint64_t offset;
+
+        /**
+         * The size of the stored data.
+         */
+        uint64_t size;
+
+        /**
+         * The size of the mip once decoded, RTexture::getImageSize() of the mip.
+         */
+        uint64_t uncompressedSize;
+
+        /**
+         * The Supercompression of the data.
+         */
+        uint32_t supercompression;
+
+        uint32_t reserved;
+    };
+
+    /**
+     * Constructs a closed file.
+     */
+    RTextureFile();
+
+    /**
+     * Destructor, closes the file.
+     */
+    ~RTextureFile();
+
+    /**
+     * Maps a texture file into memory.
+     *
+     * @param path The path of the file.
+     *
+     * @return false if the file cannot be mapped or is not a complete texture file.
+     */
+    bool open(const char* path);
+
+    /**
+     * Opens a texture file in memory, which must outlive the RTextureFile.
+     *
+     * The data may be a prefix of the file holding at least the header and
+     * the levels, while it is streamed in.
+     *
+     * @param data The file data.
+     * @param size The size of the data in bytes.
+     *
+     * @return false if the data is not a texture file or misses the levels.
+     */
+    bool openMemory(const void* data, size_t size);
+
+    /**
+     * Closes the file, unmapping it.
+     */
+    void close();
+
+    /**
+     * Determines whether the whole file is available.
+     *
+     * @return true if the file is open and complete.
+     */
+    bool isComplete() const;
+
+    /**
+     * Checks the checksum of the file.
+     *
+     * @return true if the file is complete and its checksum matches.
+     */
+    bool verify() const;
+
+    /**
+     * Gets the header of the open file.
+     *
+     * @return The header, NULL if the file is closed.
+     */
+    const Header* getHeader() const;
+
+    /**
+     * Gets the storage of a mip.
+     *
+     * @param mip The mip, less than getHeader()->mipCount.
+     *
+     * @return The level.
+     */
+    const Level& getLevel(unsigned int mip) const;
+
+    /**
+     * Determines whether the data of a mip is available.
+     *
+     * @param mip The mip.
+     *
+     * @return true if the open data holds the mip.
+     */
+    bool isMipAvailable(unsigned int mip) const;
+
+    /**
+     * Gets the stored data of a mip, without copying it.
+     *
+     * @param mip The mip.
+     *
+     * @return getLevel(mip).size bytes, supercompressed as the level says, or
+     *      NULL if the mip is not available.
+     */
+    const uint8_t* getMipData(unsigned int mip) const;
+
+    /**
+     * Copies or decodes a mip into a buffer.
+     *
+     * @param mip The mip.
+     * @param dst The buffer.
+     * @param size The size of the buffer, getLevel(mip).uncompressedSize bytes.
+     *
+     * @return false if the mip is not available, the size does not match or the data is corrupt.
+     */
+    bool readMip(unsigned int mip, uint8_t* dst, size_t size) const;
+
+    /**
+     * Creates a 2D texture of the size, format and mip count of the file.
+     *
+     * @return The texture, owned by the caller, or NULL if the file is not a 2D texture.
+     */
+    RTexture2D* createTexture2D() const;
+
+    /**
+     * Creates a 3D texture of the size, format and mip count of the file.
+     *
+     * @return The texture, owned by the caller, or NULL if the file is not a 3D texture.
+     */
+    RTexture3D* createTexture3D() const;
+
+    /**
+     * Determines if a texture has the type, size, format and mip count of the file.
+     *
+     * @param texture The texture.
+     *
+     * @return true if the mips of the file can be uploaded to the texture.
+     */
+    bool matches(const RTexture2D* texture) const;
+
+    /**
+     * Uploads the available mips to a created texture, coarsest first.
+     *
+     * @param cache The state cache to bind the texture through.
+     * @param texture The texture, from createTexture2D().
+     *
+     * @return false if the texture does not match the file or a mip fails to upload.
+     */
+    bool upload(RGLStateCache* cache, RTexture2D* texture) const;
+
+    /**
+     * Uploads the available mips to a created texture, coarsest first.
+     *
+     * @param cache The state cache to bind the texture through.
+     * @param texture The texture, from createTexture3D().
+     *
+     * @return false if the texture does not match the file or a mip fails to upload.
+     */
+    bool upload(RGLStateCache* cache, RTexture3D* texture) const;
+
+    /**
+     * Converts a mip chain to the format.
+     *
+     * @param type The type of texture.
+     * @param format The format of the data.
+     * @param width The width of mip 0 in pixels.
+     * @param height The height of mip 0 in pixels.
+     * @param depth The depth of mip 0 in slices, 1 for 2D textures.
+     * @param mipCount The number of mips, at most RTexture::getFullMipCount().
+     * @param chain The mips, mip 0 first, each RTexture::getImageSize() bytes.
+     * @param supercompress Whether to supercompress the mips that get smaller.
+     * @param dst Set to the file data.
+     *
+     * @return false if the size or mip count is invalid.
+     */
+    static bool write(RTexture::Type type, RTexture::Format format, unsigned int width, unsigned int height,
+                      unsigned int depth, unsigned int mipCount, const uint8_t* chain, bool supercompress,
+                      std::vector<uint8_t>* dst);
+
+private:
+
+    RTextureFile(const RTextureFile& copy);
+
+    RTextureFile& operator=(const RTextureFile&);
+
+    const uint8_t* _data;
+    size_t _size;
+    RFileMapping _mapping;
+};
+
+}
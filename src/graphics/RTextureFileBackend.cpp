@@ -0,0 +1,42 @@
+#include "common.h"
+#include "RTextureFileBackend.h"
+#include "RTextureFile.h"
+
+namespace rocket
+{
+
+RTextureFileBackend::RTextureFileBackend(RGLStateCache* cache)
+    : RGLTextureBackend(cache)
+{
+}
+
+RTextureFileBackend::~RTextureFileBackend()
+{
+}
+
+bool RTextureFileBackend::setFile(const RTexture2D* texture, const RTextureFile* file)
+{
+    if (file && !file->matches(texture))
+        return false;
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (file)
+        _files[texture] = file;
+    else
+        _files.erase(texture);
+    return true;
+}
+
+bool RTextureFileBackend::read(const RTexture2D* texture, unsigned int mip, uint8_t* dst, size_t size)
+{
+    const RTextureFile* file;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::unordered_map<const RTexture2D*, const RTextureFile*>::const_iterator found = _files.find(texture);
+        if (found == _files.end())
+            return false;
+        file = found->second;
+    }
+    return file->readMip(mip, dst, size);
+}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "RGLTextureBackend.h"
+
+namespace rocket
+{
+
+class RTextureFile;
+
+/**
+ * Defines a texture streamer backend that reads mips from texture files and
+ * uploads them with RGLTextureBackend.
+ *
+ * Each streamed texture is given the file its mips come from. Reads decode
+ * the mip from the file's mapping straight into the streamer's staging
+ * buffer with RTextureFile::readMip(). A file opened from a prefix of its
+ * data fails the reads of mips it does not hold yet, which stops the
+ * streamer from reading that texture again.
+ */
+class API RTextureFileBackend : public RGLTextureBackend
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param cache The state cache to bind through, must outlive the backend.
+     */
+    explicit RTextureFileBackend(RGLStateCache* cache);
+
+    /**
+     * Destructor.
+     */
+    ~RTextureFileBackend();
+
+    /**
+     * Sets the file the mips of a texture are read from. The file must stay
+     * open while the texture is streamed.
+     *
+     * @param texture The texture, from RTextureFile::createTexture2D().
+     * @param file The file, NULL to forget the texture.
+     *
+     * @return false if the file does not match the texture.
+     */
+    bool setFile(const RTexture2D* texture, const RTextureFile* file);
+
+    bool read(const RTexture2D* texture, unsigned int mip, uint8_t* dst, size_t size);
+
+private:
+
+    std::mutex _mutex;
+    std::unordered_map<const RTexture2D*, const RTextureFile*> _files;
+};
+
+}
@@ -0,0 +1,381 @@
+#include "common.h"
+#include "RTextureStreamer.h"
+
+namespace rocket
+{
+
+// The largest mip dimension of the tail that stays resident whatever the budget.
+#define STREAMER_TAIL_SIZE  64
+
+/**
+ * A finer mip that a texture could be granted.
+ */
+struct RTextureStreamerCandidate
+{
+    float priority;
+    size_t index;
+    unsigned int mip;
+
+    bool operator<(const RTextureStreamerCandidate& other) const
+    {
+        if (priority != other.priority)
+            return priority < other.priority;
+        return index > other.index;
+    }
+};
+
+static inline float getStreamerPriority(const RTexture2D* texture, unsigned int mip, float screenSize, uint64_t age)
+{
+    float size = (float)std::max(texture->getMipWidth(mip), texture->getMipHeight(mip));
+    return screenSize / size / (float)(1 + age);
+}
+
+RTextureStreamer::RTextureStreamer(Backend* backend, size_t budget, unsigned int threadCount)
+    : _backend(backend), _budget(budget), _frame(0), _statistics(), _stop(false)
+{
+    for (unsigned int i = 0; i < threadCount; i++)
+        _threads.push_back(std::thread(&RTextureStreamer::run, this));
+}
+
+RTextureStreamer::~RTextureStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _queued.notify_all();
+    for (size_t i = 0; i < _threads.size(); i++)
+        _threads[i].join();
+    for (size_t i = 0; i < _queue.size(); i++)
+        delete _queue[i];
+    for (size_t i = 0; i < _completed.size(); i++)
+        delete _completed[i];
+    for (size_t i = 0; i < _free.size(); i++)
+        delete _free[i];
+}
+
+void RTextureStreamer::setBudget(size_t budget)
+{
+    _budget = budget;
+}
+
+size_t RTextureStreamer::getBudget() const
+{
+    return _budget;
+}
+
+void RTextureStreamer::add(RTexture2D* texture)
+{
+    if (!texture || _indices.find(texture) != _indices.end())
+        return;
+    Entry entry;
+    entry.texture = texture;
+    entry.screenSize = 0.0f;
+    entry.lastUse = _frame;
+    entry.targetMip = texture->getMipCount();
+    entry.loading = false;
+    entry.failed = false;
+    _indices[texture] = _entries.size();
+    _entries.push_back(entry);
+    _statistics.residentSize += texture->getChainSize(texture->getResidentMip());
+}
+
+void RTextureStreamer::remove(RTexture2D* texture)
+{
+    std::unordered_map<const RTexture2D*, size_t>::iterator found = _indices.find(texture);
+    if (found == _indices.end())
+        return;
+
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (size_t i = 0; i < _queue.size();)
+        {
+            if (_queue[i]->texture == texture)
+            {
+                _statistics.pendingSize -= texture->getMipSize(_queue[i]->mip);
+                _free.push_back(_queue[i]);
+                _queue.erase(_queue.begin() + i);
+            }
+            else
+                i++;
+        }
+        _finished.wait(lock, [&]() { return std::find(_reading.begin(), _reading.end(), texture) == _reading.end(); });
+        for (size_t i = 0; i < _completed.size();)
+        {
+            if (_completed[i]->texture == texture)
+            {
+                _statistics.pendingSize -= texture->getMipSize(_completed[i]->mip);
+                _free.push_back(_completed[i]);
+                _completed.erase(_completed.begin() + i);
+            }
+            else
+                i++;
+        }
+    }
+
+    _statistics.residentSize -= texture->getChainSize(texture->getResidentMip());
+    size_t index = found->second;
+    _indices.erase(found);
+    if (index + 1 < _entries.size())
+    {
+        _entries[index] = _entries.back();
+        _indices[_entries[index].texture] = index;
+    }
+    _entries.pop_back();
+}
+
+void RTextureStreamer::use(RTexture2D* texture, float screenSize)
+{
+    std::unordered_map<const RTexture2D*, size_t>::iterator found = _indices.find(texture);
+    if (found == _indices.end())
+        return;
+    Entry& entry = _entries[found->second];
+    if (entry.lastUse == _frame)
+        entry.screenSize = std::max(entry.screenSize, screenSize);
+    else
+        entry.screenSize = screenSize;
+    entry.lastUse = _frame;
+}
+
+void RTextureStreamer::update()
+{
+    complete();
+    chooseTargets();
+
+    // Evict first, so the reads below stay within the budget.
+    for (size_t i = 0; i < _entries.size(); i++)
+    {
+        Entry& entry = _entries[i];
+        unsigned int resident = entry.texture->getResidentMip();
+        if (resident >= entry.targetMip)
+            continue;
+        _backend->evict(entry.texture, entry.targetMip);
+        _statistics.residentSize -= entry.texture->getChainSize(resident) - entry.texture->getChainSize(entry.targetMip);
+        _statistics.evictions++;
+        entry.texture->setResidentMip(entry.targetMip);
+    }
+
+    queueReads();
+    if (_threads.empty())
+        flush();
+    _frame++;
+}
+
+void RTextureStreamer::flush()
+{
+    if (_threads.empty())
+    {
+        while (!_queue.empty())
+        {
+            Request* request = _queue.front();
+            _queue.pop_front();
+            process(request);
+            _completed.push_back(request);
+        }
+    }
+    else
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _finished.wait(lock, [&]() { return _queue.empty() && _reading.empty(); });
+    }
+    complete();
+}
+
+unsigned int RTextureStreamer::getTargetMip(const RTexture2D* texture) const
+{
+    std::unordered_map<const RTexture2D*, size_t>::const_iterator found = _indices.find(texture);
+    if (found == _indices.end())
+        return texture ? texture->getMipCount() : 0;
+    return _entries[found->second].targetMip;
+}
+
+RTextureStreamer::Statistics RTextureStreamer::getStatistics() const
+{
+    return _statistics;
+}
+
+unsigned int RTextureStreamer::getDesiredMip(const RTexture2D* texture, float screenSize)
+{
+    unsigned int coarsest = texture->getMipCount() - 1;
+    if (!(screenSize > 0.0f))
+        return coarsest;
+    float ratio = (float)std::max(texture->getWidth(), texture->getHeight()) / screenSize;
+    if (ratio <= 1.0f)
+        return 0;
+    return std::min((unsigned int)std::floor(std::log2(ratio)), coarsest);
+}
+
+unsigned int RTextureStreamer::getTailMip(const RTexture2D* texture)
+{
+    unsigned int mip = 0;
+    while (mip + 1 < texture->getMipCount() &&
+           std::max(texture->getMipWidth(mip), texture->getMipHeight(mip)) > STREAMER_TAIL_SIZE)
+        mip++;
+    return mip;
+}
+
+void RTextureStreamer::chooseTargets()
+{
+    // The tails are granted first, even over the budget.
+    size_t available = _budget;
+    std::priority_queue<RTextureStreamerCandidate> candidates;
+    for (size_t i = 0; i < _entries.size(); i++)
+    {
+        Entry& entry = _entries[i];
+        unsigned int tail = getTailMip(entry.texture);
+        entry.targetMip = tail;
+        available -= std::min(available, entry.texture->getChainSize(tail));
+        if (tail > getDesiredMip(entry.texture, entry.screenSize))
+        {
+            RTextureStreamerCandidate candidate;
+            candidate.index = i;
+            candidate.mip = tail - 1;
+            candidate.priority = getStreamerPriority(entry.texture, candidate.mip, entry.screenSize, _frame - entry.lastUse);
+            candidates.push(candidate);
+        }
+    }
+
+    // Then finer mips, one at a time per texture, by priority until the budget is spent.
+    while (!candidates.empty())
+    {
+        RTextureStreamerCandidate candidate = candidates.top();
+        candidates.pop();
+        Entry& entry = _entries[candidate.index];
+        size_t cost = entry.texture->getMipSize(candidate.mip);
+        if (cost > available)
+            continue;
+        available -= cost;
+        entry.targetMip = candidate.mip;
+        if (candidate.mip > getDesiredMip(entry.texture, entry.screenSize))
+        {
+            candidate.mip--;
+            candidate.priority = getStreamerPriority(entry.texture, candidate.mip, entry.screenSize, _frame - entry.lastUse);
+            candidates.push(candidate);
+        }
+    }
+}
+
+void RTextureStreamer::queueReads()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // Reads that have not started and are no longer wanted are cancelled.
+    for (size_t i = 0; i < _queue.size();)
+    {
+        Request* request = _queue[i];
+        Entry& entry = _entries[_indices[request->texture]];
+        if (request->mip < entry.targetMip)
+        {
+            entry.loading = false;
+            _statistics.pendingSize -= request->texture->getMipSize(request->mip);
+            _free.push_back(request);
+            _queue.erase(_queue.begin() + i);
+        }
+        else
+            i++;
+    }
+
+    std::vector<RTextureStreamerCandidate> reads;
+    for (size_t i = 0; i < _entries.size(); i++)
+    {
+        const Entry& entry = _entries[i];
+        unsigned int resident = entry.texture->getResidentMip();
+        if (entry.loading || entry.failed || resident <= entry.targetMip)
+            continue;
+        RTextureStreamerCandidate read;
+        read.index = i;
+        read.mip = resident - 1;
+        read.priority = getStreamerPriority(entry.texture, read.mip, entry.screenSize, _frame - entry.lastUse);
+        reads.push_back(read);
+    }
+    std::sort(reads.begin(), reads.end(), [](const RTextureStreamerCandidate& a, const RTextureStreamerCandidate& b) { return b < a; });
+
+    for (size_t i = 0; i < reads.size(); i++)
+    {
+        Entry& entry = _entries[reads[i].index];
+        Request* request;
+        if (_free.empty())
+            request = new Request();
+        else
+        {
+            request = _free.back();
+            _free.pop_back();
+        }
+        request->texture = entry.texture;
+        request->mip = reads[i].mip;
+        request->success = false;
+        entry.loading = true;
+        _statistics.pendingSize += entry.texture->getMipSize(request->mip);
+        _queue.push_back(request);
+    }
+    if (!reads.empty())
+        _queued.notify_all();
+}
+
+void RTextureStreamer::complete()
+{
+    std::vector<Request*> completed;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        completed.swap(_completed);
+    }
+
+    for (size_t i = 0; i < completed.size(); i++)
+    {
+        Request* request = completed[i];
+        std::unordered_map<const RTexture2D*, size_t>::iterator found = _indices.find(request->texture);
+        if (found != _indices.end())
+        {
+            Entry& entry = _entries[found->second];
+            RTexture2D* texture = entry.texture;
+            size_t size = texture->getMipSize(request->mip);
+            entry.loading = false;
+            _statistics.pendingSize -= size;
+            if (!request->success)
+            {
+                entry.failed = true;
+                _statistics.failures++;
+            }
+            else if (request->mip + 1 == texture->getResidentMip() && request->mip >= entry.targetMip)
+            {
+                _backend->upload(texture, request->mip, request->data.data(), size);
+                texture->setResidentMip(request->mip);
+                _statistics.residentSize += size;
+                _statistics.uploads++;
+            }
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        _free.push_back(request);
+    }
+}
+
+void RTextureStreamer::process(Request* request)
+{
+    size_t size = request->texture->getMipSize(request->mip);
+    request->data.resize(size);
+    request->success = _backend->read(request->texture, request->mip, request->data.data(), size);
+}
+
+void RTextureStreamer::run()
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true)
+    {
+        _queued.wait(lock, [&]() { return _stop || !_queue.empty(); });
+        if (_stop)
+            return;
+        Request* request = _queue.front();
+        _queue.pop_front();
+        _reading.push_back(request->texture);
+        lock.unlock();
+
+        process(request);
+
+        lock.lock();
+        _reading.erase(std::find(_reading.begin(), _reading.end(), request->texture));
+        _completed.push_back(request);
+        _finished.notify_all();
+    }
+}
+
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "RTexture2D.h"
+#include <condition_variable>
+
+namespace rocket
+{
+
+/**
+ * Defines a texture streamer that keeps the mips of RTexture2D resident
+ * according to how large the textures appear on screen, within a memory
+ * budget.
+ *
+ * Each frame the renderer reports the projected size of the visible
+ * textures with use(), then calls update(), which:
+ *
+ * - Chooses the resident mip of every texture. The coarse tail of each
+ *   chain (mips of at most 64 pixels) is always kept. Finer mips are granted
+ *   greedily by priority, the on-screen size of the texture relative to the
+ *   mip, divided by the number of frames since the texture was last used,
+ *   until the budget is spent. Textures that stop being used therefore keep
+ *   their mips while memory allows and are the first to lose them.
+ * - Evicts mips finer than the chosen ones.
+ * - Queues reads of the next finer mip of textures below their chosen mip,
+ *   highest priority first. I/O threads read the mips into staging buffers.
+ * - Uploads the mips that finished reading.
+ *
+ * All storage and GPU access goes through a Backend, so the decisions can be
+ * tested without a GL context or files. RGLTextureBackend implements the GPU
+ * side, sizing each texture's storage to its resident mips. A texture whose read fails is not
+ * read again, it keeps the mips it has. Apart from Backend::read(), which is
+ * called on the I/O threads, all methods and backend calls run on the thread
+ * that calls update().
+ */
+class API RTextureStreamer
+{
+public:
+
+    /**
+     * Defines the storage and GPU operations of the streamer.
+     */
+    class API Backend
+    {
+    public:
+
+        /**
+         * Destructor.
+         */
+        virtual ~Backend() {}
+
+        /**
+         * Reads a mip from storage, on an I/O thread.
+         *
+         * @param texture The texture.
+         * @param mip The mip.
+         * @param dst The staging buffer to read into, of texture->getMipSize(mip) bytes.
+         * @param size The size of the staging buffer in bytes.
+         *
+         * @return false if the mip cannot be read.
+         */
+        virtual bool read(const RTexture2D* texture, unsigned int mip, uint8_t* dst, size_t size) = 0;
+
+        /**
+         * Uploads a mip from a staging buffer to the GPU texture.
+         *
+         * @param texture The texture.
+         * @param mip The mip, one finer than the resident mip.
+         * @param data The staging buffer.
+         * @param size The size of the data in bytes.
+         */
+        virtual void upload(RTexture2D* texture, unsigned int mip, const uint8_t* data, size_t size) = 0;
+
+        /**
+         * Releases the GPU memory of the mips finer than a mip.
+         *
+         * @param texture The texture.
+         * @param mip The new finest resident mip.
+         */
+        virtual void evict(RTexture2D* texture, unsigned int mip) = 0;
+    };
+
+    /**
+     * The counters of the streamer.
+     */
+    struct Statistics
+    {
+        size_t residentSize;
+        size_t pendingSize;
+        unsigned int uploads;
+        unsigned int evictions;
+        unsigned int failures;
+    };
+
+    /**
+     * Constructor.
+     *
+     * @param backend The storage and GPU operations.
+     * @param budget The memory budget of resident and pending mips in bytes.
+     * @param threadCount The number of I/O threads, 0 to read in update().
+     */
+    RTextureStreamer(Backend* backend, size_t budget, unsigned int threadCount = 2);
+
+    /**
+     * Destructor, cancels the pending reads and stops the I/O threads.
+     */
+    ~RTextureStreamer();
+
+    /**
+     * Sets the memory budget. It takes effect at the next update().
+     *
+     * @param budget The budget in bytes.
+     */
+    void setBudget(size_t budget);
+
+    /**
+     * Gets the memory budget.
+     *
+     * @return The budget in bytes.
+     */
+    size_t getBudget() const;
+
+    /**
+     * Adds a texture to stream. Nothing of it is resident until update().
+     *
+     * @param texture The texture.
+     */
+    void add(RTexture2D* texture);
+
+    /**
+     * Removes a texture, waiting for a read of it in progress. Its resident
+     * mips are left to the caller.
+     *
+     * @param texture The texture.
+     */
+    void remove(RTexture2D* texture);
+
+    /**
+     * Reports that a texture is drawn in the current frame.
+     *
+     * @param texture The texture.
+     * @param screenSize The largest projected size of the texture, in pixels
+     * across its full extent (a texture tiled n times across 100 pixels has a
+     * size of 100 / n).
+     */
+    void use(RTexture2D* texture, float screenSize);
+
+    /**
+     * Chooses residency, evicts, queues reads and uploads finished reads. Call once per frame.
+     */
+    void update();
+
+    /**
+     * Waits for all queued reads, then uploads them.
+     */
+    void flush();
+
+    /**
+     * Gets the resident mip chosen for a texture by the last update().
+     *
+     * @param texture The texture.
+     *
+     * @return The mip, getMipCount() if none was chosen.
+     */
+    unsigned int getTargetMip(const RTexture2D* texture) const;
+
+    /**
+     * Gets the statistics.
+     *
+     * @return The counters.
+     */
+    Statistics getStatistics() const;
+
+    /**
+     * Gets the mip that matches a projected size one texel per pixel.
+     *
+     * @param texture The texture.
+     * @param screenSize The projected size in pixels.
+     *
+     * @return The mip, the coarsest one for sizes of 0.
+     */
+    static unsigned int getDesiredMip(const RTexture2D* texture, float screenSize);
+
+    /**
+     * Gets the finest mip of the tail that is always resident.
+     *
+     * @param texture The texture.
+     *
+     * @return The mip.
+     */
+    static unsigned int getTailMip(const RTexture2D* texture);
+
+private:
+
+    struct Entry
+    {
+        RTexture2D* texture;
+        float screenSize;
+        uint64_t lastUse;
+        unsigned int targetMip;
+        bool loading;
+        bool failed;
+    };
+
+    struct Request
+    {
+        RTexture2D* texture;
+        unsigned int mip;
+        std::vector<uint8_t> data;
+        bool success;
+    };
+
+    RTextureStreamer(const RTextureStreamer& copy);
+
+    RTextureStreamer& operator=(const RTextureStreamer&);
+
+    void chooseTargets();
+
+    void queueReads();
+
+    void complete();
+
+    void process(Request* request);
+
+    void run();
+
+    Backend* _backend;
+    size_t _budget;
+    uint64_t _frame;
+    std::vector<Entry> _entries;
+    std::unordered_map<const RTexture2D*, size_t> _indices;
+    Statistics _statistics;
+    std::vector<std::thread> _threads;
+    mutable std::mutex _mutex;
+    std::condition_variable _queued;
+    std::condition_variable _finished;
+    std::deque<Request*> _queue;
+    std::vector<Request*> _completed;
+    std::vector<Request*> _free;
+    std::vector<const RTexture2D*> _reading;
+    bool _stop;
+};
+
+}
@@ -0,0 +1,380 @@
+#include "common.h"
+#include "RVertexDeclaration.h"
+#include "RGL.h"
+#include "math/RPacking.h"
+
+namespace rocket
+{
+
+// Attributes are converted through a stack buffer of this many float4.
+#define VERTEX_CHUNK    256
+
+/**
+ * Gets the alignment of a format, the size of its components.
+ */
+static inline unsigned int getAlignment(RVertexDeclaration::Format format)
+{
+    switch (format)
+    {
+    case RVertexDeclaration::FORMAT_SNORM8_4:
+    case RVertexDeclaration::FORMAT_UNORM8_4:
+    case RVertexDeclaration::FORMAT_OCTAHEDRAL8:
+        return 1;
+    case RVertexDeclaration::FORMAT_HALF2:
+    case RVertexDeclaration::FORMAT_HALF4:
+    case RVertexDeclaration::FORMAT_SNORM16_4:
+    case RVertexDeclaration::FORMAT_UNORM16_2:
+    case RVertexDeclaration::FORMAT_UNORM16_4:
+    case RVertexDeclaration::FORMAT_OCTAHEDRAL16:
+        return 2;
+    default:
+        return 4;
+    }
+}
+
+/**
+ * Copies the bytes of count elements between strided arrays.
+ */
+static inline void scatter(const uint8_t* src, size_t srcStride, uint8_t* dst, size_t dstStride, size_t count, size_t size)
+{
+    for (size_t i = 0; i < count; i++)
+        memcpy(dst + i * dstStride, src + i * srcStride, size);
+}
+
+RVertexDeclaration::Tolerances::Tolerances()
+    : position(1e-3f), direction(1e-2f), color(0.5f / 255.0f), texcoord(1.0f / 4096.0f)
+{
+}
+
+RVertexDeclaration::RVertexDeclaration()
+    : _stride(0), _decodeOffset(0.0f, 0.0f, 0.0f), _decodeScale(1.0f, 1.0f, 1.0f)
+{
+}
+
+RVertexDeclaration::~RVertexDeclaration()
+{
+}
+
+unsigned int RVertexDeclaration::add(Semantic semantic, Format format)
+{
+    unsigned int end = 0;
+    for (size_t i = 0; i < _elements.size(); i++)
+        end = std::max(end, _elements[i].offset + getSize(_elements[i].format));
+    unsigned int alignment = getAlignment(format);
+
+    Element element;
+    element.semantic = semantic;
+    element.format = format;
+    element.offset = (end + alignment - 1) / alignment * alignment;
+    _elements.push_back(element);
+    _stride = (element.offset + getSize(format) + 3) / 4 * 4;
+    return element.offset;
+}
+
+unsigned int RVertexDeclaration::getElementCount() const
+{
+    return (unsigned int)_elements.size();
+}
+
+const RVertexDeclaration::Element& RVertexDeclaration::getElement(unsigned int index) const
+{
+    return _elements[index];
+}
+
+const RVertexDeclaration::Element* RVertexDeclaration::find(Semantic semantic) const
+{
+    for (size_t i = 0; i < _elements.size(); i++)
+    {
+        if (_elements[i].semantic == semantic)
+            return &_elements[i];
+    }
+    return NULL;
+}
+
+unsigned int RVertexDeclaration::getStride() const
+{
+    return _stride;
+}
+
+const RVector3& RVertexDeclaration::getDecodeOffset() const
+{
+    return _decodeOffset;
+}
+
+const RVector3& RVertexDeclaration::getDecodeScale() const
+{
+    return _decodeScale;
+}
+
+void RVertexDeclaration::setDecode(const RVector3& offset, const RVector3& scale)
+{
+    _decodeOffset = offset;
+    _decodeScale = scale;
+}
+
+unsigned int RVertexDeclaration::getSize(Format format)
+{
+    switch (format)
+    {
+    case FORMAT_FLOAT1:
+        return 4;
+    case FORMAT_FLOAT2:
+        return 8;
+    case FORMAT_FLOAT3:
+        return 12;
+    case FORMAT_FLOAT4:
+        return 16;
+    case FORMAT_HALF2:
+        return 4;
+    case FORMAT_HALF4:
+        return 8;
+    case FORMAT_SNORM8_4:
+        return 4;
+    case FORMAT_SNORM16_4:
+        return 8;
+    case FORMAT_UNORM8_4:
+        return 4;
+    case FORMAT_UNORM16_2:
+        return 4;
+    case FORMAT_UNORM16_4:
+        return 8;
+    case FORMAT_SNORM_10_10_10_2:
+        return 4;
+    case FORMAT_OCTAHEDRAL8:
+        return 2;
+    case FORMAT_OCTAHEDRAL16:
+        return 4;
+    }
+    return 0;
+}
+
+unsigned int RVertexDeclaration::getComponentCount(Format format)
+{
+    switch (format)
+    {
+    case FORMAT_FLOAT1:
+        return 1;
+    case FORMAT_FLOAT2:
+    case FORMAT_HALF2:
+    case FORMAT_UNORM16_2:
+        return 2;
+    case FORMAT_FLOAT3:
+    case FORMAT_OCTAHEDRAL8:
+    case FORMAT_OCTAHEDRAL16:
+        return 3;
+    default:
+        return 4;
+    }
+}
+
+void RVertexDeclaration::getGLFormat(Format format, unsigned int* type, int* size, bool* normalized)
+{
+    *normalized = true;
+    switch (format)
+    {
+    case FORMAT_FLOAT1:
+    case FORMAT_FLOAT2:
+    case FORMAT_FLOAT3:
+    case FORMAT_FLOAT4:
+        *type = GL_FLOAT;
+        *size = (int)getComponentCount(format);
+        *normalized = false;
+        break;
+    case FORMAT_HALF2:
+    case FORMAT_HALF4:
+        *type = GL_HALF_FLOAT;
+        *size = (int)getComponentCount(format);
+        *normalized = false;
+        break;
+    case FORMAT_SNORM8_4:
+        *type = GL_BYTE;
+        *size = 4;
+        break;
+    case FORMAT_SNORM16_4:
+        *type = GL_SHORT;
+        *size = 4;
+        break;
+    case FORMAT_UNORM8_4:
+        *type = GL_UNSIGNED_BYTE;
+        *size = 4;
+        break;
+    case FORMAT_UNORM16_2:
+    case FORMAT_UNORM16_4:
+        *type = GL_UNSIGNED_SHORT;
+        *size = (int)getComponentCount(format);
+        break;
+    case FORMAT_SNORM_10_10_10_2:
+        *type = GL_INT_2_10_10_10_REV;
+        *size = 4;
+        break;
+    case FORMAT_OCTAHEDRAL8:
+        *type = GL_BYTE;
+        *size = 2;
+        break;
+    case FORMAT_OCTAHEDRAL16:
+        *type = GL_SHORT;
+        *size = 2;
+        break;
+    }
+}
+
+void RVertexDeclaration::pack(Format format, const void* src, size_t srcStride, unsigned int srcComponents, size_t count,
+                              void* dst, size_t dstStride, const RVector3* offset, const RVector3* scale)
+{
+    srcComponents = std::min(std::max(srcComponents, 1u), 4u);
+    const uint8_t* in = (const uint8_t*)src;
+    uint8_t* out = (uint8_t*)dst;
+    RVector3 o = offset ? *offset : RVector3::zero();
+    RVector3 s = scale ? *scale : RVector3::one();
+    float inverse[3] = { s.x != 0.0f ? 1.0f / s.x : 0.0f, s.y != 0.0f ? 1.0f / s.y : 0.0f, s.z != 0.0f ? 1.0f / s.z : 0.0f };
+    const float origin[3] = { o.x, o.y, o.z };
+    bool transform = offset || scale;
+
+    float values[VERTEX_CHUNK * 4];
+    RVector3 vectors[VERTEX_CHUNK];
+    uint32_t encoded[VERTEX_CHUNK * 4];
+    for (size_t begin = 0; begin < count; begin += VERTEX_CHUNK)
+    {
+        size_t n = std::min<size_t>(VERTEX_CHUNK, count - begin);
+        for (size_t i = 0; i < n; i++)
+        {
+            float* v = &values[i * 4];
+            v[0] = v[1] = v[2] = 0.0f;
+            v[3] = 1.0f;
+            memcpy(v, in + (begin + i) * srcStride, srcComponents * sizeof(float));
+            for (unsigned int c = 0; c < 3 && transform; c++)
+                v[c] = (v[c] - origin[c]) * inverse[c];
+        }
+
+        uint8_t* chunk = out + begin * dstStride;
+        uint8_t* bytes = (uint8_t*)encoded;
+        switch (format)
+        {
+        case FORMAT_FLOAT1:
+        case FORMAT_FLOAT2:
+        case FORMAT_FLOAT3:
+        case FORMAT_FLOAT4:
+            scatter((const uint8_t*)values, 4 * sizeof(float), chunk, dstStride, n, getSize(format));
+            break;
+        case FORMAT_HALF2:
+        case FORMAT_HALF4:
+            RPacking::packHalf(values, n * 4, (uint16_t*)bytes);
+            scatter(bytes, 4 * sizeof(uint16_t), chunk, dstStride, n, getSize(format));
+            break;
+        case FORMAT_SNORM8_4:
+            RPacking::packSnorm8(values, n * 4, (int8_t*)bytes);
+            scatter(bytes, 4, chunk, dstStride, n, 4);
+            break;
+        case FORMAT_SNORM16_4:
+            RPacking::packSnorm16(values, n * 4, (int16_t*)bytes);
+            scatter(bytes, 8, chunk, dstStride, n, 8);
+            break;
+        case FORMAT_UNORM8_4:
+            RPacking::packUnorm8(values, n * 4, bytes);
+            scatter(bytes, 4, chunk, dstStride, n, 4);
+            break;
+        case FORMAT_UNORM16_2:
+        case FORMAT_UNORM16_4:
+            RPacking::packUnorm16(values, n * 4, (uint16_t*)bytes);
+            scatter(bytes, 8, chunk, dstStride, n, getSize(format));
+            break;
+        case FORMAT_SNORM_10_10_10_2:
+            RPacking::packSnorm1010102((const RVector4*)values, n, encoded);
+            scatter(bytes, 4, chunk, dstStride, n, 4);
+            break;
+        case FORMAT_OCTAHEDRAL8:
+        case FORMAT_OCTAHEDRAL16:
+            for (size_t i = 0; i < n; i++)
+                vectors[i].set(values[i * 4], values[i * 4 + 1], values[i * 4 + 2]);
+            if (format == FORMAT_OCTAHEDRAL8)
+                RPacking::packOctahedral8(vectors, n, (int8_t*)bytes);
+            else
+                RPacking::packOctahedral16(vectors, n, (int16_t*)bytes);
+            scatter(bytes, getSize(format), chunk, dstStride, n, getSize(format));
+            break;
+        }
+    }
+}
+
+void RVertexDeclaration::unpack(Format format, const void* src, size_t srcStride, size_t count, float* dst,
+                                const RVector3* offset, const RVector3* scale)
+{
+    const uint8_t* in = (const uint8_t*)src;
+    RVector3 o = offset ? *offset : RVector3::zero();
+    RVector3 s = scale ? *scale : RVector3::one();
+    bool transform = offset || scale;
+    unsigned int size = getSize(format);
+    unsigned int components = getComponentCount(format);
+
+    float values[VERTEX_CHUNK * 4];
+    RVector3 vectors[VERTEX_CHUNK];
+    uint32_t encoded[VERTEX_CHUNK * 4];
+    uint8_t* bytes = (uint8_t*)encoded;
+    for (size_t begin = 0; begin < count; begin += VERTEX_CHUNK)
+    {
+        size_t n = std::min<size_t>(VERTEX_CHUNK, count - begin);
+        const uint8_t* chunk = in + begin * srcStride;
+        float* out = dst + begin * 4;
+        switch (format)
+        {
+        case FORMAT_FLOAT1:
+        case FORMAT_FLOAT2:
+        case FORMAT_FLOAT3:
+        case FORMAT_FLOAT4:
+            for (size_t i = 0; i < n; i++)
+                memcpy(&values[i * 4], chunk + i * srcStride, size);
+            break;
+        case FORMAT_HALF2:
+        case FORMAT_HALF4:
+            scatter(chunk, srcStride, bytes, 4 * sizeof(uint16_t), n, size);
+            RPacking::unpackHalf((const uint16_t*)bytes, n * 4, values);
+            break;
+        case FORMAT_SNORM8_4:
+            scatter(chunk, srcStride, bytes, 4, n, 4);
+            RPacking::unpackSnorm8((const int8_t*)bytes, n * 4, values);
+            break;
+        case FORMAT_SNORM16_4:
+            scatter(chunk, srcStride, bytes, 8, n, 8);
+            RPacking::unpackSnorm16((const int16_t*)bytes, n * 4, values);
+            break;
+        case FORMAT_UNORM8_4:
+            scatter(chunk, srcStride, bytes, 4, n, 4);
+            RPacking::unpackUnorm8(bytes, n * 4, values);
+            break;
+        case FORMAT_UNORM16_2:
+        case FORMAT_UNORM16_4:
+            scatter(chunk, srcStride, bytes, 8, n, size);
+            RPacking::unpackUnorm16((const uint16_t*)bytes, n * 4, values);
+            break;
+        case FORMAT_SNORM_10_10_10_2:
+            scatter(chunk, srcStride, bytes, 4, n, 4);
+            RPacking::unpackSnorm1010102(encoded, n, (RVector4*)values);
+            break;
+        case FORMAT_OCTAHEDRAL8:
+        case FORMAT_OCTAHEDRAL16:
+            scatter(chunk, srcStride, bytes, size, n, size);
+            if (format == FORMAT_OCTAHEDRAL8)
+                RPacking::unpackOctahedral8((const int8_t*)bytes, n, vectors);
+            else
+                RPacking::unpackOctahedral16((const int16_t*)bytes, n, vectors);
+            for (size_t i = 0; i < n; i++)
+                memcpy(&values[i * 4], &vectors[i].x, 3 * sizeof(float));
+            break;
+        }
+
+        for (size_t i = 0; i < n; i++)
+        {
+            float* v = &out[i * 4];
+            for (unsigned int c = 0; c < 4; c++)
+                v[c] = c < components ? values[i * 4 + c] : (c == 3 ? 1.0f : 0.0f);
+            if (transform)
+            {
+                v[0] = v[0] * s.x + o.x;
+                v[1] = v[1] * s.y + o.y;
+                v[2] = v[2] * s.z + o.z;
+            }
+        }
+    }
+}
+
+}
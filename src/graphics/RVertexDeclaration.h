@@ -0,0 +1,267 @@
+#pragma once
+
+#include "math/RVector3.h"
+
+namespace rocket
+{
+
+/**
+ * Defines the layout of an interleaved vertex: which attributes it holds,
+ * in which format and at which offset.
+ *
+ * Besides full floats, attributes can use the compact formats of RPacking,
+ * which cut vertex memory and fetch bandwidth in half or more:
+ *
+ * - positions as snorm16 relative to the mesh bounds (see getDecodeOffset()),
+ *   or half floats,
+ * - normals as octahedral 8 or 16-bit pairs, tangents as 10:10:10:2 with
+ *   the bitangent sign in w,
+ * - colors as unorm8,
+ * - texture coordinates as half floats or unorm16.
+ *
+ * Each element is aligned to the size of its components and the stride to
+ * 4 bytes. pack() and unpack() convert arrays of float attributes with the
+ * SIMD bulk converters of RPacking; RMeshBuilder::convert() uses them to
+ * build a vertex buffer and RMeshBuilder::selectDeclaration() to pick the
+ * smallest formats within an error tolerance.
+ */
+class API RVertexDeclaration
+{
+public:
+
+    /**
+     * The meaning of an attribute.
+     */
+    enum Semantic
+    {
+        SEMANTIC_POSITION,
+        SEMANTIC_NORMAL,
+        SEMANTIC_TANGENT,
+        SEMANTIC_COLOR,
+        SEMANTIC_TEXCOORD0,
+        SEMANTIC_TEXCOORD1,
+        SEMANTIC_COUNT
+    };
+
+    /**
+     * The storage format of an attribute.
+     */
+    enum Format
+    {
+        FORMAT_FLOAT1,
+        FORMAT_FLOAT2,
+        FORMAT_FLOAT3,
+        FORMAT_FLOAT4,
+        FORMAT_HALF2,
+        FORMAT_HALF4,
+        FORMAT_SNORM8_4,
+        FORMAT_SNORM16_4,
+        FORMAT_UNORM8_4,
+        FORMAT_UNORM16_2,
+        FORMAT_UNORM16_4,
+        FORMAT_SNORM_10_10_10_2,
+
+        /**
+         * A unit vector as two snorm8 octahedral coordinates (2 bytes).
+         */
+        FORMAT_OCTAHEDRAL8,
+
+        /**
+         * A unit vector as two snorm16 octahedral coordinates (4 bytes).
+         */
+        FORMAT_OCTAHEDRAL16
+    };
+
+    /**
+     * An attribute of the vertex.
+     */
+    struct Element
+    {
+        Semantic semantic;
+        Format format;
+
+        /**
+         * The offset of the attribute in the vertex, in bytes.
+         */
+        unsigned int offset;
+    };
+
+    /**
+     * The largest errors selectDeclaration() accepts for each kind of attribute.
+     */
+    struct Tolerances
+    {
+        /**
+         * The distance in position units.
+         */
+        float position;
+
+        /**
+         * The angle of normals and tangents, in radians.
+         */
+        float direction;
+
+        /**
+         * The difference of color components.
+         */
+        float color;
+
+        /**
+         * The difference of texture coordinates.
+         */
+        float texcoord;
+
+        /**
+         * Constructs tolerances of 0.001 units, 0.01 radians, half a step of
+         * 8-bit colors and 1/4096 of a texture.
+         */
+        Tolerances();
+    };
+
+    /**
+     * Constructs an empty declaration.
+     */
+    RVertexDeclaration();
+
+    /**
+     * Destructor.
+     */
+    ~RVertexDeclaration();
+
+    /**
+     * Appends an attribute after the previous ones.
+     *
+     * @param semantic The meaning of the attribute.
+     * @param format The storage format.
+     *
+     * @return The offset of the attribute.
+     */
+    unsigned int add(Semantic semantic, Format format);
+
+    /**
+     * Gets the number of attributes.
+     *
+     * @return The number of attributes.
+     */
+    unsigned int getElementCount() const;
+
+    /**
+     * Gets an attribute.
+     *
+     * @param index The index of the attribute.
+     *
+     * @return The attribute.
+     */
+    const Element& getElement(unsigned int index) const;
+
+    /**
+     * Finds the attribute of a semantic.
+     *
+     * @param semantic The semantic.
+     *
+     * @return The attribute, NULL if there is none.
+     */
+    const Element* find(Semantic semantic) const;
+
+    /**
+     * Gets the size of a vertex.
+     *
+     * @return The stride in bytes, a multiple of 4.
+     */
+    unsigned int getStride() const;
+
+    /**
+     * Gets the offset subtracted from snorm16 positions before encoding.
+     *
+     * Shaders decode positions as decoded * scale + offset.
+     *
+     * @return The offset, zero by default.
+     */
+    const RVector3& getDecodeOffset() const;
+
+    /**
+     * Gets the scale positions are divided by before encoding as snorm16.
+     *
+     * @return The scale, one by default.
+     */
+    const RVector3& getDecodeScale() const;
+
+    /**
+     * Sets the transform from snorm16 positions to positions, usually the center and half extents of the mesh bounds.
+     *
+     * @param offset The offset.
+     * @param scale The scale.
+     */
+    void setDecode(const RVector3& offset, const RVector3& scale);
+
+    /**
+     * Gets the size of a format.
+     *
+     * @param format The format.
+     *
+     * @return The size in bytes.
+     */
+    static unsigned int getSize(Format format);
+
+    /**
+     * Gets the number of float components a format encodes.
+     *
+     * @param format The format.
+     *
+     * @return The component count, 3 for the octahedral unit vectors.
+     */
+    static unsigned int getComponentCount(Format format);
+
+    /**
+     * Gets the arguments of glVertexAttribPointer for a format.
+     *
+     * @param format The format.
+     * @param type Set to the GL component type.
+     * @param size Set to the number of stored components.
+     * @param normalized Set to whether integers are normalized.
+     */
+    static void getGLFormat(Format format, unsigned int* type, int* size, bool* normalized);
+
+    /**
+     * Encodes an array of float attributes.
+     *
+     * Missing source components are 0, and a missing w is 1.
+     *
+     * @param format The format to encode to.
+     * @param src The first float attribute.
+     * @param srcStride The distance between float attributes, in bytes.
+     * @param srcComponents The number of floats in each attribute, 1 to 4.
+     * @param count The number of attributes.
+     * @param dst The first encoded attribute.
+     * @param dstStride The distance between encoded attributes, in bytes.
+     * @param offset Optional offset subtracted from xyz before encoding.
+     * @param scale Optional scale xyz are divided by before encoding.
+     */
+    static void pack(Format format, const void* src, size_t srcStride, unsigned int srcComponents, size_t count,
+                     void* dst, size_t dstStride, const RVector3* offset = NULL, const RVector3* scale = NULL);
+
+    /**
+     * Decodes an array of attributes to four floats each.
+     *
+     * Components the format does not store are 0, and w is 1.
+     *
+     * @param format The format to decode from.
+     * @param src The first encoded attribute.
+     * @param srcStride The distance between encoded attributes, in bytes.
+     * @param count The number of attributes.
+     * @param dst count * 4 floats.
+     * @param offset Optional offset added to xyz after decoding.
+     * @param scale Optional scale xyz are multiplied by after decoding.
+     */
+    static void unpack(Format format, const void* src, size_t srcStride, size_t count, float* dst,
+                       const RVector3* offset = NULL, const RVector3* scale = NULL);
+
+private:
+
+    std::vector<Element> _elements;
+    unsigned int _stride;
+    RVector3 _decodeOffset;
+    RVector3 _decodeScale;
+};
+
+}
@@ -0,0 +1,447 @@
+#include "common.h"
+#include "RCurve.h"
+#include "RSimd.h"
+
+namespace rocket
+{
+
+// Offsets into a segment record, see RCurve::_segments.
+#define CURVE_START         0
+#define CURVE_INV_DURATION  1
+#define CURVE_COEFFICIENTS  2
+
+template <typename F>
+static inline F clampUnit(F t)
+{
+    return simdMin(simdMax(t, F(0.0f)), F(1.0f));
+}
+
+template <typename F>
+static inline F horner(F a, F b, F c, F d, F t)
+{
+    return ((a * t + b) * t + c) * t + d;
+}
+
+template <typename F>
+static inline void normalizeQuaternion(F* x, F* y, F* z, F* w)
+{
+    F length = simdSqrt(*x * *x + *y * *y + *z * *z + *w * *w);
+    F valid = length > F(0.0f);
+    *x = simdSelect(valid, *x / length, *x);
+    *y = simdSelect(valid, *y / length, *y);
+    *z = simdSelect(valid, *z / length, *z);
+    *w = simdSelect(valid, *w / length, *w);
+}
+
+#ifdef ROCKET_SIMD_SSE2
+static inline RSimd4f gather(const float* const* records, int offset)
+{
+    return _mm_setr_ps(records[0][offset], records[1][offset], records[2][offset], records[3][offset]);
+}
+
+static inline void scatter(RSimd4f v, float* const* dst, int offset)
+{
+    float tmp[4];
+    v.store(tmp);
+    for (int i = 0; i < 4; i++)
+        dst[i][offset] = tmp[i];
+}
+#endif
+
+RCurve::RCurve(unsigned int pointCount, unsigned int componentCount)
+    : _pointCount(std::max(1u, pointCount)), _componentCount(std::max(1u, componentCount)), _quaternionOffset(-1),
+      _segmentStride(CURVE_COEFFICIENTS + 4 * _componentCount)
+{
+    _times.resize(_pointCount, 0.0f);
+    _values.resize(_pointCount * _componentCount, 0.0f);
+    _inTangents.resize(_pointCount * _componentCount, 0.0f);
+    _outTangents.resize(_pointCount * _componentCount, 0.0f);
+    _types.resize(_pointCount, LINEAR);
+    _segments.resize(_pointCount * _segmentStride, 0.0f);
+}
+
+RCurve::~RCurve()
+{
+}
+
+unsigned int RCurve::getPointCount() const
+{
+    return _pointCount;
+}
+
+unsigned int RCurve::getComponentCount() const
+{
+    return _componentCount;
+}
+
+float RCurve::getStartTime() const
+{
+    return _times[0];
+}
+
+float RCurve::getEndTime() const
+{
+    return _times[_pointCount - 1];
+}
+
+void RCurve::setPoint(unsigned int index, float time, const float* value, InterpolationType type)
+{
+    setPoint(index, time, value, type, NULL, NULL);
+}
+
+void RCurve::setPoint(unsigned int index, float time, const float* value, InterpolationType type,
+                      const float* inTangent, const float* outTangent)
+{
+    if (index >= _pointCount || !value)
+        return;
+
+    const size_t base = index * _componentCount;
+    _times[index] = time;
+    _types[index] = type;
+    memcpy(&_values[base], value, _componentCount * sizeof(float));
+    if (inTangent)
+        memcpy(&_inTangents[base], inTangent, _componentCount * sizeof(float));
+    if (outTangent)
+        memcpy(&_outTangents[base], outTangent, _componentCount * sizeof(float));
+
+    // Catmull-Rom segments read the points before and after them.
+    unsigned int first = index >= 2 ? index - 2 : 0;
+    unsigned int last = std::min(index + 1, _pointCount - 1);
+    for (unsigned int segment = first; segment <= last; segment++)
+        updateSegment(segment);
+}
+
+void RCurve::setQuaternionOffset(unsigned int offset)
+{
+    if (offset + 4 > _componentCount)
+        return;
+
+    _quaternionOffset = (int)offset;
+    for (unsigned int segment = 0; segment < _pointCount; segment++)
+        updateSegment(segment);
+}
+
+void RCurve::updateSegment(unsigned int segment)
+{
+    const unsigned int n = _componentCount;
+    const unsigned int lastPoint = _pointCount - 1;
+    float* record = &_segments[segment * _segmentStride];
+    float* a = record + CURVE_COEFFICIENTS;
+    float* b = a + n;
+    float* c = b + n;
+    float* d = c + n;
+
+    record[CURVE_START] = _times[segment];
+    if (segment == lastPoint)
+    {
+        // Past the last point the curve holds its value.
+        record[CURVE_INV_DURATION] = 0.0f;
+        for (unsigned int i = 0; i < n; i++)
+        {
+            a[i] = b[i] = c[i] = 0.0f;
+            d[i] = _values[segment * n + i];
+        }
+        return;
+    }
+
+    const unsigned int prev = segment > 0 ? segment - 1 : segment;
+    const unsigned int next = std::min(segment + 2, lastPoint);
+    const float t0 = _times[segment];
+    const float t1 = _times[segment + 1];
+    const float duration = t1 - t0;
+    record[CURVE_INV_DURATION] = duration > 0.0f ? 1.0f / duration : 0.0f;
+
+    const float* p0 = &_values[segment * n];
+    const float* p1 = &_values[(segment + 1) * n];
+    const float* pPrev = &_values[prev * n];
+    const float* pNext = &_values[next * n];
+
+    // Sign of p1, pPrev and pNext's quaternion relative to p0 (pNext relative to the flipped p1).
+    float sign1 = 1.0f, signPrev = 1.0f, signNext = 1.0f;
+    if (_quaternionOffset >= 0)
+    {
+        const int q = _quaternionOffset;
+        float dot1 = 0.0f, dotPrev = 0.0f, dotNext = 0.0f;
+        for (int i = q; i < q + 4; i++)
+        {
+            dot1 += p0[i] * p1[i];
+            dotPrev += p0[i] * pPrev[i];
+            dotNext += p1[i] * pNext[i];
+        }
+        sign1 = dot1 < 0.0f ? -1.0f : 1.0f;
+        signPrev = dotPrev < 0.0f ? -1.0f : 1.0f;
+        signNext = dotNext < 0.0f ? -sign1 : sign1;
+    }
+
+    // Catmull-Rom tangents are finite differences scaled to the duration of this segment.
+    const float tPrev = _times[prev];
+    const float tNext = _times[next];
+    const float scale0 = (t1 > tPrev && segment > 0) ? duration / (t1 - tPrev) : 1.0f;
+    const float scale1 = (tNext > t0 && segment + 2 <= lastPoint) ? duration / (tNext - t0) : 1.0f;
+
+    const InterpolationType type = _types[segment];
+    for (unsigned int i = 0; i < n; i++)
+    {
+        const bool quaternion = _quaternionOffset >= 0 && (int)i >= _quaternionOffset && (int)i < _quaternionOffset + 4;
+        const float s1 = quaternion ? sign1 : 1.0f;
+        const float v0 = p0[i];
+        const float v1 = p1[i] * s1;
+
+        float m0, m1;
+        switch (type)
+        {
+        case STEP:
+            a[i] = b[i] = c[i] = 0.0f;
+            d[i] = v0;
+            continue;
+
+        case LINEAR:
+            a[i] = b[i] = 0.0f;
+            c[i] = v1 - v0;
+            d[i] = v0;
+            continue;
+
+        case HERMITE:
+            m0 = _outTangents[segment * n + i];
+            m1 = _inTangents[(segment + 1) * n + i] * s1;
+            break;
+
+        case BEZIER:
+            m0 = 3.0f * (_outTangents[segment * n + i] - v0);
+            m1 = 3.0f * (v1 - _inTangents[(segment + 1) * n + i] * s1);
+            break;
+
+        case CATMULL_ROM:
+        default:
+        {
+            const float vPrev = segment > 0 ? pPrev[i] * (quaternion ? signPrev : 1.0f) : v0;
+            const float vNext = segment + 2 <= lastPoint ? pNext[i] * (quaternion ? signNext : 1.0f) : v1;
+            m0 = (segment > 0 ? v1 - vPrev : v1 - v0) * scale0;
+            m1 = (segment + 2 <= lastPoint ? vNext - v0 : v1 - v0) * scale1;
+            break;
+        }
+        }
+
+        a[i] = 2.0f * v0 + m0 - 2.0f * v1 + m1;
+        b[i] = -3.0f * v0 - 2.0f * m0 + 3.0f * v1 - m1;
+        c[i] = m0;
+        d[i] = v0;
+    }
+}
+
+unsigned int RCurve::findSegment(float time, unsigned int hint) const
+{
+    const float* times = _times.data();
+    const unsigned int lastPoint = _pointCount - 1;
+
+    // The hint or the segment after it cover small steps either way.
+    if (hint < lastPoint && times[hint] <= time)
+    {
+        if (time < times[hint + 1])
+            return hint;
+        if (hint + 1 == lastPoint || time < times[hint + 2])
+            return hint + 1;
+    }
+    if (time < times[0])
+        return 0;
+
+    return (unsigned int)(std::upper_bound(times, times + _pointCount, time) - times) - 1;
+}
+
+void RCurve::evaluateSegment(unsigned int segment, float time, float* dst) const
+{
+    const unsigned int n = _componentCount;
+    const float* record = &_segments[segment * _segmentStride];
+    const float* a = record + CURVE_COEFFICIENTS;
+    const float* b = a + n;
+    const float* c = b + n;
+    const float* d = c + n;
+
+    unsigned int i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    RSimd4f t4 = clampUnit(RSimd4f((time - record[CURVE_START]) * record[CURVE_INV_DURATION]));
+    for (; i + 4 <= n; i += 4)
+        horner(RSimd4f::load(a + i), RSimd4f::load(b + i), RSimd4f::load(c + i), RSimd4f::load(d + i), t4).store(dst + i);
+#endif
+    RSimd1f t = clampUnit(RSimd1f((time - record[CURVE_START]) * record[CURVE_INV_DURATION]));
+    for (; i < n; i++)
+        dst[i] = horner(RSimd1f(a[i]), RSimd1f(b[i]), RSimd1f(c[i]), RSimd1f(d[i]), t).v;
+
+    if (_quaternionOffset >= 0)
+    {
+        float* q = dst + _quaternionOffset;
+        RSimd1f x(q[0]), y(q[1]), z(q[2]), w(q[3]);
+        normalizeQuaternion(&x, &y, &z, &w);
+        q[0] = x.v;
+        q[1] = y.v;
+        q[2] = z.v;
+        q[3] = w.v;
+    }
+}
+
+void RCurve::evaluate(float time, float* dst) const
+{
+    evaluateSegment(findSegment(time, _pointCount), time, dst);
+}
+
+void RCurve::evaluate(float time, float* dst, unsigned int* cursor) const
+{
+    *cursor = findSegment(time, *cursor);
+    evaluateSegment(*cursor, time, dst);
+}
+
+void RCurve::evaluate(const float* times, size_t count, float* dst) const
+{
+    const unsigned int n = _componentCount;
+    unsigned int cursor = 0;
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    for (; i + 4 <= count; i += 4)
+    {
+        const float* records[4];
+        float* out[4];
+        for (int lane = 0; lane < 4; lane++)
+        {
+            cursor = findSegment(times[i + lane], cursor);
+            records[lane] = &_segments[cursor * _segmentStride];
+            out[lane] = dst + (i + lane) * n;
+        }
+
+        RSimd4f t = clampUnit((RSimd4f::load(times + i) - gather(records, CURVE_START)) * gather(records, CURVE_INV_DURATION));
+        for (unsigned int c = 0; c < n; c++)
+        {
+            const int offset = CURVE_COEFFICIENTS + c;
+            RSimd4f value = horner(gather(records, offset), gather(records, offset + n),
+                                   gather(records, offset + 2 * n), gather(records, offset + 3 * n), t);
+            scatter(value, out, c);
+        }
+
+        if (_quaternionOffset >= 0)
+        {
+            const int q = _quaternionOffset;
+            const float* const* values = (const float* const*)out;
+            RSimd4f x = gather(values, q), y = gather(values, q + 1), z = gather(values, q + 2), w = gather(values, q + 3);
+            normalizeQuaternion(&x, &y, &z, &w);
+            scatter(x, out, q);
+            scatter(y, out, q + 1);
+            scatter(z, out, q + 2);
+            scatter(w, out, q + 3);
+        }
+    }
+#endif
+    for (; i < count; i++)
+    {
+        cursor = findSegment(times[i], cursor);
+        evaluateSegment(cursor, times[i], dst + i * n);
+    }
+}
+
+void RCurve::evaluate(const RCurve* const* curves, size_t count, float time, float* const* dst, unsigned int* cursors)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    for (; i + 4 <= count; i += 4)
+    {
+        bool scalar = true;
+        for (int lane = 0; lane < 4; lane++)
+            scalar = scalar && curves[i + lane]->_componentCount == 1;
+        if (!scalar)
+        {
+            for (int lane = 0; lane < 4; lane++)
+            {
+                if (cursors)
+                    curves[i + lane]->evaluate(time, dst[i + lane], &cursors[i + lane]);
+                else
+                    curves[i + lane]->evaluate(time, dst[i + lane]);
+            }
+            continue;
+        }
+
+        const float* records[4];
+        for (int lane = 0; lane < 4; lane++)
+        {
+            const RCurve* curve = curves[i + lane];
+            unsigned int hint = cursors ? cursors[i + lane] : curve->_pointCount;
+            unsigned int segment = curve->findSegment(time, hint);
+            if (cursors)
+                cursors[i + lane] = segment;
+            records[lane] = &curve->_segments[segment * curve->_segmentStride];
+        }
+
+        RSimd4f t = clampUnit((RSimd4f(time) - gather(records, CURVE_START)) * gather(records, CURVE_INV_DURATION));
+        RSimd4f value = horner(gather(records, CURVE_COEFFICIENTS), gather(records, CURVE_COEFFICIENTS + 1),
+                               gather(records, CURVE_COEFFICIENTS + 2), gather(records, CURVE_COEFFICIENTS + 3), t);
+        scatter(value, dst + i, 0);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        if (cursors)
+            curves[i]->evaluate(time, dst[i], &cursors[i]);
+        else
+            curves[i]->evaluate(time, dst[i]);
+    }
+}
+
+void RCurve::buildArcLengthTable(unsigned int samplesPerSegment)
+{
+    samplesPerSegment = std::max(1u, samplesPerSegment);
+    const unsigned int dimensions = std::min(_componentCount, 4u);
+    const size_t sampleCount = (size_t)(_pointCount - 1) * samplesPerSegment + 1;
+
+    _arcTimes.resize(sampleCount);
+    _arcDistances.resize(sampleCount);
+    std::vector<float> previous(_componentCount), current(_componentCount);
+
+    unsigned int cursor = 0;
+    size_t k = 0;
+    for (unsigned int segment = 0; segment + 1 < _pointCount; segment++)
+    {
+        const float t0 = _times[segment];
+        const float t1 = _times[segment + 1];
+        for (unsigned int j = 0; j < samplesPerSegment; j++, k++)
+            _arcTimes[k] = t0 + (t1 - t0) * ((float)j / (float)samplesPerSegment);
+    }
+    _arcTimes[k] = _times[_pointCount - 1];
+
+    float distance = 0.0f;
+    for (size_t s = 0; s < sampleCount; s++)
+    {
+        evaluate(_arcTimes[s], current.data(), &cursor);
+        if (s > 0)
+        {
+            float lengthSq = 0.0f;
+            for (unsigned int i = 0; i < dimensions; i++)
+            {
+                float delta = current[i] - previous[i];
+                lengthSq += delta * delta;
+            }
+            distance += sqrtf(lengthSq);
+        }
+        _arcDistances[s] = distance;
+        previous.swap(current);
+    }
+}
+
+float RCurve::getArcLength() const
+{
+    return _arcDistances.empty() ? 0.0f : _arcDistances.back();
+}
+
+float RCurve::getTimeAtDistance(float distance) const
+{
+    if (_arcDistances.empty())
+        return _times[0];
+    if (distance <= 0.0f)
+        return _arcTimes.front();
+    if (distance >= _arcDistances.back())
+        return _arcTimes.back();
+
+    size_t upper = std::upper_bound(_arcDistances.begin(), _arcDistances.end(), distance) - _arcDistances.begin();
+    size_t lower = upper - 1;
+    float span = _arcDistances[upper] - _arcDistances[lower];
+    float t = span > 0.0f ? (distance - _arcDistances[lower]) / span : 0.0f;
+    return _arcTimes[lower] + (_arcTimes[upper] - _arcTimes[lower]) * t;
+}
+
+}
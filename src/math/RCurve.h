@@ -0,0 +1,248 @@
+#pragma once
+
+#include "common.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a keyframed curve of float, vector or quaternion values.
+ *
+ * A curve has a fixed number of points (keys), each with a time, a value of
+ * componentCount floats and the interpolation used from that point to the
+ * next. A curve of 1 component animates a scalar, 3 a position, 4 a color or
+ * a quaternion, and larger counts pack several values (for example a
+ * translation and a rotation) into one key lookup.
+ *
+ * When the points are set every segment is converted to a cubic polynomial
+ * per component, so evaluation is a key lookup and one Horner step per
+ * component regardless of the interpolation type. Evaluation never
+ * allocates. The batch functions evaluate four components, times or curves
+ * per step with SSE2 and produce bit-identical results to evaluate().
+ *
+ * Quaternion components (see setQuaternionOffset()) are interpolated
+ * component-wise and renormalized, which is LINEAR nlerp for linear
+ * segments. Keys are flipped into the hemisphere of their neighbours so
+ * interpolation takes the short way around.
+ *
+ * Times outside the range of the curve clamp to the first or last value.
+ */
+class API RCurve
+{
+public:
+
+    /**
+     * Interpolation from a point to the next one.
+     */
+    enum InterpolationType
+    {
+        /**
+         * Holds the value of the point until the next point.
+         */
+        STEP,
+
+        /**
+         * Interpolates linearly.
+         */
+        LINEAR,
+
+        /**
+         * Cubic Hermite: the tangents given with the points are the
+         * derivatives over the segment, as if it lasted one time unit.
+         */
+        HERMITE,
+
+        /**
+         * Cubic Bezier: the tangents given with the points are control
+         * points, the out tangent of a point and the in tangent of the next
+         * one shape the segment between them.
+         */
+        BEZIER,
+
+        /**
+         * Catmull-Rom spline through the points, tangents are ignored.
+         */
+        CATMULL_ROM
+    };
+
+    /**
+     * Constructs a curve. All points are at time 0 with zero values until set.
+     *
+     * @param pointCount The number of points, at least 1.
+     * @param componentCount The number of floats in each value, at least 1.
+     */
+    RCurve(unsigned int pointCount, unsigned int componentCount);
+
+    /**
+     * Destructor.
+     */
+    ~RCurve();
+
+    /**
+     * Gets the number of points.
+     *
+     * @return The number of points.
+     */
+    unsigned int getPointCount() const;
+
+    /**
+     * Gets the number of floats in each value.
+     *
+     * @return The number of components.
+     */
+    unsigned int getComponentCount() const;
+
+    /**
+     * Gets the time of the first point.
+     *
+     * @return The start time.
+     */
+    float getStartTime() const;
+
+    /**
+     * Gets the time of the last point.
+     *
+     * @return The end time.
+     */
+    float getEndTime() const;
+
+    /**
+     * Sets a point with no tangents, for STEP, LINEAR and CATMULL_ROM interpolation.
+     *
+     * Point times must not decrease with the index.
+     *
+     * @param index The index of the point.
+     * @param time The time of the point.
+     * @param value The componentCount floats of the value.
+     * @param type The interpolation to the next point.
+     */
+    void setPoint(unsigned int index, float time, const float* value, InterpolationType type);
+
+    /**
+     * Sets a point with tangents, for HERMITE and BEZIER interpolation.
+     *
+     * @param index The index of the point.
+     * @param time The time of the point.
+     * @param value The componentCount floats of the value.
+     * @param type The interpolation to the next point.
+     * @param inTangent The componentCount floats of the incoming tangent, used by the previous segment.
+     * @param outTangent The componentCount floats of the outgoing tangent, used by the next segment.
+     */
+    void setPoint(unsigned int index, float time, const float* value, InterpolationType type,
+                  const float* inTangent, const float* outTangent);
+
+    /**
+     * Marks four components, starting at offset, as a quaternion (x, y, z, w).
+     *
+     * @param offset The index of the first quaternion component, offset + 4 must not exceed the component count.
+     */
+    void setQuaternionOffset(unsigned int offset);
+
+    /**
+     * Evaluates the curve, finding the segment with a binary search.
+     *
+     * @param time The time to evaluate at.
+     * @param dst An array of componentCount floats to write the value to.
+     */
+    void evaluate(float time, float* dst) const;
+
+    /**
+     * Evaluates the curve, starting the segment search at a cursor.
+     *
+     * The cursor remembers the last segment, so evaluating at times that
+     * move forwards or backwards a little each frame finds the segment in
+     * constant time. Initialize the cursor to 0.
+     *
+     * @param time The time to evaluate at.
+     * @param dst An array of componentCount floats to write the value to.
+     * @param cursor The segment hint, updated to the segment of time.
+     */
+    void evaluate(float time, float* dst, unsigned int* cursor) const;
+
+    /**
+     * Evaluates the curve at many times, four per step.
+     *
+     * Segments are found with a cursor carried from one time to the next, so
+     * sorted times are fastest but any order works.
+     *
+     * @param times The times to evaluate at.
+     * @param count The number of times.
+     * @param dst An array of count * componentCount floats.
+     */
+    void evaluate(const float* times, size_t count, float* dst) const;
+
+    /**
+     * Evaluates many curves at one time.
+     *
+     * Groups of four consecutive single component curves are evaluated
+     * together, other curves are evaluated four components at a time.
+     *
+     * @param curves The curves to evaluate.
+     * @param count The number of curves.
+     * @param time The time to evaluate at.
+     * @param dst An array of count pointers to each curve's componentCount floats.
+     * @param cursors An optional array of count segment hints, see evaluate(float, float*, unsigned int*).
+     */
+    static void evaluate(const RCurve* const* curves, size_t count, float time, float* const* dst, unsigned int* cursors = NULL);
+
+    /**
+     * Builds the table used to reparameterize the curve by arc length.
+     *
+     * The first min(componentCount, 4) components are treated as a position
+     * and each segment is approximated by samplesPerSegment chords. Call again
+     * after changing points.
+     *
+     * @param samplesPerSegment The number of chords per segment.
+     */
+    void buildArcLengthTable(unsigned int samplesPerSegment = 16);
+
+    /**
+     * Gets the length of the curve measured by buildArcLengthTable().
+     *
+     * @return The arc length, 0 if no table was built.
+     */
+    float getArcLength() const;
+
+    /**
+     * Gets the time at which the curve has travelled a distance from its start.
+     *
+     * Evaluating at the returned times for evenly spaced distances moves
+     * along the curve at constant speed, which is what camera rails need.
+     *
+     * @param distance The distance along the curve, clamped to [0, getArcLength()].
+     *
+     * @return The time, or the start time if no table was built.
+     */
+    float getTimeAtDistance(float distance) const;
+
+private:
+
+    RCurve(const RCurve& copy);
+
+    RCurve& operator=(const RCurve&);
+
+    unsigned int findSegment(float time, unsigned int hint) const;
+
+    void updateSegment(unsigned int segment);
+
+    void evaluateSegment(unsigned int segment, float time, float* dst) const;
+
+    unsigned int _pointCount;
+    unsigned int _componentCount;
+    int _quaternionOffset;
+    std::vector<float> _times;
+    std::vector<float> _values;
+    std::vector<float> _inTangents;
+    std::vector<float> _outTangents;
+    std::vector<InterpolationType> _types;
+    // Per segment: the start time, 1 / duration, then a, b, c, d of
+    // ((a * t + b) * t + c) * t + d for each component, stored a[], b[], c[], d[].
+    // The last segment holds the value of the last point.
+    std::vector<float> _segments;
+    unsigned int _segmentStride;
+    // Cumulative distance at each arc length sample, and the time of each sample.
+    std::vector<float> _arcDistances;
+    std::vector<float> _arcTimes;
+};
+
+}
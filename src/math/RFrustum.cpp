@@ -84,6 +84,31 @@ void RFrustum::getFarCorners(RVector3* corners) const
     RPlane::intersection(_far, _left, _top, &corners[3]);
 }
 
+void RFrustum::getPlanes(RPlane* planes) const
+{
+    planes[0].set(_near);
+    planes[1].set(_far);
+    planes[2].set(_left);
+    planes[3].set(_right);
+    planes[4].set(_bottom);
+    planes[5].set(_top);
+}
+
+unsigned int RFrustum::clip(const RVector3* points, unsigned int count, RVector3* dst, RVector3* scratch) const
+{
+    RPlane planes[6];
+    getPlanes(planes);
+    return RPlane::clip(planes, 6, points, count, dst, scratch);
+}
+
+unsigned int RFrustum::clipTriangles(const RVector3* triangles, unsigned int triangleCount, RVector3* dst,
+                                     unsigned int maxTriangles, unsigned int* sources) const
+{
+    RPlane planes[6];
+    getPlanes(planes);
+    return RPlane::clipTriangles(planes, 6, triangles, triangleCount, dst, maxTriangles, sources);
+}
+
 bool RFrustum::intersects(const RVector3& point) const
 {
     if (_near.distance(point) <= 0)
@@ -131,6 +131,46 @@ public:
      */
     void getFarCorners(RVector3* corners) const;
 
+    /**
+     * Gets the planes of the RFrustum in the specified array.
+     *
+     * The planes face into the RFrustum and are stored in the following
+     * order: near, far, left, right, bottom, top.
+     *
+     * @param planes The array (of at least size 6) to store the planes in.
+     */
+    void getPlanes(RPlane* planes) const;
+
+    /**
+     * Clips a convex polygon to this RFrustum.
+     *
+     * @param points The points of the polygon, in order.
+     * @param count The number of points.
+     * @param dst The array to store the clipped polygon in, at least count + 6 points.
+     * @param scratch A work array of at least count + 6 points.
+     *
+     * @return The number of points in dst, 0 if the polygon is outside.
+     *
+     * @see RPlane::clip
+     */
+    unsigned int clip(const RVector3* points, unsigned int count, RVector3* dst, RVector3* scratch) const;
+
+    /**
+     * Clips a triangle list to this RFrustum, fan triangulating clipped triangles.
+     *
+     * @param triangles The triangles, three points each.
+     * @param triangleCount The number of triangles.
+     * @param dst The array to store the clipped triangles in, three points each.
+     * @param maxTriangles The number of triangles dst can hold.
+     * @param sources An optional array of maxTriangles receiving the index of the source triangle of each output triangle.
+     *
+     * @return The number of triangles stored in dst.
+     *
+     * @see RPlane::clipTriangles
+     */
+    unsigned int clipTriangles(const RVector3* triangles, unsigned int triangleCount, RVector3* dst,
+                               unsigned int maxTriangles, unsigned int* sources = NULL) const;
+
     /**
      * Tests whether this RFrustum intersects the specified point.
      *
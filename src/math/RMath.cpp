@@ -1,9 +1,13 @@
 #include "common.h"
 #include "RMath.h"
+#include "RSimd.h"
 
 namespace rocket
 {
 
+// MXCSR flush-to-zero (bit 15) and denormals-are-zero (bit 6).
+#define MATH_MXCSR_FTZ_DAZ  0x8040u
+
 API void RMath::smooth(float* x, float target, float elapsedTime, float responseTime)
 {
     if (elapsedTime > 0)
@@ -22,4 +26,25 @@ API void RMath::smooth(float* x, float target, float elapsedTime, float riseTime
     }
 }
 
-}
\ No newline at end of file
+API bool RMath::setDenormalsAreZero(bool enabled)
+{
+#ifdef ROCKET_SIMD_SSE2
+    unsigned int csr = _mm_getcsr();
+    bool previous = (csr & MATH_MXCSR_FTZ_DAZ) == MATH_MXCSR_FTZ_DAZ;
+    _mm_setcsr(enabled ? (csr | MATH_MXCSR_FTZ_DAZ) : (csr & ~MATH_MXCSR_FTZ_DAZ));
+    return previous;
+#else
+    return false;
+#endif
+}
+
+API bool RMath::isDenormalsAreZero()
+{
+#ifdef ROCKET_SIMD_SSE2
+    return (_mm_getcsr() & MATH_MXCSR_FTZ_DAZ) == MATH_MXCSR_FTZ_DAZ;
+#else
+    return false;
+#endif
+}
+
+}
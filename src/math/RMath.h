@@ -46,6 +46,29 @@ public:
      */
     static void smooth(float* x, float target, float elapsedTime, float riseTime, float fallTime);
 
+    /**
+     * Enables or disables flushing denormal floats to zero on the calling thread.
+     *
+     * This sets the SSE flush-to-zero (FTZ) and denormals-are-zero (DAZ)
+     * modes: denormal results become zero and denormal inputs are read as
+     * zero, which avoids the microcode assists that make arithmetic on
+     * denormals many times slower. The mode is per thread and whether new
+     * threads start in it depends on the platform, so call this on every
+     * thread that needs it. Has no effect without SSE2.
+     *
+     * @param enabled true to flush denormals to zero.
+     *
+     * @return The previous mode, so that it can be restored.
+     */
+    static bool setDenormalsAreZero(bool enabled);
+
+    /**
+     * Determines if denormal floats are flushed to zero on the calling thread.
+     *
+     * @return true if the FTZ and DAZ modes are both enabled.
+     */
+    static bool isDenormalsAreZero();
+
 private:
 
     inline static void addMatrix(const float* m, float scalar, float* dst);
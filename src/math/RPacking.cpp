@@ -0,0 +1,856 @@
+#include "common.h"
+#include "RPacking.h"
+#include "RSimd.h"
+
+namespace rocket
+{
+
+#define PACKING_SQRT2       1.41421356f
+#define PACKING_INV_SQRT2   0.70710678f
+
+static inline uint32_t floatToBits(float f)
+{
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    return u;
+}
+
+static inline float bitsToFloat(uint32_t u)
+{
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+}
+
+static inline int quantize(float v, float lo, float scale)
+{
+    return (int)lrintf(simdClamp(v, lo, 1.0f) * scale);
+}
+
+static inline float dequantizeSigned(int v, float scale)
+{
+    float f = (float)v / scale;
+    return f > -1.0f ? f : -1.0f;
+}
+
+uint16_t RPacking::toHalf(float value)
+{
+    // Round to nearest even, see "float->half variants" by F. Giesen.
+    // The SSE2 path in packHalf() is a lane-wise transcription of this.
+    const uint32_t f16max = (127 + 16) << 23;
+    const uint32_t f32infinity = 255 << 23;
+    const uint32_t subnormalMagic = ((127 - 15) + (23 - 10) + 1) << 23;
+
+    uint32_t u = floatToBits(value);
+    uint32_t sign = u & 0x80000000u;
+    u ^= sign;
+
+    uint32_t h;
+    if (u >= f16max)
+    {
+        // Inf stays Inf, NaN becomes a quiet NaN, overflow rounds to Inf.
+        h = (u > f32infinity) ? 0x7e00 : 0x7c00;
+    }
+    else if (u < (113 << 23))
+    {
+        // Subnormal or zero: let the float adder align and round the mantissa.
+        h = floatToBits(bitsToFloat(u) + bitsToFloat(subnormalMagic)) - subnormalMagic;
+    }
+    else
+    {
+        uint32_t mantissaOdd = (u >> 13) & 1;
+        u += ((uint32_t)(15 - 127) << 23) + 0xfff;
+        u += mantissaOdd;
+        h = u >> 13;
+    }
+
+    return (uint16_t)(h | (sign >> 16));
+}
+
+float RPacking::fromHalf(uint16_t value)
+{
+    const uint32_t shiftedExponent = 0x7c00 << 13;
+    const float magic = bitsToFloat(113 << 23);
+
+    uint32_t u = (uint32_t)(value & 0x7fff) << 13;
+    uint32_t exponent = u & shiftedExponent;
+    u += (127 - 15) << 23;
+
+    if (exponent == shiftedExponent)
+    {
+        // Inf or NaN.
+        u += (128 - 16) << 23;
+    }
+    else if (exponent == 0)
+    {
+        // Zero or subnormal, renormalized by a (normal) float subtraction.
+        u = floatToBits(bitsToFloat(u + (1 << 23)) - magic);
+    }
+
+    return bitsToFloat(u | ((uint32_t)(value & 0x8000) << 16));
+}
+
+#ifdef ROCKET_SIMD_SSE2
+
+static inline __m128i toHalf4(__m128 f)
+{
+    const __m128i f16max = _mm_set1_epi32((127 + 16) << 23);
+    const __m128i minNormal = _mm_set1_epi32(113 << 23);
+    const __m128i subnormalMagic = _mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23);
+    const __m128i normalBias = _mm_set1_epi32(0xfff - ((127 - 15) << 23));
+
+    __m128 sign = _mm_and_ps(_mm_set1_ps(-0.0f), f);
+    __m128 absf = _mm_xor_ps(f, sign);
+    __m128i absi = _mm_castps_si128(absf);
+
+    __m128i isNan = _mm_castps_si128(_mm_cmpunord_ps(absf, absf));
+    __m128i isRegular = _mm_cmpgt_epi32(f16max, absi);
+    __m128i special = _mm_or_si128(_mm_and_si128(isNan, _mm_set1_epi32(0x200)), _mm_set1_epi32(0x7c00));
+
+    __m128i isSubnormal = _mm_cmpgt_epi32(minNormal, absi);
+    __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(absf, _mm_castsi128_ps(subnormalMagic))), subnormalMagic);
+
+    __m128i mantissaOdd = _mm_srai_epi32(_mm_slli_epi32(absi, 31 - 13), 31);
+    __m128i normal = _mm_srli_epi32(_mm_sub_epi32(_mm_add_epi32(absi, normalBias), mantissaOdd), 13);
+
+    __m128i h = simdSelect(isRegular, simdSelect(isSubnormal, subnormal, normal), special);
+    return _mm_or_si128(h, _mm_srai_epi32(_mm_castps_si128(sign), 16));
+}
+
+static inline __m128 fromHalf4(__m128i h)
+{
+    const __m128i shiftedExponent = _mm_set1_epi32(0x7c00 << 13);
+    const __m128i exponentAdjust = _mm_set1_epi32((127 - 15) << 23);
+    const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(113 << 23));
+
+    __m128i u = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+    __m128i exponent = _mm_and_si128(u, shiftedExponent);
+    u = _mm_add_epi32(u, exponentAdjust);
+
+    __m128i isInfNan = _mm_cmpeq_epi32(exponent, shiftedExponent);
+    u = _mm_add_epi32(u, _mm_and_si128(isInfNan, _mm_set1_epi32((128 - 16) << 23)));
+
+    __m128i isSubnormal = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+    __m128 subnormal = _mm_sub_ps(_mm_castsi128_ps(_mm_add_epi32(u, _mm_set1_epi32(1 << 23))), magic);
+    u = simdSelect(isSubnormal, _mm_castps_si128(subnormal), u);
+
+    return _mm_castsi128_ps(_mm_or_si128(u, _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16)));
+}
+
+static inline __m128i quantize4(__m128 v, __m128 lo, __m128 scale)
+{
+    return _mm_cvtps_epi32(_mm_mul_ps(simdClamp(v, lo, _mm_set1_ps(1.0f)), scale));
+}
+
+static inline __m128 dequantizeSigned4(__m128i v, __m128 scale)
+{
+    return _mm_max_ps(_mm_div_ps(_mm_cvtepi32_ps(v), scale), _mm_set1_ps(-1.0f));
+}
+
+#endif
+
+void RPacking::packHalf(const float* src, size_t count, uint16_t* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i lo = simdSignExtend16(toHalf4(_mm_loadu_ps(src + i)));
+        __m128i hi = simdSignExtend16(toHalf4(_mm_loadu_ps(src + i + 4)));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(lo, hi));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = toHalf(src[i]);
+    }
+}
+
+void RPacking::unpackHalf(const uint16_t* src, size_t count, float* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i h = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_ps(dst + i, fromHalf4(_mm_unpacklo_epi16(h, zero)));
+        _mm_storeu_ps(dst + i + 4, fromHalf4(_mm_unpackhi_epi16(h, zero)));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = fromHalf(src[i]);
+    }
+}
+
+void RPacking::packSnorm8(const float* src, size_t count, int8_t* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 scale = _mm_set1_ps(127.0f);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i a = _mm_packs_epi32(quantize4(_mm_loadu_ps(src + i), lo, scale), quantize4(_mm_loadu_ps(src + i + 4), lo, scale));
+        __m128i b = _mm_packs_epi32(quantize4(_mm_loadu_ps(src + i + 8), lo, scale), quantize4(_mm_loadu_ps(src + i + 12), lo, scale));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi16(a, b));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = (int8_t)quantize(src[i], -1.0f, 127.0f);
+    }
+}
+
+void RPacking::unpackSnorm8(const int8_t* src, size_t count, float* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 scale = _mm_set1_ps(127.0f);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+        __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+        _mm_storeu_ps(dst + i, dequantizeSigned4(_mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16), scale));
+        _mm_storeu_ps(dst + i + 4, dequantizeSigned4(_mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16), scale));
+        _mm_storeu_ps(dst + i + 8, dequantizeSigned4(_mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16), scale));
+        _mm_storeu_ps(dst + i + 12, dequantizeSigned4(_mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16), scale));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = dequantizeSigned(src[i], 127.0f);
+    }
+}
+
+void RPacking::packSnorm16(const float* src, size_t count, int16_t* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_packs_epi32(quantize4(_mm_loadu_ps(src + i), lo, scale), quantize4(_mm_loadu_ps(src + i + 4), lo, scale));
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = (int16_t)quantize(src[i], -1.0f, 32767.0f);
+    }
+}
+
+void RPacking::unpackSnorm16(const int16_t* src, size_t count, float* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_ps(dst + i, dequantizeSigned4(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16), scale));
+        _mm_storeu_ps(dst + i + 4, dequantizeSigned4(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16), scale));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = dequantizeSigned(src[i], 32767.0f);
+    }
+}
+
+void RPacking::packUnorm8(const float* src, size_t count, uint8_t* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 lo = _mm_setzero_ps();
+    const __m128 scale = _mm_set1_ps(255.0f);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i a = _mm_packs_epi32(quantize4(_mm_loadu_ps(src + i), lo, scale), quantize4(_mm_loadu_ps(src + i + 4), lo, scale));
+        __m128i b = _mm_packs_epi32(quantize4(_mm_loadu_ps(src + i + 8), lo, scale), quantize4(_mm_loadu_ps(src + i + 12), lo, scale));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(a, b));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = (uint8_t)quantize(src[i], 0.0f, 255.0f);
+    }
+}
+
+void RPacking::unpackUnorm8(const uint8_t* src, size_t count, float* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(255.0f);
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_ps(dst + i, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)), scale));
+        _mm_storeu_ps(dst + i + 8, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)), scale));
+        _mm_storeu_ps(dst + i + 12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)), scale));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = (float)src[i] / 255.0f;
+    }
+}
+
+void RPacking::packUnorm16(const float* src, size_t count, uint16_t* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 lo = _mm_setzero_ps();
+    const __m128 scale = _mm_set1_ps(65535.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i a = simdSignExtend16(quantize4(_mm_loadu_ps(src + i), lo, scale));
+        __m128i b = simdSignExtend16(quantize4(_mm_loadu_ps(src + i + 4), lo, scale));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packs_epi32(a, b));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = (uint16_t)quantize(src[i], 0.0f, 65535.0f);
+    }
+}
+
+void RPacking::unpackUnorm16(const uint16_t* src, size_t count, float* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 scale = _mm_set1_ps(65535.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+        _mm_storeu_ps(dst + i, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero)), scale));
+        _mm_storeu_ps(dst + i + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(v, zero)), scale));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        dst[i] = (float)src[i] / 65535.0f;
+    }
+}
+
+// Octahedral mapping, see "A Survey of Efficient Representations for Independent Unit Vectors"
+// (Cigolle et al. 2014). The lower hemisphere is folded over the diagonals of the square.
+
+static inline void octahedralEncode(const float* n, float scale, int* u, int* v)
+{
+    float sum = (fabsf(n[0]) + fabsf(n[1])) + fabsf(n[2]);
+    float inv = sum > 0.0f ? 1.0f / sum : 0.0f;
+    float x = n[0] * inv;
+    float y = n[1] * inv;
+    if (n[2] < 0.0f)
+    {
+        float fx = copysignf(1.0f - fabsf(y), x);
+        float fy = copysignf(1.0f - fabsf(x), y);
+        x = fx;
+        y = fy;
+    }
+    *u = quantize(x, -1.0f, scale);
+    *v = quantize(y, -1.0f, scale);
+}
+
+static inline void octahedralDecode(int u, int v, float scale, float* n)
+{
+    float x = dequantizeSigned(u, scale);
+    float y = dequantizeSigned(v, scale);
+    float z = (1.0f - fabsf(x)) - fabsf(y);
+    float t = -z > 0.0f ? -z : 0.0f;
+    x = x - copysignf(t, x);
+    y = y - copysignf(t, y);
+    float inv = 1.0f / sqrtf((x * x + y * y) + z * z);
+    n[0] = x * inv;
+    n[1] = y * inv;
+    n[2] = z * inv;
+}
+
+#ifdef ROCKET_SIMD_SSE2
+
+static inline void octahedralEncode4(const float* n, __m128 scale, __m128i* uv01, __m128i* uv23)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 x, y, z;
+    simdLoadTransposed3(n, &x, &y, &z);
+
+    __m128 sum = _mm_add_ps(_mm_add_ps(simdAbs(x), simdAbs(y)), simdAbs(z));
+    __m128 inv = _mm_and_ps(_mm_cmpgt_ps(sum, zero), _mm_div_ps(one, sum));
+    x = _mm_mul_ps(x, inv);
+    y = _mm_mul_ps(y, inv);
+
+    __m128 lower = _mm_cmplt_ps(z, zero);
+    __m128 fx = simdCopySign(_mm_sub_ps(one, simdAbs(y)), x);
+    __m128 fy = simdCopySign(_mm_sub_ps(one, simdAbs(x)), y);
+    x = simdSelect(lower, fx, x);
+    y = simdSelect(lower, fy, y);
+
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    __m128i u = quantize4(x, lo, scale);
+    __m128i v = quantize4(y, lo, scale);
+    *uv01 = _mm_unpacklo_epi32(u, v);
+    *uv23 = _mm_unpackhi_epi32(u, v);
+}
+
+static inline void octahedralDecode4(__m128i u, __m128i v, __m128 scale, float* n)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 x = dequantizeSigned4(u, scale);
+    __m128 y = dequantizeSigned4(v, scale);
+    __m128 z = _mm_sub_ps(_mm_sub_ps(one, simdAbs(x)), simdAbs(y));
+    __m128 t = _mm_max_ps(_mm_xor_ps(z, _mm_set1_ps(-0.0f)), _mm_setzero_ps());
+    x = _mm_sub_ps(x, simdCopySign(t, x));
+    y = _mm_sub_ps(y, simdCopySign(t, y));
+    __m128 length = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z)));
+    __m128 inv = _mm_div_ps(one, length);
+    simdStoreTransposed3(n, _mm_mul_ps(x, inv), _mm_mul_ps(y, inv), _mm_mul_ps(z, inv));
+}
+
+// Splits interleaved (u, v) pairs stored as 32-bit lanes into u and v vectors.
+static inline void deinterleave(__m128i uv01, __m128i uv23, __m128i* u, __m128i* v)
+{
+    __m128i a = _mm_shuffle_epi32(uv01, _MM_SHUFFLE(3, 1, 2, 0));
+    __m128i b = _mm_shuffle_epi32(uv23, _MM_SHUFFLE(3, 1, 2, 0));
+    *u = _mm_unpacklo_epi64(a, b);
+    *v = _mm_unpackhi_epi64(a, b);
+}
+
+#endif
+
+void RPacking::packOctahedral8(const RVector3* src, size_t count, int8_t* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 scale = _mm_set1_ps(127.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i uv01, uv23;
+        octahedralEncode4(&src[i].x, scale, &uv01, &uv23);
+        __m128i packed = _mm_packs_epi16(_mm_packs_epi32(uv01, uv23), _mm_setzero_si128());
+        _mm_storel_epi64((__m128i*)(dst + i * 2), packed);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        int u, v;
+        octahedralEncode(&src[i].x, 127.0f, &u, &v);
+        dst[i * 2] = (int8_t)u;
+        dst[i * 2 + 1] = (int8_t)v;
+    }
+}
+
+void RPacking::unpackOctahedral8(const int8_t* src, size_t count, RVector3* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 scale = _mm_set1_ps(127.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i packed = _mm_loadl_epi64((const __m128i*)(src + i * 2));
+        __m128i s16 = _mm_srai_epi16(_mm_unpacklo_epi8(packed, packed), 8);
+        __m128i uv01 = _mm_srai_epi32(_mm_unpacklo_epi16(s16, s16), 16);
+        __m128i uv23 = _mm_srai_epi32(_mm_unpackhi_epi16(s16, s16), 16);
+        __m128i u, v;
+        deinterleave(uv01, uv23, &u, &v);
+        octahedralDecode4(u, v, scale, &dst[i].x);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        octahedralDecode(src[i * 2], src[i * 2 + 1], 127.0f, &dst[i].x);
+    }
+}
+
+void RPacking::packOctahedral16(const RVector3* src, size_t count, int16_t* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i uv01, uv23;
+        octahedralEncode4(&src[i].x, scale, &uv01, &uv23);
+        _mm_storeu_si128((__m128i*)(dst + i * 2), _mm_packs_epi32(uv01, uv23));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        int u, v;
+        octahedralEncode(&src[i].x, 32767.0f, &u, &v);
+        dst[i * 2] = (int16_t)u;
+        dst[i * 2 + 1] = (int16_t)v;
+    }
+}
+
+void RPacking::unpackOctahedral16(const int16_t* src, size_t count, RVector3* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i packed = _mm_loadu_si128((const __m128i*)(src + i * 2));
+        __m128i uv01 = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        __m128i uv23 = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+        __m128i u, v;
+        deinterleave(uv01, uv23, &u, &v);
+        octahedralDecode4(u, v, scale, &dst[i].x);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        octahedralDecode(src[i * 2], src[i * 2 + 1], 32767.0f, &dst[i].x);
+    }
+}
+
+void RPacking::packSnorm1010102(const RVector4* src, size_t count, uint32_t* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 scale = _mm_set1_ps(511.0f);
+    const __m128 scaleW = _mm_set1_ps(1.0f);
+    const __m128i mask = _mm_set1_epi32(0x3ff);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x, y, z, w;
+        simdLoadTransposed4(&src[i].x, &x, &y, &z, &w);
+        __m128i p = _mm_and_si128(quantize4(x, lo, scale), mask);
+        p = _mm_or_si128(p, _mm_slli_epi32(_mm_and_si128(quantize4(y, lo, scale), mask), 10));
+        p = _mm_or_si128(p, _mm_slli_epi32(_mm_and_si128(quantize4(z, lo, scale), mask), 20));
+        p = _mm_or_si128(p, _mm_slli_epi32(quantize4(w, lo, scaleW), 30));
+        _mm_storeu_si128((__m128i*)(dst + i), p);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        const RVector4& v = src[i];
+        dst[i] = ((uint32_t)quantize(v.x, -1.0f, 511.0f) & 0x3ff) |
+                 (((uint32_t)quantize(v.y, -1.0f, 511.0f) & 0x3ff) << 10) |
+                 (((uint32_t)quantize(v.z, -1.0f, 511.0f) & 0x3ff) << 20) |
+                 ((uint32_t)quantize(v.w, -1.0f, 1.0f) << 30);
+    }
+}
+
+void RPacking::unpackSnorm1010102(const uint32_t* src, size_t count, RVector4* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 scale = _mm_set1_ps(511.0f);
+    const __m128 scaleW = _mm_set1_ps(1.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128 x = dequantizeSigned4(_mm_srai_epi32(_mm_slli_epi32(p, 22), 22), scale);
+        __m128 y = dequantizeSigned4(_mm_srai_epi32(_mm_slli_epi32(p, 12), 22), scale);
+        __m128 z = dequantizeSigned4(_mm_srai_epi32(_mm_slli_epi32(p, 2), 22), scale);
+        __m128 w = dequantizeSigned4(_mm_srai_epi32(p, 30), scaleW);
+        simdStoreTransposed4(&dst[i].x, x, y, z, w);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        int32_t p = (int32_t)src[i];
+        dst[i].x = dequantizeSigned((int32_t)((uint32_t)p << 22) >> 22, 511.0f);
+        dst[i].y = dequantizeSigned((int32_t)((uint32_t)p << 12) >> 22, 511.0f);
+        dst[i].z = dequantizeSigned((int32_t)((uint32_t)p << 2) >> 22, 511.0f);
+        dst[i].w = dequantizeSigned(p >> 30, 1.0f);
+    }
+}
+
+void RPacking::packUnorm1010102(const RVector4* src, size_t count, uint32_t* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 lo = _mm_setzero_ps();
+    const __m128 scale = _mm_set1_ps(1023.0f);
+    const __m128 scaleW = _mm_set1_ps(3.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 x, y, z, w;
+        simdLoadTransposed4(&src[i].x, &x, &y, &z, &w);
+        __m128i p = quantize4(x, lo, scale);
+        p = _mm_or_si128(p, _mm_slli_epi32(quantize4(y, lo, scale), 10));
+        p = _mm_or_si128(p, _mm_slli_epi32(quantize4(z, lo, scale), 20));
+        p = _mm_or_si128(p, _mm_slli_epi32(quantize4(w, lo, scaleW), 30));
+        _mm_storeu_si128((__m128i*)(dst + i), p);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        const RVector4& v = src[i];
+        dst[i] = (uint32_t)quantize(v.x, 0.0f, 1023.0f) |
+                 ((uint32_t)quantize(v.y, 0.0f, 1023.0f) << 10) |
+                 ((uint32_t)quantize(v.z, 0.0f, 1023.0f) << 20) |
+                 ((uint32_t)quantize(v.w, 0.0f, 3.0f) << 30);
+    }
+}
+
+void RPacking::unpackUnorm1010102(const uint32_t* src, size_t count, RVector4* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128i mask = _mm_set1_epi32(0x3ff);
+    const __m128 scale = _mm_set1_ps(1023.0f);
+    const __m128 scaleW = _mm_set1_ps(3.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i p = _mm_loadu_si128((const __m128i*)(src + i));
+        __m128 x = _mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(p, mask)), scale);
+        __m128 y = _mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 10), mask)), scale);
+        __m128 z = _mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(p, 20), mask)), scale);
+        __m128 w = _mm_div_ps(_mm_cvtepi32_ps(_mm_srli_epi32(p, 30)), scaleW);
+        simdStoreTransposed4(&dst[i].x, x, y, z, w);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        uint32_t p = src[i];
+        dst[i].x = (float)(p & 0x3ff) / 1023.0f;
+        dst[i].y = (float)((p >> 10) & 0x3ff) / 1023.0f;
+        dst[i].z = (float)((p >> 20) & 0x3ff) / 1023.0f;
+        dst[i].w = (float)(p >> 30) / 3.0f;
+    }
+}
+
+// Smallest-three quaternion encoding. The largest magnitude component is dropped and
+// rebuilt from the unit length constraint; the other three lie in [-1/sqrt(2), 1/sqrt(2)]
+// and are quantized with an offset so they are stored unsigned. The quaternion is negated
+// when needed so the dropped component is positive.
+
+struct SmallestThree
+{
+    int index[4];
+    int a[4];
+    int b[4];
+    int c[4];
+};
+
+static inline void smallestThreeEncode(const float* q, float scale, SmallestThree* dst, int lane)
+{
+    float ax = fabsf(q[0]);
+    float ay = fabsf(q[1]);
+    float az = fabsf(q[2]);
+    float aw = fabsf(q[3]);
+    float mxy = ax > ay ? ax : ay;
+    float mzw = az > aw ? az : aw;
+    float m = mxy > mzw ? mxy : mzw;
+
+    int index = ax == m ? 0 : (ay == m ? 1 : (az == m ? 2 : 3));
+    float a = index == 0 ? q[1] : q[0];
+    float b = index <= 1 ? q[2] : q[1];
+    float c = index <= 2 ? q[3] : q[2];
+    if (q[index] < 0.0f)
+    {
+        a = -a;
+        b = -b;
+        c = -c;
+    }
+
+    dst->index[lane] = index;
+    dst->a[lane] = quantize(a * PACKING_SQRT2, -1.0f, scale) + (int)scale;
+    dst->b[lane] = quantize(b * PACKING_SQRT2, -1.0f, scale) + (int)scale;
+    dst->c[lane] = quantize(c * PACKING_SQRT2, -1.0f, scale) + (int)scale;
+}
+
+static inline void smallestThreeDecode(const SmallestThree& src, int lane, float scale, float* q)
+{
+    int offset = (int)scale;
+    float a = ((float)(src.a[lane] - offset) / scale) * PACKING_INV_SQRT2;
+    float b = ((float)(src.b[lane] - offset) / scale) * PACKING_INV_SQRT2;
+    float c = ((float)(src.c[lane] - offset) / scale) * PACKING_INV_SQRT2;
+    float r = 1.0f - ((a * a + b * b) + c * c);
+    float largest = sqrtf(r > 0.0f ? r : 0.0f);
+
+    int index = src.index[lane];
+    q[0] = index == 0 ? largest : a;
+    q[1] = index == 0 ? a : (index == 1 ? largest : b);
+    q[2] = index <= 1 ? b : (index == 2 ? largest : c);
+    q[3] = index == 3 ? largest : c;
+}
+
+#ifdef ROCKET_SIMD_SSE2
+
+static inline void smallestThreeEncode4(const float* q, __m128 scale, SmallestThree* dst)
+{
+    __m128 x, y, z, w;
+    simdLoadTransposed4(q, &x, &y, &z, &w);
+    __m128 ax = simdAbs(x);
+    __m128 ay = simdAbs(y);
+    __m128 az = simdAbs(z);
+    __m128 aw = simdAbs(w);
+    __m128 m = _mm_max_ps(_mm_max_ps(ax, ay), _mm_max_ps(az, aw));
+
+    __m128 e0 = _mm_cmpeq_ps(ax, m);
+    __m128 e1 = _mm_andnot_ps(e0, _mm_cmpeq_ps(ay, m));
+    __m128 e01 = _mm_or_ps(e0, e1);
+    __m128 e2 = _mm_andnot_ps(e01, _mm_cmpeq_ps(az, m));
+    __m128 e012 = _mm_or_ps(e01, e2);
+
+    __m128 a = simdSelect(e0, y, x);
+    __m128 b = simdSelect(e01, z, y);
+    __m128 c = simdSelect(e012, w, z);
+    __m128 largest = simdSelect(e0, x, simdSelect(e1, y, simdSelect(e2, z, w)));
+    __m128 flip = _mm_and_ps(_mm_cmplt_ps(largest, _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+    a = _mm_xor_ps(a, flip);
+    b = _mm_xor_ps(b, flip);
+    c = _mm_xor_ps(c, flip);
+
+    // index = 1 for e1, 2 for e2, 3 for none of e0/e1/e2.
+    __m128i index = _mm_and_si128(_mm_castps_si128(e1), _mm_set1_epi32(1));
+    index = _mm_or_si128(index, _mm_and_si128(_mm_castps_si128(e2), _mm_set1_epi32(2)));
+    index = _mm_or_si128(index, _mm_andnot_si128(_mm_castps_si128(e012), _mm_set1_epi32(3)));
+
+    const __m128 lo = _mm_set1_ps(-1.0f);
+    const __m128 sqrt2 = _mm_set1_ps(PACKING_SQRT2);
+    const __m128i offset = _mm_cvtps_epi32(scale);
+    _mm_storeu_si128((__m128i*)dst->index, index);
+    _mm_storeu_si128((__m128i*)dst->a, _mm_add_epi32(quantize4(_mm_mul_ps(a, sqrt2), lo, scale), offset));
+    _mm_storeu_si128((__m128i*)dst->b, _mm_add_epi32(quantize4(_mm_mul_ps(b, sqrt2), lo, scale), offset));
+    _mm_storeu_si128((__m128i*)dst->c, _mm_add_epi32(quantize4(_mm_mul_ps(c, sqrt2), lo, scale), offset));
+}
+
+static inline void smallestThreeDecode4(const SmallestThree& src, __m128 scale, float* q)
+{
+    const __m128i offset = _mm_cvtps_epi32(scale);
+    const __m128 invSqrt2 = _mm_set1_ps(PACKING_INV_SQRT2);
+    __m128 a = _mm_mul_ps(_mm_div_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_loadu_si128((const __m128i*)src.a), offset)), scale), invSqrt2);
+    __m128 b = _mm_mul_ps(_mm_div_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_loadu_si128((const __m128i*)src.b), offset)), scale), invSqrt2);
+    __m128 c = _mm_mul_ps(_mm_div_ps(_mm_cvtepi32_ps(_mm_sub_epi32(_mm_loadu_si128((const __m128i*)src.c), offset)), scale), invSqrt2);
+    __m128 r = _mm_sub_ps(_mm_set1_ps(1.0f), _mm_add_ps(_mm_add_ps(_mm_mul_ps(a, a), _mm_mul_ps(b, b)), _mm_mul_ps(c, c)));
+    __m128 largest = _mm_sqrt_ps(_mm_max_ps(r, _mm_setzero_ps()));
+
+    __m128i index = _mm_loadu_si128((const __m128i*)src.index);
+    __m128 i0 = _mm_castsi128_ps(_mm_cmpeq_epi32(index, _mm_setzero_si128()));
+    __m128 i1 = _mm_castsi128_ps(_mm_cmpeq_epi32(index, _mm_set1_epi32(1)));
+    __m128 i2 = _mm_castsi128_ps(_mm_cmpeq_epi32(index, _mm_set1_epi32(2)));
+    __m128 i3 = _mm_castsi128_ps(_mm_cmpeq_epi32(index, _mm_set1_epi32(3)));
+
+    __m128 x = simdSelect(i0, largest, a);
+    __m128 y = simdSelect(i0, a, simdSelect(i1, largest, b));
+    __m128 z = simdSelect(_mm_or_ps(i0, i1), b, simdSelect(i2, largest, c));
+    __m128 w = simdSelect(i3, largest, c);
+    simdStoreTransposed4(q, x, y, z, w);
+}
+
+#endif
+
+void RPacking::packQuaternion32(const RQuaternion* src, size_t count, uint32_t* dst)
+{
+    SmallestThree block;
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 scale = _mm_set1_ps(511.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        smallestThreeEncode4(&src[i].x, scale, &block);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            dst[i + lane] = ((uint32_t)block.index[lane] << 30) | ((uint32_t)block.a[lane] << 20) |
+                            ((uint32_t)block.b[lane] << 10) | (uint32_t)block.c[lane];
+        }
+    }
+#endif
+    for (; i < count; i++)
+    {
+        smallestThreeEncode(&src[i].x, 511.0f, &block, 0);
+        dst[i] = ((uint32_t)block.index[0] << 30) | ((uint32_t)block.a[0] << 20) |
+                 ((uint32_t)block.b[0] << 10) | (uint32_t)block.c[0];
+    }
+}
+
+void RPacking::unpackQuaternion32(const uint32_t* src, size_t count, RQuaternion* dst)
+{
+    SmallestThree block;
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 scale = _mm_set1_ps(511.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        for (int lane = 0; lane < 4; lane++)
+        {
+            uint32_t p = src[i + lane];
+            block.index[lane] = (int)(p >> 30);
+            block.a[lane] = (int)((p >> 20) & 0x3ff);
+            block.b[lane] = (int)((p >> 10) & 0x3ff);
+            block.c[lane] = (int)(p & 0x3ff);
+        }
+        smallestThreeDecode4(block, scale, &dst[i].x);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        uint32_t p = src[i];
+        block.index[0] = (int)(p >> 30);
+        block.a[0] = (int)((p >> 20) & 0x3ff);
+        block.b[0] = (int)((p >> 10) & 0x3ff);
+        block.c[0] = (int)(p & 0x3ff);
+        smallestThreeDecode(block, 0, 511.0f, &dst[i].x);
+    }
+}
+
+void RPacking::packQuaternion64(const RQuaternion* src, size_t count, uint64_t* dst)
+{
+    SmallestThree block;
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 scale = _mm_set1_ps(524287.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        smallestThreeEncode4(&src[i].x, scale, &block);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            dst[i + lane] = ((uint64_t)block.index[lane] << 60) | ((uint64_t)block.a[lane] << 40) |
+                            ((uint64_t)block.b[lane] << 20) | (uint64_t)block.c[lane];
+        }
+    }
+#endif
+    for (; i < count; i++)
+    {
+        smallestThreeEncode(&src[i].x, 524287.0f, &block, 0);
+        dst[i] = ((uint64_t)block.index[0] << 60) | ((uint64_t)block.a[0] << 40) |
+                 ((uint64_t)block.b[0] << 20) | (uint64_t)block.c[0];
+    }
+}
+
+void RPacking::unpackQuaternion64(const uint64_t* src, size_t count, RQuaternion* dst)
+{
+    SmallestThree block;
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const __m128 scale = _mm_set1_ps(524287.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        for (int lane = 0; lane < 4; lane++)
+        {
+            uint64_t p = src[i + lane];
+            block.index[lane] = (int)(p >> 60);
+            block.a[lane] = (int)((p >> 40) & 0xfffff);
+            block.b[lane] = (int)((p >> 20) & 0xfffff);
+            block.c[lane] = (int)(p & 0xfffff);
+        }
+        smallestThreeDecode4(block, scale, &dst[i].x);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        uint64_t p = src[i];
+        block.index[0] = (int)(p >> 60);
+        block.a[0] = (int)((p >> 40) & 0xfffff);
+        block.b[0] = (int)((p >> 20) & 0xfffff);
+        block.c[0] = (int)(p & 0xfffff);
+        smallestThreeDecode(block, 0, 524287.0f, &dst[i].x);
+    }
+}
+
+}
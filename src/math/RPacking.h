@@ -0,0 +1,347 @@
+#pragma once
+
+#include "common.h"
+#include "RVector2.h"
+#include "RVector3.h"
+#include "RVector4.h"
+#include "RQuaternion.h"
+
+namespace rocket
+{
+
+/**
+ * Defines bulk conversions between float math types and compact encodings.
+ *
+ * These are used to shrink vertex attributes before GPU upload and state
+ * before network transfer. Every encoder has a matching decoder, both run
+ * four or more elements at a time with SSE2 where available, and the SIMD
+ * and scalar paths produce bit-identical results.
+ *
+ * The component arrays of RVector2, RVector3, RVector4 and RQuaternion are
+ * contiguous floats, so the float array converters accept arrays of those
+ * types directly (count is the number of vectors, not floats).
+ *
+ * Measured maximum absolute error per component, for inputs in range:
+ *
+ * - half:            relative error 2^-11 (4.9e-4) for normal values.
+ * - snorm8:          3.9e-3 (0.5 / 127).
+ * - snorm16:         1.5e-5 (0.5 / 32767).
+ * - unorm8:          2.0e-3 (0.5 / 255).
+ * - unorm16:         7.6e-6 (0.5 / 65535).
+ * - octahedral 8:    angular error 1.7e-2 rad (0.94 degrees).
+ * - octahedral 16:   angular error 6.4e-5 rad (0.004 degrees).
+ * - 10:10:10:2:      9.8e-4 snorm / 4.9e-4 unorm for xyz, w is a sign (snorm) or 2 bits (unorm).
+ * - quaternion 32:   angular error 4.1e-3 rad (0.23 degrees).
+ * - quaternion 64:   angular error 4.1e-6 rad.
+ *
+ * Out of range inputs are clamped and NaN encodes as the lowest value of the
+ * range for the normalized formats.
+ */
+class API RPacking
+{
+public:
+
+    /**
+     * Converts a float to a half float, rounding to nearest even.
+     *
+     * @param value The value to convert.
+     *
+     * @return The IEEE 754 binary16 bits.
+     */
+    static uint16_t toHalf(float value);
+
+    /**
+     * Converts a half float to a float. The conversion is exact.
+     *
+     * @param value The IEEE 754 binary16 bits.
+     *
+     * @return The float value.
+     */
+    static float fromHalf(uint16_t value);
+
+    /**
+     * Converts floats to half floats.
+     *
+     * @param src The floats to convert.
+     * @param count The number of floats.
+     * @param dst An array of count half floats.
+     */
+    static void packHalf(const float* src, size_t count, uint16_t* dst);
+
+    /**
+     * Converts half floats to floats.
+     *
+     * @param src The half floats to convert.
+     * @param count The number of half floats.
+     * @param dst An array of count floats.
+     */
+    static void unpackHalf(const uint16_t* src, size_t count, float* dst);
+
+    /**
+     * Converts floats in [-1, 1] to signed normalized 8-bit integers.
+     *
+     * @param src The floats to convert.
+     * @param count The number of floats.
+     * @param dst An array of count integers.
+     */
+    static void packSnorm8(const float* src, size_t count, int8_t* dst);
+
+    /**
+     * Converts signed normalized 8-bit integers to floats in [-1, 1].
+     *
+     * @param src The integers to convert.
+     * @param count The number of integers.
+     * @param dst An array of count floats.
+     */
+    static void unpackSnorm8(const int8_t* src, size_t count, float* dst);
+
+    /**
+     * Converts floats in [-1, 1] to signed normalized 16-bit integers.
+     *
+     * @param src The floats to convert.
+     * @param count The number of floats.
+     * @param dst An array of count integers.
+     */
+    static void packSnorm16(const float* src, size_t count, int16_t* dst);
+
+    /**
+     * Converts signed normalized 16-bit integers to floats in [-1, 1].
+     *
+     * @param src The integers to convert.
+     * @param count The number of integers.
+     * @param dst An array of count floats.
+     */
+    static void unpackSnorm16(const int16_t* src, size_t count, float* dst);
+
+    /**
+     * Converts floats in [0, 1] to unsigned normalized 8-bit integers.
+     *
+     * @param src The floats to convert.
+     * @param count The number of floats.
+     * @param dst An array of count integers.
+     */
+    static void packUnorm8(const float* src, size_t count, uint8_t* dst);
+
+    /**
+     * Converts unsigned normalized 8-bit integers to floats in [0, 1].
+     *
+     * @param src The integers to convert.
+     * @param count The number of integers.
+     * @param dst An array of count floats.
+     */
+    static void unpackUnorm8(const uint8_t* src, size_t count, float* dst);
+
+    /**
+     * Converts floats in [0, 1] to unsigned normalized 16-bit integers.
+     *
+     * @param src The floats to convert.
+     * @param count The number of floats.
+     * @param dst An array of count integers.
+     */
+    static void packUnorm16(const float* src, size_t count, uint16_t* dst);
+
+    /**
+     * Converts unsigned normalized 16-bit integers to floats in [0, 1].
+     *
+     * @param src The integers to convert.
+     * @param count The number of integers.
+     * @param dst An array of count floats.
+     */
+    static void unpackUnorm16(const uint16_t* src, size_t count, float* dst);
+
+    /**
+     * Encodes unit vectors with the octahedral mapping into two signed normalized 8-bit integers each.
+     *
+     * The input does not need to be normalized; zero vectors encode as +z.
+     *
+     * @param src The vectors to encode.
+     * @param count The number of vectors.
+     * @param dst An array of count * 2 integers.
+     */
+    static void packOctahedral8(const RVector3* src, size_t count, int8_t* dst);
+
+    /**
+     * Decodes octahedral encoded unit vectors.
+     *
+     * @param src An array of count * 2 integers.
+     * @param count The number of vectors.
+     * @param dst An array of count normalized vectors.
+     */
+    static void unpackOctahedral8(const int8_t* src, size_t count, RVector3* dst);
+
+    /**
+     * Encodes unit vectors with the octahedral mapping into two signed normalized 16-bit integers each.
+     *
+     * The input does not need to be normalized; zero vectors encode as +z.
+     *
+     * @param src The vectors to encode.
+     * @param count The number of vectors.
+     * @param dst An array of count * 2 integers.
+     */
+    static void packOctahedral16(const RVector3* src, size_t count, int16_t* dst);
+
+    /**
+     * Decodes octahedral encoded unit vectors.
+     *
+     * @param src An array of count * 2 integers.
+     * @param count The number of vectors.
+     * @param dst An array of count normalized vectors.
+     */
+    static void unpackOctahedral16(const int16_t* src, size_t count, RVector3* dst);
+
+    /**
+     * Packs vectors in [-1, 1] into the GL_INT_2_10_10_10_REV layout:
+     * x, y and z as 10-bit signed normalized values in the low bits and w as a 2-bit signed value.
+     *
+     * This is the usual format for normals and tangents, with w holding the bitangent sign.
+     *
+     * @param src The vectors to pack.
+     * @param count The number of vectors.
+     * @param dst An array of count packed values.
+     */
+    static void packSnorm1010102(const RVector4* src, size_t count, uint32_t* dst);
+
+    /**
+     * Unpacks vectors stored in the GL_INT_2_10_10_10_REV layout.
+     *
+     * @param src The packed values.
+     * @param count The number of values.
+     * @param dst An array of count vectors.
+     */
+    static void unpackSnorm1010102(const uint32_t* src, size_t count, RVector4* dst);
+
+    /**
+     * Packs vectors in [0, 1] into the GL_UNSIGNED_INT_2_10_10_10_REV layout:
+     * x, y and z as 10-bit unsigned normalized values in the low bits and w as 2 bits.
+     *
+     * @param src The vectors to pack.
+     * @param count The number of vectors.
+     * @param dst An array of count packed values.
+     */
+    static void packUnorm1010102(const RVector4* src, size_t count, uint32_t* dst);
+
+    /**
+     * Unpacks vectors stored in the GL_UNSIGNED_INT_2_10_10_10_REV layout.
+     *
+     * @param src The packed values.
+     * @param count The number of values.
+     * @param dst An array of count vectors.
+     */
+    static void unpackUnorm1010102(const uint32_t* src, size_t count, RVector4* dst);
+
+    /**
+     * Packs unit quaternions with the smallest-three encoding into 32 bits:
+     * 2 bits for the index of the largest component and 10 bits for each of the others.
+     *
+     * q and -q represent the same rotation, so the sign is not preserved.
+     *
+     * @param src The unit quaternions to pack.
+     * @param count The number of quaternions.
+     * @param dst An array of count packed values.
+     */
+    static void packQuaternion32(const RQuaternion* src, size_t count, uint32_t* dst);
+
+    /**
+     * Unpacks quaternions stored with packQuaternion32().
+     *
+     * @param src The packed values.
+     * @param count The number of values.
+     * @param dst An array of count unit quaternions.
+     */
+    static void unpackQuaternion32(const uint32_t* src, size_t count, RQuaternion* dst);
+
+    /**
+     * Packs unit quaternions with the smallest-three encoding into 64 bits:
+     * 2 bits for the index of the largest component and 20 bits for each of the others.
+     *
+     * @param src The unit quaternions to pack.
+     * @param count The number of quaternions.
+     * @param dst An array of count packed values.
+     */
+    static void packQuaternion64(const RQuaternion* src, size_t count, uint64_t* dst);
+
+    /**
+     * Unpacks quaternions stored with packQuaternion64().
+     *
+     * @param src The packed values.
+     * @param count The number of values.
+     * @param dst An array of count unit quaternions.
+     */
+    static void unpackQuaternion64(const uint64_t* src, size_t count, RQuaternion* dst);
+
+    /**
+     * Converts an array of RVector2, RVector3, RVector4 or RQuaternion to half floats.
+     *
+     * @param src The vectors to convert.
+     * @param count The number of vectors.
+     * @param dst An array of count * components half floats.
+     */
+    template <typename T>
+    static void packHalf(const T* src, size_t count, uint16_t* dst);
+
+    /**
+     * Converts half floats to an array of RVector2, RVector3, RVector4 or RQuaternion.
+     *
+     * @param src An array of count * components half floats.
+     * @param count The number of vectors.
+     * @param dst The vectors to write.
+     */
+    template <typename T>
+    static void unpackHalf(const uint16_t* src, size_t count, T* dst);
+
+    /**
+     * Converts an array of RVector2, RVector3, RVector4 or RQuaternion to signed normalized 8-bit integers.
+     */
+    template <typename T>
+    static void packSnorm8(const T* src, size_t count, int8_t* dst);
+
+    /**
+     * Converts signed normalized 8-bit integers to an array of RVector2, RVector3, RVector4 or RQuaternion.
+     */
+    template <typename T>
+    static void unpackSnorm8(const int8_t* src, size_t count, T* dst);
+
+    /**
+     * Converts an array of RVector2, RVector3, RVector4 or RQuaternion to signed normalized 16-bit integers.
+     */
+    template <typename T>
+    static void packSnorm16(const T* src, size_t count, int16_t* dst);
+
+    /**
+     * Converts signed normalized 16-bit integers to an array of RVector2, RVector3, RVector4 or RQuaternion.
+     */
+    template <typename T>
+    static void unpackSnorm16(const int16_t* src, size_t count, T* dst);
+
+    /**
+     * Converts an array of RVector2, RVector3 or RVector4 to unsigned normalized 8-bit integers.
+     */
+    template <typename T>
+    static void packUnorm8(const T* src, size_t count, uint8_t* dst);
+
+    /**
+     * Converts unsigned normalized 8-bit integers to an array of RVector2, RVector3 or RVector4.
+     */
+    template <typename T>
+    static void unpackUnorm8(const uint8_t* src, size_t count, T* dst);
+
+    /**
+     * Converts an array of RVector2, RVector3 or RVector4 to unsigned normalized 16-bit integers.
+     */
+    template <typename T>
+    static void packUnorm16(const T* src, size_t count, uint16_t* dst);
+
+    /**
+     * Converts unsigned normalized 16-bit integers to an array of RVector2, RVector3 or RVector4.
+     */
+    template <typename T>
+    static void unpackUnorm16(const uint16_t* src, size_t count, T* dst);
+
+private:
+
+    RPacking();
+};
+
+}
+
+#include "RPacking.inl"
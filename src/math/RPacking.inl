@@ -0,0 +1,71 @@
+#include "RPacking.h"
+
+namespace rocket
+{
+
+// Number of floats in one of the vector types accepted by the template converters.
+#define PACKING_COMPONENTS(T) (sizeof(T) / sizeof(float))
+
+template <typename T>
+inline void RPacking::packHalf(const T* src, size_t count, uint16_t* dst)
+{
+    packHalf(&src->x, count * PACKING_COMPONENTS(T), dst);
+}
+
+template <typename T>
+inline void RPacking::unpackHalf(const uint16_t* src, size_t count, T* dst)
+{
+    unpackHalf(src, count * PACKING_COMPONENTS(T), &dst->x);
+}
+
+template <typename T>
+inline void RPacking::packSnorm8(const T* src, size_t count, int8_t* dst)
+{
+    packSnorm8(&src->x, count * PACKING_COMPONENTS(T), dst);
+}
+
+template <typename T>
+inline void RPacking::unpackSnorm8(const int8_t* src, size_t count, T* dst)
+{
+    unpackSnorm8(src, count * PACKING_COMPONENTS(T), &dst->x);
+}
+
+template <typename T>
+inline void RPacking::packSnorm16(const T* src, size_t count, int16_t* dst)
+{
+    packSnorm16(&src->x, count * PACKING_COMPONENTS(T), dst);
+}
+
+template <typename T>
+inline void RPacking::unpackSnorm16(const int16_t* src, size_t count, T* dst)
+{
+    unpackSnorm16(src, count * PACKING_COMPONENTS(T), &dst->x);
+}
+
+template <typename T>
+inline void RPacking::packUnorm8(const T* src, size_t count, uint8_t* dst)
+{
+    packUnorm8(&src->x, count * PACKING_COMPONENTS(T), dst);
+}
+
+template <typename T>
+inline void RPacking::unpackUnorm8(const uint8_t* src, size_t count, T* dst)
+{
+    unpackUnorm8(src, count * PACKING_COMPONENTS(T), &dst->x);
+}
+
+template <typename T>
+inline void RPacking::packUnorm16(const T* src, size_t count, uint16_t* dst)
+{
+    packUnorm16(&src->x, count * PACKING_COMPONENTS(T), dst);
+}
+
+template <typename T>
+inline void RPacking::unpackUnorm16(const uint16_t* src, size_t count, T* dst)
+{
+    unpackUnorm16(src, count * PACKING_COMPONENTS(T), &dst->x);
+}
+
+#undef PACKING_COMPONENTS
+
+}
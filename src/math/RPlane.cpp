@@ -242,6 +242,136 @@ API bool RPlane::isParallel(const RPlane& plane) const
            (_normal.x * plane._normal.y) - (_normal.y * plane._normal.x) == 0.0f;
 }
 
+API unsigned int RPlane::clip(const RVector3* points, unsigned int count, RVector3* dst) const
+{
+    if (count == 0)
+        return 0;
+
+    unsigned int n = 0;
+    const RVector3* a = &points[count - 1];
+    float da = distance(*a);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const RVector3* b = &points[i];
+        float db = distance(*b);
+        if ((da >= 0.0f) != (db >= 0.0f))
+        {
+            // Interpolate from the kept point so both orders of the edge give the same result.
+            if (da >= 0.0f)
+                dst[n++] = *a + (*b - *a) * (da / (da - db));
+            else
+                dst[n++] = *b + (*a - *b) * (db / (db - da));
+        }
+        if (db >= 0.0f)
+            dst[n++] = *b;
+        a = b;
+        da = db;
+    }
+    return n;
+}
+
+API unsigned int RPlane::clip(const RPlane* planes, unsigned int planeCount, const RVector3* points, unsigned int count,
+                              RVector3* dst, RVector3* scratch)
+{
+    if (planeCount == 0)
+    {
+        memcpy(dst, points, count * sizeof(RVector3));
+        return count;
+    }
+
+    // Alternate between dst and scratch so that the last plane writes to dst.
+    RVector3* buffers[2] = { dst, scratch };
+    unsigned int target = (planeCount & 1) ? 0 : 1;
+    const RVector3* src = points;
+    for (unsigned int i = 0; i < planeCount && count > 0; i++)
+    {
+        count = planes[i].clip(src, count, buffers[target]);
+        src = buffers[target];
+        target ^= 1;
+    }
+    if (count > 0 && src != dst)
+        memcpy(dst, src, count * sizeof(RVector3));
+    return count;
+}
+
+API unsigned int RPlane::clipTriangles(const RPlane* planes, unsigned int planeCount, const RVector3* triangles,
+                                       unsigned int triangleCount, RVector3* dst, unsigned int maxTriangles,
+                                       unsigned int* sources)
+{
+    if (planeCount > CLIP_MAX_PLANES)
+        planeCount = CLIP_MAX_PLANES;
+
+    RVector3 polygon[3 + CLIP_MAX_PLANES];
+    RVector3 scratch[3 + CLIP_MAX_PLANES];
+    unsigned int written = 0;
+    for (unsigned int t = 0; t < triangleCount && written < maxTriangles; t++)
+    {
+        const RVector3* triangle = &triangles[t * 3];
+
+        // Triangles entirely inside every plane are copied without clipping.
+        bool inside = true;
+        for (unsigned int i = 0; i < planeCount && inside; i++)
+        {
+            inside = planes[i].distance(triangle[0]) >= 0.0f &&
+                     planes[i].distance(triangle[1]) >= 0.0f &&
+                     planes[i].distance(triangle[2]) >= 0.0f;
+        }
+        if (inside)
+        {
+            memcpy(&dst[written * 3], triangle, 3 * sizeof(RVector3));
+            if (sources)
+                sources[written] = t;
+            written++;
+            continue;
+        }
+
+        unsigned int count = clip(planes, planeCount, triangle, 3, polygon, scratch);
+        for (unsigned int i = 2; i < count && written < maxTriangles; i++)
+        {
+            dst[written * 3] = polygon[0];
+            dst[written * 3 + 1] = polygon[i - 1];
+            dst[written * 3 + 2] = polygon[i];
+            if (sources)
+                sources[written] = t;
+            written++;
+        }
+    }
+    return written;
+}
+
+API unsigned int RPlane::createPortalPlanes(const RVector3& eye, const RVector3* polygon, unsigned int count, RPlane* dst)
+{
+    if (count < 3)
+        return 0;
+
+    // The centroid is inside a convex polygon and orients every plane.
+    RVector3 centroid;
+    for (unsigned int i = 0; i < count; i++)
+        centroid += polygon[i];
+    centroid *= 1.0f / (float)count;
+
+    RVector3 normal;
+    RVector3::cross(polygon[1] - polygon[0], polygon[2] - polygon[0], &normal);
+    RPlane portal(normal, -normal.dot(polygon[0]));
+    if (portal.getNormal().isZero() || fabs(portal.distance(eye)) <= MATH_EPSILON)
+        return 0;
+    if (portal.distance(eye) > 0.0f)
+        portal.set(-portal._normal, -portal._distance);
+
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const RVector3& a = polygon[i];
+        const RVector3& b = polygon[(i + 1) % count];
+        RVector3::cross(a - eye, b - eye, &normal);
+        RPlane& plane = dst[i];
+        plane.set(normal, -normal.dot(eye));
+        if (plane.distance(centroid) < 0.0f)
+            plane.set(-plane._normal, -plane._distance);
+    }
+    dst[count].set(portal);
+    return count + 1;
+}
+
 API void RPlane::set(const RVector3& normal, float distance)
 {
     _normal = normal;
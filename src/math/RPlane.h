@@ -34,6 +34,11 @@ public:
      */
     static const int INTERSECTS_BACK = -1;
 
+    /**
+     * The maximum number of planes clipTriangles() clips against.
+     */
+    static const unsigned int CLIP_MAX_PLANES = 16;
+
     /**
      * Constructs a new plane with normal (0, 1, 0) and distance 0.
      */
@@ -189,6 +194,80 @@ public:
      */
     bool isParallel(const RPlane& plane) const;
 
+    /**
+     * Clips a convex polygon to the positive half-space of this plane
+     * (Sutherland-Hodgman).
+     *
+     * Points on the plane are kept. New points are always interpolated from
+     * the kept end of an edge, so polygons sharing an edge are clipped to the
+     * same point and stay watertight.
+     *
+     * @param points The points of the polygon, in order.
+     * @param count The number of points.
+     * @param dst The array to store the clipped polygon in, at least count + 1 points, not overlapping points.
+     *
+     * @return The number of points in dst, 0 if the polygon is entirely behind the plane.
+     */
+    unsigned int clip(const RVector3* points, unsigned int count, RVector3* dst) const;
+
+    /**
+     * Clips a convex polygon to the intersection of the positive half-spaces
+     * of several planes, such as the planes of a frustum or of a portal.
+     *
+     * @param planes The planes to clip against.
+     * @param planeCount The number of planes.
+     * @param points The points of the polygon, in order.
+     * @param count The number of points.
+     * @param dst The array to store the clipped polygon in, at least count + planeCount points.
+     * @param scratch A work array of at least count + planeCount points.
+     *
+     * @return The number of points in dst, 0 if the polygon is entirely clipped.
+     */
+    static unsigned int clip(const RPlane* planes, unsigned int planeCount, const RVector3* points, unsigned int count,
+                             RVector3* dst, RVector3* scratch);
+
+    /**
+     * Clips a triangle list to the intersection of the positive half-spaces
+     * of several planes, as when projecting a decal onto the triangles under
+     * it. Each clipped triangle is fan triangulated into dst.
+     *
+     * Clipping stops when dst is full, so the output is never reallocated.
+     * A triangle clipped by n planes produces at most n + 1 triangles.
+     *
+     * @param planes The planes to clip against, at most CLIP_MAX_PLANES.
+     * @param planeCount The number of planes.
+     * @param triangles The triangles, three points each.
+     * @param triangleCount The number of triangles.
+     * @param dst The array to store the clipped triangles in, three points each.
+     * @param maxTriangles The number of triangles dst can hold.
+     * @param sources An optional array of maxTriangles receiving the index of the source triangle of each output triangle.
+     *
+     * @return The number of triangles stored in dst.
+     */
+    static unsigned int clipTriangles(const RPlane* planes, unsigned int planeCount, const RVector3* triangles,
+                                      unsigned int triangleCount, RVector3* dst, unsigned int maxTriangles,
+                                      unsigned int* sources = NULL);
+
+    /**
+     * Creates the planes bounding the volume seen from a point through a
+     * convex polygon, the view through a portal.
+     *
+     * There is one plane through the eye and each edge of the polygon, and a
+     * last plane through the polygon itself so that nothing between the eye
+     * and the portal is inside. All planes face into the volume and either
+     * winding of the polygon works. Clip the next portal against the result
+     * with clip() and create its planes from the clipped polygon to narrow
+     * the view recursively.
+     *
+     * @param eye The point of view.
+     * @param polygon The points of the polygon, usually clipped to the current view first.
+     * @param count The number of points.
+     * @param dst The array to store the planes in, at least count + 1 planes.
+     *
+     * @return The number of planes stored in dst, 0 if the polygon has fewer than 3 points or the eye lies in its plane.
+     */
+    static unsigned int createPortalPlanes(const RVector3& eye, const RVector3* polygon, unsigned int count, RPlane* dst);
+
     /**
      * Sets this plane to the specified values.
      *
@@ -0,0 +1,104 @@
+#include "common.h"
+#include "RQuaternionArray.h"
+
+namespace rocket
+{
+
+void RQuaternionArray::multiply(const RQuaternionArray& a, const RQuaternionArray& b, RQuaternionArray* dst)
+{
+    dst->resize(a.size());
+    simdForEach(a.getPaddedSize(), [&](auto lane, size_t i)
+    {
+        typedef decltype(lane) F;
+        F x1 = F::load(a.getComponent(0) + i), y1 = F::load(a.getComponent(1) + i);
+        F z1 = F::load(a.getComponent(2) + i), w1 = F::load(a.getComponent(3) + i);
+        F x2 = F::load(b.getComponent(0) + i), y2 = F::load(b.getComponent(1) + i);
+        F z2 = F::load(b.getComponent(2) + i), w2 = F::load(b.getComponent(3) + i);
+
+        (w1 * x2 + x1 * w2 + y1 * z2 - z1 * y2).store(dst->getComponent(0) + i);
+        (w1 * y2 - x1 * z2 + y1 * w2 + z1 * x2).store(dst->getComponent(1) + i);
+        (w1 * z2 + x1 * y2 - y1 * x2 + z1 * w2).store(dst->getComponent(2) + i);
+        (w1 * w2 - x1 * x2 - y1 * y2 - z1 * z2).store(dst->getComponent(3) + i);
+    });
+}
+
+void RQuaternionArray::normalize(const RQuaternionArray& a, RQuaternionArray* dst)
+{
+    dst->resize(a.size());
+    simdForEach(a.getPaddedSize(), [&](auto lane, size_t i)
+    {
+        typedef decltype(lane) F;
+        F x = F::load(a.getComponent(0) + i), y = F::load(a.getComponent(1) + i);
+        F z = F::load(a.getComponent(2) + i), w = F::load(a.getComponent(3) + i);
+
+        F length = simdSqrt(x * x + y * y + z * z + w * w);
+        F valid = length > F(0.0f);
+        simdSelect(valid, x / length, x).store(dst->getComponent(0) + i);
+        simdSelect(valid, y / length, y).store(dst->getComponent(1) + i);
+        simdSelect(valid, z / length, z).store(dst->getComponent(2) + i);
+        simdSelect(valid, w / length, w).store(dst->getComponent(3) + i);
+    });
+}
+
+void RQuaternionArray::nlerp(const RQuaternionArray& a, const RQuaternionArray& b, float t, RQuaternionArray* dst)
+{
+    dst->resize(a.size());
+    simdForEach(a.getPaddedSize(), [&](auto lane, size_t i)
+    {
+        typedef decltype(lane) F;
+        F x1 = F::load(a.getComponent(0) + i), y1 = F::load(a.getComponent(1) + i);
+        F z1 = F::load(a.getComponent(2) + i), w1 = F::load(a.getComponent(3) + i);
+        F x2 = F::load(b.getComponent(0) + i), y2 = F::load(b.getComponent(1) + i);
+        F z2 = F::load(b.getComponent(2) + i), w2 = F::load(b.getComponent(3) + i);
+
+        // Flip b into the hemisphere of a.
+        F sign = (x1 * x2 + y1 * y2 + z1 * z2 + w1 * w2) & F(-0.0f);
+        x2 = x2 ^ sign;
+        y2 = y2 ^ sign;
+        z2 = z2 ^ sign;
+        w2 = w2 ^ sign;
+
+        F s(t);
+        F x = x1 + (x2 - x1) * s;
+        F y = y1 + (y2 - y1) * s;
+        F z = z1 + (z2 - z1) * s;
+        F w = w1 + (w2 - w1) * s;
+
+        F length = simdSqrt(x * x + y * y + z * z + w * w);
+        F valid = length > F(0.0f);
+        simdSelect(valid, x / length, x).store(dst->getComponent(0) + i);
+        simdSelect(valid, y / length, y).store(dst->getComponent(1) + i);
+        simdSelect(valid, z / length, z).store(dst->getComponent(2) + i);
+        simdSelect(valid, w / length, w).store(dst->getComponent(3) + i);
+    });
+}
+
+void RQuaternionArray::rotate(const RQuaternionArray& q, const RVector3Array& v, RVector3Array* dst)
+{
+    dst->resize(q.size());
+    simdForEach(q.getPaddedSize(), [&](auto lane, size_t i)
+    {
+        typedef decltype(lane) F;
+        F qx = F::load(q.getComponent(0) + i), qy = F::load(q.getComponent(1) + i);
+        F qz = F::load(q.getComponent(2) + i), qw = F::load(q.getComponent(3) + i);
+        F vx = F::load(v.getComponent(0) + i), vy = F::load(v.getComponent(1) + i);
+        F vz = F::load(v.getComponent(2) + i);
+
+        // v' = v + w * t + cross(q.xyz, t), with t = 2 * cross(q.xyz, v).
+        F two(2.0f);
+        F tx = (qy * vz - qz * vy) * two;
+        F ty = (qz * vx - qx * vz) * two;
+        F tz = (qx * vy - qy * vx) * two;
+
+        (vx + qw * tx + (qy * tz - qz * ty)).store(dst->getComponent(0) + i);
+        (vy + qw * ty + (qz * tx - qx * tz)).store(dst->getComponent(1) + i);
+        (vz + qw * tz + (qx * ty - qy * tx)).store(dst->getComponent(2) + i);
+    });
+}
+
+void RQuaternionArray::normalize()
+{
+    normalize(*this, this);
+}
+
+}
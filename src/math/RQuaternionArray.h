@@ -0,0 +1,65 @@
+#pragma once
+
+#include "RVectorArray.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a structure of arrays container of RQuaternion with batch
+ * operations.
+ *
+ * The batch functions resize dst to the size of the first input and dst may
+ * be one of the inputs. Results match the RQuaternion functions up to
+ * rounding.
+ */
+class API RQuaternionArray : public RSoAArray<RQuaternion>
+{
+public:
+
+    using RSoAArray<RQuaternion>::RSoAArray;
+
+    /**
+     * Multiplies two arrays element-wise, a * b.
+     *
+     * @param a The first array.
+     * @param b The second array.
+     * @param dst The array to store the products in.
+     */
+    static void multiply(const RQuaternionArray& a, const RQuaternionArray& b, RQuaternionArray* dst);
+
+    /**
+     * Normalizes every quaternion of an array. Zero quaternions are left unchanged.
+     *
+     * @param a The array.
+     * @param dst The array to store the normalized quaternions in.
+     */
+    static void normalize(const RQuaternionArray& a, RQuaternionArray* dst);
+
+    /**
+     * Interpolates between two arrays with normalized linear interpolation,
+     * taking the short way around.
+     *
+     * @param a The array at t = 0.
+     * @param b The array at t = 1.
+     * @param t The interpolation coefficient.
+     * @param dst The array to store the results in.
+     */
+    static void nlerp(const RQuaternionArray& a, const RQuaternionArray& b, float t, RQuaternionArray* dst);
+
+    /**
+     * Rotates vectors by unit quaternions element-wise.
+     *
+     * @param q The rotations.
+     * @param v The vectors, the same size as q.
+     * @param dst The array to store the rotated vectors in.
+     */
+    static void rotate(const RQuaternionArray& q, const RVector3Array& v, RVector3Array* dst);
+
+    /**
+     * Normalizes every quaternion of this array.
+     */
+    void normalize();
+};
+
+}
@@ -0,0 +1,465 @@
+#include "common.h"
+#include "RRectangleTree.h"
+
+namespace rocket
+{
+
+// The tree is AVL balanced, so its height stays below 1.44 * log2(n + 2) and a
+// traversal never holds more than height + 1 nodes. 128 covers any tree that
+// fits in memory.
+#define TREE_STACK_SIZE 128
+
+static inline float perimeter(float minX, float minY, float maxX, float maxY)
+{
+    return 2.0f * ((maxX - minX) + (maxY - minY));
+}
+
+static inline float distanceSquared(float x, float y, float minX, float minY, float maxX, float maxY)
+{
+    float dx = std::max(std::max(minX - x, x - maxX), 0.0f);
+    float dy = std::max(std::max(minY - y, y - maxY), 0.0f);
+    return dx * dx + dy * dy;
+}
+
+const int RRectangleTree::NULL_NODE;
+
+RRectangleTree::RRectangleTree(float margin)
+    : _root(NULL_NODE), _freeList(NULL_NODE), _leafCount(0), _margin(margin)
+{
+}
+
+RRectangleTree::~RRectangleTree()
+{
+}
+
+int RRectangleTree::insert(const RRectangle& rect, void* userData)
+{
+    int id = allocateNode();
+    Node& node = _nodes[id];
+    node.rect = rect;
+    node.userData = userData;
+    setFatBounds(node, rect);
+    insertLeaf(id);
+    _leafCount++;
+    return id;
+}
+
+void RRectangleTree::remove(int id)
+{
+    removeLeaf(id);
+    freeNode(id);
+    _leafCount--;
+}
+
+bool RRectangleTree::move(int id, const RRectangle& rect)
+{
+    Node& node = _nodes[id];
+    node.rect = rect;
+    if (rect.x >= node.minX && rect.y >= node.minY &&
+        rect.x + rect.width <= node.maxX && rect.y + rect.height <= node.maxY)
+    {
+        return false;
+    }
+
+    removeLeaf(id);
+    setFatBounds(_nodes[id], rect);
+    insertLeaf(id);
+    return true;
+}
+
+void RRectangleTree::clear()
+{
+    _nodes.clear();
+    _root = NULL_NODE;
+    _freeList = NULL_NODE;
+    _leafCount = 0;
+}
+
+const RRectangle& RRectangleTree::getRectangle(int id) const
+{
+    return _nodes[id].rect;
+}
+
+void* RRectangleTree::getUserData(int id) const
+{
+    return _nodes[id].userData;
+}
+
+size_t RRectangleTree::size() const
+{
+    return _leafCount;
+}
+
+int RRectangleTree::getHeight() const
+{
+    return _root == NULL_NODE ? 0 : _nodes[_root].height;
+}
+
+size_t RRectangleTree::query(float x, float y, std::vector<int>* results) const
+{
+    if (_root == NULL_NODE)
+        return 0;
+
+    size_t found = 0;
+    int stack[TREE_STACK_SIZE];
+    int top = 0;
+    stack[top++] = _root;
+    while (top > 0)
+    {
+        int id = stack[--top];
+        const Node& node = _nodes[id];
+        if (x < node.minX || x > node.maxX || y < node.minY || y > node.maxY)
+            continue;
+
+        if (node.isLeaf())
+        {
+            if (node.rect.contains(x, y))
+            {
+                results->push_back(id);
+                found++;
+            }
+        }
+        else
+        {
+            stack[top++] = node.child1;
+            stack[top++] = node.child2;
+        }
+    }
+    return found;
+}
+
+size_t RRectangleTree::query(const RRectangle& rect, std::vector<int>* results) const
+{
+    if (_root == NULL_NODE)
+        return 0;
+
+    const float minX = rect.x;
+    const float minY = rect.y;
+    const float maxX = rect.x + rect.width;
+    const float maxY = rect.y + rect.height;
+
+    size_t found = 0;
+    int stack[TREE_STACK_SIZE];
+    int top = 0;
+    stack[top++] = _root;
+    while (top > 0)
+    {
+        int id = stack[--top];
+        const Node& node = _nodes[id];
+        if (maxX < node.minX || minX > node.maxX || maxY < node.minY || minY > node.maxY)
+            continue;
+
+        if (node.isLeaf())
+        {
+            if (node.rect.intersects(rect))
+            {
+                results->push_back(id);
+                found++;
+            }
+        }
+        else
+        {
+            stack[top++] = node.child1;
+            stack[top++] = node.child2;
+        }
+    }
+    return found;
+}
+
+int RRectangleTree::nearest(float x, float y, float maxDistance, float* distance) const
+{
+    int best = NULL_NODE;
+    float bestDistance = maxDistance < FLT_MAX ? maxDistance * maxDistance : FLT_MAX;
+
+    if (_root != NULL_NODE)
+    {
+        int stack[TREE_STACK_SIZE];
+        int top = 0;
+        stack[top++] = _root;
+        while (top > 0)
+        {
+            int id = stack[--top];
+            const Node& node = _nodes[id];
+            if (distanceSquared(x, y, node.minX, node.minY, node.maxX, node.maxY) > bestDistance)
+                continue;
+
+            if (node.isLeaf())
+            {
+                const RRectangle& r = node.rect;
+                float d = distanceSquared(x, y, r.x, r.y, r.x + r.width, r.y + r.height);
+                if (d <= bestDistance)
+                {
+                    bestDistance = d;
+                    best = id;
+                }
+            }
+            else
+            {
+                // Push the closer child last so it is visited first, which shrinks
+                // bestDistance early and prunes more of the far subtree.
+                const Node& c1 = _nodes[node.child1];
+                const Node& c2 = _nodes[node.child2];
+                float d1 = distanceSquared(x, y, c1.minX, c1.minY, c1.maxX, c1.maxY);
+                float d2 = distanceSquared(x, y, c2.minX, c2.minY, c2.maxX, c2.maxY);
+                if (d1 < d2)
+                {
+                    stack[top++] = node.child2;
+                    stack[top++] = node.child1;
+                }
+                else
+                {
+                    stack[top++] = node.child1;
+                    stack[top++] = node.child2;
+                }
+            }
+        }
+    }
+
+    if (distance)
+    {
+        *distance = best == NULL_NODE ? FLT_MAX : std::sqrt(bestDistance);
+    }
+    return best;
+}
+
+int RRectangleTree::allocateNode()
+{
+    if (_freeList == NULL_NODE)
+    {
+        size_t oldSize = _nodes.size();
+        size_t newSize = oldSize == 0 ? 16 : oldSize * 2;
+        _nodes.resize(newSize);
+        for (size_t i = oldSize; i < newSize; i++)
+        {
+            _nodes[i].next = (i + 1 < newSize) ? (int)(i + 1) : NULL_NODE;
+            _nodes[i].height = -1;
+        }
+        _freeList = (int)oldSize;
+    }
+
+    int id = _freeList;
+    Node& node = _nodes[id];
+    _freeList = node.next;
+    node.parent = NULL_NODE;
+    node.child1 = NULL_NODE;
+    node.child2 = NULL_NODE;
+    node.height = 0;
+    node.userData = NULL;
+    return id;
+}
+
+void RRectangleTree::freeNode(int id)
+{
+    _nodes[id].next = _freeList;
+    _nodes[id].height = -1;
+    _freeList = id;
+}
+
+void RRectangleTree::setFatBounds(Node& node, const RRectangle& rect) const
+{
+    node.minX = rect.x - _margin;
+    node.minY = rect.y - _margin;
+    node.maxX = rect.x + rect.width + _margin;
+    node.maxY = rect.y + rect.height + _margin;
+}
+
+void RRectangleTree::insertLeaf(int leaf)
+{
+    if (_root == NULL_NODE)
+    {
+        _root = leaf;
+        _nodes[leaf].parent = NULL_NODE;
+        return;
+    }
+
+    // Find the best sibling by descending towards the child whose perimeter
+    // grows the least, stopping when creating a new parent here is cheaper.
+    const float minX = _nodes[leaf].minX;
+    const float minY = _nodes[leaf].minY;
+    const float maxX = _nodes[leaf].maxX;
+    const float maxY = _nodes[leaf].maxY;
+    int index = _root;
+    while (!_nodes[index].isLeaf())
+    {
+        const Node& node = _nodes[index];
+        float area = perimeter(node.minX, node.minY, node.maxX, node.maxY);
+        float combinedArea = perimeter(std::min(node.minX, minX), std::min(node.minY, minY),
+                                       std::max(node.maxX, maxX), std::max(node.maxY, maxY));
+
+        // Cost of creating a new parent for this node and the new leaf.
+        float cost = 2.0f * combinedArea;
+
+        // Minimum cost of pushing the leaf further down the tree.
+        float inheritanceCost = 2.0f * (combinedArea - area);
+
+        float childCost[2];
+        for (int i = 0; i < 2; i++)
+        {
+            const Node& child = _nodes[i == 0 ? node.child1 : node.child2];
+            float enlarged = perimeter(std::min(child.minX, minX), std::min(child.minY, minY),
+                                       std::max(child.maxX, maxX), std::max(child.maxY, maxY));
+            if (child.isLeaf())
+            {
+                childCost[i] = enlarged + inheritanceCost;
+            }
+            else
+            {
+                childCost[i] = (enlarged - perimeter(child.minX, child.minY, child.maxX, child.maxY)) + inheritanceCost;
+            }
+        }
+
+        if (cost < childCost[0] && cost < childCost[1])
+            break;
+
+        index = childCost[0] < childCost[1] ? node.child1 : node.child2;
+    }
+
+    int sibling = index;
+
+    // Create a new parent for the sibling and the leaf.
+    int oldParent = _nodes[sibling].parent;
+    int newParent = allocateNode();
+    _nodes[newParent].parent = oldParent;
+    _nodes[newParent].child1 = sibling;
+    _nodes[newParent].child2 = leaf;
+    _nodes[sibling].parent = newParent;
+    _nodes[leaf].parent = newParent;
+
+    if (oldParent != NULL_NODE)
+    {
+        if (_nodes[oldParent].child1 == sibling)
+            _nodes[oldParent].child1 = newParent;
+        else
+            _nodes[oldParent].child2 = newParent;
+    }
+    else
+    {
+        _root = newParent;
+    }
+
+    // Walk back up fixing heights and bounds.
+    index = newParent;
+    while (index != NULL_NODE)
+    {
+        index = balance(index);
+        refit(index);
+        index = _nodes[index].parent;
+    }
+}
+
+void RRectangleTree::removeLeaf(int leaf)
+{
+    if (leaf == _root)
+    {
+        _root = NULL_NODE;
+        return;
+    }
+
+    int parent = _nodes[leaf].parent;
+    int grandParent = _nodes[parent].parent;
+    int sibling = _nodes[parent].child1 == leaf ? _nodes[parent].child2 : _nodes[parent].child1;
+
+    if (grandParent != NULL_NODE)
+    {
+        // Replace the parent with the sibling.
+        if (_nodes[grandParent].child1 == parent)
+            _nodes[grandParent].child1 = sibling;
+        else
+            _nodes[grandParent].child2 = sibling;
+        _nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        int index = grandParent;
+        while (index != NULL_NODE)
+        {
+            index = balance(index);
+            refit(index);
+            index = _nodes[index].parent;
+        }
+    }
+    else
+    {
+        _root = sibling;
+        _nodes[sibling].parent = NULL_NODE;
+        freeNode(parent);
+    }
+}
+
+void RRectangleTree::refit(int id)
+{
+    Node& node = _nodes[id];
+    const Node& c1 = _nodes[node.child1];
+    const Node& c2 = _nodes[node.child2];
+    node.minX = std::min(c1.minX, c2.minX);
+    node.minY = std::min(c1.minY, c2.minY);
+    node.maxX = std::max(c1.maxX, c2.maxX);
+    node.maxY = std::max(c1.maxY, c2.maxY);
+    node.height = 1 + std::max(c1.height, c2.height);
+}
+
+int RRectangleTree::balance(int iA)
+{
+    /*
+     * Performs a left or right rotation if node A is imbalanced and returns the new subtree root.
+     *      A
+     *    /   \
+     *   B     C
+     *  / \   / \
+     * D   E F   G
+     */
+    Node& a = _nodes[iA];
+    if (a.isLeaf() || a.height < 2)
+        return iA;
+
+    int iB = a.child1;
+    int iC = a.child2;
+    int diff = _nodes[iC].height - _nodes[iB].height;
+
+    if (diff > 1 || diff < -1)
+    {
+        // Rotate the taller child up. Written once for both directions.
+        int iUp = diff > 1 ? iC : iB;
+        Node& up = _nodes[iUp];
+        int iF = up.child1;
+        int iG = up.child2;
+
+        // Swap A and the taller child.
+        up.child1 = iA;
+        up.parent = a.parent;
+        a.parent = iUp;
+
+        if (up.parent != NULL_NODE)
+        {
+            if (_nodes[up.parent].child1 == iA)
+                _nodes[up.parent].child1 = iUp;
+            else
+                _nodes[up.parent].child2 = iUp;
+        }
+        else
+        {
+            _root = iUp;
+        }
+
+        // Keep the taller grandchild under the rotated node, give the other to A.
+        int iTall = _nodes[iF].height > _nodes[iG].height ? iF : iG;
+        int iShort = iTall == iF ? iG : iF;
+        up.child2 = iTall;
+        if (diff > 1)
+        {
+            a.child2 = iShort;
+        }
+        else
+        {
+            a.child1 = iShort;
+        }
+        _nodes[iShort].parent = iA;
+
+        refit(iA);
+        refit(iUp);
+        return iUp;
+    }
+
+    return iA;
+}
+
+}
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "common.h"
+#include "RRectangle.h"
+#include <cfloat>
+
+namespace rocket
+{
+
+/**
+ * Defines a dynamic bounding volume tree of rectangles.
+ *
+ * The tree answers point, rectangle and nearest neighbour queries over large
+ * sets of RRectangle in logarithmic time, which is what UI hit-testing and 2D
+ * sprite culling need once linear scans over RRectangle::contains() and
+ * RRectangle::intersects() become too slow.
+ *
+ * Each rectangle is stored in a leaf whose bounds are inflated by a margin.
+ * Moving a rectangle inside those "fat" bounds only updates the leaf, so
+ * small per-frame movements of widgets and sprites do not restructure the
+ * tree. The tree is kept balanced with AVL rotations.
+ *
+ * Rectangles are identified by the integer handle returned from insert().
+ */
+class API RRectangleTree
+{
+public:
+
+    /**
+     * Invalid handle, returned by queries that found nothing.
+     */
+    static const int NULL_NODE = -1;
+
+    /**
+     * Constructs an empty tree.
+     *
+     * @param margin The amount leaf bounds are inflated by on each side.
+     *      Larger margins make move() cheaper but queries slightly slower.
+     */
+    RRectangleTree(float margin = 4.0f);
+
+    /**
+     * Destructor.
+     */
+    ~RRectangleTree();
+
+    /**
+     * Inserts a rectangle into the tree.
+     *
+     * @param rect The rectangle to insert.
+     * @param userData An optional pointer stored with the rectangle.
+     *
+     * @return The handle of the rectangle.
+     */
+    int insert(const RRectangle& rect, void* userData = NULL);
+
+    /**
+     * Removes a rectangle from the tree.
+     *
+     * @param id The handle returned by insert().
+     */
+    void remove(int id);
+
+    /**
+     * Moves a rectangle.
+     *
+     * If the new rectangle still fits in the fat bounds of its leaf only the
+     * stored rectangle is updated, otherwise the leaf is reinserted.
+     *
+     * @param id The handle returned by insert().
+     * @param rect The new rectangle.
+     *
+     * @return true if the tree was restructured, false if the leaf was updated in place.
+     */
+    bool move(int id, const RRectangle& rect);
+
+    /**
+     * Removes all rectangles from the tree.
+     */
+    void clear();
+
+    /**
+     * Returns the rectangle stored for the specified handle.
+     *
+     * @param id The handle returned by insert().
+     */
+    const RRectangle& getRectangle(int id) const;
+
+    /**
+     * Returns the user data stored for the specified handle.
+     *
+     * @param id The handle returned by insert().
+     */
+    void* getUserData(int id) const;
+
+    /**
+     * Returns the number of rectangles in the tree.
+     */
+    size_t size() const;
+
+    /**
+     * Returns the height of the tree, 0 for a tree with a single rectangle.
+     */
+    int getHeight() const;
+
+    /**
+     * Finds all rectangles that contain the specified point.
+     *
+     * @param x The x-coordinate of the point.
+     * @param y The y-coordinate of the point.
+     * @param results A list the handles of the hit rectangles are appended to.
+     *
+     * @return The number of handles appended.
+     */
+    size_t query(float x, float y, std::vector<int>* results) const;
+
+    /**
+     * Finds all rectangles that intersect the specified rectangle.
+     *
+     * @param rect The rectangle to test against.
+     * @param results A list the handles of the intersecting rectangles are appended to.
+     *
+     * @return The number of handles appended.
+     */
+    size_t query(const RRectangle& rect, std::vector<int>* results) const;
+
+    /**
+     * Finds the rectangle closest to the specified point.
+     *
+     * A rectangle that contains the point has a distance of zero.
+     *
+     * @param x The x-coordinate of the point.
+     * @param y The y-coordinate of the point.
+     * @param maxDistance Rectangles further away than this are ignored.
+     * @param distance If not NULL, stores the distance to the closest rectangle.
+     *
+     * @return The handle of the closest rectangle or NULL_NODE if none is within maxDistance.
+     */
+    int nearest(float x, float y, float maxDistance = FLT_MAX, float* distance = NULL) const;
+
+private:
+
+    struct Node
+    {
+        float minX;
+        float minY;
+        float maxX;
+        float maxY;
+        RRectangle rect;
+        void* userData;
+        union
+        {
+            int parent;
+            int next;
+        };
+        int child1;
+        int child2;
+        int height;
+
+        bool isLeaf() const { return child1 == NULL_NODE; }
+    };
+
+    RRectangleTree(const RRectangleTree& copy);
+
+    RRectangleTree& operator=(const RRectangleTree&);
+
+    int allocateNode();
+
+    void freeNode(int id);
+
+    void insertLeaf(int leaf);
+
+    void removeLeaf(int leaf);
+
+    void refit(int id);
+
+    int balance(int id);
+
+    void setFatBounds(Node& node, const RRectangle& rect) const;
+
+    std::vector<Node> _nodes;
+    int _root;
+    int _freeList;
+    size_t _leafCount;
+    float _margin;
+};
+
+}
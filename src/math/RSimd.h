@@ -0,0 +1,331 @@
+#pragma once
+
+#include "common.h"
+
+/**
+ * SIMD support for the batch math kernels.
+ *
+ * ROCKET_SIMD_SSE2 is defined when SSE2 intrinsics are available, which is
+ * always the case on x86-64. Every kernel that uses it keeps a scalar
+ * fallback that performs the same IEEE operations in the same order, so
+ * results are bit-identical whichever path runs. To keep that true:
+ *
+ * - only use exactly rounded operations (add, sub, mul, div, sqrt, min, max,
+ *   conversions with the default round-to-nearest-even mode),
+ * - never use the reciprocal estimate instructions (rcp, rsqrt),
+ * - write the scalar min/max as (a > b ? a : b) / (a < b ? a : b), which is
+ *   what _mm_max_ps(a, b) / _mm_min_ps(a, b) compute, NaNs included.
+ *
+ * The library is compiled with floating point contraction disabled so the
+ * compiler does not fuse scalar multiply-adds behind our back.
+ */
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define ROCKET_SIMD_SSE2 1
+    #include <emmintrin.h>
+#endif
+
+namespace rocket
+{
+
+#ifdef ROCKET_SIMD_SSE2
+
+/**
+ * Returns a where mask is set and b elsewhere.
+ */
+inline __m128 simdSelect(__m128 mask, __m128 a, __m128 b)
+{
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+/**
+ * Returns a where mask is set and b elsewhere.
+ */
+inline __m128i simdSelect(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+/**
+ * Returns the absolute value of each lane.
+ */
+inline __m128 simdAbs(__m128 v)
+{
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+/**
+ * Returns the magnitude of a with the sign of b, per lane (like copysignf).
+ */
+inline __m128 simdCopySign(__m128 a, __m128 b)
+{
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    return _mm_or_ps(_mm_andnot_ps(sign, a), _mm_and_ps(sign, b));
+}
+
+/**
+ * Clamps each lane to [lo, hi]. NaN lanes become lo, matching simdClamp(float, ...).
+ */
+inline __m128 simdClamp(__m128 v, __m128 lo, __m128 hi)
+{
+    return _mm_min_ps(_mm_max_ps(v, lo), hi);
+}
+
+/**
+ * Sign extends the low 16 bits of each 32-bit lane, so _mm_packs_epi32 packs
+ * unsigned 16-bit values without saturating them.
+ */
+inline __m128i simdSignExtend16(__m128i v)
+{
+    return _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+}
+
+/**
+ * Loads four 3-element vectors and transposes them to x, y and z lanes.
+ */
+inline void simdLoadTransposed3(const float* v, __m128* x, __m128* y, __m128* z)
+{
+    *x = _mm_setr_ps(v[0], v[3], v[6], v[9]);
+    *y = _mm_setr_ps(v[1], v[4], v[7], v[10]);
+    *z = _mm_setr_ps(v[2], v[5], v[8], v[11]);
+}
+
+/**
+ * Loads four 4-element vectors and transposes them to x, y, z and w lanes.
+ */
+inline void simdLoadTransposed4(const float* v, __m128* x, __m128* y, __m128* z, __m128* w)
+{
+    __m128 r0 = _mm_loadu_ps(v);
+    __m128 r1 = _mm_loadu_ps(v + 4);
+    __m128 r2 = _mm_loadu_ps(v + 8);
+    __m128 r3 = _mm_loadu_ps(v + 12);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    *x = r0;
+    *y = r1;
+    *z = r2;
+    *w = r3;
+}
+
+/**
+ * Transposes x, y and z lanes back to four 3-element vectors and stores them.
+ */
+inline void simdStoreTransposed3(float* v, __m128 x, __m128 y, __m128 z)
+{
+    float tx[4], ty[4], tz[4];
+    _mm_storeu_ps(tx, x);
+    _mm_storeu_ps(ty, y);
+    _mm_storeu_ps(tz, z);
+    for (int i = 0; i < 4; i++)
+    {
+        v[i * 3] = tx[i];
+        v[i * 3 + 1] = ty[i];
+        v[i * 3 + 2] = tz[i];
+    }
+}
+
+/**
+ * Transposes x, y, z and w lanes back to four 4-element vectors and stores them.
+ */
+inline void simdStoreTransposed4(float* v, __m128 x, __m128 y, __m128 z, __m128 w)
+{
+    _MM_TRANSPOSE4_PS(x, y, z, w);
+    _mm_storeu_ps(v, x);
+    _mm_storeu_ps(v + 4, y);
+    _mm_storeu_ps(v + 8, z);
+    _mm_storeu_ps(v + 12, w);
+}
+
+#endif
+
+/**
+ * Scalar counterpart of simdClamp(). NaN becomes lo.
+ */
+inline float simdClamp(float v, float lo, float hi)
+{
+    v = v > lo ? v : lo;
+    return v < hi ? v : hi;
+}
+
+/**
+ * Lane types for writing a kernel once and running it both 4-wide and scalar.
+ *
+ * RSimd1f/RSimd1i hold one float/int32 lane and RSimd4f/RSimd4i hold four.
+ * Both pairs expose the same operators and simd* functions, so a kernel
+ * written as a template over <F, I> compiles to SSE2 for the bulk of an
+ * array and to plain scalar code for the tail, with bit-identical results.
+ *
+ * Comparisons return a mask of the same type (all bits set where true),
+ * which is consumed by simdSelect() or the bitwise operators. Integer
+ * arithmetic wraps and >> is a logical shift, as used by hash functions.
+ */
+struct RSimd1f;
+struct RSimd1i;
+
+struct RSimd1f
+{
+    static const int WIDTH = 1;
+    float v;
+
+    RSimd1f() { }
+    RSimd1f(float f) : v(f) { }
+    static RSimd1f load(const float* p) { return RSimd1f(*p); }
+    void store(float* p) const { *p = v; }
+    float lane(int) const { return v; }
+};
+
+struct RSimd1i
+{
+    static const int WIDTH = 1;
+    int32_t v;
+
+    RSimd1i() { }
+    RSimd1i(int32_t i) : v(i) { }
+    static RSimd1i load(const int32_t* p) { return RSimd1i(*p); }
+    void store(int32_t* p) const { *p = v; }
+    int32_t lane(int) const { return v; }
+};
+
+inline uint32_t simdBits(float f) { uint32_t u; memcpy(&u, &f, 4); return u; }
+inline float simdFromBits(uint32_t u) { float f; memcpy(&f, &u, 4); return f; }
+inline RSimd1f simdMask1f(bool b) { return RSimd1f(simdFromBits(b ? 0xffffffffu : 0u)); }
+
+inline RSimd1f operator+(RSimd1f a, RSimd1f b) { return RSimd1f(a.v + b.v); }
+inline RSimd1f operator-(RSimd1f a, RSimd1f b) { return RSimd1f(a.v - b.v); }
+inline RSimd1f operator*(RSimd1f a, RSimd1f b) { return RSimd1f(a.v * b.v); }
+inline RSimd1f operator/(RSimd1f a, RSimd1f b) { return RSimd1f(a.v / b.v); }
+inline RSimd1f operator-(RSimd1f a) { return RSimd1f(simdFromBits(simdBits(a.v) ^ 0x80000000u)); }
+inline RSimd1f operator&(RSimd1f a, RSimd1f b) { return RSimd1f(simdFromBits(simdBits(a.v) & simdBits(b.v))); }
+inline RSimd1f operator|(RSimd1f a, RSimd1f b) { return RSimd1f(simdFromBits(simdBits(a.v) | simdBits(b.v))); }
+inline RSimd1f operator^(RSimd1f a, RSimd1f b) { return RSimd1f(simdFromBits(simdBits(a.v) ^ simdBits(b.v))); }
+inline RSimd1f operator<(RSimd1f a, RSimd1f b) { return simdMask1f(a.v < b.v); }
+inline RSimd1f operator>(RSimd1f a, RSimd1f b) { return simdMask1f(a.v > b.v); }
+inline RSimd1f operator<=(RSimd1f a, RSimd1f b) { return simdMask1f(a.v <= b.v); }
+inline RSimd1f operator>=(RSimd1f a, RSimd1f b) { return simdMask1f(a.v >= b.v); }
+inline RSimd1f operator==(RSimd1f a, RSimd1f b) { return simdMask1f(a.v == b.v); }
+inline RSimd1f simdSelect(RSimd1f mask, RSimd1f a, RSimd1f b) { return (mask & a) | RSimd1f(simdFromBits(~simdBits(mask.v) & simdBits(b.v))); }
+inline RSimd1f simdMin(RSimd1f a, RSimd1f b) { return RSimd1f(a.v < b.v ? a.v : b.v); }
+inline RSimd1f simdMax(RSimd1f a, RSimd1f b) { return RSimd1f(a.v > b.v ? a.v : b.v); }
+inline RSimd1f simdAbs(RSimd1f a) { return RSimd1f(simdFromBits(simdBits(a.v) & 0x7fffffffu)); }
+inline RSimd1f simdSqrt(RSimd1f a) { return RSimd1f(sqrtf(a.v)); }
+
+inline RSimd1i operator+(RSimd1i a, RSimd1i b) { return RSimd1i((int32_t)((uint32_t)a.v + (uint32_t)b.v)); }
+inline RSimd1i operator-(RSimd1i a, RSimd1i b) { return RSimd1i((int32_t)((uint32_t)a.v - (uint32_t)b.v)); }
+inline RSimd1i operator*(RSimd1i a, RSimd1i b) { return RSimd1i((int32_t)((uint32_t)a.v * (uint32_t)b.v)); }
+inline RSimd1i operator&(RSimd1i a, RSimd1i b) { return RSimd1i(a.v & b.v); }
+inline RSimd1i operator|(RSimd1i a, RSimd1i b) { return RSimd1i(a.v | b.v); }
+inline RSimd1i operator^(RSimd1i a, RSimd1i b) { return RSimd1i(a.v ^ b.v); }
+inline RSimd1i operator<<(RSimd1i a, int n) { return RSimd1i((int32_t)((uint32_t)a.v << n)); }
+inline RSimd1i operator>>(RSimd1i a, int n) { return RSimd1i((int32_t)((uint32_t)a.v >> n)); }
+inline RSimd1i operator==(RSimd1i a, RSimd1i b) { return RSimd1i(a.v == b.v ? -1 : 0); }
+inline RSimd1i operator>(RSimd1i a, RSimd1i b) { return RSimd1i(a.v > b.v ? -1 : 0); }
+inline RSimd1i simdSelect(RSimd1i mask, RSimd1i a, RSimd1i b) { return RSimd1i((mask.v & a.v) | (~mask.v & b.v)); }
+
+inline RSimd1f simdCastToFloat(RSimd1i a) { return RSimd1f(simdFromBits((uint32_t)a.v)); }
+inline RSimd1i simdCastToInt(RSimd1f a) { return RSimd1i((int32_t)simdBits(a.v)); }
+inline RSimd1f simdConvert(RSimd1i a) { return RSimd1f((float)a.v); }
+inline RSimd1i simdTruncate(RSimd1f a) { return RSimd1i((int32_t)a.v); }
+
+#ifdef ROCKET_SIMD_SSE2
+
+struct RSimd4f
+{
+    static const int WIDTH = 4;
+    __m128 v;
+
+    RSimd4f() { }
+    RSimd4f(__m128 m) : v(m) { }
+    RSimd4f(float f) : v(_mm_set1_ps(f)) { }
+    static RSimd4f load(const float* p) { return RSimd4f(_mm_loadu_ps(p)); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+    float lane(int i) const { float t[4]; _mm_storeu_ps(t, v); return t[i]; }
+};
+
+struct RSimd4i
+{
+    static const int WIDTH = 4;
+    __m128i v;
+
+    RSimd4i() { }
+    RSimd4i(__m128i m) : v(m) { }
+    RSimd4i(int32_t i) : v(_mm_set1_epi32(i)) { }
+    static RSimd4i load(const int32_t* p) { return RSimd4i(_mm_loadu_si128((const __m128i*)p)); }
+    void store(int32_t* p) const { _mm_storeu_si128((__m128i*)p, v); }
+    int32_t lane(int i) const { int32_t t[4]; _mm_storeu_si128((__m128i*)t, v); return t[i]; }
+};
+
+inline RSimd4f operator+(RSimd4f a, RSimd4f b) { return _mm_add_ps(a.v, b.v); }
+inline RSimd4f operator-(RSimd4f a, RSimd4f b) { return _mm_sub_ps(a.v, b.v); }
+inline RSimd4f operator*(RSimd4f a, RSimd4f b) { return _mm_mul_ps(a.v, b.v); }
+inline RSimd4f operator/(RSimd4f a, RSimd4f b) { return _mm_div_ps(a.v, b.v); }
+inline RSimd4f operator-(RSimd4f a) { return _mm_xor_ps(a.v, _mm_set1_ps(-0.0f)); }
+inline RSimd4f operator&(RSimd4f a, RSimd4f b) { return _mm_and_ps(a.v, b.v); }
+inline RSimd4f operator|(RSimd4f a, RSimd4f b) { return _mm_or_ps(a.v, b.v); }
+inline RSimd4f operator^(RSimd4f a, RSimd4f b) { return _mm_xor_ps(a.v, b.v); }
+inline RSimd4f operator<(RSimd4f a, RSimd4f b) { return _mm_cmplt_ps(a.v, b.v); }
+inline RSimd4f operator>(RSimd4f a, RSimd4f b) { return _mm_cmpgt_ps(a.v, b.v); }
+inline RSimd4f operator<=(RSimd4f a, RSimd4f b) { return _mm_cmple_ps(a.v, b.v); }
+inline RSimd4f operator>=(RSimd4f a, RSimd4f b) { return _mm_cmpge_ps(a.v, b.v); }
+inline RSimd4f operator==(RSimd4f a, RSimd4f b) { return _mm_cmpeq_ps(a.v, b.v); }
+inline RSimd4f simdSelect(RSimd4f mask, RSimd4f a, RSimd4f b) { return simdSelect(mask.v, a.v, b.v); }
+inline RSimd4f simdMin(RSimd4f a, RSimd4f b) { return _mm_min_ps(a.v, b.v); }
+inline RSimd4f simdMax(RSimd4f a, RSimd4f b) { return _mm_max_ps(a.v, b.v); }
+inline RSimd4f simdAbs(RSimd4f a) { return simdAbs(a.v); }
+inline RSimd4f simdSqrt(RSimd4f a) { return _mm_sqrt_ps(a.v); }
+
+inline RSimd4i operator+(RSimd4i a, RSimd4i b) { return _mm_add_epi32(a.v, b.v); }
+inline RSimd4i operator-(RSimd4i a, RSimd4i b) { return _mm_sub_epi32(a.v, b.v); }
+inline RSimd4i operator*(RSimd4i a, RSimd4i b)
+{
+    // SSE2 has no 32-bit low multiply, build it from the two 32x32->64 multiplies.
+    __m128i even = _mm_mul_epu32(a.v, b.v);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a.v, 32), _mm_srli_epi64(b.v, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+inline RSimd4i operator&(RSimd4i a, RSimd4i b) { return _mm_and_si128(a.v, b.v); }
+inline RSimd4i operator|(RSimd4i a, RSimd4i b) { return _mm_or_si128(a.v, b.v); }
+inline RSimd4i operator^(RSimd4i a, RSimd4i b) { return _mm_xor_si128(a.v, b.v); }
+inline RSimd4i operator<<(RSimd4i a, int n) { return _mm_slli_epi32(a.v, n); }
+inline RSimd4i operator>>(RSimd4i a, int n) { return _mm_srli_epi32(a.v, n); }
+inline RSimd4i operator==(RSimd4i a, RSimd4i b) { return _mm_cmpeq_epi32(a.v, b.v); }
+inline RSimd4i operator>(RSimd4i a, RSimd4i b) { return _mm_cmpgt_epi32(a.v, b.v); }
+inline RSimd4i simdSelect(RSimd4i mask, RSimd4i a, RSimd4i b) { return simdSelect(mask.v, a.v, b.v); }
+
+inline RSimd4f simdCastToFloat(RSimd4i a) { return _mm_castsi128_ps(a.v); }
+inline RSimd4i simdCastToInt(RSimd4f a) { return _mm_castps_si128(a.v); }
+inline RSimd4f simdConvert(RSimd4i a) { return _mm_cvtepi32_ps(a.v); }
+inline RSimd4i simdTruncate(RSimd4f a) { return _mm_cvttps_epi32(a.v); }
+
+#endif
+
+/**
+ * Rounds each lane towards negative infinity, returning an integer.
+ * Valid for |v| < 2^31.
+ */
+template <typename F, typename I>
+inline I simdFloorToInt(F v)
+{
+    I i = simdTruncate(v);
+    // Truncation rounds negative non-integers up, step those down by one.
+    return i + simdCastToInt(v < simdConvert(i));
+}
+
+/**
+ * Runs kernel(lane, i) for i = 0, WIDTH, 2 * WIDTH, ... below count, where
+ * lane is a default constructed RSimd4f with SSE2 and RSimd1f otherwise.
+ *
+ * Kernels take the lane type from decltype(lane), so one generic lambda
+ * serves every width. count must be a multiple of 4 (arrays padded so the
+ * kernel can read and write whole lanes past the last element).
+ */
+template <typename Kernel>
+inline void simdForEach(size_t count, const Kernel& kernel)
+{
+#ifdef ROCKET_SIMD_SSE2
+    for (size_t i = 0; i < count; i += 4)
+        kernel(RSimd4f(), i);
+#else
+    for (size_t i = 0; i < count; i++)
+        kernel(RSimd1f(), i);
+#endif
+}
+
+}
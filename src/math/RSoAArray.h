@@ -0,0 +1,322 @@
+#pragma once
+
+#include "common.h"
+#include "RSimd.h"
+#include <iterator>
+#include <new>
+
+namespace rocket
+{
+
+/**
+ * Describes how a type is split into float components for RSoAArray.
+ *
+ * Specializations define COMPONENTS and two functions that copy a value to
+ * and from one float per component. The vector and quaternion types are
+ * provided here; RTransform is provided by RTransformArray.h.
+ */
+template <typename T>
+struct RSoATraits;
+
+/**
+ * Traits for types made of N contiguous floats starting at member x.
+ */
+template <typename T, unsigned int N>
+struct RSoAFloatTraits
+{
+    static const unsigned int COMPONENTS = N;
+
+    static void load(const T& value, float* dst) { memcpy(dst, &value.x, N * sizeof(float)); }
+
+    static void store(const float* src, T* dst) { memcpy(&dst->x, src, N * sizeof(float)); }
+};
+
+template <> struct RSoATraits<float>
+{
+    static const unsigned int COMPONENTS = 1;
+
+    static void load(float value, float* dst) { *dst = value; }
+
+    static void store(const float* src, float* dst) { *dst = *src; }
+};
+
+template <> struct RSoATraits<RVector2> : RSoAFloatTraits<RVector2, 2> { };
+template <> struct RSoATraits<RVector3> : RSoAFloatTraits<RVector3, 3> { };
+template <> struct RSoATraits<RVector4> : RSoAFloatTraits<RVector4, 4> { };
+template <> struct RSoATraits<RQuaternion> : RSoAFloatTraits<RQuaternion, 4> { };
+
+/**
+ * Defines a structure of arrays container.
+ *
+ * Each float component of T is stored in its own array (stream), so
+ * the x of consecutive elements are adjacent, then the y and so on. Batch
+ * kernels load four elements of one component with a single SSE2 load, and
+ * a loop that only reads some components only touches those cache lines.
+ *
+ * Every stream starts on a 64-byte boundary and is padded to a multiple of
+ * 16 elements (getPaddedSize()), so kernels run whole lanes without a
+ * scalar tail. The values in the padding are unspecified.
+ *
+ * Elements are accessed by value with get() and set(), or through proxy
+ * references from operator[] and the iterators, which convert to T and
+ * assign from T. The iterators are random access, so standard algorithms
+ * (std::copy, std::transform, std::sort, ...) work on the container.
+ */
+template <typename T>
+class RSoAArray
+{
+public:
+
+    /**
+     * The number of float streams.
+     */
+    static const unsigned int COMPONENTS = RSoATraits<T>::COMPONENTS;
+
+    /**
+     * The number of elements streams are padded to a multiple of.
+     */
+    static const size_t PADDING = 16;
+
+    /**
+     * The alignment of each stream, in bytes.
+     */
+    static const size_t ALIGNMENT = 64;
+
+    /**
+     * Proxy for an element, converts to T and assigns from T.
+     */
+    class Reference
+    {
+    public:
+
+        Reference(RSoAArray* array, size_t index) : _array(array), _index(index) { }
+
+        operator T() const { return _array->get(_index); }
+
+        Reference& operator=(const T& value) { _array->set(_index, value); return *this; }
+
+        Reference& operator=(const Reference& other) { _array->set(_index, other._array->get(other._index)); return *this; }
+
+        /**
+         * Gets a component of the element.
+         */
+        float& operator[](unsigned int component) const { return _array->getComponent(component)[_index]; }
+
+        friend void swap(Reference a, Reference b)
+        {
+            T value = a;
+            a = (T)b;
+            b = value;
+        }
+
+    private:
+
+        RSoAArray* _array;
+        size_t _index;
+    };
+
+    /**
+     * Random access iterator, dereferences to R (Reference or T).
+     */
+    template <typename A, typename R>
+    class IteratorBase
+    {
+    public:
+
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef R reference;
+        typedef void pointer;
+
+        IteratorBase() : _array(NULL), _index(0) { }
+        IteratorBase(A* array, size_t index) : _array(array), _index(index) { }
+
+        R operator*() const { return (*_array)[_index]; }
+        R operator[](difference_type n) const { return (*_array)[_index + n]; }
+
+        IteratorBase& operator++() { _index++; return *this; }
+        IteratorBase& operator--() { _index--; return *this; }
+        IteratorBase operator++(int) { IteratorBase it = *this; _index++; return it; }
+        IteratorBase operator--(int) { IteratorBase it = *this; _index--; return it; }
+        IteratorBase& operator+=(difference_type n) { _index += n; return *this; }
+        IteratorBase& operator-=(difference_type n) { _index -= n; return *this; }
+        IteratorBase operator+(difference_type n) const { return IteratorBase(_array, _index + n); }
+        IteratorBase operator-(difference_type n) const { return IteratorBase(_array, _index - n); }
+        friend IteratorBase operator+(difference_type n, const IteratorBase& it) { return it + n; }
+        difference_type operator-(const IteratorBase& it) const { return (difference_type)_index - (difference_type)it._index; }
+
+        bool operator==(const IteratorBase& it) const { return _index == it._index; }
+        bool operator!=(const IteratorBase& it) const { return _index != it._index; }
+        bool operator<(const IteratorBase& it) const { return _index < it._index; }
+        bool operator>(const IteratorBase& it) const { return _index > it._index; }
+        bool operator<=(const IteratorBase& it) const { return _index <= it._index; }
+        bool operator>=(const IteratorBase& it) const { return _index >= it._index; }
+
+    private:
+
+        A* _array;
+        size_t _index;
+    };
+
+    typedef IteratorBase<RSoAArray, Reference> iterator;
+    typedef IteratorBase<const RSoAArray, T> const_iterator;
+
+    /**
+     * Constructs an empty array.
+     */
+    RSoAArray();
+
+    /**
+     * Constructs an array of count copies of value.
+     *
+     * @param count The number of elements.
+     * @param value The value of the elements.
+     */
+    explicit RSoAArray(size_t count, const T& value = T());
+
+    /**
+     * Copy constructor.
+     */
+    RSoAArray(const RSoAArray& copy);
+
+    /**
+     * Move constructor.
+     */
+    RSoAArray(RSoAArray&& other);
+
+    /**
+     * Destructor.
+     */
+    ~RSoAArray();
+
+    RSoAArray& operator=(const RSoAArray& copy);
+
+    RSoAArray& operator=(RSoAArray&& other);
+
+    /**
+     * Gets the number of elements.
+     *
+     * @return The number of elements.
+     */
+    size_t size() const;
+
+    /**
+     * Gets the number of elements rounded up to PADDING, the number of
+     * elements batch kernels may read and write in each stream.
+     *
+     * @return The padded number of elements.
+     */
+    size_t getPaddedSize() const;
+
+    /**
+     * Determines if the array is empty.
+     *
+     * @return true if there are no elements.
+     */
+    bool empty() const;
+
+    /**
+     * Gets the number of elements that fit in the current allocation.
+     *
+     * @return The capacity, a multiple of PADDING.
+     */
+    size_t capacity() const;
+
+    /**
+     * Grows the allocation to hold at least count elements.
+     *
+     * @param count The number of elements.
+     */
+    void reserve(size_t count);
+
+    /**
+     * Resizes the array, new elements are set to value.
+     *
+     * @param count The new number of elements.
+     * @param value The value of new elements.
+     */
+    void resize(size_t count, const T& value = T());
+
+    /**
+     * Removes all elements, keeping the allocation.
+     */
+    void clear();
+
+    /**
+     * Appends an element.
+     *
+     * @param value The element to append.
+     */
+    void push_back(const T& value);
+
+    /**
+     * Removes the last element.
+     */
+    void pop_back();
+
+    /**
+     * Gets an element.
+     *
+     * @param index The index of the element.
+     *
+     * @return The element.
+     */
+    T get(size_t index) const;
+
+    /**
+     * Sets an element.
+     *
+     * @param index The index of the element.
+     * @param value The new value.
+     */
+    void set(size_t index, const T& value);
+
+    /**
+     * Gets the stream of a component.
+     *
+     * @param component The component index, less than COMPONENTS.
+     *
+     * @return getPaddedSize() floats, aligned to ALIGNMENT.
+     */
+    float* getComponent(unsigned int component);
+
+    /**
+     * Gets the stream of a component.
+     *
+     * @param component The component index, less than COMPONENTS.
+     *
+     * @return getPaddedSize() floats, aligned to ALIGNMENT.
+     */
+    const float* getComponent(unsigned int component) const;
+
+    Reference operator[](size_t index);
+
+    T operator[](size_t index) const;
+
+    iterator begin();
+
+    iterator end();
+
+    const_iterator begin() const;
+
+    const_iterator end() const;
+
+private:
+
+    void reallocate(size_t capacity);
+
+    float* _data;
+    size_t _size;
+    size_t _capacity;
+};
+
+/**
+ * A padded, aligned array of floats, the result of per element batch queries
+ * such as lengths and dot products.
+ */
+typedef RSoAArray<float> RFloatArray;
+
+}
+
+#include "RSoAArray.inl"
@@ -0,0 +1,225 @@
+#include "RSoAArray.h"
+
+namespace rocket
+{
+
+template <typename T>
+inline RSoAArray<T>::RSoAArray()
+    : _data(NULL), _size(0), _capacity(0)
+{
+}
+
+template <typename T>
+inline RSoAArray<T>::RSoAArray(size_t count, const T& value)
+    : _data(NULL), _size(0), _capacity(0)
+{
+    resize(count, value);
+}
+
+template <typename T>
+inline RSoAArray<T>::RSoAArray(const RSoAArray& copy)
+    : _data(NULL), _size(0), _capacity(0)
+{
+    *this = copy;
+}
+
+template <typename T>
+inline RSoAArray<T>::RSoAArray(RSoAArray&& other)
+    : _data(other._data), _size(other._size), _capacity(other._capacity)
+{
+    other._data = NULL;
+    other._size = 0;
+    other._capacity = 0;
+}
+
+template <typename T>
+inline RSoAArray<T>::~RSoAArray()
+{
+    ::operator delete(_data, std::align_val_t(ALIGNMENT));
+}
+
+template <typename T>
+inline RSoAArray<T>& RSoAArray<T>::operator=(const RSoAArray& copy)
+{
+    if (this != &copy)
+    {
+        _size = 0;
+        reserve(copy._size);
+        _size = copy._size;
+        if (_size > 0)
+        {
+            for (unsigned int c = 0; c < COMPONENTS; c++)
+                memcpy(getComponent(c), copy.getComponent(c), getPaddedSize() * sizeof(float));
+        }
+    }
+    return *this;
+}
+
+template <typename T>
+inline RSoAArray<T>& RSoAArray<T>::operator=(RSoAArray&& other)
+{
+    if (this != &other)
+    {
+        ::operator delete(_data, std::align_val_t(ALIGNMENT));
+        _data = other._data;
+        _size = other._size;
+        _capacity = other._capacity;
+        other._data = NULL;
+        other._size = 0;
+        other._capacity = 0;
+    }
+    return *this;
+}
+
+template <typename T>
+inline size_t RSoAArray<T>::size() const
+{
+    return _size;
+}
+
+template <typename T>
+inline size_t RSoAArray<T>::getPaddedSize() const
+{
+    return (_size + PADDING - 1) & ~(PADDING - 1);
+}
+
+template <typename T>
+inline bool RSoAArray<T>::empty() const
+{
+    return _size == 0;
+}
+
+template <typename T>
+inline size_t RSoAArray<T>::capacity() const
+{
+    return _capacity;
+}
+
+template <typename T>
+inline void RSoAArray<T>::reserve(size_t count)
+{
+    if (count > _capacity)
+        reallocate(std::max((count + PADDING - 1) & ~(PADDING - 1), _capacity * 2));
+}
+
+template <typename T>
+inline void RSoAArray<T>::resize(size_t count, const T& value)
+{
+    reserve(count);
+    if (count > _size)
+    {
+        float components[COMPONENTS];
+        RSoATraits<T>::load(value, components);
+        for (unsigned int c = 0; c < COMPONENTS; c++)
+            std::fill(getComponent(c) + _size, getComponent(c) + count, components[c]);
+    }
+    _size = count;
+}
+
+template <typename T>
+inline void RSoAArray<T>::clear()
+{
+    _size = 0;
+}
+
+template <typename T>
+inline void RSoAArray<T>::push_back(const T& value)
+{
+    reserve(_size + 1);
+    _size++;
+    set(_size - 1, value);
+}
+
+template <typename T>
+inline void RSoAArray<T>::pop_back()
+{
+    if (_size > 0)
+        _size--;
+}
+
+template <typename T>
+inline T RSoAArray<T>::get(size_t index) const
+{
+    float components[COMPONENTS];
+    for (unsigned int c = 0; c < COMPONENTS; c++)
+        components[c] = _data[c * _capacity + index];
+    T value;
+    RSoATraits<T>::store(components, &value);
+    return value;
+}
+
+template <typename T>
+inline void RSoAArray<T>::set(size_t index, const T& value)
+{
+    float components[COMPONENTS];
+    RSoATraits<T>::load(value, components);
+    for (unsigned int c = 0; c < COMPONENTS; c++)
+        _data[c * _capacity + index] = components[c];
+}
+
+template <typename T>
+inline float* RSoAArray<T>::getComponent(unsigned int component)
+{
+    return _data + component * _capacity;
+}
+
+template <typename T>
+inline const float* RSoAArray<T>::getComponent(unsigned int component) const
+{
+    return _data + component * _capacity;
+}
+
+template <typename T>
+inline typename RSoAArray<T>::Reference RSoAArray<T>::operator[](size_t index)
+{
+    return Reference(this, index);
+}
+
+template <typename T>
+inline T RSoAArray<T>::operator[](size_t index) const
+{
+    return get(index);
+}
+
+template <typename T>
+inline typename RSoAArray<T>::iterator RSoAArray<T>::begin()
+{
+    return iterator(this, 0);
+}
+
+template <typename T>
+inline typename RSoAArray<T>::iterator RSoAArray<T>::end()
+{
+    return iterator(this, _size);
+}
+
+template <typename T>
+inline typename RSoAArray<T>::const_iterator RSoAArray<T>::begin() const
+{
+    return const_iterator(this, 0);
+}
+
+template <typename T>
+inline typename RSoAArray<T>::const_iterator RSoAArray<T>::end() const
+{
+    return const_iterator(this, _size);
+}
+
+template <typename T>
+inline void RSoAArray<T>::reallocate(size_t capacity)
+{
+    // Streams are laid out back to back, each capacity floats long. The
+    // capacity is a multiple of PADDING, so every stream stays aligned.
+    float* data = (float*)::operator new(capacity * COMPONENTS * sizeof(float), std::align_val_t(ALIGNMENT));
+    memset(data, 0, capacity * COMPONENTS * sizeof(float));
+    if (_data)
+    {
+        for (unsigned int c = 0; c < COMPONENTS; c++)
+            memcpy(data + c * capacity, _data + c * _capacity, _size * sizeof(float));
+        ::operator delete(_data, std::align_val_t(ALIGNMENT));
+    }
+    _data = data;
+    _capacity = capacity;
+}
+
+}
@@ -0,0 +1,128 @@
+#include "common.h"
+#include "RTransformArray.h"
+
+namespace rocket
+{
+
+/**
+ * Rotates (vx, vy, vz) by the unit quaternion (qx, qy, qz, qw).
+ */
+template <typename F>
+static inline void rotateVector(F qx, F qy, F qz, F qw, F* vx, F* vy, F* vz)
+{
+    F two(2.0f);
+    F tx = (qy * *vz - qz * *vy) * two;
+    F ty = (qz * *vx - qx * *vz) * two;
+    F tz = (qx * *vy - qy * *vx) * two;
+    *vx = *vx + qw * tx + (qy * tz - qz * ty);
+    *vy = *vy + qw * ty + (qz * tx - qx * tz);
+    *vz = *vz + qw * tz + (qx * ty - qy * tx);
+}
+
+void RTransformArray::compose(const RTransformArray& parents, const RTransformArray& locals, RTransformArray* dst)
+{
+    dst->resize(parents.size());
+    simdForEach(parents.getPaddedSize(), [&](auto lane, size_t i)
+    {
+        typedef decltype(lane) F;
+        F p[COMPONENTS], l[COMPONENTS];
+        for (unsigned int c = 0; c < COMPONENTS; c++)
+        {
+            p[c] = F::load(parents.getComponent(c) + i);
+            l[c] = F::load(locals.getComponent(c) + i);
+        }
+
+        // Translation: parent translation + parent rotation * (parent scale * local translation).
+        F tx = p[SCALE] * l[TRANSLATION];
+        F ty = p[SCALE + 1] * l[TRANSLATION + 1];
+        F tz = p[SCALE + 2] * l[TRANSLATION + 2];
+        rotateVector(p[ROTATION], p[ROTATION + 1], p[ROTATION + 2], p[ROTATION + 3], &tx, &ty, &tz);
+
+        F x1 = p[ROTATION], y1 = p[ROTATION + 1], z1 = p[ROTATION + 2], w1 = p[ROTATION + 3];
+        F x2 = l[ROTATION], y2 = l[ROTATION + 1], z2 = l[ROTATION + 2], w2 = l[ROTATION + 3];
+
+        F r[COMPONENTS];
+        r[TRANSLATION] = p[TRANSLATION] + tx;
+        r[TRANSLATION + 1] = p[TRANSLATION + 1] + ty;
+        r[TRANSLATION + 2] = p[TRANSLATION + 2] + tz;
+        r[ROTATION] = w1 * x2 + x1 * w2 + y1 * z2 - z1 * y2;
+        r[ROTATION + 1] = w1 * y2 - x1 * z2 + y1 * w2 + z1 * x2;
+        r[ROTATION + 2] = w1 * z2 + x1 * y2 - y1 * x2 + z1 * w2;
+        r[ROTATION + 3] = w1 * w2 - x1 * x2 - y1 * y2 - z1 * z2;
+        r[SCALE] = p[SCALE] * l[SCALE];
+        r[SCALE + 1] = p[SCALE + 1] * l[SCALE + 1];
+        r[SCALE + 2] = p[SCALE + 2] * l[SCALE + 2];
+
+        for (unsigned int c = 0; c < COMPONENTS; c++)
+            r[c].store(dst->getComponent(c) + i);
+    });
+}
+
+void RTransformArray::getMatrices(RMatrix* dst) const
+{
+    if (empty())
+        return;
+
+    // Computed four transforms at a time into a column-major scratch block, then copied out.
+    float m[16][4];
+    for (size_t base = 0; base < size(); base += 4)
+    {
+        simdForEach(4, [&](auto lane, size_t j)
+        {
+            typedef decltype(lane) F;
+            size_t i = base + j;
+            F tx = F::load(getComponent(TRANSLATION) + i);
+            F ty = F::load(getComponent(TRANSLATION + 1) + i);
+            F tz = F::load(getComponent(TRANSLATION + 2) + i);
+            F x = F::load(getComponent(ROTATION) + i);
+            F y = F::load(getComponent(ROTATION + 1) + i);
+            F z = F::load(getComponent(ROTATION + 2) + i);
+            F w = F::load(getComponent(ROTATION + 3) + i);
+            F sx = F::load(getComponent(SCALE) + i);
+            F sy = F::load(getComponent(SCALE + 1) + i);
+            F sz = F::load(getComponent(SCALE + 2) + i);
+
+            F x2 = x + x, y2 = y + y, z2 = z + z;
+            F xx2 = x * x2, yy2 = y * y2, zz2 = z * z2;
+            F xy2 = x * y2, xz2 = x * z2, yz2 = y * z2;
+            F wx2 = w * x2, wy2 = w * y2, wz2 = w * z2;
+            F one(1.0f), zero(0.0f);
+
+            F columns[16] =
+            {
+                (one - yy2 - zz2) * sx, (xy2 + wz2) * sx, (xz2 - wy2) * sx, zero,
+                (xy2 - wz2) * sy, (one - xx2 - zz2) * sy, (yz2 + wx2) * sy, zero,
+                (xz2 + wy2) * sz, (yz2 - wx2) * sz, (one - xx2 - yy2) * sz, zero,
+                tx, ty, tz, one
+            };
+            for (unsigned int k = 0; k < 16; k++)
+                columns[k].store(&m[k][j]);
+        });
+
+        size_t n = size() - base < 4 ? size() - base : 4;
+        for (size_t j = 0; j < n; j++)
+        {
+            for (unsigned int k = 0; k < 16; k++)
+                dst[base + j].m[k] = m[k][j];
+        }
+    }
+}
+
+void RTransformArray::transformPoints(const RVector3Array& points, RVector3Array* dst) const
+{
+    dst->resize(size());
+    simdForEach(getPaddedSize(), [&](auto lane, size_t i)
+    {
+        typedef decltype(lane) F;
+        F x = F::load(points.getComponent(0) + i) * F::load(getComponent(SCALE) + i);
+        F y = F::load(points.getComponent(1) + i) * F::load(getComponent(SCALE + 1) + i);
+        F z = F::load(points.getComponent(2) + i) * F::load(getComponent(SCALE + 2) + i);
+        rotateVector(F::load(getComponent(ROTATION) + i), F::load(getComponent(ROTATION + 1) + i),
+                     F::load(getComponent(ROTATION + 2) + i), F::load(getComponent(ROTATION + 3) + i), &x, &y, &z);
+        (x + F::load(getComponent(TRANSLATION) + i)).store(dst->getComponent(0) + i);
+        (y + F::load(getComponent(TRANSLATION + 1) + i)).store(dst->getComponent(1) + i);
+        (z + F::load(getComponent(TRANSLATION + 2) + i)).store(dst->getComponent(2) + i);
+    });
+}
+
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "RQuaternionArray.h"
+#include "RTransform.h"
+
+namespace rocket
+{
+
+/**
+ * Splits an RTransform into its translation, rotation and scale components.
+ */
+template <> struct RSoATraits<RTransform>
+{
+    static const unsigned int COMPONENTS = 10;
+
+    static void load(const RTransform& value, float* dst)
+    {
+        memcpy(dst, &value.getTranslation().x, 3 * sizeof(float));
+        memcpy(dst + 3, &value.getRotation().x, 4 * sizeof(float));
+        memcpy(dst + 7, &value.getScale().x, 3 * sizeof(float));
+    }
+
+    static void store(const float* src, RTransform* dst)
+    {
+        dst->set(RVector3(src[7], src[8], src[9]), RQuaternion(src[3], src[4], src[5], src[6]), RVector3(src[0], src[1], src[2]));
+    }
+};
+
+/**
+ * Defines a structure of arrays container of translation, rotation, scale
+ * transforms with batch composition, the hot loop of a transform hierarchy.
+ *
+ * The components are the translation x, y, z, the rotation x, y, z, w and
+ * the scale x, y, z; TRANSLATION, ROTATION and SCALE are the indices of the
+ * first component of each. Elements converted back to RTransform never
+ * notify transform listeners.
+ */
+class API RTransformArray : public RSoAArray<RTransform>
+{
+public:
+
+    static const unsigned int TRANSLATION = 0;
+    static const unsigned int ROTATION = 3;
+    static const unsigned int SCALE = 7;
+
+    using RSoAArray<RTransform>::RSoAArray;
+
+    /**
+     * Composes transforms element-wise, as the world transforms of locals
+     * attached to parents.
+     *
+     * Like RTransform, scale is applied component-wise and non-uniform
+     * parent scale does not skew rotated children.
+     *
+     * @param parents The parent transforms.
+     * @param locals The local transforms, the same size as parents.
+     * @param dst The array to store the composed transforms in, may be parents or locals.
+     */
+    static void compose(const RTransformArray& parents, const RTransformArray& locals, RTransformArray* dst);
+
+    /**
+     * Computes the matrix of every transform, as RTransform::getMatrix() does.
+     *
+     * @param dst An array of size() matrices.
+     */
+    void getMatrices(RMatrix* dst) const;
+
+    /**
+     * Transforms one point by each transform.
+     *
+     * @param points The points, the same size as this array.
+     * @param dst The array to store the transformed points in.
+     */
+    void transformPoints(const RVector3Array& points, RVector3Array* dst) const;
+};
+
+}
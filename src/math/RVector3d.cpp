@@ -0,0 +1,176 @@
+#include "common.h"
+#include "RVector3d.h"
+#include "RBoundingSphere.h"
+
+namespace rocket
+{
+
+RVector3d::RVector3d()
+    : x(0.0), y(0.0), z(0.0)
+{
+}
+
+RVector3d::RVector3d(double x, double y, double z)
+    : x(x), y(y), z(z)
+{
+}
+
+RVector3d::RVector3d(const RVector3& v)
+    : x(v.x), y(v.y), z(v.z)
+{
+}
+
+RVector3d::RVector3d(const RVector3d& copy)
+    : x(copy.x), y(copy.y), z(copy.z)
+{
+}
+
+RVector3d::~RVector3d()
+{
+}
+
+const RVector3d& RVector3d::zero()
+{
+    static RVector3d value(0.0, 0.0, 0.0);
+    return value;
+}
+
+bool RVector3d::isZero() const
+{
+    return x == 0.0 && y == 0.0 && z == 0.0;
+}
+
+void RVector3d::add(const RVector3d& v)
+{
+    x += v.x;
+    y += v.y;
+    z += v.z;
+}
+
+void RVector3d::add(const RVector3& v)
+{
+    x += v.x;
+    y += v.y;
+    z += v.z;
+}
+
+void RVector3d::add(const RVector3d& v1, const RVector3d& v2, RVector3d* dst)
+{
+    dst->x = v1.x + v2.x;
+    dst->y = v1.y + v2.y;
+    dst->z = v1.z + v2.z;
+}
+
+double RVector3d::distance(const RVector3d& v) const
+{
+    return std::sqrt(distanceSquared(v));
+}
+
+double RVector3d::distanceSquared(const RVector3d& v) const
+{
+    double dx = v.x - x;
+    double dy = v.y - y;
+    double dz = v.z - z;
+
+    return (dx * dx + dy * dy + dz * dz);
+}
+
+double RVector3d::length() const
+{
+    return std::sqrt(x * x + y * y + z * z);
+}
+
+double RVector3d::lengthSquared() const
+{
+    return (x * x + y * y + z * z);
+}
+
+void RVector3d::negate()
+{
+    x = -x;
+    y = -y;
+    z = -z;
+}
+
+void RVector3d::scale(double scalar)
+{
+    x *= scalar;
+    y *= scalar;
+    z *= scalar;
+}
+
+void RVector3d::set(double x, double y, double z)
+{
+    this->x = x;
+    this->y = y;
+    this->z = z;
+}
+
+void RVector3d::set(const RVector3d& v)
+{
+    x = v.x;
+    y = v.y;
+    z = v.z;
+}
+
+void RVector3d::set(const RVector3& v)
+{
+    x = v.x;
+    y = v.y;
+    z = v.z;
+}
+
+void RVector3d::subtract(const RVector3d& v)
+{
+    x -= v.x;
+    y -= v.y;
+    z -= v.z;
+}
+
+void RVector3d::subtract(const RVector3d& v1, const RVector3d& v2, RVector3d* dst)
+{
+    dst->x = v1.x - v2.x;
+    dst->y = v1.y - v2.y;
+    dst->z = v1.z - v2.z;
+}
+
+RVector3 RVector3d::relativeTo(const RVector3d& origin) const
+{
+    return RVector3((float)(x - origin.x), (float)(y - origin.y), (float)(z - origin.z));
+}
+
+RVector3 RVector3d::toVector3() const
+{
+    return RVector3((float)x, (float)y, (float)z);
+}
+
+void RVector3d::rebase(const RVector3d& origin, const RVector3d* points, size_t count, RVector3* dst)
+{
+    // Hoist the origin into locals so the compiler does not have to assume
+    // it aliases dst, which keeps the loop free of reloads.
+    const double ox = origin.x;
+    const double oy = origin.y;
+    const double oz = origin.z;
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i].x = (float)(points[i].x - ox);
+        dst[i].y = (float)(points[i].y - oy);
+        dst[i].z = (float)(points[i].z - oz);
+    }
+}
+
+void RVector3d::rebase(const RVector3d& origin, const RVector3d* centers, const float* radii, size_t count, RBoundingSphere* dst)
+{
+    const double ox = origin.x;
+    const double oy = origin.y;
+    const double oz = origin.z;
+    for (size_t i = 0; i < count; i++)
+    {
+        dst[i].center.x = (float)(centers[i].x - ox);
+        dst[i].center.y = (float)(centers[i].y - oy);
+        dst[i].center.z = (float)(centers[i].z - oz);
+        dst[i].radius = radii[i];
+    }
+}
+
+}
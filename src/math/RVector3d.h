@@ -0,0 +1,307 @@
+#pragma once
+
+#include "common.h"
+#include "RVector3.h"
+
+namespace rocket
+{
+
+class RBoundingSphere;
+
+/**
+ * Defines a 3-element double precision vector.
+ *
+ * This is used for world space positions in large worlds, where a float
+ * position starts to jitter a few kilometres away from the origin.
+ * Rendering and culling still work in single precision: positions are
+ * rebased relative to a double precision origin (usually the camera) and
+ * the small float offsets are handed to RMatrix, RFrustum and friends.
+ *
+ * @see RWorldTransform
+ */
+class API RVector3d
+{
+public:
+
+    /**
+     * The x-coordinate.
+     */
+    double x;
+
+    /**
+     * The y-coordinate.
+     */
+    double y;
+
+    /**
+     * The z-coordinate.
+     */
+    double z;
+
+    /**
+     * Constructs a new vector initialized to all zeros.
+     */
+    RVector3d();
+
+    /**
+     * Constructs a new vector initialized to the specified values.
+     *
+     * @param x The x coordinate.
+     * @param y The y coordinate.
+     * @param z The z coordinate.
+     */
+    RVector3d(double x, double y, double z);
+
+    /**
+     * Constructs a new vector from a single precision vector.
+     *
+     * @param v The vector to widen.
+     */
+    explicit RVector3d(const RVector3& v);
+
+    /**
+     * Constructs a new vector that is a copy of the specified vector.
+     *
+     * @param copy The vector to copy.
+     */
+    RVector3d(const RVector3d& copy);
+
+    /**
+     * Destructor.
+     */
+    ~RVector3d();
+
+    /**
+     * Returns the zero vector.
+     *
+     * @return The 3-element vector of 0s.
+     */
+    static const RVector3d& zero();
+
+    /**
+     * Indicates whether this vector contains all zeros.
+     *
+     * @return true if this vector contains all zeros, false otherwise.
+     */
+    bool isZero() const;
+
+    /**
+     * Adds the elements of the specified vector to this one.
+     *
+     * @param v The vector to add.
+     */
+    void add(const RVector3d& v);
+
+    /**
+     * Adds the elements of the specified single precision vector to this one.
+     *
+     * @param v The vector to add.
+     */
+    void add(const RVector3& v);
+
+    /**
+     * Adds the specified vectors and stores the result in dst.
+     *
+     * @param v1 The first vector.
+     * @param v2 The second vector.
+     * @param dst A vector to store the result in.
+     */
+    static void add(const RVector3d& v1, const RVector3d& v2, RVector3d* dst);
+
+    /**
+     * Returns the distance between this vector and v.
+     *
+     * @param v The other vector.
+     *
+     * @return The distance between this vector and v.
+     */
+    double distance(const RVector3d& v) const;
+
+    /**
+     * Returns the squared distance between this vector and v.
+     *
+     * @param v The other vector.
+     *
+     * @return The squared distance between this vector and v.
+     */
+    double distanceSquared(const RVector3d& v) const;
+
+    /**
+     * Computes the length of this vector.
+     *
+     * @return The length of the vector.
+     */
+    double length() const;
+
+    /**
+     * Returns the squared length of this vector.
+     *
+     * @return The squared length of the vector.
+     */
+    double lengthSquared() const;
+
+    /**
+     * Negates this vector.
+     */
+    void negate();
+
+    /**
+     * Scales all elements of this vector by the specified value.
+     *
+     * @param scalar The scalar value.
+     */
+    void scale(double scalar);
+
+    /**
+     * Sets the elements of this vector to the specified values.
+     *
+     * @param x The new x coordinate.
+     * @param y The new y coordinate.
+     * @param z The new z coordinate.
+     */
+    void set(double x, double y, double z);
+
+    /**
+     * Sets the elements of this vector to those in the specified vector.
+     *
+     * @param v The vector to copy.
+     */
+    void set(const RVector3d& v);
+
+    /**
+     * Sets the elements of this vector to those in the specified single precision vector.
+     *
+     * @param v The vector to widen.
+     */
+    void set(const RVector3& v);
+
+    /**
+     * Subtracts this vector and the specified vector as (this - v)
+     * and stores the result in this vector.
+     *
+     * @param v The vector to subtract.
+     */
+    void subtract(const RVector3d& v);
+
+    /**
+     * Subtracts the specified vectors and stores the result in dst.
+     * The resulting vector is computed as (v1 - v2).
+     *
+     * @param v1 The first vector.
+     * @param v2 The second vector.
+     * @param dst The destination vector.
+     */
+    static void subtract(const RVector3d& v1, const RVector3d& v2, RVector3d* dst);
+
+    /**
+     * Returns this position relative to the given origin, narrowed to single precision.
+     *
+     * The subtraction is done in double precision, so the result is exact to float
+     * precision as long as the point is near the origin.
+     *
+     * @param origin The origin to rebase against (usually the camera position).
+     *
+     * @return The vector (this - origin) as floats.
+     */
+    RVector3 relativeTo(const RVector3d& origin) const;
+
+    /**
+     * Returns this vector narrowed to single precision.
+     *
+     * @return The vector as floats.
+     */
+    RVector3 toVector3() const;
+
+    /**
+     * Rebases an array of points against the given origin.
+     *
+     * This is the batch form of relativeTo() and is meant to run once per frame
+     * over every object position, before culling and matrix generation.
+     *
+     * @param origin The origin to rebase against.
+     * @param points The world space points.
+     * @param count The number of points.
+     * @param dst An array of count vectors to store the relative points in.
+     */
+    static void rebase(const RVector3d& origin, const RVector3d* points, size_t count, RVector3* dst);
+
+    /**
+     * Rebases an array of bounding spheres against the given origin so they can be
+     * tested against a camera relative RFrustum.
+     *
+     * @param origin The origin to rebase against.
+     * @param centers The world space sphere centers.
+     * @param radii The sphere radii.
+     * @param count The number of spheres.
+     * @param dst An array of count spheres to store the relative spheres in.
+     */
+    static void rebase(const RVector3d& origin, const RVector3d* centers, const float* radii, size_t count, RBoundingSphere* dst);
+
+    /**
+     * Calculates the sum of this vector with the given vector.
+     *
+     * Note: this does not modify this vector.
+     *
+     * @param v The vector to add.
+     * @return The vector sum.
+     */
+    inline const RVector3d operator+(const RVector3d& v) const;
+
+    /**
+     * Adds the given vector to this vector.
+     *
+     * @param v The vector to add.
+     * @return This vector, after the addition occurs.
+     */
+    inline RVector3d& operator+=(const RVector3d& v);
+
+    /**
+     * Calculates the difference of this vector with the given vector.
+     *
+     * Note: this does not modify this vector.
+     *
+     * @param v The vector to subtract.
+     * @return The vector difference.
+     */
+    inline const RVector3d operator-(const RVector3d& v) const;
+
+    /**
+     * Subtracts the given vector from this vector.
+     *
+     * @param v The vector to subtract.
+     * @return This vector, after the subtraction occurs.
+     */
+    inline RVector3d& operator-=(const RVector3d& v);
+
+    /**
+     * Calculates the scalar product of this vector with the given value.
+     *
+     * Note: this does not modify this vector.
+     *
+     * @param x The value to scale by.
+     * @return The scaled vector.
+     */
+    inline const RVector3d operator*(double x) const;
+
+    /**
+     * Determines if this vector is equal to the given vector.
+     *
+     * @param v The vector to compare against.
+     *
+     * @return True if this vector is equal to the given vector, false otherwise.
+     */
+    inline bool operator==(const RVector3d& v) const;
+
+    /**
+     * Determines if this vector is not equal to the given vector.
+     *
+     * @param v The vector to compare against.
+     *
+     * @return True if this vector is not equal to the given vector, false otherwise.
+     */
+    inline bool operator!=(const RVector3d& v) const;
+};
+
+}
+
+#include "RVector3d.inl"
@@ -0,0 +1,49 @@
+#include "RVector3d.h"
+
+namespace rocket
+{
+
+inline const RVector3d RVector3d::operator+(const RVector3d& v) const
+{
+    RVector3d result(*this);
+    result.add(v);
+    return result;
+}
+
+inline RVector3d& RVector3d::operator+=(const RVector3d& v)
+{
+    add(v);
+    return *this;
+}
+
+inline const RVector3d RVector3d::operator-(const RVector3d& v) const
+{
+    RVector3d result(*this);
+    result.subtract(v);
+    return result;
+}
+
+inline RVector3d& RVector3d::operator-=(const RVector3d& v)
+{
+    subtract(v);
+    return *this;
+}
+
+inline const RVector3d RVector3d::operator*(double x) const
+{
+    RVector3d result(*this);
+    result.scale(x);
+    return result;
+}
+
+inline bool RVector3d::operator==(const RVector3d& v) const
+{
+    return x==v.x && y==v.y && z==v.z;
+}
+
+inline bool RVector3d::operator!=(const RVector3d& v) const
+{
+    return x!=v.x || y!=v.y || z!=v.z;
+}
+
+}
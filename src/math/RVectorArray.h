@@ -0,0 +1,127 @@
+#pragma once
+
+#include "RSoAArray.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a structure of arrays container of RVector2, RVector3 or RVector4
+ * with batch arithmetic.
+ *
+ * The batch functions process every element with the SIMD kernels of
+ * RSimd.h and resize dst to the size of the first input. dst may be one of
+ * the inputs. Inputs of a binary operation must have the same size.
+ */
+template <typename T>
+class RVectorArray : public RSoAArray<T>
+{
+public:
+
+    using RSoAArray<T>::RSoAArray;
+
+    /**
+     * Adds two arrays element-wise.
+     *
+     * @param a The first array.
+     * @param b The second array.
+     * @param dst The array to store the sums in.
+     */
+    static void add(const RVectorArray& a, const RVectorArray& b, RVectorArray* dst);
+
+    /**
+     * Subtracts two arrays element-wise.
+     *
+     * @param a The first array.
+     * @param b The array to subtract.
+     * @param dst The array to store the differences in.
+     */
+    static void subtract(const RVectorArray& a, const RVectorArray& b, RVectorArray* dst);
+
+    /**
+     * Multiplies two arrays component-wise.
+     *
+     * @param a The first array.
+     * @param b The second array.
+     * @param dst The array to store the products in.
+     */
+    static void multiply(const RVectorArray& a, const RVectorArray& b, RVectorArray* dst);
+
+    /**
+     * Scales every vector of an array.
+     *
+     * @param a The array.
+     * @param scale The scale factor.
+     * @param dst The array to store the scaled vectors in.
+     */
+    static void scale(const RVectorArray& a, float scale, RVectorArray* dst);
+
+    /**
+     * Interpolates linearly between two arrays, a + (b - a) * t.
+     *
+     * @param a The array at t = 0.
+     * @param b The array at t = 1.
+     * @param t The interpolation coefficient.
+     * @param dst The array to store the results in.
+     */
+    static void lerp(const RVectorArray& a, const RVectorArray& b, float t, RVectorArray* dst);
+
+    /**
+     * Computes the dot products of two arrays element-wise.
+     *
+     * @param a The first array.
+     * @param b The second array.
+     * @param dst The array to store the dot products in.
+     */
+    static void dot(const RVectorArray& a, const RVectorArray& b, RFloatArray* dst);
+
+    /**
+     * Computes the length of every vector of an array.
+     *
+     * @param a The array.
+     * @param dst The array to store the lengths in.
+     */
+    static void length(const RVectorArray& a, RFloatArray* dst);
+
+    /**
+     * Normalizes every vector of an array. Zero vectors are left unchanged.
+     *
+     * @param a The array.
+     * @param dst The array to store the normalized vectors in.
+     */
+    static void normalize(const RVectorArray& a, RVectorArray* dst);
+
+    /**
+     * Adds an array to this one element-wise.
+     *
+     * @param b The array to add.
+     */
+    void add(const RVectorArray& b);
+
+    /**
+     * Subtracts an array from this one element-wise.
+     *
+     * @param b The array to subtract.
+     */
+    void subtract(const RVectorArray& b);
+
+    /**
+     * Scales every vector of this array.
+     *
+     * @param scale The scale factor.
+     */
+    void scale(float scale);
+
+    /**
+     * Normalizes every vector of this array.
+     */
+    void normalize();
+};
+
+typedef RVectorArray<RVector2> RVector2Array;
+typedef RVectorArray<RVector3> RVector3Array;
+typedef RVectorArray<RVector4> RVector4Array;
+
+}
+
+#include "RVectorArray.inl"
@@ -0,0 +1,163 @@
+#include "RVectorArray.h"
+
+namespace rocket
+{
+
+template <typename T>
+inline void RVectorArray<T>::add(const RVectorArray& a, const RVectorArray& b, RVectorArray* dst)
+{
+    dst->resize(a.size());
+    for (unsigned int c = 0; c < RSoAArray<T>::COMPONENTS; c++)
+    {
+        const float* pa = a.getComponent(c);
+        const float* pb = b.getComponent(c);
+        float* pd = dst->getComponent(c);
+        simdForEach(a.getPaddedSize(), [&](auto lane, size_t i)
+        {
+            typedef decltype(lane) F;
+            (F::load(pa + i) + F::load(pb + i)).store(pd + i);
+        });
+    }
+}
+
+template <typename T>
+inline void RVectorArray<T>::subtract(const RVectorArray& a, const RVectorArray& b, RVectorArray* dst)
+{
+    dst->resize(a.size());
+    for (unsigned int c = 0; c < RSoAArray<T>::COMPONENTS; c++)
+    {
+        const float* pa = a.getComponent(c);
+        const float* pb = b.getComponent(c);
+        float* pd = dst->getComponent(c);
+        simdForEach(a.getPaddedSize(), [&](auto lane, size_t i)
+        {
+            typedef decltype(lane) F;
+            (F::load(pa + i) - F::load(pb + i)).store(pd + i);
+        });
+    }
+}
+
+template <typename T>
+inline void RVectorArray<T>::multiply(const RVectorArray& a, const RVectorArray& b, RVectorArray* dst)
+{
+    dst->resize(a.size());
+    for (unsigned int c = 0; c < RSoAArray<T>::COMPONENTS; c++)
+    {
+        const float* pa = a.getComponent(c);
+        const float* pb = b.getComponent(c);
+        float* pd = dst->getComponent(c);
+        simdForEach(a.getPaddedSize(), [&](auto lane, size_t i)
+        {
+            typedef decltype(lane) F;
+            (F::load(pa + i) * F::load(pb + i)).store(pd + i);
+        });
+    }
+}
+
+template <typename T>
+inline void RVectorArray<T>::scale(const RVectorArray& a, float scale, RVectorArray* dst)
+{
+    dst->resize(a.size());
+    for (unsigned int c = 0; c < RSoAArray<T>::COMPONENTS; c++)
+    {
+        const float* pa = a.getComponent(c);
+        float* pd = dst->getComponent(c);
+        simdForEach(a.getPaddedSize(), [&](auto lane, size_t i)
+        {
+            typedef decltype(lane) F;
+            (F::load(pa + i) * F(scale)).store(pd + i);
+        });
+    }
+}
+
+template <typename T>
+inline void RVectorArray<T>::lerp(const RVectorArray& a, const RVectorArray& b, float t, RVectorArray* dst)
+{
+    dst->resize(a.size());
+    for (unsigned int c = 0; c < RSoAArray<T>::COMPONENTS; c++)
+    {
+        const float* pa = a.getComponent(c);
+        const float* pb = b.getComponent(c);
+        float* pd = dst->getComponent(c);
+        simdForEach(a.getPaddedSize(), [&](auto lane, size_t i)
+        {
+            typedef decltype(lane) F;
+            F va = F::load(pa + i);
+            (va + (F::load(pb + i) - va) * F(t)).store(pd + i);
+        });
+    }
+}
+
+template <typename T>
+inline void RVectorArray<T>::dot(const RVectorArray& a, const RVectorArray& b, RFloatArray* dst)
+{
+    dst->resize(a.size());
+    float* pd = dst->getComponent(0);
+    simdForEach(a.getPaddedSize(), [&](auto lane, size_t i)
+    {
+        typedef decltype(lane) F;
+        F sum = F::load(a.getComponent(0) + i) * F::load(b.getComponent(0) + i);
+        for (unsigned int c = 1; c < RSoAArray<T>::COMPONENTS; c++)
+            sum = sum + F::load(a.getComponent(c) + i) * F::load(b.getComponent(c) + i);
+        sum.store(pd + i);
+    });
+}
+
+template <typename T>
+inline void RVectorArray<T>::length(const RVectorArray& a, RFloatArray* dst)
+{
+    dot(a, a, dst);
+    float* pd = dst->getComponent(0);
+    simdForEach(a.getPaddedSize(), [&](auto lane, size_t i)
+    {
+        typedef decltype(lane) F;
+        simdSqrt(F::load(pd + i)).store(pd + i);
+    });
+}
+
+template <typename T>
+inline void RVectorArray<T>::normalize(const RVectorArray& a, RVectorArray* dst)
+{
+    const unsigned int n = RSoAArray<T>::COMPONENTS;
+    dst->resize(a.size());
+    simdForEach(a.getPaddedSize(), [&](auto lane, size_t i)
+    {
+        typedef decltype(lane) F;
+        F v[n];
+        for (unsigned int c = 0; c < n; c++)
+            v[c] = F::load(a.getComponent(c) + i);
+        F lengthSq = v[0] * v[0];
+        for (unsigned int c = 1; c < n; c++)
+            lengthSq = lengthSq + v[c] * v[c];
+        F length = simdSqrt(lengthSq);
+        F valid = length > F(0.0f);
+        for (unsigned int c = 0; c < n; c++)
+            simdSelect(valid, v[c] / length, v[c]).store(dst->getComponent(c) + i);
+    });
+}
+
+template <typename T>
+inline void RVectorArray<T>::add(const RVectorArray& b)
+{
+    add(*this, b, this);
+}
+
+template <typename T>
+inline void RVectorArray<T>::subtract(const RVectorArray& b)
+{
+    subtract(*this, b, this);
+}
+
+template <typename T>
+inline void RVectorArray<T>::scale(float scale)
+{
+    RVectorArray::scale(*this, scale, this);
+}
+
+template <typename T>
+inline void RVectorArray<T>::normalize()
+{
+    normalize(*this, this);
+}
+
+}
@@ -0,0 +1,136 @@
+#include "common.h"
+#include "RWorldTransform.h"
+
+namespace rocket
+{
+
+RWorldTransform::RWorldTransform()
+    : _scale(RVector3::one()), _dirty(false)
+{
+}
+
+RWorldTransform::RWorldTransform(const RVector3& scale, const RQuaternion& rotation, const RVector3d& translation)
+    : _dirty(true)
+{
+    set(scale, rotation, translation);
+}
+
+RWorldTransform::RWorldTransform(const RWorldTransform& copy)
+    : _dirty(true)
+{
+    set(copy);
+}
+
+RWorldTransform::~RWorldTransform()
+{
+}
+
+const RVector3& RWorldTransform::getScale() const
+{
+    return _scale;
+}
+
+const RQuaternion& RWorldTransform::getRotation() const
+{
+    return _rotation;
+}
+
+const RVector3d& RWorldTransform::getTranslation() const
+{
+    return _translation;
+}
+
+const RMatrix& RWorldTransform::getRotationScale() const
+{
+    if (_dirty)
+    {
+        // Same RS order as RTransform::getMatrix(), the translation is applied when rebasing.
+        RMatrix::createRotation(_rotation, &_rotationScale);
+        if (!_scale.isOne())
+        {
+            _rotationScale.scale(_scale);
+        }
+        _dirty = false;
+    }
+    return _rotationScale;
+}
+
+void RWorldTransform::getRelativeMatrix(const RVector3d& origin, RMatrix* dst) const
+{
+    dst->set(getRotationScale());
+    dst->m[12] = (float)(_translation.x - origin.x);
+    dst->m[13] = (float)(_translation.y - origin.y);
+    dst->m[14] = (float)(_translation.z - origin.z);
+}
+
+bool RWorldTransform::getRelativeViewMatrix(RMatrix* dst) const
+{
+    return getRotationScale().invert(dst);
+}
+
+void RWorldTransform::setScale(const RVector3& scale)
+{
+    _scale.set(scale);
+    _dirty = true;
+}
+
+void RWorldTransform::setRotation(const RQuaternion& rotation)
+{
+    _rotation.set(rotation);
+    _dirty = true;
+}
+
+void RWorldTransform::setTranslation(const RVector3d& translation)
+{
+    _translation.set(translation);
+}
+
+void RWorldTransform::set(const RVector3& scale, const RQuaternion& rotation, const RVector3d& translation)
+{
+    _scale.set(scale);
+    _rotation.set(rotation);
+    _translation.set(translation);
+    _dirty = true;
+}
+
+void RWorldTransform::set(const RWorldTransform& transform)
+{
+    set(transform._scale, transform._rotation, transform._translation);
+}
+
+void RWorldTransform::translate(const RVector3& translation)
+{
+    _translation.add(translation);
+}
+
+void RWorldTransform::translate(const RVector3d& translation)
+{
+    _translation.add(translation);
+}
+
+void RWorldTransform::rebase(const RVector3d& origin, const RWorldTransform* transforms, size_t count, RMatrix* dst)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        transforms[i].getRelativeMatrix(origin, &dst[i]);
+    }
+}
+
+void RWorldTransform::rebase(const RVector3d& origin, const RMatrix* rotationScales, const RVector3d* translations, size_t count, RMatrix* dst)
+{
+    const double ox = origin.x;
+    const double oy = origin.y;
+    const double oz = origin.z;
+    for (size_t i = 0; i < count; i++)
+    {
+        const float* src = rotationScales[i].m;
+        float* m = dst[i].m;
+        memcpy(m, src, sizeof(float) * 12);
+        m[12] = (float)(translations[i].x - ox);
+        m[13] = (float)(translations[i].y - oy);
+        m[14] = (float)(translations[i].z - oz);
+        m[15] = 1.0f;
+    }
+}
+
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include "RVector3.h"
+#include "RVector3d.h"
+#include "RQuaternion.h"
+#include "RMatrix.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a 3-dimensional transformation with a double precision translation.
+ *
+ * RWorldTransform is meant for objects placed in large worlds. Scale and
+ * rotation stay in single precision, but the translation is stored as an
+ * RVector3d so positions far from the world origin do not jitter.
+ *
+ * A world transform never produces an absolute float matrix. Instead it is
+ * rebased against an origin (usually the camera position) with
+ * getRelativeMatrix() or, once per frame for many objects, with rebase().
+ * Pair the result with getRelativeViewMatrix() of the camera transform so
+ * that rendering and RFrustum culling run in camera relative space, where
+ * single precision is accurate.
+ *
+ * @see RTransform
+ */
+class API RWorldTransform
+{
+public:
+
+    /**
+     * Constructs the identity transform.
+     */
+    RWorldTransform();
+
+    /**
+     * Constructs a new transform from the specified values.
+     *
+     * @param scale The scale vector.
+     * @param rotation The rotation quaternion.
+     * @param translation The world space translation.
+     */
+    RWorldTransform(const RVector3& scale, const RQuaternion& rotation, const RVector3d& translation);
+
+    /**
+     * Constructs a new transform from the given transform.
+     *
+     * @param copy The transform to copy.
+     */
+    RWorldTransform(const RWorldTransform& copy);
+
+    /**
+     * Destructor.
+     */
+    ~RWorldTransform();
+
+    /**
+     * Returns the scale for this transform.
+     */
+    const RVector3& getScale() const;
+
+    /**
+     * Returns the rotation for this transform.
+     */
+    const RQuaternion& getRotation() const;
+
+    /**
+     * Returns the world space translation for this transform.
+     */
+    const RVector3d& getTranslation() const;
+
+    /**
+     * Returns the rotation and scale of this transform as a matrix with no translation.
+     *
+     * The matrix is cached and only recomputed after the scale or rotation changes.
+     *
+     * @return The rotation and scale matrix.
+     */
+    const RMatrix& getRotationScale() const;
+
+    /**
+     * Gets the matrix of this transform relative to the specified origin.
+     *
+     * The translation is computed as (translation - origin) in double precision
+     * and then narrowed, so the result is accurate for objects near the origin.
+     *
+     * @param origin The origin to rebase against (usually the camera position).
+     * @param dst A matrix to store the camera relative world matrix in.
+     */
+    void getRelativeMatrix(const RVector3d& origin, RMatrix* dst) const;
+
+    /**
+     * Gets the view matrix for a camera placed at this transform, for use
+     * with matrices and bounds rebased against this transform's translation.
+     *
+     * This is the inverse of getRotationScale(); the camera sits at the origin
+     * of the camera relative space so the view matrix has no translation.
+     *
+     * @param dst A matrix to store the camera relative view matrix in.
+     *
+     * @return true if the view matrix could be computed, false if the rotation and scale is singular.
+     */
+    bool getRelativeViewMatrix(RMatrix* dst) const;
+
+    /**
+     * Sets the scale for this transform.
+     *
+     * @param scale The scale to set.
+     */
+    void setScale(const RVector3& scale);
+
+    /**
+     * Sets the rotation for this transform.
+     *
+     * @param rotation The rotation to set.
+     */
+    void setRotation(const RQuaternion& rotation);
+
+    /**
+     * Sets the world space translation for this transform.
+     *
+     * @param translation The translation to set.
+     */
+    void setTranslation(const RVector3d& translation);
+
+    /**
+     * Sets this transform to the specified values.
+     *
+     * @param scale The scale vector.
+     * @param rotation The rotation quaternion.
+     * @param translation The world space translation.
+     */
+    void set(const RVector3& scale, const RQuaternion& rotation, const RVector3d& translation);
+
+    /**
+     * Sets this transform to the given transform.
+     *
+     * @param transform The transform to set this transform to.
+     */
+    void set(const RWorldTransform& transform);
+
+    /**
+     * Translates this transform by the specified offset.
+     *
+     * @param translation The amount to translate.
+     */
+    void translate(const RVector3& translation);
+
+    /**
+     * Translates this transform by the specified double precision offset.
+     *
+     * @param translation The amount to translate.
+     */
+    void translate(const RVector3d& translation);
+
+    /**
+     * Computes the camera relative world matrices for an array of transforms.
+     *
+     * This is the per frame batch form of getRelativeMatrix().
+     *
+     * @param origin The origin to rebase against (usually the camera position).
+     * @param transforms The transforms to rebase.
+     * @param count The number of transforms.
+     * @param dst An array of count matrices to store the relative matrices in.
+     */
+    static void rebase(const RVector3d& origin, const RWorldTransform* transforms, size_t count, RMatrix* dst);
+
+    /**
+     * Computes camera relative world matrices from separate rotation/scale and
+     * translation arrays.
+     *
+     * This is the fast path for objects whose rotation and scale rarely change:
+     * only the translation column is written per object, everything else is a
+     * straight copy.
+     *
+     * @param origin The origin to rebase against.
+     * @param rotationScales The rotation and scale matrices (their translation is ignored).
+     * @param translations The world space translations.
+     * @param count The number of objects.
+     * @param dst An array of count matrices to store the relative matrices in.
+     */
+    static void rebase(const RVector3d& origin, const RMatrix* rotationScales, const RVector3d* translations, size_t count, RMatrix* dst);
+
+private:
+
+    RVector3 _scale;
+    RQuaternion _rotation;
+    RVector3d _translation;
+    mutable RMatrix _rotationScale;
+    mutable bool _dirty;
+};
+
+}
@@ -0,0 +1,220 @@
+#include "RTest.h"
+#include "graphics/RBlockCompressor.h"
+#include "graphics/RGLStateCache.h"
+#include "graphics/RTexture2D.h"
+
+namespace rocket
+{
+
+static std::vector<uint8_t> createImage(unsigned int width, unsigned int height, uint32_t seed)
+{
+    RRandom random(seed);
+    std::vector<uint8_t> image(width * height * 4);
+    for (unsigned int y = 0; y < height; y++)
+    {
+        for (unsigned int x = 0; x < width; x++)
+        {
+            uint8_t* pixel = &image[(y * width + x) * 4];
+            float noise = random.nextFloat(-6.0f, 6.0f);
+            pixel[0] = (uint8_t)std::min(std::max(x * 255.0f / width + noise, 0.0f), 255.0f);
+            pixel[1] = (uint8_t)std::min(std::max(y * 255.0f / height + noise, 0.0f), 255.0f);
+            pixel[2] = (uint8_t)std::min(std::max(128.0f + 100.0f * std::sin(x * 0.2f) + noise, 0.0f), 255.0f);
+            pixel[3] = (uint8_t)((x * 7 + y * 3) & 255);
+        }
+    }
+    return image;
+}
+
+static double getRootMeanSquareError(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, unsigned int channels)
+{
+    double sum = 0.0;
+    size_t count = 0;
+    for (size_t i = 0; i < a.size(); i += 4)
+    {
+        for (unsigned int c = 0; c < channels; c++)
+        {
+            double d = (double)a[i + c] - (double)b[i + c];
+            sum += d * d;
+            count++;
+        }
+    }
+    return std::sqrt(sum / (double)count);
+}
+
+static double roundTrip(const RBlockCompressor& compressor, RTexture::Format format, const std::vector<uint8_t>& image,
+                        unsigned int width, unsigned int height, unsigned int channels, std::vector<uint8_t>* decoded = NULL)
+{
+    std::vector<uint8_t> blocks(RTexture::getImageSize(format, width, height));
+    std::vector<uint8_t> result(image.size());
+    EXPECT_TRUE(compressor.compress(format, image.data(), width, height, blocks.data()));
+    EXPECT_TRUE(compressor.decompress(format, blocks.data(), width, height, result.data()));
+    if (decoded)
+        *decoded = result;
+    return getRootMeanSquareError(image, result, channels);
+}
+
+TEST(RBlockCompressor, DecodesReferenceBC1Block)
+{
+    // Red and blue endpoints, every pixel on the first third between them.
+    const uint8_t block[8] = { 0x00, 0xf8, 0x1f, 0x00, 0xaa, 0xaa, 0xaa, 0xaa };
+    uint8_t rgba[64];
+    RBlockCompressor::decompressBlock(RTexture::FORMAT_BC1, block, rgba);
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        EXPECT_EQ(170, rgba[i * 4]);
+        EXPECT_EQ(0, rgba[i * 4 + 1]);
+        EXPECT_EQ(85, rgba[i * 4 + 2]);
+        EXPECT_EQ(255, rgba[i * 4 + 3]);
+    }
+}
+
+TEST(RBlockCompressor, DecodesThreeSubsetBC7Blocks)
+{
+    // Each subset ramps from black to red, green or blue, with the pixel indices below. The
+    // p-bits of mode 0 are 0, so its ramps end at 247.
+    const uint8_t mode0[16] = { 0x1d, 0x1e, 0x00, 0x00, 0x00, 0x1e, 0x00, 0x00,
+                                0x00, 0x1e, 0xa0, 0x9a, 0xf1, 0x50, 0x9d, 0xf1 };
+    const char* subsets0 = "0011011211221222";
+    const unsigned int indices0[16] = { 0, 5, 2, 3, 4, 1, 6, 3, 0, 5, 2, 7, 4, 1, 6, 3 };
+    const int weights0[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+    const uint8_t mode2[16] = { 0x6c, 0xc0, 0x07, 0x00, 0x00, 0x00, 0xc0, 0x07,
+                                0x00, 0x00, 0x00, 0xc0, 0xb7, 0xd1, 0xd8, 0xd8 };
+    const char* subsets2 = "0122012201220122";
+    const unsigned int indices2[16] = { 0, 3, 2, 1, 0, 1, 2, 1, 0, 3, 2, 1, 0, 3, 2, 1 };
+    const int weights2[4] = { 0, 21, 43, 64 };
+
+    uint8_t rgba[64];
+    RBlockCompressor::decompressBlock(RTexture::FORMAT_BC7, mode0, rgba);
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        unsigned int subset = subsets0[i] - '0';
+        for (unsigned int c = 0; c < 3; c++)
+            EXPECT_EQ(c == subset ? (247 * weights0[indices0[i]] + 32) >> 6 : 0, rgba[i * 4 + c]) << "pixel " << i;
+        EXPECT_EQ(255, rgba[i * 4 + 3]);
+    }
+    RBlockCompressor::decompressBlock(RTexture::FORMAT_BC7, mode2, rgba);
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        unsigned int subset = subsets2[i] - '0';
+        for (unsigned int c = 0; c < 3; c++)
+            EXPECT_EQ(c == subset ? (255 * weights2[indices2[i]] + 32) >> 6 : 0, rgba[i * 4 + c]) << "pixel " << i;
+        EXPECT_EQ(255, rgba[i * 4 + 3]);
+    }
+}
+
+TEST(RBlockCompressor, EncodesSolidBlocksClosely)
+{
+    uint8_t rgba[64];
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        rgba[i * 4] = 37;
+        rgba[i * 4 + 1] = 201;
+        rgba[i * 4 + 2] = 90;
+        rgba[i * 4 + 3] = 129;
+    }
+    uint8_t block[16];
+    uint8_t decoded[64];
+    RBlockCompressor::compressBlock(RTexture::FORMAT_BC7, rgba, block, RBlockCompressor::QUALITY_FAST);
+    RBlockCompressor::decompressBlock(RTexture::FORMAT_BC7, block, decoded);
+    // Mode 6 shares a p-bit between channels, so mixed parities can be one off.
+    for (unsigned int i = 0; i < 64; i++)
+        EXPECT_NEAR(rgba[i], decoded[i], 1);
+
+    RBlockCompressor::compressBlock(RTexture::FORMAT_BC5, rgba, block);
+    RBlockCompressor::decompressBlock(RTexture::FORMAT_BC5, block, decoded);
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        EXPECT_EQ(37, decoded[i * 4]);
+        EXPECT_EQ(201, decoded[i * 4 + 1]);
+        EXPECT_EQ(0, decoded[i * 4 + 2]);
+        EXPECT_EQ(255, decoded[i * 4 + 3]);
+    }
+}
+
+TEST(RBlockCompressor, RoundTripsWithinFormatError)
+{
+    const unsigned int width = 64, height = 48;
+    std::vector<uint8_t> image = createImage(width, height, 7);
+    RBlockCompressor compressor;
+
+    // Punch-through alpha decodes transparent pixels as black.
+    std::vector<uint8_t> decoded;
+    roundTrip(compressor, RTexture::FORMAT_BC1, image, width, height, 3, &decoded);
+    for (size_t i = 0; i < image.size(); i += 4)
+        EXPECT_EQ(image[i + 3] < 128 ? 0 : 255, decoded[i + 3]);
+
+    EXPECT_LT(roundTrip(compressor, RTexture::FORMAT_BC3, image, width, height, 4), 8.0);
+    EXPECT_LT(roundTrip(compressor, RTexture::FORMAT_BC4, image, width, height, 1), 3.0);
+    EXPECT_LT(roundTrip(compressor, RTexture::FORMAT_BC5, image, width, height, 2), 3.0);
+    EXPECT_LT(roundTrip(compressor, RTexture::FORMAT_BC7, image, width, height, 4), 6.0);
+
+    for (size_t i = 3; i < image.size(); i += 4)
+        image[i] = 255;
+    double bc1 = roundTrip(compressor, RTexture::FORMAT_BC1, image, width, height, 3);
+    double bc7 = roundTrip(compressor, RTexture::FORMAT_BC7, image, width, height, 3);
+    EXPECT_LT(bc1, 8.0);
+    EXPECT_LT(bc7, bc1);
+}
+
+TEST(RBlockCompressor, HigherQualityLowersBC7Error)
+{
+    const unsigned int width = 32, height = 32;
+    std::vector<uint8_t> image = createImage(width, height, 11);
+    for (size_t i = 3; i < image.size(); i += 4)
+        image[i] = 255;
+
+    RBlockCompressor compressor(RBlockCompressor::QUALITY_FAST);
+    double fast = roundTrip(compressor, RTexture::FORMAT_BC7, image, width, height, 3);
+    compressor.setQuality(RBlockCompressor::QUALITY_NORMAL);
+    double normal = roundTrip(compressor, RTexture::FORMAT_BC7, image, width, height, 3);
+    compressor.setQuality(RBlockCompressor::QUALITY_HIGH);
+    double high = roundTrip(compressor, RTexture::FORMAT_BC7, image, width, height, 3);
+    EXPECT_LE(normal, fast);
+    EXPECT_LE(high, normal);
+    EXPECT_LT(high, 4.0);
+}
+
+TEST(RBlockCompressor, EncodesOddSizesOnAnyThreadCount)
+{
+    const unsigned int width = 37, height = 70;
+    std::vector<uint8_t> image = createImage(width, height, 3);
+    size_t size = RTexture::getImageSize(RTexture::FORMAT_BC7, width, height);
+    EXPECT_EQ(10u * 18u * 16u, size);
+
+    RBlockCompressor compressor;
+    compressor.setThreadCount(1);
+    std::vector<uint8_t> single(size);
+    compressor.compress(RTexture::FORMAT_BC7, image.data(), width, height, single.data());
+    compressor.setThreadCount(4);
+    std::vector<uint8_t> threaded(size);
+    compressor.compress(RTexture::FORMAT_BC7, image.data(), width, height, threaded.data());
+    EXPECT_EQ(single, threaded);
+
+    EXPECT_LT(roundTrip(compressor, RTexture::FORMAT_BC7, image, width, height, 4), 6.0);
+    EXPECT_FALSE(compressor.compress(RTexture::FORMAT_RGBA8, image.data(), width, height, single.data()));
+}
+
+TEST(RBlockCompressor, UploadsCompressedMipsDirectly)
+{
+    RGLRecorder recorder;
+    RGLStateCache cache(&recorder);
+    RTexture2D texture(64, 32, RTexture::FORMAT_BC7_SRGB);
+    ASSERT_TRUE(texture.create(&cache));
+    EXPECT_EQ(1u, recorder.getCount(RGLRecorder::TEX_STORAGE_2D));
+    EXPECT_EQ(GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM, recorder.getCalls().back().args[1]);
+
+    std::vector<uint8_t> image = createImage(32, 16, 5);
+    EXPECT_TRUE(texture.uploadPixels(&cache, 1, image.data()));
+    const RGLRecorder::Call& call = recorder.getCalls().back();
+    EXPECT_EQ(RGLRecorder::COMPRESSED_TEX_SUB_IMAGE_2D, call.type);
+    EXPECT_EQ(1u, call.args[0]);
+    EXPECT_EQ(32u * 16u, call.args[3]);
+    EXPECT_EQ(1u, texture.getResidentMip());
+
+    EXPECT_FALSE(texture.upload(&cache, 0, image.data(), 100));
+    EXPECT_EQ(0u, recorder.getCount(RGLRecorder::TEX_SUB_IMAGE_2D));
+    texture.destroy(&cache);
+    EXPECT_EQ(0u, texture.getHandle());
+}
+
+}
@@ -0,0 +1,214 @@
+#include "RTest.h"
+#include "graphics/RBrickMap.h"
+#include "graphics/RGLStateCache.h"
+#include "graphics/RTexture3D.h"
+
+namespace rocket
+{
+
+/**
+ * Builds an R8 fog volume, empty but for a ball of density.
+ */
+static std::vector<uint8_t> buildFog(unsigned int width, unsigned int height, unsigned int depth, float cx, float cy,
+                                     float cz, float radius)
+{
+    std::vector<uint8_t> voxels((size_t)width * height * depth);
+    for (unsigned int z = 0; z < depth; z++)
+    {
+        for (unsigned int y = 0; y < height; y++)
+        {
+            for (unsigned int x = 0; x < width; x++)
+            {
+                float dx = x + 0.5f - cx, dy = y + 0.5f - cy, dz = z + 0.5f - cz;
+                float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+                voxels[((size_t)z * height + y) * width + x] = distance < radius ? (uint8_t)(255.0f * (1.0f - distance / radius)) : 0;
+            }
+        }
+    }
+    return voxels;
+}
+
+TEST(RBrickMap, BuildsFromDenseVolumes)
+{
+    // The volume is not a whole number of bricks, so the edge bricks are partial.
+    const unsigned int width = 44, height = 36, depth = 20;
+    std::vector<uint8_t> voxels = buildFog(width, height, depth, 40.0f, 20.0f, 12.0f, 9.0f);
+    RBrickMap map(width, height, depth, RTexture::FORMAT_R8);
+    ASSERT_TRUE(map.build(voxels.data()));
+
+    unsigned int gridWidth, gridHeight, gridDepth;
+    map.getGridSize(&gridWidth, &gridHeight, &gridDepth);
+    EXPECT_EQ(6u, gridWidth);
+    EXPECT_EQ(5u, gridHeight);
+    EXPECT_EQ(3u, gridDepth);
+
+    std::vector<bool> occupied(gridWidth * gridHeight * gridDepth, false);
+    for (unsigned int z = 0; z < depth; z++)
+    {
+        for (unsigned int y = 0; y < height; y++)
+        {
+            for (unsigned int x = 0; x < width; x++)
+            {
+                uint8_t value = voxels[((size_t)z * height + y) * width + x];
+                uint8_t voxel;
+                map.getVoxel(x, y, z, &voxel);
+                ASSERT_EQ(value, voxel);
+                if (value != 0)
+                    occupied[((z / 8) * gridHeight + y / 8) * gridWidth + x / 8] = true;
+            }
+        }
+    }
+    unsigned int occupiedCount = 0;
+    for (size_t brick = 0; brick < occupied.size(); brick++)
+    {
+        EXPECT_EQ(occupied[brick], map.isBrickOccupied((unsigned int)(brick % gridWidth), (unsigned int)(brick / gridWidth % gridHeight),
+                                                       (unsigned int)(brick / gridWidth / gridHeight)));
+        EXPECT_EQ(occupied[brick], map.getIndirection()[brick] != 0);
+        occupiedCount += occupied[brick] ? 1 : 0;
+    }
+    EXPECT_EQ(occupiedCount, map.getOccupiedBrickCount());
+    EXPECT_GT(occupiedCount, 0u);
+
+    uint8_t voxel = 1;
+    map.getVoxel(width, 0, 0, &voxel);
+    EXPECT_EQ(0, voxel);
+    EXPECT_FALSE(RBrickMap(8, 8, 8, RTexture::FORMAT_BC4).build(voxels.data()));
+}
+
+TEST(RBrickMap, ShrinksMostlyEmptyVolumes)
+{
+    const unsigned int size = 128;
+    std::vector<uint8_t> voxels = buildFog(size, size, size, 40.0f, 70.0f, 64.0f, 14.0f);
+    RBrickMap map(size, size, size, RTexture::FORMAT_R8);
+    ASSERT_TRUE(map.build(voxels.data()));
+    EXPECT_EQ(voxels.size(), map.getDenseSize());
+    EXPECT_LT(map.getMemorySize() * 10, map.getDenseSize());
+
+    // A signed distance field stores its far voxels as the empty voxel.
+    uint8_t far = 255;
+    for (size_t i = 0; i < voxels.size(); i++)
+        voxels[i] = 255 - voxels[i];
+    RBrickMap field(size, size, size, RTexture::FORMAT_R8, &far);
+    ASSERT_TRUE(field.build(voxels.data()));
+    EXPECT_EQ(map.getOccupiedBrickCount(), field.getOccupiedBrickCount());
+    uint8_t voxel;
+    field.getVoxel(0, 0, 0, &voxel);
+    EXPECT_EQ(255, voxel);
+}
+
+TEST(RBrickMap, UploadsChangedBricks)
+{
+    RBrickMap map(32, 32, 16, RTexture::FORMAT_R8);
+    std::vector<uint8_t> brick(RBrickMap::BRICK_SIZE * RBrickMap::BRICK_SIZE * RBrickMap::BRICK_SIZE, 7);
+    ASSERT_TRUE(map.setBrick(1, 2, 1, brick.data()));
+    ASSERT_TRUE(map.setBrick(3, 0, 0, brick.data()));
+    EXPECT_FALSE(map.setBrick(4, 0, 0, brick.data()));
+    EXPECT_EQ(2u, map.getOccupiedBrickCount());
+
+    RGLRecorder recorder;
+    RGLStateCache cache(&recorder);
+    RTexture3D* atlas = map.createAtlasTexture();
+    RTexture3D* indirection = map.createIndirectionTexture();
+    EXPECT_EQ(RBrickMap::ATLAS_BRICKS * RBrickMap::BRICK_SIZE, atlas->getWidth());
+    EXPECT_EQ(RBrickMap::BRICK_SIZE, atlas->getDepth());
+    EXPECT_EQ(4u, indirection->getWidth());
+    EXPECT_EQ(2u, indirection->getDepth());
+    EXPECT_FALSE(map.upload(&cache, atlas, indirection));
+    ASSERT_TRUE(atlas->create(&cache));
+    ASSERT_TRUE(indirection->create(&cache));
+
+    EXPECT_TRUE(map.upload(&cache, atlas, indirection));
+    EXPECT_EQ(3u, recorder.getCount(RGLRecorder::TEX_SUB_IMAGE_3D));
+    EXPECT_TRUE(map.upload(&cache, atlas, indirection));
+    EXPECT_EQ(3u, recorder.getCount(RGLRecorder::TEX_SUB_IMAGE_3D));
+
+    // Rewriting a brick uploads only that brick.
+    brick[0] = 9;
+    ASSERT_TRUE(map.setBrick(1, 2, 1, brick.data()));
+    EXPECT_TRUE(map.upload(&cache, atlas, indirection));
+    EXPECT_EQ(4u, recorder.getCount(RGLRecorder::TEX_SUB_IMAGE_3D));
+    const RGLRecorder::Call& call = recorder.getCalls().back();
+    EXPECT_EQ(RBrickMap::BRICK_SIZE, call.args[1]);
+    uint8_t voxel;
+    map.getVoxel(8, 16, 8, &voxel);
+    EXPECT_EQ(9, voxel);
+
+    // Clearing a brick frees its slot for the next brick and changes only the indirection.
+    uint32_t entry = map.getIndirection()[(1 * 4 + 2) * 4 + 1];
+    std::vector<uint8_t> empty(brick.size(), 0);
+    ASSERT_TRUE(map.setBrick(1, 2, 1, empty.data()));
+    EXPECT_FALSE(map.isBrickOccupied(1, 2, 1));
+    EXPECT_EQ(1u, map.getOccupiedBrickCount());
+    map.getVoxel(8, 16, 8, &voxel);
+    EXPECT_EQ(0, voxel);
+    EXPECT_TRUE(map.upload(&cache, atlas, indirection));
+    EXPECT_EQ(5u, recorder.getCount(RGLRecorder::TEX_SUB_IMAGE_3D));
+    ASSERT_TRUE(map.setBrick(0, 0, 1, brick.data()));
+    EXPECT_EQ(entry, map.getIndirection()[(1 * 4 + 0) * 4 + 0]);
+    map.clearBrick(3, 0, 0);
+    EXPECT_EQ(1u, map.getOccupiedBrickCount());
+
+    std::vector<uint8_t> read(brick.size());
+    ASSERT_TRUE(map.getBrick(0, 0, 1, read.data()));
+    EXPECT_EQ(brick, read);
+    ASSERT_TRUE(map.getBrick(3, 0, 0, read.data()));
+    EXPECT_EQ(empty, read);
+
+    // New textures need every brick again.
+    recorder.clear();
+    map.invalidate();
+    EXPECT_TRUE(map.upload(&cache, atlas, indirection));
+    EXPECT_EQ(2u, recorder.getCount(RGLRecorder::TEX_SUB_IMAGE_3D));
+
+    // The uploads bound through the cache, which knows the indirection went last.
+    recorder.clear();
+    cache.bindTexture(0, GL_TEXTURE_3D, indirection->getHandle());
+    EXPECT_EQ(0u, recorder.getCalls().size());
+    delete atlas;
+    delete indirection;
+}
+
+TEST(RBrickMap, SamplesAcrossBricks)
+{
+    // A ramp along x, with one brick left empty.
+    const unsigned int width = 24, height = 8, depth = 8;
+    std::vector<float> voxels((size_t)width * height * depth * 4);
+    for (size_t i = 0; i < voxels.size() / 4; i++)
+    {
+        float x = (float)(i % width);
+        voxels[i * 4] = x < 16.0f ? x : 0.0f;
+        voxels[i * 4 + 1] = x < 16.0f ? 1.0f : 0.0f;
+        voxels[i * 4 + 2] = 0.0f;
+        voxels[i * 4 + 3] = x < 16.0f ? 1.0f : 0.0f;
+    }
+    RBrickMap map(width, height, depth, RTexture::FORMAT_RGBA32F);
+    ASSERT_TRUE(map.build(voxels.data()));
+    EXPECT_EQ(2u, map.getOccupiedBrickCount());
+
+    float value[4];
+    ASSERT_EQ(4u, map.sample(3.5f, 2.5f, 6.5f, value));
+    EXPECT_FLOAT_EQ(3.0f, value[0]);
+    EXPECT_FLOAT_EQ(1.0f, value[1]);
+    map.sample(8.0f, 4.0f, 4.0f, value);
+    EXPECT_FLOAT_EQ(7.5f, value[0]);
+    map.sample(7.75f, 0.0f, 8.0f, value);
+    EXPECT_FLOAT_EQ(7.25f, value[0]);
+    map.sample(-3.0f, 4.0f, 4.0f, value);
+    EXPECT_FLOAT_EQ(0.0f, value[0]);
+
+    // Into the empty brick, which samples as the empty voxel.
+    map.sample(16.0f, 4.0f, 4.0f, value);
+    EXPECT_FLOAT_EQ(7.5f, value[0]);
+    EXPECT_FLOAT_EQ(0.5f, value[1]);
+    EXPECT_FLOAT_EQ(0.5f, value[3]);
+    map.sample(100.0f, 4.0f, 4.0f, value);
+    EXPECT_FLOAT_EQ(0.0f, value[3]);
+
+    RBrickMap fog(8, 8, 8, RTexture::FORMAT_R8);
+    std::vector<uint8_t> brick(512, 51);
+    ASSERT_TRUE(fog.setBrick(0, 0, 0, brick.data()));
+    ASSERT_EQ(1u, fog.sample(4.0f, 4.0f, 4.0f, value));
+    EXPECT_FLOAT_EQ(0.2f, value[0]);
+}
+
+}
@@ -0,0 +1,164 @@
+#include "RTest.h"
+#include "math/RCurve.h"
+
+namespace rocket
+{
+
+/**
+ * Evaluates a single component curve.
+ */
+static float evaluateScalar(const RCurve& curve, float time)
+{
+    float value;
+    curve.evaluate(time, &value);
+    return value;
+}
+
+TEST(RCurve, CatmullRomMatchesHandComputedCubics)
+{
+    RCurve curve(4, 1);
+    const float values[4] = { 0.0f, 1.0f, 3.0f, 2.0f };
+    for (unsigned int i = 0; i < 4; i++)
+        curve.setPoint(i, (float)i, &values[i], RCurve::CATMULL_ROM);
+
+    for (unsigned int i = 0; i < 4; i++)
+        EXPECT_NEAR(values[i], evaluateScalar(curve, (float)i), 1e-6f);
+
+    // Inner tangents are (next - previous) / 2, end tangents the chord of the segment:
+    // segment 0 has m0 = 1, m1 = 1.5, segment 1 m0 = 1.5, m1 = 0.5, segment 2 m0 = 0.5, m1 = -1.
+    EXPECT_NEAR(0.4375f, evaluateScalar(curve, 0.5f), 1e-6f);
+    EXPECT_NEAR(2.125f, evaluateScalar(curve, 1.5f), 1e-6f);
+    EXPECT_NEAR(2.6875f, evaluateScalar(curve, 2.5f), 1e-6f);
+
+    // Outside the range the curve clamps to the end values.
+    EXPECT_EQ(0.0f, evaluateScalar(curve, -1.0f));
+    EXPECT_EQ(2.0f, evaluateScalar(curve, 5.0f));
+}
+
+TEST(RCurve, HermiteAndBezierMatchHandComputedCubics)
+{
+    // Hermite tangents are per segment, so a 2 second segment is not slowed down.
+    RCurve hermite(2, 1);
+    const float hermiteValues[2] = { 0.0f, 1.0f };
+    const float hermiteTangents[2] = { 2.0f, -1.0f };
+    hermite.setPoint(0, 0.0f, &hermiteValues[0], RCurve::HERMITE, &hermiteTangents[1], &hermiteTangents[0]);
+    hermite.setPoint(1, 2.0f, &hermiteValues[1], RCurve::HERMITE, &hermiteTangents[1], &hermiteTangents[0]);
+    EXPECT_EQ(0.0f, evaluateScalar(hermite, 0.0f));
+    EXPECT_NEAR(1.0f, evaluateScalar(hermite, 2.0f), 1e-6f);
+    // h10(0.25) * 2 + h01(0.25) * 1 + h11(0.25) * -1 = 0.28125 + 0.15625 + 0.046875.
+    EXPECT_NEAR(0.484375f, evaluateScalar(hermite, 0.5f), 1e-6f);
+    // h10(0.5) * 2 + h01(0.5) * 1 + h11(0.5) * -1 = 0.25 + 0.5 + 0.125.
+    EXPECT_NEAR(0.875f, evaluateScalar(hermite, 1.0f), 1e-6f);
+
+    // Bezier tangents are the inner control points: 0, 1, 3, 2.
+    RCurve bezier(2, 1);
+    const float bezierValues[2] = { 0.0f, 2.0f };
+    const float bezierControls[2] = { 1.0f, 3.0f };
+    bezier.setPoint(0, 0.0f, &bezierValues[0], RCurve::BEZIER, &bezierControls[1], &bezierControls[0]);
+    bezier.setPoint(1, 1.0f, &bezierValues[1], RCurve::BEZIER, &bezierControls[1], &bezierControls[0]);
+    EXPECT_EQ(0.0f, evaluateScalar(bezier, 0.0f));
+    EXPECT_NEAR(2.0f, evaluateScalar(bezier, 1.0f), 1e-6f);
+    // (0 + 3 * 1 + 3 * 3 + 2) / 8.
+    EXPECT_NEAR(1.75f, evaluateScalar(bezier, 0.5f), 1e-6f);
+    // 0.421875 * 1 + 0.140625 * 3 + 0.015625 * 2.
+    EXPECT_NEAR(0.875f, evaluateScalar(bezier, 0.25f), 1e-6f);
+}
+
+TEST(RCurve, CursorFindsSegmentsBothWays)
+{
+    RCurve curve(5, 1);
+    for (unsigned int i = 0; i < 5; i++)
+    {
+        float value = (float)(i * i);
+        curve.setPoint(i, (float)i, &value, RCurve::LINEAR);
+    }
+
+    // Small steps stay on the hint or the segment after it, jumps search,
+    // times past either end land on the first segment or the last point.
+    const float times[] = { 0.5f, 0.75f, 1.5f, 3.5f, 2.5f, 2.0f, -1.0f, 10.0f, 4.0f, 0.0f };
+    const unsigned int segments[] = { 0, 0, 1, 3, 2, 2, 0, 4, 4, 0 };
+    unsigned int cursor = 0;
+    for (size_t i = 0; i < sizeof(times) / sizeof(times[0]); i++)
+    {
+        float value;
+        curve.evaluate(times[i], &value, &cursor);
+        EXPECT_EQ(segments[i], cursor) << "time " << times[i];
+        EXPECT_EQ(evaluateScalar(curve, times[i]), value);
+    }
+
+    // A stale hint past the end still finds the segment.
+    cursor = 100;
+    float value;
+    curve.evaluate(1.25f, &value, &cursor);
+    EXPECT_EQ(1u, cursor);
+    EXPECT_NEAR(1.75f, value, 1e-6f);
+}
+
+TEST(RCurve, ArcLengthOfAStraightLine)
+{
+    // The line moves 5 units in the first second and 5 in the next two.
+    RCurve curve(3, 3);
+    const float points[3][3] = { { 0.0f, 0.0f, 0.0f }, { 3.0f, 4.0f, 0.0f }, { 6.0f, 8.0f, 0.0f } };
+    curve.setPoint(0, 0.0f, points[0], RCurve::LINEAR);
+    curve.setPoint(1, 1.0f, points[1], RCurve::LINEAR);
+    curve.setPoint(2, 3.0f, points[2], RCurve::LINEAR);
+    EXPECT_EQ(0.0f, curve.getArcLength());
+    EXPECT_EQ(0.0f, curve.getTimeAtDistance(5.0f));
+
+    curve.buildArcLengthTable();
+    EXPECT_NEAR(10.0f, curve.getArcLength(), 1e-5f);
+    EXPECT_NEAR(1.0f, curve.getTimeAtDistance(curve.getArcLength() / 2.0f), 1e-5f);
+    EXPECT_NEAR(0.5f, curve.getTimeAtDistance(2.5f), 1e-5f);
+    EXPECT_NEAR(2.0f, curve.getTimeAtDistance(7.5f), 1e-5f);
+    EXPECT_EQ(0.0f, curve.getTimeAtDistance(-1.0f));
+    EXPECT_EQ(3.0f, curve.getTimeAtDistance(20.0f));
+}
+
+TEST(RCurve, QuaternionsTakeTheShortWayAcrossASignFlip)
+{
+    // Rotations about y by 0, 0.5 and 1 radians, the middle key stored negated.
+    RCurve curve(3, 4);
+    curve.setQuaternionOffset(0);
+    const float keys[3][4] =
+    {
+        { 0.0f, 0.0f, 0.0f, 1.0f },
+        { 0.0f, -sinf(0.25f), 0.0f, -cosf(0.25f) },
+        { 0.0f, sinf(0.5f), 0.0f, cosf(0.5f) }
+    };
+    curve.setPoint(0, 0.0f, keys[0], RCurve::LINEAR);
+    curve.setPoint(1, 1.0f, keys[1], RCurve::CATMULL_ROM);
+    curve.setPoint(2, 2.0f, keys[2], RCurve::CATMULL_ROM);
+
+    // nlerp halfway between two rotations about one axis is the half angle.
+    float q[4];
+    curve.evaluate(0.5f, q);
+    EXPECT_NEAR(0.0f, q[0], 1e-6f);
+    EXPECT_NEAR(sinf(0.125f), q[1], 1e-6f);
+    EXPECT_NEAR(cosf(0.125f), q[3], 1e-6f);
+
+    RErrorStats stats("RCurve quaternion length");
+    float previous[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+    for (int i = 0; i <= 200; i++)
+    {
+        curve.evaluate((float)i / 100.0f, q);
+        stats.add(fabs(sqrt((double)q[0] * q[0] + (double)q[1] * q[1] + (double)q[2] * q[2] + (double)q[3] * q[3]) - 1.0));
+        EXPECT_NEAR(0.0f, q[0], 1e-6f);
+        EXPECT_NEAR(0.0f, q[2], 1e-6f);
+
+        // Each segment keeps the sign of its first key, so q and -q meet at the keys,
+        // but as rotations consecutive samples turn 0.01 radians at most.
+        EXPECT_GT(fabs(q[0] * previous[0] + q[1] * previous[1] + q[2] * previous[2] + q[3] * previous[3]), cosf(0.01f));
+        memcpy(previous, q, sizeof(q));
+    }
+    EXPECT_LT(stats.getMax(), 1e-6);
+
+    // The segment after the negated key turns the same way as the one before it.
+    curve.evaluate(1.5f, q);
+    EXPECT_GT(q[1] * q[3], 0.0f);
+    EXPECT_NEAR(0.375f, atan2f(fabsf(q[1]), fabsf(q[3])), 0.01f);
+    curve.evaluate(2.0f, q);
+    EXPECT_NEAR(sinf(0.5f), q[1], 1e-6f);
+    EXPECT_NEAR(cosf(0.5f), q[3], 1e-6f);
+}
+
+}
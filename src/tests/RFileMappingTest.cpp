@@ -0,0 +1,48 @@
+#include "RTest.h"
+#include "utilities/FileMapping.h"
+
+namespace rocket
+{
+
+TEST(RFileMapping, MapsWholeFiles)
+{
+    std::string path = ::testing::TempDir() + "rocket_file_mapping_test.bin";
+    {
+        std::ofstream stream(path, std::ios::binary);
+        stream << "123456789";
+    }
+    RFileMapping mapping;
+    ASSERT_TRUE(mapping.open(path.c_str()));
+    ASSERT_EQ(9u, mapping.getSize());
+    EXPECT_EQ(0, memcmp("123456789", mapping.getData(), 9));
+    // The CRC-32 check value.
+    EXPECT_EQ(0xcbf43926u, RFileMapping::computeChecksum(mapping.getData(), mapping.getSize()));
+
+    RFileMapping other;
+    other.swap(mapping);
+    EXPECT_TRUE(mapping.getData() == NULL);
+    EXPECT_EQ(9u, other.getSize());
+    other.close();
+    EXPECT_EQ(0u, other.getSize());
+
+    // Empty and missing files are not mapped.
+    {
+        std::ofstream stream(path, std::ios::binary);
+    }
+    EXPECT_FALSE(mapping.open(path.c_str()));
+    std::remove(path.c_str());
+    EXPECT_FALSE(mapping.open(path.c_str()));
+}
+
+TEST(RFileMapping, ChecksRangesWithoutOverflow)
+{
+    EXPECT_EQ(0u, RFileMapping::alignOffset(0, 64));
+    EXPECT_EQ(64u, RFileMapping::alignOffset(1, 64));
+    EXPECT_EQ(64u, RFileMapping::alignOffset(64, 64));
+    EXPECT_TRUE(RFileMapping::isInRange(16, 48, 64));
+    EXPECT_FALSE(RFileMapping::isInRange(16, 49, 64));
+    EXPECT_FALSE(RFileMapping::isInRange(65, 0, 64));
+    EXPECT_FALSE(RFileMapping::isInRange(8, UINT64_MAX - 4, 64));
+}
+
+}
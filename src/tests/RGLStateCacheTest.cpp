@@ -0,0 +1,146 @@
+#include "RTest.h"
+#include "graphics/RGLStateCache.h"
+#include "graphics/RTexture2D.h"
+
+namespace rocket
+{
+
+TEST(RBlendState, EqualDescriptionsShareOneState)
+{
+    RBlendState::Description description;
+    description.enabled = true;
+    description.srcColor = RBlendState::BLEND_SRC_ALPHA;
+    description.dstColor = RBlendState::BLEND_ONE_MINUS_SRC_ALPHA;
+    description.dstAlpha = RBlendState::BLEND_ONE_MINUS_SRC_ALPHA;
+    EXPECT_EQ(RBlendState::getAlpha(), RBlendState::get(description));
+    EXPECT_NE(RBlendState::getAlpha(), RBlendState::getAdditive());
+
+    // Factors of disabled states are ignored.
+    description.enabled = false;
+    EXPECT_EQ(RBlendState::getOpaque(), RBlendState::get(description));
+
+    RCullState::Description cull;
+    cull.enabled = false;
+    cull.side = RCullState::SIDE_FRONT;
+    EXPECT_EQ(RCullState::getNone(), RCullState::get(cull));
+    EXPECT_NE(RCullState::getNone(), RCullState::getBack());
+}
+
+TEST(RGLStateCache, SkipsRedundantCalls)
+{
+    RGLRecorder gl;
+    RGLStateCache cache(&gl);
+
+    cache.setBlendState(RBlendState::getAlpha());
+    cache.setCullState(RCullState::getBack());
+    cache.useProgram(3);
+    cache.bindTexture(0, GL_TEXTURE_2D, 7);
+    size_t first = gl.getCalls().size();
+    EXPECT_EQ(cache.getStatistics().issued, first);
+    EXPECT_EQ(0u, cache.getStatistics().skipped);
+
+    // Binding the same state again issues nothing.
+    cache.beginFrame();
+    cache.setBlendState(RBlendState::getAlpha());
+    cache.setCullState(RCullState::getBack());
+    cache.useProgram(3);
+    cache.bindTexture(0, GL_TEXTURE_2D, 7);
+    EXPECT_EQ(first, gl.getCalls().size());
+    EXPECT_EQ(0u, cache.getStatistics().issued);
+    // A skipped texture bind counts once, the unit switch it would have needed is not counted.
+    EXPECT_EQ(first - 1, cache.getStatistics().skipped);
+
+    // Additive differs from alpha only in the destination factors.
+    gl.clear();
+    cache.setBlendState(RBlendState::getAdditive());
+    ASSERT_EQ(1u, gl.getCalls().size());
+    EXPECT_EQ(RGLRecorder::BLEND_FUNC_SEPARATE, gl.getCalls()[0].type);
+    EXPECT_EQ((GLuint)GL_ONE, gl.getCalls()[0].args[1]);
+
+    // Disabling blending leaves the factors alone, enabling again with them only enables.
+    gl.clear();
+    cache.setBlendState(RBlendState::getOpaque());
+    cache.setBlendState(RBlendState::getAdditive());
+    EXPECT_EQ(1u, gl.getCount(RGLRecorder::DISABLE));
+    EXPECT_EQ(1u, gl.getCount(RGLRecorder::ENABLE));
+    EXPECT_EQ(2u, gl.getCalls().size());
+}
+
+TEST(RGLStateCache, TracksTextureUnitsAndFramebuffers)
+{
+    RGLRecorder gl;
+    RGLStateCache cache(&gl);
+
+    cache.bindTexture(0, GL_TEXTURE_2D, 1);
+    cache.bindTexture(1, GL_TEXTURE_2D, 2);
+    cache.bindTexture(1, GL_TEXTURE_CUBE_MAP, 3);
+    cache.bindTexture(0, GL_TEXTURE_2D, 1);
+    cache.bindTexture(1, GL_TEXTURE_2D, 2);
+    EXPECT_EQ(3u, gl.getCount(RGLRecorder::BIND_TEXTURE));
+    EXPECT_EQ(2u, gl.getCount(RGLRecorder::ACTIVE_TEXTURE));
+
+    cache.bindFramebuffer(GL_FRAMEBUFFER, 5);
+    cache.bindFramebuffer(GL_DRAW_FRAMEBUFFER, 5);
+    cache.bindFramebuffer(GL_READ_FRAMEBUFFER, 5);
+    cache.bindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    cache.bindFramebuffer(GL_FRAMEBUFFER, 5);
+    EXPECT_EQ(3u, gl.getCount(RGLRecorder::BIND_FRAMEBUFFER));
+}
+
+TEST(RGLStateCache, TextureUploadsKeepTheShadow)
+{
+    RGLRecorder gl;
+    RGLStateCache cache(&gl);
+    RTexture2D previous(4, 4, RTexture::FORMAT_RGBA8, 1);
+    RTexture2D texture(4, 4, RTexture::FORMAT_RGBA8, 1);
+    ASSERT_TRUE(previous.create(&cache));
+    ASSERT_TRUE(texture.create(&cache));
+    cache.useProgram(3);
+    cache.bindTexture(1, GL_TEXTURE_2D, previous.getHandle());
+    cache.bindTexture(0, GL_TEXTURE_2D, previous.getHandle());
+
+    // The upload rebinds unit 0 only, so the other state is still shadowed.
+    std::vector<uint8_t> pixels(4 * 4 * 4, 255);
+    ASSERT_TRUE(texture.upload(&cache, 0, pixels.data(), pixels.size()));
+    gl.clear();
+    cache.useProgram(3);
+    cache.bindTexture(1, GL_TEXTURE_2D, previous.getHandle());
+    EXPECT_EQ(0u, gl.getCalls().size());
+    cache.bindTexture(0, GL_TEXTURE_2D, previous.getHandle());
+    EXPECT_EQ(1u, gl.getCount(RGLRecorder::BIND_TEXTURE));
+
+    // Deleting a bound texture leaves 0 bound.
+    gl.clear();
+    previous.destroy(&cache);
+    cache.bindTexture(0, GL_TEXTURE_2D, 0);
+    cache.bindTexture(1, GL_TEXTURE_2D, 0);
+    EXPECT_EQ(1u, gl.getCalls().size());
+    EXPECT_EQ(1u, gl.getCount(RGLRecorder::DELETE_TEXTURE));
+    texture.destroy(&cache);
+}
+
+TEST(RGLStateCache, InvalidateAndRawCapabilitiesResync)
+{
+    RGLRecorder gl;
+    RGLStateCache cache(&gl);
+
+    cache.setCullState(RCullState::getBack());
+    cache.setEnabled(GL_CULL_FACE, false);
+    gl.clear();
+    // The raw disable made the bound state object stale, so binding it again re-enables culling.
+    cache.setCullState(RCullState::getBack());
+    EXPECT_EQ(1u, gl.getCount(RGLRecorder::ENABLE));
+    EXPECT_EQ(1u, gl.getCalls().size());
+
+    cache.setEnabled(GL_DEPTH_TEST, true);
+    cache.setEnabled(GL_DEPTH_TEST, true);
+    EXPECT_EQ(2u, gl.getCount(RGLRecorder::ENABLE));
+
+    cache.invalidate();
+    gl.clear();
+    cache.useProgram(0);
+    cache.setEnabled(GL_DEPTH_TEST, true);
+    EXPECT_EQ(2u, gl.getCalls().size());
+}
+
+}
@@ -0,0 +1,170 @@
+#include "RTest.h"
+#include "graphics/RIndexBuffer.h"
+#include "graphics/RMeshBuilder.h"
+
+namespace rocket
+{
+
+/**
+ * Gets the row by row triangles of a grid of size x size quads.
+ */
+static std::vector<uint32_t> getGridIndices(unsigned int size)
+{
+    std::vector<uint32_t> indices;
+    for (unsigned int y = 0; y < size; y++)
+    {
+        for (unsigned int x = 0; x < size; x++)
+        {
+            uint32_t i = y * (size + 1) + x;
+            indices.insert(indices.end(), { i, i + 1, i + size + 2, i, i + size + 2, i + size + 1 });
+        }
+    }
+    return indices;
+}
+
+TEST(RIndexBuffer, Uses16BitIndicesForSmallMeshes)
+{
+    std::vector<uint32_t> indices = getGridIndices(16);
+    RIndexBuffer buffer;
+    buffer.set(indices.data(), indices.size(), std::vector<RMeshPart>());
+    EXPECT_EQ(RIndexBuffer::FORMAT_UINT16, buffer.getFormat());
+    EXPECT_EQ(indices.size() * 2, buffer.getSize());
+    ASSERT_EQ(1u, buffer.getPartCount());
+
+    unsigned int count;
+    const RMeshPart* draws = buffer.getDraws(0, &count);
+    ASSERT_EQ(1u, count);
+    EXPECT_EQ(0u, draws[0].getBaseVertex());
+    EXPECT_EQ(indices.size(), draws[0].getIndexCount());
+    for (size_t i = 0; i < indices.size(); i++)
+        EXPECT_EQ(indices[i], buffer.getIndex(i));
+}
+
+TEST(RIndexBuffer, SplitsPartsSpanningMoreThan65536Vertices)
+{
+    // 301 x 301 vertices, two parts: the first 30 rows and the others.
+    std::vector<uint32_t> indices = getGridIndices(300);
+    uint32_t half = 30 * 300 * 6;
+    std::vector<RMeshPart> parts;
+    parts.push_back(RMeshPart(0, half, 0.0f));
+    parts.push_back(RMeshPart(half, (uint32_t)indices.size() - half, 0.5f));
+
+    RIndexBuffer buffer;
+    buffer.set(indices.data(), indices.size(), parts);
+    EXPECT_EQ(RIndexBuffer::FORMAT_UINT16, buffer.getFormat());
+    ASSERT_EQ(2u, buffer.getPartCount());
+
+    for (unsigned int p = 0; p < 2; p++)
+    {
+        unsigned int count;
+        const RMeshPart* draws = buffer.getDraws(p, &count);
+        ASSERT_GE(count, 1u);
+        uint32_t next = parts[p].getFirstIndex();
+        for (unsigned int d = 0; d < count; d++)
+        {
+            EXPECT_EQ(next, draws[d].getFirstIndex());
+            EXPECT_EQ(0u, draws[d].getIndexCount() % 3);
+            EXPECT_EQ(parts[p].getError(), draws[d].getError());
+            for (uint32_t i = draws[d].getFirstIndex(); i < draws[d].getFirstIndex() + draws[d].getIndexCount(); i++)
+                ASSERT_EQ(indices[i], buffer.getIndex(i) + draws[d].getBaseVertex());
+            next += draws[d].getIndexCount();
+        }
+        EXPECT_EQ(parts[p].getFirstIndex() + parts[p].getIndexCount(), next);
+    }
+    unsigned int count;
+    buffer.getDraws(1, &count);
+    EXPECT_EQ(2u, count);
+}
+
+TEST(RIndexBuffer, Uses32BitIndicesWhenATriangleSpansMoreThan65536Vertices)
+{
+    std::vector<uint32_t> indices = { 0, 1, 2, 0, 2, 70000 };
+    RIndexBuffer buffer;
+    buffer.set(indices.data(), indices.size(), std::vector<RMeshPart>());
+    EXPECT_EQ(RIndexBuffer::FORMAT_UINT32, buffer.getFormat());
+    EXPECT_EQ(4u, buffer.getIndexSize());
+    unsigned int count;
+    const RMeshPart* draws = buffer.getDraws(0, &count);
+    ASSERT_EQ(1u, count);
+    EXPECT_EQ(0u, draws[0].getBaseVertex());
+    EXPECT_EQ(70000u, buffer.getIndex(5));
+}
+
+TEST(RIndexBuffer, CompressesAndDecompressesIndices)
+{
+    std::vector<uint32_t> grid = getGridIndices(64);
+    std::vector<uint8_t> compressed;
+    RIndexBuffer::compress(grid.data(), grid.size(), &compressed);
+    EXPECT_LE(compressed.size(), RIndexBuffer::getCompressBound(grid.size()));
+    EXPECT_LT(compressed.size(), grid.size());
+
+    std::vector<uint32_t> decoded(grid.size());
+    ASSERT_TRUE(RIndexBuffer::decompress(compressed.data(), compressed.size(), decoded.data(), decoded.size()));
+    EXPECT_EQ(grid, decoded);
+
+    // Partial blocks, large deltas of either sign and full 32-bit values.
+    RRandom random(7);
+    for (size_t count : { (size_t)0, (size_t)1, (size_t)127, (size_t)129, (size_t)1000 })
+    {
+        std::vector<uint32_t> indices(count);
+        for (size_t i = 0; i < count; i++)
+            indices[i] = i % 7 == 0 ? random.nextUInt(0xffffffffu) : random.nextUInt(1000);
+        RIndexBuffer::compress(indices.data(), count, &compressed);
+        std::vector<uint32_t> result(count, 0xdeadbeef);
+        ASSERT_TRUE(RIndexBuffer::decompress(compressed.data(), compressed.size(), result.data(), count));
+        EXPECT_EQ(indices, result);
+    }
+
+    RIndexBuffer::compress(grid.data(), grid.size(), &compressed);
+    EXPECT_FALSE(RIndexBuffer::decompress(compressed.data(), compressed.size() - 1, decoded.data(), decoded.size()));
+    compressed[0] = 0;
+    EXPECT_FALSE(RIndexBuffer::decompress(compressed.data(), compressed.size(), decoded.data(), decoded.size()));
+
+    RIndexBuffer buffer;
+    EXPECT_FALSE(buffer.load(compressed.data(), compressed.size(), grid.size(), std::vector<RMeshPart>()));
+    EXPECT_EQ(0u, buffer.getIndexCount());
+    RIndexBuffer::compress(grid.data(), grid.size(), &compressed);
+    ASSERT_TRUE(buffer.load(compressed.data(), compressed.size(), grid.size(), std::vector<RMeshPart>()));
+    EXPECT_EQ(RIndexBuffer::FORMAT_UINT16, buffer.getFormat());
+    for (size_t i = 0; i < grid.size(); i++)
+        EXPECT_EQ(grid[i], buffer.getIndex(i));
+}
+
+TEST(RIndexBuffer, CompressesCacheOptimizedMeshes)
+{
+    // A grid of shuffled triangles, reordered for the vertex cache and fetch.
+    const unsigned int size = 64;
+    RMeshBuilder builder(3 * sizeof(float));
+    for (unsigned int y = 0; y <= size; y++)
+    {
+        for (unsigned int x = 0; x <= size; x++)
+        {
+            float position[3] = { (float)x, (float)y, 0.0f };
+            builder.addVertex(position);
+        }
+    }
+    std::vector<uint32_t> grid = getGridIndices(size);
+    std::vector<uint32_t> triangles(grid.size() / 3);
+    for (size_t t = 0; t < triangles.size(); t++)
+        triangles[t] = (uint32_t)t;
+    RRandom random(3);
+    for (size_t t = triangles.size() - 1; t > 0; t--)
+        std::swap(triangles[t], triangles[random.nextUInt((uint32_t)t + 1)]);
+    for (size_t t = 0; t < triangles.size(); t++)
+        builder.addTriangle(grid[triangles[t] * 3], grid[triangles[t] * 3 + 1], grid[triangles[t] * 3 + 2]);
+    builder.optimizeVertexCache();
+    builder.optimizeVertexFetch();
+
+    std::vector<uint32_t> indices(builder.getIndices(), builder.getIndices() + builder.getIndexCount());
+    std::vector<uint8_t> compressed;
+    RIndexBuffer::compress(indices.data(), indices.size(), &compressed);
+    EXPECT_LE(compressed.size(), RIndexBuffer::getCompressBound(indices.size()));
+    // Under 2 bytes per triangle, against 6 for 16-bit indices.
+    EXPECT_LT(compressed.size(), indices.size() / 3 * 2);
+
+    std::vector<uint32_t> decoded(indices.size());
+    ASSERT_TRUE(RIndexBuffer::decompress(compressed.data(), compressed.size(), decoded.data(), decoded.size()));
+    EXPECT_EQ(indices, decoded);
+}
+
+}
@@ -0,0 +1,139 @@
+#include "RTest.h"
+#include "graphics/RMeshInstance.h"
+#include "math/RPacking.h"
+
+namespace rocket
+{
+
+static RInstanceBatcher::Batch makeBatch(uint32_t mesh, float radius)
+{
+    RInstanceBatcher::Batch batch;
+    batch.shader = 1;
+    batch.material = 2;
+    batch.mesh = mesh;
+    batch.firstIndex = 0;
+    batch.indexCount = 36;
+    batch.baseVertex = (int32_t)(mesh - 10) * 65536;
+    batch.bounds.set(RVector3::zero(), radius);
+    return batch;
+}
+
+static RMatrix makeTranslation(float x, float y, float z)
+{
+    RMatrix m;
+    RMatrix::createTranslation(x, y, z, &m);
+    return m;
+}
+
+TEST(RInstanceBatcher, DrawsVisibleInstancesPerBatch)
+{
+    // The identity view projection culls to the [-1, 1] cube.
+    RFrustum frustum(RMatrix::identity());
+    RInstanceBatcher batcher(RInstanceBatcher::FORMAT_AFFINE);
+    unsigned int rocks = batcher.addBatch(makeBatch(10, 0.1f));
+    unsigned int trees = batcher.addBatch(makeBatch(11, 0.1f));
+
+    std::vector<std::unique_ptr<RMeshInstance>> instances;
+    for (int i = 0; i < 12; i++)
+    {
+        instances.emplace_back(new RMeshInstance(&batcher, i % 2 ? trees : rocks));
+        instances.back()->setTransform(makeTranslation(-3.0f + 0.5f * i, 0.0f, 0.0f));
+    }
+
+    std::vector<float> buffer(12 * 12);
+    RCommandBuffer commands;
+    size_t written = batcher.update(frustum, buffer.data(), buffer.size() * sizeof(float), &commands, 0);
+
+    // x = -1, -0.5, 0, 0.5, 1 are visible: rocks at -1, 0, 1 and trees at -0.5, 0.5.
+    EXPECT_EQ(5u, written);
+    EXPECT_EQ(5u, batcher.getStatistics().visible);
+    ASSERT_EQ(2u, commands.size());
+    EXPECT_EQ(10u, commands.get(0).mesh);
+    EXPECT_EQ(3u, commands.get(0).instanceCount);
+    EXPECT_EQ(0u, commands.get(0).firstInstance);
+    EXPECT_EQ(11u, commands.get(1).mesh);
+    EXPECT_EQ(2u, commands.get(1).instanceCount);
+    EXPECT_EQ(3u, commands.get(1).firstInstance);
+    EXPECT_EQ(0, commands.get(0).baseVertex);
+    EXPECT_EQ(65536, commands.get(1).baseVertex);
+
+    // Affine rows hold the translation in the last column.
+    const float expected[] = { -1.0f, 0.0f, 1.0f, -0.5f, 0.5f };
+    for (unsigned int i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(expected[i], buffer[i * 12 + 3]);
+        EXPECT_EQ(1.0f, buffer[i * 12 + 0]);
+    }
+
+    // Removing an instance moves another into its slot.
+    instances.erase(instances.begin() + 4);
+    EXPECT_EQ(11u, batcher.getInstanceCount());
+    commands.clear();
+    batcher.update(frustum, buffer.data(), buffer.size() * sizeof(float), &commands, 0);
+    EXPECT_EQ(2u, batcher.getVisibleCount(rocks));
+    EXPECT_EQ(2u, batcher.getVisibleCount(trees));
+}
+
+TEST(RInstanceBatcher, JobsWriteTheSameBufferAsOneThread)
+{
+    RFrustum frustum(RMatrix::identity());
+    RInstanceBatcher batcher(RInstanceBatcher::FORMAT_MATRIX);
+    for (uint32_t mesh = 0; mesh < 5; mesh++)
+        batcher.addBatch(makeBatch(mesh, 0.05f));
+
+    RRandom random(7);
+    std::vector<std::unique_ptr<RMeshInstance>> instances;
+    for (int i = 0; i < 3000; i++)
+    {
+        instances.emplace_back(new RMeshInstance(&batcher, random.nextUInt(5)));
+        instances.back()->setTransform(makeTranslation(random.nextFloat(-2.0f, 2.0f), random.nextFloat(-2.0f, 2.0f), 0.0f));
+    }
+
+    size_t capacity = 3000 * batcher.getStride();
+    std::vector<uint8_t> single(capacity), threaded(capacity);
+    batcher.begin(frustum, single.data(), capacity, 1);
+    batcher.cull(0);
+    size_t written = batcher.allocate();
+    batcher.write(0);
+    EXPECT_GT(written, 0u);
+    EXPECT_LT(written, 3000u);
+
+    const unsigned int jobs = 4;
+    batcher.begin(frustum, threaded.data(), capacity, jobs);
+    std::vector<std::thread> workers;
+    for (unsigned int job = 0; job < jobs; job++)
+        workers.emplace_back(&RInstanceBatcher::cull, &batcher, job);
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+    EXPECT_EQ(written, batcher.allocate());
+    workers.clear();
+    for (unsigned int job = 0; job < jobs; job++)
+        workers.emplace_back(&RInstanceBatcher::write, &batcher, job);
+    for (size_t i = 0; i < workers.size(); i++)
+        workers[i].join();
+
+    EXPECT_EQ(0, memcmp(single.data(), threaded.data(), written * batcher.getStride()));
+}
+
+TEST(RInstanceBatcher, DropsInstancesPastTheCapacity)
+{
+    RFrustum frustum(RMatrix::identity());
+    RInstanceBatcher batcher(RInstanceBatcher::FORMAT_AFFINE_HALF);
+    unsigned int first = batcher.addBatch(makeBatch(0, 0.1f));
+    unsigned int second = batcher.addBatch(makeBatch(1, 0.1f));
+    std::vector<std::unique_ptr<RMeshInstance>> instances;
+    for (int i = 0; i < 6; i++)
+        instances.emplace_back(new RMeshInstance(&batcher, i < 4 ? first : second));
+
+    // One spare transform past the capacity catches writes out of range.
+    std::vector<uint16_t> buffer(6 * 12, 0xffff);
+    RCommandBuffer commands;
+    EXPECT_EQ(5u, batcher.update(frustum, buffer.data(), 5 * batcher.getStride(), &commands, 0));
+    EXPECT_EQ(4u, batcher.getVisibleCount(first));
+    EXPECT_EQ(1u, batcher.getVisibleCount(second));
+    EXPECT_EQ(1u, batcher.getStatistics().dropped);
+    EXPECT_EQ(RPacking::toHalf(1.0f), buffer[4 * 12]);
+    EXPECT_EQ(0xffff, buffer[5 * 12]);
+}
+
+}
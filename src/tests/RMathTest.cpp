@@ -0,0 +1,39 @@
+#include "RTest.h"
+#include "math/RMath.h"
+
+namespace rocket
+{
+
+TEST(RMath, DenormalsAreZeroFlushesInputsAndResults)
+{
+    bool previous = RMath::setDenormalsAreZero(false);
+    EXPECT_FALSE(RMath::isDenormalsAreZero());
+
+    volatile float tiny = 1e-40f;
+    volatile float half = 0.5f;
+    ASSERT_TRUE(isDenormal(tiny));
+    EXPECT_TRUE(isDenormal(tiny * half));
+
+#ifdef ROCKET_SIMD_SSE2
+    EXPECT_FALSE(RMath::setDenormalsAreZero(true));
+    EXPECT_TRUE(RMath::isDenormalsAreZero());
+    // DAZ reads the denormal input as zero, FTZ flushes the denormal result of normal inputs.
+    EXPECT_EQ(0.0f, tiny * half);
+    volatile float small = 1e-30f;
+    EXPECT_EQ(0.0f, small * small);
+    EXPECT_TRUE(RMath::setDenormalsAreZero(false));
+#endif
+
+    RMath::setDenormalsAreZero(previous);
+}
+
+TEST(RMath, SmoothConvergesToTarget)
+{
+    float x = 0.0f;
+    for (int i = 0; i < 1000; i++)
+        RMath::smooth(&x, 10.0f, 0.016f, 0.1f);
+    EXPECT_NEAR(10.0f, x, 1e-3f);
+    EXPECT_FALSE(hasSlowValues(&x, 1));
+}
+
+}
@@ -0,0 +1,143 @@
+#include "RTest.h"
+
+namespace rocket
+{
+
+static const int MATRIX_TEST_SAMPLES = 20000;
+
+static RMatrix randomTRS(RRandom& random, float minScale, float maxScale)
+{
+    RMatrix m;
+    RMatrix::createTranslation(random.nextFloat(-100.0f, 100.0f), random.nextFloat(-100.0f, 100.0f), random.nextFloat(-100.0f, 100.0f), &m);
+    m.rotate(randomRotation(random));
+    m.scale(random.nextFloat(minScale, maxScale), random.nextFloat(minScale, maxScale), random.nextFloat(minScale, maxScale));
+    return m;
+}
+
+TEST(RMatrix, MultiplyMatchesDoubleReference)
+{
+    RRandom random(1);
+    RErrorStats stats("RMatrix::multiply");
+    for (int i = 0; i < MATRIX_TEST_SAMPLES; i++)
+    {
+        RMatrix a, b;
+        for (int k = 0; k < 16; k++)
+        {
+            a.m[k] = random.nextFloat(-10.0f, 10.0f);
+            b.m[k] = random.nextFloat(-10.0f, 10.0f);
+        }
+        RMatrix c;
+        RMatrix::multiply(a, b, &c);
+        RMatrixd r = RMatrixd(a) * RMatrixd(b);
+        // Bounded by 4 roundings of products of magnitude <= 100.
+        for (int k = 0; k < 16; k++)
+            stats.add(fabs(c.m[k] - r.m[k]) / 400.0);
+        ASSERT_FALSE(hasSlowValues(c.m, 16));
+    }
+    EXPECT_EQ(0u, stats.getNonFiniteCount());
+    EXPECT_LT(stats.getMax(), 1e-6);
+}
+
+TEST(RMatrix, InvertMatchesDoubleReference)
+{
+    RRandom random(2);
+    RErrorStats stats("RMatrix::invert (TRS)");
+    for (int i = 0; i < MATRIX_TEST_SAMPLES; i++)
+    {
+        RMatrix m = randomTRS(random, 0.1f, 10.0f);
+        RMatrix inverse;
+        ASSERT_TRUE(m.invert(&inverse));
+        ASSERT_FALSE(hasSlowValues(inverse.m, 16));
+
+        RMatrixd r;
+        ASSERT_TRUE(RMatrixd(m).invert(&r));
+        double scale = r.getMaxAbs();
+        for (int k = 0; k < 16; k++)
+            stats.add(fabs(inverse.m[k] - r.m[k]) / scale);
+    }
+    EXPECT_EQ(0u, stats.getNonFiniteCount());
+    EXPECT_LT(stats.getMax(), 1e-4);
+}
+
+TEST(RMatrix, InvertFuzz)
+{
+    RRandom random(3);
+    RErrorStats stats("RMatrix::invert (fuzz, relative to condition)");
+    for (int i = 0; i < MATRIX_TEST_SAMPLES; i++)
+    {
+        RMatrix m;
+        for (int k = 0; k < 16; k++)
+            m.m[k] = fuzzFloat(random, 10.0f);
+
+        RMatrixd r;
+        bool invertible = RMatrixd(m).invert(&r);
+        RMatrix inverse;
+        if (!m.invert(&inverse))
+            continue;
+        // A matrix the float path accepts must give a finite, normal result.
+        ASSERT_TRUE(invertible);
+        for (int k = 0; k < 16; k++)
+            ASSERT_TRUE(std::isfinite(inverse.m[k]));
+
+        // Forward error is bounded by the condition number times the precision.
+        double condition = RMatrixd(m).getMaxAbs() * r.getMaxAbs() * 16.0;
+        if (condition > 1e4)
+            continue;
+        double scale = r.getMaxAbs();
+        for (int k = 0; k < 16; k++)
+            stats.add(fabs(inverse.m[k] - r.m[k]) / (scale * condition));
+    }
+    EXPECT_EQ(0u, stats.getNonFiniteCount());
+    EXPECT_LT(stats.getMax(), 1e-5);
+}
+
+TEST(RMatrix, InvertSingularFails)
+{
+    RMatrix m(1, 2, 3, 4,
+              2, 4, 6, 8,
+              0, 1, 0, 1,
+              0, 0, 0, 1);
+    RMatrix inverse;
+    EXPECT_FALSE(m.invert(&inverse));
+
+    RMatrix zero;
+    zero.setZero();
+    EXPECT_FALSE(zero.invert(&inverse));
+}
+
+TEST(RMatrix, DecomposeRoundTrips)
+{
+    RRandom random(4);
+    RErrorStats translationStats("RMatrix::decompose translation");
+    RErrorStats scaleStats("RMatrix::decompose scale");
+    RErrorStats rotationStats("RMatrix::decompose rotation");
+    for (int i = 0; i < MATRIX_TEST_SAMPLES; i++)
+    {
+        RVector3 translation(random.nextFloat(-100.0f, 100.0f), random.nextFloat(-100.0f, 100.0f), random.nextFloat(-100.0f, 100.0f));
+        RVector3 scale(random.nextFloat(0.1f, 10.0f), random.nextFloat(0.1f, 10.0f), random.nextFloat(0.1f, 10.0f));
+        RQuaternion rotation = randomRotation(random);
+        RMatrix m;
+        RMatrix::createTranslation(translation, &m);
+        m.rotate(rotation);
+        m.scale(scale);
+
+        RVector3 t, s;
+        RQuaternion r;
+        ASSERT_TRUE(m.decompose(&s, &r, &t));
+        ASSERT_FALSE(hasSlowValues(&t.x, 3));
+        ASSERT_FALSE(hasSlowValues(&s.x, 3));
+
+        translationStats.add(t.distance(translation) / 100.0);
+        scaleStats.add(fabs(s.x - scale.x) / scale.x);
+        scaleStats.add(fabs(s.y - scale.y) / scale.y);
+        scaleStats.add(fabs(s.z - scale.z) / scale.z);
+        // q and -q are the same rotation.
+        double d = fabs((double)r.x * rotation.x + (double)r.y * rotation.y + (double)r.z * rotation.z + (double)r.w * rotation.w);
+        rotationStats.add(1.0 - std::min(d, 1.0));
+    }
+    EXPECT_LT(translationStats.getMax(), 1e-5);
+    EXPECT_LT(scaleStats.getMax(), 1e-4);
+    EXPECT_LT(rotationStats.getMax(), 1e-5);
+}
+
+}
@@ -0,0 +1,389 @@
+#include "RTest.h"
+#include "graphics/RMesh.h"
+#include "graphics/RMeshBuilder.h"
+#include <array>
+
+namespace rocket
+{
+
+/**
+ * Builds an unindexed grid of size x size quads (position and uv) with its triangles shuffled.
+ */
+static void buildShuffledGrid(RMeshBuilder* builder, unsigned int size, uint32_t seed)
+{
+    std::vector<std::array<float, 5>> corners;
+    for (unsigned int y = 0; y <= size; y++)
+    {
+        for (unsigned int x = 0; x <= size; x++)
+            corners.push_back({ (float)x, (float)y, 0.0f, (float)x / size, (float)y / size });
+    }
+    std::vector<std::array<unsigned int, 3>> triangles;
+    for (unsigned int y = 0; y < size; y++)
+    {
+        for (unsigned int x = 0; x < size; x++)
+        {
+            unsigned int i = y * (size + 1) + x;
+            triangles.push_back({ i, i + 1, i + size + 2 });
+            triangles.push_back({ i, i + size + 2, i + size + 1 });
+        }
+    }
+    RRandom random(seed);
+    for (size_t i = triangles.size() - 1; i > 0; i--)
+        std::swap(triangles[i], triangles[random.nextUInt((uint32_t)i + 1)]);
+    for (size_t t = 0; t < triangles.size(); t++)
+    {
+        uint32_t a = builder->addVertex(corners[triangles[t][0]].data());
+        uint32_t b = builder->addVertex(corners[triangles[t][1]].data());
+        uint32_t c = builder->addVertex(corners[triangles[t][2]].data());
+        builder->addTriangle(a, b, c);
+    }
+}
+
+/**
+ * Gets the triangles as sorted position triples, independent of vertex and triangle order.
+ */
+static std::vector<std::array<float, 9>> getTriangles(const RMeshBuilder& builder)
+{
+    std::vector<std::array<float, 9>> triangles;
+    for (size_t i = 0; i < builder.getIndexCount(); i += 3)
+    {
+        // Rotate so the smallest index first keeps the winding.
+        RVector3 p[3];
+        for (unsigned int k = 0; k < 3; k++)
+            p[k] = builder.getPosition(builder.getIndices()[i + k]);
+        unsigned int first = 0;
+        for (unsigned int k = 1; k < 3; k++)
+        {
+            if (p[k].x < p[first].x || (p[k].x == p[first].x && p[k].y < p[first].y))
+                first = k;
+        }
+        std::array<float, 9> triangle;
+        for (unsigned int k = 0; k < 3; k++)
+        {
+            const RVector3& q = p[(first + k) % 3];
+            triangle[k * 3] = q.x;
+            triangle[k * 3 + 1] = q.y;
+            triangle[k * 3 + 2] = q.z;
+        }
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+/**
+ * Builds a flat size x size grid in the xy plane, with the vertices of column seam duplicated when seam > 0.
+ */
+static void buildGrid(RMeshBuilder* builder, unsigned int size, unsigned int seam)
+{
+    for (unsigned int y = 0; y <= size; y++)
+    {
+        for (unsigned int x = 0; x <= size; x++)
+        {
+            float vertex[4] = { (float)x, (float)y, 0.0f, 0.0f };
+            builder->addVertex(vertex);
+        }
+    }
+    uint32_t seamStart = (uint32_t)builder->getVertexCount();
+    for (unsigned int y = 0; y <= size && seam > 0; y++)
+    {
+        float vertex[4] = { (float)seam, (float)y, 0.0f, 1.0f };
+        builder->addVertex(vertex);
+    }
+    for (unsigned int y = 0; y < size; y++)
+    {
+        for (unsigned int x = 0; x < size; x++)
+        {
+            // Quads right of the seam use the duplicated column.
+            uint32_t i[4] = { y * (size + 1) + x, y * (size + 1) + x + 1, (y + 1) * (size + 1) + x + 1, (y + 1) * (size + 1) + x };
+            if (seam > 0 && x == seam)
+            {
+                i[0] = seamStart + y;
+                i[3] = seamStart + y + 1;
+            }
+            builder->addTriangle(i[0], i[1], i[2]);
+            builder->addTriangle(i[0], i[2], i[3]);
+        }
+    }
+}
+
+static float getArea(const RMeshBuilder& builder, const uint32_t* indices, size_t count)
+{
+    float area = 0.0f;
+    for (size_t i = 0; i < count; i += 3)
+    {
+        RVector3 p0 = builder.getPosition(indices[i]);
+        RVector3 cross;
+        RVector3::cross(builder.getPosition(indices[i + 1]) - p0, builder.getPosition(indices[i + 2]) - p0, &cross);
+        area += 0.5f * cross.length();
+    }
+    return area;
+}
+
+TEST(RMeshBuilder, OptimizeKeepsTrianglesAndImprovesCacheEfficiency)
+{
+    const unsigned int size = 40;
+    RMeshBuilder builder(5 * sizeof(float));
+    buildShuffledGrid(&builder, size, 3);
+    std::vector<std::array<float, 9>> before = getTriangles(builder);
+
+    RMeshBuilder::Statistics stages[4];
+    RMeshBuilder::Statistics result = builder.optimize(stages);
+    printf("[ acmr     ] dedup %.3f cache %.3f overdraw %.3f fetch %.3f (atvr %.3f)\n",
+           stages[0].acmr, stages[1].acmr, stages[2].acmr, stages[3].acmr, result.atvr);
+
+    EXPECT_EQ((size + 1) * (size + 1), stages[0].vertexCount);
+    EXPECT_EQ(2 * size * size, result.triangleCount);
+    EXPECT_GT(stages[0].acmr, 1.5f);
+    EXPECT_LT(stages[1].acmr, 0.8f);
+    EXPECT_LE(stages[2].acmr, stages[1].acmr * 1.1f);
+    EXPECT_EQ(stages[2].acmr, stages[3].acmr);
+    EXPECT_LT(result.atvr, 1.4f);
+    EXPECT_EQ(before, getTriangles(builder));
+
+    // Vertices are in first use order.
+    uint32_t next = 0;
+    for (size_t i = 0; i < builder.getIndexCount(); i++)
+    {
+        ASSERT_LE(builder.getIndices()[i], next);
+        if (builder.getIndices()[i] == next)
+            next++;
+    }
+    EXPECT_EQ(builder.getVertexCount(), next);
+}
+
+TEST(RMeshBuilder, VertexFetchRemovesUnusedVertices)
+{
+    RMeshBuilder builder(3 * sizeof(float));
+    float positions[5][3] = { { 0, 0, 0 }, { 9, 9, 9 }, { 1, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 } };
+    builder.addVertices(positions, 5);
+    builder.addTriangle(4, 3, 2);
+    builder.addTriangle(2, 3, 0);
+
+    RMeshBuilder::Statistics statistics = builder.optimizeVertexFetch();
+    EXPECT_EQ(4u, statistics.vertexCount);
+    EXPECT_EQ(1.0f, statistics.atvr);
+    const uint32_t expected[] = { 0, 1, 2, 2, 1, 3 };
+    for (unsigned int i = 0; i < 6; i++)
+        EXPECT_EQ(expected[i], builder.getIndices()[i]);
+    EXPECT_EQ(1.0f, builder.getPosition(0).x);
+    EXPECT_EQ(0.0f, builder.getPosition(3).x);
+}
+
+TEST(RMeshBuilder, HandlesDegenerateTriangles)
+{
+    RMeshBuilder builder(3 * sizeof(float));
+    float positions[5][3] = { { 0, 0, 0 }, { 1, 0, 0 }, { 0, 1, 0 }, { 1, 1, 0 }, { 1, 0, 0 } };
+    builder.addVertices(positions, 4);
+
+    // No triangle misses on all three vertices when the first one is degenerate.
+    builder.addTriangle(0, 0, 1);
+    builder.addTriangle(0, 1, 2);
+    builder.addTriangle(1, 3, 2);
+    EXPECT_EQ(3u, builder.optimizeOverdraw().triangleCount);
+
+    // Vertex 4 duplicates vertex 1, so the triangle using both is dropped.
+    builder.clear();
+    builder.addVertices(positions, 5);
+    builder.addTriangle(0, 1, 4);
+    builder.addTriangle(0, 1, 2);
+    builder.addTriangle(4, 3, 2);
+    RMeshBuilder::Statistics statistics = builder.deduplicate();
+    EXPECT_EQ(4u, statistics.vertexCount);
+    EXPECT_EQ(2u, statistics.triangleCount);
+    const uint32_t expected[] = { 0, 1, 2, 1, 3, 2 };
+    for (unsigned int i = 0; i < 6; i++)
+        EXPECT_EQ(expected[i], builder.getIndices()[i]);
+    EXPECT_EQ(2u, builder.optimize().triangleCount);
+}
+
+TEST(RMeshBuilder, GeneratesLodChain)
+{
+    RMeshBuilder builder(3 * sizeof(float));
+    buildSphere(&builder, 32, 64);
+    size_t baseCount = builder.getIndexCount();
+    std::vector<RMeshPart> lods = builder.generateLods(5, 0.5f, 0.2f);
+
+    ASSERT_EQ(5u, lods.size());
+    EXPECT_EQ(baseCount, lods[0].getIndexCount());
+    EXPECT_EQ(0.0f, lods[0].getError());
+    for (size_t l = 1; l < lods.size(); l++)
+    {
+        printf("[ lod      ] %zu: %u triangles, error %.4f\n", l, lods[l].getTriangleCount(), lods[l].getError());
+        EXPECT_EQ(lods[l - 1].getFirstIndex() + lods[l - 1].getIndexCount(), lods[l].getFirstIndex());
+        EXPECT_LE(lods[l].getIndexCount(), lods[l - 1].getIndexCount() * 6 / 10);
+        EXPECT_GE(lods[l].getError(), lods[l - 1].getError());
+        EXPECT_LE(lods[l].getError(), 0.2f);
+    }
+    // Coarse levels still cover the sphere: its area is 4 pi, the base mesh a little less.
+    float area = getArea(builder, builder.getIndices() + lods[4].getFirstIndex(), lods[4].getIndexCount());
+    EXPECT_GT(area, 0.8f * 4.0f * MATH_PI);
+}
+
+TEST(RMeshBuilder, SimplifyKeepsBordersAndSeams)
+{
+    const unsigned int size = 16;
+    RMeshBuilder builder(4 * sizeof(float));
+    buildGrid(&builder, size, 8);
+    std::vector<uint32_t> indices;
+    float error = builder.simplify(0, 1e-4f, &indices);
+
+    // The flat interior collapses for free, the border and the seam stay.
+    EXPECT_LE(error, 1e-4f);
+    EXPECT_LT(indices.size(), builder.getIndexCount() / 4);
+    EXPECT_NEAR((float)(size * size), getArea(builder, indices.data(), indices.size()), 1e-3f);
+    std::vector<uint8_t> used(builder.getVertexCount(), 0);
+    for (size_t i = 0; i < indices.size(); i++)
+        used[indices[i]] = 1;
+    for (unsigned int i = 0; i <= size; i++)
+    {
+        EXPECT_TRUE(used[i]);
+        EXPECT_TRUE(used[size * (size + 1) + i]);
+        EXPECT_TRUE(used[i * (size + 1)]);
+        EXPECT_TRUE(used[i * (size + 1) + size]);
+        EXPECT_TRUE(used[i * (size + 1) + 8]);
+        EXPECT_TRUE(used[(size + 1) * (size + 1) + i]);
+    }
+}
+
+TEST(RMesh, SelectsCoarserLevelsWithDistance)
+{
+    RMesh mesh;
+    mesh.setBounds(RBoundingSphere(RVector3::zero(), 1.0f));
+    std::vector<RMeshPart> lods;
+    lods.push_back(RMeshPart(0, 3000, 0.0f));
+    lods.push_back(RMeshPart(3000, 1500, 0.01f));
+    lods.push_back(RMeshPart(4500, 750, 0.05f));
+    lods.push_back(RMeshPart(5250, 375, 0.2f));
+    mesh.setLods(lods);
+
+    RMatrix projection, view, world;
+    RMatrix::createPerspective(60.0f, 1.0f, 0.1f, 1000.0f, &projection);
+    unsigned int previous = 0;
+    const float distances[] = { 0.5f, 2.0f, 10.0f, 50.0f, 200.0f, 900.0f };
+    for (unsigned int i = 0; i < 6; i++)
+    {
+        RMatrix::createLookAt(RVector3(0.0f, 0.0f, distances[i]), RVector3::zero(), RVector3(0.0f, 1.0f, 0.0f), &view);
+        unsigned int level = mesh.selectLod(world, projection * view, 1080.0f, 1.0f);
+        EXPECT_GE(level, previous);
+        previous = level;
+        if (i == 0)
+        {
+            EXPECT_EQ(0u, level);
+        }
+    }
+    EXPECT_EQ(3u, previous);
+
+    // 1 pixel at 1080 lines and 60 degrees is 1.07e-3 units per unit of distance.
+    RMatrix::createLookAt(RVector3(0.0f, 0.0f, 11.0f), RVector3::zero(), RVector3(0.0f, 1.0f, 0.0f), &view);
+    EXPECT_NEAR(0.01f / 10.0f / (2.0f * tan(MATH_PI / 6.0f)) * 1080.0f,
+                mesh.getProjectedError(0.01f, world, projection * view, 1080.0f), 1e-3f);
+
+    // A scaled instance is larger on screen.
+    RMatrix::createScale(4.0f, 4.0f, 4.0f, &world);
+    EXPECT_GT(mesh.getProjectedError(0.01f, world, projection * view, 1080.0f), 4.0f * 0.9f);
+}
+
+TEST(RMeshBuilder, BuildsMeshletsCoveringEveryTriangle)
+{
+    RMeshBuilder builder(3 * sizeof(float));
+    buildSphere(&builder, 32, 64);
+    builder.optimizeVertexCache();
+    RMeshletSet meshlets;
+    builder.buildMeshlets(&meshlets, 64, 124);
+
+    std::vector<uint32_t> covered;
+    for (size_t i = 0; i < meshlets.size(); i++)
+    {
+        const RMeshlet& meshlet = meshlets.get(i);
+        ASSERT_LE(meshlet.vertexCount, 64u);
+        ASSERT_LE(meshlet.triangleCount, 124u);
+        for (uint32_t t = 0; t < meshlet.triangleCount * 3; t += 3)
+        {
+            uint32_t triangle[3];
+            for (unsigned int k = 0; k < 3; k++)
+            {
+                uint8_t local = meshlets.getTriangles()[meshlet.triangleOffset + t + k];
+                ASSERT_LT(local, meshlet.vertexCount);
+                triangle[k] = meshlets.getVertices()[meshlet.vertexOffset + local];
+                EXPECT_LE(meshlet.bounds.center.distance(builder.getPosition(triangle[k])), meshlet.bounds.radius * 1.0001f);
+            }
+            std::rotate(triangle, std::min_element(triangle, triangle + 3), triangle + 3);
+            covered.insert(covered.end(), triangle, triangle + 3);
+        }
+    }
+    // Compact meshlets average well over half the triangle limit.
+    EXPECT_LT(meshlets.size(), builder.getIndexCount() / 3 / 80);
+
+    std::vector<uint32_t> expected(builder.getIndices(), builder.getIndices() + builder.getIndexCount());
+    for (size_t i = 0; i < expected.size(); i += 3)
+        std::rotate(&expected[i], std::min_element(&expected[i], &expected[i] + 3), &expected[i] + 3);
+    std::vector<std::array<uint32_t, 3>> a(covered.size() / 3), b(expected.size() / 3);
+    memcpy(a.data(), covered.data(), covered.size() * sizeof(uint32_t));
+    memcpy(b.data(), expected.data(), expected.size() * sizeof(uint32_t));
+    std::sort(a.begin(), a.end());
+    std::sort(b.begin(), b.end());
+    EXPECT_EQ(b, a);
+}
+
+TEST(RMeshletSet, CullsBackFacingHiddenAndOutsideMeshlets)
+{
+    RMeshBuilder builder(3 * sizeof(float));
+    buildSphere(&builder, 32, 64);
+    builder.optimizeVertexCache();
+    RMeshletSet meshlets;
+    builder.buildMeshlets(&meshlets);
+
+    RVector3 camera(0.0f, 0.0f, 5.0f);
+    RMatrix projection, view, world;
+    RMatrix::createPerspective(60.0f, 1.0f, 0.1f, 100.0f, &projection);
+    RMatrix::createLookAt(camera, RVector3::zero(), RVector3(0.0f, 1.0f, 0.0f), &view);
+    RMatrix viewProjection = projection * view;
+    RFrustum frustum(viewProjection);
+
+    // Every front facing triangle is kept, and the far side is mostly culled.
+    std::vector<uint32_t> indices;
+    size_t visible = meshlets.cull(world, frustum, camera, NULL, &indices);
+    EXPECT_GT(meshlets.getStatistics().backfaceCulled, meshlets.size() / 4);
+    EXPECT_EQ(0u, meshlets.getStatistics().frustumCulled);
+    EXPECT_EQ(visible, meshlets.size() - meshlets.getStatistics().backfaceCulled);
+    std::set<std::array<uint32_t, 3>> kept;
+    for (size_t i = 0; i < indices.size(); i += 3)
+        kept.insert({ indices[i], indices[i + 1], indices[i + 2] });
+    for (size_t i = 0; i < builder.getIndexCount(); i += 3)
+    {
+        const uint32_t* t = builder.getIndices() + i;
+        RVector3 p0 = builder.getPosition(t[0]);
+        RVector3 normal;
+        RVector3::cross(builder.getPosition(t[1]) - p0, builder.getPosition(t[2]) - p0, &normal);
+        if (normal.dot(p0 - camera) < 0.0f)
+        {
+            EXPECT_TRUE(kept.count({ t[0], t[1], t[2] }));
+        }
+    }
+
+    // A wall between the camera and the sphere hides everything.
+    ROcclusionBuffer occlusion(64, 64);
+    occlusion.clear(viewProjection);
+    RVector3 wall[4] = { RVector3(-4, -4, 2), RVector3(4, -4, 2), RVector3(4, 4, 2), RVector3(-4, 4, 2) };
+    uint32_t wallIndices[6] = { 0, 1, 2, 0, 2, 3 };
+    occlusion.addOccluder(wall, wallIndices, 6, RMatrix::identity());
+    EXPECT_NEAR(3.0f, occlusion.getDepth(32, 32), 1e-4f);
+    EXPECT_EQ(0u, meshlets.cull(world, frustum, camera, &occlusion, &indices));
+    EXPECT_EQ(visible, meshlets.getStatistics().occlusionCulled);
+    EXPECT_TRUE(indices.empty());
+
+    // A wall behind the sphere hides nothing.
+    occlusion.clear(viewProjection);
+    RMatrix behind;
+    RMatrix::createTranslation(0.0f, 0.0f, -4.0f, &behind);
+    occlusion.addOccluder(wall, wallIndices, 6, behind);
+    EXPECT_EQ(visible, meshlets.cull(world, frustum, camera, &occlusion, &indices));
+
+    // Moved out of the frustum, every meshlet is culled.
+    RMatrix::createTranslation(50.0f, 0.0f, 0.0f, &world);
+    EXPECT_EQ(0u, meshlets.cull(world, frustum, camera, NULL, &indices));
+    EXPECT_EQ(meshlets.size(), meshlets.getStatistics().frustumCulled);
+}
+
+}
@@ -0,0 +1,223 @@
+#include "RTest.h"
+#include "graphics/RMeshFile.h"
+
+namespace rocket
+{
+
+/**
+ * Builds an optimized unit sphere of position only vertices with a chain of levels of detail.
+ */
+static std::vector<RMeshPart> buildSphereLods(RMeshBuilder* builder, unsigned int rings, unsigned int segments)
+{
+    buildSphere(builder, rings, segments);
+    builder->optimize();
+    return builder->generateLods(3);
+}
+
+static RVertexDeclaration getPositionDeclaration(RVertexDeclaration::Format format)
+{
+    RVertexDeclaration declaration;
+    declaration.add(RVertexDeclaration::SEMANTIC_POSITION, format);
+    return declaration;
+}
+
+TEST(RMeshFile, WritesAndLoadsMeshes)
+{
+    RMeshBuilder builder(3 * sizeof(float));
+    std::vector<RMeshPart> lods = buildSphereLods(&builder, 24, 48);
+    ASSERT_GE(lods.size(), 2u);
+    RMeshletSet meshlets;
+    builder.buildMeshlets(&meshlets);
+
+    std::vector<uint8_t> data;
+    RMeshFile::write(builder, getPositionDeclaration(RVertexDeclaration::FORMAT_FLOAT3),
+                     getPositionDeclaration(RVertexDeclaration::FORMAT_SNORM16_4), lods, &meshlets, false, &data);
+
+    RMeshFile file;
+    ASSERT_TRUE(file.openMemory(data.data(), data.size()));
+    EXPECT_TRUE(file.isComplete());
+    EXPECT_TRUE(file.verify());
+    const RMeshFile::Header* header = file.getHeader();
+    EXPECT_EQ(builder.getVertexCount(), header->vertexCount);
+    EXPECT_EQ(8u, header->vertexStride);
+    EXPECT_EQ(2u, header->indexSize);
+    EXPECT_EQ(0u, header->indexOffset % 64);
+    EXPECT_EQ(0u, header->vertexOffset % 64);
+
+    // The blocks are the builder's data, encoded.
+    const uint16_t* indices = (const uint16_t*)file.getIndices();
+    for (size_t i = 0; i < builder.getIndexCount(); i++)
+        ASSERT_EQ(builder.getIndices()[i], indices[i]);
+    RVertexDeclaration declaration = file.getDeclaration();
+    std::vector<float> positions(header->vertexCount * 4);
+    RVertexDeclaration::unpack(RVertexDeclaration::FORMAT_SNORM16_4, file.getVertices(), header->vertexStride, header->vertexCount,
+                               positions.data(), &declaration.getDecodeOffset(), &declaration.getDecodeScale());
+    for (uint32_t v = 0; v < header->vertexCount; v++)
+        EXPECT_LT(builder.getPosition(v).distance(RVector3(positions[v * 4], positions[v * 4 + 1], positions[v * 4 + 2])), 1e-4f);
+
+    RMesh mesh;
+    file.getMesh(&mesh);
+    ASSERT_EQ(lods.size(), mesh.getLodCount());
+    for (unsigned int l = 0; l < mesh.getLodCount(); l++)
+    {
+        EXPECT_EQ(lods[l].getFirstIndex(), mesh.getLod(l).getFirstIndex());
+        EXPECT_EQ(lods[l].getIndexCount(), mesh.getLod(l).getIndexCount());
+        EXPECT_EQ(lods[l].getError(), mesh.getLod(l).getError());
+        EXPECT_TRUE(file.isLodAvailable(l));
+    }
+    EXPECT_EQ(builder.getBounds().radius, mesh.getBounds().radius);
+
+    RMeshletSet loaded;
+    ASSERT_TRUE(file.getMeshlets(&loaded));
+    ASSERT_EQ(meshlets.size(), loaded.size());
+    EXPECT_EQ(meshlets.getVertices(), loaded.getVertices());
+    EXPECT_EQ(meshlets.getTriangles(), loaded.getTriangles());
+
+    // Corruption and truncation are detected.
+    data[header->vertexOffset] ^= 1;
+    EXPECT_FALSE(file.verify());
+    EXPECT_FALSE(file.openMemory(data.data(), sizeof(RMeshFile::Header) - 1));
+    data[0] = 'X';
+    EXPECT_FALSE(file.openMemory(data.data(), data.size()));
+}
+
+TEST(RMeshFile, StreamsTheCoarsestLevelFirst)
+{
+    RMeshBuilder builder(3 * sizeof(float));
+    std::vector<RMeshPart> lods = buildSphereLods(&builder, 24, 48);
+    unsigned int coarsest = (unsigned int)lods.size() - 1;
+
+    std::vector<uint8_t> data;
+    RMeshFile::write(builder, getPositionDeclaration(RVertexDeclaration::FORMAT_FLOAT3),
+                     getPositionDeclaration(RVertexDeclaration::FORMAT_FLOAT3), lods, NULL, true, &data);
+    RMeshFile file;
+    ASSERT_TRUE(file.openMemory(data.data(), data.size()));
+    const RMeshFile::Header header = *file.getHeader();
+    EXPECT_EQ(RMeshFile::FLAG_STREAMING, header.flags);
+    EXPECT_TRUE(file.verify());
+    EXPECT_EQ(NULL, file.getIndices());
+    EXPECT_EQ(NULL, file.getVertices());
+    EXPECT_LT(file.getLod(coarsest).vertexCount, builder.getVertexCount());
+
+    // The coarsest level needs about its share of the data, not the indices of the finer levels.
+    uint64_t coarsestData = (uint64_t)file.getLod(coarsest).indexCount * header.indexSize +
+                            (uint64_t)file.getLod(coarsest).vertexCount * header.vertexStride;
+    printf("[ stream   ] coarsest level needs %llu of %zu bytes\n", (unsigned long long)file.getLod(coarsest).requiredSize, data.size());
+    EXPECT_LT(file.getLod(coarsest).requiredSize, header.drawOffset + header.drawCount * sizeof(RMeshFile::Draw) + coarsestData + 128);
+    EXPECT_LT(file.getLod(coarsest).requiredSize * 3, data.size());
+
+    // Levels become available coarsest first, each drawing the same
+    // triangles from buffers filled with the data of the available levels.
+    std::vector<uint16_t> indices(header.indexCount);
+    std::vector<float> positions(header.vertexCount * 3);
+    for (unsigned int level = coarsest + 1; level-- > 0;)
+    {
+        const RMeshFile::Lod lod = file.getLod(level);
+        ASSERT_TRUE(file.openMemory(data.data(), (size_t)lod.requiredSize));
+        EXPECT_TRUE(file.isLodAvailable(level));
+        if (level > 0)
+        {
+            EXPECT_FALSE(file.isLodAvailable(level - 1));
+            EXPECT_EQ(NULL, file.getLodIndices(level - 1));
+            EXPECT_FALSE(file.isComplete());
+        }
+        memcpy(&indices[lod.firstIndex], file.getLodIndices(level), lod.indexCount * sizeof(uint16_t));
+        memcpy(&positions[lod.firstStoredVertex * 3], file.getLodVertices(level), lod.storedVertexCount * 3 * sizeof(float));
+        ASSERT_LE(lod.vertexCount, lod.firstStoredVertex + lod.storedVertexCount);
+
+        for (uint32_t i = 0; i < lod.indexCount; i++)
+        {
+            uint32_t index = indices[lod.firstIndex + i] + file.getDraws(level)[0].baseVertex;
+            ASSERT_LT(index, lod.vertexCount);
+            RVector3 expected = builder.getPosition(builder.getIndices()[lods[level].getFirstIndex() + i]);
+            EXPECT_EQ(expected, RVector3(positions[index * 3], positions[index * 3 + 1], positions[index * 3 + 2]));
+        }
+    }
+    EXPECT_LE(file.getLod(0).requiredSize, data.size());
+}
+
+TEST(RMeshFile, KeepsTheDrawsOfSplitLevels)
+{
+    // A row ordered grid of 90601 vertices, more than 16-bit indices reach from one base.
+    const unsigned int size = 300;
+    RMeshBuilder builder(3 * sizeof(float));
+    for (unsigned int y = 0; y <= size; y++)
+    {
+        for (unsigned int x = 0; x <= size; x++)
+        {
+            float p[3] = { (float)x, (float)y, 0.0f };
+            builder.addVertex(p);
+        }
+    }
+    for (unsigned int y = 0; y < size; y++)
+    {
+        for (unsigned int x = 0; x < size; x++)
+        {
+            uint32_t i = y * (size + 1) + x;
+            builder.addTriangle(i, i + 1, i + size + 2);
+            builder.addTriangle(i, i + size + 2, i + size + 1);
+        }
+    }
+
+    std::vector<uint8_t> data;
+    RMeshFile::write(builder, getPositionDeclaration(RVertexDeclaration::FORMAT_FLOAT3),
+                     getPositionDeclaration(RVertexDeclaration::FORMAT_FLOAT3), std::vector<RMeshPart>(), NULL, false, &data);
+    RMeshFile file;
+    ASSERT_TRUE(file.openMemory(data.data(), data.size()));
+    EXPECT_EQ(2u, file.getHeader()->indexSize);
+    ASSERT_GT(file.getLod(0).drawCount, 1u);
+
+    RMesh mesh;
+    file.getMesh(&mesh);
+    unsigned int count;
+    const RMeshPart* draws = mesh.getDraws(0, &count);
+    ASSERT_EQ(file.getLod(0).drawCount, count);
+    const uint16_t* indices = (const uint16_t*)file.getIndices();
+    uint32_t next = 0;
+    for (unsigned int d = 0; d < count; d++)
+    {
+        ASSERT_EQ(next, draws[d].getFirstIndex());
+        for (uint32_t i = draws[d].getFirstIndex(); i < draws[d].getFirstIndex() + draws[d].getIndexCount(); i++)
+            ASSERT_EQ(builder.getIndices()[i], indices[i] + draws[d].getBaseVertex());
+        next += draws[d].getIndexCount();
+    }
+    EXPECT_EQ(builder.getIndexCount(), next);
+
+    // Levels that were not split draw as themselves.
+    mesh.setLods(std::vector<RMeshPart>(1, RMeshPart(0, 30)));
+    draws = mesh.getDraws(0, &count);
+    ASSERT_EQ(1u, count);
+    EXPECT_EQ(30u, draws[0].getIndexCount());
+}
+
+TEST(RMeshFile, MapsFiles)
+{
+    RMeshBuilder builder(3 * sizeof(float));
+    std::vector<RMeshPart> lods = buildSphereLods(&builder, 8, 16);
+    std::vector<uint8_t> data;
+    RMeshFile::write(builder, getPositionDeclaration(RVertexDeclaration::FORMAT_FLOAT3),
+                     getPositionDeclaration(RVertexDeclaration::FORMAT_HALF4), lods, NULL, false, &data);
+
+    std::string path = ::testing::TempDir() + "rocket_mesh_file_test.rmsh";
+    {
+        std::ofstream stream(path, std::ios::binary);
+        stream.write((const char*)data.data(), (std::streamsize)data.size());
+    }
+    RMeshFile file;
+    ASSERT_TRUE(file.open(path.c_str()));
+    EXPECT_TRUE(file.verify());
+    EXPECT_EQ(0, memcmp(data.data(), file.getHeader(), data.size()));
+    file.close();
+    EXPECT_EQ(NULL, file.getHeader());
+
+    // A truncated file is not a complete mesh.
+    {
+        std::ofstream stream(path, std::ios::binary);
+        stream.write((const char*)data.data(), (std::streamsize)data.size() - 1);
+    }
+    EXPECT_FALSE(file.open(path.c_str()));
+    EXPECT_FALSE(file.open("missing.rmsh"));
+    std::remove(path.c_str());
+}
+
+}
@@ -0,0 +1,191 @@
+#include "RTest.h"
+#include "graphics/RGLStateCache.h"
+#include "graphics/RMipGenerator.h"
+#include "graphics/RTexture2D.h"
+#include "graphics/RTexture3D.h"
+
+namespace rocket
+{
+
+static std::vector<uint8_t> generateChain(const RMipGenerator& generator, const std::vector<uint8_t>& image,
+                                          unsigned int width, unsigned int height, unsigned int depth = 1)
+{
+    std::vector<uint8_t> chain(RMipGenerator::getChainSize(width, height, depth, 0));
+    EXPECT_TRUE(generator.generate(image.data(), width, height, depth, 0, chain.data()));
+    return chain;
+}
+
+TEST(RMipGenerator, AveragesWithBoxFilter)
+{
+    const unsigned int width = 4, height = 2;
+    std::vector<uint8_t> image(width * height * 4);
+    for (size_t i = 0; i < image.size(); i++)
+        image[i] = (uint8_t)(i * 8);
+
+    RMipGenerator generator;
+    std::vector<uint8_t> chain = generateChain(generator, image, width, height);
+    ASSERT_EQ((4u * 2u + 2u * 1u + 1u) * 4u, chain.size());
+    EXPECT_EQ(0, memcmp(chain.data(), image.data(), image.size()));
+
+    // Mip 1 pixel 0 averages pixels 0, 1, 4 and 5.
+    const uint8_t* mip1 = chain.data() + 32;
+    for (unsigned int c = 0; c < 4; c++)
+        EXPECT_EQ((image[c] + image[4 + c] + image[16 + c] + image[20 + c] + 2) / 4, mip1[c]);
+    const uint8_t* mip2 = mip1 + 8;
+    EXPECT_EQ((mip1[0] + mip1[4] + 1) / 2, mip2[0]);
+}
+
+TEST(RMipGenerator, FiltersOddSizesExactly)
+{
+    // Three pixels reduce to one, each weighing a third.
+    std::vector<uint8_t> image = { 30, 0, 0, 255, 60, 0, 0, 255, 150, 0, 0, 255 };
+    RMipGenerator generator;
+    std::vector<uint8_t> chain = generateChain(generator, image, 3, 1);
+    ASSERT_EQ(16u, chain.size());
+    EXPECT_EQ(80, chain[12]);
+    EXPECT_EQ(255, chain[15]);
+
+    RTexture3D texture(5, 4, 3, RTexture::FORMAT_RGBA8);
+    EXPECT_EQ(3u, texture.getMipCount());
+    EXPECT_EQ(1u, texture.getMipDepth(1));
+    EXPECT_EQ(RMipGenerator::getChainSize(5, 4, 3, 0), texture.getChainSize(0));
+}
+
+TEST(RMipGenerator, FiltersSrgbInLinearSpace)
+{
+    const unsigned int width = 8, height = 8;
+    std::vector<uint8_t> image(width * height * 4);
+    for (unsigned int i = 0; i < width * height; i++)
+    {
+        uint8_t value = ((i % width) + (i / width)) % 2 ? 255 : 0;
+        image[i * 4] = image[i * 4 + 1] = image[i * 4 + 2] = value;
+        image[i * 4 + 3] = value;
+    }
+
+    RMipGenerator generator;
+    std::vector<uint8_t> chain = generateChain(generator, image, width, height);
+    EXPECT_EQ(128, chain[width * height * 4]);
+
+    // Half of the light in linear space is 188 in sRGB, alpha stays linear.
+    generator.setSrgb(true);
+    chain = generateChain(generator, image, width, height);
+    EXPECT_EQ(188, chain[width * height * 4]);
+    EXPECT_EQ(128, chain[width * height * 4 + 3]);
+    EXPECT_EQ(188, chain[chain.size() - 4]);
+}
+
+TEST(RMipGenerator, RenormalizesNormalMaps)
+{
+    const unsigned int width = 2, height = 2;
+    // Normals tilted 45 degrees left and right average to a short vector along z.
+    std::vector<uint8_t> image = { 38, 128, 218, 255, 218, 128, 218, 255,
+                                   38, 128, 218, 255, 218, 128, 218, 255 };
+    RMipGenerator generator;
+    std::vector<uint8_t> chain = generateChain(generator, image, width, height);
+    EXPECT_EQ(218, chain[18]);
+
+    generator.setNormalMap(true);
+    generator.setSrgb(true);
+    chain = generateChain(generator, image, width, height);
+    EXPECT_EQ(128, chain[16]);
+    EXPECT_EQ(128, chain[17]);
+    EXPECT_EQ(255, chain[18]);
+}
+
+TEST(RMipGenerator, PreservesAlphaCoverage)
+{
+    const unsigned int width = 64, height = 64;
+    const float cutoff = 0.5f;
+    RRandom random(9);
+    std::vector<uint8_t> image(width * height * 4, 255);
+    for (unsigned int i = 0; i < width * height; i++)
+        image[i * 4 + 3] = random.nextFloat() < 0.3f ? 255 : (uint8_t)random.nextUInt(100);
+
+    auto getCoverage = [&](const uint8_t* pixels, size_t count)
+    {
+        size_t passing = 0;
+        for (size_t i = 0; i < count; i++)
+            passing += pixels[i * 4 + 3] >= cutoff * 255.0f;
+        return (float)passing / (float)count;
+    };
+    float reference = getCoverage(image.data(), width * height);
+    size_t mip3 = (64 * 64 + 32 * 32 + 16 * 16) * 4;
+
+    RMipGenerator generator;
+    std::vector<uint8_t> chain = generateChain(generator, image, width, height);
+    float filtered = getCoverage(chain.data() + mip3, 8 * 8);
+
+    generator.setAlphaCutoff(cutoff);
+    chain = generateChain(generator, image, width, height);
+    float preserved = getCoverage(chain.data() + mip3, 8 * 8);
+    EXPECT_LT(std::fabs(preserved - reference), 0.05f);
+    EXPECT_LT(std::fabs(preserved - reference), std::fabs(filtered - reference));
+}
+
+TEST(RMipGenerator, KaiserFilterKeepsFlatImagesOnAnyThreadCount)
+{
+    const unsigned int width = 40, height = 24, depth = 6;
+    std::vector<uint8_t> flat(width * height * depth * 4, 77);
+    RMipGenerator generator(RMipGenerator::FILTER_KAISER);
+    std::vector<uint8_t> chain = generateChain(generator, flat, width, height, depth);
+    for (size_t i = 0; i < chain.size(); i++)
+        ASSERT_EQ(77, chain[i]);
+
+    RRandom random(4);
+    std::vector<uint8_t> image(flat.size());
+    for (size_t i = 0; i < image.size(); i++)
+        image[i] = (uint8_t)random.nextUInt(256);
+    generator.setThreadCount(1);
+    std::vector<uint8_t> single = generateChain(generator, image, width, height, depth);
+    generator.setThreadCount(4);
+    EXPECT_EQ(single, generateChain(generator, image, width, height, depth));
+
+    std::vector<uint8_t> dst(4);
+    EXPECT_FALSE(generator.generate(image.data(), width, height, depth, 7, dst.data()));
+    EXPECT_FALSE(generator.generate(image.data(), 0, height, depth, 0, dst.data()));
+}
+
+TEST(RMipGenerator, UploadsChainsCoarseToFine)
+{
+    RGLRecorder recorder;
+    RGLStateCache cache(&recorder);
+    RTexture2D texture(16, 8, RTexture::FORMAT_RGBA8_SRGB);
+    ASSERT_TRUE(texture.create(&cache));
+    std::vector<uint8_t> image(16 * 8 * 4, 200);
+    EXPECT_TRUE(texture.uploadChain(&cache, image.data()));
+    EXPECT_EQ(5u, recorder.getCount(RGLRecorder::TEX_SUB_IMAGE_2D));
+    EXPECT_EQ(0u, recorder.getCalls().back().args[0]);
+    EXPECT_EQ(0u, texture.getResidentMip());
+
+    RTexture2D compressed(16, 16, RTexture::FORMAT_BC1);
+    ASSERT_TRUE(compressed.create(&cache));
+    EXPECT_TRUE(compressed.uploadChain(&cache, std::vector<uint8_t>(16 * 16 * 4, 90).data()));
+    EXPECT_EQ(5u, recorder.getCount(RGLRecorder::COMPRESSED_TEX_SUB_IMAGE_2D));
+}
+
+TEST(RMipGenerator, UploadsVolumeChainsCoarseToFine)
+{
+    RGLRecorder recorder;
+    RGLStateCache cache(&recorder);
+    RTexture3D texture(16, 8, 4, RTexture::FORMAT_RGBA8);
+    ASSERT_TRUE(texture.create(&cache));
+    std::vector<uint8_t> image(16 * 8 * 4 * 4, 200);
+    EXPECT_TRUE(texture.uploadChain(&cache, image.data()));
+    ASSERT_EQ(5u, recorder.getCount(RGLRecorder::TEX_SUB_IMAGE_3D));
+    unsigned int level = 5;
+    for (size_t i = 0; i < recorder.getCalls().size(); i++)
+    {
+        const RGLRecorder::Call& call = recorder.getCalls()[i];
+        if (call.type == RGLRecorder::TEX_SUB_IMAGE_3D)
+        {
+            EXPECT_EQ(--level, call.args[0]);
+            EXPECT_EQ(texture.getMipDepth(level), call.args[2]);
+        }
+    }
+
+    RTexture3D compressed(16, 16, 4, RTexture::FORMAT_BC1);
+    ASSERT_TRUE(compressed.create(&cache));
+    EXPECT_FALSE(compressed.uploadChain(&cache, std::vector<uint8_t>(16 * 16 * 4 * 4, 90).data()));
+}
+
+}
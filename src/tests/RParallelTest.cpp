@@ -0,0 +1,63 @@
+#include "RTest.h"
+#include "utilities/Parallel.h"
+
+#include <atomic>
+
+namespace rocket
+{
+
+static void countVisits(size_t count, unsigned int threadCount, std::vector<std::atomic<int>>* visits)
+{
+    RParallel::parallelFor(count, 16, threadCount, [&](size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; i++)
+            (*visits)[i]++;
+    });
+}
+
+TEST(RParallel, RunsEveryItemOnce)
+{
+    for (unsigned int threads = 1; threads <= 8; threads++)
+    {
+        std::vector<std::atomic<int>> visits(1000);
+        countVisits(visits.size(), threads, &visits);
+        for (size_t i = 0; i < visits.size(); i++)
+            ASSERT_EQ(1, visits[i].load()) << threads << " threads";
+    }
+
+    RParallel parallel;
+    EXPECT_GE(parallel.getThreadCount(), 1u);
+    parallel.setThreadCount(0);
+    EXPECT_EQ(1u, parallel.getThreadCount());
+}
+
+TEST(RParallel, NestsAndRunsFromSeveralThreads)
+{
+    // Inner loops queue behind the outer ones, the waiting threads run them.
+    std::vector<std::atomic<int>> visits(64 * 256);
+    RParallel::parallelFor(64, 1, 4, [&](size_t begin, size_t end)
+    {
+        for (size_t row = begin; row < end; row++)
+        {
+            RParallel::parallelFor(256, 16, 4, [&](size_t first, size_t last)
+            {
+                for (size_t i = first; i < last; i++)
+                    visits[row * 256 + i]++;
+            });
+        }
+    });
+    for (size_t i = 0; i < visits.size(); i++)
+        ASSERT_EQ(1, visits[i].load());
+
+    std::vector<std::atomic<int>> a(4096), b(4096);
+    std::thread other([&]() { countVisits(b.size(), 4, &b); });
+    countVisits(a.size(), 4, &a);
+    other.join();
+    for (size_t i = 0; i < a.size(); i++)
+    {
+        ASSERT_EQ(1, a[i].load());
+        ASSERT_EQ(1, b[i].load());
+    }
+}
+
+}
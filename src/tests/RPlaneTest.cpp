@@ -0,0 +1,230 @@
+#include "RTest.h"
+#include "math/RFrustum.h"
+#include "math/RMatrix.h"
+#include "math/RPlane.h"
+
+namespace rocket
+{
+
+/**
+ * Gets the signed area of a polygon in the z = 0 plane.
+ */
+static float getArea(const RVector3* points, unsigned int count)
+{
+    float area = 0.0f;
+    for (unsigned int i = 0; i < count; i++)
+    {
+        const RVector3& a = points[i];
+        const RVector3& b = points[(i + 1) % count];
+        area += a.x * b.y - b.x * a.y;
+    }
+    return area * 0.5f;
+}
+
+/**
+ * Determines if a point is inside every plane, within a tolerance.
+ */
+static bool isInside(const RPlane* planes, unsigned int planeCount, const RVector3& point)
+{
+    for (unsigned int i = 0; i < planeCount; i++)
+    {
+        if (planes[i].distance(point) < -1e-4f)
+            return false;
+    }
+    return true;
+}
+
+TEST(RPlane, ClipsPolygonsToOnePlane)
+{
+    const RVector3 square[4] = { RVector3(-1, -1, 0), RVector3(1, -1, 0), RVector3(1, 1, 0), RVector3(-1, 1, 0) };
+    RVector3 dst[5];
+
+    // Keeps x >= 0.5.
+    RPlane plane(RVector3(1, 0, 0), -0.5f);
+    unsigned int count = plane.clip(square, 4, dst);
+    ASSERT_EQ(4u, count);
+    EXPECT_NEAR(1.0f, getArea(dst, count), 1e-5f);
+    for (unsigned int i = 0; i < count; i++)
+        EXPECT_GE(dst[i].x, 0.5f - 1e-6f);
+
+    // A corner cut adds a point.
+    RPlane corner(RVector3(-1, -1, 0), 1.0f);
+    count = corner.clip(square, 4, dst);
+    ASSERT_EQ(5u, count);
+    EXPECT_NEAR(3.5f, getArea(dst, count), 1e-5f);
+
+    EXPECT_EQ(4u, RPlane(RVector3(0, 0, 1), 1.0f).clip(square, 4, dst));
+    EXPECT_EQ(0u, RPlane(RVector3(0, 0, 1), -1.0f).clip(square, 4, dst));
+}
+
+TEST(RPlane, ClipsSharedEdgesToTheSamePoint)
+{
+    // Two triangles sharing the edge b-c, wound in opposite directions along it.
+    const RVector3 a(-1.0f, -0.3f, 0.0f);
+    const RVector3 b(0.1f, -1.7f, 0.2f);
+    const RVector3 c(0.7f, 1.3f, -0.4f);
+    const RVector3 d(2.0f, 0.1f, 0.3f);
+    const RVector3 first[3] = { a, b, c };
+    const RVector3 second[3] = { d, c, b };
+    RPlane plane(RVector3(0.3f, 1.0f, 0.2f), 0.1f);
+
+    RVector3 clippedFirst[4];
+    RVector3 clippedSecond[4];
+    unsigned int firstCount = plane.clip(first, 3, clippedFirst);
+    unsigned int secondCount = plane.clip(second, 3, clippedSecond);
+    ASSERT_GT(firstCount, 0u);
+    ASSERT_GT(secondCount, 0u);
+
+    // The point on b-c is bitwise identical in both outputs.
+    unsigned int matches = 0;
+    for (unsigned int i = 0; i < firstCount; i++)
+    {
+        for (unsigned int j = 0; j < secondCount; j++)
+        {
+            if (clippedFirst[i] != b && clippedFirst[i] != c &&
+                memcmp(&clippedFirst[i], &clippedSecond[j], sizeof(RVector3)) == 0)
+                matches++;
+        }
+    }
+    EXPECT_EQ(1u, matches);
+}
+
+TEST(RPlane, ClipsPolygonsToSeveralPlanes)
+{
+    const RVector3 square[4] = { RVector3(-1, -1, 0), RVector3(1, -1, 0), RVector3(1, 1, 0), RVector3(-1, 1, 0) };
+    const RPlane planes[3] = { RPlane(RVector3(1, 0, 0), 0.0f), RPlane(RVector3(0, 1, 0), 0.0f),
+                               RPlane(RVector3(-1, -1, 0), 1.5f) };
+    RVector3 dst[7];
+    RVector3 scratch[7];
+
+    unsigned int count = RPlane::clip(planes, 2, square, 4, dst, scratch);
+    ASSERT_EQ(4u, count);
+    EXPECT_NEAR(1.0f, getArea(dst, count), 1e-5f);
+
+    // The quadrant with its far corner cut off.
+    count = RPlane::clip(planes, 3, square, 4, dst, scratch);
+    ASSERT_EQ(5u, count);
+    EXPECT_NEAR(0.875f, getArea(dst, count), 1e-5f);
+    for (unsigned int i = 0; i < count; i++)
+        EXPECT_TRUE(isInside(planes, 3, dst[i]));
+
+    const RPlane opposite[2] = { RPlane(RVector3(1, 0, 0), 0.0f), RPlane(RVector3(-1, 0, 0), -0.5f) };
+    EXPECT_EQ(0u, RPlane::clip(opposite, 2, square, 4, dst, scratch));
+}
+
+TEST(RPlane, ClipsTriangleLists)
+{
+    const RVector3 triangles[9] =
+    {
+        // Inside, copied as is.
+        RVector3(0.1f, 0.1f, 0), RVector3(0.5f, 0.1f, 0), RVector3(0.1f, 0.5f, 0),
+        // Outside, dropped.
+        RVector3(-3, -3, 0), RVector3(-2, -3, 0), RVector3(-3, -2, 0),
+        // Crossing one plane into a quad, fan triangulated.
+        RVector3(-1, 1, 0), RVector3(2, 0, 0), RVector3(2, 2, 0)
+    };
+    const RPlane planes[2] = { RPlane(RVector3(1, 0, 0), 0.0f), RPlane(RVector3(0, 1, 0), 0.0f) };
+    RVector3 dst[3 * 8];
+    unsigned int sources[8];
+
+    unsigned int count = RPlane::clipTriangles(planes, 2, triangles, 3, dst, 8, sources);
+    ASSERT_EQ(3u, count);
+    EXPECT_EQ(0u, sources[0]);
+    EXPECT_EQ(0, memcmp(dst, triangles, 3 * sizeof(RVector3)));
+    float area = 0.0f;
+    for (unsigned int t = 1; t < count; t++)
+    {
+        EXPECT_EQ(2u, sources[t]);
+        area += getArea(&dst[t * 3], 3);
+        for (unsigned int k = 0; k < 3; k++)
+            EXPECT_TRUE(isInside(planes, 2, dst[t * 3 + k]));
+    }
+    EXPECT_NEAR(8.0f / 3.0f, area, 1e-5f);
+
+    // Stops when the output is full.
+    EXPECT_EQ(2u, RPlane::clipTriangles(planes, 2, triangles, 3, dst, 2));
+}
+
+TEST(RPlane, CreatesPortalPlanes)
+{
+    const RVector3 eye(0.0f, 0.0f, 0.0f);
+    const RVector3 portal[4] = { RVector3(-1, -1, -5), RVector3(1, -1, -5), RVector3(1, 1, -5), RVector3(-1, 1, -5) };
+    const RVector3 reversed[4] = { portal[3], portal[2], portal[1], portal[0] };
+
+    for (const RVector3* polygon : { portal, reversed })
+    {
+        RPlane planes[5];
+        ASSERT_EQ(5u, RPlane::createPortalPlanes(eye, polygon, 4, planes));
+        EXPECT_TRUE(isInside(planes, 5, RVector3(0.0f, 0.0f, -10.0f)));
+        EXPECT_TRUE(isInside(planes, 5, RVector3(1.9f, 1.9f, -10.0f)));
+        EXPECT_FALSE(isInside(planes, 5, RVector3(2.1f, 0.0f, -10.0f)));
+        EXPECT_FALSE(isInside(planes, 5, RVector3(0.0f, -2.1f, -10.0f)));
+        // Between the eye and the portal.
+        EXPECT_FALSE(isInside(planes, 5, RVector3(0.0f, 0.0f, -2.0f)));
+    }
+
+    // A second portal seen through the first narrows the view.
+    RPlane planes[5];
+    RPlane::createPortalPlanes(eye, portal, 4, planes);
+    const RVector3 next[4] = { RVector3(0, 0, -10), RVector3(4, 0, -10), RVector3(4, 4, -10), RVector3(0, 4, -10) };
+    RVector3 clipped[9];
+    RVector3 scratch[9];
+    unsigned int count = RPlane::clip(planes, 5, next, 4, clipped, scratch);
+    ASSERT_EQ(4u, count);
+    RPlane narrowed[5];
+    ASSERT_EQ(5u, RPlane::createPortalPlanes(eye, clipped, count, narrowed));
+    EXPECT_TRUE(isInside(narrowed, 5, RVector3(1.5f, 1.5f, -15.0f)));
+    EXPECT_FALSE(isInside(narrowed, 5, RVector3(-1.5f, 1.5f, -15.0f)));
+
+    EXPECT_EQ(0u, RPlane::createPortalPlanes(eye, portal, 2, planes));
+    const RVector3 edgeOn[3] = { RVector3(0, 0, -1), RVector3(0, 1, -2), RVector3(0, -1, -2) };
+    EXPECT_EQ(0u, RPlane::createPortalPlanes(eye, edgeOn, 3, planes));
+}
+
+TEST(RFrustum, ClipsPolygonsAndTriangles)
+{
+    RMatrix projection;
+    RMatrix view;
+    RMatrix viewProjection;
+    RMatrix::createPerspective(60.0f, 1.0f, 1.0f, 100.0f, &projection);
+    RMatrix::createLookAt(RVector3(0, 0, 0), RVector3(0, 0, -1), RVector3(0, 1, 0), &view);
+    RMatrix::multiply(projection, view, &viewProjection);
+    RFrustum frustum(viewProjection);
+    RPlane planes[6];
+    frustum.getPlanes(planes);
+
+    // A quad larger than the view at z = -10 is cut to the view rectangle.
+    const RVector3 quad[4] = { RVector3(-50, -50, -10), RVector3(50, -50, -10), RVector3(50, 50, -10), RVector3(-50, 50, -10) };
+    RVector3 dst[10];
+    RVector3 scratch[10];
+    unsigned int count = frustum.clip(quad, 4, dst, scratch);
+    ASSERT_EQ(4u, count);
+    float half = 10.0f * tanf(MATH_DEG_TO_RAD(30.0f));
+    EXPECT_NEAR(4.0f * half * half, getArea(dst, count), 1e-3f);
+    for (unsigned int i = 0; i < count; i++)
+        EXPECT_TRUE(isInside(planes, 6, dst[i]));
+
+    // A quad crossing the near plane keeps only the part in front of it.
+    const RVector3 floor[4] = { RVector3(-1, -1, 5), RVector3(1, -1, 5), RVector3(1, -1, -5), RVector3(-1, -1, -5) };
+    count = frustum.clip(floor, 4, dst, scratch);
+    ASSERT_GE(count, 3u);
+    for (unsigned int i = 0; i < count; i++)
+    {
+        EXPECT_TRUE(isInside(planes, 6, dst[i]));
+        EXPECT_LE(dst[i].z, -1.0f + 1e-4f);
+    }
+
+    // Behind the camera.
+    const RVector3 behind[3] = { RVector3(-1, 0, 5), RVector3(1, 0, 5), RVector3(0, 1, 5) };
+    EXPECT_EQ(0u, frustum.clip(behind, 3, dst, scratch));
+
+    RVector3 triangles[3 * 8];
+    const RVector3 large[3] = { RVector3(-50, -50, -10), RVector3(50, -50, -10), RVector3(0, 50, -10) };
+    unsigned int triangleCount = frustum.clipTriangles(large, 1, triangles, 8);
+    ASSERT_GE(triangleCount, 1u);
+    for (unsigned int k = 0; k < triangleCount * 3; k++)
+        EXPECT_TRUE(isInside(planes, 6, triangles[k]));
+    EXPECT_EQ(0u, frustum.clipTriangles(behind, 1, triangles, 8));
+}
+
+}
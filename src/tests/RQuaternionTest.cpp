@@ -0,0 +1,143 @@
+#include "RTest.h"
+#include "math/RQuaternionArray.h"
+
+namespace rocket
+{
+
+static const int QUATERNION_TEST_SAMPLES = 50000;
+
+/**
+ * Reference slerp in double precision, taking the short way around like RQuaternion::slerp.
+ */
+static void slerpReference(const RQuaternion& a, const RQuaternion& b, double t, double* dst)
+{
+    double qa[4] = { a.x, a.y, a.z, a.w };
+    double qb[4] = { b.x, b.y, b.z, b.w };
+    double cosTheta = qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2] + qa[3] * qb[3];
+    if (cosTheta < 0.0)
+    {
+        cosTheta = -cosTheta;
+        for (int i = 0; i < 4; i++)
+            qb[i] = -qb[i];
+    }
+    double wa, wb;
+    if (cosTheta > 1.0 - 1e-12)
+    {
+        wa = 1.0 - t;
+        wb = t;
+    }
+    else
+    {
+        double theta = acos(cosTheta);
+        wa = sin((1.0 - t) * theta) / sin(theta);
+        wb = sin(t * theta) / sin(theta);
+    }
+    for (int i = 0; i < 4; i++)
+        dst[i] = wa * qa[i] + wb * qb[i];
+}
+
+TEST(RQuaternion, SlerpMatchesDoubleReference)
+{
+    RRandom random(10);
+    RErrorStats stats("RQuaternion::slerp");
+    for (int i = 0; i < QUATERNION_TEST_SAMPLES; i++)
+    {
+        RQuaternion a = randomRotation(random);
+        RQuaternion b = randomRotation(random);
+        float t = random.nextFloat();
+        RQuaternion q;
+        RQuaternion::slerp(a, b, t, &q);
+        ASSERT_FALSE(hasSlowValues(&q.x, 4));
+
+        double r[4];
+        slerpReference(a, b, t, r);
+        // q and -q are the same rotation, slerp may return either.
+        double sign = q.x * r[0] + q.y * r[1] + q.z * r[2] + q.w * r[3] < 0.0 ? -1.0 : 1.0;
+        double error = 0.0;
+        for (int k = 0; k < 4; k++)
+            error = std::max(error, fabs((&q.x)[k] - sign * r[k]));
+        stats.add(error);
+    }
+    EXPECT_EQ(0u, stats.getNonFiniteCount());
+    // The series approximation in slerp is accurate to about 1e-5.
+    EXPECT_LT(stats.getMax(), 1e-4);
+}
+
+TEST(RQuaternion, SlerpEndpointsAreExact)
+{
+    RRandom random(11);
+    for (int i = 0; i < 1000; i++)
+    {
+        RQuaternion a = randomRotation(random);
+        RQuaternion b = randomRotation(random);
+        RQuaternion q;
+        RQuaternion::slerp(a, b, 0.0f, &q);
+        EXPECT_TRUE(a.x == q.x && a.y == q.y && a.z == q.z && a.w == q.w);
+        RQuaternion::slerp(a, b, 1.0f, &q);
+        EXPECT_TRUE(b.x == q.x && b.y == q.y && b.z == q.z && b.w == q.w);
+    }
+}
+
+TEST(RQuaternion, MultiplyMatchesDoubleReference)
+{
+    RRandom random(12);
+    RErrorStats stats("RQuaternion::multiply");
+    for (int i = 0; i < QUATERNION_TEST_SAMPLES; i++)
+    {
+        RQuaternion a = randomRotation(random);
+        RQuaternion b = randomRotation(random);
+        RQuaternion q = a * b;
+
+        double x = (double)a.w * b.x + (double)a.x * b.w + (double)a.y * b.z - (double)a.z * b.y;
+        double y = (double)a.w * b.y - (double)a.x * b.z + (double)a.y * b.w + (double)a.z * b.x;
+        double z = (double)a.w * b.z + (double)a.x * b.y - (double)a.y * b.x + (double)a.z * b.w;
+        double w = (double)a.w * b.w - (double)a.x * b.x - (double)a.y * b.y - (double)a.z * b.z;
+        stats.add(std::max(std::max(fabs(q.x - x), fabs(q.y - y)), std::max(fabs(q.z - z), fabs(q.w - w))));
+    }
+    EXPECT_LT(stats.getMax(), 1e-6);
+}
+
+TEST(RQuaternionArray, MatchesScalarPath)
+{
+    RRandom random(13);
+    const size_t count = 1001;
+    RQuaternionArray a, b;
+    RVector3Array v;
+    for (size_t i = 0; i < count; i++)
+    {
+        a.push_back(randomRotation(random));
+        b.push_back(randomRotation(random));
+        v.push_back(RVector3(random.nextFloat(-10.0f, 10.0f), random.nextFloat(-10.0f, 10.0f), random.nextFloat(-10.0f, 10.0f)));
+    }
+
+    RQuaternionArray product, blend;
+    RVector3Array rotated;
+    RQuaternionArray::multiply(a, b, &product);
+    RQuaternionArray::nlerp(a, b, 0.25f, &blend);
+    RQuaternionArray::rotate(a, v, &rotated);
+    ASSERT_EQ(count, product.size());
+    ASSERT_EQ(count, rotated.size());
+
+    RErrorStats stats("RQuaternionArray vs RQuaternion");
+    for (size_t i = 0; i < count; i++)
+    {
+        RQuaternion p = a.get(i) * b.get(i);
+        RQuaternion q = product.get(i);
+        stats.add(fabs(p.x - q.x) + fabs(p.y - q.y) + fabs(p.z - q.z) + fabs(p.w - q.w));
+
+        RQuaternion l;
+        RQuaternion::lerp(a.get(i), b.get(i), 0.25f, &l);
+        RQuaternion n = blend.get(i);
+        double d = fabs((double)n.x * l.x + (double)n.y * l.y + (double)n.z * l.z + (double)n.w * l.w) /
+                   sqrt((double)l.x * l.x + (double)l.y * l.y + (double)l.z * l.z + (double)l.w * l.w);
+        if (a.get(i).x * b.get(i).x + a.get(i).y * b.get(i).y + a.get(i).z * b.get(i).z + a.get(i).w * b.get(i).w >= 0.0f)
+            stats.add(1.0 - d);
+
+        RVector3 r;
+        a.get(i).rotatePoint(v.get(i), &r);
+        stats.add(r.distance(rotated.get(i)) / 10.0);
+    }
+    EXPECT_LT(stats.getMax(), 1e-5);
+}
+
+}
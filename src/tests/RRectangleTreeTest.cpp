@@ -0,0 +1,125 @@
+#include "RTest.h"
+#include "math/RRectangleTree.h"
+#include <algorithm>
+
+namespace rocket
+{
+
+/**
+ * Gets the distance from a point to a rectangle, 0 inside it.
+ */
+static float getDistance(float x, float y, const RRectangle& rect)
+{
+    float dx = std::max(std::max(rect.x - x, x - (rect.x + rect.width)), 0.0f);
+    float dy = std::max(std::max(rect.y - y, y - (rect.y + rect.height)), 0.0f);
+    return sqrtf(dx * dx + dy * dy);
+}
+
+/**
+ * Checks the queries of a tree against a linear scan of its rectangles.
+ */
+static void expectQueriesMatchScan(const RRectangleTree& tree, const std::vector<int>& ids, RRandom* random)
+{
+    std::vector<int> results;
+    std::vector<int> expected;
+    for (int q = 0; q < 100; q++)
+    {
+        float x = random->nextFloat(0.0f, 1000.0f);
+        float y = random->nextFloat(0.0f, 1000.0f);
+        expected.clear();
+        for (int id : ids)
+        {
+            if (tree.getRectangle(id).contains(x, y))
+                expected.push_back(id);
+        }
+        results.clear();
+        EXPECT_EQ(expected.size(), tree.query(x, y, &results));
+        std::sort(results.begin(), results.end());
+        EXPECT_EQ(expected, results);
+
+        RRectangle area(x, y, random->nextFloat(0.0f, 200.0f), random->nextFloat(0.0f, 200.0f));
+        expected.clear();
+        for (int id : ids)
+        {
+            if (tree.getRectangle(id).intersects(area))
+                expected.push_back(id);
+        }
+        results.clear();
+        EXPECT_EQ(expected.size(), tree.query(area, &results));
+        std::sort(results.begin(), results.end());
+        EXPECT_EQ(expected, results);
+
+        float best = FLT_MAX;
+        for (int id : ids)
+            best = std::min(best, getDistance(x, y, tree.getRectangle(id)));
+        float distance = -1.0f;
+        int nearest = tree.nearest(x, y, FLT_MAX, &distance);
+        ASSERT_NE(RRectangleTree::NULL_NODE, nearest);
+        EXPECT_NEAR(best, distance, 1e-3f);
+        EXPECT_NEAR(best, getDistance(x, y, tree.getRectangle(nearest)), 1e-3f);
+    }
+}
+
+TEST(RRectangleTree, QueriesMatchALinearScan)
+{
+    RRandom random(5);
+    RRectangleTree tree;
+    std::vector<int> ids;
+    for (int i = 0; i < 500; i++)
+    {
+        RRectangle rect(random.nextFloat(0.0f, 1000.0f), random.nextFloat(0.0f, 1000.0f),
+                        random.nextFloat(1.0f, 50.0f), random.nextFloat(1.0f, 50.0f));
+        ids.push_back(tree.insert(rect, &ids));
+    }
+    EXPECT_EQ(500u, tree.size());
+    EXPECT_EQ(&ids, tree.getUserData(ids[17]));
+    // Balanced: well under the height of a list.
+    EXPECT_LE(tree.getHeight(), 20);
+    std::sort(ids.begin(), ids.end());
+    expectQueriesMatchScan(tree, ids, &random);
+
+    // Small moves stay in the fat bounds, large ones restructure the tree.
+    const RRectangle& moved = tree.getRectangle(ids[0]);
+    EXPECT_FALSE(tree.move(ids[0], RRectangle(moved.x + 1.0f, moved.y, moved.width, moved.height)));
+    EXPECT_TRUE(tree.move(ids[1], RRectangle(990.0f, 5.0f, 5.0f, 5.0f)));
+    for (size_t i = 2; i < ids.size(); i += 3)
+    {
+        tree.move(ids[i], RRectangle(random.nextFloat(0.0f, 1000.0f), random.nextFloat(0.0f, 1000.0f),
+                                     random.nextFloat(1.0f, 50.0f), random.nextFloat(1.0f, 50.0f)));
+    }
+    expectQueriesMatchScan(tree, ids, &random);
+
+    std::vector<int> kept;
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        if (i % 2 == 0)
+            tree.remove(ids[i]);
+        else
+            kept.push_back(ids[i]);
+    }
+    EXPECT_EQ(kept.size(), tree.size());
+    expectQueriesMatchScan(tree, kept, &random);
+}
+
+TEST(RRectangleTree, HandlesEmptyTreesAndDistanceLimits)
+{
+    RRectangleTree tree;
+    std::vector<int> results;
+    EXPECT_EQ(0u, tree.query(1.0f, 1.0f, &results));
+    EXPECT_EQ(RRectangleTree::NULL_NODE, tree.nearest(0.0f, 0.0f));
+
+    int id = tree.insert(RRectangle(10.0f, 10.0f, 5.0f, 5.0f));
+    EXPECT_EQ(0, tree.getHeight());
+    EXPECT_EQ(1u, tree.query(10.0f, 15.0f, &results));
+    EXPECT_EQ(id, results[0]);
+    float distance;
+    EXPECT_EQ(id, tree.nearest(13.0f, 19.0f, 5.0f, &distance));
+    EXPECT_FLOAT_EQ(4.0f, distance);
+    EXPECT_EQ(RRectangleTree::NULL_NODE, tree.nearest(13.0f, 19.0f, 3.0f));
+
+    tree.clear();
+    EXPECT_EQ(0u, tree.size());
+    EXPECT_EQ(RRectangleTree::NULL_NODE, tree.nearest(13.0f, 19.0f));
+}
+
+}
@@ -0,0 +1,206 @@
+#include "RTest.h"
+#include "graphics/RGLStreamBuffer.h"
+#include "graphics/RRingBuffer.h"
+
+namespace rocket
+{
+
+/**
+ * Fences signaled by the test instead of a GPU.
+ */
+class MockFences : public RRingBuffer::Fences
+{
+public:
+
+    std::vector<bool> signaled;
+    std::vector<bool> released;
+    unsigned int waits = 0;
+
+    uint64_t insert()
+    {
+        signaled.push_back(false);
+        released.push_back(false);
+        return signaled.size() - 1;
+    }
+
+    bool isSignaled(uint64_t fence)
+    {
+        return signaled[fence];
+    }
+
+    void wait(uint64_t fence)
+    {
+        signaled[fence] = true;
+        waits++;
+    }
+
+    void release(uint64_t fence)
+    {
+        released[fence] = true;
+    }
+};
+
+TEST(RRingBuffer, AlignsAllocationsAndWrapsAround)
+{
+    std::vector<uint8_t> memory(1000);
+    MockFences fences;
+    RRingBuffer ring(memory.data(), memory.size(), &fences);
+
+    ring.beginFrame();
+    RRingBuffer::Allocation a = ring.allocate(100, 1);
+    RRingBuffer::Allocation b = ring.allocate(100, 256);
+    EXPECT_EQ(memory.data(), a.data);
+    EXPECT_EQ(0u, a.offset);
+    EXPECT_EQ(256u, b.offset);
+    EXPECT_EQ(memory.data() + 256, b.data);
+    EXPECT_EQ(356u, ring.getUsedSize());
+    ring.endFrame();
+    fences.signaled[0] = true;
+
+    // 600 bytes do not fit after 356, so the allocation starts at 0 again.
+    ring.beginFrame();
+    EXPECT_EQ(0u, ring.getUsedSize());
+    EXPECT_TRUE(fences.released[0]);
+    RRingBuffer::Allocation c = ring.allocate(600, 8);
+    ASSERT_NE(nullptr, c.data);
+    EXPECT_EQ(360u, c.offset);
+    RRingBuffer::Allocation d = ring.allocate(100, 8);
+    ASSERT_NE(nullptr, d.data);
+    EXPECT_EQ(0u, d.offset);
+    EXPECT_EQ(0u, ring.getStatistics().failures);
+    EXPECT_EQ(4u, ring.getStatistics().allocations);
+}
+
+TEST(RRingBuffer, ReusesMemoryOnlyAfterTheGpuIsDone)
+{
+    std::vector<uint8_t> memory(1024);
+    MockFences fences;
+    RRingBuffer ring(memory.data(), memory.size(), &fences, 3);
+
+    // Three frames in flight fill 900 bytes, the GPU has not finished any.
+    size_t offsets[4];
+    for (unsigned int frame = 0; frame < 3; frame++)
+    {
+        ring.beginFrame();
+        RRingBuffer::Allocation allocation = ring.allocate(300);
+        ASSERT_NE(nullptr, allocation.data);
+        offsets[frame] = allocation.offset;
+        memset(allocation.data, frame + 1, allocation.size);
+        ring.endFrame();
+    }
+    EXPECT_EQ(0u, fences.waits);
+    EXPECT_EQ(3u, ring.getPendingFrameCount());
+
+    // Without room the allocation fails instead of overwriting pending data.
+    EXPECT_EQ(nullptr, ring.allocate(300).data);
+    EXPECT_EQ(1u, ring.getStatistics().failures);
+
+    // The fourth frame waits for the oldest pending frame, and reuses its memory.
+    ring.beginFrame();
+    EXPECT_EQ(1u, fences.waits);
+    RRingBuffer::Allocation allocation = ring.allocate(300);
+    ASSERT_NE(nullptr, allocation.data);
+    offsets[3] = allocation.offset;
+    EXPECT_EQ(offsets[0], offsets[3]);
+    for (unsigned int frame = 1; frame < 3; frame++)
+        EXPECT_EQ(frame + 1, memory[offsets[frame]]);
+    ring.endFrame();
+
+    // Empty frames insert no fence, signaled frames retire without waiting.
+    size_t fenceCount = fences.signaled.size();
+    std::fill(fences.signaled.begin(), fences.signaled.end(), true);
+    ring.beginFrame();
+    ring.endFrame();
+    EXPECT_EQ(fenceCount, fences.signaled.size());
+    EXPECT_EQ(0u, ring.getPendingFrameCount());
+    EXPECT_EQ(1u, ring.getStatistics().waits);
+}
+
+TEST(RRingBuffer, AllocatesConcurrentlyWithoutOverlap)
+{
+    const unsigned int threadCount = 8;
+    const unsigned int allocationsPerThread = 2000;
+    std::vector<uint8_t> memory(threadCount * allocationsPerThread * 96);
+    MockFences fences;
+    RRingBuffer ring(memory.data(), memory.size(), &fences);
+    ring.beginFrame();
+
+    std::vector<std::vector<RRingBuffer::Allocation>> allocations(threadCount);
+    std::vector<std::thread> threads;
+    for (unsigned int t = 0; t < threadCount; t++)
+    {
+        threads.push_back(std::thread([&, t]()
+        {
+            RRandom random(t + 1);
+            for (unsigned int i = 0; i < allocationsPerThread; i++)
+            {
+                RRingBuffer::Allocation allocation = ring.allocate(1 + random.nextUInt(64), 16);
+                ASSERT_NE(nullptr, allocation.data);
+                memset(allocation.data, (int)t + 1, allocation.size);
+                allocations[t].push_back(allocation);
+            }
+        }));
+    }
+    for (size_t t = 0; t < threads.size(); t++)
+        threads[t].join();
+    ring.endFrame();
+
+    std::vector<RRingBuffer::Allocation> all;
+    for (unsigned int t = 0; t < threadCount; t++)
+    {
+        for (size_t i = 0; i < allocations[t].size(); i++)
+        {
+            const RRingBuffer::Allocation& allocation = allocations[t][i];
+            EXPECT_EQ(0u, allocation.offset % 16);
+            for (size_t b = 0; b < allocation.size; b++)
+                ASSERT_EQ(t + 1, allocation.data[b]);
+            all.push_back(allocation);
+        }
+    }
+    std::sort(all.begin(), all.end(), [](const RRingBuffer::Allocation& a, const RRingBuffer::Allocation& b) { return a.offset < b.offset; });
+    for (size_t i = 1; i < all.size(); i++)
+        EXPECT_LE(all[i - 1].offset + all[i - 1].size, all[i].offset);
+    EXPECT_EQ(threadCount * allocationsPerThread, ring.getStatistics().allocations);
+}
+
+TEST(RRingBuffer, RunsOnAStreamBufferWithoutAContext)
+{
+    RGLRecorder recorder;
+    recorder.setInteger(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, 64);
+    RGLStreamBuffer buffer;
+    EXPECT_FALSE(buffer.create(&recorder, GL_UNIFORM_BUFFER, 0));
+    ASSERT_TRUE(buffer.create(&recorder, GL_UNIFORM_BUFFER, 4096));
+    EXPECT_EQ(64u, buffer.getUniformAlignment());
+    EXPECT_EQ(256u, buffer.getStorageAlignment());
+    EXPECT_EQ(1u, recorder.getCount(RGLRecorder::BUFFER_STORAGE));
+    const RGLRecorder::Call& map = recorder.getCalls().back();
+    EXPECT_EQ(RGLRecorder::MAP_BUFFER_RANGE, map.type);
+    EXPECT_EQ(4096u, map.args[2]);
+    EXPECT_EQ((GLuint)(GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT), map.args[3]);
+
+    // With one frame in flight the second frame waits for the fence of the first.
+    RRingBuffer ring(buffer.getMemory(), buffer.getSize(), &buffer, 1);
+    ring.beginFrame();
+    RRingBuffer::Allocation a = ring.allocate(100, buffer.getUniformAlignment());
+    ASSERT_NE(nullptr, a.data);
+    memset(a.data, 7, a.size);
+    ring.endFrame();
+    EXPECT_EQ(1u, recorder.getCount(RGLRecorder::FENCE_SYNC));
+    ring.beginFrame();
+    EXPECT_EQ(1u, ring.getStatistics().waits);
+    EXPECT_EQ(2u, recorder.getCount(RGLRecorder::CLIENT_WAIT_SYNC));
+    EXPECT_EQ(1u, recorder.getCount(RGLRecorder::DELETE_SYNC));
+    const RGLRecorder::Call& wait = recorder.getCalls()[recorder.getCalls().size() - 2];
+    EXPECT_EQ(RGLRecorder::CLIENT_WAIT_SYNC, wait.type);
+    EXPECT_EQ((GLuint)GL_SYNC_FLUSH_COMMANDS_BIT, wait.args[1]);
+    RRingBuffer::Allocation b = ring.allocate(100, buffer.getUniformAlignment());
+    EXPECT_EQ(128u, b.offset);
+    ring.endFrame();
+
+    buffer.destroy();
+    EXPECT_EQ(1u, recorder.getCount(RGLRecorder::UNMAP_BUFFER));
+    EXPECT_EQ(1u, recorder.getCount(RGLRecorder::DELETE_BUFFER));
+    EXPECT_EQ(0u, buffer.getBuffer());
+}
+
+}
@@ -0,0 +1,469 @@
+#include "RTest.h"
+#include "math/RCurve.h"
+#include "math/RPacking.h"
+#include "math/RSimd.h"
+#include "math/RTransformArray.h"
+#include "math/RVectorArray.h"
+
+namespace rocket
+{
+
+/**
+ * Fills values with random floats and the special values (NaN, infinities,
+ * denormals, signed zeros, integers and halves) lane kernels must agree on.
+ */
+static void fillSpecialFloats(RRandom& random, std::vector<float>* values)
+{
+    static const float specials[] =
+    {
+        0.0f, -0.0f, 1.0f, -1.0f, 0.5f, -0.5f, 1.5f, -2.5f, 1e-40f, -1e-40f, 1e30f, -1e30f,
+        INFINITY, -INFINITY, NAN, 8388608.5f, -8388609.0f
+    };
+    for (size_t i = 0; i < values->size(); i++)
+    {
+        if (i < sizeof(specials) / sizeof(specials[0]))
+            (*values)[i] = specials[i];
+        else
+            (*values)[i] = fuzzFloat(random, 1000.0f);
+    }
+}
+
+template <typename F, typename I>
+static void runLaneKernel(const float* a, const float* b, float* dst)
+{
+    F va = F::load(a), vb = F::load(b);
+    (va + vb).store(dst);
+    (va - vb).store(dst + 4);
+    (va * vb).store(dst + 8);
+    (va / vb).store(dst + 12);
+    simdMin(va, vb).store(dst + 16);
+    simdMax(va, vb).store(dst + 20);
+    simdSqrt(simdAbs(va)).store(dst + 24);
+    simdSelect(va < vb, va, vb).store(dst + 28);
+    F clamped = simdMax(simdMin(va, F(1e6f)), F(-1e6f));
+    simdConvert(simdFloorToInt<F, I>(clamped)).store(dst + 32);
+}
+
+TEST(RSimd, LanesMatchScalarBitForBit)
+{
+#ifdef ROCKET_SIMD_SSE2
+    RRandom random(20);
+    std::vector<float> a(4096), b(4096);
+    fillSpecialFloats(random, &a);
+    fillSpecialFloats(random, &b);
+    std::reverse(b.begin(), b.end());
+
+    for (size_t i = 0; i < a.size(); i += 4)
+    {
+        float wide[36], narrow[36];
+        runLaneKernel<RSimd4f, RSimd4i>(&a[i], &b[i], wide);
+        for (int lane = 0; lane < 4; lane++)
+        {
+            float single[36];
+            runLaneKernel<RSimd1f, RSimd1i>(&a[i + lane], &b[i + lane], single);
+            for (int op = 0; op < 9; op++)
+                narrow[op * 4 + lane] = single[op * 4];
+        }
+        for (int k = 0; k < 36; k++)
+            ASSERT_EQ(simdBits(narrow[k]), simdBits(wide[k])) << "op " << k / 4 << " a " << a[i + k % 4] << " b " << b[i + k % 4];
+    }
+#endif
+}
+
+TEST(RPacking, BulkHalfMatchesSingle)
+{
+    RRandom random(21);
+    std::vector<float> values(4099);
+    fillSpecialFloats(random, &values);
+    std::vector<uint16_t> packed(values.size());
+    RPacking::packHalf(values.data(), values.size(), packed.data());
+    std::vector<float> unpacked(values.size());
+    RPacking::unpackHalf(packed.data(), packed.size(), unpacked.data());
+    for (size_t i = 0; i < values.size(); i++)
+    {
+        ASSERT_EQ(RPacking::toHalf(values[i]), packed[i]) << values[i];
+        float single = RPacking::fromHalf(packed[i]);
+        ASSERT_EQ(simdBits(single), simdBits(unpacked[i]));
+    }
+}
+
+TEST(RPacking, Snorm16ErrorIsBounded)
+{
+    RRandom random(22);
+    std::vector<float> values(10000);
+    random.fillFloat(values.data(), values.size(), -1.0f, 1.0f);
+    std::vector<int16_t> packed(values.size());
+    std::vector<float> unpacked(values.size());
+    RPacking::packSnorm16(values.data(), values.size(), packed.data());
+    RPacking::unpackSnorm16(packed.data(), packed.size(), unpacked.data());
+    RErrorStats stats("RPacking snorm16");
+    for (size_t i = 0; i < values.size(); i++)
+        stats.add(fabs(values[i] - unpacked[i]));
+    EXPECT_LE(stats.getMax(), 0.5 / 32767.0 + 1e-7);
+}
+
+/**
+ * Packs and unpacks scalars in [min, max] and checks the error against half a quantization step.
+ */
+template <typename T>
+static void checkScalarRoundTrip(const char* name, void (*pack)(const float*, size_t, T*),
+                                 void (*unpack)(const T*, size_t, float*), float min, float max, double step)
+{
+    RRandom random(24);
+    std::vector<float> values(10000);
+    random.fillFloat(values.data(), values.size(), min, max);
+    values[0] = min;
+    values[1] = max;
+    values[2] = 0.0f;
+    std::vector<T> packed(values.size());
+    std::vector<float> unpacked(values.size());
+    pack(values.data(), values.size(), packed.data());
+    unpack(packed.data(), packed.size(), unpacked.data());
+    RErrorStats stats(name);
+    for (size_t i = 0; i < values.size(); i++)
+        stats.add(fabs((double)values[i] - (double)unpacked[i]));
+    EXPECT_EQ(0u, stats.getNonFiniteCount());
+    EXPECT_LE(stats.getMax(), 0.5 * step + 1e-7) << name;
+}
+
+TEST(RPacking, NormalizedErrorIsBounded)
+{
+    checkScalarRoundTrip<int8_t>("RPacking snorm8", RPacking::packSnorm8, RPacking::unpackSnorm8, -1.0f, 1.0f, 1.0 / 127.0);
+    checkScalarRoundTrip<uint8_t>("RPacking unorm8", RPacking::packUnorm8, RPacking::unpackUnorm8, 0.0f, 1.0f, 1.0 / 255.0);
+    checkScalarRoundTrip<uint16_t>("RPacking unorm16", RPacking::packUnorm16, RPacking::unpackUnorm16, 0.0f, 1.0f, 1.0 / 65535.0);
+}
+
+/**
+ * Gets the angle between two vectors. atan2 stays accurate for tiny angles,
+ * where acos of the dot product is swamped by the rounding of the lengths.
+ */
+static double getAngle(const RVector3& a, const RVector3& b)
+{
+    double cx = (double)a.y * b.z - (double)a.z * b.y;
+    double cy = (double)a.z * b.x - (double)a.x * b.z;
+    double cz = (double)a.x * b.y - (double)a.y * b.x;
+    double dot = (double)a.x * b.x + (double)a.y * b.y + (double)a.z * b.z;
+    return atan2(sqrt(cx * cx + cy * cy + cz * cz), dot);
+}
+
+TEST(RPacking, OctahedralErrorIsBounded)
+{
+    RRandom random(25);
+    std::vector<RVector3> normals(10000);
+    for (size_t i = 0; i < normals.size(); i++)
+    {
+        double x, y, z, length;
+        do
+        {
+            x = random.nextFloat(-1.0f, 1.0f);
+            y = random.nextFloat(-1.0f, 1.0f);
+            z = random.nextFloat(-1.0f, 1.0f);
+            length = sqrt(x * x + y * y + z * z);
+        }
+        while (length < 0.01 || length > 1.0);
+        normals[i].set((float)(x / length), (float)(y / length), (float)(z / length));
+    }
+    // The axes and octahedron edges are where the folding is most likely to go wrong.
+    normals[0].set(0.0f, 0.0f, 1.0f);
+    normals[1].set(0.0f, 0.0f, -1.0f);
+    normals[2].set(1.0f, 0.0f, 0.0f);
+    normals[3].set(0.0f, -1.0f, 0.0f);
+    normals[4].set(0.70710678f, 0.0f, -0.70710678f);
+
+    std::vector<RVector3> unpacked(normals.size());
+    std::vector<int8_t> packed8(normals.size() * 2);
+    std::vector<int16_t> packed16(normals.size() * 2);
+    RPacking::packOctahedral8(normals.data(), normals.size(), packed8.data());
+    RPacking::unpackOctahedral8(packed8.data(), normals.size(), unpacked.data());
+    RErrorStats stats8("RPacking octahedral8 (radians)");
+    for (size_t i = 0; i < normals.size(); i++)
+        stats8.add(getAngle(normals[i], unpacked[i]));
+    EXPECT_EQ(0u, stats8.getNonFiniteCount());
+    EXPECT_LE(stats8.getMax(), 0.018);
+
+    RPacking::packOctahedral16(normals.data(), normals.size(), packed16.data());
+    RPacking::unpackOctahedral16(packed16.data(), normals.size(), unpacked.data());
+    RErrorStats stats16("RPacking octahedral16 (radians)");
+    for (size_t i = 0; i < normals.size(); i++)
+        stats16.add(getAngle(normals[i], unpacked[i]));
+    EXPECT_EQ(0u, stats16.getNonFiniteCount());
+    EXPECT_LE(stats16.getMax(), 7e-5);
+}
+
+TEST(RPacking, Packed1010102ErrorIsBounded)
+{
+    RRandom random(26);
+    const size_t count = 10000;
+    std::vector<RVector4> signedValues(count), unsignedValues(count), unpacked(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        // The 2-bit signed w holds a bitangent sign, so only -1, 0 and 1 round trip.
+        signedValues[i].set(random.nextFloat(-1.0f, 1.0f), random.nextFloat(-1.0f, 1.0f), random.nextFloat(-1.0f, 1.0f),
+                            (float)random.nextUInt(3) - 1.0f);
+        unsignedValues[i].set(random.nextFloat(), random.nextFloat(), random.nextFloat(), random.nextFloat());
+    }
+    std::vector<uint32_t> packed(count);
+
+    RPacking::packSnorm1010102(signedValues.data(), count, packed.data());
+    RPacking::unpackSnorm1010102(packed.data(), count, unpacked.data());
+    RErrorStats snormStats("RPacking snorm1010102 xyz");
+    for (size_t i = 0; i < count; i++)
+    {
+        snormStats.add(fabs((double)signedValues[i].x - unpacked[i].x));
+        snormStats.add(fabs((double)signedValues[i].y - unpacked[i].y));
+        snormStats.add(fabs((double)signedValues[i].z - unpacked[i].z));
+        ASSERT_EQ(signedValues[i].w, unpacked[i].w);
+    }
+    EXPECT_LE(snormStats.getMax(), 0.5 / 511.0 + 1e-7);
+
+    RPacking::packUnorm1010102(unsignedValues.data(), count, packed.data());
+    RPacking::unpackUnorm1010102(packed.data(), count, unpacked.data());
+    RErrorStats unormStats("RPacking unorm1010102 xyz");
+    RErrorStats unormWStats("RPacking unorm1010102 w");
+    for (size_t i = 0; i < count; i++)
+    {
+        unormStats.add(fabs((double)unsignedValues[i].x - unpacked[i].x));
+        unormStats.add(fabs((double)unsignedValues[i].y - unpacked[i].y));
+        unormStats.add(fabs((double)unsignedValues[i].z - unpacked[i].z));
+        unormWStats.add(fabs((double)unsignedValues[i].w - unpacked[i].w));
+    }
+    EXPECT_LE(unormStats.getMax(), 0.5 / 1023.0 + 1e-7);
+    EXPECT_LE(unormWStats.getMax(), 0.5 / 3.0 + 1e-7);
+}
+
+/**
+ * Gets the angle of the rotation between two unit quaternions, which is 0 for q and -q.
+ */
+static double getRotationAngle(const RQuaternion& a, const RQuaternion& b)
+{
+    // The vector part of conj(b) * a, the rotation from b to a.
+    double x = (double)b.w * a.x - (double)a.w * b.x - ((double)b.y * a.z - (double)b.z * a.y);
+    double y = (double)b.w * a.y - (double)a.w * b.y - ((double)b.z * a.x - (double)b.x * a.z);
+    double z = (double)b.w * a.z - (double)a.w * b.z - ((double)b.x * a.y - (double)b.y * a.x);
+    double w = (double)a.x * b.x + (double)a.y * b.y + (double)a.z * b.z + (double)a.w * b.w;
+    return 2.0 * atan2(sqrt(x * x + y * y + z * z), fabs(w));
+}
+
+TEST(RPacking, SmallestThreeErrorIsBounded)
+{
+    RRandom random(27);
+    std::vector<RQuaternion> rotations(10000), unpacked(rotations.size());
+    for (size_t i = 0; i < rotations.size(); i++)
+        rotations[i] = randomRotation(random);
+    rotations[0] = RQuaternion::identity();
+    rotations[1].set(0.0f, 0.0f, 0.0f, -1.0f);
+    rotations[2].set(0.5f, 0.5f, 0.5f, 0.5f);
+
+    std::vector<uint32_t> packed32(rotations.size());
+    RPacking::packQuaternion32(rotations.data(), rotations.size(), packed32.data());
+    RPacking::unpackQuaternion32(packed32.data(), rotations.size(), unpacked.data());
+    RErrorStats stats32("RPacking quaternion32 (radians)");
+    for (size_t i = 0; i < rotations.size(); i++)
+        stats32.add(getRotationAngle(rotations[i], unpacked[i]));
+    EXPECT_EQ(0u, stats32.getNonFiniteCount());
+    EXPECT_LE(stats32.getMax(), 0.005);
+
+    std::vector<uint64_t> packed64(rotations.size());
+    RPacking::packQuaternion64(rotations.data(), rotations.size(), packed64.data());
+    RPacking::unpackQuaternion64(packed64.data(), rotations.size(), unpacked.data());
+    RErrorStats stats64("RPacking quaternion64 (radians)");
+    for (size_t i = 0; i < rotations.size(); i++)
+        stats64.add(getRotationAngle(rotations[i], unpacked[i]));
+    EXPECT_EQ(0u, stats64.getNonFiniteCount());
+    EXPECT_LE(stats64.getMax(), 5e-6);
+}
+
+TEST(RNoise, BulkMatchesSingle)
+{
+    RNoise noise;
+    noise.setSeed(7);
+    noise.setFractal(RNoise::FBM, 3);
+    RRandom random(23);
+    const size_t count = 1003;
+    std::vector<float> x(count), y(count), z(count), bulk(count);
+    random.fillFloat(x.data(), count, -100.0f, 100.0f);
+    random.fillFloat(y.data(), count, -100.0f, 100.0f);
+    random.fillFloat(z.data(), count, -100.0f, 100.0f);
+    for (int type = 0; type < 2; type++)
+    {
+        noise.setType(type == 0 ? RNoise::GRADIENT : RNoise::SIMPLEX);
+        noise.get(x.data(), y.data(), z.data(), count, bulk.data());
+        for (size_t i = 0; i < count; i++)
+        {
+            ASSERT_EQ(simdBits(noise.get(x[i], y[i], z[i])), simdBits(bulk[i]));
+            ASSERT_FALSE(hasSlowValues(&bulk[i], 1));
+            ASSERT_LE(fabs(bulk[i]), 1.5f);
+        }
+    }
+}
+
+TEST(RRandom, BulkFillMatchesSingleDraws)
+{
+    RRandom a(24), b(24);
+    std::vector<float> bulk(1024);
+    a.fillFloat(bulk.data(), bulk.size());
+    for (size_t i = 0; i < bulk.size(); i++)
+    {
+        ASSERT_EQ(simdBits(b.nextFloat()), simdBits(bulk[i]));
+        ASSERT_GE(bulk[i], 0.0f);
+        ASSERT_LT(bulk[i], 1.0f);
+    }
+}
+
+TEST(RCurve, BatchMatchesSingle)
+{
+    RRandom random(25);
+    RCurve curve(16, 3);
+    for (unsigned int i = 0; i < 16; i++)
+    {
+        float value[3] = { random.nextFloat(-1.0f, 1.0f), random.nextFloat(-1.0f, 1.0f), random.nextFloat(-1.0f, 1.0f) };
+        curve.setPoint(i, (float)i, value, RCurve::CATMULL_ROM);
+    }
+    const size_t count = 999;
+    std::vector<float> times(count), bulk(count * 3);
+    random.fillFloat(times.data(), count, -1.0f, 17.0f);
+    curve.evaluate(times.data(), count, bulk.data());
+    for (size_t i = 0; i < count; i++)
+    {
+        float single[3];
+        curve.evaluate(times[i], single);
+        for (int c = 0; c < 3; c++)
+            ASSERT_EQ(simdBits(single[c]), simdBits(bulk[i * 3 + c]));
+    }
+}
+
+TEST(RVectorArray, NormalizeMatchesAoS)
+{
+    RRandom random(26);
+    RVector3Array v;
+    std::vector<RVector3> aos;
+    for (int i = 0; i < 1000; i++)
+    {
+        RVector3 p(fuzzFloat(random, 10.0f), fuzzFloat(random, 10.0f), fuzzFloat(random, 10.0f));
+        v.push_back(p);
+        aos.push_back(p);
+    }
+    v.push_back(RVector3::zero());
+    aos.push_back(RVector3::zero());
+
+    RVector3Array normalized;
+    RVector3Array::normalize(v, &normalized);
+    RErrorStats stats("RVectorArray::normalize");
+    for (size_t i = 0; i < aos.size(); i++)
+    {
+        RVector3 expected = aos[i];
+        expected.normalize();
+        RVector3 actual = normalized.get(i);
+        ASSERT_FALSE(hasSlowValues(&actual.x, 3) && !aos[i].isZero());
+        stats.add(expected.distance(actual));
+    }
+    EXPECT_EQ(0u, stats.getNonFiniteCount());
+    EXPECT_LT(stats.getMax(), 1e-6);
+    EXPECT_EQ(RVector3::zero(), normalized.get(aos.size() - 1));
+}
+
+/**
+ * Creates a transform with a random rotation, translation and a scale that
+ * is uniform when requested.
+ */
+static RTransform randomTransform(RRandom& random, bool uniform)
+{
+    float scale = random.nextFloat(0.5f, 2.0f);
+    return RTransform(uniform ? RVector3(scale, scale, scale) : RVector3(scale, random.nextFloat(0.5f, 2.0f), random.nextFloat(0.5f, 2.0f)),
+                      randomRotation(random),
+                      RVector3(random.nextFloat(-10.0f, 10.0f), random.nextFloat(-10.0f, 10.0f), random.nextFloat(-10.0f, 10.0f)));
+}
+
+TEST(RTransformArray, ComposeMatchesAoS)
+{
+    // Not a multiple of the lane width, so the tail lanes are checked too.
+    const size_t count = 1003;
+    RRandom random(33);
+    std::vector<RTransform> parents, locals;
+    RTransformArray parentArray, localArray;
+    for (size_t i = 0; i < count; i++)
+    {
+        parents.push_back(randomTransform(random, i % 2 == 0));
+        locals.push_back(randomTransform(random, false));
+        parentArray.push_back(parents.back());
+        localArray.push_back(locals.back());
+    }
+
+    RTransformArray composed;
+    RTransformArray::compose(parentArray, localArray, &composed);
+    ASSERT_EQ(count, composed.size());
+    RErrorStats stats("RTransformArray::compose");
+    RErrorStats matrixStats("RTransformArray::compose vs RMatrix");
+    for (size_t i = 0; i < count; i++)
+    {
+        const RTransform& p = parents[i];
+        const RTransform& l = locals[i];
+        RTransform world = composed.get(i);
+
+        // The child's origin lands where the parent puts the local translation.
+        RVector3 translation;
+        p.getMatrix().transformPoint(l.getTranslation(), &translation);
+        stats.add(translation.distance(world.getTranslation()) / 40.0);
+        RQuaternion rotation = p.getRotation() * l.getRotation();
+        stats.add(fabs(rotation.x - world.getRotation().x) + fabs(rotation.y - world.getRotation().y) +
+                  fabs(rotation.z - world.getRotation().z) + fabs(rotation.w - world.getRotation().w));
+        RVector3 scale(p.getScale().x * l.getScale().x, p.getScale().y * l.getScale().y, p.getScale().z * l.getScale().z);
+        stats.add(scale.distance(world.getScale()) / 4.0);
+
+        // Without non-uniform parent scale there is no skew to drop, so the matrices multiply.
+        if (i % 2 == 0)
+        {
+            RMatrix product;
+            RMatrix::multiply(p.getMatrix(), l.getMatrix(), &product);
+            for (int k = 0; k < 16; k++)
+                matrixStats.add(fabs(product.m[k] - world.getMatrix().m[k]) / 40.0);
+        }
+    }
+    EXPECT_EQ(0u, stats.getNonFiniteCount());
+    EXPECT_LT(stats.getMax(), 1e-5);
+    EXPECT_LT(matrixStats.getMax(), 1e-5);
+
+    // Composing in place matches composing into another array.
+    RTransformArray::compose(parentArray, localArray, &parentArray);
+    for (size_t c = 0; c < RTransformArray::COMPONENTS; c++)
+        EXPECT_EQ(0, memcmp(composed.getComponent(c), parentArray.getComponent(c), count * sizeof(float)));
+}
+
+TEST(RTransformArray, MatricesAndPointsMatchAoS)
+{
+    const size_t count = 1003;
+    RRandom random(34);
+    std::vector<RTransform> transforms;
+    RTransformArray array;
+    RVector3Array points;
+    for (size_t i = 0; i < count; i++)
+    {
+        transforms.push_back(randomTransform(random, false));
+        array.push_back(transforms.back());
+        points.push_back(RVector3(random.nextFloat(-10.0f, 10.0f), random.nextFloat(-10.0f, 10.0f), random.nextFloat(-10.0f, 10.0f)));
+    }
+
+    std::vector<RMatrix> matrices(count);
+    array.getMatrices(matrices.data());
+    RVector3Array transformed;
+    array.transformPoints(points, &transformed);
+    ASSERT_EQ(count, transformed.size());
+
+    RErrorStats matrixStats("RTransformArray::getMatrices");
+    RErrorStats pointStats("RTransformArray::transformPoints");
+    for (size_t i = 0; i < count; i++)
+    {
+        const RMatrix& expected = transforms[i].getMatrix();
+        for (int k = 0; k < 16; k++)
+            matrixStats.add(fabs(expected.m[k] - matrices[i].m[k]) / (k >= 12 ? 10.0 : 2.0));
+
+        RVector3 point;
+        expected.transformPoint(points.get(i), &point);
+        pointStats.add(point.distance(transformed.get(i)) / 40.0);
+    }
+    EXPECT_EQ(0u, matrixStats.getNonFiniteCount());
+    EXPECT_LT(matrixStats.getMax(), 1e-6);
+    EXPECT_LT(pointStats.getMax(), 1e-6);
+}
+
+}
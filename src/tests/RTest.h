@@ -0,0 +1,252 @@
+#pragma once
+
+#include "common.h"
+#include "graphics/RMeshBuilder.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+
+namespace rocket
+{
+
+/**
+ * Accumulates the error of a fast path against a reference.
+ *
+ * Non-finite results are counted separately, so that a kernel returning NaN
+ * fails the test instead of poisoning the statistics.
+ */
+class RErrorStats
+{
+public:
+
+    RErrorStats(const char* name) : _name(name), _max(0.0), _sum(0.0), _count(0), _nonFinite(0) { }
+
+    ~RErrorStats()
+    {
+        printf("[ error    ] %s: max %.3g mean %.3g over %zu samples\n", _name, _max, getMean(), _count);
+    }
+
+    void add(double error)
+    {
+        if (!std::isfinite(error))
+        {
+            _nonFinite++;
+            return;
+        }
+        _max = std::max(_max, error);
+        _sum += error;
+        _count++;
+    }
+
+    double getMax() const { return _max; }
+
+    double getMean() const { return _count ? _sum / (double)_count : 0.0; }
+
+    size_t getNonFiniteCount() const { return _nonFinite; }
+
+private:
+
+    const char* _name;
+    double _max;
+    double _sum;
+    size_t _count;
+    size_t _nonFinite;
+};
+
+/**
+ * Determines if a float is denormal (subnormal).
+ */
+inline bool isDenormal(float f)
+{
+    return std::fpclassify(f) == FP_SUBNORMAL;
+}
+
+/**
+ * Determines if any of count floats is NaN, infinite or denormal, the
+ * values that send kernels down slow paths.
+ */
+inline bool hasSlowValues(const float* v, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!std::isfinite(v[i]) || isDenormal(v[i]))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * Gets a fuzzed float: mostly uniform in [-range, range], sometimes one of
+ * the edge cases (zero, signed zero, tiny and huge magnitudes) that
+ * optimized kernels tend to get wrong.
+ */
+inline float fuzzFloat(RRandom& random, float range)
+{
+    switch (random.nextUInt(16))
+    {
+    case 0:
+        return 0.0f;
+    case 1:
+        return -0.0f;
+    case 2:
+        return random.nextFloat(-1.0f, 1.0f) * 1e-6f;
+    case 3:
+        return random.nextFloat(-1.0f, 1.0f) * range * 1e3f;
+    default:
+        return random.nextFloat(-range, range);
+    }
+}
+
+/**
+ * Gets a uniformly distributed unit quaternion.
+ */
+inline RQuaternion randomRotation(RRandom& random)
+{
+    RQuaternion q;
+    do
+    {
+        q.set(random.nextFloat(-1.0f, 1.0f), random.nextFloat(-1.0f, 1.0f), random.nextFloat(-1.0f, 1.0f), random.nextFloat(-1.0f, 1.0f));
+    }
+    while (q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w < 0.01f);
+    q.normalize();
+    return q;
+}
+
+/**
+ * Builds a closed sphere without seams: a vertex at each pole, rings - 1
+ * rings of segments vertices between them, and the triangles joining them.
+ *
+ * @param builder The builder to add the vertices and triangles to.
+ * @param rings The number of bands from pole to pole, at least 2.
+ * @param segments The number of vertices around each ring, at least 3.
+ * @param fill Writes the getVertexSize() bytes of the vertex with a unit
+ *        normal at texture coordinates u, v, NULL for float3 positions on
+ *        the unit sphere.
+ */
+inline void buildSphere(RMeshBuilder* builder, unsigned int rings, unsigned int segments,
+                        void (*fill)(const RVector3& normal, float u, float v, void* vertex) = NULL)
+{
+    std::vector<uint8_t> vertex(builder->getVertexSize());
+    auto addVertex = [&](const RVector3& normal, float u, float v)
+    {
+        if (fill)
+            fill(normal, u, v, vertex.data());
+        else
+            memcpy(vertex.data(), &normal.x, 3 * sizeof(float));
+        return builder->addVertex(vertex.data());
+    };
+
+    uint32_t top = addVertex(RVector3(0.0f, 1.0f, 0.0f), 0.0f, 0.0f);
+    for (unsigned int r = 1; r < rings; r++)
+    {
+        float theta = MATH_PI * r / rings;
+        for (unsigned int s = 0; s < segments; s++)
+        {
+            float phi = 2.0f * MATH_PI * s / segments;
+            addVertex(RVector3(sin(theta) * cos(phi), cos(theta), sin(theta) * sin(phi)), (float)s / segments, (float)r / rings);
+        }
+    }
+    uint32_t bottom = addVertex(RVector3(0.0f, -1.0f, 0.0f), 0.0f, 1.0f);
+    for (unsigned int s = 0; s < segments; s++)
+    {
+        uint32_t s1 = (s + 1) % segments;
+        builder->addTriangle(top, 1 + s1, 1 + s);
+        for (unsigned int r = 1; r + 1 < rings; r++)
+        {
+            uint32_t a = 1 + (r - 1) * segments;
+            uint32_t b = a + segments;
+            builder->addTriangle(a + s, a + s1, b + s1);
+            builder->addTriangle(a + s, b + s1, b + s);
+        }
+        uint32_t last = 1 + (rings - 2) * segments;
+        builder->addTriangle(bottom, last + s, last + s1);
+    }
+}
+
+/**
+ * Double precision reference for a column-major 4x4 matrix.
+ */
+struct RMatrixd
+{
+    double m[16];
+
+    RMatrixd() { for (int i = 0; i < 16; i++) m[i] = (i % 5 == 0) ? 1.0 : 0.0; }
+
+    explicit RMatrixd(const RMatrix& f) { for (int i = 0; i < 16; i++) m[i] = f.m[i]; }
+
+    RMatrixd operator*(const RMatrixd& b) const
+    {
+        RMatrixd r;
+        for (int col = 0; col < 4; col++)
+        {
+            for (int row = 0; row < 4; row++)
+            {
+                double sum = 0.0;
+                for (int k = 0; k < 4; k++)
+                    sum += m[k * 4 + row] * b.m[col * 4 + k];
+                r.m[col * 4 + row] = sum;
+            }
+        }
+        return r;
+    }
+
+    /**
+     * Inverts with Gauss-Jordan elimination and partial pivoting.
+     *
+     * @return false if the matrix is singular.
+     */
+    bool invert(RMatrixd* dst) const
+    {
+        double a[4][8];
+        for (int row = 0; row < 4; row++)
+        {
+            for (int col = 0; col < 4; col++)
+            {
+                a[row][col] = m[col * 4 + row];
+                a[row][col + 4] = row == col ? 1.0 : 0.0;
+            }
+        }
+        for (int col = 0; col < 4; col++)
+        {
+            int pivot = col;
+            for (int row = col + 1; row < 4; row++)
+            {
+                if (fabs(a[row][col]) > fabs(a[pivot][col]))
+                    pivot = row;
+            }
+            if (a[pivot][col] == 0.0)
+                return false;
+            for (int k = 0; k < 8; k++)
+                std::swap(a[col][k], a[pivot][k]);
+            double inv = 1.0 / a[col][col];
+            for (int k = 0; k < 8; k++)
+                a[col][k] *= inv;
+            for (int row = 0; row < 4; row++)
+            {
+                if (row == col)
+                    continue;
+                double f = a[row][col];
+                for (int k = 0; k < 8; k++)
+                    a[row][k] -= f * a[col][k];
+            }
+        }
+        for (int row = 0; row < 4; row++)
+        {
+            for (int col = 0; col < 4; col++)
+                dst->m[col * 4 + row] = a[row][col + 4];
+        }
+        return true;
+    }
+
+    /**
+     * Gets the largest absolute element, the norm errors are measured relative to.
+     */
+    double getMaxAbs() const
+    {
+        double r = 0.0;
+        for (int i = 0; i < 16; i++)
+            r = std::max(r, fabs(m[i]));
+        return r;
+    }
+};
+
+}
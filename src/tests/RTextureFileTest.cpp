@@ -0,0 +1,185 @@
+#include "RTest.h"
+#include "graphics/RGLStateCache.h"
+#include "graphics/RMipGenerator.h"
+#include "graphics/RTexture2D.h"
+#include "graphics/RTexture3D.h"
+#include "graphics/RTextureFile.h"
+#include <fstream>
+
+namespace rocket
+{
+
+/**
+ * Builds the RGBA8 mip chain of an image of flat tiles, or of noise.
+ */
+static std::vector<uint8_t> buildChain(unsigned int width, unsigned int height, unsigned int depth, bool noise)
+{
+    RRandom random(21);
+    std::vector<uint8_t> image((size_t)width * height * depth * 4);
+    for (size_t i = 0; i < image.size(); i += 4)
+    {
+        size_t x = (i / 4) % width;
+        size_t y = (i / 4 / width) % height;
+        image[i] = noise ? (uint8_t)random.nextUInt(256) : (uint8_t)((x / 8) * 40);
+        image[i + 1] = noise ? (uint8_t)random.nextUInt(256) : (uint8_t)((y / 8) * 40);
+        image[i + 2] = noise ? (uint8_t)random.nextUInt(256) : 64;
+        image[i + 3] = 255;
+    }
+    std::vector<uint8_t> chain(RMipGenerator::getChainSize(width, height, depth, 0));
+    RMipGenerator().generate(image.data(), width, height, depth, 0, chain.data());
+    return chain;
+}
+
+TEST(RTextureFile, StoresSmallestMipFirst)
+{
+    std::vector<uint8_t> chain = buildChain(64, 32, 1, false);
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(RTextureFile::write(RTexture::TYPE_2D, RTexture::FORMAT_RGBA8, 64, 32, 1, 7, chain.data(), false, &data));
+
+    RTextureFile file;
+    ASSERT_TRUE(file.openMemory(data.data(), data.size()));
+    EXPECT_TRUE(file.isComplete());
+    EXPECT_TRUE(file.verify());
+    EXPECT_EQ(7u, file.getHeader()->mipCount);
+
+    size_t chainOffset = 0;
+    for (unsigned int mip = 0; mip < 7; mip++)
+    {
+        const RTextureFile::Level& level = file.getLevel(mip);
+        EXPECT_EQ(0u, level.offset % 64);
+        EXPECT_EQ((uint32_t)RTextureFile::SUPERCOMPRESSION_NONE, level.supercompression);
+        if (mip > 0)
+        {
+            EXPECT_LT(level.offset, file.getLevel(mip - 1).offset);
+        }
+
+        // Uncompressed mips are read in place.
+        EXPECT_EQ(0, memcmp(chain.data() + chainOffset, file.getMipData(mip), (size_t)level.size));
+        chainOffset += (size_t)level.uncompressedSize;
+    }
+    EXPECT_EQ(chain.size(), chainOffset);
+
+    data[data.size() - 1] ^= 1;
+    EXPECT_FALSE(file.verify());
+    data[0] ^= 1;
+    EXPECT_FALSE(file.openMemory(data.data(), data.size()));
+    EXPECT_FALSE(RTextureFile::write(RTexture::TYPE_2D, RTexture::FORMAT_RGBA8, 64, 32, 1, 8, chain.data(), false, &data));
+    EXPECT_FALSE(RTextureFile::write(RTexture::TYPE_2D, RTexture::FORMAT_RGBA8, 64, 32, 2, 1, chain.data(), false, &data));
+}
+
+TEST(RTextureFile, SupercompressesMipsThatGetSmaller)
+{
+    const unsigned int width = 128, height = 64;
+    std::vector<uint8_t> tiles = buildChain(width, height, 1, false);
+    std::vector<uint8_t> noise = buildChain(width, height, 1, true);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        const std::vector<uint8_t>& chain = pass == 0 ? tiles : noise;
+        std::vector<uint8_t> data;
+        ASSERT_TRUE(RTextureFile::write(RTexture::TYPE_2D, RTexture::FORMAT_RGBA8, width, height, 1, 8, chain.data(), true, &data));
+        RTextureFile file;
+        ASSERT_TRUE(file.openMemory(data.data(), data.size()));
+        EXPECT_TRUE(file.verify());
+
+        const RTextureFile::Level& level = file.getLevel(0);
+        if (pass == 0)
+        {
+            EXPECT_EQ((uint32_t)RTextureFile::SUPERCOMPRESSION_LZ, level.supercompression);
+            EXPECT_LT(level.size * 4, level.uncompressedSize);
+            EXPECT_LT(data.size(), chain.size());
+        }
+        else
+            EXPECT_EQ((uint32_t)RTextureFile::SUPERCOMPRESSION_NONE, level.supercompression);
+
+        size_t chainOffset = 0;
+        for (unsigned int mip = 0; mip < 8; mip++)
+        {
+            std::vector<uint8_t> staging((size_t)file.getLevel(mip).uncompressedSize);
+            ASSERT_TRUE(file.readMip(mip, staging.data(), staging.size()));
+            EXPECT_EQ(0, memcmp(chain.data() + chainOffset, staging.data(), staging.size()));
+            EXPECT_FALSE(file.readMip(mip, staging.data(), staging.size() - 1));
+            chainOffset += staging.size();
+        }
+    }
+}
+
+TEST(RTextureFile, UploadsCoarseMipsFromAPrefix)
+{
+    std::vector<uint8_t> chain = buildChain(32, 32, 1, false);
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(RTextureFile::write(RTexture::TYPE_2D, RTexture::FORMAT_RGBA8_SRGB, 32, 32, 1, 6, chain.data(), true, &data));
+
+    // A prefix holding the level table is enough to open the file.
+    RTextureFile file;
+    ASSERT_TRUE(file.openMemory(data.data(), data.size()));
+    const RTextureFile::Level& level = file.getLevel(2);
+    size_t prefix = (size_t)(level.offset + level.size);
+    ASSERT_TRUE(file.openMemory(data.data(), prefix));
+    EXPECT_FALSE(file.isComplete());
+    EXPECT_TRUE(file.isMipAvailable(2));
+    EXPECT_FALSE(file.isMipAvailable(1));
+    EXPECT_EQ(NULL, file.getMipData(1));
+
+    RGLRecorder recorder;
+    RGLStateCache cache(&recorder);
+    RTexture2D* texture = file.createTexture2D();
+    ASSERT_TRUE(texture != NULL);
+    EXPECT_EQ(NULL, file.createTexture3D());
+    ASSERT_TRUE(texture->create(&cache));
+    EXPECT_TRUE(file.upload(&cache, texture));
+    EXPECT_EQ(4u, recorder.getCount(RGLRecorder::TEX_SUB_IMAGE_2D));
+    EXPECT_EQ(2u, texture->getResidentMip());
+
+    ASSERT_TRUE(file.openMemory(data.data(), data.size()));
+    EXPECT_TRUE(file.upload(&cache, texture));
+    EXPECT_EQ(0u, texture->getResidentMip());
+    delete texture;
+
+    RTexture2D other(32, 16, RTexture::FORMAT_RGBA8_SRGB);
+    EXPECT_FALSE(file.upload(&cache, &other));
+}
+
+TEST(RTextureFile, LoadsMappedVolumes)
+{
+    const unsigned int width = 16, height = 8, depth = 4;
+    RTexture3D layout(width, height, depth, RTexture::FORMAT_BC4);
+    std::vector<uint8_t> chain(layout.getChainSize(0));
+    for (size_t i = 0; i < chain.size(); i++)
+        chain[i] = (uint8_t)(i / 64);
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(RTextureFile::write(RTexture::TYPE_3D, RTexture::FORMAT_BC4, width, height, depth, layout.getMipCount(), chain.data(), true, &data));
+
+    std::string path = ::testing::TempDir() + "rocket_texture_file_test.rtex";
+    {
+        std::ofstream stream(path, std::ios::binary);
+        stream.write((const char*)data.data(), (std::streamsize)data.size());
+    }
+    RTextureFile file;
+    ASSERT_TRUE(file.open(path.c_str()));
+    EXPECT_TRUE(file.verify());
+
+    RGLRecorder recorder;
+    RGLStateCache cache(&recorder);
+    RTexture3D* texture = file.createTexture3D();
+    ASSERT_TRUE(texture != NULL);
+    EXPECT_EQ(depth, texture->getDepth());
+    ASSERT_TRUE(texture->create(&cache));
+    EXPECT_EQ(1u, recorder.getCount(RGLRecorder::TEX_STORAGE_3D));
+    EXPECT_TRUE(file.upload(&cache, texture));
+    EXPECT_EQ(texture->getMipCount(), recorder.getCount(RGLRecorder::COMPRESSED_TEX_SUB_IMAGE_3D));
+    const RGLRecorder::Call& call = recorder.getCalls().back();
+    EXPECT_EQ(0u, call.args[0]);
+    EXPECT_EQ(depth, call.args[2]);
+    EXPECT_EQ(layout.getMipSize(0), call.args[3]);
+    delete texture;
+    file.close();
+
+    {
+        std::ofstream stream(path, std::ios::binary);
+        stream.write((const char*)data.data(), (std::streamsize)data.size() - 1);
+    }
+    EXPECT_FALSE(file.open(path.c_str()));
+    std::remove(path.c_str());
+}
+
+}
@@ -0,0 +1,375 @@
+#include "RTest.h"
+#include "graphics/RGLStateCache.h"
+#include "graphics/RGLTextureBackend.h"
+#include "graphics/RMipGenerator.h"
+#include "graphics/RTextureFile.h"
+#include "graphics/RTextureFileBackend.h"
+#include "graphics/RTextureStreamer.h"
+#include <atomic>
+
+namespace rocket
+{
+
+/**
+ * A backend that fills mips with their level and records the uploads and evictions.
+ */
+class FakeTextureBackend : public RTextureStreamer::Backend
+{
+public:
+
+    std::atomic<unsigned int> reads;
+    unsigned int failingMip = 100;
+    std::vector<std::pair<const RTexture2D*, unsigned int>> uploads;
+    std::vector<std::pair<const RTexture2D*, unsigned int>> evictions;
+    bool valid = true;
+
+    FakeTextureBackend() : reads(0) {}
+
+    bool read(const RTexture2D* texture, unsigned int mip, uint8_t* dst, size_t size)
+    {
+        reads++;
+        if (mip == failingMip || size != texture->getMipSize(mip))
+            return false;
+        memset(dst, (int)mip + 1, size);
+        return true;
+    }
+
+    void upload(RTexture2D* texture, unsigned int mip, const uint8_t* data, size_t size)
+    {
+        // Mips arrive coarse to fine with the data that was read.
+        valid &= mip + 1 == texture->getResidentMip() && size == texture->getMipSize(mip);
+        valid &= data[0] == mip + 1 && data[size - 1] == mip + 1;
+        uploads.push_back(std::make_pair(texture, mip));
+    }
+
+    void evict(RTexture2D* texture, unsigned int mip)
+    {
+        valid &= mip > texture->getResidentMip();
+        evictions.push_back(std::make_pair(texture, mip));
+    }
+};
+
+/**
+ * A GL backend that fills mips with their level.
+ */
+class FilledGLTextureBackend : public RGLTextureBackend
+{
+public:
+
+    explicit FilledGLTextureBackend(RGLStateCache* cache) : RGLTextureBackend(cache) {}
+
+    bool read(const RTexture2D*, unsigned int mip, uint8_t* dst, size_t size)
+    {
+        memset(dst, (int)mip + 1, size);
+        return true;
+    }
+};
+
+/**
+ * Gets the value of the last GL_TEXTURE_BASE_LEVEL set.
+ */
+static GLuint getLastBaseLevel(const RGLRecorder& gl)
+{
+    GLuint level = 1000;
+    for (size_t i = 0; i < gl.getCalls().size(); i++)
+    {
+        const RGLRecorder::Call& call = gl.getCalls()[i];
+        if (call.type == RGLRecorder::TEX_PARAMETER && call.args[0] == GL_TEXTURE_BASE_LEVEL)
+            level = call.args[1];
+    }
+    return level;
+}
+
+TEST(RTextureStreamer, ComputesMipsFromScreenSize)
+{
+    RTexture2D texture(1024, 512, RTexture::FORMAT_RGBA8);
+    EXPECT_EQ(11u, texture.getMipCount());
+    EXPECT_EQ(texture.getMipCount(), texture.getResidentMip());
+    EXPECT_EQ(1u, texture.getMipHeight(10));
+    EXPECT_EQ(1024u * 512u * 4u, texture.getMipSize(0));
+    EXPECT_EQ(texture.getMipSize(0) + texture.getChainSize(1), texture.getChainSize(0));
+    EXPECT_EQ(0u, texture.getChainSize(11));
+
+    EXPECT_EQ(0u, RTextureStreamer::getDesiredMip(&texture, 2048.0f));
+    EXPECT_EQ(0u, RTextureStreamer::getDesiredMip(&texture, 1024.0f));
+    EXPECT_EQ(1u, RTextureStreamer::getDesiredMip(&texture, 512.0f));
+    EXPECT_EQ(3u, RTextureStreamer::getDesiredMip(&texture, 100.0f));
+    EXPECT_EQ(10u, RTextureStreamer::getDesiredMip(&texture, 0.0f));
+    EXPECT_EQ(4u, RTextureStreamer::getTailMip(&texture));
+
+    RTexture2D small(16, 16, RTexture::FORMAT_R8, 2);
+    EXPECT_EQ(2u, small.getMipCount());
+    EXPECT_EQ(0u, RTextureStreamer::getTailMip(&small));
+}
+
+TEST(RTextureStreamer, StreamsMipsCoarseToFine)
+{
+    FakeTextureBackend backend;
+    RTextureStreamer streamer(&backend, 64 << 20, 0);
+    RTexture2D near(1024, 1024, RTexture::FORMAT_RGBA8);
+    RTexture2D far(1024, 1024, RTexture::FORMAT_RGBA8);
+    RTexture2D unused(1024, 1024, RTexture::FORMAT_RGBA8);
+    streamer.add(&near);
+    streamer.add(&far);
+    streamer.add(&unused);
+
+    // One mip per texture and frame, until each matches its screen size.
+    for (unsigned int frame = 0; frame < 16; frame++)
+    {
+        streamer.use(&near, 900.0f);
+        streamer.use(&far, 100.0f);
+        streamer.use(&far, 300.0f);
+        streamer.update();
+    }
+    EXPECT_EQ(0u, near.getResidentMip());
+    EXPECT_EQ(1u, far.getResidentMip());
+    EXPECT_EQ(4u, unused.getResidentMip());
+    EXPECT_EQ(11u + 10u + 7u, backend.uploads.size());
+    EXPECT_TRUE(backend.evictions.empty());
+    EXPECT_TRUE(backend.valid);
+
+    RTextureStreamer::Statistics statistics = streamer.getStatistics();
+    EXPECT_EQ(near.getChainSize(0) + far.getChainSize(1) + unused.getChainSize(4), statistics.residentSize);
+    EXPECT_EQ(0u, statistics.pendingSize);
+
+    // Moving away drops the mips that are no longer needed.
+    for (unsigned int frame = 0; frame < 2; frame++)
+    {
+        streamer.use(&near, 200.0f);
+        streamer.use(&far, 300.0f);
+        streamer.update();
+    }
+    EXPECT_EQ(2u, near.getResidentMip());
+    EXPECT_EQ(1u, backend.evictions.size());
+    EXPECT_EQ(28u, backend.uploads.size());
+}
+
+TEST(RTextureStreamer, EvictsLeastRecentlyUsedWithinBudget)
+{
+    FakeTextureBackend backend;
+    RTexture2D a(1024, 1024, RTexture::FORMAT_RGBA8);
+    RTexture2D b(1024, 1024, RTexture::FORMAT_RGBA8);
+    size_t budget = 6 << 20;
+    RTextureStreamer streamer(&backend, budget, 0);
+    streamer.add(&a);
+    streamer.add(&b);
+
+    for (unsigned int frame = 0; frame < 16; frame++)
+    {
+        streamer.use(&a, 1024.0f);
+        streamer.update();
+    }
+    EXPECT_EQ(0u, a.getResidentMip());
+    EXPECT_EQ(4u, b.getResidentMip());
+
+    // Only one full chain fits: the texture in view wins over the one used last.
+    for (unsigned int frame = 0; frame < 16; frame++)
+    {
+        streamer.use(&b, 1024.0f);
+        streamer.update();
+        EXPECT_LE(streamer.getStatistics().residentSize + streamer.getStatistics().pendingSize, budget);
+    }
+    EXPECT_EQ(0u, b.getResidentMip());
+    EXPECT_EQ(2u, a.getResidentMip());
+    EXPECT_EQ(2u, streamer.getTargetMip(&a));
+    EXPECT_FALSE(backend.evictions.empty());
+    EXPECT_TRUE(backend.valid);
+
+    // A smaller budget shrinks both, down to the tails at most.
+    streamer.setBudget(0);
+    streamer.use(&b, 1024.0f);
+    streamer.update();
+    EXPECT_EQ(4u, a.getResidentMip());
+    EXPECT_EQ(4u, b.getResidentMip());
+    EXPECT_EQ(a.getChainSize(4) + b.getChainSize(4), streamer.getStatistics().residentSize);
+}
+
+TEST(RTextureStreamer, StopsReadingAfterAFailure)
+{
+    FakeTextureBackend backend;
+    backend.failingMip = 2;
+    RTextureStreamer streamer(&backend, 64 << 20, 0);
+    RTexture2D texture(256, 256, RTexture::FORMAT_RGBA8);
+    streamer.add(&texture);
+    for (unsigned int frame = 0; frame < 16; frame++)
+    {
+        streamer.use(&texture, 256.0f);
+        streamer.update();
+    }
+    EXPECT_EQ(3u, texture.getResidentMip());
+    EXPECT_EQ(1u, streamer.getStatistics().failures);
+    EXPECT_EQ(7u, backend.reads.load());
+}
+
+TEST(RTextureStreamer, ReadsOnIoThreads)
+{
+    FakeTextureBackend backend;
+    RTextureStreamer streamer(&backend, 256 << 20, 3);
+    std::vector<std::unique_ptr<RTexture2D>> textures;
+    for (unsigned int i = 0; i < 32; i++)
+    {
+        textures.push_back(std::unique_ptr<RTexture2D>(new RTexture2D(512, 256, RTexture::FORMAT_RGBA16F)));
+        streamer.add(textures.back().get());
+    }
+
+    for (unsigned int frame = 0; frame < 12; frame++)
+    {
+        for (size_t i = 0; i < textures.size(); i++)
+            streamer.use(textures[i].get(), i % 2 ? 512.0f : 128.0f);
+        streamer.update();
+
+        // Removing a texture with reads in flight is safe.
+        if (frame == 3)
+        {
+            streamer.remove(textures.back().get());
+            textures.pop_back();
+        }
+        streamer.flush();
+    }
+    for (size_t i = 0; i < textures.size(); i++)
+        EXPECT_EQ(i % 2 ? 0u : 2u, textures[i]->getResidentMip());
+    EXPECT_EQ(0u, streamer.getStatistics().pendingSize);
+    EXPECT_TRUE(backend.valid);
+}
+
+TEST(RTextureStreamer, SizesGLStorageToResidentMips)
+{
+    RGLRecorder gl;
+    RGLStateCache cache(&gl);
+    FilledGLTextureBackend backend(&cache);
+    RTextureStreamer streamer(&backend, 64 << 20, 0);
+    RTexture2D texture(256, 256, RTexture::FORMAT_RGBA8);
+    streamer.add(&texture);
+
+    // Each upload grows the storage by one mip and copies the coarser ones over.
+    for (unsigned int frame = 0; frame < 16; frame++)
+    {
+        streamer.use(&texture, 256.0f);
+        streamer.update();
+    }
+    EXPECT_EQ(0u, texture.getResidentMip());
+    EXPECT_EQ(0u, texture.getStorageMip());
+    EXPECT_EQ(9u, gl.getCount(RGLRecorder::TEX_STORAGE_2D));
+    EXPECT_EQ(8u, gl.getCount(RGLRecorder::DELETE_TEXTURE));
+    EXPECT_EQ(8u * 9u / 2u, gl.getCount(RGLRecorder::COPY_IMAGE_SUB_DATA));
+    EXPECT_EQ(0u, getLastBaseLevel(gl));
+
+    // Eviction frees the fine mips.
+    gl.clear();
+    streamer.use(&texture, 64.0f);
+    streamer.update();
+    EXPECT_EQ(2u, texture.getResidentMip());
+    EXPECT_EQ(2u, texture.getStorageMip());
+    ASSERT_EQ(1u, gl.getCount(RGLRecorder::TEX_STORAGE_2D));
+    EXPECT_EQ(1u, gl.getCount(RGLRecorder::DELETE_TEXTURE));
+    EXPECT_EQ(7u, gl.getCount(RGLRecorder::COPY_IMAGE_SUB_DATA));
+    for (size_t i = 0; i < gl.getCalls().size(); i++)
+    {
+        if (gl.getCalls()[i].type == RGLRecorder::TEX_STORAGE_2D)
+        {
+            EXPECT_EQ(7u, gl.getCalls()[i].args[0]);
+            EXPECT_EQ(64u, gl.getCalls()[i].args[2]);
+        }
+    }
+    EXPECT_EQ(0u, getLastBaseLevel(gl));
+    streamer.remove(&texture);
+    texture.destroy(&cache);
+}
+
+TEST(RTextureStreamer, ClampsSamplingWithoutStorageCopies)
+{
+    RGLRecorder gl;
+    gl.setCopyImageSubData(false);
+    RGLStateCache cache(&gl);
+    FilledGLTextureBackend backend(&cache);
+    RTextureStreamer streamer(&backend, 64 << 20, 0);
+    RTexture2D texture(256, 256, RTexture::FORMAT_RGBA8);
+    streamer.add(&texture);
+
+    // The full chain is allocated once and sampling follows the uploads.
+    streamer.use(&texture, 256.0f);
+    streamer.update();
+    EXPECT_EQ(8u, texture.getResidentMip());
+    EXPECT_EQ(0u, texture.getStorageMip());
+    EXPECT_EQ(8u, getLastBaseLevel(gl));
+    for (unsigned int frame = 0; frame < 16; frame++)
+    {
+        streamer.use(&texture, 256.0f);
+        streamer.update();
+    }
+    EXPECT_EQ(0u, getLastBaseLevel(gl));
+
+    streamer.use(&texture, 64.0f);
+    streamer.update();
+    EXPECT_EQ(2u, getLastBaseLevel(gl));
+    EXPECT_EQ(1u, gl.getCount(RGLRecorder::TEX_STORAGE_2D));
+    EXPECT_EQ(0u, gl.getCount(RGLRecorder::COPY_IMAGE_SUB_DATA));
+    EXPECT_EQ(0u, gl.getCount(RGLRecorder::DELETE_TEXTURE));
+    streamer.remove(&texture);
+    texture.destroy(&cache);
+}
+
+TEST(RTextureStreamer, StreamsFromTextureFiles)
+{
+    std::vector<uint8_t> image(256 * 256 * 4);
+    for (size_t i = 0; i < image.size(); i++)
+        image[i] = (uint8_t)((i / 4 % 256 / 16 + i / 4 / 256 / 16) * 8 + i % 4);
+    std::vector<uint8_t> chain(RMipGenerator::getChainSize(256, 256, 1, 0));
+    RMipGenerator().generate(image.data(), 256, 256, 1, 0, chain.data());
+    std::vector<uint8_t> data;
+    ASSERT_TRUE(RTextureFile::write(RTexture::TYPE_2D, RTexture::FORMAT_RGBA8, 256, 256, 1, 9, chain.data(), true, &data));
+    RTextureFile file;
+    ASSERT_TRUE(file.openMemory(data.data(), data.size()));
+
+    RGLRecorder gl;
+    RGLStateCache cache(&gl);
+    RTextureFileBackend backend(&cache);
+    std::unique_ptr<RTexture2D> texture(file.createTexture2D());
+    RTexture2D other(128, 128, RTexture::FORMAT_RGBA8);
+    EXPECT_FALSE(backend.setFile(&other, &file));
+    ASSERT_TRUE(backend.setFile(texture.get(), &file));
+
+    // The mips are read from the file into the staging buffers and uploaded coarse to fine.
+    RTextureStreamer streamer(&backend, 64 << 20, 0);
+    streamer.add(texture.get());
+    for (unsigned int frame = 0; frame < 16; frame++)
+    {
+        streamer.use(texture.get(), 256.0f);
+        streamer.update();
+    }
+    EXPECT_EQ(0u, texture->getResidentMip());
+    EXPECT_EQ(0u, streamer.getStatistics().failures);
+    EXPECT_EQ(9u, gl.getCount(RGLRecorder::TEX_SUB_IMAGE_2D));
+    EXPECT_EQ(0u, getLastBaseLevel(gl));
+
+    size_t offset = 0;
+    for (unsigned int mip = 0; mip < 9; mip++)
+    {
+        std::vector<uint8_t> mipData(texture->getMipSize(mip));
+        ASSERT_TRUE(backend.read(texture.get(), mip, mipData.data(), mipData.size()));
+        EXPECT_EQ(0, memcmp(chain.data() + offset, mipData.data(), mipData.size()));
+        offset += mipData.size();
+    }
+    streamer.remove(texture.get());
+    texture->destroy(&cache);
+
+    // A file still loading stops streaming at the mips it holds.
+    RTextureFile partial;
+    const RTextureFile::Level& level = file.getLevel(2);
+    ASSERT_TRUE(partial.openMemory(data.data(), (size_t)(level.offset + level.size)));
+    ASSERT_TRUE(backend.setFile(texture.get(), &partial));
+    streamer.add(texture.get());
+    for (unsigned int frame = 0; frame < 16; frame++)
+    {
+        streamer.use(texture.get(), 256.0f);
+        streamer.update();
+    }
+    EXPECT_EQ(2u, texture->getResidentMip());
+    EXPECT_EQ(1u, streamer.getStatistics().failures);
+    streamer.remove(texture.get());
+    texture->destroy(&cache);
+    backend.setFile(texture.get(), NULL);
+    EXPECT_FALSE(backend.read(texture.get(), 8, chain.data(), texture->getMipSize(8)));
+}
+
+}
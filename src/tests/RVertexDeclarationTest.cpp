@@ -0,0 +1,165 @@
+#include "RTest.h"
+#include "graphics/RMeshBuilder.h"
+
+namespace rocket
+{
+
+/**
+ * A float vertex with every semantic.
+ */
+struct TestVertex
+{
+    float position[3];
+    float normal[3];
+    float tangent[4];
+    float color[4];
+    float texcoord[2];
+};
+
+static RVertexDeclaration getTestDeclaration()
+{
+    RVertexDeclaration declaration;
+    declaration.add(RVertexDeclaration::SEMANTIC_POSITION, RVertexDeclaration::FORMAT_FLOAT3);
+    declaration.add(RVertexDeclaration::SEMANTIC_NORMAL, RVertexDeclaration::FORMAT_FLOAT3);
+    declaration.add(RVertexDeclaration::SEMANTIC_TANGENT, RVertexDeclaration::FORMAT_FLOAT4);
+    declaration.add(RVertexDeclaration::SEMANTIC_COLOR, RVertexDeclaration::FORMAT_FLOAT4);
+    declaration.add(RVertexDeclaration::SEMANTIC_TEXCOORD0, RVertexDeclaration::FORMAT_FLOAT2);
+    return declaration;
+}
+
+/**
+ * Fills a TestVertex on a sphere of radius 10 centered at (5, 0, -2).
+ */
+static void fillSphereVertex(const RVector3& normal, float u, float v, void* dst)
+{
+    float theta = u * 2.0f * MATH_PI;
+    TestVertex vertex = {
+        { normal.x * 10.0f + 5.0f, normal.y * 10.0f, normal.z * 10.0f - 2.0f },
+        { normal.x, normal.y, normal.z },
+        { -sin(theta), 0.0f, cos(theta), normal.z < 0.0f ? -1.0f : 1.0f },
+        { u, v, 1.0f - u, 1.0f },
+        { u, v }
+    };
+    memcpy(dst, &vertex, sizeof(vertex));
+}
+
+TEST(RVertexDeclaration, AlignsElementsAndStride)
+{
+    RVertexDeclaration declaration;
+    EXPECT_EQ(0u, declaration.add(RVertexDeclaration::SEMANTIC_NORMAL, RVertexDeclaration::FORMAT_OCTAHEDRAL8));
+    EXPECT_EQ(2u, declaration.add(RVertexDeclaration::SEMANTIC_TEXCOORD0, RVertexDeclaration::FORMAT_HALF2));
+    EXPECT_EQ(8u, declaration.add(RVertexDeclaration::SEMANTIC_POSITION, RVertexDeclaration::FORMAT_FLOAT3));
+    EXPECT_EQ(20u, declaration.add(RVertexDeclaration::SEMANTIC_COLOR, RVertexDeclaration::FORMAT_UNORM8_4));
+    EXPECT_EQ(24u, declaration.getStride());
+    EXPECT_EQ(4u, declaration.getElementCount());
+    ASSERT_NE(nullptr, declaration.find(RVertexDeclaration::SEMANTIC_POSITION));
+    EXPECT_EQ(8u, declaration.find(RVertexDeclaration::SEMANTIC_POSITION)->offset);
+    EXPECT_EQ(nullptr, declaration.find(RVertexDeclaration::SEMANTIC_TANGENT));
+
+    declaration.add(RVertexDeclaration::SEMANTIC_TEXCOORD1, RVertexDeclaration::FORMAT_OCTAHEDRAL8);
+    EXPECT_EQ(28u, declaration.getStride());
+}
+
+TEST(RVertexDeclaration, PacksAndUnpacksStridedAttributes)
+{
+    RRandom random(42);
+    const size_t count = 1000;
+    std::vector<float> values(count * 4);
+    for (size_t i = 0; i < values.size(); i++)
+        values[i] = random.nextFloat(0.0f, 1.0f);
+
+    const RVertexDeclaration::Format formats[] = {
+        RVertexDeclaration::FORMAT_FLOAT4, RVertexDeclaration::FORMAT_HALF4, RVertexDeclaration::FORMAT_SNORM8_4,
+        RVertexDeclaration::FORMAT_SNORM16_4, RVertexDeclaration::FORMAT_UNORM8_4, RVertexDeclaration::FORMAT_UNORM16_4,
+        RVertexDeclaration::FORMAT_SNORM_10_10_10_2
+    };
+    const float tolerances[] = { 0.0f, 1.0f / 2048.0f, 0.5f / 127.0f, 0.5f / 32767.0f, 0.5f / 255.0f, 0.5f / 65535.0f, 0.5f / 511.0f };
+    for (size_t f = 0; f < sizeof(formats) / sizeof(formats[0]); f++)
+    {
+        // Interleave with another attribute to test the strides.
+        const size_t stride = RVertexDeclaration::getSize(formats[f]) + 4;
+        std::vector<uint8_t> encoded(count * stride, 0xcd);
+        std::vector<float> decoded(count * 4);
+        RVertexDeclaration::pack(formats[f], values.data(), 4 * sizeof(float), 4, count, encoded.data(), stride);
+        RVertexDeclaration::unpack(formats[f], encoded.data(), stride, count, decoded.data());
+        for (size_t i = 0; i < count; i++)
+        {
+            EXPECT_EQ(0xcd, encoded[i * stride + stride - 1]);
+            for (unsigned int c = 0; c < 3; c++)
+                EXPECT_NEAR(values[i * 4 + c], decoded[i * 4 + c], tolerances[f] + 1e-6f) << "format " << f;
+        }
+    }
+
+    RVector3 offset(10.0f, 0.0f, -10.0f);
+    RVector3 scale(2.0f, 4.0f, 8.0f);
+    std::vector<float> positions(count * 3);
+    for (size_t i = 0; i < positions.size(); i++)
+        positions[i] = (&offset.x)[i % 3] + random.nextFloat(-1.0f, 1.0f) * (&scale.x)[i % 3];
+    std::vector<uint8_t> encoded(count * 8);
+    std::vector<float> decoded(count * 4);
+    RVertexDeclaration::pack(RVertexDeclaration::FORMAT_SNORM16_4, positions.data(), 3 * sizeof(float), 3, count,
+                             encoded.data(), 8, &offset, &scale);
+    RVertexDeclaration::unpack(RVertexDeclaration::FORMAT_SNORM16_4, encoded.data(), 8, count, decoded.data(), &offset, &scale);
+    for (size_t i = 0; i < count; i++)
+    {
+        for (unsigned int c = 0; c < 3; c++)
+            EXPECT_NEAR(positions[i * 3 + c], decoded[i * 4 + c], 8.0f / 32767.0f);
+        EXPECT_EQ(1.0f, decoded[i * 4 + 3]);
+    }
+}
+
+TEST(RMeshBuilder, SelectsCompactFormatsWithinTolerances)
+{
+    RMeshBuilder builder(sizeof(TestVertex));
+    buildSphere(&builder, 32, 32, fillSphereVertex);
+    RVertexDeclaration source = getTestDeclaration();
+    EXPECT_EQ(sizeof(TestVertex), source.getStride());
+
+    RVertexDeclaration::Tolerances loose;
+    loose.position = 0.01f;
+    loose.direction = 0.05f;
+    loose.color = 1.0f / 255.0f;
+    RVertexDeclaration compact = builder.selectDeclaration(source, loose);
+    EXPECT_EQ(RVertexDeclaration::FORMAT_SNORM16_4, compact.find(RVertexDeclaration::SEMANTIC_POSITION)->format);
+    EXPECT_EQ(RVertexDeclaration::FORMAT_OCTAHEDRAL8, compact.find(RVertexDeclaration::SEMANTIC_NORMAL)->format);
+    EXPECT_EQ(RVertexDeclaration::FORMAT_SNORM_10_10_10_2, compact.find(RVertexDeclaration::SEMANTIC_TANGENT)->format);
+    EXPECT_EQ(RVertexDeclaration::FORMAT_UNORM8_4, compact.find(RVertexDeclaration::SEMANTIC_COLOR)->format);
+    EXPECT_EQ(RVertexDeclaration::FORMAT_UNORM16_2, compact.find(RVertexDeclaration::SEMANTIC_TEXCOORD0)->format);
+    EXPECT_EQ(24u, compact.getStride());
+
+    RVertexDeclaration::Tolerances tight;
+    tight.position = 1e-7f;
+    tight.direction = 1e-7f;
+    tight.color = 1e-7f;
+    tight.texcoord = 1e-7f;
+    RVertexDeclaration exact = builder.selectDeclaration(source, tight);
+    EXPECT_EQ(RVertexDeclaration::FORMAT_FLOAT3, exact.find(RVertexDeclaration::SEMANTIC_POSITION)->format);
+    EXPECT_EQ(RVertexDeclaration::FORMAT_FLOAT3, exact.find(RVertexDeclaration::SEMANTIC_NORMAL)->format);
+    // The uvs are multiples of 1/32, which half floats store exactly.
+    EXPECT_EQ(RVertexDeclaration::FORMAT_HALF4, exact.find(RVertexDeclaration::SEMANTIC_COLOR)->format);
+    EXPECT_EQ(RVertexDeclaration::FORMAT_HALF2, exact.find(RVertexDeclaration::SEMANTIC_TEXCOORD0)->format);
+    EXPECT_EQ(52u, exact.getStride());
+
+    // The converted vertices decode to the source within the tolerances.
+    std::vector<uint8_t> vertices;
+    builder.convert(source, &compact, &vertices);
+    ASSERT_EQ(builder.getVertexCount() * compact.getStride(), vertices.size());
+    const RVertexDeclaration::Element* position = compact.find(RVertexDeclaration::SEMANTIC_POSITION);
+    const RVertexDeclaration::Element* normal = compact.find(RVertexDeclaration::SEMANTIC_NORMAL);
+    std::vector<float> positions(builder.getVertexCount() * 4);
+    std::vector<float> normals(builder.getVertexCount() * 4);
+    RVertexDeclaration::unpack(position->format, &vertices[position->offset], compact.getStride(), builder.getVertexCount(),
+                               positions.data(), &compact.getDecodeOffset(), &compact.getDecodeScale());
+    RVertexDeclaration::unpack(normal->format, &vertices[normal->offset], compact.getStride(), builder.getVertexCount(),
+                               normals.data());
+    for (size_t v = 0; v < builder.getVertexCount(); v++)
+    {
+        const TestVertex* vertex = (const TestVertex*)(builder.getVertices() + v * sizeof(TestVertex));
+        RVector3 p(positions[v * 4], positions[v * 4 + 1], positions[v * 4 + 2]);
+        EXPECT_LE(p.distance(RVector3(vertex->position[0], vertex->position[1], vertex->position[2])), loose.position);
+        RVector3 n(normals[v * 4], normals[v * 4 + 1], normals[v * 4 + 2]);
+        EXPECT_GE(n.dot(RVector3(vertex->normal[0], vertex->normal[1], vertex->normal[2])), cos(loose.direction) - 1e-4f);
+    }
+}
+
+}
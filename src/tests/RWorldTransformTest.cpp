@@ -0,0 +1,93 @@
+#include "RTest.h"
+#include "math/RBoundingSphere.h"
+#include "math/RWorldTransform.h"
+
+namespace rocket
+{
+
+TEST(RWorldTransform, RebasesFarFromTheOrigin)
+{
+    RQuaternion rotation(RVector3(0.3f, 1.0f, -0.2f).normalize(), 0.7f);
+    RWorldTransform transform(RVector3(2.0f, 0.5f, 1.5f), rotation, RVector3d(1.0e7 + 0.125, -3.0e6 + 0.5, 5.0e8 + 0.25));
+    RVector3d camera(1.0e7, -3.0e6, 5.0e8);
+
+    // The offsets are lost in a float world position but exact once rebased.
+    EXPECT_NE(0.25f, (float)(5.0e8 + 0.25) - (float)5.0e8);
+    RMatrix relative;
+    transform.getRelativeMatrix(camera, &relative);
+    EXPECT_EQ(0.125f, relative.m[12]);
+    EXPECT_EQ(0.5f, relative.m[13]);
+    EXPECT_EQ(0.25f, relative.m[14]);
+    for (int i = 0; i < 12; i++)
+        EXPECT_EQ(transform.getRotationScale().m[i], relative.m[i]);
+
+    transform.translate(RVector3(0.5f, 0.0f, 0.0f));
+    transform.translate(RVector3d(0.0, 0.0, -1.0e8));
+    transform.getRelativeMatrix(RVector3d(1.0e7, -3.0e6, 4.0e8), &relative);
+    EXPECT_EQ(0.625f, relative.m[12]);
+    EXPECT_EQ(0.25f, relative.m[14]);
+}
+
+TEST(RWorldTransform, CancelsTheCameraRotationInTheViewMatrix)
+{
+    RWorldTransform camera(RVector3::one(), RQuaternion(RVector3(0.0f, 1.0f, 0.0f), 1.2f), RVector3d(4.0e6, 10.0, -7.0e6));
+    RMatrix view;
+    ASSERT_TRUE(camera.getRelativeViewMatrix(&view));
+
+    // An object at the camera with the camera's rotation maps to the identity.
+    RMatrix relative;
+    camera.getRelativeMatrix(camera.getTranslation(), &relative);
+    RMatrix product;
+    RMatrix::multiply(view, relative, &product);
+    for (int i = 0; i < 16; i++)
+        EXPECT_NEAR(RMatrix::identity().m[i], product.m[i], 1e-6f);
+
+    RWorldTransform singular(RVector3(0.0f, 1.0f, 1.0f), RQuaternion(), RVector3d());
+    EXPECT_FALSE(singular.getRelativeViewMatrix(&view));
+}
+
+TEST(RWorldTransform, RebasesArraysLikeSingleTransforms)
+{
+    const size_t count = 37;
+    RRandom random(11);
+    RVector3d origin(-2.5e7, 3.0e5, 1.0e9);
+    std::vector<RWorldTransform> transforms(count);
+    std::vector<RMatrix> rotationScales(count);
+    std::vector<RVector3d> translations(count);
+    std::vector<float> radii(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        RVector3 axis(random.nextFloat() - 0.5f, random.nextFloat() - 0.5f, random.nextFloat() + 0.1f);
+        translations[i].set(origin.x + (random.nextFloat() - 0.5f) * 1.0e4,
+                            origin.y + (random.nextFloat() - 0.5f) * 1.0e4,
+                            origin.z + (random.nextFloat() - 0.5f) * 1.0e4);
+        transforms[i].set(RVector3(1.0f + random.nextFloat(), 1.0f, 0.5f), RQuaternion(axis.normalize(), random.nextFloat() * 6.0f),
+                          translations[i]);
+        rotationScales[i] = transforms[i].getRotationScale();
+        radii[i] = random.nextFloat();
+    }
+
+    std::vector<RMatrix> batch(count);
+    std::vector<RMatrix> split(count);
+    RWorldTransform::rebase(origin, transforms.data(), count, batch.data());
+    RWorldTransform::rebase(origin, rotationScales.data(), translations.data(), count, split.data());
+    std::vector<RVector3> points(count);
+    std::vector<RBoundingSphere> spheres(count);
+    RVector3d::rebase(origin, translations.data(), count, points.data());
+    RVector3d::rebase(origin, translations.data(), radii.data(), count, spheres.data());
+
+    for (size_t i = 0; i < count; i++)
+    {
+        RMatrix single;
+        transforms[i].getRelativeMatrix(origin, &single);
+        EXPECT_EQ(0, memcmp(single.m, batch[i].m, sizeof(single.m)));
+        EXPECT_EQ(0, memcmp(single.m, split[i].m, sizeof(single.m)));
+        EXPECT_EQ(single.m[12], points[i].x);
+        EXPECT_EQ(single.m[13], points[i].y);
+        EXPECT_EQ(single.m[14], points[i].z);
+        EXPECT_EQ(points[i], spheres[i].center);
+        EXPECT_EQ(radii[i], spheres[i].radius);
+    }
+}
+
+}
@@ -0,0 +1,132 @@
+#include "common.h"
+#include "FileMapping.h"
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace rocket
+{
+
+RFileMapping::RFileMapping()
+    : _mapping(NULL), _size(0)
+{
+}
+
+RFileMapping::~RFileMapping()
+{
+    close();
+}
+
+bool RFileMapping::open(const char* path)
+{
+    close();
+    void* mapping = NULL;
+    size_t size = 0;
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+    {
+        HANDLE view = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (view)
+        {
+            mapping = MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0);
+            size = (size_t)fileSize.QuadPart;
+            CloseHandle(view);
+        }
+    }
+    CloseHandle(file);
+#else
+    int file = ::open(path, O_RDONLY);
+    if (file < 0)
+        return false;
+    struct stat status;
+    if (fstat(file, &status) == 0 && status.st_size > 0)
+    {
+        mapping = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (mapping == MAP_FAILED)
+            mapping = NULL;
+        size = (size_t)status.st_size;
+    }
+    ::close(file);
+#endif
+    if (!mapping)
+        return false;
+
+    _mapping = mapping;
+    _size = size;
+    return true;
+}
+
+void RFileMapping::close()
+{
+    if (_mapping)
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(_mapping);
+#else
+        munmap(_mapping, _size);
+#endif
+    }
+    _mapping = NULL;
+    _size = 0;
+}
+
+void RFileMapping::swap(RFileMapping& other)
+{
+    std::swap(_mapping, other._mapping);
+    std::swap(_size, other._size);
+}
+
+const uint8_t* RFileMapping::getData() const
+{
+    return (const uint8_t*)_mapping;
+}
+
+size_t RFileMapping::getSize() const
+{
+    return _size;
+}
+
+uint32_t RFileMapping::computeChecksum(const uint8_t* data, size_t size)
+{
+    static const struct ChecksumTable
+    {
+        uint32_t values[256];
+
+        ChecksumTable()
+        {
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t value = i;
+                for (unsigned int bit = 0; bit < 8; bit++)
+                    value = (value >> 1) ^ (value & 1 ? 0xedb88320u : 0u);
+                values[i] = value;
+            }
+        }
+    } table;
+
+    uint32_t crc = 0xffffffffu;
+    for (size_t i = 0; i < size; i++)
+        crc = table.values[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return crc ^ 0xffffffffu;
+}
+
+uint64_t RFileMapping::alignOffset(uint64_t offset, uint64_t alignment)
+{
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+bool RFileMapping::isInRange(uint64_t offset, uint64_t size, uint64_t limit)
+{
+    return offset <= limit && size <= limit - offset;
+}
+
+}
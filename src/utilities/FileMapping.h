@@ -0,0 +1,106 @@
+#pragma once
+
+#include "common.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a read-only memory mapping of a whole file, with the helpers the
+ * binary file formats share for laying out and validating their data.
+ *
+ * Files loaded through a mapping are read in place: the pages are faulted
+ * in on first touch and shared with the OS file cache, so formats align
+ * their data blocks for uploads straight from the mapping.
+ */
+class API RFileMapping
+{
+public:
+
+    /**
+     * Constructs an empty mapping.
+     */
+    RFileMapping();
+
+    /**
+     * Destructor, unmapping the file.
+     */
+    ~RFileMapping();
+
+    /**
+     * Maps a file, replacing the current mapping.
+     *
+     * @param path The path of the file.
+     *
+     * @return false if the file is missing, empty or cannot be mapped.
+     */
+    bool open(const char* path);
+
+    /**
+     * Unmaps the file.
+     */
+    void close();
+
+    /**
+     * Exchanges the mappings of two objects.
+     *
+     * @param other The other mapping.
+     */
+    void swap(RFileMapping& other);
+
+    /**
+     * Gets the mapped bytes.
+     *
+     * @return The bytes of the file, NULL if nothing is mapped.
+     */
+    const uint8_t* getData() const;
+
+    /**
+     * Gets the size of the mapping.
+     *
+     * @return The size of the file in bytes.
+     */
+    size_t getSize() const;
+
+    /**
+     * Computes the CRC-32 (IEEE 802.3) of data.
+     *
+     * @param data The data.
+     * @param size The size of the data in bytes.
+     *
+     * @return The checksum.
+     */
+    static uint32_t computeChecksum(const uint8_t* data, size_t size);
+
+    /**
+     * Rounds an offset up to a multiple of an alignment.
+     *
+     * @param offset The offset.
+     * @param alignment The alignment, not 0.
+     *
+     * @return The aligned offset.
+     */
+    static uint64_t alignOffset(uint64_t offset, uint64_t alignment);
+
+    /**
+     * Determines whether a range lies within a limit, without overflowing.
+     *
+     * @param offset The start of the range.
+     * @param size The size of the range.
+     * @param limit The end of the valid space.
+     *
+     * @return true if offset + size <= limit.
+     */
+    static bool isInRange(uint64_t offset, uint64_t size, uint64_t limit);
+
+private:
+
+    RFileMapping(const RFileMapping& copy);
+
+    RFileMapping& operator=(const RFileMapping&);
+
+    void* _mapping;
+    size_t _size;
+};
+
+}
@@ -0,0 +1,712 @@
+#include "common.h"
+#include "Noise.h"
+#include "math/RSimd.h"
+
+namespace rocket
+{
+
+// Large primes that decorrelate the lattice axes in the hash. Lattice
+// coordinates are premultiplied, so stepping to the next cell is an add.
+#define NOISE_PRIME_X           501125321
+#define NOISE_PRIME_Y           1136930381
+#define NOISE_PRIME_Z           1720413743
+#define NOISE_PRIME_W           1066037191
+
+// Seed offsets of the domain warp fields, one per warped axis.
+#define NOISE_WARP_SEED         0x2f0b3c1du
+
+// Skew and unskew factors of the simplex grids, (sqrt(n + 1) - 1) / n and (1 - 1 / sqrt(n + 1)) / n.
+#define NOISE_F2                0.36602540378f
+#define NOISE_G2                0.21132486540f
+#define NOISE_F3                0.33333333333f
+#define NOISE_G3                0.16666666667f
+#define NOISE_F4                0.30901699437f
+#define NOISE_G4                0.13819660113f
+
+// Output scale of each base function, measured so the extremes land near +-1.
+#define NOISE_GRADIENT2_SCALE   1.3230f
+#define NOISE_GRADIENT3_SCALE   1.0030f
+#define NOISE_GRADIENT4_SCALE   0.8477f
+#define NOISE_SIMPLEX2_SCALE    90.456f
+#define NOISE_SIMPLEX3_SCALE    76.883f
+#define NOISE_SIMPLEX4_SCALE    62.795f
+
+// Bulk requests smaller than this many samples are never split across threads.
+#define NOISE_PARALLEL_MIN      16384
+
+struct NoiseSettings
+{
+    uint32_t seed;
+    RNoise::Type type;
+    RNoise::Fractal fractal;
+    int octaves;
+    float frequency;
+    float lacunarity;
+    float gain;
+    float fractalBounding;
+    float warpAmplitude;
+    float warpFrequency;
+};
+
+template <typename I>
+static inline I hash(I seed, I x, I y)
+{
+    I h = (seed ^ x ^ y) * I(0x27d4eb2d);
+    return h ^ (h >> 15);
+}
+
+template <typename I>
+static inline I hash(I seed, I x, I y, I z)
+{
+    I h = (seed ^ x ^ y ^ z) * I(0x27d4eb2d);
+    return h ^ (h >> 15);
+}
+
+template <typename I>
+static inline I hash(I seed, I x, I y, I z, I w)
+{
+    I h = (seed ^ x ^ y ^ z ^ w) * I(0x27d4eb2d);
+    return h ^ (h >> 15);
+}
+
+/**
+ * Negates v where the sign bit of bits is set.
+ */
+template <typename F, typename I>
+static inline F flipSign(F v, I bits)
+{
+    return v ^ simdCastToFloat(bits & I((int32_t)0x80000000u));
+}
+
+/**
+ * Dot product with one of 8 gradients (+-1, +-0.5) and (+-0.5, +-1).
+ */
+template <typename F, typename I>
+static inline F gradient(I h, F x, F y)
+{
+    F swap = simdCastToFloat((h & I(4)) == I(0));
+    F a = simdSelect(swap, x, y);
+    F b = simdSelect(swap, y, x);
+    return flipSign(a, h << 31) + flipSign(b * F(0.5f), h << 30);
+}
+
+/**
+ * Dot product with one of the 12 cube edge gradients of improved Perlin noise (16 entries, 4 repeated).
+ */
+template <typename F, typename I>
+static inline F gradient(I h, F x, F y, F z)
+{
+    I low = h & I(15);
+    F u = simdSelect(simdCastToFloat((low & I(8)) == I(0)), x, y);
+    F v = simdSelect(simdCastToFloat((low & I(12)) == I(0)), y,
+          simdSelect(simdCastToFloat((low & I(13)) == I(12)), x, z));
+    return flipSign(u, h << 31) + flipSign(v, h << 30);
+}
+
+/**
+ * Dot product with one of the 32 tesseract edge gradients (one axis zero, the others +-1).
+ */
+template <typename F, typename I>
+static inline F gradient(I h, F x, F y, F z, F w)
+{
+    I axis = (h >> 3) & I(3);
+    F a = simdSelect(simdCastToFloat(axis == I(0)), y, x);
+    F b = simdSelect(simdCastToFloat((axis & I(2)) == I(0)), z, y);
+    F c = simdSelect(simdCastToFloat(axis == I(3)), z, w);
+    return flipSign(a, h << 31) + flipSign(b, h << 30) + flipSign(c, h << 29);
+}
+
+template <typename F>
+static inline F fade(F t)
+{
+    return t * t * t * (t * (t * F(6.0f) - F(15.0f)) + F(10.0f));
+}
+
+template <typename F>
+static inline F lerp(F a, F b, F t)
+{
+    return a + t * (b - a);
+}
+
+template <typename F, typename I>
+static F gradient2(I seed, F x, F y)
+{
+    I xi = simdFloorToInt<F, I>(x);
+    I yi = simdFloorToInt<F, I>(y);
+    F x0 = x - simdConvert(xi);
+    F y0 = y - simdConvert(yi);
+    F x1 = x0 - F(1.0f);
+    F y1 = y0 - F(1.0f);
+    F u = fade(x0);
+    F v = fade(y0);
+
+    I px0 = xi * I(NOISE_PRIME_X);
+    I py0 = yi * I(NOISE_PRIME_Y);
+    I px1 = px0 + I(NOISE_PRIME_X);
+    I py1 = py0 + I(NOISE_PRIME_Y);
+
+    F n00 = gradient(hash(seed, px0, py0), x0, y0);
+    F n10 = gradient(hash(seed, px1, py0), x1, y0);
+    F n01 = gradient(hash(seed, px0, py1), x0, y1);
+    F n11 = gradient(hash(seed, px1, py1), x1, y1);
+    return lerp(lerp(n00, n10, u), lerp(n01, n11, u), v) * F(NOISE_GRADIENT2_SCALE);
+}
+
+template <typename F, typename I>
+static F gradient3(I seed, F x, F y, F z)
+{
+    I xi = simdFloorToInt<F, I>(x);
+    I yi = simdFloorToInt<F, I>(y);
+    I zi = simdFloorToInt<F, I>(z);
+    F x0 = x - simdConvert(xi);
+    F y0 = y - simdConvert(yi);
+    F z0 = z - simdConvert(zi);
+    F x1 = x0 - F(1.0f);
+    F y1 = y0 - F(1.0f);
+    F z1 = z0 - F(1.0f);
+    F u = fade(x0);
+    F v = fade(y0);
+    F t = fade(z0);
+
+    I px0 = xi * I(NOISE_PRIME_X);
+    I py0 = yi * I(NOISE_PRIME_Y);
+    I pz0 = zi * I(NOISE_PRIME_Z);
+    I px1 = px0 + I(NOISE_PRIME_X);
+    I py1 = py0 + I(NOISE_PRIME_Y);
+    I pz1 = pz0 + I(NOISE_PRIME_Z);
+
+    F n000 = gradient(hash(seed, px0, py0, pz0), x0, y0, z0);
+    F n100 = gradient(hash(seed, px1, py0, pz0), x1, y0, z0);
+    F n010 = gradient(hash(seed, px0, py1, pz0), x0, y1, z0);
+    F n110 = gradient(hash(seed, px1, py1, pz0), x1, y1, z0);
+    F n001 = gradient(hash(seed, px0, py0, pz1), x0, y0, z1);
+    F n101 = gradient(hash(seed, px1, py0, pz1), x1, y0, z1);
+    F n011 = gradient(hash(seed, px0, py1, pz1), x0, y1, z1);
+    F n111 = gradient(hash(seed, px1, py1, pz1), x1, y1, z1);
+
+    F n0 = lerp(lerp(n000, n100, u), lerp(n010, n110, u), v);
+    F n1 = lerp(lerp(n001, n101, u), lerp(n011, n111, u), v);
+    return lerp(n0, n1, t) * F(NOISE_GRADIENT3_SCALE);
+}
+
+template <typename F, typename I>
+static F gradient4(I seed, F x, F y, F z, F w)
+{
+    I xi = simdFloorToInt<F, I>(x);
+    I yi = simdFloorToInt<F, I>(y);
+    I zi = simdFloorToInt<F, I>(z);
+    I wi = simdFloorToInt<F, I>(w);
+    F f[2][4];
+    f[0][0] = x - simdConvert(xi);
+    f[0][1] = y - simdConvert(yi);
+    f[0][2] = z - simdConvert(zi);
+    f[0][3] = w - simdConvert(wi);
+    I p[2][4];
+    p[0][0] = xi * I(NOISE_PRIME_X);
+    p[0][1] = yi * I(NOISE_PRIME_Y);
+    p[0][2] = zi * I(NOISE_PRIME_Z);
+    p[0][3] = wi * I(NOISE_PRIME_W);
+    p[1][0] = p[0][0] + I(NOISE_PRIME_X);
+    p[1][1] = p[0][1] + I(NOISE_PRIME_Y);
+    p[1][2] = p[0][2] + I(NOISE_PRIME_Z);
+    p[1][3] = p[0][3] + I(NOISE_PRIME_W);
+    for (int i = 0; i < 4; i++)
+        f[1][i] = f[0][i] - F(1.0f);
+
+    // Corner c has bit i set when it is offset along axis i.
+    F n[16];
+    for (int c = 0; c < 16; c++)
+    {
+        int a = c & 1, b = (c >> 1) & 1, d = (c >> 2) & 1, e = (c >> 3) & 1;
+        n[c] = gradient(hash(seed, p[a][0], p[b][1], p[d][2], p[e][3]), f[a][0], f[b][1], f[d][2], f[e][3]);
+    }
+
+    // Interpolate one axis at a time, halving the corner count each pass.
+    for (int axis = 0, count = 16; axis < 4; axis++)
+    {
+        F t = fade(f[0][axis]);
+        count >>= 1;
+        for (int c = 0; c < count; c++)
+            n[c] = lerp(n[c * 2], n[c * 2 + 1], t);
+    }
+    return n[0] * F(NOISE_GRADIENT4_SCALE);
+}
+
+/**
+ * Contribution of one simplex corner, (0.5 - r^2)^4 * (g . d).
+ */
+template <typename F>
+static inline F falloff(F t)
+{
+    t = simdMax(t, F(0.0f));
+    t = t * t;
+    return t * t;
+}
+
+template <typename F, typename I>
+static F simplex2(I seed, F x, F y)
+{
+    F s = (x + y) * F(NOISE_F2);
+    I i = simdFloorToInt<F, I>(x + s);
+    I j = simdFloorToInt<F, I>(y + s);
+    F t = simdConvert(i + j) * F(NOISE_G2);
+    F x0 = x - (simdConvert(i) - t);
+    F y0 = y - (simdConvert(j) - t);
+
+    // The middle corner steps along the larger of the two offsets first.
+    F xFirst = x0 > y0;
+    F x1 = x0 - (xFirst & F(1.0f)) + F(NOISE_G2);
+    F y1 = y0 - simdSelect(xFirst, F(0.0f), F(1.0f)) + F(NOISE_G2);
+    F x2 = x0 - F(1.0f - 2.0f * NOISE_G2);
+    F y2 = y0 - F(1.0f - 2.0f * NOISE_G2);
+
+    I pi = i * I(NOISE_PRIME_X);
+    I pj = j * I(NOISE_PRIME_Y);
+    I pi1 = pi + (simdCastToInt(xFirst) & I(NOISE_PRIME_X));
+    I pj1 = pj + simdSelect(simdCastToInt(xFirst), I(0), I(NOISE_PRIME_Y));
+
+    F n0 = falloff(F(0.5f) - x0 * x0 - y0 * y0) * gradient(hash(seed, pi, pj), x0, y0);
+    F n1 = falloff(F(0.5f) - x1 * x1 - y1 * y1) * gradient(hash(seed, pi1, pj1), x1, y1);
+    F n2 = falloff(F(0.5f) - x2 * x2 - y2 * y2) *
+           gradient(hash(seed, pi + I(NOISE_PRIME_X), pj + I(NOISE_PRIME_Y)), x2, y2);
+    return (n0 + n1 + n2) * F(NOISE_SIMPLEX2_SCALE);
+}
+
+template <typename F, typename I>
+static F simplex3(I seed, F x, F y, F z)
+{
+    F s = (x + y + z) * F(NOISE_F3);
+    I i = simdFloorToInt<F, I>(x + s);
+    I j = simdFloorToInt<F, I>(y + s);
+    I k = simdFloorToInt<F, I>(z + s);
+    F t = simdConvert(i + j + k) * F(NOISE_G3);
+    F x0 = x - (simdConvert(i) - t);
+    F y0 = y - (simdConvert(j) - t);
+    F z0 = z - (simdConvert(k) - t);
+
+    // Rank the offsets, the simplex walks from the largest to the smallest axis.
+    // Comparison masks are -1 where true, so subtracting one counts a win.
+    I xy = simdCastToInt(x0 > y0);
+    I xz = simdCastToInt(x0 > z0);
+    I yz = simdCastToInt(y0 > z0);
+    I rankX = I(0) - xy - xz;
+    I rankY = I(1) + xy - yz;
+    I rankZ = I(2) + xz + yz;
+
+    I pi = i * I(NOISE_PRIME_X);
+    I pj = j * I(NOISE_PRIME_Y);
+    I pk = k * I(NOISE_PRIME_Z);
+    F n = F(0.0f);
+    for (int corner = 0; corner < 4; corner++)
+    {
+        F ox, oy, oz;
+        I hx = pi, hy = pj, hz = pk;
+        if (corner == 0)
+        {
+            ox = oy = oz = F(0.0f);
+        }
+        else if (corner == 3)
+        {
+            ox = oy = oz = F(1.0f);
+            hx = hx + I(NOISE_PRIME_X);
+            hy = hy + I(NOISE_PRIME_Y);
+            hz = hz + I(NOISE_PRIME_Z);
+        }
+        else
+        {
+            I threshold(2 - corner);
+            I mx = rankX > threshold;
+            I my = rankY > threshold;
+            I mz = rankZ > threshold;
+            ox = simdCastToFloat(mx) & F(1.0f);
+            oy = simdCastToFloat(my) & F(1.0f);
+            oz = simdCastToFloat(mz) & F(1.0f);
+            hx = hx + (mx & I(NOISE_PRIME_X));
+            hy = hy + (my & I(NOISE_PRIME_Y));
+            hz = hz + (mz & I(NOISE_PRIME_Z));
+        }
+        F g(corner * NOISE_G3);
+        F dx = x0 - ox + g;
+        F dy = y0 - oy + g;
+        F dz = z0 - oz + g;
+        n = n + falloff(F(0.5f) - dx * dx - dy * dy - dz * dz) * gradient(hash(seed, hx, hy, hz), dx, dy, dz);
+    }
+    return n * F(NOISE_SIMPLEX3_SCALE);
+}
+
+template <typename F, typename I>
+static F simplex4(I seed, F x, F y, F z, F w)
+{
+    F s = (x + y + z + w) * F(NOISE_F4);
+    I i = simdFloorToInt<F, I>(x + s);
+    I j = simdFloorToInt<F, I>(y + s);
+    I k = simdFloorToInt<F, I>(z + s);
+    I l = simdFloorToInt<F, I>(w + s);
+    F t = simdConvert(i + j + k + l) * F(NOISE_G4);
+    F x0 = x - (simdConvert(i) - t);
+    F y0 = y - (simdConvert(j) - t);
+    F z0 = z - (simdConvert(k) - t);
+    F w0 = w - (simdConvert(l) - t);
+
+    I xy = simdCastToInt(x0 > y0);
+    I xz = simdCastToInt(x0 > z0);
+    I xw = simdCastToInt(x0 > w0);
+    I yz = simdCastToInt(y0 > z0);
+    I yw = simdCastToInt(y0 > w0);
+    I zw = simdCastToInt(z0 > w0);
+    I rankX = I(0) - xy - xz - xw;
+    I rankY = I(1) + xy - yz - yw;
+    I rankZ = I(2) + xz + yz - zw;
+    I rankW = I(3) + xw + yw + zw;
+
+    I pi = i * I(NOISE_PRIME_X);
+    I pj = j * I(NOISE_PRIME_Y);
+    I pk = k * I(NOISE_PRIME_Z);
+    I pl = l * I(NOISE_PRIME_W);
+    F n = F(0.0f);
+    for (int corner = 0; corner < 5; corner++)
+    {
+        F ox, oy, oz, ow;
+        I hx = pi, hy = pj, hz = pk, hw = pl;
+        if (corner == 0)
+        {
+            ox = oy = oz = ow = F(0.0f);
+        }
+        else if (corner == 4)
+        {
+            ox = oy = oz = ow = F(1.0f);
+            hx = hx + I(NOISE_PRIME_X);
+            hy = hy + I(NOISE_PRIME_Y);
+            hz = hz + I(NOISE_PRIME_Z);
+            hw = hw + I(NOISE_PRIME_W);
+        }
+        else
+        {
+            I threshold(3 - corner);
+            I mx = rankX > threshold;
+            I my = rankY > threshold;
+            I mz = rankZ > threshold;
+            I mw = rankW > threshold;
+            ox = simdCastToFloat(mx) & F(1.0f);
+            oy = simdCastToFloat(my) & F(1.0f);
+            oz = simdCastToFloat(mz) & F(1.0f);
+            ow = simdCastToFloat(mw) & F(1.0f);
+            hx = hx + (mx & I(NOISE_PRIME_X));
+            hy = hy + (my & I(NOISE_PRIME_Y));
+            hz = hz + (mz & I(NOISE_PRIME_Z));
+            hw = hw + (mw & I(NOISE_PRIME_W));
+        }
+        F g(corner * NOISE_G4);
+        F dx = x0 - ox + g;
+        F dy = y0 - oy + g;
+        F dz = z0 - oz + g;
+        F dw = w0 - ow + g;
+        n = n + falloff(F(0.5f) - dx * dx - dy * dy - dz * dz - dw * dw) *
+                gradient(hash(seed, hx, hy, hz, hw), dx, dy, dz, dw);
+    }
+    return n * F(NOISE_SIMPLEX4_SCALE);
+}
+
+/**
+ * Evaluates the base function in D dimensions at p.
+ */
+template <int D, typename F, typename I>
+static inline F baseNoise(RNoise::Type type, I seed, const F* p)
+{
+    if constexpr (D == 2)
+        return type == RNoise::GRADIENT ? gradient2(seed, p[0], p[1]) : simplex2(seed, p[0], p[1]);
+    else if constexpr (D == 3)
+        return type == RNoise::GRADIENT ? gradient3(seed, p[0], p[1], p[2]) : simplex3(seed, p[0], p[1], p[2]);
+    else
+        return type == RNoise::GRADIENT ? gradient4(seed, p[0], p[1], p[2], p[3]) : simplex4(seed, p[0], p[1], p[2], p[3]);
+}
+
+/**
+ * Evaluates the configured noise in D dimensions at p: domain warp, frequency, then octaves.
+ */
+template <int D, typename F, typename I>
+static F sample(const NoiseSettings& s, const F* in)
+{
+    F p[D];
+    if (s.warpAmplitude != 0.0f)
+    {
+        F q[D];
+        for (int i = 0; i < D; i++)
+            q[i] = in[i] * F(s.warpFrequency);
+        for (int i = 0; i < D; i++)
+        {
+            I seed((int32_t)(s.seed + NOISE_WARP_SEED * (uint32_t)(i + 1)));
+            p[i] = (in[i] + baseNoise<D, F, I>(s.type, seed, q) * F(s.warpAmplitude)) * F(s.frequency);
+        }
+    }
+    else
+    {
+        for (int i = 0; i < D; i++)
+            p[i] = in[i] * F(s.frequency);
+    }
+
+    if (s.fractal == RNoise::NONE)
+        return baseNoise<D, F, I>(s.type, I((int32_t)s.seed), p);
+
+    F sum(0.0f);
+    float amplitude = 1.0f;
+    for (int octave = 0; octave < s.octaves; octave++)
+    {
+        F n = baseNoise<D, F, I>(s.type, I((int32_t)(s.seed + (uint32_t)octave)), p);
+        if (s.fractal == RNoise::RIDGED)
+        {
+            n = F(1.0f) - simdAbs(n);
+            n = n * n;
+        }
+        sum = sum + n * F(amplitude);
+        amplitude *= s.gain;
+        for (int i = 0; i < D; i++)
+            p[i] = p[i] * F(s.lacunarity);
+    }
+    if (s.fractal == RNoise::RIDGED)
+        return sum * F(2.0f * s.fractalBounding) - F(1.0f);
+    return sum * F(s.fractalBounding);
+}
+
+/**
+ * Evaluates count points given as D coordinate arrays, four at a time where SSE2 is available.
+ */
+template <int D>
+static void sampleArray(const NoiseSettings& s, const float* const* coords, size_t count, float* dst)
+{
+    size_t i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    for (; i + 4 <= count; i += 4)
+    {
+        RSimd4f p[D];
+        for (int d = 0; d < D; d++)
+            p[d] = RSimd4f::load(coords[d] + i);
+        sample<D, RSimd4f, RSimd4i>(s, p).store(dst + i);
+    }
+#endif
+    for (; i < count; i++)
+    {
+        RSimd1f p[D];
+        for (int d = 0; d < D; d++)
+            p[d] = RSimd1f(coords[d][i]);
+        dst[i] = sample<D, RSimd1f, RSimd1i>(s, p).v;
+    }
+}
+
+/**
+ * Evaluates one row of a grid, sample i at (x + i * step, y, z).
+ */
+template <int D>
+static void sampleRow(const NoiseSettings& s, float x, float step, const float* rest, int width, float* dst)
+{
+    int i = 0;
+#ifdef ROCKET_SIMD_SSE2
+    const RSimd4f offsets(_mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f));
+    for (; i + 4 <= width; i += 4)
+    {
+        RSimd4f p[D];
+        p[0] = (RSimd4f((float)i) + offsets) * RSimd4f(step) + RSimd4f(x);
+        for (int d = 1; d < D; d++)
+            p[d] = RSimd4f(rest[d - 1]);
+        sample<D, RSimd4f, RSimd4i>(s, p).store(dst + i);
+    }
+#endif
+    for (; i < width; i++)
+    {
+        RSimd1f p[D];
+        p[0] = RSimd1f((float)i) * RSimd1f(step) + RSimd1f(x);
+        for (int d = 1; d < D; d++)
+            p[d] = RSimd1f(rest[d - 1]);
+        dst[i] = sample<D, RSimd1f, RSimd1i>(s, p).v;
+    }
+}
+
+RNoise::RNoise(uint32_t seed)
+    : _seed(seed), _type(SIMPLEX), _fractal(NONE), _octaves(1), _frequency(1.0f),
+      _lacunarity(2.0f), _gain(0.5f), _fractalBounding(1.0f), _warpAmplitude(0.0f), _warpFrequency(1.0f)
+{
+}
+
+RNoise::~RNoise()
+{
+}
+
+uint32_t RNoise::getSeed() const
+{
+    return _seed;
+}
+
+void RNoise::setSeed(uint32_t seed)
+{
+    _seed = seed;
+}
+
+RNoise::Type RNoise::getType() const
+{
+    return _type;
+}
+
+void RNoise::setType(Type type)
+{
+    _type = type;
+}
+
+float RNoise::getFrequency() const
+{
+    return _frequency;
+}
+
+void RNoise::setFrequency(float frequency)
+{
+    _frequency = frequency;
+}
+
+RNoise::Fractal RNoise::getFractal() const
+{
+    return _fractal;
+}
+
+void RNoise::setFractal(Fractal fractal, int octaves, float lacunarity, float gain)
+{
+    _fractal = fractal;
+    _octaves = std::max(1, octaves);
+    _lacunarity = lacunarity;
+    _gain = gain;
+    updateBounding();
+}
+
+int RNoise::getOctaves() const
+{
+    return _octaves;
+}
+
+void RNoise::setDomainWarp(float amplitude, float frequency)
+{
+    _warpAmplitude = amplitude;
+    _warpFrequency = frequency;
+}
+
+void RNoise::updateBounding()
+{
+    // Octave amplitudes sum to at most this, scale it back to 1.
+    float amplitude = 1.0f;
+    float sum = 0.0f;
+    for (int i = 0; i < _octaves; i++)
+    {
+        sum += amplitude;
+        amplitude *= _gain;
+    }
+    _fractalBounding = 1.0f / sum;
+}
+
+void RNoise::getSettings(NoiseSettings* dst) const
+{
+    dst->seed = _seed;
+    dst->type = _type;
+    dst->fractal = _fractal;
+    dst->octaves = _octaves;
+    dst->frequency = _frequency;
+    dst->lacunarity = _lacunarity;
+    dst->gain = _gain;
+    dst->fractalBounding = _fractalBounding;
+    dst->warpAmplitude = _warpAmplitude;
+    dst->warpFrequency = _warpFrequency;
+}
+
+float RNoise::get(float x, float y) const
+{
+    NoiseSettings s;
+    getSettings(&s);
+    RSimd1f p[2] = { x, y };
+    return sample<2, RSimd1f, RSimd1i>(s, p).v;
+}
+
+float RNoise::get(float x, float y, float z) const
+{
+    NoiseSettings s;
+    getSettings(&s);
+    RSimd1f p[3] = { x, y, z };
+    return sample<3, RSimd1f, RSimd1i>(s, p).v;
+}
+
+float RNoise::get(float x, float y, float z, float w) const
+{
+    NoiseSettings s;
+    getSettings(&s);
+    RSimd1f p[4] = { x, y, z, w };
+    return sample<4, RSimd1f, RSimd1i>(s, p).v;
+}
+
+void RNoise::get(const float* x, const float* y, size_t count, float* dst) const
+{
+    NoiseSettings s;
+    getSettings(&s);
+    parallelFor(count, NOISE_PARALLEL_MIN, [&](size_t begin, size_t end)
+    {
+        const float* coords[2] = { x + begin, y + begin };
+        sampleArray<2>(s, coords, end - begin, dst + begin);
+    });
+}
+
+void RNoise::get(const float* x, const float* y, const float* z, size_t count, float* dst) const
+{
+    NoiseSettings s;
+    getSettings(&s);
+    parallelFor(count, NOISE_PARALLEL_MIN, [&](size_t begin, size_t end)
+    {
+        const float* coords[3] = { x + begin, y + begin, z + begin };
+        sampleArray<3>(s, coords, end - begin, dst + begin);
+    });
+}
+
+void RNoise::get(const float* x, const float* y, const float* z, const float* w, size_t count, float* dst) const
+{
+    NoiseSettings s;
+    getSettings(&s);
+    parallelFor(count, NOISE_PARALLEL_MIN, [&](size_t begin, size_t end)
+    {
+        const float* coords[4] = { x + begin, y + begin, z + begin, w + begin };
+        sampleArray<4>(s, coords, end - begin, dst + begin);
+    });
+}
+
+void RNoise::fillGrid(float x, float y, float step, int width, int height, float* dst) const
+{
+    if (width <= 0 || height <= 0)
+        return;
+
+    NoiseSettings s;
+    getSettings(&s);
+    size_t rowsPerThread = NOISE_PARALLEL_MIN / (size_t)width + 1;
+    parallelFor((size_t)height, rowsPerThread, [&](size_t begin, size_t end)
+    {
+        for (size_t j = begin; j < end; j++)
+        {
+            float rest[1] = { (float)j * step + y };
+            sampleRow<2>(s, x, step, rest, width, dst + j * width);
+        }
+    });
+}
+
+void RNoise::fillGrid(float x, float y, float z, float step, int width, int height, int depth, float* dst) const
+{
+    if (width <= 0 || height <= 0 || depth <= 0)
+        return;
+
+    NoiseSettings s;
+    getSettings(&s);
+    size_t rows = (size_t)height * depth;
+    size_t rowsPerThread = NOISE_PARALLEL_MIN / (size_t)width + 1;
+    parallelFor(rows, rowsPerThread, [&](size_t begin, size_t end)
+    {
+        for (size_t row = begin; row < end; row++)
+        {
+            size_t j = row % height;
+            size_t k = row / height;
+            float rest[2] = { (float)j * step + y, (float)k * step + z };
+            sampleRow<3>(s, x, step, rest, width, dst + row * width);
+        }
+    });
+}
+
+}
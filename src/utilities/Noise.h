@@ -0,0 +1,258 @@
+#pragma once
+
+#include "common.h"
+#include "Parallel.h"
+
+namespace rocket
+{
+
+struct NoiseSettings;
+
+/**
+ * Defines coherent noise for procedural terrain, textures and effects.
+ *
+ * Gradient (Perlin) and simplex noise are available in 2, 3 and 4
+ * dimensions, optionally summed over octaves (fBm or ridged) and with the
+ * input domain warped by a second noise field.
+ *
+ * The bulk functions evaluate four samples per step with SSE2 and split
+ * large requests across worker threads. Each sample is computed with the
+ * same IEEE operations in the same order on every path, so a given seed and
+ * set of settings produces bit-identical results whichever path, thread
+ * count or CPU is used. Requests smaller than a few thousand samples always
+ * run on the calling thread.
+ *
+ * Single octave output is in approximately [-1, 1]. Fractal output is
+ * normalized back to the same range.
+ */
+class API RNoise : public RParallel
+{
+public:
+
+    /**
+     * The base noise function.
+     */
+    enum Type
+    {
+        GRADIENT,
+        SIMPLEX
+    };
+
+    /**
+     * How octaves are combined.
+     */
+    enum Fractal
+    {
+        NONE,
+        FBM,
+        RIDGED
+    };
+
+    /**
+     * Constructs noise with the specified seed.
+     *
+     * Defaults to single octave simplex noise at frequency 1 with no domain warp.
+     *
+     * @param seed The seed, different seeds produce unrelated fields.
+     */
+    RNoise(uint32_t seed = 1337);
+
+    /**
+     * Destructor.
+     */
+    ~RNoise();
+
+    /**
+     * Gets the seed.
+     *
+     * @return The seed.
+     */
+    uint32_t getSeed() const;
+
+    /**
+     * Sets the seed.
+     *
+     * @param seed The seed.
+     */
+    void setSeed(uint32_t seed);
+
+    /**
+     * Gets the base noise function.
+     *
+     * @return The noise type.
+     */
+    Type getType() const;
+
+    /**
+     * Sets the base noise function.
+     *
+     * @param type The noise type.
+     */
+    void setType(Type type);
+
+    /**
+     * Gets the frequency the input coordinates are scaled by.
+     *
+     * @return The frequency.
+     */
+    float getFrequency() const;
+
+    /**
+     * Sets the frequency the input coordinates are scaled by.
+     *
+     * @param frequency The frequency.
+     */
+    void setFrequency(float frequency);
+
+    /**
+     * Gets how octaves are combined.
+     *
+     * @return The fractal type.
+     */
+    Fractal getFractal() const;
+
+    /**
+     * Sets how octaves are combined and the octave parameters.
+     *
+     * @param fractal The fractal type.
+     * @param octaves The number of octaves, at least 1.
+     * @param lacunarity The frequency multiplier between octaves.
+     * @param gain The amplitude multiplier between octaves.
+     */
+    void setFractal(Fractal fractal, int octaves = 5, float lacunarity = 2.0f, float gain = 0.5f);
+
+    /**
+     * Gets the number of octaves.
+     *
+     * @return The number of octaves.
+     */
+    int getOctaves() const;
+
+    /**
+     * Sets the domain warp.
+     *
+     * Each input coordinate is offset by amplitude times a single octave of
+     * the base noise evaluated at frequency times the position. An amplitude
+     * of 0 disables warping.
+     *
+     * @param amplitude The warp distance, in input units before the frequency is applied.
+     * @param frequency The frequency of the warp field.
+     */
+    void setDomainWarp(float amplitude, float frequency = 1.0f);
+
+    /**
+     * Evaluates 2D noise at a point.
+     *
+     * @param x The x coordinate.
+     * @param y The y coordinate.
+     *
+     * @return The noise value.
+     */
+    float get(float x, float y) const;
+
+    /**
+     * Evaluates 3D noise at a point.
+     *
+     * @param x The x coordinate.
+     * @param y The y coordinate.
+     * @param z The z coordinate.
+     *
+     * @return The noise value.
+     */
+    float get(float x, float y, float z) const;
+
+    /**
+     * Evaluates 4D noise at a point.
+     *
+     * @param x The x coordinate.
+     * @param y The y coordinate.
+     * @param z The z coordinate.
+     * @param w The w coordinate.
+     *
+     * @return The noise value.
+     */
+    float get(float x, float y, float z, float w) const;
+
+    /**
+     * Evaluates 2D noise at an array of points.
+     *
+     * @param x The x coordinates.
+     * @param y The y coordinates.
+     * @param count The number of points.
+     * @param dst An array of count noise values.
+     */
+    void get(const float* x, const float* y, size_t count, float* dst) const;
+
+    /**
+     * Evaluates 3D noise at an array of points.
+     *
+     * @param x The x coordinates.
+     * @param y The y coordinates.
+     * @param z The z coordinates.
+     * @param count The number of points.
+     * @param dst An array of count noise values.
+     */
+    void get(const float* x, const float* y, const float* z, size_t count, float* dst) const;
+
+    /**
+     * Evaluates 4D noise at an array of points.
+     *
+     * @param x The x coordinates.
+     * @param y The y coordinates.
+     * @param z The z coordinates.
+     * @param w The w coordinates.
+     * @param count The number of points.
+     * @param dst An array of count noise values.
+     */
+    void get(const float* x, const float* y, const float* z, const float* w, size_t count, float* dst) const;
+
+    /**
+     * Evaluates 2D noise on a regular grid, row by row.
+     *
+     * Sample (i, j) is taken at (x + i * step, y + j * step) and written to dst[j * width + i].
+     *
+     * @param x The x coordinate of the first sample.
+     * @param y The y coordinate of the first sample.
+     * @param step The spacing between samples.
+     * @param width The number of samples along x.
+     * @param height The number of samples along y.
+     * @param dst An array of width * height noise values.
+     */
+    void fillGrid(float x, float y, float step, int width, int height, float* dst) const;
+
+    /**
+     * Evaluates 3D noise on a regular grid, slice by slice.
+     *
+     * Sample (i, j, k) is taken at (x + i * step, y + j * step, z + k * step)
+     * and written to dst[(k * height + j) * width + i].
+     *
+     * @param x The x coordinate of the first sample.
+     * @param y The y coordinate of the first sample.
+     * @param z The z coordinate of the first sample.
+     * @param step The spacing between samples.
+     * @param width The number of samples along x.
+     * @param height The number of samples along y.
+     * @param depth The number of samples along z.
+     * @param dst An array of width * height * depth noise values.
+     */
+    void fillGrid(float x, float y, float z, float step, int width, int height, int depth, float* dst) const;
+
+private:
+
+    void updateBounding();
+
+    void getSettings(NoiseSettings* dst) const;
+
+    uint32_t _seed;
+    Type _type;
+    Fractal _fractal;
+    int _octaves;
+    float _frequency;
+    float _lacunarity;
+    float _gain;
+    float _fractalBounding;
+    float _warpAmplitude;
+    float _warpFrequency;
+};
+
+}
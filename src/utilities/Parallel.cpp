@@ -0,0 +1,145 @@
+#include "common.h"
+#include "Parallel.h"
+
+#include <condition_variable>
+#include <deque>
+
+namespace rocket
+{
+
+/**
+ * The worker threads shared by every loop, grown to the largest thread
+ * count asked for.
+ */
+class ParallelPool
+{
+public:
+
+    static ParallelPool& get()
+    {
+        static ParallelPool pool;
+        return pool;
+    }
+
+    ~ParallelPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _changed.notify_all();
+        for (size_t i = 0; i < _workers.size(); i++)
+            _workers[i].join();
+    }
+
+    void run(size_t count, size_t threads, const std::function<void(size_t, size_t)>& fn)
+    {
+        size_t chunk = count / threads;
+        size_t remaining = threads - 1;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            while (_workers.size() < threads - 1)
+                _workers.emplace_back(&ParallelPool::work, this);
+            for (size_t t = 1; t < threads; t++)
+            {
+                size_t begin = t * chunk;
+                Task task = { &fn, begin, (t + 1 == threads) ? count : begin + chunk, &remaining };
+                _tasks.push_back(task);
+            }
+        }
+        _changed.notify_all();
+        fn(0, chunk);
+
+        // Help with queued ranges, ours or another loop's, rather than sleep on them.
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (remaining > 0)
+        {
+            if (_tasks.empty())
+                _changed.wait(lock);
+            else
+                runTask(lock);
+        }
+    }
+
+private:
+
+    struct Task
+    {
+        const std::function<void(size_t, size_t)>* fn;
+        size_t begin;
+        size_t end;
+        size_t* remaining;
+    };
+
+    ParallelPool()
+        : _stopping(false)
+    {
+    }
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true)
+        {
+            _changed.wait(lock, [this]() { return _stopping || !_tasks.empty(); });
+            if (_tasks.empty())
+                return;
+            runTask(lock);
+        }
+    }
+
+    void runTask(std::unique_lock<std::mutex>& lock)
+    {
+        Task task = _tasks.front();
+        _tasks.pop_front();
+        lock.unlock();
+        (*task.fn)(task.begin, task.end);
+        lock.lock();
+        if (--*task.remaining == 0)
+            _changed.notify_all();
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _changed;
+    std::deque<Task> _tasks;
+    std::vector<std::thread> _workers;
+    bool _stopping;
+};
+
+RParallel::RParallel()
+    : _threadCount(std::max(1u, std::thread::hardware_concurrency()))
+{
+}
+
+RParallel::~RParallel()
+{
+}
+
+unsigned int RParallel::getThreadCount() const
+{
+    return _threadCount;
+}
+
+void RParallel::setThreadCount(unsigned int count)
+{
+    _threadCount = std::max(1u, count);
+}
+
+void RParallel::parallelFor(size_t count, size_t minPerThread, unsigned int threadCount,
+                            const std::function<void(size_t, size_t)>& fn)
+{
+    size_t threads = std::min<size_t>(threadCount, count / std::max<size_t>(minPerThread, 1));
+    if (threads <= 1)
+    {
+        fn(0, count);
+        return;
+    }
+    ParallelPool::get().run(count, threads, fn);
+}
+
+void RParallel::parallelFor(size_t count, size_t minPerThread, const std::function<void(size_t, size_t)>& fn) const
+{
+    parallelFor(count, minPerThread, _threadCount, fn);
+}
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "common.h"
+
+namespace rocket
+{
+
+/**
+ * Defines the thread count of a data parallel algorithm and splits its
+ * loops across a pool of worker threads shared by the whole process.
+ *
+ * Classes that process large arrays derive from it for their thread count.
+ * The workers are started on first use and kept, so a loop costs a wake-up
+ * rather than starting threads. A thread waiting for its loop runs queued
+ * ranges itself, so loops may nest and may be started from several threads
+ * at once.
+ *
+ * Workers keep their own floating point mode, bodies that need flushing of
+ * denormals set it themselves (see RMath::setDenormalsAreZero()).
+ */
+class API RParallel
+{
+public:
+
+    /**
+     * Constructs with one thread per hardware thread.
+     */
+    RParallel();
+
+    /**
+     * Destructor.
+     */
+    ~RParallel();
+
+    /**
+     * Gets the number of threads the loops may use.
+     *
+     * @return The thread count.
+     */
+    unsigned int getThreadCount() const;
+
+    /**
+     * Sets the number of threads the loops may use, including the calling thread.
+     * Defaults to std::thread::hardware_concurrency().
+     *
+     * @param count The thread count, 0 or 1 to run on the calling thread only.
+     */
+    void setThreadCount(unsigned int count);
+
+    /**
+     * Runs fn(begin, end) over [0, count), split into contiguous ranges across
+     * up to threadCount threads, and returns once every range has run.
+     *
+     * The calling thread takes the first range. Ranges are at least
+     * minPerThread long, so small loops run on the calling thread alone.
+     *
+     * @param count The number of items.
+     * @param minPerThread The fewest items worth a thread.
+     * @param threadCount The most threads to use, including the calling thread.
+     * @param fn The body, called once per range.
+     */
+    static void parallelFor(size_t count, size_t minPerThread, unsigned int threadCount,
+                            const std::function<void(size_t, size_t)>& fn);
+
+protected:
+
+    /**
+     * Runs fn(begin, end) over [0, count) on up to getThreadCount() threads.
+     *
+     * @param count The number of items.
+     * @param minPerThread The fewest items worth a thread.
+     * @param fn The body, called once per range.
+     */
+    void parallelFor(size_t count, size_t minPerThread, const std::function<void(size_t, size_t)>& fn) const;
+
+private:
+
+    unsigned int _threadCount;
+};
+
+}
@@ -0,0 +1,427 @@
+#include "common.h"
+#include "Random.h"
+#include "math/RSimd.h"
+
+#include <atomic>
+
+namespace rocket
+{
+
+// xoshiro128 jump polynomial, equivalent to 2^64 calls to nextBits().
+static const uint32_t RANDOM_JUMP[4] = { 0x8764000b, 0xf542d2d3, 0x6fa035c3, 0x77f2db5b };
+
+#define RANDOM_FLOAT_SCALE  (1.0f / 16777216.0f)
+
+static inline uint64_t splitMix64(uint64_t* x)
+{
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+template <typename I>
+static inline I rotl(I x, int k)
+{
+    return (x << k) | (x >> (32 - k));
+}
+
+/**
+ * Advances one xoshiro128** step, s holds the four state words.
+ */
+template <typename I>
+static inline I nextBits(I* s)
+{
+    // s1 * 5 and * 9 as shift-adds, SSE2 has no 32-bit low multiply.
+    I result = s[1] + (s[1] << 2);
+    result = rotl(result, 7);
+    result = result + (result << 3);
+
+    I t = s[1] << 9;
+    s[2] = s[2] ^ s[0];
+    s[3] = s[3] ^ s[1];
+    s[1] = s[1] ^ s[2];
+    s[0] = s[0] ^ s[3];
+    s[2] = s[2] ^ t;
+    s[3] = rotl(s[3], 11);
+    return result;
+}
+
+/**
+ * Maps 32 random bits to a float in [0, 1) using the top 24 bits.
+ */
+template <typename F, typename I>
+static inline F toUnitFloat(I bits)
+{
+    return simdConvert(bits >> 8) * F(RANDOM_FLOAT_SCALE);
+}
+
+/**
+ * Computes the cosine and sine of a uniformly distributed angle from a
+ * value in [0, 1). The angle is t * 2pi rotated by -pi/4, which is still
+ * uniform. Polynomial error is below 4e-7.
+ */
+template <typename F, typename I>
+static inline void sinCosTurns(F t, F* s, F* c)
+{
+    // Pick the quadrant, then evaluate on [-pi/4, pi/4).
+    F t4 = t * F(4.0f);
+    I quadrant = simdTruncate(t4);
+    F a = (t4 - simdConvert(quadrant) - F(0.5f)) * F(MATH_PIOVER2);
+    F a2 = a * a;
+    F sa = a * (F(1.0f) + a2 * (F(-1.0f / 6.0f) + a2 * (F(1.0f / 120.0f) + a2 * F(-1.0f / 5040.0f))));
+    F ca = F(1.0f) + a2 * (F(-0.5f) + a2 * (F(1.0f / 24.0f) + a2 * (F(-1.0f / 720.0f) + a2 * F(1.0f / 40320.0f))));
+
+    // Rotate (ca, sa) by the quadrant: odd quadrants swap, quadrants 1 and 2 negate cos, 2 and 3 negate sin.
+    F swap = simdCastToFloat((quadrant & I(1)) == I(1));
+    F cs = simdSelect(swap, sa, ca);
+    F ss = simdSelect(swap, ca, sa);
+    I negateCos = (quadrant + I(1)) << 30;
+    I negateSin = quadrant << 30;
+    *c = cs ^ simdCastToFloat(negateCos & I((int32_t)0x80000000u));
+    *s = ss ^ simdCastToFloat(negateSin & I((int32_t)0x80000000u));
+}
+
+template <typename F, typename I>
+static inline void unitVector(I* state, F* x, F* y, F* z)
+{
+    F u = toUnitFloat<F, I>(nextBits(state));
+    F v = toUnitFloat<F, I>(nextBits(state));
+    *z = u * F(2.0f) - F(1.0f);
+    F r = simdSqrt(simdMax(F(1.0f) - *z * *z, F(0.0f)));
+    F s, c;
+    sinCosTurns<F, I>(v, &s, &c);
+    *x = r * c;
+    *y = r * s;
+}
+
+template <typename F, typename I>
+static inline void pointInSphere(I* state, F cx, F cy, F cz, F radius, F* x, F* y, F* z)
+{
+    unitVector<F, I>(state, x, y, z);
+
+    // The largest of three uniforms has the r^3 distribution of the radius in a ball.
+    F r = toUnitFloat<F, I>(nextBits(state));
+    r = simdMax(r, toUnitFloat<F, I>(nextBits(state)));
+    r = simdMax(r, toUnitFloat<F, I>(nextBits(state)));
+    r = r * radius;
+    *x = *x * r + cx;
+    *y = *y * r + cy;
+    *z = *z * r + cz;
+}
+
+template <typename F, typename I>
+static inline void pointInBox(I* state, const float* min, const float* size, F* x, F* y, F* z)
+{
+    *x = toUnitFloat<F, I>(nextBits(state)) * F(size[0]) + F(min[0]);
+    *y = toUnitFloat<F, I>(nextBits(state)) * F(size[1]) + F(min[1]);
+    *z = toUnitFloat<F, I>(nextBits(state)) * F(size[2]) + F(min[2]);
+}
+
+/**
+ * Runs kernel(state, first, lanes) over count outputs, four per step.
+ *
+ * Output first + lane comes from lane `lane` of the generator. With SSE2 the
+ * kernel sees all four lanes at once and writes the first `lanes` outputs;
+ * otherwise it is called for one lane at a time with lanes set to 0 or 1.
+ * Every lane steps for every group either way, so both leave the same state.
+ */
+template <typename Kernel>
+static void forEachGroup(uint32_t state[4][4], size_t count, const Kernel& kernel)
+{
+#ifdef ROCKET_SIMD_SSE2
+    RSimd4i s[4];
+    for (int w = 0; w < 4; w++)
+        s[w] = RSimd4i::load((const int32_t*)state[w]);
+    for (size_t i = 0; i < count; i += 4)
+        kernel(s, i, (int)std::min<size_t>(4, count - i));
+    for (int w = 0; w < 4; w++)
+        s[w].store((int32_t*)state[w]);
+#else
+    for (int lane = 0; lane < 4; lane++)
+    {
+        RSimd1i s[4];
+        for (int w = 0; w < 4; w++)
+            s[w] = RSimd1i((int32_t)state[w][lane]);
+        for (size_t i = 0; i < count; i += 4)
+            kernel(s, i + lane, (i + lane < count) ? 1 : 0);
+        for (int w = 0; w < 4; w++)
+            state[w][lane] = (uint32_t)s[w].v;
+    }
+#endif
+}
+
+template <typename F>
+static inline void storeLanes(F v, float* dst, int lanes)
+{
+    float tmp[4];
+    v.store(tmp);
+    for (int i = 0; i < lanes; i++)
+        dst[i] = tmp[i];
+}
+
+template <typename F>
+static inline void storeLanes(F x, F y, F z, float* dst, int lanes)
+{
+    float tx[4], ty[4], tz[4];
+    x.store(tx);
+    y.store(ty);
+    z.store(tz);
+    for (int i = 0; i < lanes; i++)
+    {
+        dst[i * 3] = tx[i];
+        dst[i * 3 + 1] = ty[i];
+        dst[i * 3 + 2] = tz[i];
+    }
+}
+
+#ifdef ROCKET_SIMD_SSE2
+static inline void storeLanes(RSimd4f v, float* dst, int lanes)
+{
+    if (lanes == 4)
+        v.store(dst);
+    else
+        storeLanes<RSimd4f>(v, dst, lanes);
+}
+
+static inline void storeLanes(RSimd4f x, RSimd4f y, RSimd4f z, float* dst, int lanes)
+{
+    if (lanes == 4)
+        simdStoreTransposed3(dst, x.v, y.v, z.v);
+    else
+        storeLanes<RSimd4f>(x, y, z, dst, lanes);
+}
+#endif
+
+// The lane float type that matches an integer lane type.
+template <typename I> struct RandomLanes;
+template <> struct RandomLanes<RSimd1i> { typedef RSimd1f F; };
+#ifdef ROCKET_SIMD_SSE2
+template <> struct RandomLanes<RSimd4i> { typedef RSimd4f F; };
+#endif
+
+RRandom::RRandom(uint64_t seed, uint32_t stream)
+{
+    setSeed(seed, stream);
+}
+
+RRandom::~RRandom()
+{
+}
+
+RRandom& RRandom::getLocal()
+{
+    static std::atomic<uint32_t> nextStream(0);
+    thread_local RRandom local(0, nextStream++);
+    return local;
+}
+
+void RRandom::setSeed(uint64_t seed, uint32_t stream)
+{
+    // Expand the seed with splitmix64, as recommended for the xoshiro family.
+    uint64_t x = seed;
+    for (int lane = 0; lane < 4; lane++)
+    {
+        uint64_t a = splitMix64(&x);
+        uint64_t b = splitMix64(&x);
+        _state[0][lane] = (uint32_t)a;
+        _state[1][lane] = (uint32_t)(a >> 32);
+        _state[2][lane] = (uint32_t)b;
+        _state[3][lane] = (uint32_t)(b >> 32);
+    }
+    for (uint32_t i = 0; i < stream; i++)
+        jump();
+    _index = 4;
+}
+
+void RRandom::jump()
+{
+    for (int lane = 0; lane < 4; lane++)
+    {
+        RSimd1i s[4];
+        for (int w = 0; w < 4; w++)
+            s[w] = RSimd1i((int32_t)_state[w][lane]);
+
+        uint32_t acc[4] = { 0, 0, 0, 0 };
+        for (int i = 0; i < 4; i++)
+        {
+            for (int b = 0; b < 32; b++)
+            {
+                if (RANDOM_JUMP[i] & (1u << b))
+                {
+                    for (int w = 0; w < 4; w++)
+                        acc[w] ^= (uint32_t)s[w].v;
+                }
+                nextBits(s);
+            }
+        }
+        for (int w = 0; w < 4; w++)
+            _state[w][lane] = acc[w];
+    }
+    _index = 4;
+}
+
+void RRandom::refill()
+{
+    forEachGroup(_state, 4, [&](auto* s, size_t first, int lanes)
+    {
+        auto bits = nextBits(s);
+        int32_t tmp[4];
+        bits.store(tmp);
+        for (int i = 0; i < lanes; i++)
+            _buffer[first + i] = (uint32_t)tmp[i];
+    });
+    _index = 0;
+}
+
+uint32_t RRandom::nextUInt()
+{
+    if (_index == 4)
+        refill();
+    return _buffer[_index++];
+}
+
+uint32_t RRandom::nextUInt(uint32_t bound)
+{
+    // Lemire's multiply-shift with rejection of the biased low products.
+    uint64_t m = (uint64_t)nextUInt() * bound;
+    uint32_t low = (uint32_t)m;
+    if (low < bound)
+    {
+        uint32_t threshold = (0u - bound) % bound;
+        while (low < threshold)
+        {
+            m = (uint64_t)nextUInt() * bound;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+int RRandom::nextInt(int min, int max)
+{
+    uint32_t range = (uint32_t)max - (uint32_t)min + 1u;
+    if (range == 0)
+        return (int)nextUInt();
+    return (int)((uint32_t)min + nextUInt(range));
+}
+
+float RRandom::nextFloat()
+{
+    return toUnitFloat<RSimd1f, RSimd1i>(RSimd1i((int32_t)nextUInt())).v;
+}
+
+float RRandom::nextFloat(float min, float max)
+{
+    return nextFloat() * (max - min) + min;
+}
+
+RVector3 RRandom::nextUnitVector()
+{
+    RSimd1f u = toUnitFloat<RSimd1f, RSimd1i>(RSimd1i((int32_t)nextUInt()));
+    RSimd1f v = toUnitFloat<RSimd1f, RSimd1i>(RSimd1i((int32_t)nextUInt()));
+    RSimd1f z = u * RSimd1f(2.0f) - RSimd1f(1.0f);
+    RSimd1f r = simdSqrt(simdMax(RSimd1f(1.0f) - z * z, RSimd1f(0.0f)));
+    RSimd1f s, c;
+    sinCosTurns<RSimd1f, RSimd1i>(v, &s, &c);
+    return RVector3((r * c).v, (r * s).v, z.v);
+}
+
+RVector3 RRandom::nextPointInSphere(const RVector3& center, float radius)
+{
+    RVector3 d = nextUnitVector();
+    float r = nextFloat();
+    float r1 = nextFloat();
+    float r2 = nextFloat();
+    r = r1 > r ? r1 : r;
+    r = r2 > r ? r2 : r;
+    r *= radius;
+    return RVector3(d.x * r + center.x, d.y * r + center.y, d.z * r + center.z);
+}
+
+RVector3 RRandom::nextPointInBox(const RVector3& min, const RVector3& max)
+{
+    float x = nextFloat() * (max.x - min.x) + min.x;
+    float y = nextFloat() * (max.y - min.y) + min.y;
+    float z = nextFloat() * (max.z - min.z) + min.z;
+    return RVector3(x, y, z);
+}
+
+void RRandom::fillUInt(uint32_t* dst, size_t count)
+{
+    forEachGroup(_state, count, [&](auto* s, size_t first, int lanes)
+    {
+        auto bits = nextBits(s);
+        int32_t tmp[4];
+        bits.store(tmp);
+        for (int i = 0; i < lanes; i++)
+            dst[first + i] = (uint32_t)tmp[i];
+    });
+    _index = 4;
+}
+
+void RRandom::fillFloat(float* dst, size_t count)
+{
+    forEachGroup(_state, count, [&](auto* s, size_t first, int lanes)
+    {
+        typedef typename std::remove_pointer<decltype(s)>::type I;
+        typedef typename RandomLanes<I>::F F;
+        storeLanes(toUnitFloat<F, I>(nextBits(s)), dst + first, lanes);
+    });
+    _index = 4;
+}
+
+void RRandom::fillFloat(float* dst, size_t count, float min, float max)
+{
+    float size = max - min;
+    forEachGroup(_state, count, [&](auto* s, size_t first, int lanes)
+    {
+        typedef typename std::remove_pointer<decltype(s)>::type I;
+        typedef typename RandomLanes<I>::F F;
+        storeLanes(toUnitFloat<F, I>(nextBits(s)) * F(size) + F(min), dst + first, lanes);
+    });
+    _index = 4;
+}
+
+void RRandom::fillUnitVectors(RVector3* dst, size_t count)
+{
+    forEachGroup(_state, count, [&](auto* s, size_t first, int lanes)
+    {
+        typedef typename std::remove_pointer<decltype(s)>::type I;
+        typedef typename RandomLanes<I>::F F;
+        F x, y, z;
+        unitVector<F, I>(s, &x, &y, &z);
+        storeLanes(x, y, z, &dst->x + first * 3, lanes);
+    });
+    _index = 4;
+}
+
+void RRandom::fillPointsInSphere(RVector3* dst, size_t count, const RVector3& center, float radius)
+{
+    forEachGroup(_state, count, [&](auto* s, size_t first, int lanes)
+    {
+        typedef typename std::remove_pointer<decltype(s)>::type I;
+        typedef typename RandomLanes<I>::F F;
+        F x, y, z;
+        pointInSphere<F, I>(s, F(center.x), F(center.y), F(center.z), F(radius), &x, &y, &z);
+        storeLanes(x, y, z, &dst->x + first * 3, lanes);
+    });
+    _index = 4;
+}
+
+void RRandom::fillPointsInBox(RVector3* dst, size_t count, const RVector3& min, const RVector3& max)
+{
+    const float lo[3] = { min.x, min.y, min.z };
+    const float size[3] = { max.x - min.x, max.y - min.y, max.z - min.z };
+    forEachGroup(_state, count, [&](auto* s, size_t first, int lanes)
+    {
+        typedef typename std::remove_pointer<decltype(s)>::type I;
+        typedef typename RandomLanes<I>::F F;
+        F x, y, z;
+        pointInBox<F, I>(s, lo, size, &x, &y, &z);
+        storeLanes(x, y, z, &dst->x + first * 3, lanes);
+    });
+    _index = 4;
+}
+
+}
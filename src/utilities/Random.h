@@ -0,0 +1,202 @@
+#pragma once
+
+#include "common.h"
+
+namespace rocket
+{
+
+/**
+ * Defines a fast, seedable pseudo random number generator.
+ *
+ * The generator is xoshiro128** run as four interleaved lanes, which lets
+ * the bulk fill functions produce four values per step with SSE2. The
+ * output depends only on the seed, the stream and the sequence of calls
+ * made, never on the CPU or on whether the SIMD path is compiled in, so a
+ * recorded seed replays exactly.
+ *
+ * Independent streams for worker threads are made by constructing with
+ * the same seed and a different stream index, or by calling jump(), which
+ * advances every lane by 2^64 steps. Streams do not overlap unless more
+ * than 2^64 values are drawn from one of them.
+ *
+ * An RRandom is not thread safe, give each thread its own (see getLocal()).
+ * Copying a generator snapshots its state.
+ *
+ * Bulk fills always start on a fresh step of the lanes, so calling a fill
+ * after single draws discards up to three buffered values.
+ */
+class API RRandom
+{
+public:
+
+    /**
+     * Constructs a generator.
+     *
+     * @param seed The seed.
+     * @param stream The stream index, each index is an independent sequence for the same seed.
+     */
+    RRandom(uint64_t seed = 0, uint32_t stream = 0);
+
+    /**
+     * Destructor.
+     */
+    ~RRandom();
+
+    /**
+     * Gets the generator of the calling thread.
+     *
+     * It is seeded with 0 and the thread's creation index among the threads
+     * that called getLocal() as its stream, use setSeed() for replays.
+     *
+     * @return The thread local generator.
+     */
+    static RRandom& getLocal();
+
+    /**
+     * Reseeds the generator.
+     *
+     * @param seed The seed.
+     * @param stream The stream index.
+     */
+    void setSeed(uint64_t seed, uint32_t stream = 0);
+
+    /**
+     * Advances the generator by 2^64 steps, starting a new independent stream.
+     */
+    void jump();
+
+    /**
+     * Gets a uniformly distributed 32-bit integer.
+     *
+     * @return The next value.
+     */
+    uint32_t nextUInt();
+
+    /**
+     * Gets a uniformly distributed integer in [0, bound).
+     *
+     * @param bound The exclusive upper bound, 0 returns 0.
+     *
+     * @return The next value.
+     */
+    uint32_t nextUInt(uint32_t bound);
+
+    /**
+     * Gets a uniformly distributed integer in [min, max].
+     *
+     * @param min The inclusive lower bound.
+     * @param max The inclusive upper bound.
+     *
+     * @return The next value.
+     */
+    int nextInt(int min, int max);
+
+    /**
+     * Gets a uniformly distributed float in [0, 1), a multiple of 2^-24.
+     *
+     * @return The next value.
+     */
+    float nextFloat();
+
+    /**
+     * Gets a uniformly distributed float in [min, max].
+     *
+     * @param min The lower bound.
+     * @param max The upper bound.
+     *
+     * @return The next value.
+     */
+    float nextFloat(float min, float max);
+
+    /**
+     * Gets a uniformly distributed unit vector.
+     *
+     * @return The next unit vector.
+     */
+    RVector3 nextUnitVector();
+
+    /**
+     * Gets a uniformly distributed point inside a sphere.
+     *
+     * @param center The center of the sphere.
+     * @param radius The radius of the sphere.
+     *
+     * @return The next point.
+     */
+    RVector3 nextPointInSphere(const RVector3& center, float radius);
+
+    /**
+     * Gets a uniformly distributed point inside an axis aligned box.
+     *
+     * @param min The minimum corner of the box.
+     * @param max The maximum corner of the box.
+     *
+     * @return The next point.
+     */
+    RVector3 nextPointInBox(const RVector3& min, const RVector3& max);
+
+    /**
+     * Fills an array with uniformly distributed 32-bit integers.
+     *
+     * @param dst The array to fill.
+     * @param count The number of values.
+     */
+    void fillUInt(uint32_t* dst, size_t count);
+
+    /**
+     * Fills an array with uniformly distributed floats in [0, 1).
+     *
+     * @param dst The array to fill.
+     * @param count The number of values.
+     */
+    void fillFloat(float* dst, size_t count);
+
+    /**
+     * Fills an array with uniformly distributed floats in [min, max].
+     *
+     * @param dst The array to fill.
+     * @param count The number of values.
+     * @param min The lower bound.
+     * @param max The upper bound.
+     */
+    void fillFloat(float* dst, size_t count, float min, float max);
+
+    /**
+     * Fills an array with uniformly distributed unit vectors.
+     *
+     * @param dst The array to fill.
+     * @param count The number of vectors.
+     */
+    void fillUnitVectors(RVector3* dst, size_t count);
+
+    /**
+     * Fills an array with uniformly distributed points inside a sphere.
+     *
+     * @param dst The array to fill.
+     * @param count The number of points.
+     * @param center The center of the sphere.
+     * @param radius The radius of the sphere.
+     */
+    void fillPointsInSphere(RVector3* dst, size_t count, const RVector3& center, float radius);
+
+    /**
+     * Fills an array with uniformly distributed points inside an axis aligned box.
+     *
+     * @param dst The array to fill.
+     * @param count The number of points.
+     * @param min The minimum corner of the box.
+     * @param max The maximum corner of the box.
+     */
+    void fillPointsInBox(RVector3* dst, size_t count, const RVector3& min, const RVector3& max);
+
+private:
+
+    void refill();
+
+    // Lane state, _state[word][lane], so one word of every lane is one SSE2 register.
+    uint32_t _state[4][4];
+    uint32_t _buffer[4];
+    int _index;
+};
+
+}